@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "archive/zlib.h"
+
+#include <zlib.h>
+
+#include <array>
+#include <utility>
+
+namespace archive {
+namespace {
+
+// 15 is the largest window size the formats allow, and adding 16 selects the
+// gzip wrapper instead of the zlib one.
+constexpr int kMaxWindowBits = 15;
+constexpr int kGzipWrapper = 16;
+
+} // namespace
+
+struct ZlibDecoder::Impl {
+    z_stream stream{};
+    bool initialized{};
+    bool finished{};
+};
+
+ZlibDecoder::ZlibDecoder(ZlibMode mode) : impl_{std::make_unique<Impl>()} {
+    int window_bits = mode == ZlibMode::Gzip ? kMaxWindowBits + kGzipWrapper : kMaxWindowBits;
+    impl_->initialized = inflateInit2(&impl_->stream, window_bits) == Z_OK;
+}
+
+ZlibDecoder::~ZlibDecoder() {
+    if (impl_ && impl_->initialized) {
+        inflateEnd(&impl_->stream);
+    }
+}
+
+ZlibDecoder::ZlibDecoder(ZlibDecoder &&) noexcept = default;
+ZlibDecoder &ZlibDecoder::operator=(ZlibDecoder &&) noexcept = default;
+
+std::optional<std::string> ZlibDecoder::decode(std::string_view chunk) {
+    if (!impl_->initialized) {
+        return std::nullopt;
+    }
+
+    // zlib doesn't write through next_in, it just isn't const-correct.
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    impl_->stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(chunk.data()));
+    impl_->stream.avail_in = static_cast<uInt>(chunk.size());
+
+    std::string output{};
+    std::array<char, 16384> buffer{};
+    while (impl_->stream.avail_in != 0 && !impl_->finished) {
+        impl_->stream.next_out = reinterpret_cast<Bytef *>(buffer.data());
+        impl_->stream.avail_out = static_cast<uInt>(buffer.size());
+
+        int res = inflate(&impl_->stream, Z_NO_FLUSH);
+        if (res == Z_STREAM_END) {
+            impl_->finished = true;
+        } else if (res != Z_OK) {
+            return std::nullopt;
+        }
+
+        output.append(buffer.data(), buffer.size() - impl_->stream.avail_out);
+    }
+
+    return output;
+}
+
+bool ZlibDecoder::finished() const {
+    return impl_->finished;
+}
+
+std::optional<std::string> zlib_decode(std::string_view data, ZlibMode mode) {
+    ZlibDecoder decoder{mode};
+    auto decoded = decoder.decode(data);
+    if (!decoded || !decoder.finished()) {
+        return std::nullopt;
+    }
+
+    return decoded;
+}
+
+} // namespace archive
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ARCHIVE_ZLIB_H_
+#define ARCHIVE_ZLIB_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace archive {
+
+enum class ZlibMode {
+    Zlib,
+    Gzip,
+};
+
+// Streaming zlib/gzip decompressor. Feed it compressed data as it arrives
+// and it hands back whatever it could decompress so far, so decompression
+// overlaps the download instead of running after it.
+class ZlibDecoder {
+public:
+    explicit ZlibDecoder(ZlibMode);
+    ~ZlibDecoder();
+
+    ZlibDecoder(ZlibDecoder &&) noexcept;
+    ZlibDecoder &operator=(ZlibDecoder &&) noexcept;
+
+    // Decompresses a chunk of the stream, returning the output it produced.
+    // Returns std::nullopt if the data is corrupt.
+    [[nodiscard]] std::optional<std::string> decode(std::string_view chunk);
+
+    // True once the end of the compressed stream has been seen.
+    [[nodiscard]] bool finished() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Decompresses a complete buffer in one go. Returns std::nullopt if the data
+// is corrupt or truncated.
+std::optional<std::string> zlib_decode(std::string_view data, ZlibMode);
+
+} // namespace archive
+
+#endif
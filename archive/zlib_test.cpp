@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "archive/zlib.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+using namespace std::literals;
+
+using etest::expect;
+using etest::expect_eq;
+
+namespace {
+
+// "hello" compressed with gzip and zlib framing, respectively.
+std::string const kGzipHello{
+        "\037\213\010\000\000\000\000\000\002\003\313\110\315\311\311\007\000\206\246\020\066\005\000\000\000"s};
+std::string const kZlibHello{"\170\234\313\110\315\311\311\007\000\006\054\002\025"s};
+
+} // namespace
+
+int main() {
+    etest::test("gzip, one shot", [] {
+        expect_eq(archive::zlib_decode(kGzipHello, archive::ZlibMode::Gzip), "hello"s); //
+    });
+
+    etest::test("zlib, one shot", [] {
+        expect_eq(archive::zlib_decode(kZlibHello, archive::ZlibMode::Zlib), "hello"s); //
+    });
+
+    etest::test("wrong framing", [] {
+        expect_eq(archive::zlib_decode(kGzipHello, archive::ZlibMode::Zlib), std::nullopt);
+        expect_eq(archive::zlib_decode(kZlibHello, archive::ZlibMode::Gzip), std::nullopt);
+    });
+
+    etest::test("corrupt data", [] {
+        auto corrupted = kGzipHello;
+        corrupted[corrupted.size() / 2] ^= '\x55';
+        expect_eq(archive::zlib_decode(corrupted, archive::ZlibMode::Gzip), std::nullopt);
+    });
+
+    etest::test("truncated data", [] {
+        expect_eq(archive::zlib_decode(kGzipHello.substr(0, kGzipHello.size() - 5), archive::ZlibMode::Gzip),
+                std::nullopt);
+    });
+
+    etest::test("streaming across chunks", [] {
+        archive::ZlibDecoder decoder{archive::ZlibMode::Gzip};
+        std::string decoded{};
+        for (std::size_t i = 0; i < kGzipHello.size(); ++i) {
+            auto out = decoder.decode(kGzipHello.substr(i, 1));
+            expect(out.has_value());
+            decoded += *out;
+        }
+
+        expect(decoder.finished());
+        expect_eq(decoded, "hello"s);
+    });
+
+    etest::test("streaming, not finished mid-stream", [] {
+        archive::ZlibDecoder decoder{archive::ZlibMode::Gzip};
+        auto out = decoder.decode(kGzipHello.substr(0, kGzipHello.size() / 2));
+        expect(out.has_value());
+        expect(!decoder.finished());
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/engine.h"
+#include "engine/navigation_metrics.h"
+#include "protocol/file_handler.h"
+#include "uri/uri.h"
+
+#include <fmt/format.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr char const *kDefaultPage = "browser/bench_pages/example.html";
+constexpr int kRepeats = 10;
+
+std::int64_t median_of(std::vector<std::int64_t> samples) {
+    std::ranges::sort(samples);
+    return samples[samples.size() / 2];
+}
+
+} // namespace
+
+// Drives the engine headlessly over local pages and reports where each
+// navigation spent its time, for holding the line on page-load latency
+// between changes. Run two builds over the same pages to A/B them.
+int main(int argc, char **argv) {
+    spdlog::set_default_logger(spdlog::stderr_color_mt("hastur"));
+    spdlog::set_level(spdlog::level::warn);
+
+    std::vector<std::string> pages;
+    for (int i = 1; i < argc; ++i) {
+        pages.emplace_back(argv[i]);
+    }
+
+    if (pages.empty()) {
+        pages.emplace_back(kDefaultPage);
+    }
+
+    engine::Engine engine{std::make_unique<protocol::FileHandler>()};
+    engine.set_layout_width(1024);
+
+    for (auto const &page : pages) {
+        auto page_uri = uri::Uri::parse("file://" + std::filesystem::absolute(page).string());
+
+        // Phase names in first-seen order, with one duration per run.
+        std::vector<std::string> phase_order;
+        std::map<std::string, std::vector<std::int64_t>> phase_durations;
+        std::vector<std::int64_t> totals;
+
+        for (int run = 0; run < kRepeats; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            if (auto err = engine.navigate(page_uri); err != protocol::Error::Ok) {
+                fmt::print(stderr, "Got error {} from {}\n", static_cast<int>(err), page_uri.uri);
+                return 1;
+            }
+            auto total = std::chrono::steady_clock::now() - start;
+
+            for (auto const &phase : engine.navigation_metrics().phases) {
+                if (!phase_durations.contains(phase.name)) {
+                    phase_order.push_back(phase.name);
+                }
+                phase_durations[phase.name].push_back(phase.duration_us);
+            }
+
+            totals.push_back(std::chrono::duration_cast<std::chrono::microseconds>(total).count());
+        }
+
+        fmt::print("{} ({} runs)\n", page, kRepeats);
+        for (auto const &name : phase_order) {
+            fmt::print("  {:<20}: median {} us\n", name, median_of(phase_durations[name]));
+        }
+        fmt::print("  {:<20}: median {} us\n", "total", median_of(totals));
+    }
+}
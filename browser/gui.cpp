@@ -6,12 +6,14 @@
 
 #include "os/os.h"
 
+#include <spdlog/async.h>
 #include <spdlog/cfg/env.h>
 #include <spdlog/sinks/dup_filter_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
 #include <chrono>
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,12 +25,21 @@ using namespace std::literals;
 namespace {
 auto const kBrowserTitle{"hastur"};
 auto const kStartpage{"http://example.com"s};
+// Bounded so a logging storm costs dropped messages, not blocked frames.
+constexpr std::size_t kLogQueueSize{8192};
 } // namespace
 
 int main(int argc, char **argv) {
+    // Formatting and writing happen on the logging thread so debug-level
+    // dumps don't perturb the latencies they're there to diagnose. A full
+    // queue drops the oldest messages instead of blocking the logger.
+    spdlog::init_thread_pool(kLogQueueSize, 1);
     auto dup_filter = std::make_shared<spdlog::sinks::dup_filter_sink_mt>(std::chrono::seconds{10});
     dup_filter->add_sink(std::make_shared<spdlog::sinks::stderr_color_sink_mt>());
-    spdlog::set_default_logger(std::make_shared<spdlog::logger>(kBrowserTitle, std::move(dup_filter)));
+    spdlog::set_default_logger(std::make_shared<spdlog::async_logger>(kBrowserTitle,
+            std::move(dup_filter),
+            spdlog::thread_pool(),
+            spdlog::async_overflow_policy::overrun_oldest));
     spdlog::cfg::load_env_levels();
     spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%L%$] %v");
 
@@ -64,6 +75,15 @@ int main(int argc, char **argv) {
     }
 
     browser::gui::App app{kBrowserTitle, page_provided.value_or(kStartpage), page_provided.has_value()};
-    app.set_scale(scale.value_or(os::active_window_scale_factor()));
+
+    // An explicit --scale pins the scale; otherwise the os watcher seeds it
+    // and keeps it tracking monitor moves without the app ever re-running
+    // the slow platform query itself.
+    std::optional<os::ScaleFactorWatcher> scale_watcher{};
+    if (!scale) {
+        scale_watcher.emplace([&app](unsigned new_scale) { app.on_scale_factor_changed(new_scale); });
+    }
+
+    app.set_scale(scale ? *scale : scale_watcher->scale_factor());
     return app.run();
 }
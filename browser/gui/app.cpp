@@ -6,13 +6,16 @@
 
 #include "css/rule.h"
 #include "dom/dom.h"
+#include "geom/geom.h"
 #include "gfx/color.h"
 #include "gfx/opengl_canvas.h"
 #include "gfx/painter.h"
 #include "render/render.h"
 #include "uri/uri.h"
 
+#include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Window/Event.hpp>
+#include <SFML/Window/VideoMode.hpp>
 #include <fmt/format.h>
 #include <imgui-SFML.h>
 #include <imgui.h>
@@ -20,9 +23,11 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <string_view>
@@ -40,6 +45,10 @@ auto constexpr kDefaultResolutionY = 480;
 // Magic number that felt right during testing.
 auto constexpr kMouseWheelScrollFactor = 10;
 
+// Long enough to read as movement, short enough that the page doesn't feel
+// like it's trailing the wheel.
+auto constexpr kScrollAnimationSeconds = 0.15f;
+
 std::optional<std::string_view> try_get_text_content(dom::Document const &doc, std::string_view xpath) {
     auto nodes = dom::nodes_by_xpath(doc.html(), xpath);
     if (nodes.empty() || nodes[0]->children.empty() || !std::holds_alternative<dom::Text>(nodes[0]->children[0])) {
@@ -119,9 +128,24 @@ void window(char const *title, ImVec2 const &position, ImVec2 const &size, auto
 } // namespace
 
 App::App(std::string browser_title, std::string start_page_hint, bool load_start_page)
-    : browser_title_{std::move(browser_title)}, window_{sf::VideoMode(kDefaultResolutionX, kDefaultResolutionY),
-                                                        browser_title_},
-      url_buf_{std::move(start_page_hint)} {
+    : browser_title_{std::move(browser_title)}, url_buf_{std::move(start_page_hint)} {
+    // The initial fetch doesn't need a window, and window, GL-context, and
+    // imgui init dominate cold start, so kick the navigation worker off first
+    // and let the two overlap. The worker parks in deliver_engine_event until
+    // the event loop starts running callbacks, by which point the window is
+    // up, so startup costs max(window init, fetch) instead of the sum.
+    engine_.set_layout_width(kDefaultResolutionX / static_cast<int>(scale_));
+    engine_.set_on_navigation_failure(
+            [this](protocol::Error err) { deliver_engine_event([this, err] { on_navigation_failure(err); }); });
+    engine_.set_on_page_loaded([this] { deliver_engine_event([this] { on_page_loaded(); }); });
+    engine_.set_on_layout_updated([this] { deliver_engine_event([this] { on_layout_updated(); }); });
+
+    if (load_start_page) {
+        ensure_has_scheme(url_buf_);
+        navigate();
+    }
+
+    window_.create(sf::VideoMode(kDefaultResolutionX, kDefaultResolutionY), browser_title_);
     window_.setFramerateLimit(60);
     window_.setMouseCursor(cursor_);
     if (!ImGui::SFML::Init(window_)) {
@@ -135,25 +159,92 @@ App::App(std::string browser_title, std::string start_page_hint, bool load_start
         ImGui::GetIO().IniFilename = nullptr;
     }
 
+    prefetch_on_hover_ = std::getenv("HST_PREFETCH_ON_HOVER") != nullptr;
+
+    // Opt-in: keep the browse history in an on-disk log so a restarted
+    // session resumes where it left off.
+    if (char const *history_file = std::getenv("HST_HISTORY_FILE")) {
+        browse_history_.attach_log(
+                history_file,
+                [](uri::Uri const &uri) { return uri.uri; },
+                [](std::string const &line) -> std::optional<uri::Uri> {
+                    if (line.empty()) {
+                        return std::nullopt;
+                    }
+                    return uri::Uri::parse(line);
+                });
+    }
+
     canvas_->set_viewport_size(window_.getSize().x, window_.getSize().y);
+}
 
-    engine_.set_layout_width(window_.getSize().x / scale_);
-    engine_.set_on_navigation_failure(std::bind_front(&App::on_navigation_failure, this));
-    engine_.set_on_page_loaded(std::bind_front(&App::on_page_loaded, this));
-    engine_.set_on_layout_updated(std::bind_front(&App::on_layout_updated, this));
+App::~App() {
+    cancel_navigation();
+    ImGui::SFML::Shutdown();
+}
 
-    if (load_start_page) {
-        ensure_has_scheme(url_buf_);
-        navigate();
+void App::deliver_engine_event(std::function<void()> handler) {
+    if (std::this_thread::get_id() == gui_thread_id_) {
+        handler();
+        return;
+    }
+
+    auto cancelled = nav_cancelled_;
+    if (cancelled && *cancelled) {
+        return;
     }
+
+    auto done = std::make_shared<std::atomic<bool>>(false);
+    {
+        std::scoped_lock lock{task_mutex_};
+        queued_tasks_.push_back([handler = std::move(handler), cancelled, done] {
+            // Handlers from a navigation cancelled since they were queued
+            // mustn't touch state the new navigation owns.
+            if (!cancelled || !*cancelled) {
+                handler();
+            }
+
+            *done = true;
+        });
+    }
+
+    std::unique_lock lock{task_mutex_};
+    task_run_.wait(lock, [&] { return *done || (cancelled && *cancelled); });
 }
 
-App::~App() {
-    ImGui::SFML::Shutdown();
+void App::run_queued_tasks() {
+    std::vector<std::function<void()>> tasks{};
+    {
+        std::scoped_lock lock{task_mutex_};
+        tasks = std::exchange(queued_tasks_, {});
+    }
+
+    for (auto &task : tasks) {
+        task();
+    }
+
+    if (!tasks.empty()) {
+        task_run_.notify_all();
+    }
+}
+
+void App::cancel_navigation() {
+    if (nav_cancelled_) {
+        *nav_cancelled_ = true;
+        // Wake the worker if it's waiting on a handler we'll never run.
+        task_run_.notify_all();
+    }
+
+    if (nav_thread_.joinable()) {
+        nav_thread_.join();
+    }
 }
 
 void App::set_scale(unsigned scale) {
+    finish_display_list_recording();
     scale_ = scale;
+    display_list_dirty_ = true;
+    page_tiles_.clear();
     ImGui::GetIO().FontGlobalScale = static_cast<float>(scale_);
     canvas_->set_scale(scale_);
     auto windowSize = window_.getSize();
@@ -164,170 +255,259 @@ void App::set_scale(unsigned scale) {
         canvas_->set_viewport_size(window_.getSize().x, window_.getSize().y);
     }
 
-    engine_.set_layout_width(windowSize.x / scale_);
+    // The engine only relayouts if the css-visible width actually changed,
+    // so hopping between monitors with different scales is repaint-only.
+    if (nav_in_flight_) {
+        // The initial navigation is likely still in flight when main sets the
+        // scale; the worker owns the layout tree, so relayout once it's done.
+        pending_layout_width_ = static_cast<int>(windowSize.x / scale_);
+    } else {
+        engine_.set_layout_width(windowSize.x / scale_);
+    }
+}
+
+void App::on_scale_factor_changed(unsigned scale) {
+    std::scoped_lock lock{task_mutex_};
+    queued_tasks_.push_back([this, scale] { set_scale(scale); });
 }
 
 int App::run() {
     while (window_.isOpen()) {
         sf::Event event;
+
+        // A static page shouldn't cost a core to keep on screen: with no
+        // damage to repaint and nothing in flight that could produce some,
+        // park in the blocking event wait instead of spinning at the frame
+        // limit.
+        if (can_idle() && window_.waitEvent(event)) {
+            handle_event(event);
+        }
+
         while (window_.pollEvent(event)) {
-            ImGui::SFML::ProcessEvent(event);
+            handle_event(event);
+        }
+
+        // Results from the navigation worker are handed over here.
+        run_queued_tasks();
 
-            switch (event.type) {
-                case sf::Event::Closed: {
-                    window_.close();
+        // Nothing changed after all (e.g. the event wait was interrupted):
+        // back to sleep rather than painting an identical frame.
+        if (can_idle()) {
+            continue;
+        }
+        repaint_needed_ = false;
+
+        // While a scroll is animating, this is usually the only change in the
+        // frame, and the page part of the frame is a blit of cached tiles.
+        tick_scroll_animation();
+
+        run_overlay();
+        run_nav_widget();
+        run_http_response_widget();
+        run_dom_widget();
+        run_stylesheet_widget();
+        run_layout_widget();
+
+        clear_render_surface();
+
+        if (page_loaded_) {
+            render_layout();
+        }
+
+        render_overlay();
+        show_render_surface();
+    }
+
+    return 0;
+}
+
+void App::handle_event(sf::Event const &event) {
+    // Anything that reaches the event loop can move a widget, the cursor, or
+    // the page, so every event counts as damage.
+    repaint_needed_ = true;
+    ImGui::SFML::ProcessEvent(event);
+
+    switch (event.type) {
+        case sf::Event::Closed: {
+            window_.close();
+            break;
+        }
+        case sf::Event::Resized: {
+            finish_display_list_recording();
+            canvas_->set_viewport_size(event.size.width, event.size.height);
+            if (nav_in_flight_) {
+                // The worker owns the layout tree right now; relayout
+                // once it's done.
+                pending_layout_width_ = static_cast<int>(event.size.width / scale_);
+            } else {
+                engine_.set_layout_width(event.size.width / scale_);
+            }
+            break;
+        }
+        case sf::Event::KeyPressed: {
+            if (ImGui::GetIO().WantCaptureKeyboard) {
+                break;
+            }
+
+            switch (event.key.code) {
+                case sf::Keyboard::Key::J: {
+                    scroll(event.key.shift ? -20 : -5);
                     break;
                 }
-                case sf::Event::Resized: {
-                    canvas_->set_viewport_size(event.size.width, event.size.height);
-                    engine_.set_layout_width(event.size.width / scale_);
+                case sf::Keyboard::Key::K: {
+                    scroll(event.key.shift ? 20 : 5);
                     break;
                 }
-                case sf::Event::KeyPressed: {
-                    if (ImGui::GetIO().WantCaptureKeyboard) {
-                        break;
-                    }
-
-                    switch (event.key.code) {
-                        case sf::Keyboard::Key::J: {
-                            scroll(event.key.shift ? -20 : -5);
-                            break;
-                        }
-                        case sf::Keyboard::Key::K: {
-                            scroll(event.key.shift ? 20 : 5);
-                            break;
-                        }
-                        case sf::Keyboard::Key::F1: {
-                            render_debug_ = !render_debug_;
-                            break;
-                        }
-                        case sf::Keyboard::Key::F2: {
-                            switch_canvas();
-                            break;
-                        }
-                        case sf::Keyboard::Key::Left: {
-                            if (!event.key.alt) {
-                                break;
-                            }
-
-                            auto entry = browse_history_.previous();
-                            if (!entry) {
-                                break;
-                            }
-
-                            browse_history_.pop();
-                            url_buf_ = entry->uri;
-                            navigate();
-                            break;
-                        }
-                        case sf::Keyboard::Key::Right: {
-                            if (!event.key.alt) {
-                                break;
-                            }
-
-                            auto entry = browse_history_.next();
-                            if (!entry) {
-                                break;
-                            }
-
-                            url_buf_ = entry->uri;
-                            navigate();
-                            break;
-                        }
-                        default:
-                            break;
-                    }
+                case sf::Keyboard::Key::F1: {
+                    render_debug_ = !render_debug_;
+                    break;
+                }
+                case sf::Keyboard::Key::F2: {
+                    switch_canvas();
+                    break;
+                }
+                case sf::Keyboard::Key::F3: {
+                    render_paint_heatmap_ = !render_paint_heatmap_;
                     break;
                 }
-                case sf::Event::MouseMoved: {
-                    if (!page_loaded_) {
+                case sf::Keyboard::Key::Left: {
+                    if (!event.key.alt) {
                         break;
                     }
 
-                    auto window_position = geom::Position{event.mouseMove.x, event.mouseMove.y};
-                    auto document_position = to_document_position(std::move(window_position));
-                    auto const dom_nodes = get_hovered_nodes(document_position);
-                    nav_widget_extra_info_ =
-                            fmt::format("{},{}: {}", document_position.x, document_position.y, element_text(dom_nodes));
-
-                    // If imgui is dealing with the mouse, we do nothing and let imgui change the cursor.
-                    if (ImGui::GetIO().WantCaptureMouse) {
-                        ImGui::GetIO().ConfigFlags &= ~ImGuiConfigFlags_NoMouseCursorChange;
+                    auto entry = browse_history_.previous();
+                    if (!entry) {
                         break;
                     }
 
-                    // Otherwise we tell imgui not to mess with the cursor, and change it according to what we're
-                    // currently hovering over.
-                    ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange;
-                    if (try_get_uri(dom_nodes).has_value()) {
-                        cursor_.loadFromSystem(sf::Cursor::Hand);
-                    } else {
-                        cursor_.loadFromSystem(sf::Cursor::Arrow);
-                    }
-                    window_.setMouseCursor(cursor_);
-
+                    browse_history_.pop();
+                    url_buf_ = entry->uri;
+                    navigate(engine::NavigationKind::History);
                     break;
                 }
-                case sf::Event::MouseButtonReleased: {
-                    if (ImGui::GetIO().WantCaptureMouse || event.mouseButton.button != sf::Mouse::Left) {
+                case sf::Keyboard::Key::Right: {
+                    if (!event.key.alt) {
                         break;
                     }
 
-                    auto window_position = geom::Position{event.mouseButton.x, event.mouseButton.y};
-                    auto document_position = to_document_position(std::move(window_position));
-                    auto const dom_nodes = get_hovered_nodes(std::move(document_position));
-                    if (auto uri = try_get_uri(dom_nodes); uri.has_value()) {
-                        url_buf_ = std::string{*uri};
-                        navigate();
-                    }
-
-                    break;
-                }
-                case sf::Event::MouseWheelScrolled: {
-                    if (ImGui::GetIO().WantCaptureMouse
-                            || event.mouseWheelScroll.wheel != sf::Mouse::Wheel::VerticalWheel) {
+                    auto entry = browse_history_.next();
+                    if (!entry) {
                         break;
                     }
 
-                    scroll(std::lround(event.mouseWheelScroll.delta) * kMouseWheelScrollFactor);
+                    url_buf_ = entry->uri;
+                    navigate(engine::NavigationKind::History);
                     break;
                 }
                 default:
                     break;
             }
+            break;
         }
+        case sf::Event::MouseMoved: {
+            if (!page_loaded_) {
+                break;
+            }
 
-        run_overlay();
-        run_nav_widget();
-        run_http_response_widget();
-        run_dom_widget();
-        run_stylesheet_widget();
-        run_layout_widget();
+            auto window_position = geom::Position{event.mouseMove.x, event.mouseMove.y};
+            auto document_position = to_document_position(std::move(window_position));
+            auto const dom_nodes = get_hovered_nodes(document_position);
+            nav_widget_extra_info_ =
+                    fmt::format("{},{}: {}", document_position.x, document_position.y, element_text(dom_nodes));
 
-        clear_render_surface();
+            maybe_prefetch_hovered_link(dom_nodes);
 
-        if (page_loaded_) {
-            render_layout();
+            // If imgui is dealing with the mouse, we do nothing and let imgui change the cursor.
+            if (ImGui::GetIO().WantCaptureMouse) {
+                ImGui::GetIO().ConfigFlags &= ~ImGuiConfigFlags_NoMouseCursorChange;
+                break;
+            }
+
+            // Otherwise we tell imgui not to mess with the cursor, and change it according to what we're
+            // currently hovering over.
+            ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange;
+            if (try_get_uri(dom_nodes).has_value()) {
+                cursor_.loadFromSystem(sf::Cursor::Hand);
+            } else {
+                cursor_.loadFromSystem(sf::Cursor::Arrow);
+            }
+            window_.setMouseCursor(cursor_);
+
+            break;
         }
+        case sf::Event::MouseButtonReleased: {
+            if (ImGui::GetIO().WantCaptureMouse || event.mouseButton.button != sf::Mouse::Left) {
+                break;
+            }
 
-        render_overlay();
-        show_render_surface();
+            auto window_position = geom::Position{event.mouseButton.x, event.mouseButton.y};
+            auto document_position = to_document_position(std::move(window_position));
+            auto const dom_nodes = get_hovered_nodes(std::move(document_position));
+            if (auto uri = try_get_uri(dom_nodes); uri.has_value()) {
+                url_buf_ = std::string{*uri};
+                navigate();
+            }
+
+            break;
+        }
+        case sf::Event::MouseWheelScrolled: {
+            if (ImGui::GetIO().WantCaptureMouse
+                    || event.mouseWheelScroll.wheel != sf::Mouse::Wheel::VerticalWheel) {
+                break;
+            }
+
+            scroll(std::lround(event.mouseWheelScroll.delta) * kMouseWheelScrollFactor);
+            break;
+        }
+        default:
+            break;
     }
+}
 
-    return 0;
+bool App::can_idle() {
+    if (repaint_needed_ || nav_in_flight_ || display_list_dirty_ || pending_display_list_.valid()
+            || scroll_animation_.has_value()) {
+        return false;
+    }
+
+    std::scoped_lock lock{task_mutex_};
+    return queued_tasks_.empty();
 }
 
-void App::navigate() {
+void App::navigate(engine::NavigationKind kind) {
+    // A new navigation obsoletes any in-flight one.
+    cancel_navigation();
+    finish_display_list_recording();
     page_loaded_ = false;
     auto uri = uri::Uri::parse(url_buf_, engine_.uri());
     browse_history_.push(uri);
-    engine_.navigate(std::move(uri));
 
-    // Make sure the displayed url is still correct if we followed any redirects.
-    url_buf_ = engine_.uri().uri;
+    nav_cancelled_ = std::make_shared<std::atomic<bool>>(false);
+    nav_in_flight_ = true;
+    nav_thread_ = std::thread{[this, uri = std::move(uri), cancel = nav_cancelled_, kind]() mutable {
+        engine_.navigate(std::move(uri), cancel, kind);
+
+        // Apply anything the GUI held back while we owned the engine. Queued
+        // before nav_in_flight_ flips so the GUI can't see an idle navigation
+        // with this task still unqueued and park in the event wait.
+        {
+            std::scoped_lock lock{task_mutex_};
+            queued_tasks_.push_back([this, cancel] {
+                if (!*cancel && pending_layout_width_) {
+                    finish_display_list_recording();
+                    engine_.set_layout_width(*std::exchange(pending_layout_width_, std::nullopt));
+                }
+            });
+        }
+
+        nav_in_flight_ = false;
+    }};
 }
 
 void App::on_navigation_failure(protocol::Error err) {
+    repaint_needed_ = true;
+    // Make sure the displayed url is still correct if we followed any redirects.
+    url_buf_ = engine_.uri().uri;
     update_status_line();
     response_headers_str_ = engine_.response().headers.to_string();
     dom_str_.clear();
@@ -350,6 +530,11 @@ void App::on_navigation_failure(protocol::Error err) {
             spdlog::error(nav_widget_extra_info_);
             break;
         }
+        case protocol::Error::Timeout: {
+            nav_widget_extra_info_ = fmt::format("Timed out loading '{}'", url_buf_);
+            spdlog::error(nav_widget_extra_info_);
+            break;
+        }
         case protocol::Error::Ok:
         default:
             spdlog::error("This should never happen: {}", static_cast<int>(err));
@@ -359,6 +544,8 @@ void App::on_navigation_failure(protocol::Error err) {
 
 void App::on_page_loaded() {
     page_loaded_ = true;
+    // Make sure the displayed url is still correct if we followed any redirects.
+    url_buf_ = engine_.uri().uri;
     if (auto page_title = try_get_text_content(engine_.dom(), "/html/head/title"sv)) {
         window_.setTitle(fmt::format("{} - {}", *page_title, browser_title_));
     } else {
@@ -374,18 +561,73 @@ void App::on_page_loaded() {
 
 void App::on_layout_updated() {
     reset_scroll();
+    repaint_needed_ = true;
+    display_list_dirty_ = true;
+    hit_tester_.reset();
+    page_tiles_.clear();
     nav_widget_extra_info_.clear();
     auto const *layout = engine_.layout();
     layout_str_ = layout != nullptr ? layout::to_string(*layout) : "";
+    queue_speculative_layouts();
+}
+
+void App::queue_speculative_layouts() {
+    // Widths a resize is likely to land on: nearby widths for drags, and
+    // the halves and thirds of the desktop that tiling window managers and
+    // edge snapping put windows at. The engine's idle scheduler computes
+    // them when nothing interactive is going on, so a resize hitting one of
+    // them swaps in a precomputed tree.
+    auto scale = static_cast<int>(scale_);
+    auto current = static_cast<int>(window_.getSize().x) / scale;
+    auto desktop = static_cast<int>(sf::VideoMode::getDesktopMode().width) / scale;
+    for (int width : {desktop, desktop / 2, desktop / 3, desktop * 2 / 3, current - current / 8, current + current / 8}) {
+        engine_.speculate_layout_width(width);
+    }
+}
+
+void App::maybe_prefetch_hovered_link(std::vector<dom::Node const *> const &hovered_nodes) {
+    if (!prefetch_on_hover_) {
+        return;
+    }
+
+    auto uri = try_get_uri(hovered_nodes);
+    if (!uri) {
+        return;
+    }
+
+    auto target = uri::Uri::parse(std::string{*uri}, engine_.uri());
+    if (target.scheme != "http" && target.scheme != "https") {
+        return;
+    }
+
+    if (target.uri == last_prefetched_uri_) {
+        return;
+    }
+
+    // One prefetch at a time: dropping an std::async future blocks until the
+    // fetch is done, which is the last thing the GUI thread should do.
+    if (prefetch_.valid() && prefetch_.wait_for(std::chrono::seconds{0}) != std::future_status::ready) {
+        return;
+    }
+
+    // The response is discarded here; the point is that the fetch warms the
+    // handler's response cache so a click on the link is served from it.
+    spdlog::info("Prefetching {}", target.uri);
+    last_prefetched_uri_ = target.uri;
+    prefetch_ = engine_.protocol_handler().handle_async(std::move(target));
 }
 
-std::vector<dom::Node const *> App::get_hovered_nodes(geom::Position p) const {
+std::vector<dom::Node const *> App::get_hovered_nodes(geom::Position p) {
+    if (nav_in_flight_) {
+        return {};
+    }
+
     auto const *layout = engine_.layout();
     if (!page_loaded_ || layout == nullptr) {
         return {};
     }
 
-    auto const *moused_over = layout::box_at_position(*layout, p);
+    auto const *moused_over = hit_tester_.box_at_position(*layout, p);
     if (moused_over == nullptr || moused_over->node == nullptr) {
         return {};
     }
@@ -399,11 +641,16 @@ geom::Position App::to_document_position(geom::Position window_position) const {
 }
 
 void App::reset_scroll() {
+    scroll_animation_.reset();
     canvas_->add_translation(0, -scroll_offset_y_);
     scroll_offset_y_ = 0;
 }
 
 void App::scroll(int pixels) {
+    if (nav_in_flight_) {
+        return;
+    }
+
     auto const *layout = engine_.layout();
     if (!page_loaded_ || layout == nullptr) {
         return;
@@ -414,19 +661,61 @@ void App::scroll(int pixels) {
         return;
     }
 
+    // Scrolls arriving mid-animation (wheel flicks, key repeat) move the
+    // target, so they accumulate instead of each restarting from wherever the
+    // offset happens to be.
+    int target = (scroll_animation_ ? scroll_animation_->to : scroll_offset_y_) + pixels;
+
     // Don't allow overscroll in either direction.
-    if (scroll_offset_y_ + pixels > 0) {
-        pixels = -scroll_offset_y_;
+    target = std::min(target, 0);
+    target = std::max(target, static_cast<int>(window_.getSize().y) - layout->dimensions.margin_box().height);
+
+    if (target == scroll_offset_y_) {
+        scroll_animation_.reset();
+        return;
+    }
+
+    scroll_animation_ = ScrollAnimation{.from = scroll_offset_y_, .to = target};
+}
+
+void App::tick_scroll_animation() {
+    if (!scroll_animation_) {
+        return;
     }
 
-    int current_bottom_visible_y = static_cast<int>(window_.getSize().y) - scroll_offset_y_;
-    int scrolled_bottom_visible_y = current_bottom_visible_y - pixels;
-    if (scrolled_bottom_visible_y > layout->dimensions.margin_box().height) {
-        pixels -= layout->dimensions.margin_box().height - scrolled_bottom_visible_y;
+    if (nav_in_flight_ || !page_loaded_) {
+        // The page the animation was scrolling is on its way out.
+        scroll_animation_.reset();
+        return;
     }
 
-    canvas_->add_translation(0, pixels);
-    scroll_offset_y_ += pixels;
+    int new_offset = scroll_animation_->to;
+    float t = scroll_animation_->elapsed.getElapsedTime().asSeconds() / kScrollAnimationSeconds;
+    if (t >= 1.f) {
+        scroll_animation_.reset();
+    } else {
+        // Ease-out: fast away from the old position, settling into the new.
+        float eased = 1.f - (1.f - t) * (1.f - t) * (1.f - t);
+        auto distance = static_cast<float>(scroll_animation_->to - scroll_animation_->from);
+        new_offset = scroll_animation_->from + static_cast<int>(std::lround(distance * eased));
+    }
+
+    if (new_offset == scroll_offset_y_) {
+        return;
+    }
+
+    canvas_->add_translation(0, new_offset - scroll_offset_y_);
+    scroll_offset_y_ = new_offset;
+    // The viewport moved, so a different slice of the page is visible. The
+    // page tiles are keyed by document position and stay valid, making this
+    // frame a blit of the already-painted ones.
+    display_list_dirty_ = true;
+}
+
+void App::finish_display_list_recording() {
+    // Destroying a std::async future blocks until the task has run, and the
+    // result is stale anyway once the layout tree changes.
+    pending_display_list_ = {};
 }
 
 void App::update_status_line() {
@@ -456,7 +745,9 @@ void App::run_http_response_widget() const {
             ImGui::TextUnformatted(response_headers_str_.c_str());
         }
         if (ImGui::CollapsingHeader("Body")) {
-            ImGui::TextUnformatted(engine_.response().body.c_str());
+            // The body may be a view of a mapped file, so no c_str() here.
+            std::string_view body{engine_.response().body};
+            ImGui::TextUnformatted(body.data(), body.data() + body.size());
         }
     });
 }
@@ -487,6 +778,11 @@ void App::clear_render_surface() {
         return;
     }
 
+    if (nav_in_flight_) {
+        window_.clear(sf::Color(255, 255, 255));
+        return;
+    }
+
     auto const *layout = engine_.layout();
     if (!page_loaded_ || layout == nullptr) {
         window_.clear(sf::Color(255, 255, 255));
@@ -519,17 +815,107 @@ void App::clear_render_surface() {
 }
 
 void App::render_layout() {
+    if (nav_in_flight_) {
+        // The worker may be mutating the layout tree; replay the last
+        // recorded frame instead of touching it.
+        gfx::replay_commands(*canvas_, display_list_);
+        canvas_->flush();
+        return;
+    }
+
     auto const *layout = engine_.layout();
     if (layout == nullptr) {
         return;
     }
 
-    gfx::Painter painter(*canvas_);
     if (render_debug_) {
+        gfx::Painter painter(*canvas_);
         render::debug::render_layout_depth(painter, *layout);
-    } else {
+        canvas_->flush();
+        return;
+    }
+
+    if (render_paint_heatmap_) {
+        // Tiling and display-list replay are skipped on purpose: the heatmap
+        // exists to watch the boxes being painted for real.
+        gfx::Painter painter(*canvas_);
         render::render_layout(painter, *layout);
+        render::debug::render_paint_heatmap(painter, *layout);
+        canvas_->flush();
+        return;
+    }
+
+    // The SFML canvas can paint into offscreen textures, making scrolling a
+    // blit of already-rendered page tiles.
+    if (selected_canvas_ == Canvas::Sfml && render_layout_tiled(*layout)) {
+        // The tiles are the rendering here; there's no display list to
+        // re-record, and leaving the flag set would keep the event loop from
+        // idling once a scroll animation has finished.
+        display_list_dirty_ = false;
+        return;
     }
+
+    // Swap in the latest finished recording, if any.
+    if (pending_display_list_.valid()
+            && pending_display_list_.wait_for(std::chrono::seconds{0}) == std::future_status::ready) {
+        display_list_ = pending_display_list_.get();
+    }
+
+    if (display_list_dirty_ && !pending_display_list_.valid()) {
+        // Boxes scrolled out of the window don't need to be painted.
+        geom::Rect viewport{0,
+                -scroll_offset_y_,
+                static_cast<int>(window_.getSize().x) / static_cast<int>(scale_),
+                static_cast<int>(window_.getSize().y) / static_cast<int>(scale_)};
+        // The recorder only reads the layout tree, and everything that
+        // mutates it calls finish_display_list_recording() first.
+        pending_display_list_ = std::async(
+                std::launch::async, [layout, viewport] { return render::record_layout(*layout, viewport); });
+        display_list_dirty_ = false;
+    }
+
+    gfx::replay_commands(*canvas_, display_list_);
+    canvas_->flush();
+}
+
+// TODO(robinlinden): Tiles are only evicted when the page changes, so a very
+// long browsing session on one page keeps every tile ever scrolled to.
+bool App::render_layout_tiled(layout::LayoutBox const &layout) {
+    auto window_size = window_.getSize();
+    auto document_width = static_cast<int>(window_size.x) / static_cast<int>(scale_);
+    auto tile_texture_height = kTileHeight * static_cast<int>(scale_);
+
+    // Scroll offset is the negated page translation, so the first visible
+    // document pixel row is -scroll_offset_y_.
+    int visible_top = -scroll_offset_y_;
+    int visible_bottom = visible_top + static_cast<int>(window_size.y) / static_cast<int>(scale_);
+
+    for (int tile_y = visible_top / kTileHeight * kTileHeight; tile_y < visible_bottom; tile_y += kTileHeight) {
+        auto &tile = page_tiles_[tile_y];
+        if (!tile) {
+            tile = std::make_unique<sf::RenderTexture>();
+            if (!tile->create(window_size.x, tile_texture_height)) {
+                spdlog::error("Unable to create page tile texture, painting directly");
+                page_tiles_.clear();
+                return false;
+            }
+
+            tile->clear(sf::Color::Transparent);
+            gfx::SfmlCanvas canvas{*tile};
+            canvas.set_viewport_size(static_cast<int>(window_size.x), tile_texture_height);
+            canvas.set_scale(scale_);
+            canvas.add_translation(0, -tile_y);
+            gfx::Painter painter{canvas};
+            render::render_layout(painter, layout, geom::Rect{0, tile_y, document_width, kTileHeight});
+            tile->display();
+        }
+
+        sf::Sprite sprite{tile->getTexture()};
+        sprite.setPosition(0.f, static_cast<float>((tile_y + scroll_offset_y_) * static_cast<int>(scale_)));
+        window_.draw(sprite);
+    }
+
+    return true;
 }
 
 void App::render_overlay() {
@@ -542,6 +928,10 @@ void App::show_render_surface() {
 
 void App::switch_canvas() {
     reset_scroll();
+    page_tiles_.clear();
+    // The retained display list may be stale while the tiles were doing the
+    // rendering.
+    display_list_dirty_ = true;
     if (selected_canvas_ == Canvas::OpenGL) {
         selected_canvas_ = Canvas::Sfml;
         canvas_ = std::make_unique<gfx::SfmlCanvas>(window_);
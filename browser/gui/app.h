@@ -7,19 +7,31 @@
 
 #include "dom/dom.h"
 #include "engine/engine.h"
+#include "gfx/canvas_command_saver.h"
 #include "gfx/icanvas.h"
 #include "gfx/sfml_canvas.h"
 #include "layout/layout.h"
 #include "protocol/handler_factory.h"
+#include "protocol/response.h"
 #include "uri/uri.h"
 #include "util/history.h"
 
+#include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/System/Clock.hpp>
 #include <SFML/Window/Cursor.hpp>
+#include <SFML/Window/Event.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace browser::gui {
@@ -30,6 +42,11 @@ public:
     ~App();
 
     void set_scale(unsigned scale);
+
+    // Queued from the os scale-factor watcher's thread; the GUI thread
+    // applies the new scale on its next wakeup.
+    void on_scale_factor_changed(unsigned scale);
+
     int run();
 
 private:
@@ -40,6 +57,8 @@ private:
 
     std::string browser_title_{};
     sf::Cursor cursor_{};
+    // Created in the constructor body, after the initial navigation has been
+    // kicked off, so the fetch overlaps window and GL-context creation.
     sf::RenderWindow window_{};
     sf::Clock clock_{};
     std::string url_buf_{};
@@ -62,24 +81,116 @@ private:
     // When we scroll "down", the web page is translated "up".
     int scroll_offset_y_{};
 
+    // An in-flight smooth scroll: the offset eases from `from` towards the
+    // already-clamped `to` over a fixed duration. Wheel events retarget this
+    // instead of jumping, and the frames in between are serviced from the
+    // cached page tiles, so each one is just a blit.
+    struct ScrollAnimation {
+        int from{};
+        int to{};
+        sf::Clock elapsed{};
+    };
+    std::optional<ScrollAnimation> scroll_animation_{};
+
+    // The retained display list from the last frame where the page or the
+    // viewport changed. Frames in between replay it without touching the
+    // layout tree.
+    std::vector<gfx::CanvasCommand> display_list_{};
+    bool display_list_dirty_{true};
+
+    // Recording the display list happens off the GUI thread so input stays
+    // responsive during big repaints. The GUI thread swaps the result in once
+    // it's ready and replays the previous frame until then.
+    std::future<std::vector<gfx::CanvasCommand>> pending_display_list_{};
+
+    // Set whenever input or an engine callback changes what's on screen. The
+    // event loop only paints frames while there's damage to show (or other
+    // in-progress work to poll); otherwise it parks in the event wait so a
+    // static page costs nothing to keep displayed.
+    bool repaint_needed_{true};
+
+    // Horizontal slices of the rendered page, keyed by the document y of
+    // their top edge. Scrolling just blits already-painted tiles; only tiles
+    // scrolled into view for the first time get painted. Cleared whenever the
+    // page, scale, or window size changes.
+    std::map<int, std::unique_ptr<sf::RenderTexture>> page_tiles_{};
+    static constexpr int kTileHeight{512};
+
     bool render_debug_{};
+    // Paints the page as usual, then tints each box by what it cost to paint.
+    bool render_paint_heatmap_{};
 
     unsigned scale_{1};
 
     util::History<uri::Uri> browse_history_;
 
+    // Navigation runs on this worker so slow fetches don't freeze the GUI.
+    // The engine checks the token between pipeline stages when the user
+    // navigates away mid-load. Engine callbacks are marshalled to the GUI
+    // thread: the worker queues the handler and pauses until the GUI has run
+    // it (or the navigation is cancelled), so the engine never mutates state
+    // while a handler is reading it.
+    std::thread nav_thread_{};
+    engine::CancellationToken nav_cancelled_{};
+    std::atomic<bool> nav_in_flight_{};
+    std::thread::id gui_thread_id_{std::this_thread::get_id()};
+    std::mutex task_mutex_;
+    std::condition_variable task_run_;
+    std::vector<std::function<void()>> queued_tasks_;
+
+    // Hit testing for hover and clicks starts from the box the mouse was last
+    // over instead of the layout root. Reset whenever the layout changes.
+    layout::CachedHitTester hit_tester_{};
+
+    // Window resizes that arrive while a navigation is in flight are applied
+    // once it's done instead of racing the worker for the layout tree.
+    std::optional<int> pending_layout_width_{};
+
+    // Opt-in (HST_PREFETCH_ON_HOVER): hovering a link fetches it through the
+    // protocol layer so a later click is served from the response cache.
+    bool prefetch_on_hover_{};
+    std::string last_prefetched_uri_{};
+    std::future<protocol::Response> prefetch_{};
+
+    void handle_event(sf::Event const &);
+
+    // True when there's nothing to paint and nothing in flight that could
+    // produce something to paint, so the event loop may block until input.
+    bool can_idle();
+
+    // Runs handler on the GUI thread, pausing the calling worker until it's
+    // done. Runs it inline when already on the GUI thread.
+    void deliver_engine_event(std::function<void()> handler);
+    void run_queued_tasks();
+    // Cancels any in-flight navigation and waits for its worker to wind down.
+    void cancel_navigation();
+
     void on_navigation_failure(protocol::Error);
     void on_page_loaded();
     void on_layout_updated();
+    // Hands the widths a resize is likely to land on to the engine's idle
+    // scheduler for precomputing layouts at.
+    void queue_speculative_layouts();
 
-    void navigate();
+    void navigate(engine::NavigationKind kind = engine::NavigationKind::Standard);
     void layout();
 
-    std::vector<dom::Node const *> get_hovered_nodes(geom::Position document_position) const;
+    void maybe_prefetch_hovered_link(std::vector<dom::Node const *> const &hovered_nodes);
+
+    std::vector<dom::Node const *> get_hovered_nodes(geom::Position document_position);
     geom::Position to_document_position(geom::Position window_position) const;
 
     void reset_scroll();
+    // Moves where the scroll animation is headed by pixels; the offset itself
+    // only changes in tick_scroll_animation().
     void scroll(int pixels);
+    // Advances the scroll offset towards the animation target. Called once
+    // per frame from the event loop.
+    void tick_scroll_animation();
+
+    // Blocks until any in-flight display-list recording has finished. Must be
+    // called before anything that mutates the engine's layout tree.
+    void finish_display_list_recording();
 
     void update_status_line();
 
@@ -92,6 +203,9 @@ private:
 
     void clear_render_surface();
     void render_layout();
+    // Returns false if an offscreen tile couldn't be created, in which case
+    // the caller should paint directly instead.
+    bool render_layout_tiled(layout::LayoutBox const &);
     void render_overlay();
     void show_render_surface();
 
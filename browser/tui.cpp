@@ -7,10 +7,12 @@
 #include "engine/engine.h"
 #include "protocol/handler_factory.h"
 
+#include <spdlog/async.h>
 #include <spdlog/cfg/env.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <cstddef>
 #include <cstdlib>
 #include <iostream>
 #include <string>
@@ -20,10 +22,14 @@ using namespace std::literals;
 
 namespace {
 char const *const kDefaultUri = "http://www.example.com";
+// Bounded so a logging storm costs dropped messages, not a stalled engine.
+constexpr std::size_t kLogQueueSize{8192};
 } // namespace
 
 int main(int argc, char **argv) {
-    spdlog::set_default_logger(spdlog::stderr_color_mt("hastur"));
+    // Log formatting and writing happen off-thread; see browser/gui.cpp.
+    spdlog::init_thread_pool(kLogQueueSize, 1);
+    spdlog::set_default_logger(spdlog::stderr_color_mt<spdlog::async_factory_nonblock>("hastur"));
     spdlog::cfg::load_env_levels();
     spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%L%$] %v");
 
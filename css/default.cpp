@@ -5,16 +5,57 @@
 #include "css/default.h"
 
 #include "css/parse.h"
+#include "css/snapshot.h"
 
+#include <cstdlib>
+#include <string>
 #include <string_view>
+#include <vector>
+
+using namespace std::literals;
 
 namespace css {
 namespace {
 #include "css/default_css.h"
+
+std::string snapshot_path() {
+    std::string base;
+    if (char const *xdg_cache_home = std::getenv("XDG_CACHE_HOME")) {
+        base = xdg_cache_home;
+    } else if (char const *home = std::getenv("HOME")) {
+        base = home + "/.cache"s;
+    } else {
+        return {};
+    }
+
+    return base + "/hastur/default-style";
+}
+
 } // namespace
 
-std::vector<css::Rule> default_style() {
-    return css::parse(std::string_view{reinterpret_cast<char const *>(css_default_css), css_default_css_len});
+std::vector<css::Rule> const &default_style() {
+    static std::vector<css::Rule> const kRules = [] {
+        auto source = std::string_view{reinterpret_cast<char const *>(css_default_css), css_default_css_len};
+        auto source_hash = style_sheet_hash(source);
+
+        // The source is baked into the binary, so validating the snapshot
+        // against its hash makes it good until the next upgrade changes the
+        // style sheet.
+        auto path = snapshot_path();
+        if (!path.empty()) {
+            if (auto snapshot = load_style_snapshot(path, source_hash)) {
+                return *std::move(snapshot);
+            }
+        }
+
+        auto rules = css::parse(source);
+        if (!path.empty()) {
+            save_style_snapshot(path, rules, source_hash);
+        }
+
+        return rules;
+    }();
+    return kRules;
 }
 
 } // namespace css
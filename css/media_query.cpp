@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "css/media_query.h"
+
+#include "util/from_chars.h"
+#include "util/string.h"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+namespace css {
+namespace {
+
+std::optional<int> to_px(std::string_view value) {
+    value = util::trim(value);
+    if (!value.ends_with("px")) {
+        return std::nullopt;
+    }
+
+    value.remove_suffix(std::strlen("px"));
+    float parsed{};
+    auto [ptr, ec] = util::from_chars(value.data(), value.data() + value.size(), parsed);
+    if (ec != std::errc{} || ptr != value.data() + value.size()) {
+        return std::nullopt;
+    }
+
+    return static_cast<int>(parsed);
+}
+
+} // namespace
+
+MediaQuery MediaQuery::parse(std::string_view query) {
+    MediaQuery parsed{};
+    for (auto term : util::LazySplit{query, " and "}) {
+        term = util::trim(term);
+        if (term.starts_with("only ")) {
+            term.remove_prefix(std::strlen("only "));
+        }
+
+        if (term == "all" || term == "screen") {
+            continue;
+        }
+
+        if (term == "print" || term == "speech" || term == "aural") {
+            parsed.never_matches = true;
+            continue;
+        }
+
+        if (!term.starts_with('(') || !term.ends_with(')')) {
+            continue;
+        }
+
+        term.remove_prefix(1);
+        term.remove_suffix(1);
+        auto [feature, value] = util::split_once(term, ":");
+        feature = util::trim(feature);
+        if (feature == "min-width") {
+            if (auto px = to_px(value)) {
+                parsed.min_width = std::max(parsed.min_width, *px);
+            }
+        } else if (feature == "max-width") {
+            if (auto px = to_px(value)) {
+                parsed.max_width = std::min(parsed.max_width, *px);
+            }
+        }
+    }
+
+    return parsed;
+}
+
+} // namespace css
@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef CSS_MEDIA_QUERY_H_
+#define CSS_MEDIA_QUERY_H_
+
+#include <limits>
+#include <string_view>
+
+namespace css {
+
+// The parsed form of a rule's @media condition. Only media types and the
+// width features are understood; anything else conservatively matches, since
+// a query we didn't evaluate at all used to always apply.
+struct MediaQuery {
+    static MediaQuery parse(std::string_view);
+
+    int min_width{0};
+    int max_width{std::numeric_limits<int>::max()};
+    // Set for media we never are, e.g. print.
+    bool never_matches{false};
+
+    [[nodiscard]] constexpr bool evaluate(int viewport_width) const {
+        return !never_matches && min_width <= viewport_width && viewport_width <= max_width;
+    }
+
+    [[nodiscard]] bool operator==(MediaQuery const &) const = default;
+};
+
+} // namespace css
+
+#endif
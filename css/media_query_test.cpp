@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "css/media_query.h"
+
+#include "etest/etest.h"
+
+using etest::expect;
+using etest::expect_eq;
+
+int main() {
+    etest::test("media types", [] {
+        expect(css::MediaQuery::parse("all").evaluate(100));
+        expect(css::MediaQuery::parse("screen").evaluate(100));
+        expect(css::MediaQuery::parse("only screen").evaluate(100));
+        expect(!css::MediaQuery::parse("print").evaluate(100));
+        expect(!css::MediaQuery::parse("only print").evaluate(100));
+    });
+
+    etest::test("min-width", [] {
+        auto query = css::MediaQuery::parse("(min-width: 900px)");
+        expect(!query.evaluate(899));
+        expect(query.evaluate(900));
+        expect(query.evaluate(901));
+    });
+
+    etest::test("max-width", [] {
+        auto query = css::MediaQuery::parse("(max-width: 900px)");
+        expect(query.evaluate(899));
+        expect(query.evaluate(900));
+        expect(!query.evaluate(901));
+    });
+
+    etest::test("combined terms", [] {
+        auto query = css::MediaQuery::parse("screen and (min-width: 600px) and (max-width: 900px)");
+        expect(!query.evaluate(599));
+        expect(query.evaluate(600));
+        expect(query.evaluate(900));
+        expect(!query.evaluate(901));
+
+        expect(!css::MediaQuery::parse("print and (min-width: 600px)").evaluate(700));
+    });
+
+    etest::test("unknown features conservatively match", [] {
+        // These rules have always applied unconditionally, and evaluating
+        // what we don't understand shouldn't make them disappear.
+        expect(css::MediaQuery::parse("(prefers-color-scheme: dark)").evaluate(100));
+        expect(css::MediaQuery::parse("(orientation: landscape)").evaluate(100));
+        expect(css::MediaQuery::parse("screen and (orientation: landscape)").evaluate(100));
+        expect(css::MediaQuery::parse("(min-width: 30em)").evaluate(100));
+    });
+
+    etest::test("parsed form", [] {
+        expect_eq(css::MediaQuery::parse("(min-width: 900px)"), css::MediaQuery{.min_width = 900});
+        expect_eq(css::MediaQuery::parse("(max-width: 337.5px)"), css::MediaQuery{.max_width = 337});
+        expect_eq(css::MediaQuery::parse("print"), css::MediaQuery{.never_matches = true});
+    });
+
+    return etest::run_all_tests();
+}
@@ -6,9 +6,12 @@
 
 #include "css/parser.h"
 
+#include "util/trace.h"
+
 namespace css {
 
 std::vector<css::Rule> parse(std::string_view input) {
+    util::trace::Span span{"css::parse"};
     return css::Parser{input}.parse_rules();
 }
 
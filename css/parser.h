@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <array>
 #include <charconv>
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
 #include <optional>
@@ -30,10 +31,14 @@ namespace css {
 
 class Parser final : util::BaseParser {
 public:
-    explicit Parser(std::string_view input) : BaseParser{input} {}
+    explicit Parser(std::string_view input) : BaseParser{input}, rule_count_upper_bound_{count_rules(input)} {}
 
     std::vector<css::Rule> parse_rules() {
         std::vector<css::Rule> rules;
+        // Every rule ends with a closing brace, so this only over-reserves by
+        // the number of @media blocks and saves us re-allocating our way up on
+        // big sheets.
+        rules.reserve(rule_count_upper_bound_);
         std::string_view media_query;
 
         skip_whitespace_and_comments();
@@ -42,7 +47,7 @@ public:
                 advance(std::strlen("@media"));
                 skip_whitespace_and_comments();
 
-                media_query = consume_while([](char c) { return c != '{'; });
+                media_query = consume_until('{');
                 if (auto last_char = media_query.find_last_not_of(' '); last_char != std::string_view::npos) {
                     media_query.remove_suffix(media_query.size() - (last_char + 1));
                 }
@@ -53,11 +58,11 @@ public:
             // Make sure we don't crash if we hit a currently unsupported at-rule.
             // @font-face works fine with the normal parsing-logic.
             if (starts_with("@") && !starts_with("@font-face")) {
-                auto kind = consume_while([](char c) { return c != ' ' && c != '{' && c != '('; });
+                auto kind = consume_until_any_of(" {(");
                 spdlog::warn("Encountered unhandled {} at-rule", kind);
 
                 skip_whitespace_and_comments();
-                std::ignore = consume_while([](char c) { return c != '{'; });
+                std::ignore = consume_until('{');
                 consume_char(); // {
                 skip_whitespace_and_comments();
 
@@ -89,6 +94,12 @@ public:
     }
 
 private:
+    std::size_t rule_count_upper_bound_{};
+
+    static std::size_t count_rules(std::string_view input) {
+        return static_cast<std::size_t>(std::ranges::count(input, '}'));
+    }
+
     void skip_whitespace_and_comments() {
         if (starts_with("/*")) {
             advance(2);
@@ -113,7 +124,8 @@ private:
     // https://developer.mozilla.org/en-US/docs/Web/CSS/border-width
     static constexpr std::array border_width_keywords{"thin", "medium", "thick"};
 
-    static constexpr auto shorthand_edge_property = std::array{"padding", "margin", "border-style"};
+    static constexpr auto shorthand_edge_property =
+            std::array{"padding", "margin", "border-style", "border-width", "border-color"};
 
     static constexpr auto absolute_size_keywords =
             std::array{"xx-small", "x-small", "small", "medium", "large", "x-large", "xx-large", "xxx-large"};
@@ -195,8 +207,9 @@ private:
     css::Rule parse_rule() {
         Rule rule{};
         while (peek() != '{') {
-            auto selector = consume_while([](char c) { return c != ',' && c != '{'; });
+            auto selector = consume_until_any_of(",{");
             rule.selectors.push_back(std::string{util::trim(selector)});
+            rule.selector_specificities.push_back(specificity(rule.selectors.back()));
             skip_if_neq('{'); // ' ' or ','
             skip_whitespace_and_comments();
         }
@@ -216,16 +229,16 @@ private:
     }
 
     std::pair<std::string_view, std::string_view> parse_declaration() {
-        auto name = consume_while([](char c) { return c != ':'; });
+        auto name = consume_until(':');
         consume_char(); // :
         skip_whitespace_and_comments();
-        auto value = consume_while([](char c) { return c != ';' && c != '}'; });
+        auto value = consume_until_any_of(";}");
         skip_if_neq('}'); // ;
         return {name, value};
     }
 
     void add_declaration(
-            std::map<PropertyId, std::string> &declarations, std::string_view name, std::string_view value) const {
+            std::map<PropertyId, Value> &declarations, std::string_view name, std::string_view value) const {
         if (is_shorthand_edge_property(name)) {
             expand_edge_values(declarations, std::string{name}, value);
         } else if (name == "background") {
@@ -245,7 +258,7 @@ private:
 
     // https://developer.mozilla.org/en-US/docs/Web/CSS/border
     void expand_border(
-            std::string_view name, std::map<PropertyId, std::string> &declarations, std::string_view value) const {
+            std::string_view name, std::map<PropertyId, Value> &declarations, std::string_view value) const {
         if (name == "border") {
             expand_border_impl(BorderSide::Left, declarations, value);
             expand_border_impl(BorderSide::Right, declarations, value);
@@ -263,7 +276,7 @@ private:
     }
 
     void expand_border_impl(
-            BorderSide side, std::map<PropertyId, std::string> &declarations, std::string_view value) const {
+            BorderSide side, std::map<PropertyId, Value> &declarations, std::string_view value) const {
         auto [color_id, style_id, width_id] = [&] {
             switch (side) {
                 case BorderSide::Left:
@@ -329,7 +342,7 @@ private:
 
     // https://developer.mozilla.org/en-US/docs/Web/CSS/background
     // TODO(robinlinden): This only handles a color being named, and assumes any single item listed is a color.
-    static void expand_background(std::map<PropertyId, std::string> &declarations, std::string_view value) {
+    static void expand_background(std::map<PropertyId, Value> &declarations, std::string_view value) {
         declarations[PropertyId::BackgroundImage] = "none";
         declarations[PropertyId::BackgroundPosition] = "0% 0%";
         declarations[PropertyId::BackgroundSize] = "auto auto";
@@ -346,7 +359,7 @@ private:
     }
 
     // https://developer.mozilla.org/en-US/docs/Web/CSS/border-radius
-    static void expand_border_radius_values(std::map<PropertyId, std::string> &declarations, std::string_view value) {
+    static void expand_border_radius_values(std::map<PropertyId, Value> &declarations, std::string_view value) {
         std::string top_left, top_right, bottom_right, bottom_left;
         auto [horizontal, vertical] = util::split_once(value, "/");
         Tokenizer tokenizer(horizontal, ' ');
@@ -418,7 +431,7 @@ private:
     }
 
     void expand_edge_values(
-            std::map<PropertyId, std::string> &declarations, std::string property, std::string_view value) const {
+            std::map<PropertyId, Value> &declarations, std::string property, std::string_view value) const {
         std::string_view top = "", bottom = "", left = "", right = "";
         Tokenizer tokenizer(value, ' ');
         switch (tokenizer.size()) {
@@ -444,10 +457,12 @@ private:
                 break;
         }
         std::string post_fix{""};
-        if (property == "border-style") {
-            // border-style is a bit special as we want border-top-style instead of border-style-top-style.
+        if (property.starts_with("border-")) {
+            // border-style is a bit special as we want border-top-style instead
+            // of border-style-top-style, and the same goes for border-width and
+            // border-color.
+            post_fix = property.substr(std::strlen("border"));
             property = "border";
-            post_fix = "-style";
         }
         declarations.insert_or_assign(
                 property_id_from_string(fmt::format("{}-top{}", property, post_fix)), std::string{top});
@@ -459,7 +474,7 @@ private:
                 property_id_from_string(fmt::format("{}-right{}", property, post_fix)), std::string{right});
     }
 
-    void expand_font(std::map<PropertyId, std::string> &declarations, std::string_view value) const {
+    void expand_font(std::map<PropertyId, Value> &declarations, std::string_view value) const {
         Tokenizer tokenizer(value, ' ');
         if (tokenizer.size() == 1) {
             // TODO(mkiael): Handle system properties correctly. Just forward it for now.
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "css/default.h"
+#include "css/parse.h"
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+
+namespace {
+
+// Synthetic but representative framework-style CSS: tag, class, and id
+// selectors, selector lists, shorthands, and the occasional comment. Repeated
+// until the requested size is reached.
+std::string framework_sheet_of_roughly(std::size_t wanted_size) {
+    static constexpr auto kFragment =
+            ".btn, .btn-primary, button { display: block; padding: 4px 8px; margin: 0; "
+            "color: #fff; background-color: #0d6efd; border-style: solid; border-width: thin; }\n"
+            "/* cards hold most of the page content */\n"
+            ".card { width: auto; max-width: 100%; min-height: 10em; font-size: 0.875rem; }\n"
+            "#site-header h1 { font-size: 2em; color: rgb(33, 37, 41); }\n"
+            "p a:link { color: blue; }\n"sv;
+
+    std::string sheet;
+    sheet.reserve(wanted_size + kFragment.size());
+    while (sheet.size() < wanted_size) {
+        sheet += kFragment;
+    }
+    return sheet;
+}
+
+// Lots of small rules spread over @media blocks, which stress the at-rule and
+// media-query paths rather than declaration parsing.
+std::string media_query_sheet_of_roughly(std::size_t wanted_size) {
+    static constexpr auto kFragment =
+            "@media screen { p { font-size: 1em; } }\n"
+            "@media (min-width: 768px) { .col { width: 50%; } .row { margin: 0 auto; } }\n"
+            "@media print { a { color: black; } }\n"sv;
+
+    std::string sheet;
+    sheet.reserve(wanted_size + kFragment.size());
+    while (sheet.size() < wanted_size) {
+        sheet += kFragment;
+    }
+    return sheet;
+}
+
+struct BenchmarkResult {
+    std::size_t bytes{};
+    std::size_t rules{};
+    std::chrono::nanoseconds elapsed{};
+};
+
+BenchmarkResult run_once(std::string_view sheet) {
+    auto start = std::chrono::steady_clock::now();
+    auto rules = css::parse(sheet);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return {sheet.size(), rules.size(), elapsed};
+}
+
+void benchmark(std::string_view name, std::string_view sheet, int repetitions) {
+    BenchmarkResult best{};
+    for (int i = 0; i < repetitions; ++i) {
+        auto result = run_once(sheet);
+        if (best.elapsed == std::chrono::nanoseconds::zero() || result.elapsed < best.elapsed) {
+            best = result;
+        }
+    }
+
+    auto seconds = std::chrono::duration<double>(best.elapsed).count();
+    fmt::print("{}: {} bytes, {} rules, {:.3f} ms, {:.1f} MB/s, {:.0f} rules/s\n",
+            name,
+            best.bytes,
+            best.rules,
+            seconds * 1000.,
+            static_cast<double>(best.bytes) / seconds / 1'000'000.,
+            static_cast<double>(best.rules) / seconds);
+}
+
+} // namespace
+
+int main() {
+    // The built-in style, parsed the same way a navigation would.
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto const &rules = css::default_style();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        fmt::print("default_style: {} rules, {:.3f} us first parse\n",
+                rules.size(),
+                std::chrono::duration<double>(elapsed).count() * 1'000'000.);
+    }
+
+    benchmark("framework small", framework_sheet_of_roughly(std::size_t{16} * 1024), 200);
+    benchmark("framework large", framework_sheet_of_roughly(std::size_t{1800} * 1024), 10);
+    benchmark("media queries", media_query_sheet_of_roughly(std::size_t{256} * 1024), 50);
+}
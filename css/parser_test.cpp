@@ -31,7 +31,7 @@ namespace {
 }
 
 auto const initial_background_values =
-        std::map<css::PropertyId, std::string>{{css::PropertyId::BackgroundImage, "none"},
+        std::map<css::PropertyId, css::Value>{{css::PropertyId::BackgroundImage, "none"},
                 {css::PropertyId::BackgroundPosition, "0% 0%"},
                 {css::PropertyId::BackgroundSize, "auto auto"},
                 {css::PropertyId::BackgroundRepeat, "repeat"},
@@ -40,14 +40,14 @@ auto const initial_background_values =
                 {css::PropertyId::BackgroundAttachment, "scroll"},
                 {css::PropertyId::BackgroundColor, "transparent"}};
 
-bool check_initial_background_values(std::map<css::PropertyId, std::string> const &declarations) {
+bool check_initial_background_values(std::map<css::PropertyId, css::Value> const &declarations) {
     return std::ranges::all_of(declarations, [](auto const &decl) {
         auto it = initial_background_values.find(decl.first);
         return it != cend(initial_background_values) && it->second == decl.second;
     });
 }
 
-auto const initial_font_values = std::map<css::PropertyId, std::string>{{css::PropertyId::FontStretch, "normal"},
+auto const initial_font_values = std::map<css::PropertyId, css::Value>{{css::PropertyId::FontStretch, "normal"},
         {css::PropertyId::FontVariant, "normal"},
         {css::PropertyId::FontWeight, "normal"},
         {css::PropertyId::LineHeight, "normal"},
@@ -66,7 +66,7 @@ auto const initial_font_values = std::map<css::PropertyId, std::string>{{css::Pr
         {css::PropertyId::FontVariantPosition, "normal"},
         {css::PropertyId::FontVariantEastAsian, "normal"}};
 
-bool check_initial_font_values(std::map<css::PropertyId, std::string> const &declarations) {
+bool check_initial_font_values(std::map<css::PropertyId, css::Value> const &declarations) {
     return std::ranges::all_of(declarations, [](auto const &decl) {
         auto it = initial_font_values.find(decl.first);
         return it != cend(initial_font_values) && it->second == decl.second;
@@ -100,6 +100,7 @@ int main() {
         expect_eq(rules,
                 std::vector<css::Rule>{{
                         .selectors{{"p a"}},
+                        .selector_specificities{2},
                         .declarations{{css::PropertyId::Color, "green"}},
                 }});
     });
@@ -270,10 +271,15 @@ int main() {
         auto rules = css::parse("@media screen { p { font-size: 1em; } } @media print { a { color: blue; } }");
         require_eq(rules.size(), std::size_t{2});
         expect_eq(rules[0],
-                css::Rule{
-                        .selectors{{"p"}}, .declarations{{css::PropertyId::FontSize, "1em"}}, .media_query{"screen"}});
+                css::Rule{.selectors{{"p"}},
+                        .selector_specificities{1},
+                        .declarations{{css::PropertyId::FontSize, "1em"}},
+                        .media_query{"screen"}});
         expect_eq(rules[1],
-                css::Rule{.selectors{{"a"}}, .declarations{{css::PropertyId::Color, "blue"}}, .media_query{"print"}});
+                css::Rule{.selectors{{"a"}},
+                        .selector_specificities{1},
+                        .declarations{{css::PropertyId::Color, "blue"}},
+                        .media_query{"print"}});
     });
 
     auto box_shorthand_one_value = [](std::string property, std::string value, std::string post_fix = "") {
@@ -281,7 +287,7 @@ int main() {
             auto rules = css::parse(fmt::format("p {{ {}: {}; }}"sv, property, value));
             require(rules.size() == 1);
 
-            if (property == "border-style") {
+            if (property.starts_with("border-")) {
                 property = "border";
             }
 
@@ -306,6 +312,11 @@ int main() {
         std::string border_style{"dashed"};
         etest::test("parser: shorthand border-style, one value",
                 box_shorthand_one_value("border-style", border_style, "-style"));
+
+        etest::test("parser: shorthand border-width, one value",
+                box_shorthand_one_value("border-width", "thin", "-width"));
+        etest::test("parser: shorthand border-color, one value",
+                box_shorthand_one_value("border-color", "#aabbcc", "-color"));
     }
 
     auto box_shorthand_two_values = [](std::string property,
@@ -315,7 +326,7 @@ int main() {
             auto rules = css::parse(fmt::format("p {{ {}: {} {}; }}"sv, property, values[0], values[1]));
             require(rules.size() == 1);
 
-            if (property == "border-style") {
+            if (property.starts_with("border-")) {
                 property = "border";
             }
 
@@ -340,6 +351,14 @@ int main() {
         auto border_styles = std::array{"dashed"s, "solid"s};
         etest::test("parser: shorthand border-style, two values",
                 box_shorthand_two_values("border-style", border_styles, "-style"));
+
+        auto border_widths = std::array{"thin"s, "thick"s};
+        etest::test("parser: shorthand border-width, two values",
+                box_shorthand_two_values("border-width", border_widths, "-width"));
+
+        auto border_colors = std::array{"red"s, "blue"s};
+        etest::test("parser: shorthand border-color, two values",
+                box_shorthand_two_values("border-color", border_colors, "-color"));
     }
 
     auto box_shorthand_three_values = [](std::string property,
@@ -349,7 +368,7 @@ int main() {
             auto rules = css::parse(fmt::format("p {{ {}: {} {} {}; }}"sv, property, values[0], values[1], values[2]));
             require(rules.size() == 1);
 
-            if (property == "border-style") {
+            if (property.starts_with("border-")) {
                 property = "border";
             }
 
@@ -384,7 +403,7 @@ int main() {
                     fmt::format("p {{ {}: {} {} {} {}; }}"sv, property, values[0], values[1], values[2], values[3]));
             require(rules.size() == 1);
 
-            if (property == "border-style") {
+            if (property.starts_with("border-")) {
                 property = "border";
             }
 
@@ -430,7 +449,7 @@ int main() {
                     workaround_for_border_style));
             require(rules.size() == 1);
 
-            if (property == "border-style") {
+            if (property.starts_with("border-")) {
                 property = "border";
             }
 
@@ -477,7 +496,7 @@ int main() {
                     workaround_for_border_style));
             require(rules.size() == 1);
 
-            if (property == "border-style") {
+            if (property.starts_with("border-")) {
                 property = "border";
             }
 
@@ -732,7 +751,7 @@ int main() {
         require(rules.size() == 1);
         auto const &div = rules[0];
         expect_eq(div.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderTopLeftRadius, "5px"s},
                         {css::PropertyId::BorderTopRightRadius, "5px"s},
                         {css::PropertyId::BorderBottomRightRadius, "5px"s},
@@ -745,7 +764,7 @@ int main() {
         require(rules.size() == 1);
         auto const &div = rules[0];
         expect_eq(div.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderTopLeftRadius, "1px"s},
                         {css::PropertyId::BorderTopRightRadius, "2px"s},
                         {css::PropertyId::BorderBottomRightRadius, "1px"s},
@@ -758,7 +777,7 @@ int main() {
         require(rules.size() == 1);
         auto const &div = rules[0];
         expect_eq(div.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderTopLeftRadius, "1px"s},
                         {css::PropertyId::BorderTopRightRadius, "2px"s},
                         {css::PropertyId::BorderBottomRightRadius, "3px"s},
@@ -771,7 +790,7 @@ int main() {
         require(rules.size() == 1);
         auto const &div = rules[0];
         expect_eq(div.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderTopLeftRadius, "1px"s},
                         {css::PropertyId::BorderTopRightRadius, "2px"s},
                         {css::PropertyId::BorderBottomRightRadius, "3px"s},
@@ -784,7 +803,7 @@ int main() {
         require(rules.size() == 1);
         auto const &div = rules[0];
         expect_eq(div.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderTopLeftRadius, "5px / 10px"s},
                         {css::PropertyId::BorderTopRightRadius, "5px / 10px"s},
                         {css::PropertyId::BorderBottomRightRadius, "5px / 10px"s},
@@ -797,7 +816,7 @@ int main() {
         require(rules.size() == 1);
         auto const &div = rules[0];
         expect_eq(div.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderTopLeftRadius, "5px / 10px"s},
                         {css::PropertyId::BorderTopRightRadius, "5px / 15px"s},
                         {css::PropertyId::BorderBottomRightRadius, "5px / 10px"s},
@@ -810,7 +829,7 @@ int main() {
         require(rules.size() == 1);
         auto const &div = rules[0];
         expect_eq(div.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderTopLeftRadius, "5px / 10px"s},
                         {css::PropertyId::BorderTopRightRadius, "5px / 15px"s},
                         {css::PropertyId::BorderBottomRightRadius, "5px / 20px"s},
@@ -823,7 +842,7 @@ int main() {
         require(rules.size() == 1);
         auto const &div = rules[0];
         expect_eq(div.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderTopLeftRadius, "5px / 10px"s},
                         {css::PropertyId::BorderTopRightRadius, "5px / 15px"s},
                         {css::PropertyId::BorderBottomRightRadius, "5px / 20px"s},
@@ -881,8 +900,8 @@ int main() {
 
         // Very incorrect.
         auto const &src = rules[0].declarations.at(css::PropertyId::Unknown);
-        expect(src.contains(R"(url("/fonts/OpenSans-Regular-webfont.woff2") format("woff2"))"));
-        expect(src.contains(R"(url("/fonts/OpenSans-Regular-webfont.woff") format("woff")"));
+        expect(src.raw.contains(R"(url("/fonts/OpenSans-Regular-webfont.woff2") format("woff2"))"));
+        expect(src.raw.contains(R"(url("/fonts/OpenSans-Regular-webfont.woff") format("woff")"));
     });
 
     etest::test("parser: border shorthand, all values", [] {
@@ -890,7 +909,7 @@ int main() {
         require(rules.size() == 1);
         auto const &p = rules[0];
         expect_eq(p.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderBottomColor, "black"s},
                         {css::PropertyId::BorderBottomStyle, "solid"s},
                         {css::PropertyId::BorderBottomWidth, "5px"s},
@@ -911,7 +930,7 @@ int main() {
         require(rules.size() == 1);
         auto const &p = rules[0];
         expect_eq(p.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderBottomColor, "#123"s},
                         {css::PropertyId::BorderBottomStyle, "dotted"s},
                         {css::PropertyId::BorderBottomWidth, "medium"s},
@@ -923,7 +942,7 @@ int main() {
         require(rules.size() == 1);
         auto const &p = rules[0];
         expect_eq(p.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderLeftColor, "currentcolor"s},
                         {css::PropertyId::BorderLeftStyle, "ridge"s},
                         {css::PropertyId::BorderLeftWidth, "30em"s},
@@ -935,7 +954,7 @@ int main() {
         require(rules.size() == 1);
         auto const &p = rules[0];
         expect_eq(p.declarations,
-                std::map<css::PropertyId, std::string>{
+                std::map<css::PropertyId, css::Value>{
                         {css::PropertyId::BorderRightColor, "currentcolor"s},
                         {css::PropertyId::BorderRightStyle, "none"s},
                         {css::PropertyId::BorderRightWidth, "thin"s},
@@ -946,7 +965,7 @@ int main() {
         auto rules = css::parse("p { border-top: outset #123 none solid; }");
         require(rules.size() == 1);
         auto const &p = rules[0];
-        expect_eq(p.declarations, std::map<css::PropertyId, std::string>{});
+        expect_eq(p.declarations, std::map<css::PropertyId, css::Value>{});
     });
 
     return etest::run_all_tests();
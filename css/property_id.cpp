@@ -1,19 +1,25 @@
-// SPDX-FileCopyrightText: 2022 Robin Lindén <dev@robinlinden.eu>
+// SPDX-FileCopyrightText: 2022-2023 Robin Lindén <dev@robinlinden.eu>
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
 #include "css/property_id.h"
 
-#include <algorithm>
-#include <map>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string_view>
+#include <utility>
 
 using namespace std::literals;
 
 namespace css {
 namespace {
 
-std::map<std::string_view, PropertyId> const kKnownProperties{
+// The property set is closed and known at compile time, so the name lookup
+// is a perfect hash: a table size is picked at compile time such that every
+// known name hashes to its own slot, making lookups one hash, one probe, and
+// one comparison, with no allocations.
+constexpr std::array<std::pair<std::string_view, PropertyId>, 92> kKnownProperties{{
         {"azimuth"sv, PropertyId::Azimuth},
         {"background-attachment"sv, PropertyId::BackgroundAttachment},
         {"background-clip"sv, PropertyId::BackgroundClip},
@@ -106,25 +112,85 @@ std::map<std::string_view, PropertyId> const kKnownProperties{
         {"widows"sv, PropertyId::Widows},
         {"width"sv, PropertyId::Width},
         {"word-spacing"sv, PropertyId::WordSpacing},
+}};
+
+// FNV-1a.
+constexpr std::uint64_t hashed(std::string_view str) {
+    std::uint64_t hash = 0xcbf2'9ce4'8422'2325;
+    for (char c : str) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 0x100'0000'01b3;
+    }
+
+    return hash;
+}
+
+constexpr std::size_t kMaxTableSize{1024};
+
+// The smallest table size where no two known property names share a slot.
+consteval std::size_t collision_free_table_size() {
+    for (std::size_t size = kKnownProperties.size(); size < kMaxTableSize; ++size) {
+        std::array<bool, kMaxTableSize> used{};
+        bool collision{false};
+        for (auto const &[name, id] : kKnownProperties) {
+            auto slot = hashed(name) % size;
+            collision = collision || used[slot];
+            used[slot] = true;
+        }
+
+        if (!collision) {
+            return size;
+        }
+    }
+
+    return 0;
+}
+
+constexpr std::size_t kTableSize = collision_free_table_size();
+static_assert(kTableSize != 0, "No collision-free table size found, pick a different hash");
+
+struct TableEntry {
+    std::string_view name{};
+    PropertyId id{PropertyId::Unknown};
 };
 
+constexpr auto kPropertyTable = [] {
+    std::array<TableEntry, kTableSize> table{};
+    for (auto const &[name, id] : kKnownProperties) {
+        table[hashed(name) % kTableSize] = {name, id};
+    }
+
+    return table;
+}();
+
+constexpr auto kPropertyNames = [] {
+    std::array<std::string_view, kKnownProperties.size() + 1> names{};
+    names[0] = "unknown"sv;
+    for (auto const &[name, id] : kKnownProperties) {
+        names[static_cast<std::size_t>(id)] = name;
+    }
+
+    return names;
+}();
+
 } // namespace
 
 PropertyId property_id_from_string(std::string_view id) {
-    if (!kKnownProperties.contains(id)) {
+    auto const &entry = kPropertyTable[hashed(id) % kTableSize];
+    if (entry.name != id) {
         return PropertyId::Unknown;
     }
 
-    return kKnownProperties.at(id);
+    return entry.id;
 }
 
 std::string_view to_string(PropertyId id) {
-    auto it = std::ranges::find_if(kKnownProperties, [id](auto const &entry) { return entry.second == id; });
-    if (it != end(kKnownProperties)) {
-        return it->first;
+    auto idx = static_cast<std::size_t>(id);
+    if (idx >= kPropertyNames.size()) {
+        return "unknown"sv;
     }
 
-    return "unknown"sv;
+    return kPropertyNames[idx];
 }
 
 } // namespace css
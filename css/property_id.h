@@ -158,6 +158,51 @@ constexpr bool is_inherited(PropertyId id) {
     }
 }
 
+// Whether a change to this property can move boxes around, i.e. whether
+// restyling with a new value requires a relayout or only a repaint. Anything
+// not known to be paint-only counts as layout-affecting, so new properties
+// are handled conservatively until someone classifies them. Note that the
+// border styles gate the border widths, so they affect layout here.
+constexpr bool is_layout_affecting(PropertyId id) {
+    switch (id) {
+        case css::PropertyId::Azimuth:
+        case css::PropertyId::BackgroundAttachment:
+        case css::PropertyId::BackgroundClip:
+        case css::PropertyId::BackgroundColor:
+        case css::PropertyId::BackgroundImage:
+        case css::PropertyId::BackgroundOrigin:
+        case css::PropertyId::BackgroundPosition:
+        case css::PropertyId::BackgroundRepeat:
+        case css::PropertyId::BackgroundSize:
+        case css::PropertyId::BorderBottomColor:
+        case css::PropertyId::BorderBottomLeftRadius:
+        case css::PropertyId::BorderBottomRightRadius:
+        case css::PropertyId::BorderLeftColor:
+        case css::PropertyId::BorderRightColor:
+        case css::PropertyId::BorderTopColor:
+        case css::PropertyId::BorderTopLeftRadius:
+        case css::PropertyId::BorderTopRightRadius:
+        case css::PropertyId::Color:
+        case css::PropertyId::Cursor:
+        case css::PropertyId::Elevation:
+        case css::PropertyId::Pitch:
+        case css::PropertyId::PitchRange:
+        case css::PropertyId::Richness:
+        case css::PropertyId::Speak:
+        case css::PropertyId::SpeakHeader:
+        case css::PropertyId::SpeakNumeral:
+        case css::PropertyId::SpeakPunctuation:
+        case css::PropertyId::SpeechRate:
+        case css::PropertyId::Stress:
+        case css::PropertyId::Visibility:
+        case css::PropertyId::VoiceFamily:
+        case css::PropertyId::Volume:
+            return false;
+        default:
+            return true;
+    }
+}
+
 } // namespace css
 
 #endif
@@ -35,5 +35,19 @@ int main() {
         }
     });
 
+    etest::test("is_layout_affecting", [] {
+        expect(css::is_layout_affecting(css::PropertyId::Width));
+        expect(css::is_layout_affecting(css::PropertyId::FontSize));
+        expect(css::is_layout_affecting(css::PropertyId::Display));
+        // Border style gates the border width, so it moves things around.
+        expect(css::is_layout_affecting(css::PropertyId::BorderLeftStyle));
+        // Properties we don't know are assumed to affect layout.
+        expect(css::is_layout_affecting(css::PropertyId::Unknown));
+
+        expect(!css::is_layout_affecting(css::PropertyId::Color));
+        expect(!css::is_layout_affecting(css::PropertyId::BackgroundColor));
+        expect(!css::is_layout_affecting(css::PropertyId::BorderTopColor));
+    });
+
     return etest::run_all_tests();
 }
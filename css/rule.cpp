@@ -6,11 +6,74 @@
 
 #include "css/property_id.h"
 
+#include "util/string.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
 #include <sstream>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace css {
 
+std::size_t merge_duplicates(std::vector<Rule> &rules) {
+    // Selectors can't contain '\n', so joining with it can't make two
+    // different selector lists produce the same key.
+    std::map<std::string, std::size_t, std::less<>> first_occurrence;
+    std::vector<Rule> merged;
+    merged.reserve(rules.size());
+
+    for (auto &rule : rules) {
+        std::string key;
+        for (auto const &selector : rule.selectors) {
+            key += selector;
+            key += '\n';
+        }
+        key += rule.media_query;
+
+        if (auto it = first_occurrence.find(key); it != first_occurrence.end()) {
+            auto &target = merged[it->second].declarations;
+            for (auto &[property, value] : rule.declarations) {
+                target.insert_or_assign(property, std::move(value));
+            }
+            continue;
+        }
+
+        first_occurrence.emplace(std::move(key), merged.size());
+        merged.push_back(std::move(rule));
+    }
+
+    auto dropped = rules.size() - merged.size();
+    rules = std::move(merged);
+    return dropped;
+}
+
+std::uint32_t specificity(std::string_view selector) {
+    std::uint32_t ids{};
+    std::uint32_t classes{};
+    std::uint32_t types{};
+
+    for (auto part : util::LazySplit{selector, " "}) {
+        auto [compound, psuedo_class] = util::split_once(part, ":");
+
+        if (!psuedo_class.empty()) {
+            ++classes;
+        }
+
+        if (compound.starts_with('.')) {
+            ++classes;
+        } else if (compound.starts_with('#')) {
+            ++ids;
+        } else if (!compound.empty() && compound != "*") {
+            ++types;
+        }
+    }
+
+    return ids << 20 | classes << 10 | types;
+}
+
 std::string to_string(Rule const &rule) {
     std::stringstream ss;
     ss << "Selectors:";
@@ -26,7 +89,7 @@ std::string to_string(Rule const &rule) {
     ss << '\n';
     ss << "Declarations:\n";
     for (auto const &[property, value] : rule.declarations) {
-        ss << "  " << to_string(property) << ": " << value << '\n';
+        ss << "  " << to_string(property) << ": " << value.raw << '\n';
     }
     if (!rule.media_query.empty()) {
         ss << "Media query:\n";
@@ -8,9 +8,29 @@
 
 #include "etest/etest.h"
 
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using etest::expect;
 using etest::expect_eq;
 
 int main() {
+    etest::test("specificity", [] {
+        expect_eq(css::specificity("*"), 0u);
+        expect_eq(css::specificity("div"), 1u);
+        expect_eq(css::specificity(".fancy"), 1u << 10);
+        expect_eq(css::specificity("#unique"), 1u << 20);
+        expect_eq(css::specificity(":link"), 1u << 10);
+        expect_eq(css::specificity("a:link"), (1u << 10) + 1);
+        expect_eq(css::specificity(".fancy:link"), 2u << 10);
+
+        expect_eq(css::specificity("#unique"), css::specificity("#unique"));
+        expect(css::specificity("#unique") > css::specificity(".fancy"));
+        expect(css::specificity(".fancy") > css::specificity("div"));
+        expect(css::specificity("div") > css::specificity("*"));
+    });
+
     etest::test("rule to string, one selector and declaration", [] {
         css::Rule rule;
         rule.selectors.emplace_back("div");
@@ -57,5 +77,34 @@ int main() {
         expect_eq(css::to_string(rule), expected);
     });
 
+    etest::test("merge duplicates, later declarations win", [] {
+        std::vector<css::Rule> rules{
+                {.selectors = {"p"}, .declarations = {{css::PropertyId::Color, "red"}}},
+                {.selectors = {"div"}, .declarations = {{css::PropertyId::Color, "green"}}},
+                {.selectors = {"p"},
+                        .declarations = {{css::PropertyId::Color, "blue"}, {css::PropertyId::Width, "10px"}}},
+        };
+
+        expect_eq(css::merge_duplicates(rules), std::size_t{1});
+        expect_eq(rules.size(), std::size_t{2});
+        expect_eq(rules[0].selectors, std::vector<std::string>{"p"});
+        expect_eq(rules[0].declarations.at(css::PropertyId::Color).raw, "blue");
+        expect_eq(rules[0].declarations.at(css::PropertyId::Width).raw, "10px");
+        expect_eq(rules[1].selectors, std::vector<std::string>{"div"});
+    });
+
+    etest::test("merge duplicates, media queries and selector lists key the merge", [] {
+        std::vector<css::Rule> rules{
+                {.selectors = {"p"}, .declarations = {{css::PropertyId::Color, "red"}}},
+                {.selectors = {"p"},
+                        .declarations = {{css::PropertyId::Color, "green"}},
+                        .media_query = "(min-width: 900px)"},
+                {.selectors = {"p", "div"}, .declarations = {{css::PropertyId::Color, "blue"}}},
+        };
+
+        expect_eq(css::merge_duplicates(rules), std::size_t{0});
+        expect_eq(rules.size(), std::size_t{3});
+    });
+
     return etest::run_all_tests();
 }
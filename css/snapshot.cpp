@@ -0,0 +1,207 @@
+// SPDX-FileCopyrightText: 2021-2022 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "css/snapshot.h"
+
+#include "css/property_id.h"
+#include "css/value.h"
+
+#include "os/os.h"
+
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace css {
+namespace {
+
+constexpr auto kMagic = "hastur-style-snapshot 1"sv;
+
+// The front line of rest, consumed. The format is line-framed, so a missing
+// final newline means a snapshot that was cut off mid-write.
+std::optional<std::string_view> take_line(std::string_view &rest) {
+    auto end = rest.find('\n');
+    if (end == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    auto line = rest.substr(0, end);
+    rest.remove_prefix(end + 1);
+    return line;
+}
+
+std::optional<std::uint64_t> parse_hex(std::string_view text) {
+    std::uint64_t value{};
+    auto const *end = text.data() + text.size();
+    if (auto [ptr, ec] = std::from_chars(text.data(), end, value, 16); ec != std::errc{} || ptr != end) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+} // namespace
+
+std::uint64_t style_sheet_hash(std::string_view css) {
+    // FNV-1a.
+    std::uint64_t hash = 0xcbf2'9ce4'8422'2325;
+    for (unsigned char byte : css) {
+        hash ^= byte;
+        hash *= 0x100'0000'01b3;
+    }
+
+    return hash;
+}
+
+std::optional<std::string> serialize_style_snapshot(std::span<Rule const> rules, std::uint64_t source_hash) {
+    static constexpr auto kHexDigits = "0123456789abcdef"sv;
+
+    std::string out{kMagic};
+    out += ' ';
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        out += kHexDigits[(source_hash >> shift) & 0xf];
+    }
+    out += '\n';
+
+    // Fields are tab-separated with one free-form field per line, placed
+    // last so it can contain tabs. Newlines would break the framing, but
+    // nothing a style sheet parse produces contains them.
+    for (auto const &rule : rules) {
+        if (rule.media_query.contains('\n')) {
+            return std::nullopt;
+        }
+
+        out += "rule\t";
+        out += rule.media_query;
+        out += '\n';
+
+        for (std::size_t i = 0; i < rule.selectors.size(); ++i) {
+            if (rule.selectors[i].contains('\n')) {
+                return std::nullopt;
+            }
+
+            out += "sel\t";
+            out += std::to_string(rule.selector_specificities[i]);
+            out += '\t';
+            out += rule.selectors[i];
+            out += '\n';
+        }
+
+        for (auto const &[id, value] : rule.declarations) {
+            if (value.raw.contains('\n')) {
+                return std::nullopt;
+            }
+
+            out += "decl\t";
+            out += to_string(id);
+            out += '\t';
+            out += value.raw;
+            out += '\n';
+        }
+    }
+
+    return out;
+}
+
+std::optional<std::vector<Rule>> deserialize_style_snapshot(std::string_view snapshot, std::uint64_t source_hash) {
+    auto header = take_line(snapshot);
+    if (!header || !header->starts_with(kMagic) || header->size() <= kMagic.size() + 1) {
+        return std::nullopt;
+    }
+
+    if (parse_hex(header->substr(kMagic.size() + 1)) != source_hash) {
+        return std::nullopt;
+    }
+
+    std::vector<Rule> rules;
+    while (!snapshot.empty()) {
+        auto line = take_line(snapshot);
+        if (!line) {
+            return std::nullopt;
+        }
+
+        auto tab = line->find('\t');
+        if (tab == std::string_view::npos) {
+            return std::nullopt;
+        }
+
+        auto kind = line->substr(0, tab);
+        auto rest = line->substr(tab + 1);
+
+        if (kind == "rule"sv) {
+            rules.push_back({.media_query = std::string{rest}});
+            continue;
+        }
+
+        if (rules.empty()) {
+            return std::nullopt;
+        }
+
+        auto &rule = rules.back();
+        if (kind == "sel"sv) {
+            auto second_tab = rest.find('\t');
+            if (second_tab == std::string_view::npos) {
+                return std::nullopt;
+            }
+
+            auto specificity_str = rest.substr(0, second_tab);
+            std::uint32_t selector_specificity{};
+            auto const *end = specificity_str.data() + specificity_str.size();
+            if (std::from_chars(specificity_str.data(), end, selector_specificity).ptr != end) {
+                return std::nullopt;
+            }
+
+            rule.selectors.emplace_back(rest.substr(second_tab + 1));
+            rule.selector_specificities.push_back(selector_specificity);
+        } else if (kind == "decl"sv) {
+            auto second_tab = rest.find('\t');
+            if (second_tab == std::string_view::npos) {
+                return std::nullopt;
+            }
+
+            // The Value constructor re-resolves the typed form, so only the
+            // raw text is stored.
+            rule.declarations.emplace(
+                    property_id_from_string(rest.substr(0, second_tab)), Value{std::string{rest.substr(second_tab + 1)}});
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    return rules;
+}
+
+std::optional<std::vector<Rule>> load_style_snapshot(std::string const &path, std::uint64_t source_hash) {
+    auto mapped = os::MemoryMappedFile::map(path);
+    if (!mapped) {
+        return std::nullopt;
+    }
+
+    return deserialize_style_snapshot(mapped->view(), source_hash);
+}
+
+bool save_style_snapshot(std::string const &path, std::span<Rule const> rules, std::uint64_t source_hash) {
+    auto serialized = serialize_style_snapshot(rules, source_hash);
+    if (!serialized) {
+        return false;
+    }
+
+    std::error_code errc;
+    std::filesystem::create_directories(std::filesystem::path{path}.parent_path(), errc);
+
+    std::ofstream file{path, std::ios::trunc};
+    file << *std::move(serialized);
+    return bool{file};
+}
+
+} // namespace css
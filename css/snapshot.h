@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2021-2022 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef CSS_SNAPSHOT_H_
+#define CSS_SNAPSHOT_H_
+
+#include "css/rule.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace css {
+
+// Startup snapshots of parsed style sheets.
+//
+// Parsing the built-in style sheet is identical work on every launch, which
+// adds up when the browser is restarted often. A snapshot stores the parsed
+// rules on disk, tagged with a format version and a hash of the source text,
+// so launches after the first load the result instead of re-parsing. See
+// default_style() for the consumer.
+
+// A stable hash of the style sheet text, for checking that a snapshot was
+// built from the same source that's asking for it.
+std::uint64_t style_sheet_hash(std::string_view css);
+
+// Serializes rules so deserialize_style_snapshot can bring them back.
+// Returns std::nullopt for rules a snapshot can't hold (embedded newlines);
+// callers fall back to parsing like the snapshot wasn't there.
+std::optional<std::string> serialize_style_snapshot(std::span<Rule const> rules, std::uint64_t source_hash);
+
+// The rules stored in a snapshot, or std::nullopt when it's damaged, from
+// another snapshot version, or built from different source text.
+std::optional<std::vector<Rule>> deserialize_style_snapshot(std::string_view snapshot, std::uint64_t source_hash);
+
+// As above, over the file at path.
+std::optional<std::vector<Rule>> load_style_snapshot(std::string const &path, std::uint64_t source_hash);
+bool save_style_snapshot(std::string const &path, std::span<Rule const> rules, std::uint64_t source_hash);
+
+} // namespace css
+
+#endif
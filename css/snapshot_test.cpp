@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2021-2022 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "css/snapshot.h"
+
+#include "css/parse.h"
+
+#include "etest/etest.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+using etest::expect;
+using etest::expect_eq;
+
+namespace {
+constexpr auto kSheet = "p { color: #abcdef; font-size: 10px; }\n"
+                        "@media (min-width: 900px) { a, a:visited { width: 50%; } }";
+} // namespace
+
+int main() {
+    etest::test("round trip", [] {
+        auto rules = css::parse(kSheet);
+        auto hash = css::style_sheet_hash(kSheet);
+
+        auto snapshot = css::serialize_style_snapshot(rules, hash);
+        expect(snapshot.has_value());
+        expect_eq(css::deserialize_style_snapshot(*snapshot, hash), rules);
+    });
+
+    etest::test("source hash is validated", [] {
+        auto rules = css::parse(kSheet);
+        auto snapshot = css::serialize_style_snapshot(rules, css::style_sheet_hash(kSheet));
+        expect_eq(css::deserialize_style_snapshot(*snapshot, css::style_sheet_hash("p { color: red; }")),
+                std::nullopt);
+    });
+
+    etest::test("damaged snapshots are rejected", [] {
+        auto rules = css::parse(kSheet);
+        auto hash = css::style_sheet_hash(kSheet);
+        auto snapshot = *css::serialize_style_snapshot(rules, hash);
+
+        // Cut off mid-write.
+        expect_eq(css::deserialize_style_snapshot(std::string_view{snapshot}.substr(0, snapshot.size() - 5), hash),
+                std::nullopt);
+
+        // Not a snapshot at all.
+        expect_eq(css::deserialize_style_snapshot("beep boop\n", hash), std::nullopt);
+
+        // A selector or declaration with no rule to live in.
+        expect_eq(css::deserialize_style_snapshot(std::string{snapshot.substr(0, snapshot.find('\n') + 1)}
+                          + "sel\t1\tp\n",
+                          hash),
+                std::nullopt);
+    });
+
+    etest::test("file round trip", [] {
+        auto path = (std::filesystem::temp_directory_path() / "hastur-snapshot-test" / "default-style").string();
+        std::filesystem::remove_all(std::filesystem::path{path}.parent_path());
+
+        auto rules = css::parse(kSheet);
+        auto hash = css::style_sheet_hash(kSheet);
+        expect_eq(css::load_style_snapshot(path, hash), std::nullopt);
+
+        expect(css::save_style_snapshot(path, rules, hash));
+        expect_eq(css::load_style_snapshot(path, hash), rules);
+
+        std::filesystem::remove_all(std::filesystem::path{path}.parent_path());
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "css/value.h"
+
+#include "util/from_chars.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+using namespace std::literals;
+
+namespace css {
+namespace {
+
+// constexpr so that Values created during static initialization in other
+// translation units can't observe a not-yet-initialized keyword table.
+constexpr std::array<std::pair<std::string_view, Keyword>, 14> kKnownKeywords{{
+        {"auto"sv, Keyword::Auto},
+        {"block"sv, Keyword::Block},
+        {"canvastext"sv, Keyword::Canvastext},
+        {"currentcolor"sv, Keyword::Currentcolor},
+        {"inherit"sv, Keyword::Inherit},
+        {"initial"sv, Keyword::Initial},
+        {"inline"sv, Keyword::Inline},
+        {"italic"sv, Keyword::Italic},
+        {"medium"sv, Keyword::Medium},
+        {"none"sv, Keyword::None},
+        {"normal"sv, Keyword::Normal},
+        {"oblique"sv, Keyword::Oblique},
+        {"transparent"sv, Keyword::Transparent},
+        {"unset"sv, Keyword::Unset},
+}};
+
+std::optional<gfx::Color> try_from_hex_chars(std::string_view hex_chars) {
+    if (!hex_chars.starts_with('#')) {
+        return std::nullopt;
+    }
+
+    hex_chars.remove_prefix(1);
+    if (hex_chars.length() == 3 || hex_chars.length() == 4) {
+        // Expand #abc to #aabbcc and #abcd to #aabbccdd.
+        std::string expanded;
+        for (char c : hex_chars) {
+            expanded += c;
+            expanded += c;
+        }
+
+        std::uint32_t hex{};
+        if (std::from_chars(expanded.data(), expanded.data() + expanded.size(), hex, /*base*/ 16).ec != std::errc{}) {
+            return std::nullopt;
+        }
+
+        return hex_chars.length() == 3 ? gfx::Color::from_rgb(hex) : gfx::Color::from_rgba(hex);
+    }
+
+    if (hex_chars.length() == 6 || hex_chars.length() == 8) {
+        std::uint32_t hex{};
+        auto res = std::from_chars(hex_chars.data(), hex_chars.data() + hex_chars.size(), hex, /*base*/ 16);
+        if (res.ec != std::errc{} || res.ptr != hex_chars.data() + hex_chars.size()) {
+            return std::nullopt;
+        }
+
+        return hex_chars.length() == 6 ? gfx::Color::from_rgb(hex) : gfx::Color::from_rgba(hex);
+    }
+
+    return std::nullopt;
+}
+
+ParsedValue parse(std::string_view raw) {
+    if (auto keyword = keyword_from_string(raw)) {
+        return *keyword;
+    }
+
+    if (auto color = try_from_hex_chars(raw)) {
+        return *color;
+    }
+
+    if (auto named_color = gfx::Color::from_css_name(raw)) {
+        return *named_color;
+    }
+
+    float number{};
+    auto res = util::from_chars(raw.data(), raw.data() + raw.size(), number);
+    if (res.ec != std::errc{}) {
+        return std::monostate{};
+    }
+
+    auto unit = raw.substr(std::distance(raw.data(), res.ptr));
+    if (unit.empty()) {
+        // "0" is a valid length no matter what unit the property wants.
+        if (number == 0) {
+            return Length{};
+        }
+
+        return number;
+    }
+
+    if (unit == "px"sv) {
+        return Length{number, Length::Unit::Px};
+    }
+
+    if (unit == "em"sv) {
+        return Length{number, Length::Unit::Em};
+    }
+
+    if (unit == "rem"sv) {
+        return Length{number, Length::Unit::Rem};
+    }
+
+    if (unit == "%"sv) {
+        return Length{number, Length::Unit::Percent};
+    }
+
+    return std::monostate{};
+}
+
+} // namespace
+
+std::optional<Keyword> keyword_from_string(std::string_view keyword) {
+    auto it = std::ranges::find(kKnownKeywords, keyword, &std::pair<std::string_view, Keyword>::first);
+    if (it != cend(kKnownKeywords)) {
+        return it->second;
+    }
+
+    return std::nullopt;
+}
+
+std::string_view to_string(Keyword keyword) {
+    for (auto const &[name, value] : kKnownKeywords) {
+        if (value == keyword) {
+            return name;
+        }
+    }
+
+    return "unknown"sv;
+}
+
+Value::Value(std::string v) : raw{std::move(v)}, parsed{parse(raw)} {}
+
+} // namespace css
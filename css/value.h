@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef CSS_VALUE_H_
+#define CSS_VALUE_H_
+
+#include "gfx/color.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+namespace css {
+
+// Keywords that can appear as a complete property value. Values using keywords
+// we don't type yet stay untyped and are consumed via their raw text.
+enum class Keyword {
+    Auto,
+    Block,
+    Canvastext,
+    Currentcolor,
+    Inherit,
+    Initial,
+    Inline,
+    Italic,
+    Medium,
+    None,
+    Normal,
+    Oblique,
+    Transparent,
+    Unset,
+};
+
+std::optional<Keyword> keyword_from_string(std::string_view);
+std::string_view to_string(Keyword);
+
+struct Length {
+    enum class Unit {
+        Px,
+        Em,
+        Rem,
+        Percent,
+    };
+
+    float value{};
+    Unit unit{Unit::Px};
+
+    [[nodiscard]] bool operator==(Length const &) const = default;
+};
+
+// std::monostate is used for values we can't type yet. They only provide
+// their raw text.
+using ParsedValue = std::variant<std::monostate, Keyword, Length, float, gfx::Color>;
+
+// A declaration value. The typed form is resolved once when the value is
+// created so consumers don't have to re-parse the raw text on every use.
+struct Value {
+    std::string raw;
+    ParsedValue parsed;
+
+    Value() = default;
+    // NOLINTNEXTLINE(google-explicit-constructor): Implicit on purpose, this is the only way to create one.
+    Value(std::string);
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    Value(std::string_view v) : Value{std::string{v}} {}
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    Value(char const *v) : Value{std::string{v}} {}
+
+    [[nodiscard]] bool operator==(Value const &) const = default;
+};
+
+} // namespace css
+
+#endif
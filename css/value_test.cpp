@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "css/value.h"
+
+#include "etest/etest.h"
+
+#include <variant>
+
+using namespace std::literals;
+using etest::expect;
+using etest::expect_eq;
+
+int main() {
+    etest::test("keywords", [] {
+        expect_eq(css::Value{"auto"}.parsed, css::ParsedValue{css::Keyword::Auto});
+        expect_eq(css::Value{"inherit"}.parsed, css::ParsedValue{css::Keyword::Inherit});
+        expect_eq(css::Value{"none"}.parsed, css::ParsedValue{css::Keyword::None});
+        expect_eq(css::keyword_from_string("not-a-keyword"), std::nullopt);
+        expect_eq(css::to_string(css::Keyword::Currentcolor), "currentcolor"sv);
+    });
+
+    etest::test("lengths", [] {
+        expect_eq(css::Value{"80px"}.parsed, css::ParsedValue{css::Length{80.f, css::Length::Unit::Px}});
+        expect_eq(css::Value{"1.5em"}.parsed, css::ParsedValue{css::Length{1.5f, css::Length::Unit::Em}});
+        expect_eq(css::Value{"2rem"}.parsed, css::ParsedValue{css::Length{2.f, css::Length::Unit::Rem}});
+        expect_eq(css::Value{"50%"}.parsed, css::ParsedValue{css::Length{50.f, css::Length::Unit::Percent}});
+        // A unitless zero is a valid length.
+        expect_eq(css::Value{"0"}.parsed, css::ParsedValue{css::Length{}});
+    });
+
+    etest::test("numbers", [] {
+        expect_eq(css::Value{"2"}.parsed, css::ParsedValue{2.f});
+        expect_eq(css::Value{"1.25"}.parsed, css::ParsedValue{1.25f});
+    });
+
+    etest::test("colors", [] {
+        expect_eq(css::Value{"#abc"}.parsed, css::ParsedValue{gfx::Color::from_rgb(0xaabbcc)});
+        expect_eq(css::Value{"#abcd"}.parsed, css::ParsedValue{gfx::Color::from_rgba(0xaabbccdd)});
+        expect_eq(css::Value{"#123456"}.parsed, css::ParsedValue{gfx::Color::from_rgb(0x123456)});
+        expect_eq(css::Value{"#12345678"}.parsed, css::ParsedValue{gfx::Color::from_rgba(0x12345678)});
+        expect_eq(css::Value{"red"}.parsed, css::ParsedValue{gfx::Color{0xFF, 0, 0}});
+    });
+
+    etest::test("untyped values keep their raw text", [] {
+        auto value = css::Value{"arial, sans-serif"};
+        expect(std::holds_alternative<std::monostate>(value.parsed));
+        expect_eq(value.raw, "arial, sans-serif");
+
+        expect(std::holds_alternative<std::monostate>(css::Value{"#12345"}.parsed));
+        expect(std::holds_alternative<std::monostate>(css::Value{"#nothex"}.parsed));
+        expect(std::holds_alternative<std::monostate>(css::Value{"10pc"}.parsed));
+    });
+
+    etest::test("equality", [] {
+        expect_eq(css::Value{"80px"}, css::Value{"80px"sv});
+        expect(css::Value{"80px"} != css::Value{"80em"});
+    });
+
+    return etest::run_all_tests();
+}
@@ -6,22 +6,26 @@
 #define CSS2_TOKEN_H_
 
 #include <string>
+#include <string_view>
 #include <variant>
 
 namespace css2 {
 
+// Payload-carrying tokens hold views of the text they were tokenized from
+// (or of storage owned by the tokenizer when streaming), so copying a token
+// is cheap and tokenizing doesn't allocate per token.
 struct IdentToken {
-    std::string data{};
+    std::string_view data{};
     [[nodiscard]] bool operator==(IdentToken const &) const = default;
 };
 
 struct FunctionToken {
-    std::string data{};
+    std::string_view data{};
     [[nodiscard]] bool operator==(FunctionToken const &) const = default;
 };
 
 struct AtKeywordToken {
-    std::string data{};
+    std::string_view data{};
     [[nodiscard]] bool operator==(AtKeywordToken const &) const = default;
 };
 
@@ -31,12 +35,12 @@ struct HashToken {
         Id,
     };
     Type type{Type::Unrestricted};
-    std::string data{};
+    std::string_view data{};
     [[nodiscard]] bool operator==(HashToken const &) const = default;
 };
 
 struct StringToken {
-    std::string data{};
+    std::string_view data{};
     [[nodiscard]] bool operator==(StringToken const &) const = default;
 };
 
@@ -45,7 +49,7 @@ struct BadStringToken {
 };
 
 struct UrlToken {
-    std::string data{};
+    std::string_view data{};
     [[nodiscard]] bool operator==(UrlToken const &) const = default;
 };
 
@@ -78,7 +82,7 @@ struct PercentageToken {
 struct DimensionToken {
     NumericType type{NumericType::Integer};
     std::variant<int, double> data{};
-    std::string unit{};
+    std::string_view unit{};
     [[nodiscard]] bool operator==(DimensionToken const &) const = default;
 };
 
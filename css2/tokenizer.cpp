@@ -6,8 +6,11 @@
 #include "css2/tokenizer.h"
 
 #include "util/string.h"
+#include "util/trace.h"
 
+#include <cassert>
 #include <exception>
+#include <vector>
 
 namespace css2 {
 
@@ -25,7 +28,14 @@ constexpr bool is_ident_code_point(char c) {
 } // namespace
 
 void Tokenizer::run() {
+    util::trace::Span span{"css2::Tokenizer::run"};
     while (true) {
+        // When streaming, pause until the next feed() or finish() instead of
+        // mistaking the end of the current chunk for the end of the input.
+        if (!input_complete_ && needs_more_input()) {
+            return;
+        }
+
         switch (state_) {
             case State::Main: {
                 auto c = consume_next_input_character();
@@ -34,7 +44,7 @@ void Tokenizer::run() {
                 }
 
                 if (inputs_starts_ident_sequence(*c)) {
-                    temporary_buffer_ = *c;
+                    token_start_ = pos_ - 1;
                     state_ = State::IdentLike;
                     continue;
                 }
@@ -48,7 +58,7 @@ void Tokenizer::run() {
                     case '\'':
                     case '"':
                         string_ending_ = *c;
-                        current_token_ = StringToken{""};
+                        token_start_ = pos_;
                         state_ = State::String;
                         continue;
                     case '/':
@@ -145,7 +155,7 @@ void Tokenizer::run() {
                 }
 
                 if (inputs_starts_ident_sequence(*c)) {
-                    temporary_buffer_ = *c;
+                    token_start_ = pos_ - 1;
                     state_ = State::CommercialAtIdent;
                     continue;
                 }
@@ -158,19 +168,18 @@ void Tokenizer::run() {
             case State::CommercialAtIdent: {
                 auto c = consume_next_input_character();
                 if (!c) {
-                    emit(AtKeywordToken{temporary_buffer_});
+                    emit(AtKeywordToken{payload(token_start_, input_.size())});
                     return;
                 }
 
                 if (is_ident_code_point(*c)) {
-                    temporary_buffer_ += *c;
                     continue;
                 } else if (*c == '\\') {
                     // TODO(mkiael): Handle escaped code point
                     std::terminate();
                 }
 
-                emit(AtKeywordToken{temporary_buffer_});
+                emit(AtKeywordToken{payload(token_start_, pos_ - 1)});
                 reconsume_in(State::Main);
                 continue;
             }
@@ -178,12 +187,11 @@ void Tokenizer::run() {
             case State::IdentLike: {
                 auto c = consume_next_input_character();
                 if (!c) {
-                    emit(IdentToken{temporary_buffer_});
+                    emit(IdentToken{payload(token_start_, input_.size())});
                     return;
                 }
 
                 if (is_ident_code_point(*c)) {
-                    temporary_buffer_ += *c;
                     continue;
                 } else if (*c == '\\') {
                     // TODO(mkiael): Handle escaped code point
@@ -192,7 +200,7 @@ void Tokenizer::run() {
 
                 // TODO(mkiael): Handle url and function token
 
-                emit(IdentToken{temporary_buffer_});
+                emit(IdentToken{payload(token_start_, pos_ - 1)});
                 reconsume_in(State::Main);
                 continue;
             }
@@ -201,12 +209,12 @@ void Tokenizer::run() {
                 auto c = consume_next_input_character();
                 if (!c) {
                     emit(ParseError::EofInString);
-                    emit(std::move(current_token_));
+                    emit(StringToken{payload(token_start_, input_.size())});
                     return;
                 }
 
                 if (*c == string_ending_) {
-                    emit(std::move(current_token_));
+                    emit(StringToken{payload(token_start_, pos_ - 1)});
                     state_ = State::Main;
                     continue;
                 }
@@ -221,7 +229,6 @@ void Tokenizer::run() {
                         reconsume_in(State::Main);
                         continue;
                     default:
-                        std::get<StringToken>(current_token_).data.append(1, *c);
                         continue;
                 }
             }
@@ -248,6 +255,26 @@ void Tokenizer::run() {
     }
 }
 
+void Tokenizer::feed(std::string_view input) {
+    if (input_lifetime_ == InputLifetime::StableAndContiguous) {
+        // The caller promised this chunk directly follows the previous one in
+        // a buffer that outlives the tokens, so it can be read in place.
+        assert(input_.empty() || input_.data() + input_.size() == input.data());
+        input_ = input_.empty() ? input : std::string_view{input_.data(), input_.size() + input.size()};
+        run();
+        return;
+    }
+
+    stream_buffer_ += input;
+    input_ = stream_buffer_;
+    run();
+}
+
+void Tokenizer::finish() {
+    input_complete_ = true;
+    run();
+}
+
 void Tokenizer::emit(ParseError e) {
     on_error_(e);
 }
@@ -256,6 +283,18 @@ void Tokenizer::emit(Token &&token) {
     on_emit_(std::move(token));
 }
 
+// The bytes of a token's payload. When the input is stable the token can view
+// it directly; for transient chunks, the bytes are pinned into owned storage
+// so later feed() calls can't move them out from under the token.
+std::string_view Tokenizer::payload(std::size_t begin, std::size_t end) {
+    auto bytes = input_.substr(begin, end - begin);
+    if (input_lifetime_ == InputLifetime::StableAndContiguous) {
+        return bytes;
+    }
+
+    return streamed_payloads_.emplace_back(bytes);
+}
+
 std::optional<char> Tokenizer::consume_next_input_character() {
     if (is_eof()) {
         pos_ += 1;
@@ -293,9 +332,47 @@ bool Tokenizer::is_eof() const {
     return pos_ >= input_.size();
 }
 
+bool Tokenizer::needs_more_input() const {
+    // The most we ever look ahead is the current character plus one peeked
+    // character when checking if the input starts an ident sequence.
+    return pos_ + 2 > input_.size();
+}
+
 void Tokenizer::reconsume_in(State state) {
     --pos_;
     state_ = state;
 }
 
+util::Generator<Token> tokenize(std::string_view input, std::size_t chunk_size) {
+    std::vector<Token> pending;
+    // The chunks are consecutive slices of the caller's input, so tokens can
+    // view it directly instead of being pinned into tokenizer-owned storage
+    // that'd die before the caller is done with them.
+    Tokenizer tokenizer{[&pending](Token &&token) { pending.push_back(std::move(token)); },
+            [](ParseError) {},
+            nullptr,
+            InputLifetime::StableAndContiguous};
+
+    while (!input.empty()) {
+        auto chunk = input.substr(0, chunk_size);
+        input.remove_prefix(chunk.size());
+        tokenizer.feed(chunk);
+        for (auto &token : pending) {
+            co_yield std::move(token);
+        }
+        pending.clear();
+    }
+
+    tokenizer.finish();
+    for (auto &token : pending) {
+        co_yield std::move(token);
+    }
+}
+
+void tokenize_into(std::string_view input, std::vector<Token> &out) {
+    out.clear();
+    Tokenizer tokenizer{input, [&out](Token &&token) { out.push_back(std::move(token)); }, [](ParseError) {}};
+    tokenizer.run();
+}
+
 } // namespace css2
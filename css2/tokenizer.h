@@ -8,10 +8,17 @@
 
 #include "css2/token.h"
 
+#include "util/generator.h"
+
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <list>
 #include <optional>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace css2 {
 
@@ -34,35 +41,124 @@ enum class ParseError {
     NewlineInString,
 };
 
+// Whether the storage behind chunks handed to feed() outlives the emitted
+// tokens. Transient chunks are copied into an internal buffer and token
+// payloads pinned into storage owned by the tokenizer (or its scratch, when
+// given one). Chunks that are consecutive slices of one stable buffer can be
+// read in place instead, making payloads zero-copy views of that buffer.
+enum class InputLifetime {
+    Transient,
+    StableAndContiguous,
+};
+
+// Buffers a tokenizer accumulates into while running. Callers tokenizing
+// many stylesheets can keep one of these and hand it to each tokenizer so
+// the buffers keep their capacity between runs.
+struct TokenizerScratch {
+    std::string stream_buffer{};
+    // Payload bytes of tokens emitted while streaming. Owning them here lets
+    // those tokens outlive the tokenizer that emitted them; they stay valid
+    // until the scratch is handed to the next tokenizer.
+    std::list<std::string> streamed_payloads{};
+};
+
 class Tokenizer {
 public:
-    Tokenizer(std::string_view input, std::function<void(Token &&)> on_emit, std::function<void(ParseError)> on_error)
-        : input_(input), on_emit_(on_emit), on_error_(on_error) {}
+    // Token payloads emitted by this tokenizer are views into input, so they
+    // stay valid as long as the input does.
+    Tokenizer(std::string_view input,
+            std::function<void(Token &&)> on_emit,
+            std::function<void(ParseError)> on_error,
+            TokenizerScratch *scratch = nullptr)
+        : input_(input), on_emit_(on_emit), on_error_(on_error), scratch_{scratch} {
+        borrow_scratch();
+    }
+
+    // Creates a tokenizer for streaming use where the stylesheet isn't
+    // available up-front. Call feed() as chunks arrive and finish() once the
+    // whole stylesheet has been received.
+    Tokenizer(std::function<void(Token &&)> on_emit,
+            std::function<void(ParseError)> on_error,
+            TokenizerScratch *scratch = nullptr,
+            InputLifetime input_lifetime = InputLifetime::Transient)
+        : input_complete_{false},
+          input_lifetime_{input_lifetime},
+          on_emit_(on_emit),
+          on_error_(on_error),
+          scratch_{scratch} {
+        borrow_scratch();
+    }
+
+    ~Tokenizer() {
+        if (scratch_ != nullptr) {
+            scratch_->stream_buffer = std::move(stream_buffer_);
+            scratch_->streamed_payloads = std::move(streamed_payloads_);
+        }
+    }
+
+    Tokenizer(Tokenizer const &) = delete;
+    Tokenizer &operator=(Tokenizer const &) = delete;
 
     void run();
 
+    // Appends a chunk of input and tokenizes as far as the new data allows.
+    // Only valid for tokenizers created for streaming use.
+    void feed(std::string_view);
+
+    // Signals that no more input will arrive and tokenizes what remains.
+    void finish();
+
 private:
     std::string_view input_;
+    std::string stream_buffer_{};
+    bool input_complete_{true};
+    // Input handed over up-front is the caller's to keep alive, so the
+    // whole-input constructor behaves like the stable streaming mode.
+    InputLifetime input_lifetime_{InputLifetime::StableAndContiguous};
     std::size_t pos_{0};
     State state_{State::Main};
-    Token current_token_{};
+    // Where in input_ the payload of the token being built starts. Offsets
+    // survive feed() growing the stream buffer; pointers wouldn't.
+    std::size_t token_start_{0};
 
     char string_ending_{};
 
-    std::string temporary_buffer_{};
+    std::list<std::string> streamed_payloads_{};
 
     std::function<void(Token &&)> on_emit_;
     std::function<void(ParseError)> on_error_;
+    TokenizerScratch *scratch_{nullptr};
+
+    void borrow_scratch() {
+        if (scratch_ != nullptr) {
+            stream_buffer_ = std::move(scratch_->stream_buffer);
+            stream_buffer_.clear();
+            streamed_payloads_ = std::move(scratch_->streamed_payloads);
+            streamed_payloads_.clear();
+        }
+    }
 
     void emit(ParseError);
     void emit(Token &&);
+    std::string_view payload(std::size_t begin, std::size_t end);
     std::optional<char> consume_next_input_character();
     std::optional<char> peek_input(int index) const;
     bool inputs_starts_ident_sequence(char first_character) const;
     bool is_eof() const;
+    bool needs_more_input() const;
     void reconsume_in(State);
 };
 
+// Pull-based frontend to the tokenizer: consumers take tokens on demand
+// instead of being driven through a callback. The input is fed to the
+// tokenizer roughly chunk_size bytes at a time, so only about a chunk is
+// tokenized ahead of the consumer. Token payloads are views into input.
+util::Generator<Token> tokenize(std::string_view input, std::size_t chunk_size = 4096);
+
+// Tokenizes the whole input into out, reusing out's capacity. Token payloads
+// are views into input and are valid for as long as it is.
+void tokenize_into(std::string_view input, std::vector<Token> &out);
+
 } // namespace css2
 
 #endif
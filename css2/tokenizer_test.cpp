@@ -7,6 +7,10 @@
 
 #include "etest/etest.h"
 
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <variant>
 #include <vector>
 
 using etest::expect;
@@ -27,6 +31,8 @@ public:
     std::vector<Token> tokens;
     std::vector<ParseError> errors;
     etest::source_location loc;
+    // Streamed token payloads live in the scratch once the tokenizer is gone.
+    TokenizerScratch scratch;
 };
 
 TokenizerOutput run_tokenizer(std::string_view input, etest::source_location loc = etest::source_location::current()) {
@@ -41,6 +47,23 @@ TokenizerOutput run_tokenizer(std::string_view input, etest::source_location loc
     return {std::move(tokens), std::move(errors), std::move(loc)};
 }
 
+TokenizerOutput run_tokenizer_in_chunks(
+        std::vector<std::string_view> chunks, etest::source_location loc = etest::source_location::current()) {
+    TokenizerOutput output{.loc = std::move(loc)};
+    {
+        // Destroyed before returning so the streamed payloads it owns have
+        // made it into the scratch.
+        Tokenizer tokenizer{[&](Token &&t) { output.tokens.push_back(std::move(t)); },
+                [&](ParseError e) { output.errors.push_back(e); },
+                &output.scratch};
+        for (auto chunk : chunks) {
+            tokenizer.feed(chunk);
+        }
+        tokenizer.finish();
+    }
+    return output;
+}
+
 void expect_token(
         TokenizerOutput &output, Token t, etest::source_location const &loc = etest::source_location::current()) {
     require(!output.tokens.empty(), "Unexpected end of token list", loc);
@@ -305,5 +328,94 @@ int main() {
         expect_token(output, CloseCurlyToken{});
     });
 
+    etest::test("streaming, chunk boundaries inside tokens", [] {
+        auto streamed = run_tokenizer_in_chunks({"bod", "y { wi", "dth: 1", "0px; }"});
+        auto batch = run_tokenizer("body { width: 10px; }");
+
+        expect(streamed.tokens == batch.tokens);
+        expect(streamed.errors == batch.errors);
+        streamed.tokens.clear();
+        batch.tokens.clear();
+    });
+
+    etest::test("streaming, tokens are emitted as chunks arrive", [] {
+        std::vector<Token> tokens;
+        Tokenizer tokenizer{[&](Token &&t) { tokens.push_back(std::move(t)); }, [](ParseError) {}};
+
+        tokenizer.feed("a; b");
+        expect_eq(tokens.size(), std::size_t{2});
+        expect_eq(tokens[0], Token{IdentToken{"a"}});
+        expect_eq(tokens[1], Token{SemiColonToken{}});
+
+        tokenizer.finish();
+        expect_eq(tokens.size(), std::size_t{4});
+        expect_eq(tokens[2], Token{WhitespaceToken{}});
+        expect_eq(tokens[3], Token{IdentToken{"b"}});
+    });
+
+    etest::test("streaming, scratch buffers keep their capacity between runs", [] {
+        TokenizerScratch scratch{};
+
+        auto tokenize = [&](std::string_view input) {
+            std::vector<Token> tokens;
+            Tokenizer tokenizer{[&](Token &&t) { tokens.push_back(std::move(t)); }, [](ParseError) {}, &scratch};
+            tokenizer.feed(input);
+            tokenizer.finish();
+            return tokens;
+        };
+
+        std::ignore = tokenize("body { width: 10px; }");
+        auto grown_capacity = scratch.stream_buffer.capacity();
+        expect(grown_capacity > 0);
+
+        // The second run borrows the already-grown buffer instead of
+        // starting from an empty one.
+        auto tokens = tokenize("a; b");
+        expect_eq(scratch.stream_buffer.capacity(), grown_capacity);
+        expect_eq(tokens.size(), std::size_t{4});
+        expect_eq(tokens[0], Token{IdentToken{"a"}});
+    });
+
+    etest::test("generator frontend", [] {
+        // A tiny chunk size so the input actually gets fed in pieces.
+        auto gen = css2::tokenize("a; b", 2);
+
+        std::vector<Token> tokens;
+        while (gen.has_next()) {
+            tokens.push_back(gen.next());
+        }
+
+        expect_eq(tokens.size(), std::size_t{4});
+        expect_eq(tokens[0], Token{IdentToken{"a"}});
+        expect_eq(tokens[1], Token{SemiColonToken{}});
+        expect_eq(tokens[2], Token{WhitespaceToken{}});
+        expect_eq(tokens[3], Token{IdentToken{"b"}});
+    });
+
+    etest::test("token payloads are views into the input", [] {
+        std::string_view input{"@media screen"};
+        auto output = run_tokenizer(input);
+
+        require(!output.tokens.empty());
+        auto const &at_keyword = std::get<AtKeywordToken>(output.tokens.front());
+        expect_eq(at_keyword.data, "media");
+        // No copy: the payload points straight into the input text.
+        expect(at_keyword.data.data() == input.data() + 1);
+        output.tokens.clear();
+    });
+
+    etest::test("tokenize_into reuses the output vector", [] {
+        std::vector<Token> tokens;
+        tokenize_into("a; b", tokens);
+        expect_eq(tokens.size(), std::size_t{4});
+        expect_eq(tokens[0], Token{IdentToken{"a"}});
+
+        auto capacity = tokens.capacity();
+        tokenize_into("c", tokens);
+        expect_eq(tokens.size(), std::size_t{1});
+        expect_eq(tokens[0], Token{IdentToken{"c"}});
+        expect_eq(tokens.capacity(), capacity);
+    });
+
     return etest::run_all_tests();
 }
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef DOM_ATTR_MAP_H_
+#define DOM_ATTR_MAP_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dom {
+
+// Maps attribute names to values. Elements rarely have more than a handful of
+// attributes, so a flat sorted vector beats a node-based map in both lookup
+// cost and allocation count.
+class AttrMap {
+public:
+    using value_type = std::pair<std::string, std::string>;
+    using const_iterator = std::vector<value_type>::const_iterator;
+
+    AttrMap() = default;
+
+    AttrMap(std::initializer_list<value_type> attributes) {
+        for (auto const &[name, value] : attributes) {
+            insert_or_assign(name, value);
+        }
+    }
+
+    [[nodiscard]] bool contains(std::string_view name) const { return find(name) != attributes_.end(); }
+
+    [[nodiscard]] std::string const &at(std::string_view name) const {
+        auto it = find(name);
+        if (it == attributes_.end()) {
+            throw std::out_of_range{std::string{name}};
+        }
+        return it->second;
+    }
+
+    void insert_or_assign(std::string name, std::string value) {
+        auto it = std::ranges::lower_bound(attributes_, name, {}, &value_type::first);
+        if (it != attributes_.end() && it->first == name) {
+            it->second = std::move(value);
+            return;
+        }
+        attributes_.insert(it, {std::move(name), std::move(value)});
+    }
+
+    [[nodiscard]] bool empty() const { return attributes_.empty(); }
+    [[nodiscard]] std::size_t size() const { return attributes_.size(); }
+
+    [[nodiscard]] const_iterator begin() const { return attributes_.begin(); }
+    [[nodiscard]] const_iterator end() const { return attributes_.end(); }
+
+    [[nodiscard]] bool operator==(AttrMap const &) const = default;
+
+private:
+    std::vector<value_type> attributes_{};
+
+    [[nodiscard]] const_iterator find(std::string_view name) const {
+        auto it = std::ranges::lower_bound(attributes_, name, {}, &value_type::first);
+        if (it != attributes_.end() && it->first == name) {
+            return it;
+        }
+        return attributes_.end();
+    }
+};
+
+} // namespace dom
+
+#endif
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "dom/attr_map.h"
+
+#include "etest/etest.h"
+
+#include <stdexcept>
+
+using etest::expect;
+using etest::expect_eq;
+
+int main() {
+    etest::test("contains and at", [] {
+        dom::AttrMap attrs{{"href", "https://example.com"}, {"rel", "stylesheet"}};
+        expect(attrs.contains("href"));
+        expect(attrs.contains("rel"));
+        expect(!attrs.contains("class"));
+        expect_eq(attrs.at("href"), "https://example.com");
+        expect_eq(attrs.at("rel"), "stylesheet");
+    });
+
+    etest::test("at, missing attribute", [] {
+        dom::AttrMap attrs{};
+        bool threw{false};
+        try {
+            std::ignore = attrs.at("id");
+        } catch (std::out_of_range const &) {
+            threw = true;
+        }
+        expect(threw);
+    });
+
+    etest::test("insert_or_assign", [] {
+        dom::AttrMap attrs{};
+        expect(attrs.empty());
+
+        attrs.insert_or_assign("id", "a");
+        attrs.insert_or_assign("class", "b");
+        expect_eq(attrs.size(), std::size_t{2});
+        expect_eq(attrs.at("id"), "a");
+
+        attrs.insert_or_assign("id", "c");
+        expect_eq(attrs.size(), std::size_t{2});
+        expect_eq(attrs.at("id"), "c");
+    });
+
+    etest::test("equality is insertion-order independent", [] {
+        dom::AttrMap a{{"id", "a"}, {"class", "b"}};
+        dom::AttrMap b{{"class", "b"}, {"id", "a"}};
+        expect_eq(a, b);
+    });
+
+    return etest::run_all_tests();
+}
@@ -6,37 +6,71 @@
 
 #include "util/overloaded.h"
 
-#include <ostream>
-#include <sstream>
-#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <variant>
 
+using namespace std::literals;
+
 namespace dom {
 namespace {
 
-void print_node(dom::Node const &node, std::ostream &os, uint8_t depth = 0) {
-    for (std::uint8_t i = 0; i < depth; ++i) {
-        os << "  ";
-    }
+constexpr auto kTagPrefix = "tag: "sv;
+constexpr auto kValuePrefix = "value: "sv;
+
+// Exactly how many bytes serializing this node and its children will append.
+std::size_t serialized_size(dom::Node const &node, std::size_t depth = 0) {
+    return std::visit(util::Overloaded{
+                              [depth](dom::Element const &element) {
+                                  std::size_t size = depth * 2 + kTagPrefix.size() + element.name.size() + 1;
+                                  for (auto const &child : element.children) {
+                                      size += serialized_size(child, depth + 1);
+                                  }
+                                  return size;
+                              },
+                              [depth](dom::Text const &text) {
+                                  return depth * 2 + kValuePrefix.size() + text.text.size() + 1;
+                              },
+                      },
+            node);
+}
+
+void append_node(dom::Node const &node, std::string &out, std::uint8_t depth = 0) {
+    out.append(static_cast<std::size_t>(depth) * 2, ' ');
     std::visit(util::Overloaded{
-                       [&os, depth](dom::Element const &element) {
-                           os << "tag: " << element.name << '\n';
+                       [&out, depth](dom::Element const &element) {
+                           out += kTagPrefix;
+                           out += element.name;
+                           out += '\n';
                            for (auto const &child : element.children) {
-                               print_node(child, os, depth + 1);
+                               append_node(child, out, depth + 1);
                            }
                        },
-                       [&os](dom::Text const &text) { os << "value: " << text.text << '\n'; },
+                       [&out](dom::Text const &text) {
+                           out += kValuePrefix;
+                           out += text.text;
+                           out += '\n';
+                       },
                },
             node);
 }
 
 } // namespace
 
+void to_string(Document const &document, std::string &out) {
+    constexpr auto kDoctypePrefix = "doctype: "sv;
+    out.reserve(out.size() + kDoctypePrefix.size() + document.doctype.size() + 1 + serialized_size(document.html_node));
+    out += kDoctypePrefix;
+    out += document.doctype;
+    out += '\n';
+    append_node(document.html_node, out);
+}
+
 std::string to_string(Document const &document) {
-    std::stringstream ss;
-    ss << "doctype: " << document.doctype << '\n';
-    print_node(document.html_node, ss);
-    return std::move(ss).str();
+    std::string out;
+    to_string(document, out);
+    return out;
 }
 
 } // namespace dom
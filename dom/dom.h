@@ -5,8 +5,10 @@
 #ifndef DOM_DOM_H_
 #define DOM_DOM_H_
 
+#include "dom/attr_map.h"
+#include "dom/xpath.h"
+
 #include <cstddef>
-#include <map>
 #include <string>
 #include <string_view>
 #include <variant>
@@ -17,7 +19,6 @@ namespace dom {
 struct Text;
 struct Element;
 
-using AttrMap = std::map<std::string, std::string, std::less<>>;
 using Node = std::variant<Element, Text>;
 
 struct Text {
@@ -35,9 +36,17 @@ struct Element {
 struct Document {
     std::string doctype;
     Node html_node;
+    // Total number of nodes in html_node. Maintained by the parser so
+    // consumers can pre-size whole-tree buffers without a counting pass.
+    std::size_t node_count{};
     Element const &html() const { return std::get<Element>(html_node); }
     Element &html() { return std::get<Element>(html_node); }
-    [[nodiscard]] bool operator==(Document const &) const = default;
+
+    // node_count is derived from html_node, so it doesn't participate in
+    // equality; hand-built documents in tests rarely bother setting it.
+    [[nodiscard]] bool operator==(Document const &other) const {
+        return doctype == other.doctype && html_node == other.html_node;
+    }
 };
 
 inline std::string_view dom_name(Element const &e) {
@@ -56,50 +65,20 @@ inline std::vector<Element const *> dom_children(Element const &e) {
 
 // https://developer.mozilla.org/en-US/docs/Web/XPath
 // https://en.wikipedia.org/wiki/XPath
+// Callers querying the same path repeatedly should compile it into a
+// dom::XPath once and evaluate that instead.
 template<typename T>
 inline std::vector<T const *> nodes_by_xpath(T const &root, std::string_view xpath) {
-    std::vector<T const *> next_search{&root};
-    std::vector<T const *> searching{};
-    std::vector<T const *> goal_nodes{};
-
-    // We only support xpaths in the form /a/b/c right now.
-    if (!xpath.starts_with('/')) {
-        return {};
-    }
-    xpath.remove_prefix(1);
-
-    while (!next_search.empty()) {
-        searching.swap(next_search);
-        next_search.clear();
-
-        for (auto node : searching) {
-            auto name = dom_name(*node);
-            if (xpath == name) {
-                goal_nodes.push_back(node);
-                continue;
-            }
-
-            if (xpath.starts_with(name) && xpath.size() >= name.size() + 1 && xpath[name.size()] == '/') {
-                for (auto const *child : dom_children(*node)) {
-                    next_search.push_back(child);
-                }
-            }
-        }
-
-        // Remove name + separator.
-        std::size_t separator_position{xpath.find_first_of("/")};
-        if (separator_position == xpath.npos) {
-            break;
-        }
-
-        xpath.remove_prefix(separator_position + 1);
-    }
-
-    return goal_nodes;
+    return XPath{xpath}.matching(root);
 }
 
 std::string to_string(Document const &node);
 
+// Appends into out, reserving the exact size needed in one pass. Callers
+// serializing repeatedly can reuse the buffer instead of building a fresh
+// string every time.
+void to_string(Document const &node, std::string &out);
+
 } // namespace dom
 
 #endif
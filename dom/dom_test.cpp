@@ -6,6 +6,7 @@
 
 #include "etest/etest.h"
 
+#include <string>
 #include <string_view>
 #include <utility>
 
@@ -32,6 +33,10 @@ int main() {
         document.html_node = dom::Element{.name{"span"}, .children{{dom::Text{"hello"}}}};
         auto expected = "doctype: html5\ntag: span\n  value: hello\n"sv;
         expect_eq(to_string(document), expected);
+
+        std::string sink{"previous content\n"};
+        to_string(document, sink);
+        expect_eq(sink, "previous content\n" + std::string{expected});
     });
 
     etest::test("unsupported xpaths don't return anything", [] {
@@ -39,7 +44,7 @@ int main() {
         auto nodes = nodes_by_xpath(dom, "div");
         expect(nodes.empty());
 
-        nodes = nodes_by_xpath(dom, "//div");
+        nodes = nodes_by_xpath(dom, "/div/");
         expect(nodes.empty());
     });
 
@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "dom/tag_id.h"
+
+#include <algorithm>
+#include <map>
+#include <string_view>
+
+using namespace std::literals;
+
+namespace dom {
+namespace {
+
+std::map<std::string_view, TagId> const kKnownTags{
+        {"a"sv, TagId::A},
+        {"address"sv, TagId::Address},
+        {"area"sv, TagId::Area},
+        {"article"sv, TagId::Article},
+        {"aside"sv, TagId::Aside},
+        {"audio"sv, TagId::Audio},
+        {"b"sv, TagId::B},
+        {"base"sv, TagId::Base},
+        {"blockquote"sv, TagId::Blockquote},
+        {"body"sv, TagId::Body},
+        {"br"sv, TagId::Br},
+        {"button"sv, TagId::Button},
+        {"canvas"sv, TagId::Canvas},
+        {"caption"sv, TagId::Caption},
+        {"code"sv, TagId::Code},
+        {"col"sv, TagId::Col},
+        {"colgroup"sv, TagId::Colgroup},
+        {"dd"sv, TagId::Dd},
+        {"del"sv, TagId::Del},
+        {"details"sv, TagId::Details},
+        {"dialog"sv, TagId::Dialog},
+        {"div"sv, TagId::Div},
+        {"dl"sv, TagId::Dl},
+        {"dt"sv, TagId::Dt},
+        {"em"sv, TagId::Em},
+        {"embed"sv, TagId::Embed},
+        {"fieldset"sv, TagId::Fieldset},
+        {"figcaption"sv, TagId::Figcaption},
+        {"figure"sv, TagId::Figure},
+        {"footer"sv, TagId::Footer},
+        {"form"sv, TagId::Form},
+        {"h1"sv, TagId::H1},
+        {"h2"sv, TagId::H2},
+        {"h3"sv, TagId::H3},
+        {"h4"sv, TagId::H4},
+        {"h5"sv, TagId::H5},
+        {"h6"sv, TagId::H6},
+        {"head"sv, TagId::Head},
+        {"header"sv, TagId::Header},
+        {"hgroup"sv, TagId::Hgroup},
+        {"hr"sv, TagId::Hr},
+        {"html"sv, TagId::Html},
+        {"i"sv, TagId::I},
+        {"iframe"sv, TagId::Iframe},
+        {"img"sv, TagId::Img},
+        {"input"sv, TagId::Input},
+        {"ins"sv, TagId::Ins},
+        {"label"sv, TagId::Label},
+        {"legend"sv, TagId::Legend},
+        {"li"sv, TagId::Li},
+        {"link"sv, TagId::Link},
+        {"main"sv, TagId::Main},
+        {"map"sv, TagId::Map},
+        {"menu"sv, TagId::Menu},
+        {"meta"sv, TagId::Meta},
+        {"nav"sv, TagId::Nav},
+        {"noscript"sv, TagId::Noscript},
+        {"object"sv, TagId::Object},
+        {"ol"sv, TagId::Ol},
+        {"optgroup"sv, TagId::Optgroup},
+        {"option"sv, TagId::Option},
+        {"p"sv, TagId::P},
+        {"param"sv, TagId::Param},
+        {"picture"sv, TagId::Picture},
+        {"pre"sv, TagId::Pre},
+        {"script"sv, TagId::Script},
+        {"section"sv, TagId::Section},
+        {"select"sv, TagId::Select},
+        {"small"sv, TagId::Small},
+        {"source"sv, TagId::Source},
+        {"span"sv, TagId::Span},
+        {"strong"sv, TagId::Strong},
+        {"style"sv, TagId::Style},
+        {"sub"sv, TagId::Sub},
+        {"summary"sv, TagId::Summary},
+        {"sup"sv, TagId::Sup},
+        {"svg"sv, TagId::Svg},
+        {"table"sv, TagId::Table},
+        {"tbody"sv, TagId::Tbody},
+        {"td"sv, TagId::Td},
+        {"template"sv, TagId::Template},
+        {"textarea"sv, TagId::Textarea},
+        {"tfoot"sv, TagId::Tfoot},
+        {"th"sv, TagId::Th},
+        {"thead"sv, TagId::Thead},
+        {"time"sv, TagId::Time},
+        {"title"sv, TagId::Title},
+        {"tr"sv, TagId::Tr},
+        {"track"sv, TagId::Track},
+        {"u"sv, TagId::U},
+        {"ul"sv, TagId::Ul},
+        {"var"sv, TagId::Var},
+        {"video"sv, TagId::Video},
+        {"wbr"sv, TagId::Wbr},
+};
+
+} // namespace
+
+TagId tag_id_from_string(std::string_view name) {
+    if (auto it = kKnownTags.find(name); it != end(kKnownTags)) {
+        return it->second;
+    }
+
+    return TagId::Unknown;
+}
+
+std::string_view to_string(TagId id) {
+    auto it = std::ranges::find_if(kKnownTags, [id](auto const &entry) { return entry.second == id; });
+    if (it != end(kKnownTags)) {
+        return it->first;
+    }
+
+    return "unknown"sv;
+}
+
+} // namespace dom
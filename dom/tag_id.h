@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef DOM_TAG_ID_H_
+#define DOM_TAG_ID_H_
+
+#include <string_view>
+
+namespace dom {
+
+// Interned ids for the closed set of html tag names, shared between parsing,
+// the dom, and selector matching so hot paths can compare integers instead of
+// strings.
+enum class TagId {
+    Unknown,
+
+    A,
+    Address,
+    Area,
+    Article,
+    Aside,
+    Audio,
+    B,
+    Base,
+    Blockquote,
+    Body,
+    Br,
+    Button,
+    Canvas,
+    Caption,
+    Code,
+    Col,
+    Colgroup,
+    Dd,
+    Del,
+    Details,
+    Dialog,
+    Div,
+    Dl,
+    Dt,
+    Em,
+    Embed,
+    Fieldset,
+    Figcaption,
+    Figure,
+    Footer,
+    Form,
+    H1,
+    H2,
+    H3,
+    H4,
+    H5,
+    H6,
+    Head,
+    Header,
+    Hgroup,
+    Hr,
+    Html,
+    I,
+    Iframe,
+    Img,
+    Input,
+    Ins,
+    Label,
+    Legend,
+    Li,
+    Link,
+    Main,
+    Map,
+    Menu,
+    Meta,
+    Nav,
+    Noscript,
+    Object,
+    Ol,
+    Optgroup,
+    Option,
+    P,
+    Param,
+    Picture,
+    Pre,
+    Script,
+    Section,
+    Select,
+    Small,
+    Source,
+    Span,
+    Strong,
+    Style,
+    Sub,
+    Summary,
+    Sup,
+    Svg,
+    Table,
+    Tbody,
+    Td,
+    Template,
+    Textarea,
+    Tfoot,
+    Th,
+    Thead,
+    Time,
+    Title,
+    Tr,
+    Track,
+    U,
+    Ul,
+    Var,
+    Video,
+    Wbr,
+};
+
+TagId tag_id_from_string(std::string_view);
+std::string_view to_string(TagId);
+
+} // namespace dom
+
+#endif
@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "dom/tag_id.h"
+
+#include "etest/etest.h"
+
+#include <fmt/format.h>
+
+#include <string_view>
+
+using etest::expect;
+using etest::expect_eq;
+using namespace std::literals;
+
+int main() {
+    etest::test("tag_id_from_string", [] {
+        expect_eq(dom::tag_id_from_string("div"), dom::TagId::Div);
+        expect_eq(dom::tag_id_from_string("blink"), dom::TagId::Unknown);
+    });
+
+    etest::test("to_string", [] {
+        expect_eq(dom::to_string(dom::TagId::Div), "div");
+        expect_eq(dom::to_string(dom::TagId::Unknown), "unknown");
+    });
+
+    etest::test("all ids have strings", [] {
+        auto id = static_cast<int>(dom::TagId::Unknown) + 1;
+        // Requires a manual update every time we add something last in the enum.
+        while (id <= static_cast<int>(dom::TagId::Wbr)) {
+            expect(dom::to_string(static_cast<dom::TagId>(id)) != "unknown"sv,
+                    fmt::format("Tag {} is missing a string mapping", id));
+            id += 1;
+        }
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2021-2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef DOM_XPATH_H_
+#define DOM_XPATH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dom {
+
+// Compiled form of an xpath like /html/head/link.
+//
+// Parsing the path once into steps and evaluating those makes paths that are
+// queried on every navigation cheap, and evaluation works against any tree
+// that provides dom_name and dom_children.
+//
+// Only child (/) and descendant-or-self (//) steps are supported.
+class XPath {
+public:
+    explicit XPath(std::string_view xpath) {
+        if (!xpath.starts_with('/')) {
+            return;
+        }
+
+        while (!xpath.empty()) {
+            xpath.remove_prefix(1);
+            auto axis = Axis::Child;
+            if (xpath.starts_with('/')) {
+                axis = Axis::Descendant;
+                xpath.remove_prefix(1);
+            }
+
+            auto name_end = xpath.find('/');
+            auto name = xpath.substr(0, name_end);
+            if (name.empty()) {
+                // Malformed paths match nothing.
+                steps_.clear();
+                return;
+            }
+
+            steps_.push_back({axis, std::string{name}});
+            if (name_end == std::string_view::npos) {
+                break;
+            }
+
+            xpath.remove_prefix(name_end);
+        }
+    }
+
+    template<typename T>
+    [[nodiscard]] std::vector<T const *> matching(T const &root) const {
+        return evaluate(root, false);
+    }
+
+    template<typename T>
+    [[nodiscard]] T const *first_matching(T const &root) const {
+        auto nodes = evaluate(root, true);
+        return nodes.empty() ? nullptr : nodes.front();
+    }
+
+private:
+    enum class Axis : std::uint8_t {
+        Child,
+        Descendant,
+    };
+
+    struct Step {
+        Axis axis{};
+        std::string name;
+    };
+
+    std::vector<Step> steps_{};
+
+    template<typename T>
+    static void descendants_matching(
+            T const &node, std::string_view name, bool first_only, std::vector<T const *> &out) {
+        if (first_only && !out.empty()) {
+            return;
+        }
+
+        if (dom_name(node) == name) {
+            out.push_back(&node);
+            if (first_only) {
+                return;
+            }
+        }
+
+        for (auto const *child : dom_children(node)) {
+            descendants_matching(*child, name, first_only, out);
+        }
+    }
+
+    // The first step is matched against the root itself, later steps against
+    // the children of whatever the previous step matched.
+    template<typename T>
+    std::vector<T const *> evaluate(T const &root, bool first_only) const {
+        if (steps_.empty()) {
+            return {};
+        }
+
+        std::vector<T const *> current{&root};
+        std::vector<T const *> matched{};
+        for (std::size_t i = 0; i < steps_.size(); ++i) {
+            auto const &step = steps_[i];
+            bool last_step = i + 1 == steps_.size();
+
+            matched.clear();
+            for (auto const *node : current) {
+                if (step.axis == Axis::Child) {
+                    if (dom_name(*node) == step.name) {
+                        matched.push_back(node);
+                    }
+                } else {
+                    descendants_matching(*node, step.name, last_step && first_only, matched);
+                }
+
+                if (last_step && first_only && !matched.empty()) {
+                    return matched;
+                }
+            }
+
+            if (last_step) {
+                return matched;
+            }
+
+            current.clear();
+            for (auto const *node : matched) {
+                for (auto const *child : dom_children(*node)) {
+                    current.push_back(child);
+                }
+            }
+        }
+
+        return {};
+    }
+};
+
+} // namespace dom
+
+#endif
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2021-2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "dom/xpath.h"
+
+#include "dom/dom.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using etest::expect;
+using etest::expect_eq;
+using etest::require_eq;
+
+namespace {
+dom::Element element(std::string_view name, std::vector<dom::Node> children = {}) {
+    return dom::Element{.name{std::string{name}}, .children{std::move(children)}};
+}
+} // namespace
+
+int main() {
+    etest::test("a compiled path can be evaluated repeatedly", [] {
+        dom::XPath const path{"/html/body/p"};
+
+        auto const first = element("html", {element("body", {element("p")})});
+        auto const second = element("html", {element("body", {element("p"), element("p")})});
+
+        expect_eq(path.matching(first).size(), static_cast<std::size_t>(1));
+        expect_eq(path.matching(second).size(), static_cast<std::size_t>(2));
+    });
+
+    etest::test("malformed paths match nothing", [] {
+        auto const dom = element("html");
+        expect(dom::XPath{"html"}.matching(dom).empty());
+        expect(dom::XPath{"/html/"}.matching(dom).empty());
+        expect(dom::XPath{"//"}.matching(dom).empty());
+        expect(dom::XPath{""}.matching(dom).empty());
+    });
+
+    etest::test("first_matching stops at the first match", [] {
+        dom::XPath const path{"/html/body/p"};
+        auto const dom = element("html", {element("body", {element("p"), element("p")})});
+
+        auto const *match = path.first_matching(dom);
+        auto const all = path.matching(dom);
+        require_eq(all.size(), static_cast<std::size_t>(2));
+        expect_eq(match, all.front());
+
+        expect_eq(dom::XPath{"/html/body/a"}.first_matching(dom), nullptr);
+    });
+
+    etest::test("descendant axis", [] {
+        auto const dom = element("html",
+                {element("body",
+                        {
+                                element("p"),
+                                element("div", {element("p", {element("span")})}),
+                        })});
+
+        expect_eq(dom::XPath{"//p"}.matching(dom).size(), static_cast<std::size_t>(2));
+        expect_eq(dom::XPath{"/html//p"}.matching(dom).size(), static_cast<std::size_t>(2));
+        expect_eq(dom::XPath{"//p/span"}.matching(dom).size(), static_cast<std::size_t>(1));
+        expect_eq(dom::XPath{"//span"}.matching(dom).size(), static_cast<std::size_t>(1));
+        expect(dom::XPath{"//a"}.matching(dom).empty());
+
+        // Descendant steps include the node they start from.
+        expect_eq(dom::XPath{"//html"}.matching(dom).size(), static_cast<std::size_t>(1));
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2021 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef DOM2_ATOM_TABLE_H_
+#define DOM2_ATOM_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace dom2 {
+
+// Index into a document's AtomTable.
+using Atom = std::uint32_t;
+
+// One entry per distinct name used in a document — tag names, attribute
+// names, namespaces — so nodes store fixed-size atoms instead of their own
+// copy of each string. Interning the same name twice returns the same atom,
+// so names from the same table compare equal as integers.
+class AtomTable {
+public:
+    // Atom{} is always the empty string, so value-initialized name fields
+    // read back as "".
+    AtomTable() { static_cast<void>(intern("")); }
+
+    [[nodiscard]] Atom intern(std::string_view name) {
+        if (auto it = ids_.find(name); it != ids_.end()) {
+            return it->second;
+        }
+
+        auto atom = static_cast<Atom>(names_.size());
+        // The map's keys view into the deque's strings, which stay put as
+        // the table grows, so each name is stored exactly once.
+        ids_.emplace(names_.emplace_back(name), atom);
+        return atom;
+    }
+
+    // The view is stable for the table's lifetime.
+    [[nodiscard]] std::string_view view(Atom atom) const { return names_[atom]; }
+
+    [[nodiscard]] std::size_t size() const { return names_.size(); }
+
+private:
+    std::deque<std::string> names_{};
+    std::map<std::string_view, Atom> ids_{};
+};
+
+} // namespace dom2
+
+#endif
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2021 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "dom2/atom_table.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using etest::expect_eq;
+
+using namespace dom2;
+
+int main() {
+    etest::test("interning the same name returns the same atom", [] {
+        AtomTable atoms{};
+        auto div = atoms.intern("div");
+        expect_eq(atoms.intern("div"), div);
+        expect_eq(atoms.view(div), "div");
+    });
+
+    etest::test("a default atom is the empty string", [] {
+        AtomTable atoms{};
+        expect_eq(atoms.view(Atom{}), "");
+        expect_eq(atoms.intern(""), Atom{});
+    });
+
+    etest::test("views stay valid as the table grows", [] {
+        AtomTable atoms{};
+        auto first = atoms.intern("first");
+        auto view = atoms.view(first);
+
+        std::vector<Atom> interned;
+        for (int i = 0; i < 1000; ++i) {
+            interned.push_back(atoms.intern(std::to_string(i)));
+        }
+
+        expect_eq(view, "first");
+        expect_eq(atoms.view(interned[500]), "500");
+    });
+
+    return etest::run_all_tests();
+}
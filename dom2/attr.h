@@ -5,14 +5,59 @@
 #ifndef DOM2_ATTR_H_
 #define DOM2_ATTR_H_
 
+#include "dom2/atom_table.h"
+#include "dom2/document.h"
 #include "dom2/node.h"
 
+#include <string>
+#include <string_view>
+#include <utility>
+
 namespace dom2 {
 
 // https://dom.spec.whatwg.org/#interface-attr
 class Attr final : public Node {
 public:
+    explicit Attr(Document &document,
+            std::string_view local_name = {},
+            std::string value = {},
+            std::string_view name_space = {},
+            std::string_view prefix = {})
+        : Node{document},
+          local_name_{document.atoms().intern(local_name)},
+          namespace_{document.atoms().intern(name_space)},
+          prefix_{document.atoms().intern(prefix)},
+          value_{std::move(value)} {}
+
     [[nodiscard]] NodeType type() const override { return NodeType::Attribute; }
+
+    // Names are atoms in the owner document's table; values aren't shared
+    // the way names are, so each attribute owns its own.
+    [[nodiscard]] std::string_view local_name() const { return atoms().view(local_name_); }
+    [[nodiscard]] std::string_view namespace_uri() const { return atoms().view(namespace_); }
+    [[nodiscard]] std::string_view prefix() const { return atoms().view(prefix_); }
+    [[nodiscard]] std::string const &value() const { return value_; }
+
+    // https://dom.spec.whatwg.org/#concept-attribute-qualified-name
+    [[nodiscard]] std::string name() const {
+        auto qualifier = prefix();
+        if (qualifier.empty()) {
+            return std::string{local_name()};
+        }
+
+        std::string name{qualifier};
+        name += ':';
+        name += local_name();
+        return name;
+    }
+
+private:
+    [[nodiscard]] AtomTable const &atoms() const { return owner_document()->atoms(); }
+
+    Atom local_name_{};
+    Atom namespace_{};
+    Atom prefix_{};
+    std::string value_{};
 };
 
 } // namespace dom2
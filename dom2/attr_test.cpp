@@ -4,6 +4,9 @@
 
 #include "dom2/attr.h"
 
+#include "dom2/document.h"
+#include "dom2/node.h"
+
 #include "etest/etest.h"
 
 using etest::expect_eq;
@@ -12,9 +15,25 @@ using namespace dom2;
 
 int main() {
     etest::test("type", [] {
-        Attr node{};
+        Document document{};
+        Attr node{document};
         expect_eq(node.type(), NodeType::Attribute);
     });
 
+    etest::test("local name and value", [] {
+        Document document{};
+        Attr node{document, "href", "https://example.com"};
+        expect_eq(node.local_name(), "href");
+        expect_eq(node.value(), "https://example.com");
+        expect_eq(node.name(), "href");
+    });
+
+    etest::test("qualified name includes the prefix", [] {
+        Document document{};
+        Attr node{document, "href", "image.svg", "http://www.w3.org/1999/xlink", "xlink"};
+        expect_eq(node.namespace_uri(), "http://www.w3.org/1999/xlink");
+        expect_eq(node.name(), "xlink:href");
+    });
+
     return etest::run_all_tests();
 }
@@ -5,6 +5,7 @@
 #ifndef DOM2_DOCUMENT_H_
 #define DOM2_DOCUMENT_H_
 
+#include "dom2/atom_table.h"
 #include "dom2/node.h"
 
 namespace dom2 {
@@ -13,6 +14,15 @@ namespace dom2 {
 class Document final : public Node {
 public:
     [[nodiscard]] NodeType type() const override { return NodeType::Document; }
+
+    // The names this document's nodes share. Nodes intern their names here
+    // at creation and store the atoms; only the accessors materializing a
+    // name at the API boundary read it back.
+    [[nodiscard]] AtomTable &atoms() { return atoms_; }
+    [[nodiscard]] AtomTable const &atoms() const { return atoms_; }
+
+private:
+    AtomTable atoms_{};
 };
 
 } // namespace dom2
@@ -5,10 +5,11 @@
 #ifndef DOM2_ELEMENT_H_
 #define DOM2_ELEMENT_H_
 
+#include "dom2/atom_table.h"
+#include "dom2/document.h"
 #include "dom2/node.h"
 
-#include <string>
-#include <utility>
+#include <string_view>
 
 namespace dom2 {
 
@@ -16,14 +17,29 @@ namespace dom2 {
 // TODO(robinlinden): This is only partially implemented.
 class Element final : public Node {
 public:
-    explicit Element(std::string local_name) : local_name_{std::move(local_name)} {}
+    explicit Element(Document &document,
+            std::string_view local_name,
+            std::string_view name_space = {},
+            std::string_view prefix = {})
+        : Node{document},
+          local_name_{document.atoms().intern(local_name)},
+          namespace_{document.atoms().intern(name_space)},
+          prefix_{document.atoms().intern(prefix)} {}
 
     [[nodiscard]] NodeType type() const override { return NodeType::Element; }
 
-    [[nodiscard]] std::string const &local_name() const { return local_name_; }
+    // Names are atoms in the owner document's table; these read the backing
+    // strings back out.
+    [[nodiscard]] std::string_view local_name() const { return atoms().view(local_name_); }
+    [[nodiscard]] std::string_view namespace_uri() const { return atoms().view(namespace_); }
+    [[nodiscard]] std::string_view prefix() const { return atoms().view(prefix_); }
 
 private:
-    std::string local_name_{};
+    [[nodiscard]] AtomTable const &atoms() const { return owner_document()->atoms(); }
+
+    Atom local_name_{};
+    Atom namespace_{};
+    Atom prefix_{};
 };
 
 } // namespace dom2
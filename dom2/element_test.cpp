@@ -4,24 +4,45 @@
 
 #include "dom2/element.h"
 
+#include "dom2/document.h"
+#include "dom2/node.h"
+
 #include "etest/etest.h"
 
-#include <string>
+#include <cstddef>
 
-using namespace std::literals;
 using etest::expect_eq;
 
 using namespace dom2;
 
 int main() {
     etest::test("type", [] {
-        Element node{"a"s};
+        Document document{};
+        Element node{document, "a"};
         expect_eq(node.type(), NodeType::Element);
     });
 
     etest::test("local name", [] {
-        Element node{"title"s};
+        Document document{};
+        Element node{document, "title"};
         expect_eq(node.local_name(), "title");
+        expect_eq(node.owner_document(), &document);
+    });
+
+    etest::test("namespace and prefix", [] {
+        Document document{};
+        Element node{document, "svg", "http://www.w3.org/2000/svg"};
+        expect_eq(node.namespace_uri(), "http://www.w3.org/2000/svg");
+        expect_eq(node.prefix(), "");
+    });
+
+    etest::test("repeated names share one table entry", [] {
+        Document document{};
+        auto before = document.atoms().size();
+        Element first{document, "p"};
+        Element second{document, "p"};
+        expect_eq(document.atoms().size(), before + 1);
+        expect_eq(first.local_name(), second.local_name());
     });
 
     return etest::run_all_tests();
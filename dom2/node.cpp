@@ -5,26 +5,25 @@
 #include "dom2/node.h"
 
 #include <exception>
-#include <utility>
 
 namespace dom2 {
 
 // https://dom.spec.whatwg.org/#concept-node-append
-std::shared_ptr<Node> Node::append_child(std::shared_ptr<Node> child) {
+Node *Node::append_child(Node *child) {
     // To append a node to a parent, pre-insert node into parent before null.
-    return pre_insert(std::move(child), nullptr);
+    return pre_insert(child, nullptr);
 }
 
 // https://dom.spec.whatwg.org/#concept-node-pre-insert
-std::shared_ptr<Node> Node::pre_insert(std::shared_ptr<Node> node, Node const *child) {
+Node *Node::pre_insert(Node *node, Node const *child) {
     // 1. Ensure pre-insertion validity of node into parent before child.
     // TODO(robinlinden): Ensure pre-insertion validity.
 
     // 2. Let referenceChild be child.
-    auto reference_child = child;
+    auto const *reference_child = child;
 
     // 3. If referenceChild is node, then set referenceChild to node's next sibling.
-    if (reference_child == node.get()) {
+    if (reference_child == node) {
         reference_child = node->next_sibling();
     }
 
@@ -36,18 +35,11 @@ std::shared_ptr<Node> Node::pre_insert(std::shared_ptr<Node> node, Node const *c
 }
 
 // https://dom.spec.whatwg.org/#concept-node-insert
-void Node::insert(std::shared_ptr<Node> node, Node const *child, [[maybe_unused]] bool suppress_observers) {
+void Node::insert(Node *node, Node const *child, [[maybe_unused]] bool suppress_observers) {
     // 1. Let nodes be node's children, if node is a DocumentFragment node; otherwise « node ».
-    auto const &nodes =
-            node->type() == NodeType::DocumentFragment ? node->child_nodes() : std::vector<std::shared_ptr<Node>>{node};
-
     // 2. Let count be nodes's size.
-    auto count = nodes.size();
-
     // 3. If count is 0, then return.
-    if (count == 0) {
-        return;
-    }
+    // Note: Until step 4 is implemented, nodes is always « node » and count is always 1.
 
     // 4. If node is a DocumentFragment node, then:
     if (node->type() == NodeType::DocumentFragment) {
@@ -70,17 +62,21 @@ void Node::insert(std::shared_ptr<Node> node, Node const *child, [[maybe_unused]
     [[maybe_unused]] Node const *previous_sibling = child != nullptr ? child->previous_sibling() : last_child();
 
     // 7. For each node in nodes, in tree order:
-    for (auto const &n : nodes) {
+    {
         // TODO(robinlinden):
         // 1. Adopt node into parent's node document.
 
         // 2. If child is null, then append node to parent's children.
         // 3. Otherwise, insert node into parent's children before child's index.
-        if (child == nullptr) {
-            child_nodes_.push_back(n);
+        // Appending splices the node onto the end of the intrusive child list.
+        node->parent_ = this;
+        node->next_sibling_ = nullptr;
+        if (last_child_ == nullptr) {
+            first_child_ = node;
         } else {
-            std::terminate();
+            last_child_->next_sibling_ = node;
         }
+        last_child_ = node;
 
         // Please keep my indented comments, clang-format. It looks silly, but they go where blocks will go.
         // clang-format off
@@ -99,6 +95,7 @@ void Node::insert(std::shared_ptr<Node> node, Node const *child, [[maybe_unused]
                 // 2. Otherwise, try to upgrade inclusiveDescendant.
                 // Note: If this successfully upgrades inclusiveDescendant, its connectedCallback will be enqueued
                 // automatically during the upgrade an element algorithm.
+        // clang-format on
     }
 
     // TODO(robinlinden):
@@ -5,13 +5,13 @@
 #ifndef DOM2_NODE_H_
 #define DOM2_NODE_H_
 
+#include <cstddef>
 #include <cstdint>
-#include <exception>
-#include <memory>
-#include <vector>
 
 namespace dom2 {
 
+class Document;
+
 enum class NodeType : std::uint16_t {
     Element = 1,
     Attribute = 2,
@@ -28,32 +28,89 @@ enum class NodeType : std::uint16_t {
 };
 
 // https://dom.spec.whatwg.org/#interface-node
+//
+// Nodes are owned by a NodeArena and linked into their tree intrusively
+// (parent/first-child/next-sibling), so building a tree is bump-allocation
+// and walking one touches no reference counts.
 class Node {
 public:
     virtual ~Node() = default;
 
     [[nodiscard]] virtual NodeType type() const = 0;
 
-    [[nodiscard]] bool has_child_nodes() const { return !child_nodes_.empty(); }
-    [[nodiscard]] std::vector<std::shared_ptr<Node>> const &child_nodes() const { return child_nodes_; }
-    [[nodiscard]] Node const *first_child() const {
-        return child_nodes().empty() ? nullptr : child_nodes().front().get();
-    }
-    [[nodiscard]] Node const *last_child() const {
-        return child_nodes().empty() ? nullptr : child_nodes().back().get();
+    // Lazily-walked view over a node's children.
+    class ChildNodes {
+    public:
+        explicit ChildNodes(Node const *first) : first_{first} {}
+
+        class Iterator {
+        public:
+            explicit Iterator(Node const *node) : node_{node} {}
+            Node const &operator*() const { return *node_; }
+            Iterator &operator++() {
+                node_ = node_->next_sibling();
+                return *this;
+            }
+            [[nodiscard]] bool operator==(Iterator const &) const = default;
+
+        private:
+            Node const *node_;
+        };
+
+        [[nodiscard]] Iterator begin() const { return Iterator{first_}; }
+        [[nodiscard]] Iterator end() const { return Iterator{nullptr}; }
+        [[nodiscard]] bool empty() const { return first_ == nullptr; }
+        [[nodiscard]] std::size_t size() const {
+            std::size_t count{0};
+            for (auto const *node = first_; node != nullptr; node = node->next_sibling()) {
+                ++count;
+            }
+            return count;
+        }
+
+    private:
+        Node const *first_;
+    };
+
+    // https://dom.spec.whatwg.org/#dom-node-ownerdocument
+    // Null for documents and for nodes created without one.
+    [[nodiscard]] Document const *owner_document() const { return owner_document_; }
+
+    [[nodiscard]] bool has_child_nodes() const { return first_child_ != nullptr; }
+    [[nodiscard]] ChildNodes child_nodes() const { return ChildNodes{first_child_}; }
+    [[nodiscard]] Node const *parent_node() const { return parent_; }
+    [[nodiscard]] Node const *first_child() const { return first_child_; }
+    [[nodiscard]] Node const *last_child() const { return last_child_; }
+    [[nodiscard]] Node const *next_sibling() const { return next_sibling_; }
+    [[nodiscard]] Node const *previous_sibling() const {
+        if (parent_ == nullptr || parent_->first_child_ == this) {
+            return nullptr;
+        }
+
+        auto const *node = parent_->first_child_;
+        while (node->next_sibling_ != this) {
+            node = node->next_sibling_;
+        }
+        return node;
     }
-    [[nodiscard]] Node const *previous_sibling() const { std::terminate(); }
-    [[nodiscard]] Node const *next_sibling() const { std::terminate(); }
 
-    std::shared_ptr<Node> append_child(std::shared_ptr<Node> child);
+    Node *append_child(Node *child);
 
     [[nodiscard]] bool operator==(Node const &) const = default;
 
+protected:
+    Node() = default;
+    explicit Node(Document const &owner) : owner_document_{&owner} {}
+
 private:
-    std::vector<std::shared_ptr<Node>> child_nodes_{};
+    Document const *owner_document_{nullptr};
+    Node *parent_{nullptr};
+    Node *first_child_{nullptr};
+    Node *last_child_{nullptr};
+    Node *next_sibling_{nullptr};
 
-    std::shared_ptr<Node> pre_insert(std::shared_ptr<Node> node, Node const *child);
-    void insert(std::shared_ptr<Node> node, Node const *child, bool suppress_observers = false);
+    Node *pre_insert(Node *node, Node const *child);
+    void insert(Node *node, Node const *child, bool suppress_observers = false);
 };
 
 } // namespace dom2
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2021 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef DOM2_NODE_ARENA_H_
+#define DOM2_NODE_ARENA_H_
+
+#include "dom2/node.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dom2 {
+
+// Owns every node in a tree. Creating a node is a pointer bump into a large
+// block; all nodes are destroyed together when the arena goes away.
+class NodeArena {
+public:
+    NodeArena() = default;
+    NodeArena(NodeArena &&) = default;
+    NodeArena &operator=(NodeArena &&) = default;
+
+    ~NodeArena() {
+        // Newest-first, so nodes can't outlive anything they were built from.
+        for (auto it = nodes_.rbegin(); it != nodes_.rend(); ++it) {
+            (*it)->~Node();
+        }
+    }
+
+    template<typename T, typename... Args>
+    T *create(Args &&...args) {
+        static_assert(std::is_base_of_v<Node, T>);
+        auto *node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        nodes_.push_back(node);
+        return node;
+    }
+
+    [[nodiscard]] std::size_t size() const { return nodes_.size(); }
+
+private:
+    static constexpr std::size_t kBlockSize{16 * 1024};
+
+    struct Block {
+        std::unique_ptr<std::byte[]> storage;
+        std::size_t size{};
+        std::size_t used{};
+    };
+
+    std::byte *allocate(std::size_t size, std::size_t alignment) {
+        if (!blocks_.empty()) {
+            auto &block = blocks_.back();
+            auto offset = (block.used + alignment - 1) & ~(alignment - 1);
+            if (offset + size <= block.size) {
+                block.used = offset + size;
+                return block.storage.get() + offset;
+            }
+        }
+
+        // operator new's alignment covers any node type, so a fresh block
+        // never needs adjusting.
+        auto block_size = std::max(kBlockSize, size);
+        auto &block = blocks_.emplace_back(std::make_unique<std::byte[]>(block_size), block_size, size);
+        return block.storage.get();
+    }
+
+    std::vector<Block> blocks_{};
+    std::vector<Node *> nodes_{};
+};
+
+} // namespace dom2
+
+#endif
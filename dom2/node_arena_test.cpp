@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2021 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "dom2/node_arena.h"
+
+#include "dom2/node.h"
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+using etest::expect_eq;
+
+using namespace dom2;
+
+namespace {
+struct CountingNode final : Node {
+    explicit CountingNode(int &destroyed) : destroyed_{destroyed} {}
+    ~CountingNode() override { ++destroyed_; }
+    [[nodiscard]] NodeType type() const override { return NodeType::Element; }
+
+private:
+    int &destroyed_;
+};
+
+struct TextishNode final : Node {
+    explicit TextishNode(std::string data) : data_{std::move(data)} {}
+    [[nodiscard]] NodeType type() const override { return NodeType::Text; }
+    [[nodiscard]] std::string const &data() const { return data_; }
+
+private:
+    std::string data_;
+};
+} // namespace
+
+int main() {
+    etest::test("nodes are destroyed with the arena", [] {
+        int destroyed{0};
+        {
+            NodeArena arena{};
+            arena.create<CountingNode>(destroyed);
+            arena.create<CountingNode>(destroyed);
+            expect_eq(destroyed, 0);
+        }
+        expect_eq(destroyed, 2);
+    });
+
+    etest::test("nodes keep their state", [] {
+        NodeArena arena{};
+        auto const *node = arena.create<TextishNode>("hello");
+        expect_eq(node->data(), "hello");
+    });
+
+    etest::test("trees larger than one block", [] {
+        NodeArena arena{};
+        auto &root = *arena.create<TextishNode>("root");
+        for (int i = 0; i < 10'000; ++i) {
+            root.append_child(arena.create<TextishNode>("child"));
+        }
+
+        expect_eq(arena.size(), static_cast<std::size_t>(10'001));
+        expect_eq(root.child_nodes().size(), static_cast<std::size_t>(10'000));
+    });
+
+    return etest::run_all_tests();
+}
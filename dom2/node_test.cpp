@@ -4,8 +4,11 @@
 
 #include "dom2/node.h"
 
+#include "dom2/node_arena.h"
 #include "etest/etest.h"
 
+#include <cstddef>
+
 using namespace std::literals;
 using etest::expect;
 using etest::expect_eq;
@@ -25,48 +28,83 @@ private:
 
 int main() {
     etest::test("append_node", [] {
-        TestNode node{NodeType::Document};
+        NodeArena arena{};
+        auto &node = *arena.create<TestNode>(NodeType::Document);
         expect_eq(node.child_nodes().size(), static_cast<std::size_t>(0));
 
-        node.append_child(std::make_shared<TestNode>(NodeType::Element));
+        node.append_child(arena.create<TestNode>(NodeType::Element));
         expect_eq(node.child_nodes().size(), static_cast<std::size_t>(1));
 
-        node.append_child(std::make_shared<TestNode>(NodeType::Comment));
+        node.append_child(arena.create<TestNode>(NodeType::Comment));
         expect_eq(node.child_nodes().size(), static_cast<std::size_t>(2));
     });
 
     etest::test("has_child_nodes", [] {
-        TestNode node{NodeType::Document};
+        NodeArena arena{};
+        auto &node = *arena.create<TestNode>(NodeType::Document);
         expect(!node.has_child_nodes());
-        node.append_child(std::make_shared<TestNode>(NodeType::Element));
+        node.append_child(arena.create<TestNode>(NodeType::Element));
         expect(node.has_child_nodes());
     });
 
     etest::test("first_child", [] {
-        TestNode node{NodeType::Document};
+        NodeArena arena{};
+        auto &node = *arena.create<TestNode>(NodeType::Document);
         expect_eq(node.first_child(), nullptr);
 
-        node.append_child(std::make_shared<TestNode>(NodeType::Element));
+        node.append_child(arena.create<TestNode>(NodeType::Element));
         require(node.first_child() != nullptr);
         expect_eq(node.first_child()->type(), NodeType::Element);
 
-        node.append_child(std::make_shared<TestNode>(NodeType::Comment));
+        node.append_child(arena.create<TestNode>(NodeType::Comment));
         require(node.first_child() != nullptr);
         expect_eq(node.first_child()->type(), NodeType::Element);
     });
 
     etest::test("last_child", [] {
-        TestNode node{NodeType::Document};
+        NodeArena arena{};
+        auto &node = *arena.create<TestNode>(NodeType::Document);
         expect_eq(node.last_child(), nullptr);
 
-        node.append_child(std::make_shared<TestNode>(NodeType::Element));
+        node.append_child(arena.create<TestNode>(NodeType::Element));
         require(node.last_child() != nullptr);
         expect_eq(node.last_child()->type(), NodeType::Element);
 
-        node.append_child(std::make_shared<TestNode>(NodeType::Comment));
+        node.append_child(arena.create<TestNode>(NodeType::Comment));
         require(node.last_child() != nullptr);
         expect_eq(node.last_child()->type(), NodeType::Comment);
     });
 
+    etest::test("siblings", [] {
+        NodeArena arena{};
+        auto &node = *arena.create<TestNode>(NodeType::Document);
+
+        auto const *first = node.append_child(arena.create<TestNode>(NodeType::Element));
+        expect_eq(first->previous_sibling(), nullptr);
+        expect_eq(first->next_sibling(), nullptr);
+
+        auto const *second = node.append_child(arena.create<TestNode>(NodeType::Comment));
+        expect_eq(first->next_sibling(), second);
+        expect_eq(second->previous_sibling(), first);
+        expect_eq(second->next_sibling(), nullptr);
+
+        expect_eq(first->parent_node(), &node);
+        expect_eq(second->parent_node(), &node);
+    });
+
+    etest::test("child_nodes iteration", [] {
+        NodeArena arena{};
+        auto &node = *arena.create<TestNode>(NodeType::Document);
+        node.append_child(arena.create<TestNode>(NodeType::Element));
+        node.append_child(arena.create<TestNode>(NodeType::Comment));
+
+        std::size_t seen{0};
+        for (auto const &child : node.child_nodes()) {
+            expect_eq(child.parent_node(), &node);
+            ++seen;
+        }
+        expect_eq(seen, static_cast<std::size_t>(2));
+    });
+
     return etest::run_all_tests();
 }
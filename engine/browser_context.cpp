@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/browser_context.h"
+
+#include "protocol/handler_factory.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace engine {
+
+BrowserContext::BrowserContext() : response_cache{protocol::HandlerFactory::default_response_cache()} {}
+
+std::unique_ptr<protocol::MultiProtocolHandler> BrowserContext::create_protocol_handler(
+        std::optional<std::string> user_agent) const {
+    return protocol::HandlerFactory::create(std::move(user_agent), response_cache, tls_session_cache);
+}
+
+} // namespace engine
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ENGINE_BROWSER_CONTEXT_H_
+#define ENGINE_BROWSER_CONTEXT_H_
+
+#include "engine/image_cache.h"
+#include "engine/stylesheet_cache.h"
+#include "net/socket.h"
+#include "protocol/cache.h"
+#include "protocol/multi_protocol_handler.h"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace engine {
+
+// The caches every engine in the process can share. One context serves any
+// number of engines (think one per tab): the members are immutable or
+// internally synchronized, so engines on different threads use them
+// concurrently. Ten tabs should cost one of each cache, not ten.
+//
+// Engines created without an explicit context get a private one, so
+// single-engine embedders don't have to care that this exists.
+struct BrowserContext {
+    // Decoded images. ImageCache isn't synchronized itself, so the lock
+    // travels with it.
+    struct Images {
+        std::mutex mutex{};
+        ImageCache cache{};
+    };
+
+    Images images{};
+
+    // Parsed linked stylesheets. Internally synchronized.
+    StylesheetCache stylesheet_cache{};
+
+    // Shared by every handler stack made through create_protocol_handler, so
+    // one tab's fetches warm the response cache and TLS sessions for all of
+    // them. The response cache may be nullptr (caching disabled).
+    std::shared_ptr<protocol::Cache> response_cache;
+    std::shared_ptr<net::TlsSessionCache> tls_session_cache{std::make_shared<net::TlsSessionCache>()};
+
+    BrowserContext();
+
+    // A protocol handler stack wired up to the context's shared caches. Each
+    // engine gets its own stack; only the caches behind it are shared.
+    [[nodiscard]] std::unique_ptr<protocol::MultiProtocolHandler> create_protocol_handler(
+            std::optional<std::string> user_agent = std::nullopt) const;
+};
+
+} // namespace engine
+
+#endif
@@ -6,13 +6,26 @@
 
 #include "css/default.h"
 #include "css/parse.h"
+#include "css/property_id.h"
+#include "dom/xpath.h"
+#include "engine/memory_metrics.h"
 #include "html/parse.h"
+#include "net/socket.h"
+#include "protocol/http.h"
 #include "style/style.h"
+#include "util/trace.h"
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <future>
 #include <iterator>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
 #include <string_view>
 #include <utility>
 
@@ -21,35 +34,140 @@ using namespace std::literals;
 namespace engine {
 namespace {
 
-std::optional<std::string_view> try_get_text_content(dom::Document const &doc, std::string_view xpath) {
-    auto nodes = dom::nodes_by_xpath(doc.html(), xpath);
-    if (nodes.empty() || nodes[0]->children.empty() || !std::holds_alternative<dom::Text>(nodes[0]->children[0])) {
+std::optional<std::string_view> try_get_text_content(dom::Document const &doc, dom::XPath const &xpath) {
+    auto const *node = xpath.first_matching(doc.html());
+    if (node == nullptr || node->children.empty() || !std::holds_alternative<dom::Text>(node->children[0])) {
         return std::nullopt;
     }
-    return std::get<dom::Text>(nodes[0]->children[0]).text;
+    return std::get<dom::Text>(node->children[0]).text;
+}
+
+// Starts a dns lookup for the element's href so that a later fetch of it
+// (stylesheets now, navigation if the user clicks a link) doesn't have to
+// wait on the resolver.
+void prefetch_host(dom::Element const &element, uri::UriResolver &uris) {
+    auto const &uri = uris.resolve(element.attributes.at("href"));
+    if ((uri.scheme == "http" || uri.scheme == "https") && !uri.authority.host.empty()) {
+        net::Socket::prefetch_dns(uri.authority.host, uri.authority.port.empty() ? uri.scheme : uri.authority.port);
+    }
+}
+
+// The validator that decides whether a cached parse of a sheet is still the
+// same sheet. No validator means no caching: we'd have no way to tell a
+// changed sheet apart.
+std::string stylesheet_validator(protocol::Response const &response) {
+    if (auto etag = response.headers.get("etag")) {
+        return std::string{*etag};
+    }
+
+    if (auto last_modified = response.headers.get("last-modified")) {
+        return std::string{*last_modified};
+    }
+
+    return {};
+}
+
+bool is_stylesheet_link(dom::Element const &element) {
+    return element.name == "link" && element.attributes.contains("rel")
+            && element.attributes.at("rel") == "stylesheet" && element.attributes.contains("href");
+}
+
+// Both trees are shaped by the same DOM, so they match node for node.
+void adopt_properties(style::StyledNode &onto, style::StyledNode &&from) {
+    onto.properties = std::move(from.properties);
+    onto.display = from.display;
+    for (std::size_t i = 0; i < onto.children.size(); ++i) {
+        adopt_properties(onto.children[i], std::move(from.children[i]));
+    }
+}
+
+// One budget for the whole navigation: dns, connects, tls, every redirect
+// hop, and the stylesheet downloads all draw from it, so the worst case is
+// bounded instead of additive per hop. Generous enough that only a page
+// that was never going to finish gives anything up.
+constexpr auto kNavigationBudget = std::chrono::seconds{15};
+
+std::size_t box_count(layout::LayoutBox const &box) {
+    std::size_t count{1};
+    for (auto const &child : box.children) {
+        count += box_count(child);
+    }
+    return count;
 }
 
 } // namespace
 
-protocol::Error Engine::navigate(uri::Uri uri) {
-    auto is_redirect = [](int status_code) {
-        return status_code == 301 || status_code == 302 || status_code == 307 || status_code == 308;
-    };
+protocol::Error Engine::navigate(uri::Uri uri, CancellationToken const &cancel, NavigationKind kind) {
+    util::trace::Span span{"engine::navigate"};
+    // Background tasks read the pipeline state this is about to replace.
+    IdleScheduler::BusyScope busy{*idle_};
+    // Enough for any legitimate redirect chain; a loop shouldn't hang us.
+    constexpr int kMaxRedirects{10};
+    auto cancelled = [&cancel] { return cancel != nullptr && *cancel; };
 
     uri_ = std::move(uri);
-    response_ = protocol_handler_->handle(uri_);
-    while (response_.err == protocol::Error::Ok && is_redirect(response_.status_line.status_code)) {
+    metrics_ = {.uri = uri_.uri};
+    navigation_start_ = std::chrono::steady_clock::now();
+
+    if (kind == NavigationKind::History) {
+        if (auto cached = page_cache_.take(uri_.uri)) {
+            spdlog::info("Restoring {} from the page cache", uri_.uri);
+            response_ = std::move(cached->response);
+            dom_ = std::move(cached->dom);
+            stylesheet_ = std::move(cached->stylesheet);
+            record_phase("page_cache", navigation_start_, response_.body.size());
+
+            if (!cancelled()) {
+                auto style_start = std::chrono::steady_clock::now();
+                style::SelectorIndex index{stylesheet_};
+                index.set_media_width(layout_width_);
+                speculative_layouts_.clear();
+                styled_ = style::style_tree(dom_.html_node, index);
+                record_phase("style", style_start, dom_.node_count);
+                auto layout_start = std::chrono::steady_clock::now();
+                layout_ = layout::create_layout(*styled_, layout_width_);
+                record_phase("layout", layout_start, box_count(*layout_));
+                layout_damage_.clear();
+                record_memory();
+                on_page_loaded_();
+            }
+
+            page_cache_.insert(uri_.uri, {response_, dom_, stylesheet_});
+            return protocol::Error::Ok;
+        }
+    }
+
+    auto const deadline = navigation_start_ + kNavigationBudget;
+    auto fetch_start = navigation_start_;
+    response_ = scheduler_->fetch(uri_, ResourceScheduler::Priority::Document, deadline).get();
+    int redirects{0};
+    while (response_.err == protocol::Error::Ok && protocol::Http::is_redirect(response_.status_line.status_code)
+            && !cancelled()) {
+        if (++redirects > kMaxRedirects) {
+            spdlog::warn("Too many redirects, bailing at {}", uri_.uri);
+            response_.err = protocol::Error::InvalidResponse;
+            break;
+        }
+
         spdlog::info("Following {} redirect from {} to {}",
                 response_.status_line.status_code,
                 uri_.uri,
                 response_.headers.get("Location").value());
         uri_ = uri::Uri::parse(std::string(response_.headers.get("Location").value()), uri_);
-        response_ = protocol_handler_->handle(uri_);
+        // Each hop fetches with whatever is left of the navigation's budget.
+        response_ = scheduler_->fetch(uri_, ResourceScheduler::Priority::Document, deadline).get();
+    }
+
+    metrics_.uri = uri_.uri;
+    record_phase("fetch", fetch_start, response_.body.size());
+
+    if (cancelled()) {
+        return response_.err;
     }
 
     switch (response_.err) {
         case protocol::Error::Ok:
-            on_navigation_success();
+            on_navigation_success(cancel);
             break;
         default:
             on_navigation_failure_(response_.err);
@@ -60,73 +178,338 @@ protocol::Error Engine::navigate(uri::Uri uri) {
 }
 
 void Engine::set_layout_width(int width) {
-    layout_width_ = width;
+    // The css-visible viewport hasn't changed, so the geometry is still
+    // valid. This makes e.g. display-scale changes repaint-only.
+    if (width == layout_width_ && layout_.has_value()) {
+        return;
+    }
+
+    // Waits out any in-flight speculation, so the trees it reads and the
+    // cache it fills can't change under it.
+    IdleScheduler::BusyScope busy{*idle_};
+
+    auto const old_width = std::exchange(layout_width_, width);
     if (!styled_) {
         return;
     }
 
-    layout_ = layout::create_layout(*styled_, layout_width_);
+    // A resize that crosses one of the stylesheet's media-query breakpoints
+    // changes which rules apply, so the style pass has to be redone before
+    // any geometry makes sense again.
+    if (style::media_matching_changes(stylesheet_, old_width, layout_width_)) {
+        speculative_layouts_.clear();
+        style::SelectorIndex index{stylesheet_};
+        index.set_media_width(layout_width_);
+        styled_ = style::style_tree(dom_.html_node, index);
+        layout_ = layout::create_layout(*styled_, layout_width_);
+        layout_damage_.clear();
+        record_memory();
+        on_layout_update_();
+        return;
+    }
+
+    // The box tree from the last layout doesn't depend on the width, so
+    // resizing only has to redo the geometry pass over it.
+    if (layout_) {
+        auto before = layout::flatten(*layout_);
+        auto cached = std::ranges::find(
+                speculative_layouts_, layout_width_, &std::pair<int, layout::LayoutBox>::first);
+        if (cached != speculative_layouts_.end()) {
+            // A resize landing on a precomputed width swaps trees; the
+            // outgoing tree takes the cache slot, so resizing back is a
+            // swap too.
+            auto tree = std::move(cached->second);
+            *cached = {old_width, std::move(*layout_)};
+            layout_ = std::move(tree);
+        } else {
+            layout::relayout(*layout_, layout_width_);
+        }
+        layout_damage_ = layout::damaged_regions(before, layout::flatten(*layout_));
+    } else {
+        layout_ = layout::create_layout(*styled_, layout_width_);
+        layout_damage_.clear();
+    }
+
+    record_memory();
     on_layout_update_();
 }
 
-void Engine::on_navigation_success() {
-    dom_ = html::parse(response_.body);
+void Engine::speculate_layout_width(int width) {
+    // One width per slice, so a resize or navigation arriving mid-burst
+    // preempts the remaining widths instead of waiting out all of them. The
+    // checks run on the worker: by the time the slice runs, the page or the
+    // width it was queued against may be gone.
+    idle_->schedule([this, width] {
+        if (!styled_ || !layout_.has_value() || width <= 0 || width == layout_width_) {
+            return false;
+        }
+
+        if (std::ranges::find(speculative_layouts_, width, &std::pair<int, layout::LayoutBox>::first)
+                != speculative_layouts_.end()) {
+            return false;
+        }
+
+        // Starting from a copy of the current tree reuses its cached text
+        // metrics, so the speculative pass is geometry only.
+        auto tree = *layout_;
+        layout::relayout(tree, width);
+        if (speculative_layouts_.size() >= kMaxSpeculativeLayouts) {
+            speculative_layouts_.erase(speculative_layouts_.begin());
+        }
+        speculative_layouts_.emplace_back(width, std::move(tree));
+        return false;
+    });
+}
+
+void Engine::on_navigation_success(CancellationToken const &cancel) {
+    util::trace::Span span{"engine::on_navigation_success"};
+    auto cancelled = [&cancel] { return cancel != nullptr && *cancel; };
     stylesheet_ = css::default_style();
 
-    if (auto style = try_get_text_content(dom_, "/html/head/style"sv)) {
+    // Stylesheet downloads and parses start the moment the parser opens
+    // their <link> elements, so they overlap the rest of the html parse and
+    // each other rather than waiting for the whole dom.
+    // Each worker also buckets its sheet into a partial selector index, so
+    // index construction for the merged stylesheet happens inside fetch
+    // latency instead of on the restyle path.
+    using RulesAndPartialIndex = std::pair<std::vector<css::Rule>, style::SelectorIndex::Partial>;
+    std::vector<std::future<RulesAndPartialIndex>> future_new_rules;
+    auto html_parse_start = std::chrono::steady_clock::now();
+    // One resolver for the whole document: hrefs are resolved against the
+    // page's uri and repeated ones resolve once.
+    uri::UriResolver hrefs{uri_};
+    // Pages that link one sheet twice get it fetched, parsed, and merged
+    // once; the duplicate would only re-add identical rules.
+    std::set<std::string, std::less<>> requested_sheets;
+    dom_ = html::parse(response_.body, [&, this](dom::Element const &element) {
+        if ((element.name == "a" || element.name == "link") && element.attributes.contains("href")) {
+            prefetch_host(element, hrefs);
+        }
+
+        if (!is_stylesheet_link(element)) {
+            return;
+        }
+
+        auto stylesheet_url = hrefs.resolve(element.attributes.at("href"));
+        if (!requested_sheets.insert(stylesheet_url.uri).second) {
+            return;
+        }
+
+        spdlog::info("Downloading stylesheet from {}", stylesheet_url.uri);
+        auto response = scheduler_->fetch(
+                stylesheet_url, ResourceScheduler::Priority::Stylesheet, navigation_start_ + kNavigationBudget);
+        future_new_rules.push_back(std::async(std::launch::async,
+                [this, response = std::move(response), stylesheet_url = std::move(stylesheet_url)]() mutable
+                -> RulesAndPartialIndex {
+                    auto style_data = response.get();
+                    if (style_data.err != protocol::Error::Ok) {
+                        spdlog::warn("Error {} downloading {}", static_cast<int>(style_data.err), stylesheet_url.uri);
+                        return {};
+                    }
+
+                    if ((stylesheet_url.scheme == "http" || stylesheet_url.scheme == "https")
+                            && style_data.status_line.status_code != 200) {
+                        spdlog::warn("Error {}: {} downloading {}",
+                                style_data.status_line.status_code,
+                                style_data.status_line.reason,
+                                stylesheet_url.uri);
+                        return {};
+                    }
+
+                    auto validator = stylesheet_validator(style_data);
+                    if (!validator.empty()) {
+                        if (auto cached = context_->stylesheet_cache.find(stylesheet_url.uri, validator)) {
+                            return {cached->rules, cached->index};
+                        }
+                    }
+
+                    auto rules = css::parse(style_data.body);
+                    auto partial = style::SelectorIndex::Partial{rules};
+                    if (!validator.empty()) {
+                        context_->stylesheet_cache.insert(stylesheet_url.uri,
+                                std::move(validator),
+                                std::make_shared<StylesheetCache::ParsedStylesheet const>(rules, partial));
+                    }
+
+                    return {std::move(rules), std::move(partial)};
+                }));
+    }, &tokenizer_scratch_);
+    record_phase("html_parse", html_parse_start, dom_.node_count);
+
+    // Parse inline style while the stylesheets download. It comes before the
+    // linked sheets in document order, so it's merged before them too.
+    static dom::XPath const kInlineStylePath{"/html/head/style"};
+    if (auto style = try_get_text_content(dom_, kInlineStylePath)) {
+        auto css_parse_start = std::chrono::steady_clock::now();
         auto new_rules = css::parse(*style);
+        record_phase("css_parse", css_parse_start, new_rules.size());
         stylesheet_.reserve(stylesheet_.size() + new_rules.size());
         stylesheet_.insert(
                 end(stylesheet_), std::make_move_iterator(begin(new_rules)), std::make_move_iterator(end(new_rules)));
     }
 
-    auto head_links = dom::nodes_by_xpath(dom_.html(), "/html/head/link");
-    std::erase_if(head_links, [](auto const *link) {
-        return !link->attributes.contains("rel")
-                || (link->attributes.contains("rel") && link->attributes.at("rel") != "stylesheet")
-                || !link->attributes.contains("href");
-    });
-
-    // Start downloading all stylesheets.
-    spdlog::info("Loading {} stylesheets", head_links.size());
-    std::vector<std::future<std::vector<css::Rule>>> future_new_rules;
-    for (auto link : head_links) {
-        future_new_rules.push_back(std::async(std::launch::async, [=, this]() -> std::vector<css::Rule> {
-            auto const &href = link->attributes.at("href");
-            auto stylesheet_url = uri::Uri::parse(href, uri_);
-
-            spdlog::info("Downloading stylesheet from {}", stylesheet_url.uri);
-            auto style_data = protocol_handler_->handle(stylesheet_url);
-            if (style_data.err != protocol::Error::Ok) {
-                spdlog::warn("Error {} downloading {}", static_cast<int>(style_data.err), stylesheet_url.uri);
-                return {};
-            }
+    if (cancelled()) {
+        return;
+    }
 
-            if ((stylesheet_url.scheme == "http" || stylesheet_url.scheme == "https")
-                    && style_data.status_line.status_code != 200) {
-                spdlog::warn("Error {}: {} downloading {}",
-                        style_data.status_line.status_code,
-                        style_data.status_line.reason,
-                        stylesheet_url.uri);
-                return {};
-            }
+    // First render with what's already here: the default and inline style.
+    // The linked sheets are merged below as their downloads finish.
+    css::merge_duplicates(stylesheet_);
+    spdlog::info("Styling dom w/ {} rules", stylesheet_.size());
+    auto style_start = std::chrono::steady_clock::now();
+    style::SelectorIndex initial_index{stylesheet_};
+    initial_index.set_media_width(layout_width_);
+    speculative_layouts_.clear();
+    styled_ = style::style_tree(dom_.html_node, initial_index);
+    record_phase("style", style_start, dom_.node_count);
+    auto layout_start = std::chrono::steady_clock::now();
+    layout_ = layout::create_layout(*styled_, layout_width_);
+    record_phase("layout", layout_start, box_count(*layout_));
+    layout_damage_.clear();
+    record_memory();
+    on_page_loaded_();
 
-            return css::parse(style_data.body);
-        }));
+    // In order, wait for the downloads to finish and merge with the big stylesheet.
+    bool any_linked_rules{false};
+    bool linked_rules_affect_layout{false};
+    auto stylesheets_start = std::chrono::steady_clock::now();
+    std::size_t linked_rule_count{};
+    std::vector<style::SelectorIndex::Partial> index_partials;
+    if (!future_new_rules.empty()) {
+        // The partial for everything merged so far; the linked sheets'
+        // partials were built on the workers that parsed them.
+        index_partials.reserve(future_new_rules.size() + 1);
+        index_partials.emplace_back(stylesheet_);
     }
 
-    // In order, wait for the download to finish and merge with the big stylesheet.
     for (auto &future_rules : future_new_rules) {
-        auto rules = future_rules.get();
+        if (cancelled()) {
+            return;
+        }
+
+        auto [rules, partial] = future_rules.get();
+        any_linked_rules = any_linked_rules || !rules.empty();
+        linked_rules_affect_layout = linked_rules_affect_layout || std::ranges::any_of(rules, [](auto const &rule) {
+            return std::ranges::any_of(
+                    rule.declarations, [](auto const &decl) { return css::is_layout_affecting(decl.first); });
+        });
+        linked_rule_count += rules.size();
+        index_partials.push_back(std::move(partial));
         stylesheet_.reserve(stylesheet_.size() + rules.size());
         stylesheet_.insert(
                 end(stylesheet_), std::make_move_iterator(begin(rules)), std::make_move_iterator(end(rules)));
     }
 
-    spdlog::info("Styling dom w/ {} rules", stylesheet_.size());
-    styled_ = style::style_tree(dom_.html_node, stylesheet_);
-    layout_ = layout::create_layout(*styled_, layout_width_);
-    on_page_loaded_();
+    if (!future_new_rules.empty()) {
+        record_phase("linked_stylesheets", stylesheets_start, linked_rule_count);
+    }
+
+    if (any_linked_rules && !cancelled()) {
+        // Framework sheets redefine the same selectors repeatedly, so the
+        // merged stylesheet often shrinks a lot here. Consolidation moves
+        // rules around, which invalidates the partials' indices; when it
+        // actually removed something, the index is rebuilt from the smaller
+        // stylesheet instead of spliced.
+        auto dropped = css::merge_duplicates(stylesheet_);
+        if (dropped > 0) {
+            spdlog::info("Merged {} duplicate rules", dropped);
+        }
+
+        spdlog::info("Restyling dom w/ {} rules", stylesheet_.size());
+        auto restyle_start = std::chrono::steady_clock::now();
+        auto index = dropped > 0 ? style::SelectorIndex{stylesheet_} : style::SelectorIndex{stylesheet_, index_partials};
+        index.set_media_width(layout_width_);
+        auto restyled = style::style_tree(dom_.html_node, index);
+        record_phase("restyle", restyle_start, dom_.node_count);
+        if (linked_rules_affect_layout || !layout_.has_value()) {
+            speculative_layouts_.clear();
+            styled_ = std::move(restyled);
+            auto relayout_start = std::chrono::steady_clock::now();
+            layout_ = layout::create_layout(*styled_, layout_width_);
+            record_phase("relayout", relayout_start, box_count(*layout_));
+        } else {
+            // The linked sheets only change how things paint, so the boxes'
+            // geometry is still right. Move the restyled properties into the
+            // tree the layout points into instead of rebuilding the layout.
+            adopt_properties(*styled_, std::move(*restyled));
+        }
+        layout_damage_.clear();
+        record_memory();
+        on_layout_update_();
+    }
+
+    if (!cancelled()) {
+        // The styled and layout trees point into the document, so the cache
+        // holds copies of everything they're rebuilt from instead.
+        page_cache_.insert(uri_.uri, {response_, dom_, stylesheet_});
+    }
+
+    // Diagnostic dumps of what the navigation produced. Stringifying a big
+    // page is expensive, so it's skipped entirely unless debug logging is on.
+    if (spdlog::should_log(spdlog::level::debug)) {
+        spdlog::debug("dom: {}", dom::to_string(dom_));
+        if (layout_.has_value()) {
+            spdlog::debug("layout: {}", layout::to_string(*layout_));
+        }
+    }
+}
+
+std::shared_ptr<img::Png const> Engine::request_image(uri::Uri const &uri) {
+    {
+        std::scoped_lock lock{context_->images.mutex};
+        if (auto cached = context_->images.cache.find(uri.uri)) {
+            return cached;
+        }
+    }
+
+    {
+        std::scoped_lock lock{images_->mutex};
+        if (!images_->pending.insert(uri.uri).second) {
+            // Already being fetched and decoded.
+            return nullptr;
+        }
+    }
+
+    scheduler_->fetch_image(
+            uri, [ctx = context_, images = images_.get(), uri = uri.uri](std::shared_ptr<img::Png const> image) {
+                {
+                    std::scoped_lock lock{images->mutex};
+                    images->pending.erase(uri);
+                }
+
+                if (image == nullptr) {
+                    return;
+                }
+
+                {
+                    std::scoped_lock lock{ctx->images.mutex};
+                    ctx->images.cache.insert(uri, std::move(image));
+                }
+
+                images->on_loaded();
+            });
+
+    return nullptr;
+}
+
+void Engine::record_phase(std::string name, std::chrono::steady_clock::time_point start, std::size_t output_size) {
+    auto now = std::chrono::steady_clock::now();
+    metrics_.phases.push_back({
+            .name = std::move(name),
+            .start_us = std::chrono::duration_cast<std::chrono::microseconds>(start - navigation_start_).count(),
+            .duration_us = std::chrono::duration_cast<std::chrono::microseconds>(now - start).count(),
+            .output_size = output_size,
+    });
+}
+
+void Engine::record_memory() {
+    metrics_.memory = {
+            .response_bytes = memory_estimate(response_),
+            .dom_bytes = memory_estimate(dom_),
+            .stylesheet_bytes = memory_estimate(stylesheet_),
+            .styled_bytes = styled_ != nullptr ? memory_estimate(*styled_) : 0,
+            .layout_bytes = layout_.has_value() ? memory_estimate(*layout_) : 0,
+    };
 }
 
 } // namespace engine
@@ -8,38 +8,111 @@
 
 #include "css/rule.h"
 #include "dom/dom.h"
+#include "engine/browser_context.h"
+#include "engine/idle_scheduler.h"
+#include "engine/image_cache.h"
+#include "engine/navigation_metrics.h"
+#include "engine/page_cache.h"
+#include "engine/resource_scheduler.h"
+#include "geom/geom.h"
+#include "html2/tokenizer.h"
 #include "layout/layout.h"
 #include "protocol/iprotocol_handler.h"
 #include "style/styled_node.h"
 #include "uri/uri.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
 namespace engine {
 
+// Cooperative cancellation for in-flight navigations: set to true to ask the
+// engine to abandon the navigation. Checked between pipeline stages, so a
+// cancelled navigation may still finish the stage it's in.
+using CancellationToken = std::shared_ptr<std::atomic<bool>>;
+
+// How the navigation was initiated. History navigations (back/forward) may
+// restore the page from the in-memory page cache instead of refetching.
+enum class NavigationKind {
+    Standard,
+    History,
+};
+
 class Engine {
 public:
-    explicit Engine(std::unique_ptr<protocol::IProtocolHandler> protocol_handler)
-        : protocol_handler_{std::move(protocol_handler)} {}
-
-    protocol::Error navigate(uri::Uri uri);
+    // Engines sharing a context share its caches; see BrowserContext. Without
+    // one, the engine gets a private context and behaves like it always has.
+    explicit Engine(std::unique_ptr<protocol::IProtocolHandler> protocol_handler,
+            std::shared_ptr<BrowserContext> context = nullptr)
+        : protocol_handler_{std::move(protocol_handler)},
+          context_{context != nullptr ? std::move(context) : std::make_shared<BrowserContext>()} {}
+
+    // A cancelled navigation returns early without invoking any callbacks,
+    // and may leave the engine with a mix of old and new page state.
+    protocol::Error navigate(
+            uri::Uri uri, CancellationToken const &cancel = nullptr, NavigationKind = NavigationKind::Standard);
 
     void set_layout_width(int width);
 
+    // Queues an idle task that precomputes and caches the layout at width,
+    // so a later set_layout_width landing there swaps trees instead of
+    // relayouting. Each width costs the idle worker a full geometry pass.
+    // The cache is bounded and dropped whenever the styled tree it points
+    // into is rebuilt.
+    void speculate_layout_width(int width);
+
+    // Background work queued here runs only while no navigation or layout
+    // is in flight, and yields to them at task checkpoints. Exposed so the
+    // browser can park its own deferrable work (cache warming and the like)
+    // behind the engine's definition of idle.
+    IdleScheduler &idle_scheduler() { return *idle_; }
+
     void set_on_navigation_failure(auto cb) { on_navigation_failure_ = std::move(cb); }
     void set_on_page_loaded(auto cb) { on_page_loaded_ = std::move(cb); }
     void set_on_layout_updated(auto cb) { on_layout_update_ = std::move(cb); }
+    // Runs on a scheduler worker, so keep it to waking the renderer up.
+    void set_on_image_loaded(auto cb) { images_->on_loaded = std::move(cb); }
+
+    // Returns the decoded image for the URI if it's already cached. If it
+    // isn't, a fetch-and-decode is queued on the scheduler's workers and
+    // nullptr is returned: the renderer should paint a placeholder and
+    // repaint when on_image_loaded says the bitmap has been swapped in.
+    // Navigation never waits for image decodes.
+    [[nodiscard]] std::shared_ptr<img::Png const> request_image(uri::Uri const &uri);
 
     uri::Uri const &uri() const { return uri_; }
     protocol::Response const &response() const { return response_; }
+
+    // The handler navigations go through. Exposed so the browser can warm its
+    // caches, e.g. by prefetching a link the user is hovering.
+    protocol::IProtocolHandler &protocol_handler() { return *protocol_handler_; }
+
     dom::Document const &dom() const { return dom_; }
     std::vector<css::Rule> const &stylesheet() const { return stylesheet_; }
     layout::LayoutBox const *layout() const { return layout_.has_value() ? &*layout_ : nullptr; }
 
+    // The regions damaged by the most recent layout update. Empty means the
+    // renderer should assume everything changed.
+    std::vector<geom::Rect> const &layout_damage() const { return layout_damage_; }
+
+    // Per-phase wall times, output sizes, and live per-stage byte counts for
+    // the most recent navigation.
+    NavigationMetrics const &navigation_metrics() const { return metrics_; }
+
+    // Decoded images, shared across navigations (and with every engine on the
+    // same context) so repeat visits and repeated images only decode once.
+    // The cache's hit and miss counters say how well that's working out.
+    ImageCache &image_cache() { return context_->images.cache; }
+
 private:
     std::function<void(protocol::Error)> on_navigation_failure_{[](protocol::Error) {
     }};
@@ -51,15 +124,60 @@ private:
     int layout_width_{};
 
     std::unique_ptr<protocol::IProtocolHandler> protocol_handler_{};
+    // Declared before the scheduler so workers capturing it by value keep the
+    // shared caches alive.
+    std::shared_ptr<BrowserContext> context_{};
+    // Per-engine image state touched from scheduler workers. The decoded
+    // images themselves live on the context. Held by pointer so the engine
+    // stays movable while a worker holds on to it, and declared before the
+    // scheduler so the workers can't outlive it.
+    struct ImageState {
+        std::mutex mutex{};
+        // URIs with a fetch-and-decode in flight, so a repaint full of
+        // placeholders doesn't queue the same image again.
+        std::set<std::string, std::less<>> pending{};
+        std::function<void()> on_loaded{[] {
+        }};
+    };
+    std::unique_ptr<ImageState> images_{std::make_unique<ImageState>()};
+    // All fetches go through the scheduler so the document wins over
+    // subresources and no host is hit with too many parallel requests. Held
+    // by pointer so the engine stays movable.
+    std::unique_ptr<ResourceScheduler> scheduler_{std::make_unique<ResourceScheduler>(*protocol_handler_)};
 
     uri::Uri uri_{};
     protocol::Response response_{};
+    // Retained across navigations so the tokenizer's buffers keep their
+    // capacity from one document to the next.
+    html2::TokenizerScratch tokenizer_scratch_{};
     dom::Document dom_{};
     std::vector<css::Rule> stylesheet_{};
     std::unique_ptr<style::StyledNode> styled_{};
     std::optional<layout::LayoutBox> layout_{};
+    std::vector<geom::Rect> layout_damage_{};
+
+    // Layouts precomputed at widths a resize is likely to land on, newest
+    // last. The trees point into styled_, so the cache is cleared whenever
+    // styled_ is rebuilt.
+    std::vector<std::pair<int, layout::LayoutBox>> speculative_layouts_{};
+    static constexpr std::size_t kMaxSpeculativeLayouts{8};
+
+    NavigationMetrics metrics_{};
+    std::chrono::steady_clock::time_point navigation_start_{};
+
+    PageCache page_cache_{};
+
+    void record_phase(std::string name, std::chrono::steady_clock::time_point start, std::size_t output_size);
+
+    // Re-measures what every pipeline stage holds into metrics_.memory.
+    // Called whenever a stage's output is replaced, not per query.
+    void record_memory();
+
+    void on_navigation_success(CancellationToken const &);
 
-    void on_navigation_success();
+    // Declared last so destruction joins the idle worker, and drops the
+    // tasks reading the members above, before any of those members go away.
+    std::unique_ptr<IdleScheduler> idle_{std::make_unique<IdleScheduler>()};
 };
 
 } // namespace engine
@@ -4,11 +4,19 @@
 
 #include "engine/engine.h"
 
+#include "dom/dom.h"
 #include "etest/etest.h"
+#include "img/png.h"
 #include "protocol/iprotocol_handler.h"
 #include "protocol/response.h"
 #include "uri/uri.h"
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <utility>
 
 using namespace std::literals;
@@ -21,10 +29,33 @@ namespace {
 class FakeProtocolHandler final : public protocol::IProtocolHandler {
 public:
     explicit FakeProtocolHandler(protocol::Response response) : response_{std::move(response)} {}
-    [[nodiscard]] protocol::Response handle(uri::Uri const &) override { return response_; }
+    [[nodiscard]] protocol::Response handle(uri::Uri const &, protocol::Deadline = std::nullopt) override {
+        ++requests_handled_;
+        return response_;
+    }
+
+    [[nodiscard]] int requests_handled() const { return requests_handled_; }
 
 private:
     protocol::Response response_;
+    int requests_handled_{};
+};
+
+class MultiPageProtocolHandler final : public protocol::IProtocolHandler {
+public:
+    explicit MultiPageProtocolHandler(std::map<std::string, protocol::Response, std::less<>> responses)
+        : responses_{std::move(responses)} {}
+
+    [[nodiscard]] protocol::Response handle(uri::Uri const &uri, protocol::Deadline = std::nullopt) override {
+        if (auto it = responses_.find(uri.uri); it != responses_.end()) {
+            return it->second;
+        }
+
+        return {.err = protocol::Error::Unresolved};
+    }
+
+private:
+    std::map<std::string, protocol::Response, std::less<>> responses_;
 };
 
 } // namespace
@@ -49,6 +80,7 @@ int main() {
         expect_eq(e.stylesheet().back(),
                 css::Rule{
                         .selectors{"p"},
+                        .selector_specificities{1},
                         .declarations{{css::PropertyId::FontSize, "123em"}},
                 });
     });
@@ -96,6 +128,144 @@ int main() {
 
         e.set_layout_width(100);
         expect(success);
+
+        // Setting the same width again shouldn't redo the layout.
+        success = false;
+        e.set_layout_width(100);
+        expect(!success);
+    });
+
+    etest::test("history navigation restores from the page cache", [] {
+        auto handler = std::make_unique<FakeProtocolHandler>(protocol::Response{
+                .err = protocol::Error::Ok,
+                .status_line = {.status_code = 200},
+                .body{"<html><body><p>hello</p></body></html>"},
+        });
+        auto *handler_ptr = handler.get();
+        engine::Engine e{std::move(handler)};
+
+        e.navigate(uri::Uri::parse("hax://example.com"));
+        expect_eq(handler_ptr->requests_handled(), 1);
+        auto cached_dom = dom::to_string(e.dom());
+
+        e.navigate(uri::Uri::parse("hax://example.com/other"));
+        expect_eq(handler_ptr->requests_handled(), 2);
+
+        // Going back restores the first page without touching the network.
+        bool loaded{false};
+        e.set_on_page_loaded([&] { loaded = true; });
+        e.navigate(uri::Uri::parse("hax://example.com"), nullptr, engine::NavigationKind::History);
+        expect_eq(handler_ptr->requests_handled(), 2);
+        expect(loaded);
+        expect_eq(dom::to_string(e.dom()), cached_dom);
+        require(e.layout());
+
+        // A non-history navigation to the same uri still refetches.
+        e.navigate(uri::Uri::parse("hax://example.com"));
+        expect_eq(handler_ptr->requests_handled(), 3);
+    });
+
+    etest::test("navigation metrics", [] {
+        engine::Engine e{std::make_unique<FakeProtocolHandler>(protocol::Response{
+                .err = protocol::Error::Ok,
+                .status_line = {.status_code = 200},
+                .body{"<html><head><style>p { font-size: 123em; }</style></head></html>"},
+        })};
+        e.navigate(uri::Uri::parse("hax://example.com"));
+
+        auto const &metrics = e.navigation_metrics();
+        expect_eq(metrics.uri, "hax://example.com"s);
+
+        auto has_phase = [&](std::string_view name) {
+            return std::ranges::any_of(metrics.phases, [&](auto const &phase) { return phase.name == name; });
+        };
+        expect(has_phase("fetch"));
+        expect(has_phase("html_parse"));
+        expect(has_phase("css_parse"));
+        expect(has_phase("style"));
+        expect(has_phase("layout"));
+
+        auto trace = metrics.to_trace_json();
+        expect(trace.starts_with(R"({"traceEvents":[)"));
+        expect(trace.contains(R"("name":"fetch")"));
+        expect(trace.contains(R"("ph":"X")"));
+    });
+
+    etest::test("images: cached bitmaps are returned, the rest get placeholders", [] {
+        engine::Engine e{std::make_unique<FakeProtocolHandler>(protocol::Response{.err = protocol::Error::Unresolved})};
+
+        auto uri = uri::Uri::parse("hax://example.com/a.png");
+        auto image = std::make_shared<img::Png const>();
+        e.image_cache().insert(uri.uri, image);
+        expect_eq(e.request_image(uri), image);
+
+        // This fetch fails, so the caller stays on its placeholder.
+        expect_eq(e.request_image(uri::Uri::parse("hax://example.com/missing.png")), nullptr);
+    });
+
+    etest::test("paint-only linked stylesheets repaint without relayouting", [] {
+        auto page = protocol::Response{
+                .err = protocol::Error::Ok,
+                .status_line = {.status_code = 200},
+                .body{"<html><head>"
+                      R"(<link rel="stylesheet" href="hax://example.com/style.css">)"
+                      "</head><body><p>hi</p></body></html>"},
+        };
+
+        engine::Engine e{std::make_unique<MultiPageProtocolHandler>(std::map<std::string, protocol::Response,
+                std::less<>>{
+                {"hax://example.com", page},
+                {"hax://example.com/style.css",
+                        {.err = protocol::Error::Ok,
+                                .status_line = {.status_code = 200},
+                                .body{"p { color: #aabbcc; }"}}},
+        })};
+
+        // The linked sheet only changes paint, so the restyle should reuse
+        // the styled tree the layout already points into.
+        style::StyledNode const *styled_at_first_paint{nullptr};
+        e.set_on_page_loaded([&] { styled_at_first_paint = e.layout()->node; });
+        bool restyled{false};
+        e.set_on_layout_updated([&] { restyled = true; });
+
+        e.navigate(uri::Uri::parse("hax://example.com"));
+        expect(restyled);
+        require(e.layout());
+        expect_eq(e.layout()->node, styled_at_first_paint);
+
+        auto ps = dom::nodes_by_xpath(*e.layout(), "//p");
+        require(!ps.empty());
+        expect_eq(ps[0]->get_property<css::PropertyId::Color>(), gfx::Color{0xaa, 0xbb, 0xcc});
+    });
+
+    etest::test("layout-affecting linked stylesheets relayout", [] {
+        auto page = protocol::Response{
+                .err = protocol::Error::Ok,
+                .status_line = {.status_code = 200},
+                .body{"<html><head>"
+                      R"(<link rel="stylesheet" href="hax://example.com/style.css">)"
+                      "</head><body><p>hi</p></body></html>"},
+        };
+
+        engine::Engine e{std::make_unique<MultiPageProtocolHandler>(std::map<std::string, protocol::Response,
+                std::less<>>{
+                {"hax://example.com", page},
+                {"hax://example.com/style.css",
+                        {.err = protocol::Error::Ok,
+                                .status_line = {.status_code = 200},
+                                .body{"p { font-size: 12px; }"}}},
+        })};
+
+        bool restyled{false};
+        e.set_on_layout_updated([&] { restyled = true; });
+
+        e.navigate(uri::Uri::parse("hax://example.com"));
+        expect(restyled);
+        require(e.layout());
+
+        auto ps = dom::nodes_by_xpath(*e.layout(), "//p");
+        require(!ps.empty());
+        expect_eq(ps[0]->get_property<css::PropertyId::FontSize>(), 12);
     });
 
     etest::test("css in <head><style> takes priority over browser built-in css", [] {
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/idle_scheduler.h"
+
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace engine {
+
+IdleScheduler::IdleScheduler() : worker_{[this] { run_worker(); }} {}
+
+IdleScheduler::~IdleScheduler() {
+    {
+        std::scoped_lock lock{mutex_};
+        shutting_down_ = true;
+        tasks_.clear();
+    }
+    work_available_.notify_all();
+    worker_.join();
+}
+
+void IdleScheduler::schedule(std::function<bool()> step) {
+    {
+        std::scoped_lock lock{mutex_};
+        tasks_.push_back(std::move(step));
+    }
+    work_available_.notify_one();
+}
+
+void IdleScheduler::pause() {
+    std::unique_lock lock{mutex_};
+    ++pauses_;
+    slice_finished_.wait(lock, [this] { return !slice_in_flight_; });
+}
+
+void IdleScheduler::resume() {
+    {
+        std::scoped_lock lock{mutex_};
+        --pauses_;
+    }
+    work_available_.notify_one();
+}
+
+void IdleScheduler::run_worker() {
+    std::unique_lock lock{mutex_};
+    while (true) {
+        work_available_.wait(lock, [this] { return shutting_down_ || (pauses_ == 0 && !tasks_.empty()); });
+        if (shutting_down_) {
+            return;
+        }
+
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        slice_in_flight_ = true;
+
+        lock.unlock();
+        bool more_slices = task();
+        lock.lock();
+
+        slice_in_flight_ = false;
+        if (more_slices && !shutting_down_) {
+            // Back at the front: the task resumes from its checkpoint once
+            // the scheduler is idle again, before anything queued later.
+            tasks_.push_front(std::move(task));
+        }
+        slice_finished_.notify_all();
+    }
+}
+
+} // namespace engine
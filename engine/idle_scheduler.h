@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ENGINE_IDLE_SCHEDULER_H_
+#define ENGINE_IDLE_SCHEDULER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace engine {
+
+// Runs low-priority work on a background thread, but only while nothing
+// interactive is going on. A task is a step function doing one bounded
+// slice of work per call and returning whether more remains; the slice
+// boundaries are the preemption checkpoints. pause() stops new slices
+// from starting and waits out the one in flight, so whoever holds a
+// BusyScope has the scheduler's tasks fully stopped — not just asked to
+// stop — and background work never runs concurrently with, or adds
+// latency to, the interactive path.
+class IdleScheduler {
+public:
+    IdleScheduler();
+
+    // Drops the tasks still queued and waits for the in-flight slice.
+    ~IdleScheduler();
+
+    IdleScheduler(IdleScheduler const &) = delete;
+    IdleScheduler &operator=(IdleScheduler const &) = delete;
+
+    // Queues the task. Tasks run in scheduling order, one at a time, each
+    // to completion before the next starts.
+    void schedule(std::function<bool()> step);
+
+    // Pauses stack, so nested busy sections each get to mark themselves.
+    // Returns with no slice in flight.
+    void pause();
+    void resume();
+
+    // Marks a section of interactive work: slices stop for as long as any
+    // BusyScope is alive.
+    class [[nodiscard]] BusyScope {
+    public:
+        explicit BusyScope(IdleScheduler &scheduler) : scheduler_{scheduler} { scheduler_.pause(); }
+        ~BusyScope() { scheduler_.resume(); }
+
+        BusyScope(BusyScope const &) = delete;
+        BusyScope &operator=(BusyScope const &) = delete;
+
+    private:
+        IdleScheduler &scheduler_;
+    };
+
+private:
+    void run_worker();
+
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable slice_finished_;
+    std::deque<std::function<bool()>> tasks_;
+    std::size_t pauses_{};
+    bool slice_in_flight_{};
+    bool shutting_down_{};
+
+    std::thread worker_;
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/idle_scheduler.h"
+
+#include "etest/etest.h"
+
+#include <atomic>
+#include <chrono>
+#include <semaphore>
+#include <thread>
+
+using namespace std::chrono_literals;
+using etest::expect;
+using etest::expect_eq;
+
+namespace {
+// The scheduler's worker runs asynchronously, so tests wait for its side
+// effects instead of asserting on them immediately.
+template<typename Predicate>
+bool eventually(Predicate const &predicate) {
+    for (int i = 0; i < 500; ++i) {
+        if (predicate()) {
+            return true;
+        }
+        std::this_thread::sleep_for(10ms);
+    }
+    return predicate();
+}
+} // namespace
+
+int main() {
+    etest::test("tasks run slice by slice until they say they're done", [] {
+        engine::IdleScheduler scheduler;
+        std::atomic<int> slices{0};
+        scheduler.schedule([&] { return ++slices < 3; });
+        expect(eventually([&] { return slices == 3; }));
+
+        // Done means done: the task mustn't be rescheduled.
+        std::this_thread::sleep_for(50ms);
+        expect_eq(slices.load(), 3);
+    });
+
+    etest::test("no slices start while a busy scope is alive", [] {
+        engine::IdleScheduler scheduler;
+        std::atomic<int> slices{0};
+        {
+            engine::IdleScheduler::BusyScope busy{scheduler};
+            scheduler.schedule([&] { return ++slices < 2; });
+            std::this_thread::sleep_for(50ms);
+            expect_eq(slices.load(), 0);
+        }
+
+        expect(eventually([&] { return slices == 2; }));
+    });
+
+    etest::test("pausing waits out the slice in flight", [] {
+        engine::IdleScheduler scheduler;
+        std::binary_semaphore slice_started{0};
+        std::binary_semaphore release_slice{0};
+        std::atomic<bool> slice_done{false};
+        scheduler.schedule([&] {
+            slice_started.release();
+            release_slice.acquire();
+            slice_done = true;
+            return false;
+        });
+
+        slice_started.acquire();
+        std::atomic<bool> paused{false};
+        std::thread pauser{[&] {
+            scheduler.pause();
+            paused = true;
+        }};
+
+        // The pauser must be stuck behind the slice we're holding open.
+        std::this_thread::sleep_for(50ms);
+        expect(!paused);
+
+        release_slice.release();
+        expect(eventually([&] { return paused.load(); }));
+        expect(slice_done.load());
+
+        pauser.join();
+        scheduler.resume();
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/image_cache.h"
+
+#include "img/png.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace engine {
+
+std::shared_ptr<img::Png const> ImageCache::get_or_decode(std::string uri, std::istream &bytes) {
+    if (auto cached = find(uri)) {
+        return cached;
+    }
+
+    auto png = img::Png::from(bytes);
+    if (!png) {
+        return nullptr;
+    }
+
+    auto image = std::make_shared<img::Png const>(*std::move(png));
+    insert(std::move(uri), image);
+    return image;
+}
+
+std::shared_ptr<img::Png const> ImageCache::find(std::string_view uri) {
+    auto it = std::ranges::find(images_, uri, [](auto const &entry) { return std::string_view{entry.first}; });
+    if (it == images_.end()) {
+        misses_ += 1;
+        return nullptr;
+    }
+
+    hits_ += 1;
+    images_.splice(images_.begin(), images_, it);
+    return images_.front().second;
+}
+
+void ImageCache::insert(std::string uri, std::shared_ptr<img::Png const> image) {
+    // The new image replaces any old one cached for the same uri.
+    if (auto it = std::ranges::find(images_, uri, &std::pair<std::string, std::shared_ptr<img::Png const>>::first);
+            it != images_.end()) {
+        size_bytes_ -= estimated_size_of(*it->second);
+        images_.erase(it);
+    }
+
+    auto image_size = estimated_size_of(*image);
+    if (image_size > max_bytes_) {
+        return;
+    }
+
+    size_bytes_ += image_size;
+    images_.emplace_front(std::move(uri), std::move(image));
+
+    while (size_bytes_ > max_bytes_) {
+        size_bytes_ -= estimated_size_of(*images_.back().second);
+        images_.pop_back();
+    }
+}
+
+std::size_t ImageCache::estimated_size_of(img::Png const &image) {
+    return sizeof(img::Png) + image.bytes.capacity();
+}
+
+} // namespace engine
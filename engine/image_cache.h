@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ENGINE_IMAGE_CACHE_H_
+#define ENGINE_IMAGE_CACHE_H_
+
+#include "img/png.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace engine {
+
+// Bounded in-memory cache of decoded images, keyed by URI, so repeat visits
+// and repeated images on one page only pay for decoding once. Entries are
+// shared rather than taken: the same bitmap may be painted from several
+// places at once. The least-recently-used images are evicted once the
+// decoded bytes exceed the cap.
+class ImageCache {
+public:
+    static constexpr std::size_t kDefaultMaxBytes{std::size_t{64} * 1024 * 1024};
+
+    explicit ImageCache(std::size_t max_bytes = kDefaultMaxBytes) : max_bytes_{max_bytes} {}
+
+    // Returns the image cached for the URI, decoding and caching it on a
+    // miss. Returns nullptr if the bytes don't decode.
+    [[nodiscard]] std::shared_ptr<img::Png const> get_or_decode(std::string uri, std::istream &&bytes) {
+        return get_or_decode(std::move(uri), bytes);
+    }
+    [[nodiscard]] std::shared_ptr<img::Png const> get_or_decode(std::string uri, std::istream &bytes);
+
+    [[nodiscard]] std::shared_ptr<img::Png const> find(std::string_view uri);
+    void insert(std::string uri, std::shared_ptr<img::Png const>);
+
+    [[nodiscard]] std::size_t size_bytes() const { return size_bytes_; }
+
+    // How often find() was answered from the cache. A low hit rate on an
+    // image-heavy page means the byte budget is too small for it.
+    [[nodiscard]] std::size_t hits() const { return hits_; }
+    [[nodiscard]] std::size_t misses() const { return misses_; }
+
+    [[nodiscard]] static std::size_t estimated_size_of(img::Png const &);
+
+private:
+    std::size_t max_bytes_{};
+    std::size_t size_bytes_{};
+    std::size_t hits_{};
+    std::size_t misses_{};
+    // Most recently used first.
+    std::list<std::pair<std::string, std::shared_ptr<img::Png const>>> images_{};
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/image_cache.h"
+
+#include "etest/etest.h"
+#include "img/png.h"
+
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+using etest::expect;
+using etest::expect_eq;
+
+namespace {
+
+std::shared_ptr<img::Png const> image_of_size(std::size_t byte_count) {
+    return std::make_shared<img::Png const>(img::Png{.bytes = std::vector<unsigned char>(byte_count)});
+}
+
+} // namespace
+
+int main() {
+    etest::test("insert and find", [] {
+        engine::ImageCache cache{};
+        expect_eq(cache.find("hax://example.com/a.png"), nullptr);
+
+        auto image = image_of_size(16);
+        cache.insert("hax://example.com/a.png", image);
+        expect_eq(cache.find("hax://example.com/a.png"), image);
+
+        // Finding shares the entry rather than taking it.
+        expect_eq(cache.find("hax://example.com/a.png"), image);
+    });
+
+    etest::test("hit and miss counters", [] {
+        engine::ImageCache cache{};
+        expect_eq(cache.find("hax://example.com/a.png"), nullptr);
+        expect_eq(cache.misses(), std::size_t{1});
+        expect_eq(cache.hits(), std::size_t{0});
+
+        cache.insert("hax://example.com/a.png", image_of_size(16));
+        expect(cache.find("hax://example.com/a.png") != nullptr);
+        expect_eq(cache.misses(), std::size_t{1});
+        expect_eq(cache.hits(), std::size_t{1});
+    });
+
+    etest::test("the least recently used image is evicted first", [] {
+        engine::ImageCache cache{2 * engine::ImageCache::estimated_size_of(*image_of_size(16))};
+        cache.insert("hax://a.com/a.png", image_of_size(16));
+        cache.insert("hax://b.com/b.png", image_of_size(16));
+
+        // Touch a so that b is the least recently used image.
+        expect(cache.find("hax://a.com/a.png") != nullptr);
+
+        cache.insert("hax://c.com/c.png", image_of_size(16));
+        expect_eq(cache.find("hax://b.com/b.png"), nullptr);
+        expect(cache.find("hax://a.com/a.png") != nullptr);
+        expect(cache.find("hax://c.com/c.png") != nullptr);
+    });
+
+    etest::test("inserting the same uri again replaces the old image", [] {
+        engine::ImageCache cache{};
+        cache.insert("hax://example.com/a.png", image_of_size(16));
+        auto replacement = image_of_size(32);
+        cache.insert("hax://example.com/a.png", replacement);
+
+        expect_eq(cache.find("hax://example.com/a.png"), replacement);
+        expect_eq(cache.size_bytes(), engine::ImageCache::estimated_size_of(*replacement));
+    });
+
+    etest::test("images larger than the cache aren't cached", [] {
+        engine::ImageCache cache{1};
+        cache.insert("hax://example.com/a.png", image_of_size(16));
+        expect_eq(cache.find("hax://example.com/a.png"), nullptr);
+        expect_eq(cache.size_bytes(), std::size_t{0});
+    });
+
+    etest::test("get_or_decode rejects broken images without caching them", [] {
+        engine::ImageCache cache{};
+        expect_eq(cache.get_or_decode("hax://example.com/a.png", std::stringstream{"not a png"}), nullptr);
+        expect_eq(cache.size_bytes(), std::size_t{0});
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/memory_metrics.h"
+
+#include "css/rule.h"
+#include "css/value.h"
+#include "dom/dom.h"
+#include "layout/layout.h"
+#include "protocol/response.h"
+#include "style/styled_node.h"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace engine {
+namespace {
+
+std::size_t heap_bytes(std::string const &s) {
+    // A capacity at or below a default-constructed string's fits in the
+    // small-string buffer and owns no heap memory.
+    return s.capacity() > std::string{}.capacity() ? s.capacity() + 1 : 0;
+}
+
+std::size_t node_bytes(dom::Node const &node) {
+    if (auto const *text = std::get_if<dom::Text>(&node)) {
+        return heap_bytes(text->text);
+    }
+
+    auto const &element = std::get<dom::Element>(node);
+    std::size_t bytes = heap_bytes(element.name);
+    bytes += element.attributes.size() * sizeof(dom::AttrMap::value_type);
+    for (auto const &[name, value] : element.attributes) {
+        bytes += heap_bytes(name) + heap_bytes(value);
+    }
+
+    bytes += element.children.capacity() * sizeof(dom::Node);
+    for (auto const &child : element.children) {
+        bytes += node_bytes(child);
+    }
+
+    return bytes;
+}
+
+std::size_t styled_node_bytes(style::StyledNode const &node) {
+    std::size_t bytes{0};
+    if (node.properties.capacity() > 6) {
+        // Spilled out of the inline buffer onto the heap.
+        bytes += node.properties.capacity() * sizeof(node.properties[0]);
+    }
+    for (auto const &[id, value] : node.properties) {
+        bytes += heap_bytes(value);
+    }
+
+    bytes += node.children.capacity() * sizeof(style::StyledNode);
+    for (auto const &child : node.children) {
+        bytes += styled_node_bytes(child);
+    }
+
+    return bytes;
+}
+
+std::size_t layout_box_bytes(layout::LayoutBox const &box) {
+    std::size_t bytes{0};
+    if (box.text_metrics.has_value()) {
+        bytes += box.text_metrics->segments.capacity() * sizeof(layout::LayoutBox::TextSegment);
+    }
+
+    bytes += box.children.capacity() * sizeof(layout::LayoutBox);
+    for (auto const &child : box.children) {
+        bytes += layout_box_bytes(child);
+    }
+
+    return bytes;
+}
+
+} // namespace
+
+std::size_t memory_estimate(protocol::Response const &response) {
+    // The body dominates; the headers and status line are noise next to it.
+    return response.body.size();
+}
+
+std::size_t memory_estimate(dom::Document const &document) {
+    return heap_bytes(document.doctype) + node_bytes(document.html_node);
+}
+
+std::size_t memory_estimate(std::vector<css::Rule> const &rules) {
+    std::size_t bytes = rules.capacity() * sizeof(css::Rule);
+    for (auto const &rule : rules) {
+        bytes += rule.selectors.capacity() * sizeof(std::string);
+        for (auto const &selector : rule.selectors) {
+            bytes += heap_bytes(selector);
+        }
+
+        bytes += rule.selector_specificities.capacity() * sizeof(rule.selector_specificities[0]);
+
+        // Rough per-node overhead for the red-black tree holding the
+        // declarations: the payload plus three pointers and a color.
+        bytes += rule.declarations.size() * (sizeof(std::map<css::PropertyId, css::Value>::value_type) + 4 * sizeof(void *));
+        for (auto const &[id, value] : rule.declarations) {
+            bytes += heap_bytes(value.raw);
+        }
+
+        bytes += heap_bytes(rule.media_query);
+    }
+
+    return bytes;
+}
+
+std::size_t memory_estimate(style::StyledNode const &node) {
+    return sizeof(style::StyledNode) + styled_node_bytes(node);
+}
+
+std::size_t memory_estimate(layout::LayoutBox const &box) {
+    return sizeof(layout::LayoutBox) + layout_box_bytes(box);
+}
+
+} // namespace engine
@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ENGINE_MEMORY_METRICS_H_
+#define ENGINE_MEMORY_METRICS_H_
+
+#include "css/rule.h"
+#include "dom/dom.h"
+#include "layout/layout.h"
+#include "protocol/response.h"
+#include "style/styled_node.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace engine {
+
+// Live byte estimates for what the pipeline stages hold, from walking the
+// structures: they include the strings and containers the stages own, but
+// not allocator slack. The results land in NavigationMetrics::memory.
+std::size_t memory_estimate(protocol::Response const &);
+std::size_t memory_estimate(dom::Document const &);
+std::size_t memory_estimate(std::vector<css::Rule> const &);
+std::size_t memory_estimate(style::StyledNode const &);
+std::size_t memory_estimate(layout::LayoutBox const &);
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/memory_metrics.h"
+
+#include "css/property_id.h"
+#include "css/rule.h"
+#include "dom/dom.h"
+#include "etest/etest.h"
+#include "layout/layout.h"
+#include "protocol/response.h"
+#include "style/styled_node.h"
+
+#include <string>
+#include <vector>
+
+using etest::expect;
+using etest::expect_eq;
+
+int main() {
+    etest::test("response memory is its body", [] {
+        protocol::Response response{};
+        expect_eq(engine::memory_estimate(response), std::size_t{0});
+
+        response.body = std::string(1000, 'a');
+        expect_eq(engine::memory_estimate(response), std::size_t{1000});
+    });
+
+    etest::test("bigger dom, bigger estimate", [] {
+        dom::Document small{.html_node = dom::Element{.name = "html"}};
+        dom::Document big{.html_node = dom::Element{
+                                  .name = "html",
+                                  .attributes = {{"style", std::string(100, 'x')}},
+                                  .children = {dom::Text{std::string(1000, 'a')}},
+                          }};
+
+        expect(engine::memory_estimate(big) > engine::memory_estimate(small) + 1000);
+    });
+
+    etest::test("stylesheet memory counts selectors and declarations", [] {
+        std::vector<css::Rule> empty{};
+        expect_eq(engine::memory_estimate(empty), std::size_t{0});
+
+        std::vector<css::Rule> rules{{
+                .selectors = {std::string(100, 'p')},
+                .declarations = {{css::PropertyId::Width, std::string(100, 'x')}},
+        }};
+        expect(engine::memory_estimate(rules) > 200);
+    });
+
+    etest::test("styled and layout trees count their children", [] {
+        dom::Node node = dom::Element{.name = "html"};
+        style::StyledNode child{.node = node};
+        style::StyledNode parent{.node = node, .children = {child, child, child}};
+        expect(engine::memory_estimate(parent) > engine::memory_estimate(child));
+
+        layout::LayoutBox leaf{.node = &parent};
+        layout::LayoutBox root{.node = &parent, .children = {leaf, leaf, leaf}};
+        expect(engine::memory_estimate(root) > engine::memory_estimate(leaf));
+    });
+
+    return etest::run_all_tests();
+}
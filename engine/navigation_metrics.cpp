@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/navigation_metrics.h"
+
+#include <fmt/format.h>
+
+#include <string>
+
+namespace engine {
+
+std::string NavigationMetrics::to_trace_json() const {
+    std::string events{};
+    for (auto const &phase : phases) {
+        if (!events.empty()) {
+            events += ',';
+        }
+
+        events += fmt::format(
+                R"({{"name":"{}","cat":"navigation","ph":"X","ts":{},"dur":{},"pid":1,"tid":1,"args":{{"output_size":{}}}}})",
+                phase.name,
+                phase.start_us,
+                phase.duration_us,
+                phase.output_size);
+    }
+
+    if (memory.total() > 0) {
+        if (!events.empty()) {
+            events += ',';
+        }
+
+        // A counter event, so the per-stage byte counts show up as a stacked
+        // track alongside the phase spans.
+        events += fmt::format(
+                R"({{"name":"memory","cat":"navigation","ph":"C","ts":0,"pid":1,)"
+                R"("args":{{"response":{},"dom":{},"stylesheet":{},"styled":{},"layout":{}}}}})",
+                memory.response_bytes,
+                memory.dom_bytes,
+                memory.stylesheet_bytes,
+                memory.styled_bytes,
+                memory.layout_bytes);
+    }
+
+    return fmt::format(R"({{"traceEvents":[{}]}})", events);
+}
+
+} // namespace engine
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ENGINE_NAVIGATION_METRICS_H_
+#define ENGINE_NAVIGATION_METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace engine {
+
+// One pipeline stage of a navigation: when it started relative to the start
+// of the navigation, how long it took, and how much it produced. What
+// output_size counts depends on the phase: bytes for fetches, nodes for
+// parses, boxes for layout.
+struct PhaseMetrics {
+    std::string name{};
+    std::int64_t start_us{};
+    std::int64_t duration_us{};
+    std::size_t output_size{};
+
+    [[nodiscard]] bool operator==(PhaseMetrics const &) const = default;
+};
+
+// Live byte counts per pipeline stage for the current page, so a
+// multi-hundred-MB tab can say whether the DOM, the styled tree, the layout
+// tree, or the response body owns the memory.
+struct MemoryMetrics {
+    std::size_t response_bytes{};
+    std::size_t dom_bytes{};
+    std::size_t stylesheet_bytes{};
+    std::size_t styled_bytes{};
+    std::size_t layout_bytes{};
+
+    [[nodiscard]] std::size_t total() const {
+        return response_bytes + dom_bytes + stylesheet_bytes + styled_bytes + layout_bytes;
+    }
+
+    [[nodiscard]] bool operator==(MemoryMetrics const &) const = default;
+};
+
+// Where the most recent navigation spent its time and what it holds on to.
+struct NavigationMetrics {
+    std::string uri{};
+    std::vector<PhaseMetrics> phases{};
+    MemoryMetrics memory{};
+
+    // Serializes into the trace-event format understood by chrome://tracing
+    // and https://ui.perfetto.dev/.
+    [[nodiscard]] std::string to_trace_json() const;
+
+    [[nodiscard]] bool operator==(NavigationMetrics const &) const = default;
+};
+
+} // namespace engine
+
+#endif
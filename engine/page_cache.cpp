@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/page_cache.h"
+
+#include "css/rule.h"
+#include "dom/dom.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <variant>
+
+namespace engine {
+namespace {
+
+std::size_t estimated_size_of(dom::Node const &node) {
+    if (auto const *text = std::get_if<dom::Text>(&node)) {
+        return sizeof(dom::Node) + text->text.capacity();
+    }
+
+    auto const &element = std::get<dom::Element>(node);
+    std::size_t size{sizeof(dom::Node) + element.name.capacity()};
+    for (auto const &[name, value] : element.attributes) {
+        size += sizeof(std::pair<std::string, std::string>) + name.capacity() + value.capacity();
+    }
+
+    for (auto const &child : element.children) {
+        size += estimated_size_of(child);
+    }
+
+    return size;
+}
+
+std::size_t estimated_size_of(css::Rule const &rule) {
+    std::size_t size{sizeof(css::Rule) + rule.media_query.capacity()};
+    for (auto const &selector : rule.selectors) {
+        size += sizeof(std::string) + selector.capacity();
+    }
+
+    size += rule.selector_specificities.capacity() * sizeof(std::uint32_t);
+    for (auto const &[id, value] : rule.declarations) {
+        size += sizeof(id) + sizeof(value) + value.raw.capacity();
+    }
+
+    return size;
+}
+
+} // namespace
+
+void PageCache::insert(std::string uri, CachedPage page) {
+    // The new page replaces any old one cached for the same uri.
+    std::ignore = take(uri);
+
+    auto page_size = estimated_size_of(page);
+    if (page_size > max_bytes_) {
+        return;
+    }
+
+    size_bytes_ += page_size;
+    pages_.emplace_front(std::move(uri), std::move(page));
+
+    while (size_bytes_ > max_bytes_) {
+        size_bytes_ -= estimated_size_of(pages_.back().second);
+        pages_.pop_back();
+    }
+}
+
+std::optional<CachedPage> PageCache::take(std::string_view uri) {
+    auto it = std::ranges::find(pages_, uri, &std::pair<std::string, CachedPage>::first);
+    if (it == pages_.end()) {
+        return std::nullopt;
+    }
+
+    auto page = std::move(it->second);
+    size_bytes_ -= estimated_size_of(page);
+    pages_.erase(it);
+    return page;
+}
+
+std::size_t PageCache::estimated_size_of(CachedPage const &page) {
+    std::size_t size{sizeof(CachedPage)};
+    size += page.response.body.size() + page.response.headers.to_string().size();
+    size += page.dom.doctype.capacity() + engine::estimated_size_of(page.dom.html_node);
+    for (auto const &rule : page.stylesheet) {
+        size += engine::estimated_size_of(rule);
+    }
+
+    return size;
+}
+
+} // namespace engine
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ENGINE_PAGE_CACHE_H_
+#define ENGINE_PAGE_CACHE_H_
+
+#include "css/rule.h"
+#include "dom/dom.h"
+#include "protocol/response.h"
+
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace engine {
+
+// A fully fetched and parsed page, kept around so history navigation can
+// restore it without refetching or re-parsing.
+struct CachedPage {
+    protocol::Response response{};
+    dom::Document dom{};
+    std::vector<css::Rule> stylesheet{};
+};
+
+// Bounded in-memory cache of recently visited pages, keyed by URI. The
+// least-recently-used pages are evicted once the estimated memory use
+// exceeds the cap.
+class PageCache {
+public:
+    static constexpr std::size_t kDefaultMaxBytes{std::size_t{16} * 1024 * 1024};
+
+    explicit PageCache(std::size_t max_bytes = kDefaultMaxBytes) : max_bytes_{max_bytes} {}
+
+    void insert(std::string uri, CachedPage page);
+
+    // Removes and returns the page cached for the URI, if any. The entry is
+    // taken rather than copied: restoring re-inserts the page afterwards.
+    [[nodiscard]] std::optional<CachedPage> take(std::string_view uri);
+
+    [[nodiscard]] std::size_t size_bytes() const { return size_bytes_; }
+
+    // How much memory the page is holding on to: the string and vector
+    // payloads plus the nodes themselves. An estimate, but proportional
+    // enough to keep eviction honest.
+    [[nodiscard]] static std::size_t estimated_size_of(CachedPage const &);
+
+private:
+    std::size_t max_bytes_{};
+    std::size_t size_bytes_{};
+    // Most recently used first.
+    std::list<std::pair<std::string, CachedPage>> pages_{};
+};
+
+} // namespace engine
+
+#endif
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/page_cache.h"
+
+#include "etest/etest.h"
+#include "protocol/response.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+using etest::expect;
+using etest::expect_eq;
+
+namespace {
+
+engine::CachedPage page_with_body(std::string body) {
+    return {.response{.body{std::move(body)}}};
+}
+
+} // namespace
+
+int main() {
+    etest::test("insert and take", [] {
+        engine::PageCache cache{};
+        expect(!cache.take("hax://example.com").has_value());
+
+        cache.insert("hax://example.com", page_with_body("<html></html>"));
+        auto page = cache.take("hax://example.com");
+        expect(page.has_value());
+        expect_eq(page->response.body, protocol::Body{"<html></html>"});
+
+        // Taking removes the entry.
+        expect(!cache.take("hax://example.com").has_value());
+    });
+
+    etest::test("inserting the same uri again replaces the old page", [] {
+        engine::PageCache cache{};
+        cache.insert("hax://example.com", page_with_body("old"));
+        cache.insert("hax://example.com", page_with_body("new"));
+
+        auto page = cache.take("hax://example.com");
+        expect(page.has_value());
+        expect_eq(page->response.body, protocol::Body{"new"});
+        expect(!cache.take("hax://example.com").has_value());
+    });
+
+    etest::test("the least recently used page is evicted first", [] {
+        engine::PageCache cache{2 * engine::PageCache::estimated_size_of(page_with_body("aaaa"))};
+        cache.insert("hax://a.com", page_with_body("aaaa"));
+        cache.insert("hax://b.com", page_with_body("bbbb"));
+
+        // Touch a so that b is the least recently used page.
+        cache.insert("hax://a.com", *cache.take("hax://a.com"));
+
+        cache.insert("hax://c.com", page_with_body("cccc"));
+        expect(!cache.take("hax://b.com").has_value());
+        expect(cache.take("hax://a.com").has_value());
+        expect(cache.take("hax://c.com").has_value());
+    });
+
+    etest::test("pages larger than the cache aren't cached", [] {
+        engine::PageCache cache{1};
+        cache.insert("hax://example.com", page_with_body("much too large"));
+        expect(!cache.take("hax://example.com").has_value());
+        expect_eq(cache.size_bytes(), std::size_t{0});
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/resource_scheduler.h"
+
+#include "img/png.h"
+#include "protocol/response.h"
+#include "uri/uri.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <spanstream>
+#include <utility>
+
+namespace engine {
+
+ResourceScheduler::ResourceScheduler(
+        protocol::IProtocolHandler &handler, std::size_t workers, std::size_t max_requests_per_host)
+    : handler_{handler}, max_requests_per_host_{max_requests_per_host} {
+    workers_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this] { run_worker(); });
+    }
+}
+
+ResourceScheduler::~ResourceScheduler() {
+    {
+        std::scoped_lock lock{mutex_};
+        shutting_down_ = true;
+        for (auto &queued : queue_) {
+            if (queued.on_image) {
+                queued.on_image(nullptr);
+            } else {
+                queued.promise.set_value({protocol::Error::Unresolved});
+            }
+        }
+        queue_.clear();
+        coalescable_fetches_.clear();
+    }
+
+    work_available_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+std::shared_future<protocol::Response> ResourceScheduler::fetch(
+        uri::Uri uri, Priority priority, protocol::Deadline deadline) {
+    QueuedFetch queued{.uri = std::move(uri), .priority = priority, .deadline = deadline};
+    auto future = queued.promise.get_future().share();
+
+    {
+        std::scoped_lock lock{mutex_};
+        if (shutting_down_) {
+            queued.promise.set_value({protocol::Error::Unresolved});
+            return future;
+        }
+
+        if (auto it = coalescable_fetches_.find(queued.uri.uri); it != coalescable_fetches_.end()) {
+            // A more important request for the same uri promotes the queued
+            // fetch rather than waiting behind its old priority.
+            for (auto &waiting : queue_) {
+                if (waiting.uri.uri == queued.uri.uri) {
+                    waiting.priority = std::min(waiting.priority, priority);
+                }
+            }
+
+            return it->second;
+        }
+
+        coalescable_fetches_.emplace(queued.uri.uri, future);
+        queued.sequence = next_sequence_++;
+        queue_.push_back(std::move(queued));
+    }
+
+    work_available_.notify_one();
+    return future;
+}
+
+void ResourceScheduler::fetch_image(uri::Uri uri, std::function<void(std::shared_ptr<img::Png const>)> on_done) {
+    QueuedFetch queued{.uri = std::move(uri), .priority = Priority::Image, .on_image = std::move(on_done)};
+
+    {
+        std::scoped_lock lock{mutex_};
+        if (shutting_down_) {
+            queued.on_image(nullptr);
+            return;
+        }
+
+        queued.sequence = next_sequence_++;
+        queue_.push_back(std::move(queued));
+    }
+
+    work_available_.notify_one();
+}
+
+void ResourceScheduler::run_worker() {
+    while (true) {
+        QueuedFetch fetch{};
+
+        {
+            std::unique_lock lock{mutex_};
+            // The most important fetch whose host still has a request slot
+            // free. Hosts at their limit keep their fetches queued, letting
+            // less important fetches to other hosts start in the meantime.
+            auto next = queue_.end();
+            auto runnable_next = [&] {
+                next = queue_.end();
+                for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+                    if (requests_in_flight_per_host_[it->uri.authority.host] >= max_requests_per_host_) {
+                        continue;
+                    }
+
+                    if (next == queue_.end() || it->priority < next->priority
+                            || (it->priority == next->priority && it->sequence < next->sequence)) {
+                        next = it;
+                    }
+                }
+
+                return next != queue_.end();
+            };
+
+            work_available_.wait(lock, [&] { return shutting_down_ || runnable_next(); });
+            // On shutdown, next is left over from an earlier predicate check
+            // and the queue it pointed into has been cleared, so it can't be
+            // looked at, let alone taken.
+            if (shutting_down_) {
+                return;
+            }
+
+            fetch = std::move(*next);
+            queue_.erase(next);
+            ++requests_in_flight_per_host_[fetch.uri.authority.host];
+        }
+
+        auto response = handler_.handle(fetch.uri, fetch.deadline);
+        if (fetch.on_image) {
+            std::shared_ptr<img::Png const> image{};
+            if (response.err == protocol::Error::Ok) {
+                if (auto png = img::Png::from(std::ispanstream{response.body.view()})) {
+                    image = std::make_shared<img::Png const>(*std::move(png));
+                }
+            }
+
+            fetch.on_image(std::move(image));
+        } else {
+            fetch.promise.set_value(std::move(response));
+        }
+
+        {
+            std::scoped_lock lock{mutex_};
+            --requests_in_flight_per_host_[fetch.uri.authority.host];
+            // The fetch has resolved, so the next request for this uri is a
+            // real refetch rather than a coalesce.
+            coalescable_fetches_.erase(fetch.uri.uri);
+        }
+
+        // The freed host slot may make a queued fetch runnable.
+        work_available_.notify_all();
+    }
+}
+
+} // namespace engine
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ENGINE_RESOURCE_SCHEDULER_H_
+#define ENGINE_RESOURCE_SCHEDULER_H_
+
+#include "img/png.h"
+#include "protocol/iprotocol_handler.h"
+#include "protocol/response.h"
+#include "uri/uri.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace engine {
+
+// Runs fetches on a pool of workers, starting more important resources
+// first and bounding how many requests hit one host at a time. The handler
+// it wraps pools kept-alive connections, so requests to the same host tend
+// to reuse sockets rather than reconnect.
+class ResourceScheduler {
+public:
+    // What the fetched bytes will become. Earlier values block rendering
+    // harder and are started first.
+    enum class Priority {
+        Document,
+        Stylesheet,
+        Image,
+    };
+
+    explicit ResourceScheduler(protocol::IProtocolHandler &handler,
+            std::size_t workers = kDefaultWorkers,
+            std::size_t max_requests_per_host = kDefaultMaxRequestsPerHost);
+
+    // Fails any fetches still queued with Error::Unresolved and waits for
+    // the in-flight ones to finish.
+    ~ResourceScheduler();
+
+    ResourceScheduler(ResourceScheduler const &) = delete;
+    ResourceScheduler &operator=(ResourceScheduler const &) = delete;
+
+    // Queues the fetch and returns a future for its response. Fetches start
+    // in priority order, ties broken by scheduling order. A uri with a fetch
+    // already queued or in flight shares that fetch instead of queuing
+    // another, and its result fans out to every caller's future; a caller
+    // coalescing onto an earlier fetch inherits that fetch's deadline.
+    [[nodiscard]] std::shared_future<protocol::Response> fetch(
+            uri::Uri uri, Priority priority, protocol::Deadline deadline = std::nullopt);
+
+    // Queues an image fetch and decodes the fetched bytes on the worker, so
+    // decode time is spent alongside the navigation's style and layout work
+    // instead of on it. on_done is called from the worker with the decoded
+    // image, or with nullptr if the fetch or the decode failed.
+    void fetch_image(uri::Uri uri, std::function<void(std::shared_ptr<img::Png const>)> on_done);
+
+private:
+    static constexpr std::size_t kDefaultWorkers{8};
+    static constexpr std::size_t kDefaultMaxRequestsPerHost{6};
+
+    struct QueuedFetch {
+        uri::Uri uri{};
+        Priority priority{};
+        protocol::Deadline deadline{};
+        // Keeps same-priority fetches in the order they were scheduled.
+        std::size_t sequence{};
+        std::promise<protocol::Response> promise{};
+        // Set for image fetches: the worker decodes the fetched bytes and
+        // resolves the fetch through this instead of the promise.
+        std::function<void(std::shared_ptr<img::Png const>)> on_image{};
+    };
+
+    void run_worker();
+
+    protocol::IProtocolHandler &handler_;
+    std::size_t max_requests_per_host_{};
+
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::vector<QueuedFetch> queue_;
+    std::map<std::string, std::size_t> requests_in_flight_per_host_;
+    // Futures for the fetches that haven't resolved yet, keyed by uri, so
+    // duplicate requests can attach to them. Images aren't in here: their
+    // results leave through callbacks, and the engine dedupes them itself.
+    std::map<std::string, std::shared_future<protocol::Response>, std::less<>> coalescable_fetches_;
+    std::size_t next_sequence_{};
+    bool shutting_down_{};
+
+    std::vector<std::thread> workers_;
+};
+
+} // namespace engine
+
+#endif
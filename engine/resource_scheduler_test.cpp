@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/resource_scheduler.h"
+
+#include "etest/etest.h"
+#include "img/png.h"
+#include "protocol/iprotocol_handler.h"
+#include "protocol/response.h"
+#include "uri/uri.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using etest::expect_eq;
+
+using Priority = engine::ResourceScheduler::Priority;
+
+namespace {
+
+// Records the order requests start in and holds every request until the
+// test releases it, so the tests control exactly what's in flight.
+class GatedProtocolHandler final : public protocol::IProtocolHandler {
+public:
+    [[nodiscard]] protocol::Response handle(uri::Uri const &uri, protocol::Deadline = std::nullopt) override {
+        std::unique_lock lock{mutex_};
+        started_.push_back(uri.uri);
+        in_flight_ += 1;
+        max_in_flight_ = std::max(max_in_flight_, in_flight_);
+        started_cv_.notify_all();
+
+        release_cv_.wait(lock, [this] { return releases_ > 0; });
+        releases_ -= 1;
+        in_flight_ -= 1;
+        return {protocol::Error::Ok};
+    }
+
+    void release(std::size_t requests) {
+        {
+            std::scoped_lock lock{mutex_};
+            releases_ += requests;
+        }
+        release_cv_.notify_all();
+    }
+
+    void wait_until_started(std::size_t requests) {
+        std::unique_lock lock{mutex_};
+        started_cv_.wait(lock, [&] { return started_.size() >= requests; });
+    }
+
+    [[nodiscard]] std::vector<std::string> started() {
+        std::scoped_lock lock{mutex_};
+        return started_;
+    }
+
+    [[nodiscard]] std::size_t max_in_flight() {
+        std::scoped_lock lock{mutex_};
+        return max_in_flight_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable started_cv_;
+    std::condition_variable release_cv_;
+    std::vector<std::string> started_;
+    std::size_t releases_{};
+    std::size_t in_flight_{};
+    std::size_t max_in_flight_{};
+};
+
+} // namespace
+
+int main() {
+    etest::test("responses come back through the future", [] {
+        GatedProtocolHandler handler{};
+        engine::ResourceScheduler scheduler{handler, 2};
+
+        handler.release(1);
+        auto response = scheduler.fetch(uri::Uri::parse("http://example.com"), Priority::Document).get();
+        expect_eq(response.err, protocol::Error::Ok);
+    });
+
+    etest::test("fetches start in priority order", [] {
+        GatedProtocolHandler handler{};
+        // One worker, so queued fetches start strictly one at a time.
+        engine::ResourceScheduler scheduler{handler, 1};
+
+        auto first = scheduler.fetch(uri::Uri::parse("http://a.com"), Priority::Image);
+        handler.wait_until_started(1);
+
+        // Queued while the worker is busy, so the scheduler gets to pick.
+        auto image = scheduler.fetch(uri::Uri::parse("http://b.com"), Priority::Image);
+        auto stylesheet = scheduler.fetch(uri::Uri::parse("http://c.com"), Priority::Stylesheet);
+        auto document = scheduler.fetch(uri::Uri::parse("http://d.com"), Priority::Document);
+
+        handler.release(4);
+        first.get();
+        image.get();
+        stylesheet.get();
+        document.get();
+
+        expect_eq(handler.started(),
+                std::vector<std::string>{"http://a.com", "http://d.com", "http://c.com", "http://b.com"});
+    });
+
+    etest::test("identical in-flight fetches are coalesced", [] {
+        GatedProtocolHandler handler{};
+        engine::ResourceScheduler scheduler{handler, 1};
+
+        auto first = scheduler.fetch(uri::Uri::parse("http://a.com"), Priority::Image);
+        handler.wait_until_started(1);
+
+        // Queued while the worker is busy, so the duplicate can only attach
+        // to the queued fetch.
+        auto queued = scheduler.fetch(uri::Uri::parse("http://b.com/style.css"), Priority::Stylesheet);
+        auto duplicate = scheduler.fetch(uri::Uri::parse("http://b.com/style.css"), Priority::Stylesheet);
+
+        handler.release(3);
+        expect_eq(queued.get().err, protocol::Error::Ok);
+        expect_eq(duplicate.get().err, protocol::Error::Ok);
+        first.get();
+        expect_eq(handler.started(), std::vector<std::string>{"http://a.com", "http://b.com/style.css"});
+    });
+
+    etest::test("image fetches decode on the worker", [] {
+        GatedProtocolHandler handler{};
+        engine::ResourceScheduler scheduler{handler, 1};
+
+        std::promise<std::shared_ptr<img::Png const>> decoded{};
+        scheduler.fetch_image(uri::Uri::parse("http://example.com/a.png"),
+                [&](std::shared_ptr<img::Png const> image) { decoded.set_value(std::move(image)); });
+
+        handler.release(1);
+        // The gated handler's responses hold no png bytes, so the decode fails.
+        expect_eq(decoded.get_future().get(), nullptr);
+    });
+
+    etest::test("per-host concurrency is bounded", [] {
+        GatedProtocolHandler handler{};
+        engine::ResourceScheduler scheduler{handler, 2, 1};
+
+        auto first = scheduler.fetch(uri::Uri::parse("http://a.com/1"), Priority::Document);
+        handler.wait_until_started(1);
+
+        auto second = scheduler.fetch(uri::Uri::parse("http://a.com/2"), Priority::Document);
+        // a.com is at its limit, so this skips ahead even though it was
+        // scheduled last.
+        auto other_host = scheduler.fetch(uri::Uri::parse("http://b.com"), Priority::Image);
+
+        handler.wait_until_started(2);
+        expect_eq(handler.started(), std::vector<std::string>{"http://a.com/1", "http://b.com"});
+
+        handler.release(3);
+        first.get();
+        second.get();
+        other_host.get();
+
+        expect_eq(handler.max_in_flight(), std::size_t{2});
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/stylesheet_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace engine {
+
+std::shared_ptr<StylesheetCache::ParsedStylesheet const> StylesheetCache::find(
+        std::string_view uri, std::string_view validator) {
+    std::scoped_lock lock{mutex_};
+    auto it = std::ranges::find_if(
+            sheets_, [&](auto const &entry) { return entry.uri == uri && entry.validator == validator; });
+    if (it == sheets_.end()) {
+        return nullptr;
+    }
+
+    sheets_.splice(sheets_.begin(), sheets_, it);
+    return sheets_.front().sheet;
+}
+
+void StylesheetCache::insert(std::string uri, std::string validator, std::shared_ptr<ParsedStylesheet const> sheet) {
+    std::scoped_lock lock{mutex_};
+    // The new sheet replaces any old one cached for the same uri, validator
+    // change or not.
+    if (auto it = std::ranges::find(sheets_, uri, &Entry::uri); it != sheets_.end()) {
+        sheets_.erase(it);
+    }
+
+    sheets_.emplace_front(std::move(uri), std::move(validator), std::move(sheet));
+    while (sheets_.size() > max_entries_) {
+        sheets_.pop_back();
+    }
+}
+
+std::size_t StylesheetCache::size() const {
+    std::scoped_lock lock{mutex_};
+    return sheets_.size();
+}
+
+} // namespace engine
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ENGINE_STYLESHEET_CACHE_H_
+#define ENGINE_STYLESHEET_CACHE_H_
+
+#include "css/rule.h"
+#include "style/style.h"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine {
+
+// Parsed forms of linked stylesheets, keyed by URI plus the response's cache
+// validator, so navigations between pages sharing the same sheets skip CSS
+// parsing entirely. A changed sheet gets a changed validator and misses.
+// Entries are shared and immutable: the stylesheet workers run in parallel,
+// so lookups and inserts are safe from any thread. The least-recently-used
+// sheets are evicted once the cache outgrows its entry cap.
+class StylesheetCache {
+public:
+    static constexpr std::size_t kDefaultMaxEntries{64};
+
+    struct ParsedStylesheet {
+        std::vector<css::Rule> rules{};
+        style::SelectorIndex::Partial index{};
+    };
+
+    explicit StylesheetCache(std::size_t max_entries = kDefaultMaxEntries) : max_entries_{max_entries} {}
+
+    [[nodiscard]] std::shared_ptr<ParsedStylesheet const> find(std::string_view uri, std::string_view validator);
+    void insert(std::string uri, std::string validator, std::shared_ptr<ParsedStylesheet const>);
+
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    struct Entry {
+        std::string uri{};
+        std::string validator{};
+        std::shared_ptr<ParsedStylesheet const> sheet{};
+    };
+
+    std::size_t max_entries_{};
+    mutable std::mutex mutex_{};
+    // Most recently used first.
+    std::list<Entry> sheets_{};
+};
+
+} // namespace engine
+
+#endif
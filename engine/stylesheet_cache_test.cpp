@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "engine/stylesheet_cache.h"
+
+#include "css/property_id.h"
+#include "css/rule.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using engine::StylesheetCache;
+using etest::expect;
+using etest::expect_eq;
+
+namespace {
+
+std::shared_ptr<StylesheetCache::ParsedStylesheet const> sheet_with_width(char const *width) {
+    std::vector<css::Rule> rules{
+            css::Rule{.selectors = {"p"}, .declarations = {{css::PropertyId::Width, width}}},
+    };
+    auto index = style::SelectorIndex::Partial{rules};
+    return std::make_shared<StylesheetCache::ParsedStylesheet const>(std::move(rules), std::move(index));
+}
+
+} // namespace
+
+int main() {
+    etest::test("hits require both uri and validator to match", [] {
+        StylesheetCache cache;
+        cache.insert("http://example.com/a.css", "v1", sheet_with_width("1px"));
+
+        expect(cache.find("http://example.com/a.css", "v1") != nullptr);
+        expect(cache.find("http://example.com/a.css", "v2") == nullptr);
+        expect(cache.find("http://example.com/b.css", "v1") == nullptr);
+    });
+
+    etest::test("a changed sheet replaces the old parse", [] {
+        StylesheetCache cache;
+        cache.insert("http://example.com/a.css", "v1", sheet_with_width("1px"));
+        cache.insert("http://example.com/a.css", "v2", sheet_with_width("2px"));
+
+        expect_eq(cache.size(), std::size_t{1});
+        expect(cache.find("http://example.com/a.css", "v1") == nullptr);
+        auto sheet = cache.find("http://example.com/a.css", "v2");
+        expect(sheet != nullptr);
+        expect_eq(sheet->rules.at(0).declarations.at(css::PropertyId::Width).raw, "2px");
+    });
+
+    etest::test("the least recently used sheet is evicted", [] {
+        StylesheetCache cache{2};
+        cache.insert("http://example.com/a.css", "v1", sheet_with_width("1px"));
+        cache.insert("http://example.com/b.css", "v1", sheet_with_width("2px"));
+
+        // Touch a so that b is the eviction candidate.
+        expect(cache.find("http://example.com/a.css", "v1") != nullptr);
+        cache.insert("http://example.com/c.css", "v1", sheet_with_width("3px"));
+
+        expect_eq(cache.size(), std::size_t{2});
+        expect(cache.find("http://example.com/a.css", "v1") != nullptr);
+        expect(cache.find("http://example.com/b.css", "v1") == nullptr);
+        expect(cache.find("http://example.com/c.css", "v1") != nullptr);
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "etest/allocations.h"
+
+#include "etest/etest.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace {
+
+std::atomic<std::size_t> allocation_count{0};
+std::atomic<std::size_t> allocation_bytes{0};
+
+void *counted_alloc(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    // Zero-sized allocations still have to return distinct pointers.
+    if (void *allocation = std::malloc(size != 0 ? size : 1)) {
+        return allocation;
+    }
+
+    throw std::bad_alloc{};
+}
+
+} // namespace
+
+// Over-aligned allocations go through the aligned operator new overloads,
+// which pair with the aligned deletes, so only the plain overloads need
+// replacing for counting and malloc/free to stay matched up.
+void *operator new(std::size_t size) {
+    return counted_alloc(size);
+}
+
+void *operator new[](std::size_t size) {
+    return counted_alloc(size);
+}
+
+void operator delete(void *allocation) noexcept {
+    std::free(allocation);
+}
+
+void operator delete[](void *allocation) noexcept {
+    std::free(allocation);
+}
+
+void operator delete(void *allocation, std::size_t) noexcept {
+    std::free(allocation);
+}
+
+void operator delete[](void *allocation, std::size_t) noexcept {
+    std::free(allocation);
+}
+
+namespace etest {
+
+AllocationStats current_allocations() {
+    return {
+            allocation_count.load(std::memory_order_relaxed),
+            allocation_bytes.load(std::memory_order_relaxed),
+    };
+}
+
+AllocationStats allocations_during(std::function<void()> const &body) {
+    auto before = current_allocations();
+    body();
+    auto after = current_allocations();
+    return {after.count - before.count, after.bytes - before.bytes};
+}
+
+void expect_allocations_at_most(
+        std::size_t max_allocations, std::function<void()> const &body, etest::source_location const &loc) {
+    auto made = allocations_during(body);
+    if (made.count <= max_allocations) {
+        return;
+    }
+
+    expect(false,
+            std::to_string(made.count) + " allocation(s) (" + std::to_string(made.bytes) + " bytes), budget is "
+                    + std::to_string(max_allocations),
+            loc);
+}
+
+} // namespace etest
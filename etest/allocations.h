@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ETEST_ALLOCATIONS_H_
+#define ETEST_ALLOCATIONS_H_
+
+#include "etest/cxx_compat.h"
+
+#include <cstddef>
+#include <functional>
+
+namespace etest {
+
+struct AllocationStats {
+    std::size_t count{};
+    std::size_t bytes{};
+};
+
+// Heap allocations made by this binary so far. Using anything from this
+// header links in a counting replacement of the global operator new.
+[[nodiscard]] AllocationStats current_allocations();
+
+// Runs the body and returns what it allocated.
+[[nodiscard]] AllocationStats allocations_during(std::function<void()> const &body);
+
+// Weak test requirement: the body makes at most max_allocations heap
+// allocations. This is how parsers and the style and layout passes carry
+// allocation budgets in their test suites.
+void expect_allocations_at_most(std::size_t max_allocations,
+        std::function<void()> const &body,
+        etest::source_location const &loc = etest::source_location::current());
+
+} // namespace etest
+
+#endif
@@ -0,0 +1,17 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "etest/allocations.h"
+
+#include "etest/etest.h"
+
+int main() {
+    etest::test("this should fail", [] {
+        etest::expect_allocations_at_most(0, [] {
+            // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+            delete new int{42};
+        });
+    });
+    return etest::run_all_tests();
+}
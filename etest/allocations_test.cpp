@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "etest/allocations.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <vector>
+
+using etest::expect;
+using etest::expect_eq;
+
+int main() {
+    etest::test("allocations are counted", [] {
+        auto stats = etest::allocations_during([] {
+            // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+            delete new int{42};
+        });
+
+        expect_eq(stats.count, std::size_t{1});
+        expect(stats.bytes >= sizeof(int));
+    });
+
+    etest::test("allocation-free code fits a zero budget", [] {
+        etest::expect_allocations_at_most(0, [] {
+            int sum = 0;
+            for (int i = 0; i < 100; ++i) {
+                sum += i;
+            }
+        });
+    });
+
+    etest::test("budgets have headroom", [] {
+        etest::expect_allocations_at_most(10, [] { std::vector<int> v(100); });
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "etest/benchmark.h"
+
+#include "os/os.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace etest {
+namespace {
+
+struct Benchmark {
+    std::string name;
+    std::function<void()> body;
+};
+
+std::vector<Benchmark> &benchmark_registry() {
+    static std::vector<Benchmark> registry;
+    return registry;
+}
+
+std::chrono::nanoseconds time_iterations(std::function<void()> const &body, std::uint64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i) {
+        body();
+    }
+    return std::chrono::steady_clock::now() - start;
+}
+
+} // namespace
+
+int run_all_benchmarks(BenchmarkRunOptions const &opts) noexcept {
+    auto const &benchmarks = benchmark_registry();
+    if (!opts.machine_readable) {
+        std::cout << benchmarks.size() << " benchmark(s) registered.\n";
+    }
+
+    int failures = 0;
+    for (auto const &benchmark : benchmarks) {
+        try {
+            // Calibration doubles the iteration count until one sample takes
+            // long enough to be meaningfully timed. It also serves as the
+            // warm-up: caches and branch predictors have seen the body before
+            // anything is recorded.
+            std::uint64_t iterations = 1;
+            while (time_iterations(benchmark.body, iterations) < opts.min_sample_time) {
+                iterations *= 2;
+            }
+
+            std::vector<std::chrono::nanoseconds> samples;
+            samples.reserve(opts.samples);
+            for (int i = 0; i < opts.samples; ++i) {
+                samples.push_back(time_iterations(benchmark.body, iterations));
+            }
+
+            std::ranges::sort(samples);
+            auto per_iteration = [&](std::chrono::nanoseconds sample) {
+                return static_cast<std::uint64_t>(sample.count()) / iterations;
+            };
+            auto median = per_iteration(samples[samples.size() / 2]);
+            auto fastest = per_iteration(samples.front());
+            auto slowest = per_iteration(samples.back());
+
+            os::PerfCounterValues counters{};
+            bool have_counters = false;
+            if (opts.perf_counters) {
+                if (auto perf = os::PerfCounters::open()) {
+                    perf->start();
+                    time_iterations(benchmark.body, iterations);
+                    counters = perf->stop();
+                    have_counters = true;
+                }
+            }
+
+            if (opts.machine_readable) {
+                std::cout << benchmark.name << '\t' << iterations << '\t' << median << '\t' << fastest << '\t'
+                          << slowest << '\t' << counters.instructions / iterations << '\t'
+                          << counters.cycles / iterations << '\t' << counters.cache_misses / iterations << '\t'
+                          << counters.branch_misses / iterations << '\n';
+            } else {
+                std::cout << benchmark.name << ": " << median << " ns/iteration (min " << fastest << ", max "
+                          << slowest << ", " << iterations << " iterations/sample)\n";
+                if (have_counters) {
+                    std::cout << "  " << counters.instructions / iterations << " instructions, "
+                              << counters.cycles / iterations << " cycles, " << counters.cache_misses / iterations
+                              << " cache-misses, " << counters.branch_misses / iterations
+                              << " branch-misses /iteration\n";
+                }
+            }
+        } catch (std::exception const &e) {
+            ++failures;
+            std::cout << benchmark.name << ": unhandled exception in benchmark body: " << e.what() << '\n';
+        } catch (...) {
+            ++failures;
+            std::cout << benchmark.name << ": unhandled unknown exception in benchmark body.\n";
+        }
+
+        std::cout << std::flush;
+    }
+
+    return failures > 0 ? 1 : 0;
+}
+
+void benchmark(std::string name, std::function<void()> body) noexcept {
+    benchmark_registry().push_back({std::move(name), std::move(body)});
+}
+
+} // namespace etest
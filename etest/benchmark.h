@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef ETEST_BENCHMARK_H_
+#define ETEST_BENCHMARK_H_
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+namespace etest {
+
+struct BenchmarkRunOptions {
+    // How many timed samples each benchmark is measured over. The median of
+    // these is the headline number.
+    int samples{5};
+    // The minimum time one sample should spend iterating the benchmark body.
+    // The iteration count is calibrated until a sample takes at least this
+    // long.
+    std::chrono::nanoseconds min_sample_time{std::chrono::milliseconds{10}};
+    // Print one tab-separated line per benchmark instead of human-readable
+    // output: name, iterations, median/min/max ns per iteration, and the
+    // hardware counters (zeroes when they're unavailable).
+    bool machine_readable{false};
+    // Also report hardware counters (instructions, cycles, cache-misses, and
+    // branch-misses per iteration) where the platform lets us at them.
+    // Instruction counts don't wobble with machine load the way wall-clock
+    // times do, making them the number to compare on shared hardware.
+    bool perf_counters{true};
+};
+
+// Runs every registered benchmark, printing per-iteration timings. Returns
+// non-zero if any benchmark body threw, so benchmark binaries can double as
+// normal test targets.
+[[nodiscard]] int run_all_benchmarks(BenchmarkRunOptions const & = {}) noexcept;
+
+void benchmark(std::string name, std::function<void()> body) noexcept;
+
+// Keeps the compiler from optimizing away a value a benchmark body computed
+// but doesn't otherwise use.
+template<typename T>
+void do_not_optimize(T const &value) {
+    // NOLINTNEXTLINE(hicpp-no-assembler)
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace etest
+
+#endif
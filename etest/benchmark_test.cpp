@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "etest/benchmark.h"
+
+#include "etest/etest.h"
+
+#include <chrono>
+#include <stdexcept>
+
+using etest::expect;
+using etest::expect_eq;
+
+namespace {
+// Small enough that the tests don't spend noticeable time benchmarking.
+constexpr etest::BenchmarkRunOptions kFastOptions{
+        .samples = 2,
+        .min_sample_time = std::chrono::nanoseconds{1},
+        .machine_readable = true,
+};
+} // namespace
+
+int main() {
+    etest::test("benchmarks are calibrated and run", [] {
+        int runs = 0;
+        etest::benchmark("counting", [&] { etest::do_not_optimize(++runs); });
+
+        expect_eq(etest::run_all_benchmarks(kFastOptions), 0);
+        // Calibration plus two samples means at least three iterations.
+        expect(runs >= 3);
+    });
+
+    etest::test("a throwing benchmark fails the run", [] {
+        etest::benchmark("throws", [] { throw std::runtime_error{"oh no"}; });
+        expect_eq(etest::run_all_benchmarks(kFastOptions), 1);
+    });
+
+    return etest::run_all_tests();
+}
@@ -5,15 +5,29 @@
 #include "etest/etest.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdlib>
 #include <exception>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <optional>
 #include <ostream>
 #include <sstream>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#endif
+
 namespace etest {
 namespace {
 
@@ -38,6 +52,204 @@ struct test_failure : public std::exception {};
 
 std::stringstream test_log{};
 
+struct TestResult {
+    bool passed{};
+    std::string log;
+};
+
+TestResult run_test(Test const &test) noexcept {
+    int const before = assertion_failures;
+
+    try {
+        test.body();
+    } catch (test_failure const &) {
+        ++assertion_failures;
+    } catch (std::exception const &e) {
+        ++assertion_failures;
+        test_log << "Unhandled exception in test body: " << e.what() << '\n';
+    } catch (...) {
+        ++assertion_failures;
+        test_log << "Unhandled unknown exception in test body.\n";
+    }
+
+    return {before == assertion_failures, std::exchange(test_log, {}).str()};
+}
+
+void report_status(TestResult const &result) {
+    if (result.passed) {
+        std::cout << "\u001b[32mPASSED\u001b[0m\n";
+    } else {
+        std::cout << "\u001b[31;1mFAILED\u001b[0m\n";
+        std::cout << result.log;
+    }
+
+    std::cout << std::flush;
+}
+
+#ifndef _WIN32
+
+void report(std::string_view name, std::size_t name_width, TestResult const &result) {
+    std::cout << std::left << std::setw(static_cast<int>(name_width)) << name << ": ";
+    report_status(result);
+}
+
+// Wire format for a finished test, written to the worker's pipe followed by
+// log_size bytes of log. Workers are fork()ed from this process, so native
+// layout is fine.
+struct ResultHeader {
+    std::size_t index{};
+    std::size_t log_size{};
+    bool passed{};
+};
+
+bool write_all(int fd, char const *data, std::size_t size) {
+    while (size > 0) {
+        auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+
+    return true;
+}
+
+// Runs the tests sharded round-robin across forked worker processes. Each
+// worker streams a record per finished test back over a pipe, so a test that
+// crashes only takes its own worker down and everything the worker finished
+// before the crash is still reported. Results are printed in registration
+// order once every worker is done.
+int run_in_parallel(std::vector<Test> const &tests, unsigned jobs, std::size_t name_width) {
+    jobs = static_cast<unsigned>(std::min<std::size_t>(jobs, tests.size()));
+
+    struct Worker {
+        pid_t pid{};
+        int read_fd{};
+        unsigned shard{};
+    };
+
+    std::vector<Worker> workers;
+    std::vector<std::optional<TestResult>> results(tests.size());
+
+    auto run_shard_into = [&](unsigned shard, auto &&sink) {
+        for (std::size_t i = shard; i < tests.size(); i += jobs) {
+            sink(i, run_test(tests[i]));
+        }
+    };
+
+    for (unsigned shard = 0; shard < jobs; ++shard) {
+        std::array<int, 2> fds{};
+        if (::pipe(fds.data()) != 0) {
+            // Out of descriptors; this shard runs in-process instead.
+            run_shard_into(shard, [&](std::size_t i, TestResult result) { results[i] = std::move(result); });
+            continue;
+        }
+
+        pid_t pid = ::fork();
+        if (pid == -1) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            run_shard_into(shard, [&](std::size_t i, TestResult result) { results[i] = std::move(result); });
+            continue;
+        }
+
+        if (pid == 0) {
+            ::close(fds[0]);
+            for (auto const &worker : workers) {
+                ::close(worker.read_fd);
+            }
+
+            run_shard_into(shard, [&](std::size_t i, TestResult const &result) {
+                ResultHeader header{i, result.log.size(), result.passed};
+                std::array<char, sizeof(header)> raw{};
+                std::memcpy(raw.data(), &header, sizeof(header));
+                if (!write_all(fds[1], raw.data(), raw.size())
+                        || !write_all(fds[1], result.log.data(), result.log.size())) {
+                    ::_exit(2);
+                }
+            });
+
+            std::cout << std::flush;
+            ::_exit(assertion_failures > 0 ? 1 : 0);
+        }
+
+        ::close(fds[1]);
+        workers.push_back({pid, fds[0], shard});
+    }
+
+    bool workers_ok = true;
+    for (auto const &worker : workers) {
+        std::string stream;
+        while (true) {
+            std::array<char, 4096> buffer{};
+            auto count = ::read(worker.read_fd, buffer.data(), buffer.size());
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (count <= 0) {
+                break;
+            }
+
+            stream.append(buffer.data(), static_cast<std::size_t>(count));
+        }
+
+        ::close(worker.read_fd);
+
+        std::size_t offset = 0;
+        while (stream.size() - offset >= sizeof(ResultHeader)) {
+            ResultHeader header{};
+            std::memcpy(&header, stream.data() + offset, sizeof(header));
+            if (stream.size() - offset - sizeof(header) < header.log_size) {
+                break;
+            }
+
+            offset += sizeof(header);
+            results[header.index] = TestResult{header.passed, stream.substr(offset, header.log_size)};
+            offset += header.log_size;
+        }
+
+        int status{};
+        while (::waitpid(worker.pid, &status, 0) == -1 && errno == EINTR) {
+        }
+
+        if (WIFSIGNALED(status)) {
+            workers_ok = false;
+            // The first unreported test in the shard is the one that was
+            // running; the ones after it never got to run.
+            std::string note = "  test worker killed by signal " + std::to_string(WTERMSIG(status)) + ".\n";
+            for (std::size_t i = worker.shard; i < tests.size(); i += jobs) {
+                if (!results[i].has_value()) {
+                    results[i] = TestResult{false, note};
+                    note = "  not run; an earlier test killed this test worker.\n";
+                }
+            }
+        }
+    }
+
+    bool all_passed = workers_ok;
+    for (std::size_t i = 0; i < tests.size(); ++i) {
+        // Only an abnormally exiting worker leaves gaps, and those are filled
+        // in above, but stay defensive about reporting a test as run.
+        auto const &result = results[i];
+        if (!result.has_value() || !result->passed) {
+            all_passed = false;
+        }
+
+        report(tests[i].name, name_width, result.value_or(TestResult{false, "  no result from test worker.\n"}));
+    }
+
+    return all_passed ? 0 : 1;
+}
+
+#endif // !_WIN32
+
 } // namespace
 
 int run_all_tests(RunOptions const &opts) noexcept {
@@ -63,31 +275,25 @@ int run_all_tests(RunOptions const &opts) noexcept {
             tests_to_run.end(),
             [](auto const &a, auto const &b) { return a.name.size() < b.name.size(); });
 
-    for (auto const &test : tests_to_run) {
-        std::cout << std::left << std::setw(longest_name->name.size()) << test.name << ": ";
-
-        int const before = assertion_failures;
-
-        try {
-            test.body();
-        } catch (test_failure const &) {
-            ++assertion_failures;
-        } catch (std::exception const &e) {
-            ++assertion_failures;
-            test_log << "Unhandled exception in test body: " << e.what() << '\n';
-        } catch (...) {
-            ++assertion_failures;
-            test_log << "Unhandled unknown exception in test body.\n";
+#ifndef _WIN32
+    unsigned jobs = opts.jobs;
+    if (jobs == 0) {
+        if (char const *env = std::getenv("ETEST_JOBS")) {
+            jobs = static_cast<unsigned>(std::strtoul(env, nullptr, 10));
         }
+    }
 
-        if (before == assertion_failures) {
-            std::cout << "\u001b[32mPASSED\u001b[0m\n";
-        } else {
-            std::cout << "\u001b[31;1mFAILED\u001b[0m\n";
-            std::cout << std::exchange(test_log, {}).str();
-        }
+    if (jobs > 1 && tests_to_run.size() > 1) {
+        return run_in_parallel(tests_to_run, jobs, longest_name->name.size());
+    }
+#endif
 
-        std::cout << std::flush;
+    for (auto const &test : tests_to_run) {
+        // The name goes out before the body runs so a hanging test is easy to
+        // point at.
+        std::cout << std::left << std::setw(static_cast<int>(longest_name->name.size())) << test.name << ": "
+                  << std::flush;
+        report_status(run_test(test));
     }
 
     return assertion_failures > 0 ? 1 : 0;
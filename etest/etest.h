@@ -24,6 +24,16 @@ concept Printable = requires(std::ostream &os, T t) {
 
 struct RunOptions {
     bool run_disabled_tests{false};
+
+    // Number of worker processes to shard the tests across. 1 runs everything
+    // in this process, like before. 0 defers to the ETEST_JOBS environment
+    // variable so build machines can opt whole suites in without touching
+    // every main(), falling back to 1 when it's unset. With more than one
+    // worker, tests fork()ed into workers run crash-isolated and results are
+    // reported in registration order once every worker finishes; output the
+    // test bodies write themselves may still interleave. Ignored on Windows,
+    // where tests always run in-process.
+    unsigned jobs{0};
 };
 
 [[nodiscard]] int run_all_tests(RunOptions const & = {}) noexcept;
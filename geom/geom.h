@@ -6,6 +6,9 @@
 #define GEOM_GEOM_H_
 
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <span>
 
 namespace geom {
 
@@ -76,6 +79,11 @@ struct Rect {
         };
     }
 
+    // Unlike intersected, rects that only touch at an edge don't overlap.
+    [[nodiscard]] constexpr bool overlaps(Rect const &other) const {
+        return left() < other.right() && right() > other.left() && top() < other.bottom() && bottom() > other.top();
+    }
+
     [[nodiscard]] constexpr bool contains(Position const &p) const {
         bool inside_horizontally = p.x >= left() && p.x <= right();
         bool inside_vertically = p.y >= top() && p.y <= bottom();
@@ -83,6 +91,39 @@ struct Rect {
     }
 };
 
+// Batch kernels for the frame-level geometry passes (culling, damage
+// tracking) that touch thousands of rects at a time. A Rect is four plain
+// ints, so a contiguous span of them is data the compiler can vectorize;
+// the loop bodies are written branch-free to keep it that way.
+
+// Clips every rect against clip in place, like Rect::intersected.
+constexpr void intersect_all(std::span<Rect> rects, Rect const &clip) {
+    for (auto &rect : rects) {
+        auto new_left = std::max(rect.left(), clip.left());
+        auto new_right = std::min(rect.right(), clip.right());
+        auto new_top = std::max(rect.top(), clip.top());
+        auto new_bottom = std::min(rect.bottom(), clip.bottom());
+        bool empty = new_left > new_right || new_top > new_bottom;
+        rect = empty ? Rect{} : Rect{new_left, new_top, new_right - new_left, new_bottom - new_top};
+    }
+}
+
+// Moves every rect by (dx, dy) in place, like Rect::translated.
+constexpr void translate_all(std::span<Rect> rects, int dx, int dy) {
+    for (auto &rect : rects) {
+        rect.x += dx;
+        rect.y += dy;
+    }
+}
+
+// Hit-tests p against every rect, writing one result per rect into hits.
+constexpr void contains_each(std::span<Rect const> rects, Position const &p, std::span<bool> hits) {
+    assert(rects.size() == hits.size());
+    for (std::size_t i = 0; i < rects.size(); ++i) {
+        hits[i] = rects[i].contains(p);
+    }
+}
+
 } // namespace geom
 
 #endif
@@ -6,6 +6,9 @@
 
 #include "etest/etest.h"
 
+#include <array>
+#include <vector>
+
 using etest::expect;
 using etest::expect_eq;
 using geom::EdgeSize;
@@ -113,6 +116,20 @@ int main() {
         expect_eq(Rect{}, r.intersected({11, 11, 1, 1}));
     });
 
+    etest::test("Rect::overlaps", [] {
+        Rect r{0, 0, 10, 10};
+        expect(r.overlaps(r));
+        expect(r.overlaps({5, 5, 10, 10}));
+        expect(r.overlaps({-5, -5, 10, 10}));
+
+        // Rects only touching at an edge don't overlap.
+        expect(!r.overlaps({10, 0, 10, 10}));
+        expect(!r.overlaps({0, 10, 10, 10}));
+
+        expect(!r.overlaps({11, 11, 1, 1}));
+        expect(!r.overlaps({-2, -2, 1, 1}));
+    });
+
     etest::test("Rect::contains", [] {
         Rect r{0, 0, 10, 10};
         expect(r.contains({0, 0}));
@@ -126,5 +143,36 @@ int main() {
         expect(!r.contains({11, 10}));
     });
 
+    etest::test("intersect_all", [] {
+        Rect viewport{0, 0, 100, 100};
+        std::vector<Rect> rects{
+                {10, 10, 20, 20},
+                {90, 90, 20, 20},
+                {200, 200, 10, 10},
+                {-50, -50, 300, 300},
+        };
+        auto expected = rects;
+        for (auto &rect : expected) {
+            rect = rect.intersected(viewport);
+        }
+
+        geom::intersect_all(rects, viewport);
+        expect_eq(rects, expected);
+    });
+
+    etest::test("translate_all", [] {
+        std::vector<Rect> rects{{0, 0, 10, 10}, {5, -5, 1, 1}};
+        geom::translate_all(rects, 2, -3);
+        expect_eq(rects, std::vector<Rect>{{2, -3, 10, 10}, {7, -8, 1, 1}});
+    });
+
+    etest::test("contains_each", [] {
+        std::vector<Rect> rects{{0, 0, 10, 10}, {20, 20, 10, 10}, {5, 5, 10, 10}};
+        // std::vector<bool> packs its bits, so the results need real bools.
+        std::array<bool, 3> results{};
+        geom::contains_each(rects, {5, 5}, results);
+        expect_eq(results, std::array{true, false, true});
+    });
+
     return etest::run_all_tests();
 }
@@ -0,0 +1,298 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef GFX_CANVAS_COMMAND_BUFFER_H_
+#define GFX_CANVAS_COMMAND_BUFFER_H_
+
+#include "gfx/icanvas.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gfx {
+
+// A recorded sequence of canvas calls, stored flat.
+//
+// Unlike the std::vector<CanvasCommand> in canvas_command_saver.h, commands
+// are trivially-copyable records in one contiguous byte stream with the text
+// payloads in a side arena, so recording is append-only memcpy and replaying
+// is a linear scan. Useful when frames are recorded every repaint rather than
+// inspected in tests.
+class CanvasCommandBuffer {
+public:
+    void set_viewport_size(int width, int height) {
+        append(CommandType::SetViewportSize);
+        append(SetViewportSizeRecord{width, height});
+    }
+
+    void set_scale(int scale) {
+        append(CommandType::SetScale);
+        append(SetScaleRecord{scale});
+    }
+
+    void add_translation(int dx, int dy) {
+        append(CommandType::AddTranslation);
+        append(AddTranslationRecord{dx, dy});
+    }
+
+    void fill_rect(geom::Rect const &rect, Color color) {
+        append(CommandType::FillRect);
+        append(FillRectRecord{rect, color});
+    }
+
+    void draw_rect(geom::Rect const &rect, Color const &color, Borders const &borders) {
+        append(CommandType::DrawRect);
+        append(DrawRectRecord{rect, color, borders});
+    }
+
+    void draw_text(geom::Position position,
+            std::string_view text,
+            std::vector<Font> const &font_options,
+            FontSize size,
+            FontStyle style,
+            Color color) {
+        append(CommandType::DrawTextWithFontOptions);
+        append(DrawTextWithFontOptionsRecord{
+                position, intern(text), static_cast<std::uint32_t>(font_options.size()), size.px, style, color});
+        for (auto const &font : font_options) {
+            append(intern(font.font));
+        }
+    }
+
+    void draw_text(
+            geom::Position position, std::string_view text, Font font, FontSize size, FontStyle style, Color color) {
+        append(CommandType::DrawText);
+        append(DrawTextRecord{position, intern(text), intern(font.font), size.px, style, color});
+    }
+
+    void draw_pixels(geom::Rect const &rect,
+            std::span<std::uint8_t const> rgba_data,
+            int width,
+            int height,
+            std::size_t image_id) {
+        // The pixel payload goes into the arena like text does, so the
+        // caller's buffer doesn't have to outlive the frame.
+        auto pixels = intern(std::string_view{reinterpret_cast<char const *>(rgba_data.data()), rgba_data.size()});
+        append(CommandType::DrawPixels);
+        append(DrawPixelsRecord{rect, pixels, width, height, image_id});
+    }
+
+    void replay(ICanvas &canvas) const {
+        std::size_t offset{0};
+        while (offset < bytes_.size()) {
+            switch (read<CommandType>(offset)) {
+                case CommandType::SetViewportSize: {
+                    auto cmd = read<SetViewportSizeRecord>(offset);
+                    canvas.set_viewport_size(cmd.width, cmd.height);
+                    break;
+                }
+                case CommandType::SetScale: {
+                    canvas.set_scale(read<SetScaleRecord>(offset).scale);
+                    break;
+                }
+                case CommandType::AddTranslation: {
+                    auto cmd = read<AddTranslationRecord>(offset);
+                    canvas.add_translation(cmd.dx, cmd.dy);
+                    break;
+                }
+                case CommandType::FillRect: {
+                    auto cmd = read<FillRectRecord>(offset);
+                    canvas.fill_rect(cmd.rect, cmd.color);
+                    break;
+                }
+                case CommandType::DrawRect: {
+                    auto cmd = read<DrawRectRecord>(offset);
+                    canvas.draw_rect(cmd.rect, cmd.color, cmd.borders);
+                    break;
+                }
+                case CommandType::DrawTextWithFontOptions: {
+                    auto cmd = read<DrawTextWithFontOptionsRecord>(offset);
+                    std::vector<Font> fonts;
+                    fonts.reserve(cmd.font_count);
+                    for (std::uint32_t i = 0; i < cmd.font_count; ++i) {
+                        fonts.push_back(Font{view(read<StringRef>(offset))});
+                    }
+                    canvas.draw_text(cmd.position, view(cmd.text), fonts, {cmd.size}, cmd.style, cmd.color);
+                    break;
+                }
+                case CommandType::DrawText: {
+                    auto cmd = read<DrawTextRecord>(offset);
+                    canvas.draw_text(cmd.position, view(cmd.text), {view(cmd.font)}, {cmd.size}, cmd.style, cmd.color);
+                    break;
+                }
+                case CommandType::DrawPixels: {
+                    auto cmd = read<DrawPixelsRecord>(offset);
+                    auto pixels = view(cmd.pixels);
+                    canvas.draw_pixels(cmd.rect,
+                            {reinterpret_cast<std::uint8_t const *>(pixels.data()), pixels.size()},
+                            cmd.width,
+                            cmd.height,
+                            cmd.image_id);
+                    break;
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] bool empty() const { return bytes_.empty(); }
+
+    void clear() {
+        bytes_.clear();
+        text_arena_.clear();
+    }
+
+private:
+    enum class CommandType : std::uint8_t {
+        SetViewportSize,
+        SetScale,
+        AddTranslation,
+        FillRect,
+        DrawRect,
+        DrawTextWithFontOptions,
+        DrawText,
+        DrawPixels,
+    };
+
+    struct StringRef {
+        std::uint32_t offset{};
+        std::uint32_t length{};
+    };
+
+    struct SetViewportSizeRecord {
+        int width{};
+        int height{};
+    };
+
+    struct SetScaleRecord {
+        int scale{};
+    };
+
+    struct AddTranslationRecord {
+        int dx{};
+        int dy{};
+    };
+
+    struct FillRectRecord {
+        geom::Rect rect{};
+        Color color{};
+    };
+
+    struct DrawRectRecord {
+        geom::Rect rect{};
+        Color color{};
+        Borders borders{};
+    };
+
+    struct DrawTextWithFontOptionsRecord {
+        geom::Position position{};
+        StringRef text{};
+        std::uint32_t font_count{};
+        int size{};
+        FontStyle style{FontStyle::Normal};
+        Color color{};
+    };
+
+    struct DrawTextRecord {
+        geom::Position position{};
+        StringRef text{};
+        StringRef font{};
+        int size{};
+        FontStyle style{FontStyle::Normal};
+        Color color{};
+    };
+
+    struct DrawPixelsRecord {
+        geom::Rect rect{};
+        StringRef pixels{};
+        int width{};
+        int height{};
+        std::size_t image_id{};
+    };
+
+    template<typename T>
+    void append(T const &record) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        auto offset = bytes_.size();
+        bytes_.resize(offset + sizeof(T));
+        std::memcpy(bytes_.data() + offset, &record, sizeof(T));
+    }
+
+    template<typename T>
+    T read(std::size_t &offset) const {
+        T record;
+        std::memcpy(&record, bytes_.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return record;
+    }
+
+    StringRef intern(std::string_view text) {
+        StringRef ref{static_cast<std::uint32_t>(text_arena_.size()), static_cast<std::uint32_t>(text.size())};
+        text_arena_.append(text);
+        return ref;
+    }
+
+    [[nodiscard]] std::string_view view(StringRef ref) const {
+        return std::string_view{text_arena_}.substr(ref.offset, ref.length);
+    }
+
+    std::vector<std::byte> bytes_{};
+    std::string text_arena_{};
+};
+
+// ICanvas front for CanvasCommandBuffer, mirroring CanvasCommandSaver.
+class CanvasCommandBufferSaver : public ICanvas {
+public:
+    // ICanvas
+    void set_viewport_size(int width, int height) override { buffer_.set_viewport_size(width, height); }
+    void set_scale(int scale) override { buffer_.set_scale(scale); }
+    void add_translation(int dx, int dy) override { buffer_.add_translation(dx, dy); }
+    void fill_rect(geom::Rect const &rect, Color color) override { buffer_.fill_rect(rect, color); }
+    void draw_rect(geom::Rect const &rect, Color const &color, Borders const &borders) override {
+        buffer_.draw_rect(rect, color, borders);
+    }
+    void draw_text(geom::Position position,
+            std::string_view text,
+            std::vector<Font> const &font_options,
+            FontSize size,
+            FontStyle style,
+            Color color) override {
+        buffer_.draw_text(position, text, font_options, size, style, color);
+    }
+    void draw_text(geom::Position position,
+            std::string_view text,
+            Font font,
+            FontSize size,
+            FontStyle style,
+            Color color) override {
+        buffer_.draw_text(position, text, font, size, style, color);
+    }
+    void draw_pixels(geom::Rect const &rect,
+            std::span<std::uint8_t const> rgba_data,
+            int width,
+            int height,
+            std::size_t image_id) override {
+        buffer_.draw_pixels(rect, rgba_data, width, height, image_id);
+    }
+
+    //
+    [[nodiscard]] CanvasCommandBuffer take_buffer() { return std::exchange(buffer_, {}); }
+
+private:
+    CanvasCommandBuffer buffer_{};
+};
+
+inline void replay_commands(ICanvas &canvas, CanvasCommandBuffer const &commands) {
+    commands.replay(canvas);
+}
+
+} // namespace gfx
+
+#endif
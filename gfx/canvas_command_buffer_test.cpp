@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/canvas_command_buffer.h"
+
+#include "etest/etest.h"
+#include "gfx/canvas_command_saver.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace gfx;
+using namespace std::literals;
+
+using etest::expect;
+using etest::expect_eq;
+
+using CanvasCommands = std::vector<CanvasCommand>;
+
+namespace {
+
+// Replays the buffer into a CanvasCommandSaver so the result can be compared
+// against the variant-based commands.
+CanvasCommands replayed(CanvasCommandBuffer const &buffer) {
+    CanvasCommandSaver saver;
+    replay_commands(saver, buffer);
+    return saver.take_commands();
+}
+
+} // namespace
+
+int main() {
+    etest::test("CanvasCommandBufferSaver::take_buffer", [] {
+        CanvasCommandBufferSaver saver;
+        expect(saver.take_buffer().empty());
+
+        saver.set_scale(1);
+        expect_eq(replayed(saver.take_buffer()), CanvasCommands{SetScaleCmd{1}});
+        expect(saver.take_buffer().empty());
+
+        saver.set_scale(1);
+        saver.set_scale(1);
+        expect_eq(replayed(saver.take_buffer()), CanvasCommands{SetScaleCmd{1}, SetScaleCmd{1}});
+    });
+
+    etest::test("pod commands", [] {
+        CanvasCommandBufferSaver saver;
+        saver.set_viewport_size(5, 15);
+        saver.set_scale(1000);
+        saver.add_translation(-10, 10);
+        saver.fill_rect({1, 2, 3, 4}, {0xab, 0xcd, 0xef});
+
+        Borders borders;
+        borders.left.color = Color::from_rgb(0xFF00FF);
+        borders.left.size = 10;
+        saver.draw_rect({1, 2, 3, 4}, {0xFF, 0xAA, 0xFF}, borders);
+
+        expect_eq(replayed(saver.take_buffer()),
+                CanvasCommands{
+                        SetViewportSizeCmd{5, 15},
+                        SetScaleCmd{1000},
+                        AddTranslationCmd{-10, 10},
+                        FillRectCmd{{1, 2, 3, 4}, {0xab, 0xcd, 0xef}},
+                        DrawRectCmd{{1, 2, 3, 4}, {0xFF, 0xAA, 0xFF}, borders},
+                });
+    });
+
+    etest::test("text commands, payloads survive the source strings", [] {
+        CanvasCommandBufferSaver saver;
+        {
+            // Scoped so that anything referencing these would dangle.
+            std::string text{"hello!"};
+            std::string font{"comic sans"};
+            saver.draw_text({1, 2}, text, Font{font}, {11}, FontStyle::Normal, {1, 2, 3});
+
+            std::vector<Font> options{{"font1"}, {"font2"}};
+            saver.draw_text({1, 5}, text, options, {42}, FontStyle::Italic, {3, 2, 1});
+        }
+
+        expect_eq(replayed(saver.take_buffer()),
+                CanvasCommands{
+                        DrawTextCmd{{1, 2}, "hello!"s, "comic sans"s, 11, FontStyle::Normal, {1, 2, 3}},
+                        DrawTextWithFontOptionsCmd{
+                                {1, 5}, "hello!"s, {"font1"s, "font2"s}, 42, FontStyle::Italic, {3, 2, 1}},
+                });
+    });
+
+    etest::test("pixel commands, payloads survive the source buffer", [] {
+        CanvasCommandBufferSaver saver;
+        {
+            // Scoped so that anything referencing these would dangle.
+            std::vector<std::uint8_t> pixels{1, 2, 3, 4, 5, 6, 7, 8};
+            saver.draw_pixels({1, 2, 3, 4}, pixels, 2, 1, 42);
+        }
+
+        expect_eq(replayed(saver.take_buffer()),
+                CanvasCommands{DrawPixelsCmd{{1, 2, 3, 4}, {1, 2, 3, 4, 5, 6, 7, 8}, 2, 1, 42}});
+    });
+
+    etest::test("replay matches the variant-based recorder", [] {
+        CanvasCommandSaver variant_saver;
+        CanvasCommandBufferSaver flat_saver;
+        for (ICanvas *canvas : {static_cast<ICanvas *>(&variant_saver), static_cast<ICanvas *>(&flat_saver)}) {
+            canvas->set_scale(10);
+            canvas->set_viewport_size(1, 2);
+            canvas->add_translation(1234, 5678);
+            canvas->fill_rect({9, 9, 9, 9}, {0x12, 0x34, 0x56});
+            canvas->draw_rect({9, 9, 9, 9}, {0x10, 0x11, 0x12}, {});
+            canvas->draw_text({10, 10}, "beep beep boop!"sv, {"helvetica"}, {42}, FontStyle::Italic, {3, 2, 1});
+            canvas->draw_text({1, 5}, "hello?"sv, {{"font1"}, {"font2"}}, {42}, FontStyle::Normal, {1, 2, 3});
+            canvas->draw_pixels({9, 9, 9, 9}, std::vector<std::uint8_t>{1, 2, 3, 4}, 1, 1, 42);
+        }
+
+        expect_eq(replayed(flat_saver.take_buffer()), variant_saver.take_commands());
+    });
+
+    etest::test("clear", [] {
+        CanvasCommandBuffer buffer;
+        buffer.set_scale(1);
+        expect(!buffer.empty());
+
+        buffer.clear();
+        expect(buffer.empty());
+        expect_eq(replayed(buffer), CanvasCommands{});
+    });
+
+    return etest::run_all_tests();
+}
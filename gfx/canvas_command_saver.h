@@ -8,7 +8,10 @@
 #include "gfx/icanvas.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <span>
 #include <string>
 #include <utility>
 #include <variant>
@@ -73,13 +76,24 @@ struct DrawTextCmd {
     [[nodiscard]] bool operator==(DrawTextCmd const &) const = default;
 };
 
+struct DrawPixelsCmd {
+    geom::Rect rect{};
+    std::vector<std::uint8_t> rgba_data{};
+    int width{};
+    int height{};
+    std::size_t image_id{};
+
+    [[nodiscard]] bool operator==(DrawPixelsCmd const &) const = default;
+};
+
 using CanvasCommand = std::variant<SetViewportSizeCmd,
         SetScaleCmd,
         AddTranslationCmd,
         FillRectCmd,
         DrawRectCmd,
         DrawTextWithFontOptionsCmd,
-        DrawTextCmd>;
+        DrawTextCmd,
+        DrawPixelsCmd>;
 
 class CanvasCommandSaver : public ICanvas {
 public:
@@ -114,6 +128,15 @@ public:
         cmds_.emplace_back(DrawTextCmd{position, std::string{text}, std::string{font.font}, size.px, style, color});
     }
 
+    void draw_pixels(geom::Rect const &rect,
+            std::span<std::uint8_t const> rgba_data,
+            int width,
+            int height,
+            std::size_t image_id) override {
+        cmds_.emplace_back(
+                DrawPixelsCmd{rect, {rgba_data.begin(), rgba_data.end()}, width, height, image_id});
+    }
+
     //
     [[nodiscard]] std::vector<CanvasCommand> take_commands() { return std::exchange(cmds_, {}); }
 
@@ -142,6 +165,10 @@ public:
         canvas_.draw_text(cmd.position, cmd.text, {cmd.font}, {cmd.size}, cmd.style, cmd.color);
     }
 
+    void operator()(DrawPixelsCmd const &cmd) {
+        canvas_.draw_pixels(cmd.rect, cmd.rgba_data, cmd.width, cmd.height, cmd.image_id);
+    }
+
 private:
     ICanvas &canvas_;
 };
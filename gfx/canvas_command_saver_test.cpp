@@ -6,8 +6,10 @@
 
 #include "etest/etest.h"
 
+#include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 
 using namespace gfx;
 using namespace std::literals;
@@ -84,6 +86,13 @@ int main() {
                         {1, 2}, "hello!"s, {{"comic sans"}}, 11, FontStyle::Normal, {1, 2, 3}}});
     });
 
+    etest::test("CanvasCommandSaver::draw_pixels", [] {
+        CanvasCommandSaver saver;
+        std::vector<std::uint8_t> pixels{1, 2, 3, 4};
+        saver.draw_pixels({1, 2, 3, 4}, pixels, 1, 1, 42);
+        expect_eq(saver.take_commands(), CanvasCommands{DrawPixelsCmd{{1, 2, 3, 4}, pixels, 1, 1, 42}});
+    });
+
     etest::test("replay_commands", [] {
         CanvasCommandSaver saver;
         saver.set_scale(10);
@@ -95,6 +104,7 @@ int main() {
         saver.draw_rect({9, 9, 9, 9}, {0x10, 0x11, 0x12}, {});
         saver.draw_text({10, 10}, "beep beep boop!"sv, {"helvetica"}, {42}, FontStyle::Italic, {3, 2, 1});
         saver.draw_text({1, 5}, "hello?"sv, {{"font1"}, {"font2"}}, {42}, FontStyle::Normal, {1, 2, 3});
+        saver.draw_pixels({9, 9, 9, 9}, std::vector<std::uint8_t>{1, 2, 3, 4}, 1, 1, 42);
         auto cmds = saver.take_commands();
 
         CanvasCommandSaver replayed;
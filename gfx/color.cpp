@@ -7,22 +7,21 @@
 
 #include "util/string.h"
 
-#include <algorithm>
-#include <map>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 namespace gfx {
 namespace {
 
-struct CaseInsensitiveLess {
-    using is_transparent = void;
-    bool operator()(std::string_view s1, std::string_view s2) const {
-        return std::ranges::lexicographical_compare(
-                s1, s2, [](char c1, char c2) { return util::lowercased(c1) < util::lowercased(c2); });
-    }
+struct NamedColor {
+    std::string_view name;
+    gfx::Color color;
 };
 
 // https://developer.mozilla.org/en-US/docs/Web/CSS/color_value/color_keywords#list_of_all_color_keywords
-std::map<std::string_view, gfx::Color, CaseInsensitiveLess> const kNamedColors{
+constexpr auto kNamedColors = std::to_array<NamedColor>({
         // System colors.
         // https://developer.mozilla.org/en-US/docs/Web/CSS/color_value#system_colors
         // TODO(robinlinden): Move these elsewhere and actually grab them from the system.
@@ -187,16 +186,53 @@ std::map<std::string_view, gfx::Color, CaseInsensitiveLess> const kNamedColors{
         {"yellowgreen", gfx::Color::from_rgb(0x9a'cd'32)},
         // CSS Level 4.
         {"rebeccapurple", gfx::Color::from_rgb(0x66'33'99)},
-};
+});
+
+// FNV-1a with the case fold baked in, so lookups hash the caller's spelling
+// directly instead of lowercasing into a copy first.
+constexpr std::uint64_t hash_lowercased(std::string_view name) {
+    std::uint64_t hash{0xcbf2'9ce4'8422'2325};
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(util::lowercased(c));
+        hash *= 0x100'0000'01b3;
+    }
+
+    return hash;
+}
+
+// The named colors, open-addressed by hash at compile time. The load factor
+// is kept low enough that a lookup is a hash and a probe or two; misses stop
+// at the first empty slot.
+constexpr std::size_t kColorSlotCount{512};
+static_assert(kColorSlotCount >= 2 * kNamedColors.size());
+
+constexpr auto kNamedColorTable = [] {
+    std::array<NamedColor, kColorSlotCount> slots{};
+    for (auto const &entry : kNamedColors) {
+        auto slot = hash_lowercased(entry.name) % kColorSlotCount;
+        while (!slots[slot].name.empty()) {
+            slot = (slot + 1) % kColorSlotCount;
+        }
+
+        slots[slot] = entry;
+    }
+
+    return slots;
+}();
 
 } // namespace
 
 std::optional<Color> Color::from_css_name(std::string_view name) {
-    if (!kNamedColors.contains(name)) {
-        return std::nullopt;
-    }
+    for (auto slot = hash_lowercased(name) % kColorSlotCount;; slot = (slot + 1) % kColorSlotCount) {
+        auto const &candidate = kNamedColorTable[slot];
+        if (candidate.name.empty()) {
+            return std::nullopt;
+        }
 
-    return kNamedColors.at(name);
+        if (util::iequals(candidate.name, name)) {
+            return candidate.color;
+        }
+    }
 }
 
 } // namespace gfx
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/color_ops.h"
+
+#include "gfx/color.h"
+
+#include "etest/etest.h"
+
+#include <cstdint>
+#include <vector>
+
+using etest::expect_eq;
+
+int main() {
+    etest::test("scaled", [] {
+        expect_eq(gfx::scaled(0xFF'FF'FF'FF, 0xFF), 0xFF'FF'FF'FFu);
+        expect_eq(gfx::scaled(0xFF'FF'FF'FF, 0), 0u);
+        expect_eq(gfx::scaled(0xFF'00'FF'00, 0x80), 0x80'00'80'00u);
+    });
+
+    etest::test("premultiplied", [] {
+        // Alpha is untouched, colour channels are scaled by it.
+        expect_eq(gfx::premultiplied(0xFF'FF'FF'80), 0x80'80'80'80u);
+        expect_eq(gfx::premultiplied(0xFF'FF'FF'00), 0x00'00'00'00u);
+        expect_eq(gfx::premultiplied(0x12'34'56'FF), 0x12'34'56'FFu);
+    });
+
+    etest::test("blended", [] {
+        // Opaque source replaces the destination.
+        expect_eq(gfx::blended(0x12'34'56'FF, 0xFF'FF'FF'FF), 0x12'34'56'FFu);
+        // Fully transparent source leaves the destination untouched.
+        expect_eq(gfx::blended(0x00'00'00'00, 0x12'34'56'FF), 0x12'34'56'FFu);
+        // 50% grey over opaque black.
+        expect_eq(gfx::blended(gfx::premultiplied(0xFF'FF'FF'80), 0x00'00'00'FF), 0x80'80'80'FFu);
+    });
+
+    etest::test("lerped", [] {
+        expect_eq(gfx::lerped(0x00'00'00'FF, 0xFF'FF'FF'FF, 0), 0x00'00'00'FFu);
+        expect_eq(gfx::lerped(0x00'00'00'FF, 0xFF'FF'FF'FF, 0xFF), 0xFF'FF'FF'FFu);
+        expect_eq(gfx::lerped(0x00'00'00'FF, 0xFF'FF'FF'FF, 0x80), 0x80'80'80'FFu);
+    });
+
+    etest::test("span helpers", [] {
+        std::vector<std::uint32_t> pixels{0xFF'FF'FF'80, 0xFF'FF'FF'FF};
+        gfx::premultiply(pixels);
+        expect_eq(pixels, std::vector<std::uint32_t>{0x80'80'80'80, 0xFF'FF'FF'FF});
+
+        std::vector<std::uint32_t> dst{0x00'00'00'FF, 0x00'00'00'FF};
+        gfx::blend_over(dst, pixels);
+        expect_eq(dst, std::vector<std::uint32_t>{0x80'80'80'FF, 0xFF'FF'FF'FF});
+
+        std::vector<std::uint32_t> gradient(3);
+        gfx::fill_lerp(gradient, gfx::Color{0, 0, 0}, gfx::Color{0xFF, 0xFF, 0xFF});
+        expect_eq(gradient, std::vector<std::uint32_t>{0x00'00'00'FF, 0x7F'7F'7F'FF, 0xFF'FF'FF'FF});
+    });
+
+    return etest::run_all_tests();
+}
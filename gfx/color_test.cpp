@@ -28,7 +28,10 @@ int main() {
 
     etest::test("Color::from_css_name", [] {
         expect_eq(Color::from_css_name("blue"), Color{.b = 0xFF});
+        expect_eq(Color::from_css_name("BLUE"), Color{.b = 0xFF});
+        expect_eq(Color::from_css_name("RebeccaPurple"), Color::from_rgb(0x66'33'99));
         expect_eq(Color::from_css_name("not a valid css name"), std::nullopt);
+        expect_eq(Color::from_css_name(""), std::nullopt);
     });
 
     etest::test("Color::as_rgba_u32", [] {
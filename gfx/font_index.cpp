@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/font_index.h"
+
+#include "os/os.h"
+#include "util/string.h"
+
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+using namespace std::literals;
+
+namespace gfx {
+namespace {
+
+constexpr auto kMagic = "hastur-font-index 1"sv;
+
+bool is_font_file(std::filesystem::path const &path) {
+    auto extension = util::lowercased(path.extension().string());
+    return extension == ".ttf" || extension == ".otf";
+}
+
+std::int64_t mtime_of(std::string const &path) {
+    std::error_code errc;
+    auto time = std::filesystem::last_write_time(path, errc);
+    if (errc) {
+        return 0;
+    }
+
+    return time.time_since_epoch().count();
+}
+
+std::string default_cache_path() {
+    std::string base;
+    if (char const *xdg_cache_home = std::getenv("XDG_CACHE_HOME")) {
+        base = xdg_cache_home;
+    } else if (char const *home = std::getenv("HOME")) {
+        base = home + "/.cache"s;
+    } else {
+        return {};
+    }
+
+    return base + "/hastur/font-index";
+}
+
+} // namespace
+
+FontIndex FontIndex::build(std::vector<std::string> const &dirs) {
+    FontIndex index;
+    for (auto const &dir : dirs) {
+        index.dirs_.push_back({dir, mtime_of(dir)});
+
+        std::error_code errc;
+        auto it = std::filesystem::recursive_directory_iterator(dir, errc);
+        if (errc) {
+            continue;
+        }
+
+        for (auto const &entry : it) {
+            if (!std::filesystem::is_regular_file(entry) || !is_font_file(entry.path())) {
+                continue;
+            }
+
+            index.fonts_.push_back({
+                    util::lowercased(entry.path().filename().string()),
+                    entry.path().string(),
+            });
+        }
+    }
+
+    return index;
+}
+
+std::optional<FontIndex> FontIndex::load(std::string const &cache_path, std::vector<std::string> const &dirs) {
+    std::ifstream file{cache_path};
+    if (!file) {
+        return std::nullopt;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != kMagic) {
+        return std::nullopt;
+    }
+
+    FontIndex index;
+    while (std::getline(file, line)) {
+        auto first_tab = line.find('\t');
+        if (first_tab == std::string::npos) {
+            return std::nullopt;
+        }
+
+        auto kind = std::string_view{line}.substr(0, first_tab);
+        auto rest = std::string_view{line}.substr(first_tab + 1);
+        auto second_tab = rest.find('\t');
+        if (second_tab == std::string_view::npos) {
+            return std::nullopt;
+        }
+
+        if (kind == "dir") {
+            std::int64_t mtime{};
+            auto mtime_str = rest.substr(0, second_tab);
+            if (std::from_chars(mtime_str.data(), mtime_str.data() + mtime_str.size(), mtime).ec != std::errc{}) {
+                return std::nullopt;
+            }
+
+            index.dirs_.push_back({std::string{rest.substr(second_tab + 1)}, mtime});
+        } else if (kind == "font") {
+            index.fonts_.push_back({std::string{rest.substr(0, second_tab)}, std::string{rest.substr(second_tab + 1)}});
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    // The cache is only good if it covers exactly these directories and none
+    // of them have changed since it was written.
+    if (index.dirs_.size() != dirs.size()) {
+        return std::nullopt;
+    }
+
+    for (std::size_t i = 0; i < dirs.size(); ++i) {
+        if (index.dirs_[i].path != dirs[i] || index.dirs_[i].mtime != mtime_of(dirs[i])) {
+            return std::nullopt;
+        }
+    }
+
+    return index;
+}
+
+bool FontIndex::save(std::string const &cache_path) const {
+    std::error_code errc;
+    std::filesystem::create_directories(std::filesystem::path{cache_path}.parent_path(), errc);
+
+    std::stringstream ss;
+    ss << kMagic << '\n';
+    for (auto const &dir : dirs_) {
+        ss << "dir\t" << dir.mtime << '\t' << dir.path << '\n';
+    }
+    for (auto const &font : fonts_) {
+        ss << "font\t" << font.filename << '\t' << font.path << '\n';
+    }
+
+    std::ofstream file{cache_path, std::ios::trunc};
+    file << std::move(ss).str();
+    return bool{file};
+}
+
+FontIndex FontIndex::load_or_build(std::string const &cache_path, std::vector<std::string> const &dirs) {
+    if (auto cached = load(cache_path, dirs)) {
+        return *std::move(cached);
+    }
+
+    auto index = build(dirs);
+    index.save(cache_path);
+    return index;
+}
+
+FontIndex FontIndex::load_or_build() {
+    return load_or_build(default_cache_path(), os::font_paths());
+}
+
+std::optional<std::string> FontIndex::find(std::string_view family) const {
+    for (auto const &font : fonts_) {
+        if (util::ifind(font.filename, family) != std::string_view::npos) {
+            return font.path;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::string> FontIndex::fallback() const {
+    if (fonts_.empty()) {
+        return std::nullopt;
+    }
+
+    return fonts_.front().path;
+}
+
+} // namespace gfx
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef GFX_FONT_INDEX_H_
+#define GFX_FONT_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gfx {
+
+// Index over the font files in the system's font directories.
+//
+// Resolving a font family to a file by walking the filesystem is slow enough
+// to be visible on first text draw (and very visible on network mounts), so
+// the walk happens once and the result is cached on disk. The cache remembers
+// the modification time of every indexed directory and is rebuilt when any of
+// them changes.
+class FontIndex {
+public:
+    // Loads the index cached at cache_path if it's still valid for dirs, or
+    // rebuilds it from the filesystem and rewrites the cache.
+    static FontIndex load_or_build(std::string const &cache_path, std::vector<std::string> const &dirs);
+
+    // As above, but over os::font_paths() with the cache in the user's cache
+    // directory.
+    static FontIndex load_or_build();
+
+    // Builds an index by walking dirs, without touching any cache.
+    static FontIndex build(std::vector<std::string> const &dirs);
+
+    static std::optional<FontIndex> load(std::string const &cache_path, std::vector<std::string> const &dirs);
+    bool save(std::string const &cache_path) const;
+
+    // Path to a font file whose name contains family, case-insensitively.
+    [[nodiscard]] std::optional<std::string> find(std::string_view family) const;
+
+    // Any font at all, for when nothing matches.
+    [[nodiscard]] std::optional<std::string> fallback() const;
+
+    [[nodiscard]] std::size_t size() const { return fonts_.size(); }
+
+private:
+    struct IndexedDir {
+        std::string path;
+        std::int64_t mtime{};
+    };
+
+    struct IndexedFont {
+        std::string filename; // Lowercased, for case-insensitive lookup.
+        std::string path;
+    };
+
+    std::vector<IndexedDir> dirs_{};
+    std::vector<IndexedFont> fonts_{};
+};
+
+} // namespace gfx
+
+#endif
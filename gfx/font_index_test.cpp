@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/font_index.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using etest::expect;
+using etest::expect_eq;
+
+namespace {
+
+// A temporary directory tree with a couple of font-looking files in it,
+// removed when the test is done with it.
+class TestFontDir {
+public:
+    TestFontDir() : root_{std::filesystem::temp_directory_path() / "hastur-font-index-test"} {
+        std::filesystem::remove_all(root_);
+        std::filesystem::create_directories(root_ / "fonts" / "nested");
+        touch(root_ / "fonts" / "DejaVuSans.ttf");
+        touch(root_ / "fonts" / "nested" / "comic-sans.otf");
+        touch(root_ / "fonts" / "not-a-font.txt");
+    }
+
+    ~TestFontDir() { std::filesystem::remove_all(root_); }
+
+    // The cache lives outside the indexed directory so that writing it
+    // doesn't bump the mtimes it validates against.
+    std::string path() const { return (root_ / "fonts").string(); }
+    std::string cache_path() const { return (root_ / "cache" / "font-index").string(); }
+
+    static void touch(std::filesystem::path const &path) { std::ofstream{path} << "beep boop"; }
+
+private:
+    std::filesystem::path root_;
+};
+
+} // namespace
+
+int main() {
+    etest::test("build finds fonts, skips everything else", [] {
+        TestFontDir dir{};
+        auto index = gfx::FontIndex::build({dir.path()});
+
+        expect_eq(index.size(), std::size_t{2});
+        expect(index.find("dejavusans").has_value());
+        expect(index.find("comic-sans").has_value());
+        expect(!index.find("not-a-font").has_value());
+    });
+
+    etest::test("find is case-insensitive, fallback finds anything", [] {
+        TestFontDir dir{};
+        auto index = gfx::FontIndex::build({dir.path()});
+
+        expect_eq(index.find("DEJAVU"), index.find("dejavu"));
+        expect(index.fallback().has_value());
+        expect_eq(gfx::FontIndex::build({}).fallback(), std::nullopt);
+    });
+
+    etest::test("save/load roundtrip", [] {
+        TestFontDir dir{};
+        auto index = gfx::FontIndex::build({dir.path()});
+        expect(index.save(dir.cache_path()));
+
+        auto loaded = gfx::FontIndex::load(dir.cache_path(), {dir.path()});
+        expect(loaded.has_value());
+        expect_eq(loaded->size(), index.size());
+        expect_eq(loaded->find("dejavu"), index.find("dejavu"));
+    });
+
+    etest::test("load rejects caches for other directories", [] {
+        TestFontDir dir{};
+        gfx::FontIndex::build({dir.path()}).save(dir.cache_path());
+
+        expect_eq(gfx::FontIndex::load(dir.cache_path(), {dir.path() + "/nested"}), std::nullopt);
+        expect_eq(gfx::FontIndex::load(dir.cache_path(), {}), std::nullopt);
+    });
+
+    etest::test("load rejects caches for directories that have changed", [] {
+        TestFontDir dir{};
+        gfx::FontIndex::build({dir.path()}).save(dir.cache_path());
+
+        // Adding a font bumps the directory's mtime, invalidating the cache.
+        TestFontDir::touch(std::filesystem::path{dir.path()} / "wingdings.ttf");
+        expect_eq(gfx::FontIndex::load(dir.cache_path(), {dir.path()}), std::nullopt);
+    });
+
+    etest::test("load_or_build rebuilds and repopulates the cache", [] {
+        TestFontDir dir{};
+        auto index = gfx::FontIndex::load_or_build(dir.cache_path(), {dir.path()});
+        expect_eq(index.size(), std::size_t{2});
+
+        // The rebuild wrote a cache that's now valid.
+        expect(gfx::FontIndex::load(dir.cache_path(), {dir.path()}).has_value());
+    });
+
+    return etest::run_all_tests();
+}
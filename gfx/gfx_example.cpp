@@ -56,6 +56,7 @@ int main(int argc, char **argv) {
         canvas->draw_text({100, 50}, "hello!"sv, {"arial"}, {16}, gfx::FontStyle::Normal, gfx::Color{});
         canvas->draw_text({100, 80}, "hello, but fancy!"sv, {"arial"}, {16}, gfx::FontStyle::Italic, gfx::Color{});
 
+        canvas->flush();
         window.display();
     }
 }
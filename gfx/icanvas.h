@@ -9,6 +9,9 @@
 #include "gfx/color.h"
 #include "gfx/font.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -36,6 +39,19 @@ public:
     virtual void draw_rect(geom::Rect const &, Color const &, Borders const &) = 0;
     virtual void draw_text(geom::Position, std::string_view, std::vector<Font> const &, FontSize, FontStyle, Color) = 0;
     virtual void draw_text(geom::Position, std::string_view, Font, FontSize, FontStyle, Color) = 0;
+
+    // Draws a width-by-height rgba bitmap scaled to cover the rect. image_id
+    // names the bitmap across frames: canvases that upload to the GPU keep
+    // one texture per id and only read rgba_data when an id first shows up,
+    // so repainting an unchanged image costs a textured quad, not an upload.
+    // Use a new id when the pixels change.
+    virtual void draw_pixels(
+            geom::Rect const &, std::span<std::uint8_t const> rgba_data, int width, int height, std::size_t image_id) = 0;
+
+    // Submits any drawing the canvas has buffered. Call once everything for
+    // the current frame has been issued. Canvases that draw immediately don't
+    // need to override this.
+    virtual void flush() {}
 };
 
 } // namespace gfx
@@ -4,15 +4,238 @@
 
 #include "gfx/opengl_canvas.h"
 
+#include "gfx/font_index.h"
+
 #include <GL/glew.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
 
 namespace gfx {
+namespace {
+
+// One index for every canvas in the process: the filesystem walk (or the
+// on-disk cache standing in for it) is the same no matter which canvas asks.
+// Built the first time text is drawn.
+FontIndex const &font_index() {
+    static FontIndex const index = FontIndex::load_or_build();
+    return index;
+}
+
+// Decodes the utf-8 code point starting at i and advances i past it. Invalid
+// bytes decode as U+FFFD so broken text still renders something.
+std::uint32_t next_code_point(std::string_view text, std::size_t &i) {
+    auto lead = static_cast<unsigned char>(text[i]);
+    i += 1;
+    if (lead < 0x80) {
+        return lead;
+    }
+
+    std::size_t continuation_bytes{0};
+    std::uint32_t code_point{0};
+    if ((lead & 0b1110'0000) == 0b1100'0000) {
+        continuation_bytes = 1;
+        code_point = lead & 0b0001'1111;
+    } else if ((lead & 0b1111'0000) == 0b1110'0000) {
+        continuation_bytes = 2;
+        code_point = lead & 0b0000'1111;
+    } else if ((lead & 0b1111'1000) == 0b1111'0000) {
+        continuation_bytes = 3;
+        code_point = lead & 0b0000'0111;
+    } else {
+        return 0xfffd;
+    }
+
+    for (std::size_t j = 0; j < continuation_bytes; ++j) {
+        if (i >= text.size() || (static_cast<unsigned char>(text[i]) & 0b1100'0000) != 0b1000'0000) {
+            return 0xfffd;
+        }
+
+        code_point = code_point << 6 | (static_cast<unsigned char>(text[i]) & 0b0011'1111);
+        i += 1;
+    }
+
+    return code_point;
+}
+
+} // namespace
+
+// One texture holding every glyph rasterized so far, packed left-to-right
+// into shelves. Uploading a glyph once and drawing quads into the atlas is
+// what lets a frame of text be a single draw call.
+struct OpenGLCanvas::GlyphAtlas {
+    static constexpr int kSize{1024};
+
+    struct Glyph {
+        // The glyph's bitmap in the atlas, in texture coordinates.
+        float u0{};
+        float v0{};
+        float u1{};
+        float v1{};
+        int width{};
+        int height{};
+        // Offset from the pen position to the bitmap's top left.
+        int bearing_x{};
+        int bearing_y{};
+        // How far to move the pen for the next glyph, in pixels.
+        int advance{};
+        // Baseline offset from the top of the line, shared by every glyph
+        // of one face and size.
+        int ascent{};
+    };
+
+    GlyphAtlas() { FT_Init_FreeType(&library_); }
+
+    ~GlyphAtlas() {
+        for (auto &[_, face] : faces_) {
+            if (face != nullptr) {
+                FT_Done_Face(face);
+            }
+        }
+        FT_Done_FreeType(library_);
+        if (texture_ != 0) {
+            glDeleteTextures(1, &texture_);
+        }
+    }
+
+    GlyphAtlas(GlyphAtlas const &) = delete;
+    GlyphAtlas &operator=(GlyphAtlas const &) = delete;
+
+    // The atlas texture, created on first use.
+    GLuint texture() {
+        if (texture_ == 0) {
+            glGenTextures(1, &texture_);
+            glBindTexture(GL_TEXTURE_2D, texture_);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, kSize, kSize, 0, GL_ALPHA, GL_UNSIGNED_BYTE, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+
+        return texture_;
+    }
+
+    // The glyph for code_point at px pixels, rasterizing and uploading it on
+    // first use. Returns nullptr if the glyph can't be rasterized or the
+    // atlas is out of space.
+    // TODO(robinlinden): Glyphs are never evicted from the atlas.
+    Glyph const *find_or_insert(std::string_view family, int px, std::uint32_t code_point) {
+        GlyphKey key{std::string{family}, px, code_point};
+        if (auto it = glyphs_.find(key); it != glyphs_.end()) {
+            return it->second.has_value() ? &*it->second : nullptr;
+        }
+
+        auto &slot = glyphs_[std::move(key)];
+        FT_Face face = face_for(family);
+        if (face == nullptr || FT_Set_Pixel_Sizes(face, 0, px) != 0
+                || FT_Load_Char(face, code_point, FT_LOAD_RENDER) != 0) {
+            return nullptr;
+        }
+
+        auto const &bitmap = face->glyph->bitmap;
+        auto width = static_cast<int>(bitmap.width);
+        auto height = static_cast<int>(bitmap.rows);
+        if (pen_x_ + width > kSize) {
+            pen_x_ = 0;
+            pen_y_ += row_height_;
+            row_height_ = 0;
+        }
+
+        if (pen_y_ + height > kSize) {
+            return nullptr;
+        }
+
+        if (width > 0 && height > 0) {
+            glBindTexture(GL_TEXTURE_2D, texture());
+            // Glyph bitmaps are tightly packed one byte per pixel.
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(
+                    GL_TEXTURE_2D, 0, pen_x_, pen_y_, width, height, GL_ALPHA, GL_UNSIGNED_BYTE, bitmap.buffer);
+        }
+
+        slot = Glyph{
+                .u0 = static_cast<float>(pen_x_) / kSize,
+                .v0 = static_cast<float>(pen_y_) / kSize,
+                .u1 = static_cast<float>(pen_x_ + width) / kSize,
+                .v1 = static_cast<float>(pen_y_ + height) / kSize,
+                .width = width,
+                .height = height,
+                .bearing_x = face->glyph->bitmap_left,
+                .bearing_y = face->glyph->bitmap_top,
+                .advance = static_cast<int>(face->glyph->advance.x >> 6),
+                .ascent = static_cast<int>(face->size->metrics.ascender >> 6),
+        };
+
+        pen_x_ += width;
+        row_height_ = std::max(row_height_, height);
+        return &*slot;
+    }
+
+private:
+    struct GlyphKey {
+        std::string font{};
+        int px{};
+        std::uint32_t code_point{};
+        [[nodiscard]] auto operator<=>(GlyphKey const &) const = default;
+    };
+
+    // The face for a font family, loading it through the font index on first
+    // use. Failures are cached too, so a missing font is one filesystem miss
+    // rather than one per glyph.
+    // TODO(robinlinden): Style-specific faces.
+    FT_Face face_for(std::string_view family) {
+        if (auto it = faces_.find(family); it != faces_.end()) {
+            return it->second;
+        }
+
+        auto &face = faces_[std::string{family}];
+        auto path = font_index().find(family);
+        if (!path) {
+            path = font_index().fallback();
+        }
+
+        if (!path || FT_New_Face(library_, path->c_str(), 0, &face) != 0) {
+            face = nullptr;
+        }
+
+        return face;
+    }
+
+    FT_Library library_{};
+    std::map<std::string, FT_Face, std::less<>> faces_{};
+    // nullopt marks glyphs that couldn't be rasterized, so they fail once
+    // instead of once per frame.
+    std::map<GlyphKey, std::optional<Glyph>> glyphs_{};
+    GLuint texture_{};
+    // Shelf-packing state: glyphs go left to right along the current row.
+    int pen_x_{};
+    int pen_y_{};
+    int row_height_{};
+};
 
 OpenGLCanvas::OpenGLCanvas() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+OpenGLCanvas::~OpenGLCanvas() {
+    for (auto const &[_, texture] : image_textures_) {
+        glDeleteTextures(1, &texture);
+    }
+    if (upload_pbo_ != 0) {
+        glDeleteBuffers(1, &upload_pbo_);
+    }
+}
+
 void OpenGLCanvas::set_viewport_size(int width, int height) {
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
@@ -25,8 +248,167 @@ void OpenGLCanvas::set_viewport_size(int width, int height) {
 void OpenGLCanvas::fill_rect(geom::Rect const &rect, Color color) {
     auto translated{rect.translated(translation_x, translation_y)};
     auto scaled{translated.scaled(scale_)};
-    glColor4ub(color.r, color.g, color.b, color.a);
-    glRecti(scaled.x, scaled.y, scaled.x + scaled.width, scaled.y + scaled.height);
+
+    // Two triangles per rect, accumulated so a page of rects becomes one
+    // draw call in flush() instead of one per box.
+    auto corner = [&](int x, int y) { return Vertex{x, y, color.r, color.g, color.b, color.a}; };
+    auto top_left = corner(scaled.left(), scaled.top());
+    auto top_right = corner(scaled.right(), scaled.top());
+    auto bottom_left = corner(scaled.left(), scaled.bottom());
+    auto bottom_right = corner(scaled.right(), scaled.bottom());
+
+    vertices_.push_back(top_left);
+    vertices_.push_back(top_right);
+    vertices_.push_back(bottom_right);
+    vertices_.push_back(top_left);
+    vertices_.push_back(bottom_right);
+    vertices_.push_back(bottom_left);
+}
+
+void OpenGLCanvas::draw_text(geom::Position p,
+        std::string_view text,
+        std::vector<Font> const &font_options,
+        FontSize size,
+        FontStyle style,
+        Color color) {
+    // Per-glyph font selection is future work: the first option gets the
+    // whole run, and the atlas falls back to any font it can find.
+    draw_text(p, text, !font_options.empty() ? font_options.front() : Font{}, size, style, color);
+}
+
+void OpenGLCanvas::draw_text(
+        geom::Position p, std::string_view text, Font font, FontSize size, FontStyle, Color color) {
+    if (!glyphs_) {
+        glyphs_ = std::make_unique<GlyphAtlas>();
+    }
+
+    p = p.translated(translation_x, translation_y).scaled(scale_);
+    int px = size.px * scale_;
+    int pen_x = p.x;
+
+    for (std::size_t i = 0; i < text.size();) {
+        auto code_point = next_code_point(text, i);
+        auto const *glyph = glyphs_->find_or_insert(font.font, px, code_point);
+        if (glyph == nullptr) {
+            continue;
+        }
+
+        // Two triangles per glyph, like fill_rect, but textured with the
+        // glyph's slice of the atlas. The vertex colour tints the alpha-only
+        // texture in flush().
+        int x0 = pen_x + glyph->bearing_x;
+        int y0 = p.y + glyph->ascent - glyph->bearing_y;
+        int x1 = x0 + glyph->width;
+        int y1 = y0 + glyph->height;
+        auto corner = [&](int x, int y, float u, float v) {
+            return TextVertex{x, y, u, v, color.r, color.g, color.b, color.a};
+        };
+        auto top_left = corner(x0, y0, glyph->u0, glyph->v0);
+        auto top_right = corner(x1, y0, glyph->u1, glyph->v0);
+        auto bottom_left = corner(x0, y1, glyph->u0, glyph->v1);
+        auto bottom_right = corner(x1, y1, glyph->u1, glyph->v1);
+
+        text_vertices_.push_back(top_left);
+        text_vertices_.push_back(top_right);
+        text_vertices_.push_back(bottom_right);
+        text_vertices_.push_back(top_left);
+        text_vertices_.push_back(bottom_right);
+        text_vertices_.push_back(bottom_left);
+
+        pen_x += glyph->advance;
+    }
+}
+
+void OpenGLCanvas::draw_pixels(
+        geom::Rect const &rect, std::span<std::uint8_t const> rgba_data, int width, int height, std::size_t image_id) {
+    auto size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4;
+    if (width <= 0 || height <= 0 || rgba_data.size() < size) {
+        return;
+    }
+
+    // The quad draws straight to the target, so everything buffered before
+    // this image has to land first.
+    flush();
+
+    auto it = image_textures_.find(image_id);
+    if (it == image_textures_.end()) {
+        // The pixels are staged through a pixel-buffer object so the driver
+        // can do the transfer to the texture without blocking us on it.
+        if (upload_pbo_ == 0) {
+            glGenBuffers(1, &upload_pbo_);
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), rgba_data.data(), GL_STREAM_DRAW);
+
+        GLuint texture{};
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        it = image_textures_.emplace(image_id, texture).first;
+    }
+
+    auto scaled{rect.translated(translation_x, translation_y).scaled(scale_)};
+    auto corner = [](int x, int y, float u, float v) {
+        return TextVertex{x, y, u, v, 0xff, 0xff, 0xff, 0xff};
+    };
+    std::array<TextVertex, 6> quad{
+            corner(scaled.left(), scaled.top(), 0.f, 0.f),
+            corner(scaled.right(), scaled.top(), 1.f, 0.f),
+            corner(scaled.right(), scaled.bottom(), 1.f, 1.f),
+            corner(scaled.left(), scaled.top(), 0.f, 0.f),
+            corner(scaled.right(), scaled.bottom(), 1.f, 1.f),
+            corner(scaled.left(), scaled.bottom(), 0.f, 1.f),
+    };
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, it->second);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(2, GL_INT, sizeof(TextVertex), &quad[0].x);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(TextVertex), &quad[0].u);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(quad.size()));
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisable(GL_TEXTURE_2D);
+}
+
+void OpenGLCanvas::flush() {
+    if (!vertices_.empty()) {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_INT, sizeof(Vertex), &vertices_[0].x);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &vertices_[0].r);
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices_.size()));
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        vertices_.clear();
+    }
+
+    if (!text_vertices_.empty()) {
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, glyphs_->texture());
+        // The atlas is alpha-only; the glyph colour comes from the vertices.
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glVertexPointer(2, GL_INT, sizeof(TextVertex), &text_vertices_[0].x);
+        glTexCoordPointer(2, GL_FLOAT, sizeof(TextVertex), &text_vertices_[0].u);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TextVertex), &text_vertices_[0].r);
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(text_vertices_.size()));
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisable(GL_TEXTURE_2D);
+        text_vertices_.clear();
+    }
 }
 
 } // namespace gfx
@@ -7,11 +7,19 @@
 
 #include "gfx/icanvas.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+
 namespace gfx {
 
 class OpenGLCanvas final : public ICanvas {
 public:
     OpenGLCanvas();
+    ~OpenGLCanvas() override;
 
     void set_viewport_size(int width, int height) override;
     constexpr void set_scale(int scale) override { scale_ = scale; }
@@ -23,10 +31,53 @@ public:
 
     void fill_rect(geom::Rect const &, Color) override;
     void draw_rect(geom::Rect const &, Color const &, Borders const &) override {}
-    void draw_text(geom::Position, std::string_view, std::vector<Font> const &, FontSize, FontStyle, Color) override {}
-    void draw_text(geom::Position, std::string_view, Font, FontSize, FontStyle, Color) override {}
+    void draw_text(geom::Position, std::string_view, std::vector<Font> const &, FontSize, FontStyle, Color) override;
+    void draw_text(geom::Position, std::string_view, Font, FontSize, FontStyle, Color) override;
+    void draw_pixels(geom::Rect const &, std::span<std::uint8_t const>, int width, int height, std::size_t) override;
+
+    // Draws everything buffered since the last flush: one draw call for the
+    // rects and one for all text, which shares a single glyph-atlas texture.
+    void flush() override;
 
 private:
+    struct Vertex {
+        int x{};
+        int y{};
+        std::uint8_t r{};
+        std::uint8_t g{};
+        std::uint8_t b{};
+        std::uint8_t a{};
+    };
+
+    struct TextVertex {
+        int x{};
+        int y{};
+        float u{};
+        float v{};
+        std::uint8_t r{};
+        std::uint8_t g{};
+        std::uint8_t b{};
+        std::uint8_t a{};
+    };
+
+    // Rasterized glyphs packed into one texture, populated on demand. Lives
+    // in the implementation file to keep FreeType out of the header.
+    struct GlyphAtlas;
+
+    // fill_rect only appends to this; nothing reaches the GPU until flush().
+    std::vector<Vertex> vertices_{};
+    // Textured quads for this frame's text, all sourcing the glyph atlas.
+    std::vector<TextVertex> text_vertices_{};
+    std::unique_ptr<GlyphAtlas> glyphs_{};
+    // One texture per image id, uploaded the first time the id is drawn and
+    // reused for every repaint after that.
+    // TODO(robinlinden): Textures are never evicted from the cache.
+    std::map<std::size_t, std::uint32_t> image_textures_{};
+    // Staging buffer for texture uploads, created on first use. Uploading
+    // through a pixel-buffer object lets the driver copy from it without
+    // blocking us on the transfer.
+    std::uint32_t upload_pbo_{};
+
     int translation_x{};
     int translation_y{};
     int scale_{1};
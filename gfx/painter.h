@@ -6,18 +6,26 @@
 #ifndef GFX_PAINTER_H_
 #define GFX_PAINTER_H_
 
+#include "gfx/canvas_command_saver.h"
 #include "gfx/icanvas.h"
 
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
 namespace gfx {
 
 class Painter {
 public:
-    explicit Painter(ICanvas &canvas) : canvas_{canvas} {}
+    explicit Painter(ICanvas &canvas, bool buffered = false) : canvas_{canvas}, buffered_{buffered} {}
 
-    void fill_rect(geom::Rect const &rect, Color color) { canvas_.fill_rect(rect, color); }
+    void fill_rect(geom::Rect const &rect, Color color) { target().fill_rect(rect, color); }
 
     void draw_rect(geom::Rect const &rect, Color const &color, Borders const &borders) {
-        canvas_.draw_rect(rect, color, borders);
+        target().draw_rect(rect, color, borders);
     }
 
     void draw_text(geom::Position p,
@@ -26,15 +34,128 @@ public:
             FontSize size,
             FontStyle style,
             Color color) {
-        canvas_.draw_text(p, text, font_options, size, style, color);
+        target().draw_text(p, text, font_options, size, style, color);
     }
 
     void draw_text(geom::Position p, std::string_view text, Font font, FontSize size, FontStyle style, Color color) {
-        canvas_.draw_text(p, text, font, size, style, color);
+        target().draw_text(p, text, font, size, style, color);
+    }
+
+    // Replays everything buffered since the last submit onto the canvas,
+    // grouped so commands sharing pipeline state (rects together, text runs
+    // per font) are drawn back-to-back. A command only jumps ahead of others
+    // when their bounds don't overlap, so the result looks identical to
+    // submitting in paint order. No-op for unbuffered painters.
+    void submit_buffered_frame() {
+        struct Batch {
+            std::pair<int, std::string> state;
+            std::vector<CanvasCommand> cmds;
+            geom::Rect bounds;
+        };
+
+        std::vector<Batch> batches;
+        for (auto &cmd : saver_.take_commands()) {
+            auto state = pipeline_state(cmd);
+            auto bounds = estimated_bounds(cmd);
+
+            Batch *batch = nullptr;
+            for (auto it = batches.rbegin(); it != batches.rend(); ++it) {
+                if (it->state == state) {
+                    batch = &*it;
+                    break;
+                }
+
+                // Batch bounds are unions, so this can flag overlaps that
+                // aren't real. That only costs us a merge opportunity.
+                if (overlaps(bounds, it->bounds)) {
+                    break;
+                }
+            }
+
+            if (batch != nullptr) {
+                batch->cmds.push_back(std::move(cmd));
+                batch->bounds = united(batch->bounds, bounds);
+            } else {
+                batches.push_back({std::move(state), {std::move(cmd)}, bounds});
+            }
+        }
+
+        for (auto const &batch : batches) {
+            replay_commands(canvas_, batch.cmds);
+        }
     }
 
 private:
+    [[nodiscard]] ICanvas &target() {
+        if (buffered_) {
+            return saver_;
+        }
+
+        return canvas_;
+    }
+
+    [[nodiscard]] static std::pair<int, std::string> pipeline_state(CanvasCommand const &cmd) {
+        if (std::holds_alternative<FillRectCmd>(cmd)) {
+            return {0, {}};
+        }
+
+        if (std::holds_alternative<DrawRectCmd>(cmd)) {
+            return {1, {}};
+        }
+
+        if (auto const *text = std::get_if<DrawTextCmd>(&cmd)) {
+            return {2, text->font};
+        }
+
+        if (auto const *text = std::get_if<DrawTextWithFontOptionsCmd>(&cmd)) {
+            return {2, text->font_options.empty() ? std::string{} : text->font_options.front()};
+        }
+
+        // State changes never batch with anything.
+        return {-1, {}};
+    }
+
+    [[nodiscard]] static geom::Rect estimated_bounds(CanvasCommand const &cmd) {
+        if (auto const *fill = std::get_if<FillRectCmd>(&cmd)) {
+            return fill->rect;
+        }
+
+        if (auto const *rect = std::get_if<DrawRectCmd>(&cmd)) {
+            return rect->rect.expanded({rect->borders.left.size,
+                    rect->borders.right.size,
+                    rect->borders.top.size,
+                    rect->borders.bottom.size});
+        }
+
+        // We can't measure text here, so guess generously: no glyph is wider
+        // than the font size, and leave a line of slack for descenders.
+        if (auto const *text = std::get_if<DrawTextCmd>(&cmd)) {
+            return {text->position.x, text->position.y, static_cast<int>(text->text.size()) * text->size, text->size * 2};
+        }
+
+        if (auto const *text = std::get_if<DrawTextWithFontOptionsCmd>(&cmd)) {
+            return {text->position.x, text->position.y, static_cast<int>(text->text.size()) * text->size, text->size * 2};
+        }
+
+        // State changes affect everything drawn after them.
+        constexpr int kHuge{1 << 30};
+        return {-kHuge / 2, -kHuge / 2, kHuge, kHuge};
+    }
+
+    // Unlike Rect::intersected, rects that merely share an edge don't overlap.
+    [[nodiscard]] static bool overlaps(geom::Rect const &a, geom::Rect const &b) {
+        return a.left() < b.right() && b.left() < a.right() && a.top() < b.bottom() && b.top() < a.bottom();
+    }
+
+    [[nodiscard]] static geom::Rect united(geom::Rect const &a, geom::Rect const &b) {
+        auto left = std::min(a.left(), b.left());
+        auto top = std::min(a.top(), b.top());
+        return {left, top, std::max(a.right(), b.right()) - left, std::max(a.bottom(), b.bottom()) - top};
+    }
+
     ICanvas &canvas_;
+    CanvasCommandSaver saver_{};
+    bool buffered_{false};
 };
 
 } // namespace gfx
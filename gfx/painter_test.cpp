@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/painter.h"
+
+#include "gfx/canvas_command_saver.h"
+
+#include "etest/etest.h"
+
+#include <string_view>
+#include <vector>
+
+using namespace gfx;
+using namespace std::literals;
+
+using etest::expect_eq;
+
+using CanvasCommands = std::vector<CanvasCommand>;
+
+int main() {
+    etest::test("unbuffered painting is immediate", [] {
+        CanvasCommandSaver canvas;
+        Painter painter{canvas};
+        painter.fill_rect({0, 0, 10, 10}, {0xab, 0xcd, 0xef});
+        expect_eq(canvas.take_commands(), CanvasCommands{FillRectCmd{{0, 0, 10, 10}, {0xab, 0xcd, 0xef}}});
+    });
+
+    etest::test("buffered painting holds commands until submit", [] {
+        CanvasCommandSaver canvas;
+        Painter painter{canvas, true};
+        painter.fill_rect({0, 0, 10, 10}, {0xab, 0xcd, 0xef});
+        expect_eq(canvas.take_commands(), CanvasCommands{});
+
+        painter.submit_buffered_frame();
+        expect_eq(canvas.take_commands(), CanvasCommands{FillRectCmd{{0, 0, 10, 10}, {0xab, 0xcd, 0xef}}});
+    });
+
+    etest::test("non-overlapping rects batch past text", [] {
+        CanvasCommandSaver canvas;
+        Painter painter{canvas, true};
+        painter.fill_rect({0, 0, 10, 10}, {});
+        painter.draw_text({500, 500}, "hello"sv, Font{"arial"}, FontSize{10}, FontStyle::Normal, {});
+        painter.fill_rect({20, 0, 10, 10}, {});
+        painter.submit_buffered_frame();
+
+        expect_eq(canvas.take_commands(),
+                CanvasCommands{
+                        FillRectCmd{{0, 0, 10, 10}, {}},
+                        FillRectCmd{{20, 0, 10, 10}, {}},
+                        DrawTextCmd{{500, 500}, "hello"s, "arial"s, 10, FontStyle::Normal, {}},
+                });
+    });
+
+    etest::test("overlapping draws stay in paint order", [] {
+        CanvasCommandSaver canvas;
+        Painter painter{canvas, true};
+        painter.fill_rect({0, 0, 100, 100}, {});
+        painter.draw_text({10, 10}, "hello"sv, Font{"arial"}, FontSize{10}, FontStyle::Normal, {});
+        painter.fill_rect({10, 10, 20, 20}, {0xff, 0, 0});
+        painter.submit_buffered_frame();
+
+        expect_eq(canvas.take_commands(),
+                CanvasCommands{
+                        FillRectCmd{{0, 0, 100, 100}, {}},
+                        DrawTextCmd{{10, 10}, "hello"s, "arial"s, 10, FontStyle::Normal, {}},
+                        FillRectCmd{{10, 10, 20, 20}, {0xff, 0, 0}},
+                });
+    });
+
+    etest::test("text runs batch per font", [] {
+        CanvasCommandSaver canvas;
+        Painter painter{canvas, true};
+        painter.draw_text({0, 0}, "a"sv, Font{"arial"}, FontSize{10}, FontStyle::Normal, {});
+        painter.draw_text({0, 100}, "b"sv, Font{"comic sans"}, FontSize{10}, FontStyle::Normal, {});
+        painter.draw_text({0, 200}, "c"sv, Font{"arial"}, FontSize{10}, FontStyle::Normal, {});
+        painter.submit_buffered_frame();
+
+        expect_eq(canvas.take_commands(),
+                CanvasCommands{
+                        DrawTextCmd{{0, 0}, "a"s, "arial"s, 10, FontStyle::Normal, {}},
+                        DrawTextCmd{{0, 200}, "c"s, "arial"s, 10, FontStyle::Normal, {}},
+                        DrawTextCmd{{0, 100}, "b"s, "comic sans"s, 10, FontStyle::Normal, {}},
+                });
+    });
+
+    return etest::run_all_tests();
+}
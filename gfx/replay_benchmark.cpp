@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "gfx/canvas_command_saver.h"
+#include "gfx/color.h"
+#include "gfx/icanvas.h"
+#include "gfx/opengl_canvas.h"
+#include "gfx/sfml_canvas.h"
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// Paints a synthetic but representative page: a background, then blocks of
+// bordered boxes with a handful of text runs each, a few images, and the
+// translations a scroll would issue. Recording it through CanvasCommandSaver
+// gives every backend an identical workload to replay, which is what a
+// capture from a real page would give us once those can be saved to disk.
+void paint_page(gfx::ICanvas &canvas, int blocks) {
+    constexpr int kWidth = 1280;
+    canvas.set_viewport_size(kWidth, 1024);
+    canvas.fill_rect({0, 0, kWidth, blocks * 130 + 100}, gfx::Color{0xFF, 0xFF, 0xFF});
+
+    std::vector<std::uint8_t> image(std::size_t{64} * 64 * 4, 0x7F);
+
+    for (int i = 0; i < blocks; ++i) {
+        int y = 50 + i * 130;
+        canvas.fill_rect({40, y, kWidth - 80, 120}, gfx::Color{0xF5, 0xF5, 0xF5});
+        canvas.draw_rect({40, y, kWidth - 80, 120},
+                gfx::Color{0xF5, 0xF5, 0xF5},
+                {{gfx::Color{0xCC, 0xCC, 0xCC}, 1},
+                        {gfx::Color{0xCC, 0xCC, 0xCC}, 1},
+                        {gfx::Color{0xCC, 0xCC, 0xCC}, 1},
+                        {gfx::Color{0xCC, 0xCC, 0xCC}, 1}});
+
+        canvas.draw_text(
+                {60, y + 10}, "A heading with some text in it"sv, {"arial"}, {20}, gfx::FontStyle::Italic, {});
+        canvas.draw_text({60, y + 40},
+                "Paragraph text, long enough to look like real prose rather than lorem ipsum."sv,
+                {"arial"},
+                {16},
+                gfx::FontStyle::Normal,
+                {});
+        canvas.draw_text({60, y + 65}, "a link"sv, {"arial"}, {16}, gfx::FontStyle::Normal, gfx::Color{0, 0, 0xEE});
+
+        if (i % 8 == 0) {
+            // The same image id every time, like one logo repeating down a
+            // page, so backends caching uploaded textures get to show it.
+            canvas.draw_pixels({kWidth - 140, y + 20, 64, 64}, image, 64, 64, /*image_id=*/1);
+        }
+
+        if (i % 16 == 15) {
+            canvas.add_translation(0, -10);
+        }
+    }
+}
+
+std::vector<gfx::CanvasCommand> record_page(int blocks) {
+    gfx::CanvasCommandSaver saver;
+    paint_page(saver, blocks);
+    return saver.take_commands();
+}
+
+void benchmark(
+        std::string_view name, gfx::ICanvas &canvas, std::vector<gfx::CanvasCommand> const &commands, int frames) {
+    // The first frame pays for font loads and texture uploads; warm those up
+    // so the numbers measure steady-state replay like the frames during a
+    // scroll or an animation.
+    gfx::replay_commands(canvas, commands);
+    canvas.flush();
+
+    auto best = std::chrono::nanoseconds::max();
+    for (int i = 0; i < frames; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        gfx::replay_commands(canvas, commands);
+        canvas.flush();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    auto seconds = std::chrono::duration<double>(best).count();
+    fmt::print("{}: {} commands, {:.3f} ms/frame, {:.0f} commands/s\n",
+            name,
+            commands.size(),
+            seconds * 1000.,
+            static_cast<double>(commands.size()) / seconds);
+}
+
+} // namespace
+
+int main() {
+    // An offscreen texture stands in for the window: it's a render target for
+    // the sfml backend, and activating it makes a GL context current for the
+    // opengl one.
+    sf::RenderTexture target;
+    if (!target.create(1280, 1024)) {
+        fmt::print(stderr, "Unable to create an offscreen render target\n");
+        return 1;
+    }
+    static_cast<void>(target.setActive(true));
+
+    for (auto [workload, blocks, frames] : {std::tuple{"small"sv, 20, 200}, std::tuple{"large"sv, 500, 20}}) {
+        auto commands = record_page(blocks);
+
+        {
+            gfx::SfmlCanvas canvas{target};
+            benchmark(fmt::format("sfml, {}", workload), canvas, commands, frames);
+        }
+        {
+            gfx::OpenGLCanvas canvas{};
+            benchmark(fmt::format("opengl, {}", workload), canvas, commands, frames);
+        }
+    }
+}
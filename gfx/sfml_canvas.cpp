@@ -5,23 +5,22 @@
 
 #include "gfx/sfml_canvas.h"
 
-#include "os/os.h"
-#include "util/string.h"
+#include "gfx/font_index.h"
 
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/View.hpp>
 #include <spdlog/spdlog.h>
 
-#include <algorithm>
-#include <filesystem>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
-#include <system_error>
-
-using namespace std::literals;
 
 namespace gfx {
 namespace {
@@ -29,23 +28,17 @@ namespace {
 #include "gfx/basic_vertex_shader.h"
 #include "gfx/rect_fragment_shader.h"
 
-std::filesystem::recursive_directory_iterator get_font_dir_iterator(std::filesystem::path const &path) {
-    std::error_code errc;
-    if (auto it = std::filesystem::recursive_directory_iterator(path, errc); !errc) {
-        return it;
-    }
-
-    return {};
+// Built (or loaded from its on-disk cache) the first time text is drawn, so
+// font resolution doesn't walk the filesystem per font.
+FontIndex const &font_index() {
+    static FontIndex const index = FontIndex::load_or_build();
+    return index;
 }
 
 std::optional<std::string> find_path_to_fallback_font() {
-    for (auto const &path : os::font_paths()) {
-        for (auto const &entry : get_font_dir_iterator(path)) {
-            if (std::filesystem::is_regular_file(entry) && entry.path().filename().string().ends_with(".ttf")) {
-                spdlog::info("Using fallback {}", entry.path().string());
-                return std::make_optional(entry.path().string());
-            }
-        }
+    if (auto path = font_index().fallback()) {
+        spdlog::info("Using fallback {}", *path);
+        return path;
     }
 
     return std::nullopt;
@@ -53,17 +46,9 @@ std::optional<std::string> find_path_to_fallback_font() {
 
 // TODO(robinlinden): We should be looking at font names rather than filenames.
 std::optional<std::string> find_path_to_font(std::string_view font_filename) {
-    for (auto const &path : os::font_paths()) {
-        for (auto const &entry : get_font_dir_iterator(path)) {
-            auto name = entry.path().filename().string();
-            // TODO(robinlinden): std::ranges once Clang supports it. Last tested w/ 15.
-            if (std::search(begin(name), end(name), begin(font_filename), end(font_filename), [](char a, char b) {
-                    return util::lowercased(a) == util::lowercased(b);
-                }) != end(name)) {
-                spdlog::info("Found font {} for {}", entry.path().string(), font_filename);
-                return std::make_optional(entry.path().string());
-            }
-        }
+    if (auto path = font_index().find(font_filename)) {
+        spdlog::info("Found font {} for {}", *path, font_filename);
+        return path;
     }
 
     return std::nullopt;
@@ -107,13 +92,28 @@ void SfmlCanvas::fill_rect(geom::Rect const &rect, Color color) {
     auto translated{rect.translated(tx_, ty_)};
     auto scaled{translated.scaled(scale_)};
 
-    sf::RectangleShape drawable{{static_cast<float>(scaled.width), static_cast<float>(scaled.height)}};
-    drawable.setPosition(static_cast<float>(scaled.x), static_cast<float>(scaled.y));
-    drawable.setFillColor(sf::Color{color.r, color.g, color.b, color.a});
-    target_.draw(drawable);
+    sf::Color fill{color.r, color.g, color.b, color.a};
+    auto corner = [&](int x, int y) {
+        return sf::Vertex{{static_cast<float>(x), static_cast<float>(y)}, fill};
+    };
+    auto top_left = corner(scaled.left(), scaled.top());
+    auto top_right = corner(scaled.right(), scaled.top());
+    auto bottom_left = corner(scaled.left(), scaled.bottom());
+    auto bottom_right = corner(scaled.right(), scaled.bottom());
+
+    rects_.append(top_left);
+    rects_.append(top_right);
+    rects_.append(bottom_right);
+    rects_.append(top_left);
+    rects_.append(bottom_right);
+    rects_.append(bottom_left);
 }
 
 void SfmlCanvas::draw_rect(geom::Rect const &rect, Color const &color, Borders const &borders) {
+    // The border shader draws straight to the target, so everything buffered
+    // before this box has to land first.
+    flush_rects();
+
     auto translated{rect.translated(tx_, ty_)};
     auto inner_rect{translated.scaled(scale_)};
     auto outer_rect{
@@ -185,6 +185,7 @@ void SfmlCanvas::draw_text(geom::Position p,
 // TODO(robinlinden): Fonts are never evicted from the cache.
 void SfmlCanvas::draw_text(
         geom::Position p, std::string_view text, Font font, FontSize size, FontStyle style, Color color) {
+    flush_rects();
     p = p.translated(tx_, ty_).scaled(scale_);
 
     auto const *sf_font = [&]() -> sf::Font const * {
@@ -212,14 +213,68 @@ void SfmlCanvas::draw_text(
         return;
     }
 
-    sf::Text drawable;
-    drawable.setFont(*sf_font);
-    drawable.setString(sf::String::fromUtf8(cbegin(text), cend(text)));
+    auto character_size = static_cast<unsigned>(size.px * scale_);
+    TextRun run{std::string{text}, std::string{font.font}, character_size, style};
+    auto it = text_run_cache_.find(run);
+    if (it == text_run_cache_.end()) {
+        sf::Text drawable;
+        // The cached run holds a pointer into the font. Fine for now since
+        // fonts are never evicted.
+        drawable.setFont(*sf_font);
+        drawable.setString(sf::String::fromUtf8(cbegin(text), cend(text)));
+        drawable.setCharacterSize(character_size);
+        drawable.setStyle(to_sfml(style));
+        it = text_run_cache_.emplace(std::move(run), std::move(drawable)).first;
+    }
+
+    auto &drawable = it->second;
     drawable.setFillColor(sf::Color(color.as_rgba_u32()));
-    drawable.setCharacterSize(size.px * scale_);
-    drawable.setStyle(to_sfml(style));
     drawable.setPosition(static_cast<float>(p.x), static_cast<float>(p.y));
     target_.draw(drawable);
 }
 
+void SfmlCanvas::draw_pixels(
+        geom::Rect const &rect, std::span<std::uint8_t const> rgba_data, int width, int height, std::size_t image_id) {
+    if (width <= 0 || height <= 0
+            || rgba_data.size() < static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4) {
+        return;
+    }
+
+    // The sprite draws straight to the target, so everything buffered before
+    // this image has to land first.
+    flush_rects();
+
+    auto it = texture_cache_.find(image_id);
+    if (it == texture_cache_.end()) {
+        sf::Texture texture{};
+        if (!texture.create(static_cast<unsigned>(width), static_cast<unsigned>(height))) {
+            return;
+        }
+
+        texture.update(rgba_data.data());
+        texture.setSmooth(true);
+        it = texture_cache_.emplace(image_id, std::move(texture)).first;
+    }
+
+    auto scaled{rect.translated(tx_, ty_).scaled(scale_)};
+    sf::Sprite sprite{it->second};
+    sprite.setPosition(static_cast<float>(scaled.x), static_cast<float>(scaled.y));
+    sprite.setScale(static_cast<float>(scaled.width) / static_cast<float>(width),
+            static_cast<float>(scaled.height) / static_cast<float>(height));
+    target_.draw(sprite);
+}
+
+void SfmlCanvas::flush() {
+    flush_rects();
+}
+
+void SfmlCanvas::flush_rects() {
+    if (rects_.getVertexCount() == 0) {
+        return;
+    }
+
+    target_.draw(rects_);
+    rects_.clear();
+}
+
 } // namespace gfx
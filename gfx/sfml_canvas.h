@@ -8,9 +8,17 @@
 #include "gfx/icanvas.h"
 
 #include <SFML/Graphics/Shader.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 
+#include <compare>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <span>
+#include <string>
 
 namespace sf {
 class Font;
@@ -35,11 +43,41 @@ public:
     void draw_rect(geom::Rect const &, Color const &, Borders const &) override;
     void draw_text(geom::Position, std::string_view, std::vector<Font> const &, FontSize, FontStyle, Color) override;
     void draw_text(geom::Position, std::string_view, Font, FontSize, FontStyle, Color) override;
+    void draw_pixels(geom::Rect const &, std::span<std::uint8_t const>, int width, int height, std::size_t) override;
+
+    // Draws any rects still buffered for the current frame.
+    void flush() override;
 
 private:
+    // Submits the buffered rects in one draw call. Anything drawn through a
+    // different path (the border shader, text) breaks the batch first so the
+    // paint order stays intact.
+    void flush_rects();
+    // Shaping a string into glyph quads is what makes text expensive, so runs
+    // that repeat between frames reuse the same prebuilt sf::Text. Position
+    // and colour are per-draw properties that don't invalidate the geometry.
+    struct TextRun {
+        std::string text{};
+        std::string font{};
+        unsigned character_size{};
+        FontStyle style{};
+        [[nodiscard]] auto operator<=>(TextRun const &) const = default;
+    };
+
     sf::RenderTarget &target_;
     sf::Shader border_shader_{};
+    // Two triangles per fill_rect, accumulated so a run of boxes becomes one
+    // draw call instead of one sf::RectangleShape draw per rect.
+    sf::VertexArray rects_{sf::Triangles};
     std::map<std::string, std::shared_ptr<sf::Font>, std::less<>> font_cache_;
+    // The glyph atlas textures live in the cached sf::Fonts, so keeping the
+    // runs alive also keeps their glyphs resident on the atlas.
+    // TODO(robinlinden): Text runs are never evicted from the cache.
+    std::map<TextRun, sf::Text> text_run_cache_;
+    // One texture per image id, uploaded the first time the id is drawn and
+    // reused for every repaint after that.
+    // TODO(robinlinden): Textures are never evicted from the cache.
+    std::map<std::size_t, sf::Texture> texture_cache_;
 
     int scale_{1};
     int tx_{0};
@@ -6,10 +6,17 @@
 
 #include "html/parser.h"
 
+#include "util/trace.h"
+
+#include <utility>
+
 namespace html {
 
-dom::Document parse(std::string_view input) {
-    return Parser::parse_document(input);
+dom::Document parse(std::string_view input,
+        std::function<void(dom::Element const &)> on_element_opened,
+        html2::TokenizerScratch *scratch) {
+    util::trace::Span span{"html::parse"};
+    return Parser::parse_document(input, std::move(on_element_opened), scratch);
 }
 
 } // namespace html
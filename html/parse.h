@@ -6,12 +6,19 @@
 #define HTML_PARSE_H_
 
 #include "dom/dom.h"
+#include "html2/tokenizer.h"
 
+#include <functional>
 #include <string_view>
 
 namespace html {
 
-dom::Document parse(std::string_view input);
+// on_element_opened, if set, is called for every element as soon as its start
+// tag has been parsed. scratch, if set, lets the tokenizer reuse buffers from
+// an earlier parse. See html::Parser.
+dom::Document parse(std::string_view input,
+        std::function<void(dom::Element const &)> on_element_opened = nullptr,
+        html2::TokenizerScratch *scratch = nullptr);
 
 } // namespace html
 
@@ -4,12 +4,13 @@
 
 #include "html/parser.h"
 
+#include "dom/tag_id.h"
+
 #include "util/string.h"
 
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
-#include <array>
 #include <cassert>
 #include <string>
 #include <string_view>
@@ -20,78 +21,90 @@ using namespace std::literals;
 namespace html {
 namespace {
 
-template<auto const &array>
-constexpr bool is_in_array(std::string_view str) {
-    return std::ranges::find(array, str) != std::cend(array);
-}
-
-dom::AttrMap into_dom_attributes(std::vector<html2::Attribute> const &attributes) {
+dom::AttrMap into_dom_attributes(std::vector<html2::Attribute> attributes) {
     dom::AttrMap attrs{};
-    for (auto const &[name, value] : attributes) {
-        attrs[name] = value;
+    for (auto &[name, value] : attributes) {
+        attrs.insert_or_assign(std::move(name), std::move(value));
     }
 
     return attrs;
 }
 
 // https://developer.mozilla.org/en-US/docs/Glossary/Void_element
-constexpr auto kImmediatelyPopped = std::to_array({"area"sv,
-        "base"sv,
-        "br"sv,
-        "col"sv,
-        "embed"sv,
-        "hr"sv,
-        "img"sv,
-        "input"sv,
-        "link"sv,
-        "meta"sv,
-        "param"sv,
-        "source"sv,
-        "track"sv,
-        "wbr"sv});
-
-constexpr std::array kAllowsParagraphEndTagOmission{
-        "address"sv,
-        "article"sv,
-        "aside"sv,
-        "blockquote"sv,
-        "details"sv,
-        "div"sv,
-        "dl"sv,
-        "fieldset"sv,
-        "figcaption"sv,
-        "figure"sv,
-        "footer"sv,
-        "form"sv,
-        "h1"sv,
-        "h2"sv,
-        "h3"sv,
-        "h4"sv,
-        "h5"sv,
-        "h6"sv,
-        "header"sv,
-        "hgroup"sv,
-        "hr"sv,
-        "main"sv,
-        "menu"sv,
-        "nav"sv,
-        "ol"sv,
-        "p"sv,
-        "pre"sv,
-        "section"sv,
-        "table"sv,
-        "ul"sv,
-};
-
-constexpr std::array kDisallowsParagraphEndTagOmissionWhenClosed{
-        "a"sv,
-        "audio"sv,
-        "del"sv,
-        "ins"sv,
-        "map"sv,
-        "noscript"sv,
-        "video"sv,
-};
+constexpr bool is_immediately_popped(dom::TagId tag) {
+    switch (tag) {
+        case dom::TagId::Area:
+        case dom::TagId::Base:
+        case dom::TagId::Br:
+        case dom::TagId::Col:
+        case dom::TagId::Embed:
+        case dom::TagId::Hr:
+        case dom::TagId::Img:
+        case dom::TagId::Input:
+        case dom::TagId::Link:
+        case dom::TagId::Meta:
+        case dom::TagId::Param:
+        case dom::TagId::Source:
+        case dom::TagId::Track:
+        case dom::TagId::Wbr:
+            return true;
+        default:
+            return false;
+    }
+}
+
+constexpr bool allows_paragraph_end_tag_omission(dom::TagId tag) {
+    switch (tag) {
+        case dom::TagId::Address:
+        case dom::TagId::Article:
+        case dom::TagId::Aside:
+        case dom::TagId::Blockquote:
+        case dom::TagId::Details:
+        case dom::TagId::Div:
+        case dom::TagId::Dl:
+        case dom::TagId::Fieldset:
+        case dom::TagId::Figcaption:
+        case dom::TagId::Figure:
+        case dom::TagId::Footer:
+        case dom::TagId::Form:
+        case dom::TagId::H1:
+        case dom::TagId::H2:
+        case dom::TagId::H3:
+        case dom::TagId::H4:
+        case dom::TagId::H5:
+        case dom::TagId::H6:
+        case dom::TagId::Header:
+        case dom::TagId::Hgroup:
+        case dom::TagId::Hr:
+        case dom::TagId::Main:
+        case dom::TagId::Menu:
+        case dom::TagId::Nav:
+        case dom::TagId::Ol:
+        case dom::TagId::P:
+        case dom::TagId::Pre:
+        case dom::TagId::Section:
+        case dom::TagId::Table:
+        case dom::TagId::Ul:
+            return true;
+        default:
+            return false;
+    }
+}
+
+constexpr bool disallows_paragraph_end_tag_omission_when_closed(dom::TagId tag) {
+    switch (tag) {
+        case dom::TagId::A:
+        case dom::TagId::Audio:
+        case dom::TagId::Del:
+        case dom::TagId::Ins:
+        case dom::TagId::Map:
+        case dom::TagId::Noscript:
+        case dom::TagId::Video:
+            return true;
+        default:
+            return false;
+    }
+}
 
 } // namespace
 
@@ -105,16 +118,17 @@ void Parser::operator()(html2::DoctypeToken const &doctype) {
     }
 }
 
-void Parser::operator()(html2::StartTagToken const &start_tag) {
-    if (start_tag.tag_name == "html"sv) {
+void Parser::operator()(html2::StartTagToken &start_tag) {
+    if (start_tag.tag_id == dom::TagId::Html) {
         doc_.html().name = start_tag.tag_name;
-        doc_.html().attributes = into_dom_attributes(start_tag.attributes);
+        doc_.html().attributes = into_dom_attributes(std::move(start_tag.attributes));
         open_elements_.push(&doc_.html());
         seen_html_tag_ = true;
+        doc_.node_count += 1;
         return;
     }
 
-    if (start_tag.tag_name == "script"sv) {
+    if (start_tag.tag_id == dom::TagId::Script) {
         tokenizer_.set_state(html2::State::ScriptData);
     }
 
@@ -123,6 +137,7 @@ void Parser::operator()(html2::StartTagToken const &start_tag) {
         doc_.html().name = "html"s;
         open_elements_.push(&doc_.html());
         seen_html_tag_ = true;
+        doc_.node_count += 1;
     } else if (open_elements_.empty()) {
         spdlog::warn("Start tag [{}] encountered with no open elements", start_tag.tag_name);
         return;
@@ -130,13 +145,20 @@ void Parser::operator()(html2::StartTagToken const &start_tag) {
 
     generate_text_node_if_needed();
 
+    auto tag = start_tag.tag_id;
+
     // https://html.spec.whatwg.org/multipage/grouping-content.html#the-p-element
-    if (open_elements_.top()->name == "p" && is_in_array<kAllowsParagraphEndTagOmission>(start_tag.tag_name)) {
+    if (open_elements_.top()->name == "p" && allows_paragraph_end_tag_omission(tag)) {
         open_elements_.pop();
     }
 
     auto &new_element = open_elements_.top()->children.emplace_back(
-            dom::Element{start_tag.tag_name, into_dom_attributes(start_tag.attributes), {}});
+            dom::Element{start_tag.tag_name, into_dom_attributes(std::move(start_tag.attributes)), {}});
+    doc_.node_count += 1;
+
+    if (on_element_opened_) {
+        on_element_opened_(std::get<dom::Element>(new_element));
+    }
 
     if (!start_tag.self_closing) {
         // This may seem risky since vectors will move their storage about
@@ -148,7 +170,7 @@ void Parser::operator()(html2::StartTagToken const &start_tag) {
 
     // Special cases from https://html.spec.whatwg.org/multipage/parsing.html#parsing-main-inbody
     // Immediately popped off the stack of open elements special cases.
-    if (!start_tag.self_closing && is_in_array<kImmediatelyPopped>(start_tag.tag_name)) {
+    if (!start_tag.self_closing && is_immediately_popped(tag)) {
         open_elements_.pop();
     }
 }
@@ -163,8 +185,8 @@ void Parser::operator()(html2::EndTagToken const &end_tag) {
 
     // https://html.spec.whatwg.org/multipage/grouping-content.html#the-p-element
     // TODO(robinlinden): or if the parent element is an autonomous custom element.
-    if (open_elements_.top()->name == "p" && end_tag.tag_name != "p"
-            && !is_in_array<kDisallowsParagraphEndTagOmissionWhenClosed>(end_tag.tag_name)) {
+    if (open_elements_.top()->name == "p" && end_tag.tag_id != dom::TagId::P
+            && !disallows_paragraph_end_tag_omission_when_closed(end_tag.tag_id)) {
         open_elements_.pop();
     }
 
@@ -182,7 +204,11 @@ void Parser::operator()(html2::CommentToken const &) {
 }
 
 void Parser::operator()(html2::CharacterToken const &character) {
-    current_text_ << character.data;
+    current_text_ += character.data;
+}
+
+void Parser::operator()(html2::TextSpanToken const &span) {
+    current_text_ += span.data;
 }
 
 void Parser::operator()(html2::EndOfFileToken const &) {
@@ -193,13 +219,14 @@ void Parser::operator()(html2::EndOfFileToken const &) {
 
 void Parser::generate_text_node_if_needed() {
     assert(!open_elements_.empty());
-    auto text = std::exchange(current_text_, {}).str();
-    bool is_uninteresting = std::ranges::all_of(text, [](char c) { return util::is_whitespace(c); });
+    bool is_uninteresting = std::ranges::all_of(current_text_, [](char c) { return util::is_whitespace(c); });
     if (is_uninteresting) {
+        current_text_.clear();
         return;
     }
 
-    open_elements_.top()->children.emplace_back(dom::Text{std::move(text)});
+    open_elements_.top()->children.emplace_back(dom::Text{std::exchange(current_text_, {})});
+    doc_.node_count += 1;
 }
 
 } // namespace html
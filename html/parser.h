@@ -6,8 +6,8 @@
 #include "html2/tokenizer.h"
 
 #include <functional>
-#include <sstream>
 #include <stack>
+#include <string>
 #include <string_view>
 #include <utility>
 
@@ -15,21 +15,34 @@ namespace html {
 
 class Parser {
 public:
-    [[nodiscard]] static dom::Document parse_document(std::string_view input) {
-        Parser parser{input};
+    // on_element_opened, if set, is called for every element as soon as its
+    // start tag has been parsed, i.e. while the rest of the document is still
+    // being worked on. The element has its attributes but no children yet.
+    //
+    // scratch, if set, is where the tokenizer's internal buffers are borrowed
+    // from and returned to. See html2::TokenizerScratch.
+    [[nodiscard]] static dom::Document parse_document(std::string_view input,
+            std::function<void(dom::Element const &)> on_element_opened = nullptr,
+            html2::TokenizerScratch *scratch = nullptr) {
+        Parser parser{input, std::move(on_element_opened), scratch};
         return parser.run();
     }
 
     // These must be public for std::visit to be happy with Parser as a visitor.
     void operator()(html2::DoctypeToken const &);
-    void operator()(html2::StartTagToken const &);
+    void operator()(html2::StartTagToken &);
     void operator()(html2::EndTagToken const &);
     void operator()(html2::CommentToken const &);
     void operator()(html2::CharacterToken const &);
+    void operator()(html2::TextSpanToken const &);
     void operator()(html2::EndOfFileToken const &);
 
 private:
-    explicit Parser(std::string_view input) : tokenizer_{input, std::bind_front(&Parser::on_token, this)} {}
+    Parser(std::string_view input,
+            std::function<void(dom::Element const &)> on_element_opened,
+            html2::TokenizerScratch *scratch)
+        : tokenizer_{input, std::bind_front(&Parser::on_token, this), [](auto &, auto) {}, scratch},
+          on_element_opened_{std::move(on_element_opened)} {}
 
     [[nodiscard]] dom::Document run() {
         tokenizer_.run();
@@ -41,9 +54,10 @@ private:
     void generate_text_node_if_needed();
 
     html2::Tokenizer tokenizer_;
+    std::function<void(dom::Element const &)> on_element_opened_{};
     dom::Document doc_{};
     std::stack<dom::Element *> open_elements_{};
-    std::stringstream current_text_{};
+    std::string current_text_{};
     bool seen_html_tag_{false};
 };
 
@@ -7,6 +7,9 @@
 #include "etest/etest.h"
 
 #include <cstddef>
+#include <string>
+#include <tuple>
+#include <vector>
 
 using namespace std::literals;
 using etest::expect;
@@ -27,6 +30,12 @@ int main() {
         expect(document.doctype == "html"s);
     });
 
+    etest::test("node count is kept while parsing", [] {
+        auto document = html::parse("<html><body><p>hello</p><p></p></body></html>"sv);
+        // html, body, two ps, and one text node.
+        expect_eq(document.node_count, std::size_t{5});
+    });
+
     etest::test("everything is wrapped in a html element", [] {
         auto document = html::parse("<p></p>"sv);
         auto html = document.html();
@@ -205,5 +214,17 @@ int main() {
         expect_eq(p2_text, dom::Text{"world"});
     });
 
+    etest::test("elements are announced as their start tags are parsed", [] {
+        std::vector<std::string> opened{};
+        std::ignore = html::parse("<html><head><link rel=stylesheet href=lol.css></head><body><p>hi</p></body></html>"sv,
+                [&](dom::Element const &element) { opened.push_back(element.name); });
+
+        require_eq(opened.size(), std::size_t{4});
+        expect_eq(opened[0], "head");
+        expect_eq(opened[1], "link");
+        expect_eq(opened[2], "body");
+        expect_eq(opened[3], "p");
+    });
+
     return etest::run_all_tests();
 }
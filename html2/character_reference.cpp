@@ -5,6 +5,8 @@
 #include "html2/character_reference.h"
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string_view>
 
 using namespace std::literals;
@@ -2261,12 +2263,39 @@ static constexpr std::array references = std::to_array<CharacterReference>({{"&A
         {"&zwj;"sv, 8205},
         {"&zwnj;"sv, 8204}});
 
+// The references are sorted, so all names sharing their first character after
+// the '&' form one contiguous run in the table. Index those runs by that
+// character so lookups only scan the handful of names that could match
+// instead of the whole table.
+struct ReferenceRange {
+    std::uint16_t begin{};
+    std::uint16_t end{};
+};
+
+constexpr auto reference_ranges = [] {
+    std::array<ReferenceRange, 128> ranges{};
+    for (std::size_t i = 0; i < references.size(); ++i) {
+        auto &range = ranges[references[i].name[1]];
+        if (range.begin == range.end) {
+            range.begin = static_cast<std::uint16_t>(i);
+        }
+        range.end = static_cast<std::uint16_t>(i + 1);
+    }
+    return ranges;
+}();
+
 } // namespace
 
 std::optional<CharacterReference> find_named_character_reference_for(std::string_view buffer) {
+    if (buffer.size() < 2 || buffer[0] != '&' || static_cast<unsigned char>(buffer[1]) >= reference_ranges.size()) {
+        return std::nullopt;
+    }
+
+    auto const [begin, end] = reference_ranges[buffer[1]];
     std::optional<CharacterReference> maybe_reference{std::nullopt};
 
-    for (auto const &reference : references) {
+    for (std::size_t i = begin; i < end; ++i) {
+        auto const &reference = references[i];
         if (buffer.starts_with(reference.name)
                 && (!maybe_reference || reference.name.size() > maybe_reference->name.size())) {
             maybe_reference = reference;
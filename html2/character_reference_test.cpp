@@ -41,6 +41,13 @@ int main() {
         expect(ref->name == "&lt;"sv); // And not &lt which also matches.
     });
 
+    etest::test("buffers that can't contain a reference", [] {
+        expect(!find_named_character_reference_for(""sv).has_value());
+        expect(!find_named_character_reference_for("&"sv).has_value());
+        expect(!find_named_character_reference_for("&\xff"sv).has_value());
+        expect(!find_named_character_reference_for("&&"sv).has_value());
+    });
+
     etest::test("extra characters are ignored", [] {
         auto ref = find_named_character_reference_for("&lt;&lt;&abc;123"sv);
         require(ref.has_value());
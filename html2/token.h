@@ -5,8 +5,11 @@
 #ifndef HTML2_TOKEN_H_
 #define HTML2_TOKEN_H_
 
+#include "dom/tag_id.h"
+
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -30,14 +33,26 @@ struct StartTagToken {
     std::string tag_name{};
     bool self_closing{false};
     std::vector<Attribute> attributes{};
-    [[nodiscard]] bool operator==(StartTagToken const &) const = default;
+
+    // The interned form of tag_name, filled in by the tokenizer at emission
+    // so consumers can dispatch on an integer instead of comparing strings.
+    dom::TagId tag_id{dom::TagId::Unknown};
+
+    // tag_id is derived from tag_name, so it doesn't participate in equality.
+    [[nodiscard]] bool operator==(StartTagToken const &other) const {
+        return tag_name == other.tag_name && self_closing == other.self_closing && attributes == other.attributes;
+    }
 };
 
 struct EndTagToken {
     std::string tag_name{};
     bool self_closing{false};
     std::vector<Attribute> attributes{};
-    [[nodiscard]] bool operator==(EndTagToken const &) const = default;
+    dom::TagId tag_id{dom::TagId::Unknown};
+
+    [[nodiscard]] bool operator==(EndTagToken const &other) const {
+        return tag_name == other.tag_name && self_closing == other.self_closing && attributes == other.attributes;
+    }
 };
 
 struct CommentToken {
@@ -50,11 +65,21 @@ struct CharacterToken {
     [[nodiscard]] bool operator==(CharacterToken const &) const = default;
 };
 
+// A contiguous run of character data, emitted instead of one CharacterToken
+// per byte when the tokenizer can scan ahead. The view points into the
+// tokenizer's input and is only guaranteed to stay valid until more input is
+// fed to the tokenizer.
+struct TextSpanToken {
+    std::string_view data{};
+    [[nodiscard]] bool operator==(TextSpanToken const &) const = default;
+};
+
 struct EndOfFileToken {
     [[nodiscard]] bool operator==(EndOfFileToken const &) const = default;
 };
 
-using Token = std::variant<DoctypeToken, StartTagToken, EndTagToken, CommentToken, CharacterToken, EndOfFileToken>;
+using Token =
+        std::variant<DoctypeToken, StartTagToken, EndTagToken, CommentToken, CharacterToken, TextSpanToken, EndOfFileToken>;
 
 std::string to_string(Token const &);
 
@@ -4,16 +4,25 @@
 
 #include "html2/tokenizer.h"
 
+#include "dom/tag_id.h"
 #include "html2/character_reference.h"
 #include "util/string.h"
+#include "util/trace.h"
 #include "util/unicode.h"
 
+#include <array>
+#include <bit>
 #include <cstdint>
 #include <cstring>
 #include <exception>
 #include <limits>
 #include <map>
 #include <sstream>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace std::literals;
 
@@ -95,12 +104,152 @@ constexpr bool is_unicode_noncharacter(int code_point) {
 
 std::string const kReplacementCharacter = util::unicode_to_utf8(0xFFFD);
 
+// Finds the next character that requires the data and script data states to
+// run the full state machine: tag opens, character references, and null
+// characters. Everything in between is plain text that can be emitted without
+// per-character dispatch.
+std::size_t find_next_special_character(std::string_view input, std::size_t pos) {
+#ifdef __SSE2__
+    __m128i const less_than = _mm_set1_epi8('<');
+    __m128i const ampersand = _mm_set1_epi8('&');
+    __m128i const nul = _mm_setzero_si128();
+    for (; pos + 16 <= input.size(); pos += 16) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<__m128i const *>(input.data() + pos));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, less_than), _mm_cmpeq_epi8(chunk, ampersand)),
+                _mm_cmpeq_epi8(chunk, nul));
+        if (int mask = _mm_movemask_epi8(special); mask != 0) {
+            return pos + std::countr_zero(static_cast<unsigned>(mask));
+        }
+    }
+#endif
+
+    while (pos < input.size()) {
+        char c = input[pos];
+        if (c == '<' || c == '&' || c == '\0') {
+            break;
+        }
+        ++pos;
+    }
+
+    return pos;
+}
+
+// Like find_next_special_character, but for script data where '&' has no
+// special meaning and a '<' only matters if it starts "</" or "<!". Script
+// bodies are full of lone '<'s (comparisons, arrows) that would otherwise
+// bounce the state machine through the less-than-sign states.
+std::size_t find_end_of_script_text(std::string_view input, std::size_t pos) {
+    while (pos < input.size()) {
+        pos = find_next_special_character(input, pos);
+        if (pos >= input.size() || input[pos] == '\0') {
+            break;
+        }
+
+        if (input[pos] == '&') {
+            ++pos;
+            continue;
+        }
+
+        // A '<' last in the buffer has to stay unconsumed until we can tell
+        // what follows it.
+        if (pos + 1 >= input.size()) {
+            break;
+        }
+
+        if (char next = input[pos + 1]; next == '/' || next == '!') {
+            break;
+        }
+
+        ++pos;
+    }
+    return pos;
+}
+
+// Character classes the hot tag states care about, one bit per class, so
+// "can this character continue the current run?" is a table load and a mask
+// test instead of a cascade of comparisons.
+enum CharClass : std::uint8_t {
+    // Ends a tag or attribute name: whitespace, '/', '>', '=', or '\0'.
+    kEndsName = 1 << 0,
+    // Needs lowercasing before being appended to a name.
+    kUpperAlpha = 1 << 1,
+    // Ends a double-quoted attribute value: '"', '&', or '\0'.
+    kEndsDoubleQuoted = 1 << 2,
+    // Ends a single-quoted attribute value: '\'', '&', or '\0'.
+    kEndsSingleQuoted = 1 << 3,
+    // Ends an unquoted attribute value or is a parse error in one:
+    // whitespace, '&', '>', '\0', '"', '\'', '<', '=', or '`'.
+    kEndsUnquoted = 1 << 4,
+};
+
+// Generated from the spec definitions of the tag-name, attribute-name, and
+// attribute-value states.
+// https://html.spec.whatwg.org/multipage/parsing.html#tag-name-state
+constexpr std::array<std::uint8_t, 256> kCharClasses = [] {
+    std::array<std::uint8_t, 256> classes{};
+    auto mark = [&](char c, std::uint8_t bit) { classes[static_cast<unsigned char>(c)] |= bit; };
+    for (char c : {'\t', '\n', '\f', ' '}) {
+        mark(c, kEndsName | kEndsUnquoted);
+    }
+    for (char c : {'/', '>', '='}) {
+        mark(c, kEndsName);
+    }
+    mark('\0', kEndsName | kEndsDoubleQuoted | kEndsSingleQuoted | kEndsUnquoted);
+    for (char c = 'A'; c <= 'Z'; ++c) {
+        mark(c, kUpperAlpha);
+    }
+    mark('"', kEndsDoubleQuoted | kEndsUnquoted);
+    mark('\'', kEndsSingleQuoted | kEndsUnquoted);
+    mark('&', kEndsDoubleQuoted | kEndsSingleQuoted | kEndsUnquoted);
+    for (char c : {'>', '<', '=', '`'}) {
+        mark(c, kEndsUnquoted);
+    }
+    return classes;
+}();
+
+// Length of the run of characters starting at pos whose classes don't
+// intersect mask, i.e. characters the current state appends verbatim.
+std::size_t verbatim_run(std::string_view input, std::size_t pos, std::uint8_t mask) {
+    auto start = pos;
+    for (; pos < input.size(); ++pos) {
+        if ((kCharClasses[static_cast<unsigned char>(input[pos])] & mask) != 0) {
+            break;
+        }
+    }
+    return pos - start;
+}
+
+// The run of characters that are appended verbatim to a tag or attribute
+// name: anything until a character that can end the name or needs
+// lowercasing.
+std::size_t verbatim_name_run(std::string_view input, std::size_t pos) {
+    return verbatim_run(input, pos, kEndsName | kUpperAlpha);
+}
+
+// Same, but for quoted attribute values: anything until the closing quote, a
+// character reference, or a null character.
+std::size_t verbatim_attribute_value_run(std::string_view input, std::size_t pos, char quote) {
+    return verbatim_run(input, pos, quote == '"' ? kEndsDoubleQuoted : kEndsSingleQuoted);
+}
+
 } // namespace
 
 void Tokenizer::set_state(State state) {
     state_ = state;
 }
 
+void Tokenizer::feed(std::string_view chunk) {
+    stream_buffer_ += chunk;
+    input_ = stream_buffer_;
+    run();
+}
+
+void Tokenizer::finish() {
+    input_complete_ = true;
+    run();
+}
+
 // While long, this function only contains trivial and short cases for each of
 // the parser states.
 //
@@ -110,9 +259,22 @@ void Tokenizer::set_state(State state) {
 // telling us if we should continue or return.
 // NOLINTNEXTLINE(google-readability-function-size)
 void Tokenizer::run() {
+    util::trace::Span span{"html2::Tokenizer::run"};
     while (true) {
+        if (!input_complete_ && needs_more_input()) {
+            return;
+        }
+
         switch (state_) {
             case State::Data: {
+                // Fast path: emit plain text up until the next '<', '&', or
+                // '\0' as one span instead of one token per byte.
+                if (auto text_end = find_next_special_character(input_, pos_); text_end != pos_) {
+                    emit(TextSpanToken{input_.substr(pos_, text_end - pos_)});
+                    pos_ = text_end;
+                    continue;
+                }
+
                 auto c = consume_next_input_character();
                 if (!c) {
                     emit(EndOfFileToken{});
@@ -141,6 +303,12 @@ void Tokenizer::run() {
             }
 
             case State::ScriptData: {
+                if (auto text_end = find_end_of_script_text(input_, pos_); text_end != pos_) {
+                    emit(TextSpanToken{input_.substr(pos_, text_end - pos_)});
+                    pos_ = text_end;
+                    continue;
+                }
+
                 auto c = consume_next_input_character();
                 if (!c) {
                     emit(EndOfFileToken{});
@@ -215,13 +383,6 @@ void Tokenizer::run() {
             }
 
             case State::TagName: {
-                auto c = consume_next_input_character();
-                if (!c) {
-                    // This is an eof-in-tag parse error.
-                    emit(EndOfFileToken{});
-                    return;
-                }
-
                 auto append_to_tag_name = [&](auto text) {
                     if (std::holds_alternative<StartTagToken>(current_token_)) {
                         std::get<StartTagToken>(current_token_).tag_name += text;
@@ -230,6 +391,21 @@ void Tokenizer::run() {
                     }
                 };
 
+                // Fast path: bulk-append the run of characters that can't end
+                // the name and don't need transformation.
+                if (auto run = verbatim_name_run(input_, pos_); run != 0) {
+                    append_to_tag_name(input_.substr(pos_, run));
+                    pos_ += run;
+                    continue;
+                }
+
+                auto c = consume_next_input_character();
+                if (!c) {
+                    // This is an eof-in-tag parse error.
+                    emit(EndOfFileToken{});
+                    return;
+                }
+
                 if (util::is_upper_alpha(*c)) {
                     append_to_tag_name(util::lowercased(*c));
                     continue;
@@ -776,12 +952,6 @@ void Tokenizer::run() {
             }
 
             case State::AttributeName: {
-                auto c = consume_next_input_character();
-                if (!c || *c == '\t' || *c == '\n' || *c == '\f' || *c == ' ' || *c == '/' || *c == '>') {
-                    reconsume_in(State::AfterAttributeName);
-                    continue;
-                }
-
                 auto append_to_current_attribute_name = [&](auto text) {
                     if (std::holds_alternative<StartTagToken>(current_token_)) {
                         std::get<StartTagToken>(current_token_).attributes.back().name += text;
@@ -790,6 +960,18 @@ void Tokenizer::run() {
                     }
                 };
 
+                if (auto run = verbatim_name_run(input_, pos_); run != 0) {
+                    append_to_current_attribute_name(input_.substr(pos_, run));
+                    pos_ += run;
+                    continue;
+                }
+
+                auto c = consume_next_input_character();
+                if (!c || *c == '\t' || *c == '\n' || *c == '\f' || *c == ' ' || *c == '/' || *c == '>') {
+                    reconsume_in(State::AfterAttributeName);
+                    continue;
+                }
+
                 if (util::is_upper_alpha(*c)) {
                     append_to_current_attribute_name(util::lowercased(*c));
                     continue;
@@ -875,6 +1057,12 @@ void Tokenizer::run() {
             }
 
             case State::AttributeValueDoubleQuoted: {
+                if (auto run = verbatim_attribute_value_run(input_, pos_, '"'); run != 0) {
+                    current_attribute().value += input_.substr(pos_, run);
+                    pos_ += run;
+                    continue;
+                }
+
                 auto c = consume_next_input_character();
                 if (!c) {
                     // This is an eof-in-tag parse error.
@@ -901,6 +1089,12 @@ void Tokenizer::run() {
             }
 
             case State::AttributeValueSingleQuoted: {
+                if (auto run = verbatim_attribute_value_run(input_, pos_, '\''); run != 0) {
+                    current_attribute().value += input_.substr(pos_, run);
+                    pos_ += run;
+                    continue;
+                }
+
                 auto c = consume_next_input_character();
                 if (!c) {
                     // This is an eof-in-tag parse error.
@@ -927,6 +1121,12 @@ void Tokenizer::run() {
             }
 
             case State::AttributeValueUnquoted: {
+                if (auto run = verbatim_run(input_, pos_, kEndsUnquoted); run != 0) {
+                    current_attribute().value += input_.substr(pos_, run);
+                    pos_ += run;
+                    continue;
+                }
+
                 auto c = consume_next_input_character();
                 if (!c) {
                     emit(ParseError::EofInTag);
@@ -1052,7 +1252,7 @@ void Tokenizer::run() {
                     continue;
                 }
 
-                if (util::no_case_compare(input_.substr(pos_, std::strlen("DOCTYPE")), "doctype"sv)) {
+                if (util::iequals(input_.substr(pos_, std::strlen("DOCTYPE")), "doctype"sv)) {
                     pos_ += std::strlen("DOCTYPE");
                     state_ = State::Doctype;
                     continue;
@@ -1412,13 +1612,13 @@ void Tokenizer::run() {
                         emit(std::move(current_token_));
                         continue;
                     default:
-                        if (util::no_case_compare(input_.substr(pos_ - 1, std::strlen("PUBLIC")), "public"sv)) {
+                        if (util::iequals(input_.substr(pos_ - 1, std::strlen("PUBLIC")), "public"sv)) {
                             pos_ += std::strlen("PUBLIC") - 1;
                             state_ = State::AfterDoctypePublicKeyword;
                             continue;
                         }
 
-                        if (util::no_case_compare(input_.substr(pos_ - 1, std::strlen("SYSTEM")), "system"sv)) {
+                        if (util::iequals(input_.substr(pos_ - 1, std::strlen("SYSTEM")), "system"sv)) {
                             pos_ += std::strlen("SYSTEM") - 1;
                             state_ = State::AfterDoctypeSystemKeyword;
                             continue;
@@ -2101,8 +2301,11 @@ void Tokenizer::emit(ParseError error) {
 }
 
 void Tokenizer::emit(Token &&token) {
-    if (std::holds_alternative<StartTagToken>(token)) {
-        last_start_tag_name_ = std::get<StartTagToken>(token).tag_name;
+    if (auto *start_tag = std::get_if<StartTagToken>(&token)) {
+        last_start_tag_name_ = start_tag->tag_name;
+        start_tag->tag_id = dom::tag_id_from_string(start_tag->tag_name);
+    } else if (auto *end_tag = std::get_if<EndTagToken>(&token)) {
+        end_tag->tag_id = dom::tag_id_from_string(end_tag->tag_name);
     }
     on_emit_(*this, std::move(token));
 }
@@ -2128,6 +2331,24 @@ bool Tokenizer::is_eof() const {
     return pos_ >= input_.size();
 }
 
+// Whether tokenization has to pause for more input to be fed before the
+// current state can make progress. States that look ahead more than one
+// character could otherwise make the wrong call at a chunk boundary.
+bool Tokenizer::needs_more_input() const {
+    switch (state_) {
+        case State::MarkupDeclarationOpen:
+            return input_.size() - pos_ < std::strlen("[CDATA[");
+        case State::AfterDoctypeName:
+            return input_.size() - pos_ < std::strlen("SYSTEM");
+        case State::NamedCharacterReference:
+            // Long enough to fit the longest named reference,
+            // "&CounterClockwiseContourIntegral;".
+            return input_.size() - (pos_ - 1) < 33;
+        default:
+            return is_eof();
+    }
+}
+
 void Tokenizer::start_attribute_in_current_tag_token(Attribute attr) {
     if (std::holds_alternative<StartTagToken>(current_token_)) {
         std::get<StartTagToken>(current_token_).attributes.push_back(std::move(attr));
@@ -2182,4 +2403,27 @@ void Tokenizer::emit_replacement_character() {
     }
 }
 
+util::Generator<Token> tokenize(std::string_view input, std::size_t chunk_size) {
+    std::vector<Token> pending;
+    Tokenizer tokenizer{[&pending](Tokenizer &, Token &&token) { pending.push_back(std::move(token)); }};
+
+    // Tokens are handed out between chunks: the next feed() can grow the
+    // stream buffer that text spans point into, so everything tokenized from
+    // one chunk is drained before the next goes in.
+    while (!input.empty()) {
+        auto chunk = input.substr(0, chunk_size);
+        input.remove_prefix(chunk.size());
+        tokenizer.feed(chunk);
+        for (auto &token : pending) {
+            co_yield std::move(token);
+        }
+        pending.clear();
+    }
+
+    tokenizer.finish();
+    for (auto &token : pending) {
+        co_yield std::move(token);
+    }
+}
+
 } // namespace html2
@@ -7,6 +7,9 @@
 
 #include "html2/token.h"
 
+#include "util/generator.h"
+
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <optional>
@@ -129,19 +132,61 @@ enum class ParseError {
     UnexpectedNullCharacter,
 };
 
+// Buffers a tokenizer accumulates into while running. Callers tokenizing
+// many documents can keep one of these and hand it to each tokenizer so the
+// buffers keep their capacity between runs instead of re-growing from
+// nothing on every document.
+struct TokenizerScratch {
+    std::string stream_buffer{};
+    std::string temporary_buffer{};
+};
+
 class Tokenizer {
 public:
     Tokenizer(
             std::string_view input,
             std::function<void(Tokenizer &, Token &&)> on_emit,
-            std::function<void(Tokenizer &, ParseError)> on_error = [](auto &, auto) {})
-        : input_{input}, on_emit_{std::move(on_emit)}, on_error_{std::move(on_error)} {}
+            std::function<void(Tokenizer &, ParseError)> on_error = [](auto &, auto) {},
+            TokenizerScratch *scratch = nullptr)
+        : input_{input}, on_emit_{std::move(on_emit)}, on_error_{std::move(on_error)}, scratch_{scratch} {
+        borrow_scratch();
+    }
+
+    // Creates a tokenizer for streaming use where the input isn't available
+    // up-front. Call feed() as chunks arrive and finish() once the whole
+    // document has been received.
+    explicit Tokenizer(
+            std::function<void(Tokenizer &, Token &&)> on_emit,
+            std::function<void(Tokenizer &, ParseError)> on_error = [](auto &, auto) {},
+            TokenizerScratch *scratch = nullptr)
+        : input_complete_{false}, on_emit_{std::move(on_emit)}, on_error_{std::move(on_error)}, scratch_{scratch} {
+        borrow_scratch();
+    }
+
+    ~Tokenizer() {
+        if (scratch_ != nullptr) {
+            scratch_->stream_buffer = std::move(stream_buffer_);
+            scratch_->temporary_buffer = std::move(temporary_buffer_);
+        }
+    }
+
+    Tokenizer(Tokenizer const &) = delete;
+    Tokenizer &operator=(Tokenizer const &) = delete;
 
     void set_state(State);
     void run();
 
+    // Appends a chunk of input and tokenizes as far as the new data allows.
+    // Only valid for tokenizers created for streaming use.
+    void feed(std::string_view);
+
+    // Signals that no more input will arrive and tokenizes what remains.
+    void finish();
+
 private:
     std::string_view input_;
+    std::string stream_buffer_{};
+    bool input_complete_{true};
     std::size_t pos_{0};
     State state_{State::Data};
     State return_state_{};
@@ -154,12 +199,23 @@ private:
 
     std::function<void(Tokenizer &, Token &&)> on_emit_{};
     std::function<void(Tokenizer &, ParseError)> on_error_{};
+    TokenizerScratch *scratch_{nullptr};
+
+    void borrow_scratch() {
+        if (scratch_ != nullptr) {
+            stream_buffer_ = std::move(scratch_->stream_buffer);
+            stream_buffer_.clear();
+            temporary_buffer_ = std::move(scratch_->temporary_buffer);
+            temporary_buffer_.clear();
+        }
+    }
 
     void emit(ParseError);
     void emit(Token &&);
     std::optional<char> consume_next_input_character();
     std::optional<char> peek_next_input_character() const;
     bool is_eof() const;
+    bool needs_more_input() const;
 
     void start_attribute_in_current_tag_token(Attribute);
     Attribute &current_attribute();
@@ -172,6 +228,14 @@ private:
     void emit_replacement_character();
 };
 
+// Pull-based frontend to the tokenizer: consumers take tokens on demand
+// instead of being driven through a callback, so pipelines can be written as
+// plain loops without buffering all tokens up-front. The input is fed to the
+// tokenizer roughly chunk_size bytes at a time, so only about a chunk is
+// tokenized ahead of the consumer. Character tokens reference the tokenizer's
+// internal buffer and are only valid until the next token is pulled.
+util::Generator<Token> tokenize(std::string_view input, std::size_t chunk_size = 4096);
+
 } // namespace html2
 
 #endif
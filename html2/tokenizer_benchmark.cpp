@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "html2/tokenizer.h"
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <variant>
+
+using namespace std::literals;
+
+namespace {
+
+// Synthetic but representative markup: nested elements with attributes, text
+// runs, comments, and character references. Repeated until the requested size
+// is reached so the same generator covers everything from a small page to a
+// multi-MB document.
+std::string document_of_roughly(std::size_t wanted_size) {
+    static constexpr auto kFragment =
+            "<div class=\"article content\" id=\"main\">"
+            "<h2>A heading with some text in it</h2>"
+            "<!-- comment explaining absolutely nothing -->"
+            "<p>Paragraph text, long enough to look like real prose rather than markup soup, "
+            "with an &amp; and an &lt;entity&gt; thrown in for good measure.</p>"
+            "<a href=\"https://example.com/some/path?q=1&amp;p=2\">a link</a>"
+            "</div>\n"sv;
+
+    std::string document{"<!DOCTYPE html><html><body>"};
+    document.reserve(wanted_size + kFragment.size());
+    while (document.size() < wanted_size) {
+        document += kFragment;
+    }
+    document += "</body></html>";
+    return document;
+}
+
+struct BenchmarkResult {
+    std::size_t bytes{};
+    std::size_t tokens{};
+    std::chrono::nanoseconds elapsed{};
+};
+
+BenchmarkResult run_once(std::string_view document) {
+    std::size_t tokens{};
+    auto start = std::chrono::steady_clock::now();
+    html2::Tokenizer{document, [&tokens](auto &, html2::Token &&) { ++tokens; }}.run();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return {document.size(), tokens, elapsed};
+}
+
+void benchmark(std::string_view name, std::size_t document_size, int repetitions) {
+    auto document = document_of_roughly(document_size);
+
+    BenchmarkResult best{};
+    for (int i = 0; i < repetitions; ++i) {
+        auto result = run_once(document);
+        if (best.elapsed == std::chrono::nanoseconds::zero() || result.elapsed < best.elapsed) {
+            best = result;
+        }
+    }
+
+    auto seconds = std::chrono::duration<double>(best.elapsed).count();
+    fmt::print("{}: {} bytes, {} tokens, {:.3f} ms, {:.1f} MB/s, {:.0f} tokens/s\n",
+            name,
+            best.bytes,
+            best.tokens,
+            seconds * 1000.,
+            static_cast<double>(best.bytes) / seconds / 1'000'000.,
+            static_cast<double>(best.tokens) / seconds);
+}
+
+} // namespace
+
+int main() {
+    benchmark("small", std::size_t{8} * 1024, 200);
+    benchmark("medium", std::size_t{256} * 1024, 50);
+    benchmark("large", std::size_t{4} * 1024 * 1024, 10);
+}
@@ -4,6 +4,7 @@
 
 #include "html2/tokenizer.h"
 
+#include "dom/tag_id.h"
 #include "etest/etest.h"
 
 #include <array>
@@ -69,8 +70,20 @@ void expect_token(
 void expect_text(TokenizerOutput &output,
         std::string_view text,
         etest::source_location const &loc = etest::source_location::current()) {
-    for (auto c : text) {
-        expect_token(output, CharacterToken{c}, loc);
+    while (!text.empty()) {
+        require(!output.tokens.empty(), "Unexpected end of token list", loc);
+        auto token = std::move(output.tokens.front());
+        output.tokens.erase(begin(output.tokens));
+
+        if (auto const *span = std::get_if<TextSpanToken>(&token)) {
+            require(text.starts_with(span->data), fmt::format("Unexpected text span: {}", span->data), loc);
+            text.remove_prefix(span->data.size());
+            continue;
+        }
+
+        require(std::holds_alternative<CharacterToken>(token), "Unexpected non-character token", loc);
+        expect_eq(std::get<CharacterToken>(token).data, text.front(), {}, loc);
+        text.remove_prefix(1);
     }
 }
 
@@ -156,6 +169,138 @@ void doctype_system_keyword_tests() {
 int main() {
     doctype_system_keyword_tests();
 
+    etest::test("tag tokens carry interned tag ids", [] {
+        auto tokens = run_tokenizer("<div><blink></blink></div>");
+
+        auto div = std::get<StartTagToken>(tokens.tokens.front());
+        expect_eq(div.tag_id, dom::TagId::Div);
+
+        auto blink = std::get<StartTagToken>(tokens.tokens.at(1));
+        expect_eq(blink.tag_id, dom::TagId::Unknown);
+
+        auto blink_end = std::get<EndTagToken>(tokens.tokens.at(2));
+        expect_eq(blink_end.tag_id, dom::TagId::Unknown);
+
+        auto div_end = std::get<EndTagToken>(tokens.tokens.at(3));
+        expect_eq(div_end.tag_id, dom::TagId::Div);
+
+        expect_token(tokens, StartTagToken{.tag_name = "div"});
+        expect_token(tokens, StartTagToken{.tag_name = "blink"});
+        expect_token(tokens, EndTagToken{.tag_name = "blink"});
+        expect_token(tokens, EndTagToken{.tag_name = "div"});
+        expect_token(tokens, EndOfFileToken{});
+    });
+
+    etest::test("data, long plain-text run", [] {
+        // Long enough that the vectorized scan kicks in no matter the chunk size.
+        auto text = std::string(64, 'a') + "b";
+        auto tokens = run_tokenizer(text);
+
+        expect_text(tokens, text);
+        expect_token(tokens, EndOfFileToken{});
+    });
+
+    etest::test("streaming, chunk boundaries inside lookahead", [] {
+        std::vector<Token> tokens;
+        std::vector<ParseError> errors;
+        Tokenizer tokenizer{[&](Tokenizer &, Token &&t) { tokens.push_back(std::move(t)); },
+                [&](auto &, ParseError e) { errors.push_back(e); }};
+
+        // Split in the middle of the doctype keyword and a named character
+        // reference, both of which require the tokenizer to look ahead.
+        tokenizer.feed("<!DOCT");
+        tokenizer.feed("YPE html><p>&no");
+        tokenizer.feed("t;hi");
+        tokenizer.finish();
+
+        TokenizerOutput output{std::move(tokens), std::move(errors), etest::source_location::current()};
+        expect_token(output, DoctypeToken{.name = "html"});
+        expect_token(output, StartTagToken{.tag_name = "p"});
+        expect_text(output, "\xc2\xac"); // U+00AC, "&not;".
+        expect_text(output, "hi"sv);
+        expect_token(output, EndOfFileToken{});
+    });
+
+    etest::test("streaming, tokens are emitted as chunks arrive", [] {
+        std::vector<Token> tokens;
+        Tokenizer tokenizer{[&](Tokenizer &, Token &&t) { tokens.push_back(std::move(t)); }};
+
+        tokenizer.feed("<p>hello");
+        expect_eq(tokens.size(), std::size_t{2}); // <p> + the "hello" span.
+
+        tokenizer.finish();
+        TokenizerOutput output{std::move(tokens), {}, etest::source_location::current()};
+        expect_token(output, StartTagToken{.tag_name = "p"});
+        expect_text(output, "hello"sv);
+        expect_token(output, EndOfFileToken{});
+    });
+
+    etest::test("streaming, scratch buffers keep their capacity between runs", [] {
+        TokenizerScratch scratch{};
+
+        {
+            Tokenizer tokenizer{[](Tokenizer &, Token &&) {}, [](auto &, auto) {}, &scratch};
+            // Long enough that the stream buffer has to allocate.
+            tokenizer.feed("<p>" + std::string(64, 'a') + "</p>");
+            tokenizer.finish();
+        }
+
+        auto grown_capacity = scratch.stream_buffer.capacity();
+        expect(grown_capacity > 0);
+
+        {
+            // The second run borrows the already-grown buffer instead of
+            // starting from an empty one.
+            std::vector<Token> tokens;
+            Tokenizer tokenizer{
+                    [&](Tokenizer &, Token &&t) { tokens.push_back(std::move(t)); }, [](auto &, auto) {}, &scratch};
+            tokenizer.feed("<p>hi</p>");
+            tokenizer.finish();
+
+            TokenizerOutput output{std::move(tokens), {}, etest::source_location::current()};
+            expect_token(output, StartTagToken{.tag_name = "p"});
+            expect_text(output, "hi"sv);
+            expect_token(output, EndTagToken{.tag_name = "p"});
+            expect_token(output, EndOfFileToken{});
+        }
+
+        expect_eq(scratch.stream_buffer.capacity(), grown_capacity);
+    });
+
+    etest::test("generator frontend", [] {
+        // A tiny chunk size so the input actually gets fed in pieces.
+        auto gen = tokenize("<p>hi</p>", 2);
+
+        std::string text;
+        std::vector<Token> structural;
+        while (gen.has_next()) {
+            auto token = gen.next();
+            if (auto const *span = std::get_if<TextSpanToken>(&token)) {
+                // Text spans are views into the tokenizer and die on the next
+                // pull, so they're copied out here.
+                text += span->data;
+                continue;
+            }
+
+            structural.push_back(std::move(token));
+        }
+
+        expect_eq(text, "hi");
+        require(structural.size() == 3);
+        expect_eq(structural[0], Token{StartTagToken{.tag_name = "p"}});
+        expect_eq(structural[1], Token{EndTagToken{.tag_name = "p"}});
+        expect_eq(structural[2], Token{EndOfFileToken{}});
+    });
+
+    etest::test("data, plain text interleaved with tags", [] {
+        auto tokens = run_tokenizer("hello hello hello hello<p>hello hello hello hello");
+
+        expect_text(tokens, "hello hello hello hello"sv);
+        expect_token(tokens, StartTagToken{.tag_name = "p"});
+        expect_text(tokens, "hello hello hello hello"sv);
+        expect_token(tokens, EndOfFileToken{});
+    });
+
     etest::test("script, empty", [] {
         auto tokens = run_tokenizer("<script></script>");
 
@@ -199,6 +344,15 @@ int main() {
         expect_token(tokens, EndOfFileToken{});
     });
 
+    etest::test("script, lone less-than signs are plain text", [] {
+        auto tokens = run_tokenizer("<script>if (a < b && c <= d) { e <<= 2; }</script>");
+
+        expect_token(tokens, StartTagToken{.tag_name = "script"});
+        expect_text(tokens, "if (a < b && c <= d) { e <<= 2; }"sv);
+        expect_token(tokens, EndTagToken{.tag_name = "script"});
+        expect_token(tokens, EndOfFileToken{});
+    });
+
     etest::test("script, end tag as text", [] {
         auto tokens = run_tokenizer("<script></</script>");
 
@@ -519,9 +673,9 @@ int main() {
     etest::test("comment, multiple with new lines", [] {
         auto tokens = run_tokenizer("<!--a-->\n<!--b-->\n<!--c-->");
         expect_token(tokens, CommentToken{.data = "a"});
-        expect_token(tokens, CharacterToken{'\n'});
+        expect_text(tokens, "\n"sv);
         expect_token(tokens, CommentToken{.data = "b"});
-        expect_token(tokens, CharacterToken{'\n'});
+        expect_text(tokens, "\n"sv);
         expect_token(tokens, CommentToken{.data = "c"});
         expect_token(tokens, EndOfFileToken{});
     });
@@ -690,6 +844,13 @@ int main() {
         expect_token(tokens, EndOfFileToken{});
     });
 
+    etest::test("attribute, unquoted, long value takes the bulk path", [] {
+        auto value = std::string(100, 'x');
+        auto tokens = run_tokenizer("<tag a=" + value + " b=c>");
+        expect_token(tokens, StartTagToken{.tag_name = "tag", .attributes = {{"a", value}, {"b", "c"}}});
+        expect_token(tokens, EndOfFileToken{});
+    });
+
     etest::test("attribute, unquoted, unexpected-null-character", [] {
         auto tokens = run_tokenizer("<tag a=\0>"sv);
         expect_error(tokens, ParseError::UnexpectedNullCharacter);
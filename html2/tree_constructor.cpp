@@ -4,15 +4,106 @@
 
 #include "html2/tree_constructor.h"
 
+#include "dom/tag_id.h"
 #include "dom2/document_type.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <string_view>
+#include <utility>
 
 using namespace std::literals;
 
 namespace html2 {
+namespace {
+
+constexpr std::uint8_t bit(OpenElementStack::Scope scope) {
+    return static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(scope));
+}
+
+// The scopes an element with this tag terminates.
+// https://html.spec.whatwg.org/multipage/parsing.html#has-an-element-in-the-specific-scope
+constexpr std::uint8_t scope_terminator_mask(dom::TagId tag) {
+    using Scope = OpenElementStack::Scope;
+    // Everything except optgroup and option terminates select scope.
+    std::uint8_t mask{bit(Scope::Select)};
+
+    switch (tag) {
+        // TODO(robinlinden): applet, marquee, and the MathML and SVG
+        // terminators once there are tag ids for them.
+        case dom::TagId::Caption:
+        case dom::TagId::Object:
+        case dom::TagId::Td:
+        case dom::TagId::Th:
+        case dom::TagId::Template:
+            mask |= bit(Scope::Default) | bit(Scope::ListItem) | bit(Scope::Button);
+            break;
+        case dom::TagId::Html:
+        case dom::TagId::Table:
+            mask |= bit(Scope::Default) | bit(Scope::ListItem) | bit(Scope::Button) | bit(Scope::Table);
+            break;
+        case dom::TagId::Ol:
+        case dom::TagId::Ul:
+            mask |= bit(Scope::ListItem);
+            break;
+        case dom::TagId::Button:
+            mask |= bit(Scope::Button);
+            break;
+        case dom::TagId::Optgroup:
+        case dom::TagId::Option:
+            mask = 0;
+            break;
+        default:
+            break;
+    }
+
+    return mask;
+}
+
+} // namespace
+
+void OpenElementStack::push(dom2::Node *node, dom::TagId tag) {
+    auto const index = entries_.size();
+    auto const tag_index = static_cast<std::size_t>(tag);
+    auto const terminates = scope_terminator_mask(tag);
+
+    entries_.push_back({node, tag, terminates, topmost_of_tag_[tag_index]});
+    topmost_of_tag_[tag_index] = index;
+
+    for (std::size_t scope = 0; scope < kScopeCount; ++scope) {
+        if ((terminates & (1 << scope)) != 0) {
+            terminators_[scope].push_back(index);
+        }
+    }
+}
+
+void OpenElementStack::pop() {
+    auto const &entry = entries_.back();
+    topmost_of_tag_[static_cast<std::size_t>(entry.tag)] = entry.previous_same_tag;
+
+    for (std::size_t scope = 0; scope < kScopeCount; ++scope) {
+        if ((entry.terminates & (1 << scope)) != 0) {
+            terminators_[scope].pop_back();
+        }
+    }
+
+    entries_.pop_back();
+}
+
+bool OpenElementStack::has_element_in_scope(dom::TagId tag, Scope scope) const {
+    auto const topmost = topmost_of_tag_[static_cast<std::size_t>(tag)];
+    if (topmost == kNoEntry) {
+        return false;
+    }
+
+    // The element is in scope if no terminator sits above its topmost
+    // occurrence. An element terminating its own scope still matches the spec
+    // walk, hence >= rather than >.
+    auto const &terminators = terminators_[static_cast<std::size_t>(scope)];
+    return terminators.empty() || topmost >= terminators.back();
+}
 
 void TreeConstructor::run(std::string_view input) {
     Tokenizer tokenizer{input, std::bind_front(&TreeConstructor::on_token, this)};
@@ -26,7 +117,32 @@ void TreeConstructor::run(std::vector<Token> tokens) {
     }
 }
 
-void TreeConstructor::on_token(Tokenizer &, Token &&token) {
+bool TreeConstructor::run_incremental(std::vector<Token> tokens) {
+    if (has_previous_run_ && tokens == previous_tokens_) {
+        return true;
+    }
+
+    mode_ = InsertionMode::Initial;
+    arena_ = dom2::NodeArena{};
+    document_ = arena_.create<dom2::Document>();
+    open_elements_ = {};
+
+    run(tokens);
+    previous_tokens_ = std::move(tokens);
+    has_previous_run_ = true;
+    return false;
+}
+
+void TreeConstructor::on_token(Tokenizer &tokenizer, Token &&token) {
+    // The insertion modes are specified in terms of individual characters, so
+    // unpack text spans before dispatching on the mode.
+    if (auto const *span = std::get_if<TextSpanToken>(&token)) {
+        for (char c : span->data) {
+            on_token(tokenizer, CharacterToken{c});
+        }
+        return;
+    }
+
     switch (mode_) {
         // https://html.spec.whatwg.org/multipage/parsing.html#the-initial-insertion-mode
         case InsertionMode::Initial: {
@@ -54,7 +170,7 @@ void TreeConstructor::on_token(Tokenizer &, Token &&token) {
                     // Parse error.
                 }
 
-                document_->append_child(std::make_shared<dom2::DocumentType>(doctype->name.value_or(""),
+                document_->append_child(arena_.create<dom2::DocumentType>(doctype->name.value_or(""),
                         doctype->public_identifier.value_or(""),
                         doctype->system_identifier.value_or("")));
 
@@ -92,8 +208,8 @@ void TreeConstructor::on_token(Tokenizer &, Token &&token) {
 
             if (auto const *start_tag = std::get_if<StartTagToken>(&token);
                     start_tag && start_tag->tag_name == "html") {
-                auto element = document_->append_child(create_element_for_token(token, ns::html, *document_));
-                open_elements_.push(element);
+                auto *element = document_->append_child(create_element_for_token(token, ns::html, *document_));
+                open_elements_.push(element, dom::TagId::Html);
                 mode_ = InsertionMode::BeforeHead;
                 return;
             }
@@ -148,8 +264,8 @@ void TreeConstructor::on_token(Tokenizer &, Token &&token) {
 }
 
 // https://html.spec.whatwg.org/multipage/parsing.html#create-an-element-for-the-token
-std::shared_ptr<dom2::Element> TreeConstructor::create_element_for_token(
-        Token const &token, std::string_view given_namespace, dom2::Node const &intended_parent) const {
+dom2::Element *TreeConstructor::create_element_for_token(
+        Token const &token, std::string_view given_namespace, dom2::Node const &intended_parent) {
     (void)intended_parent;
     // TODO(robinlinden): Everything.
 
@@ -167,34 +283,34 @@ std::shared_ptr<dom2::Element> TreeConstructor::create_element_for_token(
 }
 
 // https://dom.spec.whatwg.org/#concept-create-element
-std::shared_ptr<dom2::Element> TreeConstructor::create_element([[maybe_unused]] dom2::Document const &document,
+dom2::Element *TreeConstructor::create_element(dom2::Document &document,
         std::string local_name,
-        [[maybe_unused]] std::string_view ns,
+        std::string_view ns,
         // Maybe not needed once we've implemented this.
         // NOLINTNEXTLINE(bugprone-easily-swappable-parameters):
-        [[maybe_unused]] std::optional<std::string_view> prefix,
+        std::optional<std::string_view> prefix,
         [[maybe_unused]] std::optional<std::string_view> is_value,
-        [[maybe_unused]] bool synchronous_custom_elements) const {
+        [[maybe_unused]] bool synchronous_custom_elements) {
     // 1. If prefix was not given, let prefix be null.
     // 2. If is was not given, let is be null.
     // 3. Let result be null.
-    std::shared_ptr<dom2::Element> result{nullptr};
+    dom2::Element *result{nullptr};
 
     // TODO(robinlinden): Everything.
-    result = std::make_shared<dom2::Element>(local_name);
+    result = arena_.create<dom2::Element>(document, local_name, ns, prefix.value_or(""));
 
     return result;
 }
 
 // https://html.spec.whatwg.org/multipage/parsing.html#insert-a-foreign-element
-std::shared_ptr<dom2::Element> TreeConstructor::insert_foreign_element(Token const &token, std::string_view ns) {
+dom2::Element *TreeConstructor::insert_foreign_element(Token const &token, std::string_view ns) {
     // 1. Let the adjusted insertion location be the appropriate place for inserting a node.
     auto &adjusted_insertion_location = appropriate_place_for_inserting_a_node();
 
     // 2. Let element be the result of creating an element for the token in the
     // given namespace, with the intended parent being the element in which the
     // adjusted insertion location finds itself.
-    auto element = create_element_for_token(token, ns, adjusted_insertion_location);
+    auto *element = create_element_for_token(token, ns, adjusted_insertion_location);
 
     // 3. If it is possible to insert element at the adjusted insertion location, then:
     if (is_possible_to_insert_element_at(*element, adjusted_insertion_location)) {
@@ -219,7 +335,7 @@ std::shared_ptr<dom2::Element> TreeConstructor::insert_foreign_element(Token con
 
     // 4. Push element onto the stack of open elements so that it is the new
     // current node.
-    open_elements_.push(element);
+    open_elements_.push(element, dom::tag_id_from_string(element->local_name()));
 
     // 5. Return element.
     return element;
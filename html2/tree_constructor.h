@@ -5,17 +5,23 @@
 #ifndef HTML2_TREE_BUILDER_H_
 #define HTML2_TREE_BUILDER_H_
 
+#include "dom/tag_id.h"
 #include "dom2/document.h"
 #include "dom2/element.h"
 #include "dom2/node.h"
+#include "dom2/node_arena.h"
 #include "html2/token.h"
 #include "html2/tokenizer.h"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <memory>
+#include <limits>
 #include <optional>
-#include <stack>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace html2 {
@@ -49,42 +55,118 @@ enum class InsertionMode {
     AfterAfterFrameset,
 };
 
+// The stack of open elements. Entries carry their interned tag id, and the
+// terminators of each kind of scope are tracked as the stack changes, so the
+// spec's frequent "have an element in scope" queries are two index compares
+// instead of walks over the stack.
+// https://html.spec.whatwg.org/multipage/parsing.html#the-stack-of-open-elements
+class OpenElementStack {
+public:
+    // https://html.spec.whatwg.org/multipage/parsing.html#has-an-element-in-the-specific-scope
+    enum class Scope : std::uint8_t {
+        Default,
+        ListItem,
+        Button,
+        Table,
+        Select,
+    };
+
+    void push(dom2::Node *, dom::TagId);
+    void pop();
+
+    [[nodiscard]] bool empty() const { return entries_.empty(); }
+    [[nodiscard]] dom2::Node *top() const { return entries_.back().node; }
+
+    // Whether an element with this tag would be found walking from the
+    // current node towards the root before hitting an element terminating the
+    // given scope.
+    [[nodiscard]] bool has_element_in_scope(dom::TagId, Scope = Scope::Default) const;
+
+private:
+    static constexpr std::size_t kScopeCount{5};
+    // TagId is a dense enum, so it indexes arrays directly. Wbr is its last
+    // entry.
+    static constexpr std::size_t kTagCount{static_cast<std::size_t>(dom::TagId::Wbr) + 1};
+    static constexpr std::size_t kNoEntry{std::numeric_limits<std::size_t>::max()};
+
+    struct Entry {
+        dom2::Node *node;
+        dom::TagId tag;
+        // The scopes this element terminates, one bit per Scope. Computed at
+        // push so pop knows which terminator stacks to unwind.
+        std::uint8_t terminates;
+        // The entry below this one with the same tag, so popping restores
+        // topmost_of_tag_ without a search.
+        std::size_t previous_same_tag;
+    };
+
+    std::vector<Entry> entries_{};
+    // Stack index of the topmost entry per tag, kNoEntry when absent.
+    std::array<std::size_t, kTagCount> topmost_of_tag_{[] {
+        std::array<std::size_t, kTagCount> init{};
+        init.fill(kNoEntry);
+        return init;
+    }()};
+    // Stack indices of the elements terminating each scope, innermost last.
+    std::array<std::vector<std::size_t>, kScopeCount> terminators_{};
+};
+
+// A constructed document together with the arena owning its nodes.
+struct DocumentHandle {
+    dom2::NodeArena arena{};
+    dom2::Document *document{};
+};
+
 class TreeConstructor {
 public:
     void run(std::string_view input);
     void run(std::vector<html2::Token>);
 
-    std::unique_ptr<dom2::Document> take_document() {
-        return std::exchange(document_, std::make_unique<dom2::Document>());
+    // Re-runs tree construction only if the token stream differs from the
+    // previous run. Returns true if the stream was unchanged and the already
+    // constructed document was kept as-is. Reuse only applies while the
+    // constructor still owns the document: taking it forces the next run to
+    // construct a fresh one.
+    bool run_incremental(std::vector<html2::Token>);
+
+    DocumentHandle take_document() {
+        previous_tokens_.clear();
+        has_previous_run_ = false;
+        DocumentHandle handle{std::move(arena_), document_};
+        arena_ = dom2::NodeArena{};
+        document_ = arena_.create<dom2::Document>();
+        open_elements_ = {};
+        return handle;
     }
 
 private:
     InsertionMode mode_{InsertionMode::Initial};
-    std::unique_ptr<dom2::Document> document_{std::make_unique<dom2::Document>()};
-    std::stack<std::shared_ptr<dom2::Node>> open_elements_{};
+    dom2::NodeArena arena_{};
+    dom2::Document *document_{arena_.create<dom2::Document>()};
+    OpenElementStack open_elements_{};
+    std::vector<html2::Token> previous_tokens_{};
+    bool has_previous_run_{false};
 
     void on_token(Tokenizer &, Token &&);
 
-    std::shared_ptr<dom2::Element> create_element_for_token(
-            Token const &, std::string_view given_namespace, dom2::Node const &intended_parent) const;
+    dom2::Element *create_element_for_token(
+            Token const &, std::string_view given_namespace, dom2::Node const &intended_parent);
 
-    std::shared_ptr<dom2::Element> create_element(dom2::Document const &,
+    // Non-const document: element names are interned into its atom table.
+    dom2::Element *create_element(dom2::Document &,
             std::string local_name,
             std::string_view ns,
             std::optional<std::string_view> prefix = std::nullopt,
             std::optional<std::string_view> is = std::nullopt,
-            bool synchronous_custom_elements = false) const;
+            bool synchronous_custom_elements = false);
 
-    std::shared_ptr<dom2::Element> insert_foreign_element(Token const &, std::string_view ns);
-    std::shared_ptr<dom2::Element> insert_html_element(Token const &token) {
-        return insert_foreign_element(token, ns::html);
-    }
+    dom2::Element *insert_foreign_element(Token const &, std::string_view ns);
+    dom2::Element *insert_html_element(Token const &token) { return insert_foreign_element(token, ns::html); }
 
     dom2::Node &appropriate_place_for_inserting_a_node(
             std::optional<std::reference_wrapper<dom2::Node>> override_target = std::nullopt);
 
     dom2::Node &current_node() {
-        // It's UB to call back() on an empty std::deque.
         if (open_elements_.empty()) {
             std::terminate();
         }
@@ -4,7 +4,9 @@
 
 #include "html2/tree_constructor.h"
 
+#include "dom/tag_id.h"
 #include "dom2/document_type.h"
+#include "dom2/element.h"
 #include "etest/etest.h"
 
 #include <memory>
@@ -14,13 +16,14 @@
 
 using namespace std::literals;
 
+using etest::expect;
 using etest::expect_eq;
 
 using namespace html2;
 
 namespace {
 
-std::unique_ptr<dom2::Document> construct_from(std::vector<html2::Token> tokens) {
+DocumentHandle construct_from(std::vector<html2::Token> tokens) {
     auto constructor = TreeConstructor{};
     constructor.run(std::move(tokens));
     return constructor.take_document();
@@ -30,7 +33,7 @@ std::unique_ptr<dom2::Document> construct_from(std::vector<html2::Token> tokens)
 
 int main() {
     etest::test("document with only doctype", [] {
-        auto document = construct_from({DoctypeToken{"html"s}});
+        auto [arena, document] = construct_from({DoctypeToken{"html"s}});
 
         expect_eq(document->type(), dom2::NodeType::Document);
         expect_eq(document->child_nodes().size(), size_t{1});
@@ -40,5 +43,72 @@ int main() {
         expect_eq(doctype->name(), "html"s);
     });
 
+    etest::test("incremental, unchanged token stream is not re-constructed", [] {
+        std::vector<Token> tokens{DoctypeToken{"html"s}};
+        auto constructor = TreeConstructor{};
+
+        expect_eq(constructor.run_incremental(tokens), false);
+        expect_eq(constructor.run_incremental(tokens), true);
+
+        auto handle = constructor.take_document();
+        expect_eq(handle.document->child_nodes().size(), size_t{1});
+
+        // The document has been handed off, so an identical stream has to be
+        // constructed from scratch again.
+        expect_eq(constructor.run_incremental(tokens), false);
+        expect_eq(constructor.take_document().document->child_nodes().size(), size_t{1});
+    });
+
+    etest::test("open element stack, scope queries", [] {
+        using Scope = OpenElementStack::Scope;
+        dom2::NodeArena arena{};
+        auto *document = arena.create<dom2::Document>();
+        auto element = [&](char const *name) { return arena.create<dom2::Element>(*document, name); };
+
+        OpenElementStack stack{};
+        expect(!stack.has_element_in_scope(dom::TagId::P));
+
+        stack.push(element("html"), dom::TagId::Html);
+        stack.push(element("body"), dom::TagId::Body);
+        stack.push(element("button"), dom::TagId::Button);
+        stack.push(element("p"), dom::TagId::P);
+
+        expect(stack.has_element_in_scope(dom::TagId::P));
+        expect(stack.has_element_in_scope(dom::TagId::Body));
+        // The button between them terminates button scope, but not the
+        // default scope.
+        expect(stack.has_element_in_scope(dom::TagId::P, Scope::Button));
+        expect(!stack.has_element_in_scope(dom::TagId::Body, Scope::Button));
+        // An element terminating its own scope is still found.
+        expect(stack.has_element_in_scope(dom::TagId::Button, Scope::Button));
+
+        // A table shadows everything below it.
+        stack.push(element("table"), dom::TagId::Table);
+        expect(!stack.has_element_in_scope(dom::TagId::P));
+        expect(stack.has_element_in_scope(dom::TagId::Table, Scope::Table));
+        expect(!stack.has_element_in_scope(dom::TagId::Body, Scope::Table));
+
+        // Popping it brings the shadowed elements back into scope.
+        stack.pop();
+        expect(stack.has_element_in_scope(dom::TagId::P));
+
+        // option doesn't terminate select scope; anything else does.
+        stack.push(element("select"), dom::TagId::Select);
+        stack.push(element("option"), dom::TagId::Option);
+        expect(stack.has_element_in_scope(dom::TagId::Select, Scope::Select));
+        stack.push(element("div"), dom::TagId::Div);
+        expect(!stack.has_element_in_scope(dom::TagId::Select, Scope::Select));
+    });
+
+    etest::test("incremental, changed token stream is re-constructed", [] {
+        auto constructor = TreeConstructor{};
+        expect_eq(constructor.run_incremental({DoctypeToken{"html"s}}), false);
+        expect_eq(constructor.run_incremental({DoctypeToken{"xml"s}}), false);
+
+        auto [arena, document] = constructor.take_document();
+        auto const *doctype = static_cast<dom2::DocumentType const *>(document->first_child());
+        expect_eq(doctype->name(), "xml"s);
+    });
+
     return etest::run_all_tests();
 }
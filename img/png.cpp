@@ -6,9 +6,12 @@
 
 #include <array>
 #include <csetjmp>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <istream>
 #include <optional>
+#include <span>
 #include <utility>
 #include <vector>
 
@@ -28,6 +31,158 @@ void read_png_bytes(png_structp png, png_bytep data, png_size_t length) {
     }
 }
 
+// Row-expansion kernels for the formats we see most. They're plain loops
+// over whole rows, written so the compiler vectorizes them; libpng's
+// transform machinery does the same work pixel by pixel through function
+// pointers.
+void expand_gray8_to_rgba(std::span<unsigned char const> src, std::span<unsigned char> dst) {
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        dst[i * 4] = src[i];
+        dst[i * 4 + 1] = src[i];
+        dst[i * 4 + 2] = src[i];
+        dst[i * 4 + 3] = 0xff;
+    }
+}
+
+void expand_gray16_to_rgba(std::span<unsigned char const> src, std::span<unsigned char> dst) {
+    for (std::size_t i = 0; i < src.size() / 2; ++i) {
+        // The wire format is big-endian, so the high byte is the same
+        // 16-to-8 scaling png_set_scale_16 would do.
+        auto v = src[i * 2];
+        dst[i * 4] = v;
+        dst[i * 4 + 1] = v;
+        dst[i * 4 + 2] = v;
+        dst[i * 4 + 3] = 0xff;
+    }
+}
+
+void expand_palette8_to_rgba(std::span<unsigned char const> src,
+        std::array<std::array<unsigned char, 4>, 256> const &palette,
+        std::span<unsigned char> dst) {
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        auto const &entry = palette[src[i]];
+        dst[i * 4] = entry[0];
+        dst[i * 4 + 1] = entry[1];
+        dst[i * 4 + 2] = entry[2];
+        dst[i * 4 + 3] = entry[3];
+    }
+}
+
+enum class RowExpansion : std::uint8_t {
+    None, // Rows already arrive as rgba and are yielded as-is.
+    Gray8,
+    Gray16,
+    Palette8,
+};
+
+struct ProgressiveState {
+    std::function<void(Png::Metadata const &)> const &on_metadata;
+    std::function<void(std::uint32_t, std::span<unsigned char const>)> const &on_row;
+    Png::Metadata metadata{};
+    std::vector<unsigned char> row{};
+    RowExpansion expansion{RowExpansion::None};
+    std::array<std::array<unsigned char, 4>, 256> palette{};
+    std::vector<unsigned char> rgba{};
+    bool done{};
+};
+
+void progressive_info(png_structp png, png_infop info) {
+    auto *state = reinterpret_cast<ProgressiveState *>(png_get_progressive_ptr(png));
+
+    // Streaming out rows as they're decoded doesn't mix with interlacing,
+    // where every row is touched once per pass.
+    if (png_get_interlace_type(png, info) != PNG_INTERLACE_NONE) {
+        png_error(png, "interlaced pngs aren't supported in streaming decode");
+    }
+
+    // Gray and palette rows get expanded to rgba by our own kernels; the
+    // remaining formats go through libpng's transforms.
+    auto color_type = png_get_color_type(png, info);
+    auto bit_depth = png_get_bit_depth(png, info);
+    bool has_trns = png_get_valid(png, info, PNG_INFO_tRNS) != 0;
+
+    if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth == 8 && !has_trns) {
+        state->expansion = RowExpansion::Gray8;
+    } else if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth == 16 && !has_trns) {
+        state->expansion = RowExpansion::Gray16;
+    } else if (color_type == PNG_COLOR_TYPE_PALETTE && bit_depth == 8) {
+        png_colorp plte{nullptr};
+        int plte_size{0};
+        if (png_get_PLTE(png, info, &plte, &plte_size) == PNG_INFO_PLTE) {
+            state->expansion = RowExpansion::Palette8;
+
+            // Indices pointing past the plte chunk resolve to opaque black.
+            state->palette.fill({0, 0, 0, 0xff});
+            for (int i = 0; i < plte_size; ++i) {
+                state->palette[i] = {plte[i].red, plte[i].green, plte[i].blue, 0xff};
+            }
+
+            png_bytep trans{nullptr};
+            int trans_size{0};
+            if (png_get_tRNS(png, info, &trans, &trans_size, nullptr) == PNG_INFO_tRNS) {
+                for (int i = 0; i < trans_size && i < plte_size; ++i) {
+                    state->palette[i][3] = trans[i];
+                }
+            }
+        }
+    }
+
+    if (state->expansion == RowExpansion::None) {
+        png_set_expand(png);
+        png_set_scale_16(png);
+        png_set_gray_to_rgb(png);
+        png_set_add_alpha(png, 0xff, PNG_FILLER_AFTER);
+    }
+
+    png_read_update_info(png, info);
+
+    auto width = png_get_image_width(png, info);
+    state->metadata = Png::Metadata{
+            .width = width,
+            .height = png_get_image_height(png, info),
+            .bytes_per_row = std::size_t{width} * 4,
+    };
+    state->row.resize(png_get_rowbytes(png, info));
+    if (state->expansion != RowExpansion::None) {
+        state->rgba.resize(state->metadata.bytes_per_row);
+    }
+    state->on_metadata(state->metadata);
+}
+
+void progressive_row(png_structp png, png_bytep new_row, png_uint_32 row_number, int) {
+    if (new_row == nullptr) {
+        return;
+    }
+
+    auto *state = reinterpret_cast<ProgressiveState *>(png_get_progressive_ptr(png));
+    png_progressive_combine_row(png, state->row.data(), new_row);
+
+    std::span<unsigned char const> row{state->row.data(), state->row.size()};
+    switch (state->expansion) {
+        case RowExpansion::Gray8:
+            expand_gray8_to_rgba(row, state->rgba);
+            row = state->rgba;
+            break;
+        case RowExpansion::Gray16:
+            expand_gray16_to_rgba(row, state->rgba);
+            row = state->rgba;
+            break;
+        case RowExpansion::Palette8:
+            expand_palette8_to_rgba(row, state->palette, state->rgba);
+            row = state->rgba;
+            break;
+        case RowExpansion::None:
+            break;
+    }
+
+    state->on_row(row_number, row);
+}
+
+void progressive_end(png_structp png, png_infop) {
+    auto *state = reinterpret_cast<ProgressiveState *>(png_get_progressive_ptr(png));
+    state->done = true;
+}
+
 } // namespace
 
 std::optional<Png> Png::from(std::istream &is) {
@@ -64,6 +219,8 @@ std::optional<Png> Png::from(std::istream &is) {
     png_read_info(png, info);
 
     png_set_expand(png);
+    png_set_scale_16(png);
+    png_set_gray_to_rgb(png);
     png_set_add_alpha(png, 0xff, PNG_FILLER_AFTER);
 
     png_read_update_info(png, info);
@@ -89,4 +246,49 @@ std::optional<Png> Png::from(std::istream &is) {
     return ret;
 }
 
+bool Png::decode_rows(std::istream &is,
+        std::function<void(Metadata const &)> const &on_metadata,
+        std::function<void(std::uint32_t, std::span<unsigned char const>)> const &on_row) {
+    // Everything that needs destroying is set up before the setjmp so that
+    // an error longjmp can't skip any destructors.
+    ProgressiveState state{.on_metadata = on_metadata, .on_row = on_row};
+    std::array<char, 4096> buffer{};
+
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    if (png == nullptr) {
+        return false;
+    }
+
+    png_infop info = png_create_info_struct(png);
+    if (info == nullptr) {
+        png_destroy_read_struct(&png, nullptr, nullptr);
+        return false;
+    }
+
+#ifdef _MSC_VER
+    // C4611: interaction between '_setjmp' and C++ object destruction is non-portable.
+    // See: https://docs.microsoft.com/en-us/cpp/cpp/using-setjmp-longjmp
+#pragma warning(disable : 4611)
+#endif
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_read_struct(&png, &info, nullptr);
+        return false;
+    }
+
+    png_set_progressive_read_fn(png, &state, progressive_info, progressive_row, progressive_end);
+
+    while (!state.done) {
+        is.read(buffer.data(), buffer.size());
+        auto chunk_size = static_cast<png_size_t>(is.gcount());
+        if (chunk_size == 0) {
+            break;
+        }
+
+        png_process_data(png, info, reinterpret_cast<png_bytep>(buffer.data()), chunk_size);
+    }
+
+    png_destroy_read_struct(&png, &info, nullptr);
+    return state.done;
+}
+
 } // namespace img
@@ -5,9 +5,12 @@
 #ifndef IMG_PNG_H_
 #define IMG_PNG_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace img {
@@ -17,6 +20,28 @@ public:
     static std::optional<Png> from(std::istream &&is) { return from(is); }
     static std::optional<Png> from(std::istream &is);
 
+    struct Metadata {
+        std::uint32_t width{};
+        std::uint32_t height{};
+        std::size_t bytes_per_row{};
+    };
+
+    // Streaming decode through libpng's progressive reader. The input is
+    // consumed in small chunks and every decoded row is yielded through
+    // on_row from a single reused row buffer, so decoding a large image
+    // never materializes the full-size intermediate and can start before
+    // the bytes have finished arriving. Rows always arrive as 8-bit rgba
+    // regardless of the file's own pixel format. Interlaced images aren't
+    // supported here; use from() for those. Returns false on broken input.
+    static bool decode_rows(std::istream &&is,
+            std::function<void(Metadata const &)> const &on_metadata,
+            std::function<void(std::uint32_t, std::span<unsigned char const>)> const &on_row) {
+        return decode_rows(is, on_metadata, on_row);
+    }
+    static bool decode_rows(std::istream &,
+            std::function<void(Metadata const &)> const &on_metadata,
+            std::function<void(std::uint32_t, std::span<unsigned char const>)> const &on_row);
+
     std::uint32_t width{};
     std::uint32_t height{};
     std::vector<unsigned char> bytes{};
@@ -8,15 +8,77 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <span>
 #include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include <png.h>
+
+using etest::expect;
 using etest::expect_eq;
 
 namespace {
 #include "img/tiny_png.h"
 std::string const png_bytes(reinterpret_cast<char const *>(img_tiny_png), img_tiny_png_len);
+
+void append_png_bytes(png_structp png, png_bytep data, png_size_t length) {
+    auto *out = reinterpret_cast<std::string *>(png_get_io_ptr(png));
+    out->append(reinterpret_cast<char const *>(data), length);
+}
+
+// Encodes rows as-is with libpng so the decode paths can be fed pixel
+// formats tiny.png doesn't cover.
+std::string encode_png(int color_type,
+        int bit_depth,
+        std::vector<std::vector<unsigned char>> const &rows,
+        std::uint32_t width,
+        std::vector<std::array<unsigned char, 3>> const &palette = {}) {
+    std::string out{};
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct(png);
+
+    png_set_write_fn(png, &out, append_png_bytes, nullptr);
+    png_set_IHDR(png,
+            info,
+            width,
+            static_cast<std::uint32_t>(rows.size()),
+            bit_depth,
+            color_type,
+            PNG_INTERLACE_NONE,
+            PNG_COMPRESSION_TYPE_DEFAULT,
+            PNG_FILTER_TYPE_DEFAULT);
+
+    std::vector<png_color> plte{};
+    for (auto const &entry : palette) {
+        plte.push_back(png_color{entry[0], entry[1], entry[2]});
+    }
+    if (!plte.empty()) {
+        png_set_PLTE(png, info, plte.data(), static_cast<int>(plte.size()));
+    }
+
+    png_write_info(png, info);
+    for (auto const &row : rows) {
+        png_write_row(png, row.data());
+    }
+    png_write_end(png, info);
+
+    png_destroy_write_struct(&png, &info);
+    return out;
+}
+
+std::vector<unsigned char> decoded_rows(std::string const &bytes) {
+    std::vector<unsigned char> pixels{};
+    img::Png::decode_rows(
+            std::stringstream{bytes},
+            [](auto const &) {},
+            [&](std::uint32_t, std::span<unsigned char const> row) {
+                pixels.insert(pixels.end(), row.begin(), row.end());
+            });
+    return pixels;
+}
 } // namespace
 
 int main() {
@@ -38,6 +100,81 @@ int main() {
         expect_eq(png, img::Png{.width = 256, .height = 256, .bytes = std::move(expected_pixels)});
     });
 
+    etest::test("streaming decode yields the same pixels row by row", [] {
+        auto whole_image = img::Png::from(std::stringstream(png_bytes)).value();
+
+        img::Png::Metadata metadata{};
+        std::vector<unsigned char> pixels;
+        unsigned char const *row_buffer{nullptr};
+        bool buffer_was_reused{true};
+
+        bool ok = img::Png::decode_rows(
+                std::stringstream(png_bytes),
+                [&](img::Png::Metadata const &m) {
+                    metadata = m;
+                    pixels.reserve(m.bytes_per_row * m.height);
+                },
+                [&](std::uint32_t, std::span<unsigned char const> row) {
+                    // Every row arrives in the same reused buffer.
+                    buffer_was_reused &= row_buffer == nullptr || row.data() == row_buffer;
+                    row_buffer = row.data();
+                    pixels.insert(pixels.end(), row.begin(), row.end());
+                });
+
+        expect(ok);
+        expect(buffer_was_reused);
+        expect_eq(metadata.width, 256u);
+        expect_eq(metadata.height, 256u);
+        expect_eq(metadata.bytes_per_row, std::size_t{256} * 4);
+        expect_eq(pixels, whole_image.bytes);
+    });
+
+    etest::test("streaming decode expands gray8 to rgba", [] {
+        auto bytes = encode_png(PNG_COLOR_TYPE_GRAY, 8, {{0, 128}, {255, 7}}, 2);
+
+        std::vector<unsigned char> expected{
+                0, 0, 0, 0xff, 128, 128, 128, 0xff, //
+                255, 255, 255, 0xff, 7, 7, 7, 0xff, //
+        };
+        expect_eq(decoded_rows(bytes), expected);
+
+        // Both decode paths agree on what the pixels are.
+        expect_eq(img::Png::from(std::stringstream{bytes}).value().bytes, expected);
+    });
+
+    etest::test("streaming decode packs gray16 to rgba", [] {
+        // 16-bit samples are big-endian on the wire, and scaling to 8 bits
+        // keeps the high byte.
+        auto bytes = encode_png(PNG_COLOR_TYPE_GRAY, 16, {{0x12, 0x34, 0xab, 0xcd}}, 2);
+
+        std::vector<unsigned char> expected{
+                0x12, 0x12, 0x12, 0xff, 0xab, 0xab, 0xab, 0xff, //
+        };
+        expect_eq(decoded_rows(bytes), expected);
+        expect_eq(img::Png::from(std::stringstream{bytes}).value().bytes, expected);
+    });
+
+    etest::test("streaming decode expands palette to rgba", [] {
+        auto bytes = encode_png(PNG_COLOR_TYPE_PALETTE,
+                8,
+                {{0, 1}, {2, 0}},
+                2,
+                {{0xff, 0, 0}, {0, 0xff, 0}, {0, 0, 0xff}});
+
+        std::vector<unsigned char> expected{
+                0xff, 0, 0, 0xff, 0, 0xff, 0, 0xff, //
+                0, 0, 0xff, 0xff, 0xff, 0, 0, 0xff, //
+        };
+        expect_eq(decoded_rows(bytes), expected);
+        expect_eq(img::Png::from(std::stringstream{bytes}).value().bytes, expected);
+    });
+
+    etest::test("streaming decode handles truncated files", [] {
+        bool ok = img::Png::decode_rows(
+                std::stringstream(png_bytes.substr(0, 30)), [](auto const &) {}, [](auto, auto) {});
+        expect(!ok);
+    });
+
     etest::test("invalid signatures are rejected", [] {
         auto invalid_signature_bytes = png_bytes;
         invalid_signature_bytes[7] = 'b';
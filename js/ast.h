@@ -5,6 +5,7 @@
 #ifndef JS_AST_H_
 #define JS_AST_H_
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -54,27 +55,44 @@ struct NativeFunction {
 };
 
 // TODO(robinlinden): This needs to support more values.
+// Numbers and undefined are stored inline and the heavier payloads sit
+// behind shared_ptrs to immutable data, so copying a Value never allocates:
+// moving values between registers, scopes, and arguments only bumps
+// reference counts, and numeric loops don't touch the heap at all.
 class Value {
 public:
     explicit Value() : value_{Undefined{}} {}
     explicit Value(double value) : value_{value} {}
-    explicit Value(std::string value) : value_{std::move(value)} {}
+    explicit Value(std::string value) : value_{std::make_shared<std::string const>(std::move(value))} {}
     explicit Value(std::shared_ptr<Function> value) : value_{std::move(value)} {}
-    explicit Value(std::vector<Value> value) : value_{std::move(value)} {}
-    explicit Value(NativeFunction value) : value_{std::move(value)} {}
+    explicit Value(std::vector<Value> value) : value_{std::make_shared<std::vector<Value> const>(std::move(value))} {}
+    explicit Value(NativeFunction value) : value_{std::make_shared<NativeFunction const>(std::move(value))} {}
+
+    // Adopting constructors for payloads whose storage somebody else
+    // manages, e.g. a ValueHeap page.
+    explicit Value(std::shared_ptr<std::string const> value) : value_{std::move(value)} {}
+    explicit Value(std::shared_ptr<std::vector<Value> const> value) : value_{std::move(value)} {}
+
+    // Concatenation builds a rope instead of a flat string: joining two
+    // strings is O(1), and a string assembled from n fragments is flattened
+    // once, linearly, the first time somebody reads it.
+    [[nodiscard]] static Value concat(Value lhs, Value rhs);
 
     bool is_undefined() const { return std::holds_alternative<Undefined>(value_); }
     bool is_number() const { return std::holds_alternative<double>(value_); }
-    bool is_string() const { return std::holds_alternative<std::string>(value_); }
+    bool is_string() const {
+        return std::holds_alternative<std::shared_ptr<std::string const>>(value_)
+                || std::holds_alternative<std::shared_ptr<Rope>>(value_);
+    }
     bool is_function() const { return std::holds_alternative<std::shared_ptr<Function>>(value_); }
-    bool is_vector() const { return std::holds_alternative<std::vector<Value>>(value_); }
-    bool is_native_function() const { return std::holds_alternative<NativeFunction>(value_); }
+    bool is_vector() const { return std::holds_alternative<std::shared_ptr<std::vector<Value> const>>(value_); }
+    bool is_native_function() const { return std::holds_alternative<std::shared_ptr<NativeFunction const>>(value_); }
 
     double as_number() const { return std::get<double>(value_); }
-    std::string const &as_string() const { return std::get<std::string>(value_); }
+    std::string const &as_string() const;
     std::shared_ptr<Function const> as_function() const { return std::get<std::shared_ptr<Function>>(value_); }
-    std::vector<Value> const &as_vector() const { return std::get<std::vector<Value>>(value_); }
-    NativeFunction const &as_native_function() const { return std::get<NativeFunction>(value_); }
+    std::vector<Value> const &as_vector() const { return *std::get<std::shared_ptr<std::vector<Value> const>>(value_); }
+    NativeFunction const &as_native_function() const { return *std::get<std::shared_ptr<NativeFunction const>>(value_); }
 
     bool as_bool() const {
         // TODO(robinlinden): false, 0n, null, NaN, objects with an [[IsHTMLDDA]] internal slot.
@@ -86,15 +104,110 @@ public:
         return true;
     }
 
-    [[nodiscard]] bool operator==(Value const &) const = default;
+    [[nodiscard]] bool operator==(Value const &other) const {
+        // Strings and vectors compare by content, not by which allocation
+        // they happen to share. Native functions always compare unequal.
+        if (is_string() && other.is_string()) {
+            return as_string() == other.as_string();
+        }
+
+        if (value_.index() != other.value_.index()) {
+            return false;
+        }
+
+        if (is_vector()) {
+            return as_vector() == other.as_vector();
+        }
+
+        if (is_native_function()) {
+            return false;
+        }
+
+        return value_ == other.value_;
+    }
 
 private:
     struct Undefined {
         [[nodiscard]] bool operator==(Undefined const &) const = default;
     };
-    std::variant<Undefined, std::string, double, std::shared_ptr<Function>, std::vector<Value>, NativeFunction> value_;
+    struct Rope;
+    std::variant<Undefined,
+            std::shared_ptr<std::string const>,
+            double,
+            std::shared_ptr<Function>,
+            std::shared_ptr<std::vector<Value> const>,
+            std::shared_ptr<NativeFunction const>,
+            std::shared_ptr<Rope>>
+            value_;
+
+    std::size_t string_size() const;
+};
+
+struct Value::Rope {
+    Value lhs;
+    Value rhs;
+    std::size_t size{};
+    // Filled in lazily the first time the rope is read as a flat string.
+    std::shared_ptr<std::string const> flattened;
 };
 
+inline Value Value::concat(Value lhs, Value rhs) {
+    auto rope = std::make_shared<Rope>(
+            Rope{.lhs = std::move(lhs), .rhs = std::move(rhs)});
+    rope->size = rope->lhs.string_size() + rope->rhs.string_size();
+
+    Value value{};
+    value.value_ = std::move(rope);
+    return value;
+}
+
+inline std::size_t Value::string_size() const {
+    if (auto const *rope = std::get_if<std::shared_ptr<Rope>>(&value_)) {
+        return (*rope)->size;
+    }
+
+    return std::get<std::shared_ptr<std::string const>>(value_)->size();
+}
+
+inline std::string const &Value::as_string() const {
+    auto const *rope_ptr = std::get_if<std::shared_ptr<Rope>>(&value_);
+    if (rope_ptr == nullptr) {
+        return *std::get<std::shared_ptr<std::string const>>(value_);
+    }
+
+    auto &rope = **rope_ptr;
+    if (rope.flattened) {
+        return *rope.flattened;
+    }
+
+    std::string flat;
+    flat.reserve(rope.size);
+
+    // Depth-first, left to right, with an explicit stack: concatenation
+    // loops build very lopsided ropes.
+    std::vector<Value const *> stack{&rope.rhs, &rope.lhs};
+    while (!stack.empty()) {
+        auto const &value = *stack.back();
+        stack.pop_back();
+
+        if (auto const *child = std::get_if<std::shared_ptr<Rope>>(&value.value_)) {
+            if ((*child)->flattened) {
+                flat += *(*child)->flattened;
+                continue;
+            }
+
+            stack.push_back(&(*child)->rhs);
+            stack.push_back(&(*child)->lhs);
+            continue;
+        }
+
+        flat += *std::get<std::shared_ptr<std::string const>>(value.value_);
+    }
+
+    rope.flattened = std::make_shared<std::string const>(std::move(flat));
+    return *rope.flattened;
+}
+
 struct NumericLiteral {
     double value{0.};
 };
@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef JS_AST_ARENA_H_
+#define JS_AST_ARENA_H_
+
+#include "js/ast.h"
+
+#include <deque>
+#include <memory>
+#include <utility>
+
+namespace js::ast {
+
+// Owns the nodes of a program in a handful of chunked containers instead of
+// one heap allocation per node. The handles it hands out are aliasing
+// shared_ptrs into the arena, so they plug into the existing ast types
+// unchanged, there's no per-node control block, and the whole program is
+// freed in one go when the last handle is dropped.
+class AstArena {
+public:
+    [[nodiscard]] std::shared_ptr<Statement> statement(Statement node) {
+        return handle(block_->statements.emplace_back(std::move(node)));
+    }
+
+    [[nodiscard]] std::shared_ptr<Expression> expression(Expression node) {
+        return handle(block_->expressions.emplace_back(std::move(node)));
+    }
+
+    [[nodiscard]] std::shared_ptr<Function> function(Function node) {
+        return handle(block_->functions.emplace_back(std::move(node)));
+    }
+
+private:
+    // std::deque keeps references stable as nodes are added.
+    struct Block {
+        std::deque<Statement> statements;
+        std::deque<Expression> expressions;
+        std::deque<Function> functions;
+    };
+
+    template<typename T>
+    [[nodiscard]] std::shared_ptr<T> handle(T &node) const {
+        return std::shared_ptr<T>{block_, &node};
+    }
+
+    std::shared_ptr<Block> block_{std::make_shared<Block>()};
+};
+
+} // namespace js::ast
+
+#endif
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "js/ast_arena.h"
+
+#include "js/ast.h"
+#include "js/ast_executor.h"
+
+#include "etest/etest.h"
+
+#include <memory>
+
+using namespace js::ast;
+using etest::expect_eq;
+
+int main() {
+    etest::test("arena-built programs execute like any other", [] {
+        AstArena arena;
+        auto program = Program{.body{arena.statement(ExpressionStatement{BinaryExpression{
+                .op = BinaryOperator::Plus,
+                .lhs = arena.expression(NumericLiteral{11.}),
+                .rhs = arena.expression(NumericLiteral{31.}),
+        }})}};
+
+        AstExecutor e;
+        expect_eq(e.execute(*program.body[0]), Value{42.});
+    });
+
+    etest::test("handles keep the arena's nodes alive", [] {
+        std::shared_ptr<Statement> statement;
+        {
+            AstArena arena;
+            statement = arena.statement(ExpressionStatement{StringLiteral{"still here"}});
+        }
+
+        AstExecutor e;
+        expect_eq(e.execute(*statement), Value{"still here"});
+    });
+
+    return etest::run_all_tests();
+}
@@ -6,8 +6,10 @@
 #define JS_AST_EXECUTOR_H_
 
 #include "js/ast.h"
+#include "js/value_heap.h"
 
 #include <cassert>
+#include <memory>
 #include <functional>
 #include <map>
 #include <string>
@@ -23,9 +25,9 @@ public:
 
     Value operator()(Literal const &v) { return std::visit(*this, v); }
     Value operator()(NumericLiteral const &v) { return Value{v.value}; }
-    Value operator()(StringLiteral const &v) { return Value{v.value}; }
+    Value operator()(StringLiteral const &v) { return interned(v.value); }
     Value operator()(Expression const &v) { return std::visit(*this, v); }
-    Value operator()(Identifier const &v) { return Value{v.name}; }
+    Value operator()(Identifier const &v) { return interned(v.name); }
     Value operator()(Pattern const &v) { return std::visit(*this, v); }
     Value operator()(Declaration const &v) { return std::visit(*this, v); }
     Value operator()(Statement const &v) { return std::visit(*this, v); }
@@ -47,6 +49,10 @@ public:
 
         switch (v.op) {
             case BinaryOperator::Plus:
+                if (lhs.is_string() && rhs.is_string()) {
+                    return Value::concat(std::move(lhs), std::move(rhs));
+                }
+
                 return Value{lhs.as_number() + rhs.as_number()};
             case BinaryOperator::Minus:
                 return Value{lhs.as_number() - rhs.as_number()};
@@ -75,8 +81,11 @@ public:
 
     Value operator()(CallExpression const &v) {
         AstExecutor scope{*this};
+        // The cached call sites point into this executor's variables, so
+        // the callee's scope starts from a clean cache.
+        scope.call_sites_.clear();
 
-        auto const &fn = variables.at(execute(*v.callee).as_string());
+        auto const &fn = callee_of(v);
         assert(fn.is_function() || fn.is_native_function());
 
         std::vector<Value> args;
@@ -86,7 +95,7 @@ public:
         }
 
         // https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Functions/arguments
-        scope.variables["arguments"] = Value{std::move(args)};
+        scope.variables["arguments"] = heap_->vector(std::move(args));
         if (fn.is_function()) {
             return scope.execute(*fn.as_function());
         }
@@ -147,6 +156,43 @@ public:
 
     std::map<std::string, Value, std::less<>> variables;
     std::optional<Value> returning;
+
+private:
+    // Call sites overwhelmingly call the same function every time, so each
+    // site remembers where its callee lives in the scope instead of
+    // re-resolving the name per invocation. Map slots are stable once
+    // created and we never erase, so a later reassignment of the name is
+    // still seen through the cached slot.
+    Value const &callee_of(CallExpression const &v) {
+        if (auto it = call_sites_.find(&v); it != call_sites_.end()) {
+            return *it->second;
+        }
+
+        auto const &fn = variables.at(execute(*v.callee).as_string());
+        call_sites_.emplace(&v, &fn);
+        return fn;
+    }
+
+    std::map<CallExpression const *, Value const *> call_sites_;
+
+    // Identifiers and string literals are evaluated every time they're
+    // visited; interning them means each distinct string is allocated once
+    // per executor no matter how often a loop trips over it.
+    Value const &interned(std::string const &string) {
+        auto it = interned_strings_.find(string);
+        if (it == interned_strings_.end()) {
+            it = interned_strings_.emplace(string, heap_->string(string)).first;
+        }
+
+        return it->second;
+    }
+
+    std::map<std::string, Value, std::less<>> interned_strings_;
+
+    // String and vector payloads live here in pages, so values are handles
+    // and a scope unwinding doesn't cascade through payload destructors.
+    // Shared so the scopes spawned for calls allocate into the same pages.
+    std::shared_ptr<ValueHeap> heap_{std::make_shared<ValueHeap>()};
 };
 
 } // namespace js::ast
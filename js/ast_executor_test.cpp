@@ -33,6 +33,31 @@ int main() {
         expect_eq(e.execute(plus_expr), Value{42.});
     });
 
+    etest::test("call sites see reassigned callees", [] {
+        auto call = CallExpression{.callee = std::make_shared<Expression>(Identifier{"func"})};
+
+        AstExecutor e;
+        e.variables["func"] = Value{NativeFunction{[](auto const &) { return Value{1.}; }}};
+        expect_eq(e.execute(call), Value{1.});
+
+        // Resolving the same call expression again picks up the new callee.
+        e.variables["func"] = Value{NativeFunction{[](auto const &) { return Value{2.}; }}};
+        expect_eq(e.execute(call), Value{2.});
+    });
+
+    etest::test("binary expression, string concatenation", [] {
+        auto plus_expr = BinaryExpression{
+                .op = BinaryOperator::Plus,
+                .lhs = std::make_shared<Expression>(Identifier{"greeting"}),
+                .rhs = std::make_shared<Expression>(Identifier{"name"}),
+        };
+
+        AstExecutor e;
+        e.variables["greeting"] = Value{"hello, "};
+        e.variables["name"] = Value{"world"};
+        expect_eq(e.execute(plus_expr), Value{"hello, world"});
+    });
+
     etest::test("binary expression, identifiers", [] {
         auto plus_expr = BinaryExpression{
                 .op = BinaryOperator::Plus,
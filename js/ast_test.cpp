@@ -22,5 +22,20 @@ int main() {
         expect_eq(Value{std::vector<Value>{}}.as_bool(), true);
     });
 
+    etest::test("Value: concat", [] {
+        expect_eq(Value::concat(Value{"hello, "}, Value{"world"}), Value{"hello, world"});
+        expect_eq(Value::concat(Value{""}, Value{""}), Value{""});
+        expect_eq(Value::concat(Value{""}, Value{""}).as_bool(), false);
+
+        // Left-leaning ropes from concatenation loops flatten in order.
+        auto value = Value{""};
+        for (auto const *piece : {"a", "b", "c", "d"}) {
+            value = Value::concat(std::move(value), Value{piece});
+        }
+
+        expect_eq(value.as_string(), "abcd");
+        expect_eq(value, Value{"abcd"});
+    });
+
     return etest::run_all_tests();
 }
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef JS_BYTECODE_H_
+#define JS_BYTECODE_H_
+
+#include "js/ast.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace js::bytecode {
+
+// What a Program compiles into: a flat instruction array instead of a tree
+// of variants, so execution walks contiguous memory rather than chasing
+// shared_ptrs.
+enum class Opcode : std::uint8_t {
+    LoadConstant, // r[a] = constants[b]
+    Move, // r[a] = r[b]
+    Add, // r[a] = r[b] + r[c]
+    Subtract, // r[a] = r[b] - r[c]
+    GetVariable, // r[a] = variable named by constants[b]
+    SetVariable, // variable named by constants[a] = r[b]
+    GetLocal, // r[a] = locals[b]
+    SetLocal, // locals[a] = r[b]
+    Call, // r[a] = r[b] called with the c:th through (c + d - 1):th registers as arguments
+    Jump, // pc = a
+    JumpIfFalse, // pc = b unless r[a]
+    Return, // return r[a]
+    ReturnUndefined, // return undefined
+};
+
+struct Instruction {
+    Opcode op{};
+    std::uint16_t a{};
+    std::uint16_t b{};
+    std::uint16_t c{};
+    std::uint16_t d{};
+
+    [[nodiscard]] bool operator==(Instruction const &) const = default;
+};
+
+struct Chunk {
+    std::vector<Instruction> code{};
+    std::vector<ast::Value> constants{};
+    // How many registers the code needs. Register 0 is reserved for the
+    // completion value: the value of the last expression statement executed.
+    std::uint16_t register_count{};
+    // How many local slots the code needs. Parameters and declarations in
+    // function bodies get slots, so reading them is an index into the frame
+    // instead of a name lookup. The first slots hold the parameters.
+    std::uint16_t local_count{};
+};
+
+} // namespace js::bytecode
+
+#endif
@@ -0,0 +1,267 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef JS_BYTECODE_COMPILER_H_
+#define JS_BYTECODE_COMPILER_H_
+
+#include "js/ast.h"
+#include "js/bytecode.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace js::bytecode {
+
+// Lowers the ast into bytecode. Registers are allocated per statement with
+// a bump allocator: expression trees grab registers as they recurse and the
+// whole lot is reclaimed once the statement's done.
+class BytecodeCompiler {
+public:
+    [[nodiscard]] Chunk compile(ast::Program const &program) {
+        Chunk chunk{};
+        for (auto const &statement : program.body) {
+            compile_statement(chunk, *statement);
+        }
+
+        // The program's value is that of the last expression statement.
+        emit(chunk, {Opcode::Return, 0});
+        chunk.register_count = max_registers_;
+        return chunk;
+    }
+
+    [[nodiscard]] Chunk compile(ast::Function const &function) {
+        // Parameters and declarations in a function body can't be seen from
+        // the outside, so they live in indexed frame slots rather than the
+        // name-keyed scope. Program-level declarations stay name-keyed since
+        // the embedder reads them back out.
+        function_scope_ = true;
+        for (auto const &param : function.params) {
+            slot_for(std::get<ast::Identifier>(param).name);
+        }
+
+        Chunk chunk{};
+        for (auto const &statement : function.body.body) {
+            compile_statement(chunk, statement);
+        }
+
+        // Functions without a return statement produce undefined, not their
+        // last statement's value.
+        emit(chunk, {Opcode::ReturnUndefined});
+        chunk.register_count = max_registers_;
+        chunk.local_count = local_count_;
+        return chunk;
+    }
+
+private:
+    std::uint16_t next_register_{1};
+    std::uint16_t max_registers_{1};
+
+    bool function_scope_{};
+    std::map<std::string, std::uint16_t, std::less<>> local_slots_;
+    std::uint16_t local_count_{};
+
+    std::uint16_t slot_for(std::string const &name) {
+        auto it = local_slots_.find(name);
+        if (it == local_slots_.end()) {
+            it = local_slots_.emplace(name, local_count_++).first;
+        }
+
+        return it->second;
+    }
+
+    std::uint16_t allocate_register() {
+        auto reg = next_register_++;
+        max_registers_ = std::max<std::uint16_t>(max_registers_, next_register_);
+        return reg;
+    }
+
+    static std::size_t emit(Chunk &chunk, Instruction instruction) {
+        chunk.code.push_back(instruction);
+        return chunk.code.size() - 1;
+    }
+
+    static std::uint16_t add_constant(Chunk &chunk, ast::Value value) {
+        chunk.constants.push_back(std::move(value));
+        return static_cast<std::uint16_t>(chunk.constants.size() - 1);
+    }
+
+    void compile_statement(Chunk &chunk, ast::Statement const &statement) {
+        // Each statement starts from a clean register file; only register 0
+        // carries a value across statements.
+        next_register_ = 1;
+        std::visit([&](auto const &v) { compile(chunk, v); }, statement);
+    }
+
+    void compile(Chunk &chunk, ast::Declaration const &declaration) {
+        std::visit([&](auto const &v) { compile(chunk, v); }, declaration);
+    }
+
+    void compile(Chunk &chunk, ast::ExpressionStatement const &statement) {
+        emit(chunk, {Opcode::Move, 0, compile_expression(chunk, statement.expression)});
+    }
+
+    void compile(Chunk &chunk, ast::VariableDeclaration const &declaration) {
+        for (auto const &declarator : declaration.declarations) {
+            auto const &name = std::get<ast::Identifier>(declarator.id).name;
+            std::uint16_t value{};
+            if (declarator.init) {
+                value = compile_expression(chunk, *declarator.init);
+            } else {
+                value = allocate_register();
+                emit(chunk, {Opcode::LoadConstant, value, add_constant(chunk, ast::Value{})});
+            }
+
+            emit_store(chunk, name, value);
+        }
+    }
+
+    void compile(Chunk &chunk, ast::FunctionDeclaration const &declaration) {
+        auto function = allocate_register();
+        emit(chunk, {Opcode::LoadConstant, function, add_constant(chunk, ast::Value{declaration.function})});
+        emit_store(chunk, declaration.id.name, function);
+    }
+
+    void emit_store(Chunk &chunk, std::string const &name, std::uint16_t value) {
+        if (function_scope_) {
+            emit(chunk, {Opcode::SetLocal, slot_for(name), value});
+            return;
+        }
+
+        emit(chunk, {Opcode::SetVariable, add_constant(chunk, ast::Value{name}), value});
+    }
+
+    void compile(Chunk &, ast::BlockStatement const &) {
+        // TODO(robinlinden): Implement, like in AstExecutor.
+    }
+
+    void compile(Chunk &chunk, ast::ReturnStatement const &statement) {
+        if (statement.argument) {
+            emit(chunk, {Opcode::Return, compile_expression(chunk, *statement.argument)});
+            return;
+        }
+
+        emit(chunk, {Opcode::ReturnUndefined});
+    }
+
+    void compile(Chunk &chunk, ast::IfStatement const &statement) {
+        auto test = compile_expression(chunk, statement.test);
+        auto jump_to_else = emit(chunk, {Opcode::JumpIfFalse, test});
+        std::visit([&](auto const &v) { compile(chunk, v); }, *statement.if_branch);
+
+        if (statement.else_branch) {
+            auto jump_past_else = emit(chunk, {Opcode::Jump});
+            chunk.code[jump_to_else].b = static_cast<std::uint16_t>(chunk.code.size());
+            std::visit([&](auto const &v) { compile(chunk, v); }, **statement.else_branch);
+            chunk.code[jump_past_else].a = static_cast<std::uint16_t>(chunk.code.size());
+            return;
+        }
+
+        chunk.code[jump_to_else].b = static_cast<std::uint16_t>(chunk.code.size());
+    }
+
+    void compile(Chunk &chunk, ast::WhileStatement const &statement) {
+        auto loop_start = static_cast<std::uint16_t>(chunk.code.size());
+        auto test = compile_expression(chunk, statement.test);
+        auto jump_out = emit(chunk, {Opcode::JumpIfFalse, test});
+        std::visit([&](auto const &v) { compile(chunk, v); }, *statement.body);
+        emit(chunk, {Opcode::Jump, loop_start});
+        chunk.code[jump_out].b = static_cast<std::uint16_t>(chunk.code.size());
+    }
+
+    void compile(Chunk &, ast::EmptyStatement const &) {}
+
+    std::uint16_t compile_expression(Chunk &chunk, ast::Expression const &expression) {
+        return std::visit([&](auto const &v) { return compile(chunk, v); }, expression);
+    }
+
+    std::uint16_t compile(Chunk &chunk, ast::Literal const &literal) {
+        return std::visit([&](auto const &v) { return compile(chunk, v); }, literal);
+    }
+
+    std::uint16_t compile(Chunk &chunk, ast::NumericLiteral const &literal) {
+        auto reg = allocate_register();
+        emit(chunk, {Opcode::LoadConstant, reg, add_constant(chunk, ast::Value{literal.value})});
+        return reg;
+    }
+
+    std::uint16_t compile(Chunk &chunk, ast::StringLiteral const &literal) {
+        auto reg = allocate_register();
+        emit(chunk, {Opcode::LoadConstant, reg, add_constant(chunk, ast::Value{literal.value})});
+        return reg;
+    }
+
+    // A bare identifier evaluates to its own name, matching AstExecutor;
+    // only binary expressions and callees resolve identifiers as variables.
+    std::uint16_t compile(Chunk &chunk, ast::Identifier const &identifier) {
+        auto reg = allocate_register();
+        emit(chunk, {Opcode::LoadConstant, reg, add_constant(chunk, ast::Value{identifier.name})});
+        return reg;
+    }
+
+    std::uint16_t compile_resolving_variables(Chunk &chunk, ast::Expression const &expression) {
+        if (auto const *identifier = std::get_if<ast::Identifier>(&expression)) {
+            auto reg = allocate_register();
+            // Names declared in this function read straight out of their
+            // frame slot; everything else falls back to the scope lookup.
+            if (auto it = local_slots_.find(identifier->name); it != local_slots_.end()) {
+                emit(chunk, {Opcode::GetLocal, reg, it->second});
+            } else {
+                emit(chunk, {Opcode::GetVariable, reg, add_constant(chunk, ast::Value{identifier->name})});
+            }
+
+            return reg;
+        }
+
+        return compile_expression(chunk, expression);
+    }
+
+    std::uint16_t compile(Chunk &chunk, ast::BinaryExpression const &expression) {
+        auto lhs = compile_resolving_variables(chunk, *expression.lhs);
+        auto rhs = compile_resolving_variables(chunk, *expression.rhs);
+        auto reg = allocate_register();
+        switch (expression.op) {
+            case ast::BinaryOperator::Plus:
+                emit(chunk, {Opcode::Add, reg, lhs, rhs});
+                break;
+            case ast::BinaryOperator::Minus:
+                emit(chunk, {Opcode::Subtract, reg, lhs, rhs});
+                break;
+        }
+
+        return reg;
+    }
+
+    std::uint16_t compile(Chunk &chunk, ast::CallExpression const &expression) {
+        auto callee = compile_resolving_variables(chunk, *expression.callee);
+
+        // Arguments are evaluated first and then moved into consecutive
+        // registers, so the call can hand the callee a contiguous slice.
+        std::vector<std::uint16_t> argument_values;
+        argument_values.reserve(expression.arguments.size());
+        for (auto const &argument : expression.arguments) {
+            argument_values.push_back(compile_expression(chunk, *argument));
+        }
+
+        auto first_argument = next_register_;
+        for (auto value : argument_values) {
+            emit(chunk, {Opcode::Move, allocate_register(), value});
+        }
+
+        auto reg = allocate_register();
+        emit(chunk,
+                {Opcode::Call, reg, callee, first_argument, static_cast<std::uint16_t>(expression.arguments.size())});
+        return reg;
+    }
+};
+
+} // namespace js::bytecode
+
+#endif
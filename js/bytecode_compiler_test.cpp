@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "js/bytecode_compiler.h"
+
+#include "js/ast.h"
+#include "js/bytecode.h"
+
+#include "etest/etest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+using namespace js::ast;
+using js::bytecode::BytecodeCompiler;
+using js::bytecode::Opcode;
+
+using etest::expect;
+using etest::expect_eq;
+
+namespace {
+
+std::shared_ptr<Statement> stmt(Statement statement) {
+    return std::make_shared<Statement>(std::move(statement));
+}
+
+bool emits(js::bytecode::Chunk const &chunk, Opcode op) {
+    return std::ranges::any_of(chunk.code, [&](auto const &instruction) { return instruction.op == op; });
+}
+
+} // namespace
+
+int main() {
+    etest::test("program-level declarations stay name-keyed", [] {
+        auto declaration = VariableDeclaration{{
+                VariableDeclarator{
+                        .id = Identifier{"a"},
+                        .init = NumericLiteral{1.},
+                },
+        }};
+
+        auto chunk = BytecodeCompiler{}.compile(Program{.body{stmt(std::move(declaration))}});
+        expect(emits(chunk, Opcode::SetVariable));
+        expect(!emits(chunk, Opcode::SetLocal));
+        expect_eq(chunk.local_count, std::uint16_t{0});
+    });
+
+    etest::test("function parameters and declarations get frame slots", [] {
+        auto body = VariableDeclaration{{
+                VariableDeclarator{
+                        .id = Identifier{"sum"},
+                        .init = BinaryExpression{
+                                .op = BinaryOperator::Plus,
+                                .lhs = std::make_shared<Expression>(Identifier{"one"}),
+                                .rhs = std::make_shared<Expression>(Identifier{"two"}),
+                        },
+                },
+        }};
+
+        auto chunk = BytecodeCompiler{}.compile(Function{
+                .params{Identifier{"one"}, Identifier{"two"}},
+                .body{{std::move(body)}},
+        });
+
+        // The parameters occupy the first slots, and both they and the local
+        // declaration are accessed by index rather than by name.
+        expect_eq(chunk.local_count, std::uint16_t{3});
+        expect(emits(chunk, Opcode::GetLocal));
+        expect(emits(chunk, Opcode::SetLocal));
+        expect(!emits(chunk, Opcode::GetVariable));
+        expect(!emits(chunk, Opcode::SetVariable));
+    });
+
+    etest::test("names not declared in the function fall back to the scope", [] {
+        auto body = ReturnStatement{BinaryExpression{
+                .op = BinaryOperator::Plus,
+                .lhs = std::make_shared<Expression>(Identifier{"local"}),
+                .rhs = std::make_shared<Expression>(Identifier{"outer"}),
+        }};
+
+        auto chunk = BytecodeCompiler{}.compile(Function{
+                .params{Identifier{"local"}},
+                .body{{std::move(body)}},
+        });
+
+        expect(emits(chunk, Opcode::GetLocal));
+        expect(emits(chunk, Opcode::GetVariable));
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,141 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef JS_BYTECODE_VM_H_
+#define JS_BYTECODE_VM_H_
+
+#include "js/ast.h"
+#include "js/bytecode.h"
+#include "js/bytecode_compiler.h"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace js::bytecode {
+
+// Executes compiled chunks against a contiguous register file. Functions
+// are compiled the first time they're called and the chunks cached, so hot
+// functions only pay for the lowering once.
+class BytecodeVm {
+public:
+    ast::Value run(ast::Program const &program) { return run(BytecodeCompiler{}.compile(program)); }
+    ast::Value run(Chunk const &chunk) { return run(chunk, variables); }
+
+    std::map<std::string, ast::Value, std::less<>> variables;
+
+private:
+    std::map<ast::Function const *, Chunk> compiled_functions_;
+
+    ast::Value run(Chunk const &chunk,
+            std::map<std::string, ast::Value, std::less<>> &scope,
+            std::vector<ast::Value> locals = {}) {
+        std::vector<ast::Value> registers(chunk.register_count);
+        locals.resize(chunk.local_count);
+
+        for (std::size_t pc = 0; pc < chunk.code.size();) {
+            auto const &instruction = chunk.code[pc++];
+            switch (instruction.op) {
+                case Opcode::LoadConstant:
+                    registers[instruction.a] = chunk.constants[instruction.b];
+                    break;
+                case Opcode::Move:
+                    registers[instruction.a] = registers[instruction.b];
+                    break;
+                case Opcode::Add: {
+                    auto const &lhs = registers[instruction.b];
+                    auto const &rhs = registers[instruction.c];
+                    if (lhs.is_string() && rhs.is_string()) {
+                        registers[instruction.a] = ast::Value::concat(lhs, rhs);
+                        break;
+                    }
+
+                    registers[instruction.a] = ast::Value{lhs.as_number() + rhs.as_number()};
+                    break;
+                }
+                case Opcode::Subtract:
+                    registers[instruction.a] =
+                            ast::Value{registers[instruction.b].as_number() - registers[instruction.c].as_number()};
+                    break;
+                case Opcode::GetVariable:
+                    registers[instruction.a] = scope.at(chunk.constants[instruction.b].as_string());
+                    break;
+                case Opcode::SetVariable:
+                    scope[chunk.constants[instruction.a].as_string()] = registers[instruction.b];
+                    break;
+                case Opcode::GetLocal:
+                    registers[instruction.a] = locals[instruction.b];
+                    break;
+                case Opcode::SetLocal:
+                    locals[instruction.a] = registers[instruction.b];
+                    break;
+                case Opcode::Call: {
+                    std::vector<ast::Value> arguments{registers.begin() + instruction.c,
+                            registers.begin() + instruction.c + instruction.d};
+                    registers[instruction.a] = call(registers[instruction.b], std::move(arguments), scope);
+                    break;
+                }
+                case Opcode::Jump:
+                    pc = instruction.a;
+                    break;
+                case Opcode::JumpIfFalse:
+                    if (!registers[instruction.a].as_bool()) {
+                        pc = instruction.b;
+                    }
+                    break;
+                case Opcode::Return:
+                    return registers[instruction.a];
+                case Opcode::ReturnUndefined:
+                    return ast::Value{};
+            }
+        }
+
+        return ast::Value{};
+    }
+
+    ast::Value call(ast::Value const &callee,
+            std::vector<ast::Value> arguments,
+            std::map<std::string, ast::Value, std::less<>> const &caller_scope) {
+        assert(callee.is_function() || callee.is_native_function());
+
+        if (callee.is_native_function()) {
+            return callee.as_native_function().f(arguments);
+        }
+
+        // Like AstExecutor, the function scope starts as a copy of the
+        // caller's, but the parameters go into the frame's local slots
+        // rather than the name-keyed scope.
+        auto function = callee.as_function();
+        auto const &chunk = compiled(*function);
+        auto scope = caller_scope;
+
+        std::vector<ast::Value> locals(chunk.local_count);
+        for (std::size_t i = 0; i < function->params.size() && i < arguments.size(); ++i) {
+            locals[i] = arguments[i];
+        }
+
+        // https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Functions/arguments
+        scope["arguments"] = ast::Value{std::move(arguments)};
+
+        return run(chunk, scope, std::move(locals));
+    }
+
+    Chunk const &compiled(ast::Function const &function) {
+        auto it = compiled_functions_.find(&function);
+        if (it == compiled_functions_.end()) {
+            it = compiled_functions_.emplace(&function, BytecodeCompiler{}.compile(function)).first;
+        }
+
+        return it->second;
+    }
+};
+
+} // namespace js::bytecode
+
+#endif
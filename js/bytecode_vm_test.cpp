@@ -0,0 +1,250 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "js/bytecode_vm.h"
+
+#include "js/ast.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+using namespace js::ast;
+using js::bytecode::BytecodeVm;
+
+using etest::expect_eq;
+using etest::require_eq;
+
+namespace {
+
+std::shared_ptr<Statement> stmt(Statement statement) {
+    return std::make_shared<Statement>(std::move(statement));
+}
+
+} // namespace
+
+int main() {
+    etest::test("literals", [] {
+        BytecodeVm vm;
+        expect_eq(vm.run(Program{.body{stmt(ExpressionStatement{NumericLiteral{5.}})}}), Value{5.});
+        expect_eq(vm.run(Program{.body{stmt(ExpressionStatement{StringLiteral{"hello"}})}}), Value{"hello"});
+    });
+
+    etest::test("binary expressions", [] {
+        auto plus = ExpressionStatement{BinaryExpression{
+                .op = BinaryOperator::Plus,
+                .lhs = std::make_shared<Expression>(NumericLiteral{11.}),
+                .rhs = std::make_shared<Expression>(NumericLiteral{31.}),
+        }};
+        auto minus = ExpressionStatement{BinaryExpression{
+                .op = BinaryOperator::Minus,
+                .lhs = std::make_shared<Expression>(NumericLiteral{11.}),
+                .rhs = std::make_shared<Expression>(NumericLiteral{31.}),
+        }};
+
+        BytecodeVm vm;
+        expect_eq(vm.run(Program{.body{stmt(ExpressionStatement{std::move(plus.expression)})}}), Value{42.});
+        expect_eq(vm.run(Program{.body{stmt(ExpressionStatement{std::move(minus.expression)})}}), Value{-20.});
+    });
+
+    etest::test("binary expression, identifiers", [] {
+        auto plus = ExpressionStatement{BinaryExpression{
+                .op = BinaryOperator::Plus,
+                .lhs = std::make_shared<Expression>(Identifier{"eleven"}),
+                .rhs = std::make_shared<Expression>(Identifier{"thirtyone"}),
+        }};
+
+        BytecodeVm vm;
+        vm.variables["eleven"] = Value{11.};
+        vm.variables["thirtyone"] = Value{31.};
+        expect_eq(vm.run(Program{.body{stmt(std::move(plus))}}), Value{42.});
+    });
+
+    etest::test("binary expression, string concatenation", [] {
+        auto plus = ExpressionStatement{BinaryExpression{
+                .op = BinaryOperator::Plus,
+                .lhs = std::make_shared<Expression>(Identifier{"greeting"}),
+                .rhs = std::make_shared<Expression>(Identifier{"name"}),
+        }};
+
+        BytecodeVm vm;
+        vm.variables["greeting"] = Value{"hello, "};
+        vm.variables["name"] = Value{"world"};
+        expect_eq(vm.run(Program{.body{stmt(std::move(plus))}}), Value{"hello, world"});
+    });
+
+    etest::test("variable declaration", [] {
+        auto declaration = VariableDeclaration{{
+                VariableDeclarator{
+                        .id = Identifier{"a"},
+                        .init = NumericLiteral{1.},
+                },
+                VariableDeclarator{
+                        .id = Identifier{"b"},
+                },
+        }};
+
+        BytecodeVm vm;
+        expect_eq(vm.run(Program{.body{stmt(std::move(declaration))}}), Value{});
+        expect_eq(vm.variables, decltype(vm.variables){{"a", Value{1.}}, {"b", Value{}}});
+    });
+
+    etest::test("function call, arguments", [] {
+        auto function_body = ReturnStatement{BinaryExpression{
+                .op = BinaryOperator::Plus,
+                .lhs = std::make_shared<Expression>(Identifier{"one"}),
+                .rhs = std::make_shared<Expression>(Identifier{"two"}),
+        }};
+
+        auto declaration = FunctionDeclaration{
+                .id = Identifier{"func"},
+                .function = std::make_shared<Function>(Function{
+                        .params{Identifier{"one"}, Identifier{"two"}},
+                        .body{{std::move(function_body)}},
+                }),
+        };
+
+        auto call = ExpressionStatement{CallExpression{
+                .callee = std::make_shared<Expression>(Identifier{"func"}),
+                .arguments{
+                        std::make_shared<Expression>(NumericLiteral{13.}),
+                        std::make_shared<Expression>(NumericLiteral{4.}),
+                },
+        }};
+
+        BytecodeVm vm;
+        expect_eq(vm.run(Program{.body{stmt(std::move(declaration)), stmt(std::move(call))}}), Value{13. + 4.});
+
+        // The only variable in scope should be the function we declared.
+        expect_eq(vm.variables.size(), std::size_t{1});
+    });
+
+    etest::test("function locals don't leak into the outer scope", [] {
+        auto body = VariableDeclaration{{
+                VariableDeclarator{
+                        .id = Identifier{"local"},
+                        .init = BinaryExpression{
+                                .op = BinaryOperator::Plus,
+                                .lhs = std::make_shared<Expression>(Identifier{"arg"}),
+                                .rhs = std::make_shared<Expression>(Identifier{"outer"}),
+                        },
+                },
+        }};
+
+        auto declaration = FunctionDeclaration{
+                .id = Identifier{"func"},
+                .function = std::make_shared<Function>(Function{
+                        .params{Identifier{"arg"}},
+                        .body{{
+                                std::move(body),
+                                ReturnStatement{BinaryExpression{
+                                        .op = BinaryOperator::Plus,
+                                        .lhs = std::make_shared<Expression>(Identifier{"local"}),
+                                        .rhs = std::make_shared<Expression>(NumericLiteral{1.}),
+                                }},
+                        }},
+                }),
+        };
+
+        auto call = ExpressionStatement{CallExpression{
+                .callee = std::make_shared<Expression>(Identifier{"func"}),
+                .arguments{std::make_shared<Expression>(NumericLiteral{2.})},
+        }};
+
+        BytecodeVm vm;
+        vm.variables["outer"] = Value{10.};
+        expect_eq(vm.run(Program{.body{stmt(std::move(declaration)), stmt(std::move(call))}}), Value{13.});
+
+        // Parameters and declarations inside the function live in frame
+        // slots, so only "func" and "outer" remain visible.
+        expect_eq(vm.variables.size(), std::size_t{2});
+    });
+
+    etest::test("return, function execution is ended", [] {
+        auto declaration = FunctionDeclaration{
+                .id = Identifier{"func"},
+                .function = std::make_shared<Function>(Function{
+                        .params{},
+                        .body{{
+                                ReturnStatement{},
+                                ReturnStatement{NumericLiteral{42.}},
+                        }},
+                }),
+        };
+
+        auto call = ExpressionStatement{CallExpression{.callee = std::make_shared<Expression>(Identifier{"func"})}};
+
+        BytecodeVm vm;
+        expect_eq(vm.run(Program{.body{stmt(std::move(declaration)), stmt(std::move(call))}}), Value{});
+    });
+
+    etest::test("if", [] {
+        auto if_stmt = IfStatement{
+                .test = NumericLiteral{1},
+                .if_branch = stmt(ExpressionStatement{StringLiteral{"true!"}}),
+        };
+
+        BytecodeVm vm;
+        expect_eq(vm.run(Program{.body{stmt(if_stmt)}}), Value{"true!"});
+
+        if_stmt.test = NumericLiteral{0};
+        expect_eq(vm.run(Program{.body{stmt(if_stmt)}}), Value{});
+    });
+
+    etest::test("if-else", [] {
+        auto if_stmt = IfStatement{
+                .test = NumericLiteral{1},
+                .if_branch = stmt(ExpressionStatement{StringLiteral{"true!"}}),
+                .else_branch = stmt(ExpressionStatement{StringLiteral{"false!"}}),
+        };
+
+        BytecodeVm vm;
+        expect_eq(vm.run(Program{.body{stmt(if_stmt)}}), Value{"true!"});
+
+        if_stmt.test = NumericLiteral{0};
+        expect_eq(vm.run(Program{.body{stmt(if_stmt)}}), Value{"false!"});
+    });
+
+    etest::test("native function", [] {
+        BytecodeVm vm;
+
+        std::string argument{};
+        vm.variables["set_string_and_get_42"] = Value{NativeFunction{[&](auto args) {
+            require_eq(args.size(), std::size_t{1});
+            argument = args[0].as_string();
+            return Value{42};
+        }}};
+
+        auto call = ExpressionStatement{CallExpression{
+                .callee = std::make_shared<Expression>(Identifier{"set_string_and_get_42"}),
+                .arguments{std::make_shared<Expression>(StringLiteral{"did it!"})},
+        }};
+
+        expect_eq(vm.run(Program{.body{stmt(std::move(call))}}), Value{42});
+        expect_eq(argument, "did it!");
+    });
+
+    etest::test("while statement", [] {
+        BytecodeVm vm;
+
+        int loop_count{};
+        vm.variables["should_continue"] = Value{NativeFunction{[&](auto const &args) {
+            expect_eq(args.size(), std::size_t{0});
+            return Value{++loop_count < 3 ? 1. : 0.};
+        }}};
+
+        auto while_loop = WhileStatement{
+                .test = CallExpression{.callee = std::make_shared<Expression>(Identifier{"should_continue"})},
+                .body = stmt(EmptyStatement{}),
+        };
+
+        expect_eq(vm.run(Program{.body{stmt(std::move(while_loop))}}), Value{});
+        expect_eq(loop_count, 3);
+    });
+
+    return etest::run_all_tests();
+}
@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "js/ast.h"
+#include "js/ast_executor.h"
+#include "js/bytecode_vm.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+using namespace js::ast;
+
+namespace {
+
+std::shared_ptr<Statement> stmt(Statement statement) {
+    return std::make_shared<Statement>(std::move(statement));
+}
+
+std::shared_ptr<Expression> expr(Expression expression) {
+    return std::make_shared<Expression>(std::move(expression));
+}
+
+// The loops can't count on their own as we have no comparison operators
+// yet, so every workload spins on a native function that trips after the
+// requested number of iterations.
+Expression go_test() {
+    return CallExpression{.callee = expr(Identifier{"go"})};
+}
+
+// var sum = 0; while (go()) { var sum = sum + 1; }
+Program arithmetic_program() {
+    return Program{.body{
+            stmt(VariableDeclaration{{VariableDeclarator{.id = Identifier{"sum"}, .init = NumericLiteral{0.}}}}),
+            stmt(WhileStatement{
+                    .test = go_test(),
+                    .body = stmt(VariableDeclaration{{VariableDeclarator{
+                            .id = Identifier{"sum"},
+                            .init = BinaryExpression{
+                                    .op = BinaryOperator::Plus,
+                                    .lhs = expr(Identifier{"sum"}),
+                                    .rhs = expr(NumericLiteral{1.}),
+                            },
+                    }}}),
+            }),
+    }};
+}
+
+// function add(a, b) { return a + b; }
+// function twice(x) { return add(x + 1, 1); }
+// while (go()) { twice(1); }
+//
+// Identifiers only resolve as variables inside binary expressions and
+// callees, so the parameter is threaded through an addition rather than
+// passed along bare.
+Program call_program() {
+    auto add = FunctionDeclaration{
+            .id = Identifier{"add"},
+            .function = std::make_shared<Function>(Function{
+                    .params{Identifier{"a"}, Identifier{"b"}},
+                    .body{{ReturnStatement{BinaryExpression{
+                            .op = BinaryOperator::Plus,
+                            .lhs = expr(Identifier{"a"}),
+                            .rhs = expr(Identifier{"b"}),
+                    }}}},
+            }),
+    };
+
+    auto twice = FunctionDeclaration{
+            .id = Identifier{"twice"},
+            .function = std::make_shared<Function>(Function{
+                    .params{Identifier{"x"}},
+                    .body{{ReturnStatement{CallExpression{
+                            .callee = expr(Identifier{"add"}),
+                            .arguments{
+                                    expr(BinaryExpression{
+                                            .op = BinaryOperator::Plus,
+                                            .lhs = expr(Identifier{"x"}),
+                                            .rhs = expr(NumericLiteral{1.}),
+                                    }),
+                                    expr(NumericLiteral{1.}),
+                            },
+                    }}}},
+            }),
+    };
+
+    return Program{.body{
+            stmt(std::move(add)),
+            stmt(std::move(twice)),
+            stmt(WhileStatement{
+                    .test = go_test(),
+                    .body = stmt(ExpressionStatement{CallExpression{
+                            .callee = expr(Identifier{"twice"}),
+                            .arguments{expr(NumericLiteral{1.})},
+                    }}),
+            }),
+    }};
+}
+
+// var s = ""; while (go()) { var s = s + "0123456789abcdef"; }
+Program string_program() {
+    return Program{.body{
+            stmt(VariableDeclaration{{VariableDeclarator{.id = Identifier{"s"}, .init = StringLiteral{""}}}}),
+            stmt(WhileStatement{
+                    .test = go_test(),
+                    .body = stmt(VariableDeclaration{{VariableDeclarator{
+                            .id = Identifier{"s"},
+                            .init = BinaryExpression{
+                                    .op = BinaryOperator::Plus,
+                                    .lhs = expr(Identifier{"s"}),
+                                    .rhs = expr(StringLiteral{"0123456789abcdef"}),
+                            },
+                    }}}),
+            }),
+    }};
+}
+
+Value go_function(int iterations) {
+    auto count = std::make_shared<int>(0);
+    return Value{NativeFunction{[count, iterations](auto const &) { //
+        return Value{++*count <= iterations ? 1. : 0.};
+    }}};
+}
+
+void run_ast(Program const &program, int iterations) {
+    AstExecutor e;
+    e.variables["go"] = go_function(iterations);
+    for (auto const &statement : program.body) {
+        e.execute(*statement);
+    }
+}
+
+void run_bytecode(Program const &program, int iterations) {
+    js::bytecode::BytecodeVm vm;
+    vm.variables["go"] = go_function(iterations);
+    vm.run(program);
+}
+
+void benchmark(std::string_view name, int iterations, std::function<void()> const &run, int repetitions = 5) {
+    auto best = std::chrono::nanoseconds::max();
+    for (int i = 0; i < repetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::steady_clock::now() - start);
+    }
+
+    auto seconds = std::chrono::duration<double>(best).count();
+    fmt::print("{}: {} iterations, {:.3f} ms, {:.0f} ops/s\n",
+            name,
+            iterations,
+            seconds * 1000.,
+            static_cast<double>(iterations) / seconds);
+}
+
+} // namespace
+
+int main() {
+    auto arithmetic = arithmetic_program();
+    auto calls = call_program();
+    auto strings = string_program();
+
+    constexpr int kArithmeticIterations = 100'000;
+    constexpr int kCallIterations = 20'000;
+    constexpr int kStringIterations = 20'000;
+
+    benchmark("arithmetic loop, ast", kArithmeticIterations, [&] { run_ast(arithmetic, kArithmeticIterations); });
+    benchmark("arithmetic loop, bytecode", kArithmeticIterations, [&] {
+        run_bytecode(arithmetic, kArithmeticIterations);
+    });
+
+    benchmark("nested calls, ast", kCallIterations, [&] { run_ast(calls, kCallIterations); });
+    benchmark("nested calls, bytecode", kCallIterations, [&] { run_bytecode(calls, kCallIterations); });
+
+    benchmark("string building, ast", kStringIterations, [&] { run_ast(strings, kStringIterations); });
+    benchmark("string building, bytecode", kStringIterations, [&] { run_bytecode(strings, kStringIterations); });
+}
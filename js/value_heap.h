@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef JS_VALUE_HEAP_H_
+#define JS_VALUE_HEAP_H_
+
+#include "js/ast.h"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace js {
+
+// Owns string and vector payloads for ast::Values in pages instead of one
+// shared_ptr control block and allocation per payload. Allocation appends to
+// the current page, and the handles handed out are aliasing shared_ptrs into
+// it, so dropping a deep value tree — e.g. a scope's variables unwinding —
+// only decrements page refcounts instead of cascading through payload
+// destructors. A page's payloads are destroyed together once nothing
+// references the page anymore; vectors holding handles into other pages keep
+// those pages alive, and values are immutable so there are no cycles to
+// collect.
+class ValueHeap {
+public:
+    [[nodiscard]] ast::Value string(std::string value) {
+        return ast::Value{handle(page().strings.emplace_back(std::move(value)))};
+    }
+
+    [[nodiscard]] ast::Value vector(std::vector<ast::Value> value) {
+        return ast::Value{handle(page().vectors.emplace_back(std::move(value)))};
+    }
+
+private:
+    // Small enough that a sealed page whose values have died doesn't pin
+    // much memory, big enough that the per-page overhead doesn't matter.
+    static constexpr std::size_t kPayloadsPerPage = 512;
+
+    // std::deque keeps references stable as payloads are added.
+    struct Page {
+        std::deque<std::string> strings;
+        std::deque<std::vector<ast::Value>> vectors;
+        [[nodiscard]] std::size_t size() const { return strings.size() + vectors.size(); }
+    };
+
+    // Full pages are sealed: the heap lets go of them and their lifetime is
+    // carried by the values still pointing into them, so a long-running
+    // executor doesn't accumulate dead payloads on one immortal page.
+    Page &page() {
+        if (page_ == nullptr || page_->size() >= kPayloadsPerPage) {
+            page_ = std::make_shared<Page>();
+        }
+        return *page_;
+    }
+
+    template<typename T>
+    [[nodiscard]] std::shared_ptr<T const> handle(T const &payload) const {
+        return std::shared_ptr<T const>{page_, &payload};
+    }
+
+    std::shared_ptr<Page> page_{};
+};
+
+} // namespace js
+
+#endif
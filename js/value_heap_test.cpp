@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "js/value_heap.h"
+
+#include "js/ast.h"
+
+#include "etest/etest.h"
+
+#include <string>
+#include <vector>
+
+using namespace js::ast;
+using etest::expect_eq;
+
+int main() {
+    etest::test("heap values behave like plainly allocated ones", [] {
+        js::ValueHeap heap;
+        auto str = heap.string("hello");
+        expect_eq(str, Value{"hello"});
+
+        auto vec = heap.vector({Value{1.}, str});
+        expect_eq(vec.as_vector().size(), std::size_t{2});
+        expect_eq(vec.as_vector()[1], Value{"hello"});
+    });
+
+    etest::test("values outlive the heap", [] {
+        Value value;
+        {
+            js::ValueHeap heap;
+            value = heap.vector({heap.string("still"), heap.string("here")});
+        }
+
+        expect_eq(value.as_vector()[0], Value{"still"});
+        expect_eq(value.as_vector()[1], Value{"here"});
+    });
+
+    etest::test("pages seal and stay valid as the heap grows", [] {
+        js::ValueHeap heap;
+        std::vector<Value> values;
+        for (int i = 0; i < 2000; ++i) {
+            values.push_back(heap.string(std::to_string(i)));
+        }
+
+        expect_eq(values[0], Value{"0"});
+        expect_eq(values[1024], Value{"1024"});
+        expect_eq(values[1999], Value{"1999"});
+    });
+
+    return etest::run_all_tests();
+}
@@ -7,19 +7,27 @@
 
 #include "util/from_chars.h"
 #include "util/overloaded.h"
+#include "util/trace.h"
 
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <charconv>
+#include <cstddef>
 #include <cstdlib>
+#include <functional>
+#include <future>
 #include <map>
 #include <optional>
-#include <sstream>
+#include <iterator>
+#include <limits>
+#include <string>
 #include <string_view>
 #include <system_error>
+#include <thread>
 #include <utility>
 #include <variant>
 
@@ -43,6 +51,9 @@ std::optional<LayoutBox> create_tree(style::StyledNode const &node) {
 
                 LayoutBox box{&node, display == style::DisplayValue::Inline ? LayoutType::Inline : LayoutType::Block};
 
+                // Upper bound: display-none children don't get boxes, and
+                // inline children may get folded into one anonymous block.
+                box.children.reserve(node.children.size());
                 for (auto const &child : node.children) {
                     auto child_box = create_tree(child);
                     if (!child_box) {
@@ -70,6 +81,85 @@ std::optional<LayoutBox> create_tree(style::StyledNode const &node) {
     return std::visit(visitor, node.node);
 }
 
+struct TextMeasurement {
+    int width{};
+    std::vector<LayoutBox::TextSegment> segments;
+};
+
+std::map<std::pair<std::size_t, int>, TextMeasurement> &text_measurement_cache() {
+    static thread_local std::map<std::pair<std::size_t, int>, TextMeasurement> cache;
+    return cache;
+}
+
+// One segment per whitespace-delimited word, with newlines marked as forced
+// breaks. TODO(robinlinden): Unicode break opportunities.
+std::vector<LayoutBox::TextSegment> break_opportunities(std::string_view text) {
+    std::vector<LayoutBox::TextSegment> segments;
+    int chars = 0;
+    for (char c : text) {
+        if (c == '\n') {
+            // Blank lines become empty segments so they still take a line.
+            segments.push_back({chars, true});
+            chars = 0;
+        } else if (c == ' ' || c == '\t') {
+            if (chars > 0) {
+                segments.push_back({chars, false});
+                chars = 0;
+            }
+        } else {
+            ++chars;
+        }
+    }
+
+    if (chars > 0) {
+        segments.push_back({chars, false});
+    }
+
+    return segments;
+}
+
+// We lay the page out again on every resize tick, so measurements of
+// unchanged text are remembered across passes. Keyed by content hash and font
+// size rather than the text itself to keep the keys small.
+TextMeasurement const &measure_text(std::string_view text, int font_size) {
+    auto key = std::pair{std::hash<std::string_view>{}(text), font_size};
+    auto &cache = text_measurement_cache();
+    if (auto it = cache.find(key); it != end(cache)) {
+        return it->second;
+    }
+
+    // TODO(robinlinden): Measure the text for real.
+    TextMeasurement measurement{
+            static_cast<int>(text.size()) * font_size / 2,
+            break_opportunities(text),
+    };
+    return cache.emplace(key, std::move(measurement)).first->second;
+}
+
+// Greedy line breaking over precomputed segments: words go onto the current
+// line while they fit and a word that doesn't starts the next one. A re-flow
+// at a new width is one walk over the segment list, no text scanning.
+int line_count(std::vector<LayoutBox::TextSegment> const &segments, int font_size, int available_width) {
+    int lines = 1;
+    int line_chars = 0;
+    for (auto const &segment : segments) {
+        int const needed = line_chars == 0 ? segment.chars : line_chars + 1 + segment.chars;
+        if (line_chars == 0 || needed * font_size / 2 <= available_width) {
+            line_chars = needed;
+        } else {
+            ++lines;
+            line_chars = segment.chars;
+        }
+
+        if (segment.forced_break_after) {
+            ++lines;
+            line_chars = 0;
+        }
+    }
+
+    return lines;
+}
+
 // TODO(robinlinden):
 // * margin, border, etc.
 // * Not all measurements have to be in pixels.
@@ -126,10 +216,13 @@ void calculate_left_and_right_margin(LayoutBox &box,
 void calculate_width_and_margin(LayoutBox &box, geom::Rect const &parent, int const font_size) {
     assert(box.node != nullptr);
 
-    if (std::holds_alternative<dom::Text>(box.node->node)) {
-        // TODO(robinlinden): Measure the text for real.
-        auto text_node = std::get<dom::Text>(box.node->node);
-        box.dimensions.content.width = std::min(parent.width, static_cast<int>(text_node.text.size()) * font_size / 2);
+    if (auto const *text = std::get_if<dom::Text>(&box.node->node)) {
+        if (!box.text_metrics) {
+            auto const &measurement = measure_text(text->text, font_size);
+            box.text_metrics = LayoutBox::TextMetrics{measurement.width, measurement.segments};
+        }
+
+        box.dimensions.content.width = std::min(parent.width, box.text_metrics->width);
         return;
     }
 
@@ -184,8 +277,15 @@ void calculate_position(LayoutBox &box, geom::Rect const &parent) {
 void calculate_height(LayoutBox &box, int const font_size) {
     assert(box.node != nullptr);
     if (auto const *text = std::get_if<dom::Text>(&box.node->node)) {
-        int lines = static_cast<int>(std::ranges::count(text->text, '\n')) + 1;
-        box.dimensions.content.height = lines * font_size;
+        if (!box.text_metrics) {
+            auto const &measurement = measure_text(text->text, font_size);
+            box.text_metrics = LayoutBox::TextMetrics{measurement.width, measurement.segments};
+        }
+
+        // The width pass capped the content width at what's available, so
+        // wrapping to it only kicks in for text wider than its container.
+        box.dimensions.content.height =
+                line_count(box.text_metrics->segments, font_size, box.dimensions.content.width) * font_size;
     }
 
     if (auto height = box.get_property<css::PropertyId::Height>(); height && height != "auto") {
@@ -259,6 +359,54 @@ void calculate_border(LayoutBox &box, int const font_size) {
     }
 }
 
+void layout(LayoutBox &box, geom::Rect const &bounds);
+
+void translate_subtree(LayoutBox &box, int dy) {
+    box.dimensions.content.y += dy;
+    for (auto &child : box.children) {
+        translate_subtree(child, dy);
+    }
+}
+
+// Boxes with at least this many children have them laid out on multiple
+// cores.
+constexpr std::size_t kParallelChildThreshold{128};
+
+void layout_children(LayoutBox &box) {
+    if (box.children.size() < kParallelChildThreshold) {
+        for (auto &child : box.children) {
+            layout(child, box.dimensions.content);
+            box.dimensions.content.height += child.dimensions.margin_box().height;
+        }
+
+        return;
+    }
+
+    // Siblings in normal flow only interact through the y offset each one is
+    // placed at, so they can all be measured in parallel at offset 0 and then
+    // shifted into place by a cheap sequential fix-up pass.
+    auto worker_count = std::max(std::thread::hardware_concurrency(), 1u);
+    auto chunk_size = (box.children.size() + worker_count - 1) / worker_count;
+    std::vector<std::future<void>> workers;
+    for (std::size_t begin = 0; begin < box.children.size(); begin += chunk_size) {
+        auto end = std::min(begin + chunk_size, box.children.size());
+        workers.push_back(std::async(std::launch::async, [&box, begin, end] {
+            for (std::size_t i = begin; i < end; ++i) {
+                layout(box.children[i], box.dimensions.content);
+            }
+        }));
+    }
+
+    for (auto &worker : workers) {
+        worker.get();
+    }
+
+    for (auto &child : box.children) {
+        translate_subtree(child, box.dimensions.content.height);
+        box.dimensions.content.height += child.dimensions.margin_box().height;
+    }
+}
+
 void layout(LayoutBox &box, geom::Rect const &bounds) {
     switch (box.type) {
         case LayoutType::Inline:
@@ -269,10 +417,7 @@ void layout(LayoutBox &box, geom::Rect const &bounds) {
             calculate_border(box, font_size);
             calculate_width_and_margin(box, bounds, font_size);
             calculate_position(box, bounds);
-            for (auto &child : box.children) {
-                layout(child, box.dimensions.content);
-                box.dimensions.content.height += child.dimensions.margin_box().height;
-            }
+            layout_children(box);
             calculate_height(box, font_size);
             return;
         }
@@ -281,10 +426,7 @@ void layout(LayoutBox &box, geom::Rect const &bounds) {
         case LayoutType::AnonymousBlock: {
             box.dimensions.content.width = bounds.width;
             calculate_position(box, bounds);
-            for (auto &child : box.children) {
-                layout(child, box.dimensions.content);
-                box.dimensions.content.height += child.dimensions.margin_box().height;
-            }
+            layout_children(box);
             return;
         }
     }
@@ -311,40 +453,41 @@ std::string_view to_str(dom::Node const &node) {
             node);
 }
 
-std::string to_str(geom::Rect const &rect) {
-    std::stringstream ss;
-    ss << "{" << rect.x << "," << rect.y << "," << rect.width << "," << rect.height << "}";
-    return std::move(ss).str();
+void append_str(geom::Rect const &rect, std::string &out) {
+    fmt::format_to(std::back_inserter(out), "{{{},{},{},{}}}", rect.x, rect.y, rect.width, rect.height);
 }
 
-std::string to_str(geom::EdgeSize const &edge) {
-    std::stringstream ss;
-    ss << "{" << edge.top << "," << edge.right << "," << edge.bottom << "," << edge.left << "}";
-    return std::move(ss).str();
+void append_str(geom::EdgeSize const &edge, std::string &out) {
+    fmt::format_to(std::back_inserter(out), "{{{},{},{},{}}}", edge.top, edge.right, edge.bottom, edge.left);
 }
 
-void print_box(LayoutBox const &box, std::ostream &os, uint8_t depth = 0) {
-    for (std::uint8_t i = 0; i < depth; ++i) {
-        os << "  ";
-    }
+void print_box(LayoutBox const &box, std::string &out, std::uint8_t depth = 0) {
+    out.append(static_cast<std::size_t>(depth) * 2, ' ');
 
     if (box.node != nullptr) {
-        os << to_str(box.node->node) << '\n';
-        for (std::uint8_t i = 0; i < depth; ++i) {
-            os << "  ";
-        }
+        out += to_str(box.node->node);
+        out += '\n';
+        out.append(static_cast<std::size_t>(depth) * 2, ' ');
     }
 
     auto const &d = box.dimensions;
-    os << to_str(box.type) << " " << to_str(d.content) << " " << to_str(d.padding) << " " << to_str(d.margin) << '\n';
+    out += to_str(box.type);
+    out += ' ';
+    append_str(d.content, out);
+    out += ' ';
+    append_str(d.padding, out);
+    out += ' ';
+    append_str(d.margin, out);
+    out += '\n';
     for (auto const &child : box.children) {
-        print_box(child, os, depth + 1);
+        print_box(child, out, depth + 1);
     }
 }
 
 } // namespace
 
 std::optional<LayoutBox> create_layout(style::StyledNode const &node, int width) {
+    util::trace::Span span{"layout::create_layout"};
     auto tree = create_tree(node);
     if (!tree) {
         return {};
@@ -354,6 +497,28 @@ std::optional<LayoutBox> create_layout(style::StyledNode const &node, int width)
     return *tree;
 }
 
+namespace {
+
+void reset_dimensions(LayoutBox &box) {
+    box.dimensions = {};
+    for (auto &child : box.children) {
+        reset_dimensions(child);
+    }
+}
+
+} // namespace
+
+void relayout(LayoutBox &root, int width) {
+    // layout() accumulates heights into the existing dimensions, so they have
+    // to be zeroed before going again.
+    reset_dimensions(root);
+    layout(root, {0, 0, width, 0});
+}
+
+void invalidate_text_measurement_cache() {
+    text_measurement_cache().clear();
+}
+
 LayoutBox const *box_at_position(LayoutBox const &box, geom::Position p) {
     if (!box.dimensions.contains(p)) {
         return nullptr;
@@ -372,10 +537,275 @@ LayoutBox const *box_at_position(LayoutBox const &box, geom::Position p) {
     return &box;
 }
 
+namespace {
+
+// box_at_position, but recording the chain of boxes leading to the hit.
+LayoutBox const *box_at_position_recording(
+        LayoutBox const &box, geom::Position p, std::vector<LayoutBox const *> &path) {
+    if (!box.dimensions.contains(p)) {
+        return nullptr;
+    }
+
+    path.push_back(&box);
+    auto const depth = path.size();
+    for (auto const &child : box.children) {
+        if (auto const *maybe = box_at_position_recording(child, p, path)) {
+            return maybe;
+        }
+
+        path.resize(depth);
+    }
+
+    if (box.type == LayoutType::AnonymousBlock) {
+        path.pop_back();
+        return nullptr;
+    }
+
+    return &box;
+}
+
+} // namespace
+
+LayoutBox const *CachedHitTester::box_at_position(LayoutBox const &root, geom::Position p) {
+    // Walk up from the last hit to the deepest remembered box containing p.
+    // Boxes in this tree only overlap through negative margins, so a position
+    // inside an ancestor of the last hit resolves within that subtree.
+    while (!path_.empty()) {
+        auto const &candidate = *path_.back();
+        path_.pop_back();
+        if (!candidate.dimensions.contains(p)) {
+            continue;
+        }
+
+        // A failed search restores the path, so e.g. an anonymous block whose
+        // children all missed just means we keep walking up.
+        if (auto const *hit = box_at_position_recording(candidate, p, path_)) {
+            return hit;
+        }
+    }
+
+    return box_at_position_recording(root, p, path_);
+}
+
+namespace {
+
+std::size_t box_count(LayoutBox const &box) {
+    std::size_t count{1};
+    for (auto const &child : box.children) {
+        count += box_count(child);
+    }
+
+    return count;
+}
+
+std::size_t flatten_into(std::vector<FlatLayoutBox> &boxes, LayoutBox const &box) {
+    auto index = boxes.size();
+    boxes.push_back({box.node, box.type, box.dimensions});
+
+    auto previous_child = FlatLayoutBox::kNoBox;
+    for (auto const &child : box.children) {
+        auto child_index = flatten_into(boxes, child);
+        if (previous_child == FlatLayoutBox::kNoBox) {
+            boxes[index].first_child = child_index;
+        } else {
+            boxes[previous_child].next_sibling = child_index;
+        }
+
+        previous_child = child_index;
+    }
+
+    return index;
+}
+
+FlatLayoutBox const *box_at_position(std::vector<FlatLayoutBox> const &boxes, std::size_t index, geom::Position p) {
+    auto const &box = boxes[index];
+    if (!box.dimensions.contains(p)) {
+        return nullptr;
+    }
+
+    for (auto child = box.first_child; child != FlatLayoutBox::kNoBox; child = boxes[child].next_sibling) {
+        if (auto const *maybe = box_at_position(boxes, child, p)) {
+            return maybe;
+        }
+    }
+
+    if (box.type == LayoutType::AnonymousBlock) {
+        return nullptr;
+    }
+
+    return &box;
+}
+
+} // namespace
+
+std::vector<FlatLayoutBox> flatten(LayoutBox const &root) {
+    std::vector<FlatLayoutBox> boxes;
+    // Counting first makes the whole tree one allocation.
+    boxes.reserve(box_count(root));
+    flatten_into(boxes, root);
+    return boxes;
+}
+
+FlatLayoutBox const *box_at_position(std::vector<FlatLayoutBox> const &boxes, geom::Position p) {
+    if (boxes.empty()) {
+        return nullptr;
+    }
+
+    return box_at_position(boxes, std::size_t{0}, p);
+}
+
+std::vector<geom::Rect> damaged_regions(
+        std::vector<FlatLayoutBox> const &before, std::vector<FlatLayoutBox> const &after) {
+    if (before.size() != after.size()) {
+        std::vector<geom::Rect> damage;
+        if (!before.empty()) {
+            damage.push_back(before[0].dimensions.border_box());
+        }
+
+        if (!after.empty() && (damage.empty() || damage[0] != after[0].dimensions.border_box())) {
+            damage.push_back(after[0].dimensions.border_box());
+        }
+
+        return damage;
+    }
+
+    std::vector<geom::Rect> damage;
+    for (std::size_t i = 0; i < before.size(); ++i) {
+        if (before[i].dimensions == after[i].dimensions) {
+            continue;
+        }
+
+        auto old_box = before[i].dimensions.border_box();
+        auto new_box = after[i].dimensions.border_box();
+        damage.push_back(old_box);
+        if (new_box != old_box) {
+            damage.push_back(new_box);
+        }
+    }
+
+    return damage;
+}
+
+HitTestIndex::HitTestIndex(std::vector<FlatLayoutBox> boxes) : boxes_{std::move(boxes)} {
+    if (boxes_.empty()) {
+        return;
+    }
+
+    parents_.resize(boxes_.size(), FlatLayoutBox::kNoBox);
+    for (std::size_t i = 0; i < boxes_.size(); ++i) {
+        for (auto child = boxes_[i].first_child; child != FlatLayoutBox::kNoBox;
+                child = boxes_[child].next_sibling) {
+            parents_[child] = i;
+        }
+    }
+
+    // Children can stick out of their parents, so the grid covers the union
+    // of every border box rather than just the root's.
+    auto first = boxes_[0].dimensions.border_box();
+    int left = first.left();
+    int right = first.right();
+    int top = first.top();
+    int bottom = first.bottom();
+    for (auto const &box : boxes_) {
+        auto rect = box.dimensions.border_box();
+        left = std::min(left, rect.left());
+        right = std::max(right, rect.right());
+        top = std::min(top, rect.top());
+        bottom = std::max(bottom, rect.bottom());
+    }
+
+    bounds_ = {left, top, right - left, bottom - top};
+    columns_ = bounds_.width / kCellSize + 1;
+    int rows = bounds_.height / kCellSize + 1;
+    cells_.resize(static_cast<std::size_t>(columns_) * rows);
+
+    for (std::size_t i = 0; i < boxes_.size(); ++i) {
+        auto rect = boxes_[i].dimensions.border_box();
+        for (int cy = (rect.top() - bounds_.y) / kCellSize; cy <= (rect.bottom() - bounds_.y) / kCellSize; ++cy) {
+            for (int cx = (rect.left() - bounds_.x) / kCellSize; cx <= (rect.right() - bounds_.x) / kCellSize; ++cx) {
+                cells_[static_cast<std::size_t>(cy) * columns_ + cx].push_back(i);
+            }
+        }
+    }
+}
+
+// Simulates the tree search restricted to the boxes containing the queried
+// position: children take priority over their parent, in sibling order, and
+// anonymous blocks are never returned themselves.
+FlatLayoutBox const *HitTestIndex::first_hit_in(std::vector<std::size_t> const &matches, std::size_t box) const {
+    for (auto candidate : matches) {
+        if (parents_[candidate] != box) {
+            continue;
+        }
+
+        if (auto const *maybe = first_hit_in(matches, candidate)) {
+            return maybe;
+        }
+    }
+
+    if (boxes_[box].type == LayoutType::AnonymousBlock) {
+        return nullptr;
+    }
+
+    return &boxes_[box];
+}
+
+FlatLayoutBox const *HitTestIndex::box_at_position(geom::Position p) const {
+    if (boxes_.empty() || !bounds_.contains(p)) {
+        return nullptr;
+    }
+
+    auto const &cell =
+            cells_[static_cast<std::size_t>((p.y - bounds_.y) / kCellSize) * columns_ + (p.x - bounds_.x) / kCellSize];
+
+    // Every box containing p also touches p's cell, so this is exactly the
+    // set of boxes containing p, in depth-first order.
+    std::vector<std::size_t> matches;
+    for (auto index : cell) {
+        if (boxes_[index].dimensions.contains(p)) {
+            matches.push_back(index);
+        }
+    }
+
+    if (matches.empty() || matches.front() != 0) {
+        return nullptr;
+    }
+
+    return first_hit_in(matches, std::size_t{0});
+}
+
+OffsetIndex::OffsetIndex(LayoutBox const &root) {
+    tops_.reserve(root.children.size());
+    max_bottoms_.reserve(root.children.size());
+
+    int max_bottom = std::numeric_limits<int>::min();
+    for (auto const &child : root.children) {
+        auto margin_box = child.dimensions.margin_box();
+        tops_.push_back(margin_box.top());
+        max_bottom = std::max(max_bottom, margin_box.bottom());
+        max_bottoms_.push_back(max_bottom);
+    }
+
+    document_height_ = std::max(root.dimensions.margin_box().bottom(), max_bottom);
+}
+
+std::pair<std::size_t, std::size_t> OffsetIndex::visible_range(int y, int height) const {
+    // The first child reaching below the slice's top, and the first child
+    // starting at or below its bottom.
+    auto first = std::ranges::upper_bound(max_bottoms_, y);
+    auto last = std::ranges::lower_bound(tops_, y + height);
+    return {static_cast<std::size_t>(std::distance(max_bottoms_.begin(), first)),
+            static_cast<std::size_t>(std::distance(tops_.begin(), last))};
+}
+
+void to_string(LayoutBox const &box, std::string &out) {
+    print_box(box, out);
+}
+
 std::string to_string(LayoutBox const &box) {
-    std::stringstream ss;
-    print_box(box, ss);
-    return std::move(ss).str();
+    std::string out;
+    to_string(box, out);
+    return out;
 }
 
 } // namespace layout
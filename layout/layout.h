@@ -12,9 +12,12 @@
 #include "style/styled_node.h"
 
 #include <cassert>
+#include <cstddef>
+#include <limits>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -31,7 +34,33 @@ struct LayoutBox {
     LayoutType type;
     BoxModel dimensions;
     std::vector<LayoutBox> children;
-    [[nodiscard]] bool operator==(LayoutBox const &) const = default;
+
+    // A run of text between two break opportunities, i.e. a word. Measured
+    // in characters until real font metrics land. forced_break_after marks a
+    // newline in the source text.
+    struct TextSegment {
+        int chars{};
+        bool forced_break_after{};
+        [[nodiscard]] bool operator==(TextSegment const &) const = default;
+    };
+
+    // Natural (unconstrained) text width and the text's break opportunities,
+    // scanned the first layout pass that needs them and reused by every later
+    // pass over the same tree: resize-driven relayouts re-flow the
+    // precomputed segments instead of re-measuring and re-scanning every
+    // string on the page. The box is rebuilt when the DOM changes, which is
+    // what invalidates this.
+    struct TextMetrics {
+        int width{};
+        std::vector<TextSegment> segments{};
+    };
+    std::optional<TextMetrics> text_metrics{};
+
+    // text_metrics is derived state, so it doesn't participate in equality.
+    [[nodiscard]] bool operator==(LayoutBox const &other) const {
+        return node == other.node && type == other.type && dimensions == other.dimensions
+                && children == other.children;
+    }
 
     template<css::PropertyId T>
     auto get_property() const {
@@ -44,12 +73,120 @@ struct LayoutBox {
     }
 };
 
+// Flat, contiguous storage of a laid-out box tree: all boxes in one vector in
+// depth-first order, linked by first-child/next-sibling indices. Traversal
+// walks memory linearly instead of chasing per-box child vectors, and the
+// whole tree frees in one shot.
+struct FlatLayoutBox {
+    static constexpr std::size_t kNoBox{std::numeric_limits<std::size_t>::max()};
+
+    style::StyledNode const *node;
+    LayoutType type;
+    BoxModel dimensions;
+    std::size_t first_child{kNoBox};
+    std::size_t next_sibling{kNoBox};
+    [[nodiscard]] bool operator==(FlatLayoutBox const &) const = default;
+};
+
 std::optional<LayoutBox> create_layout(style::StyledNode const &node, int width);
 
+// Recomputes the geometry of an existing box tree for a new available width.
+// The tree's structure only depends on the styled tree, not the viewport, so
+// this skips box generation and is just arithmetic over the existing boxes,
+// making it much cheaper than create_layout for e.g. window resizing.
+void relayout(LayoutBox &root, int width);
+
+// Drops the calling thread's remembered text measurements. Call when the
+// metrics backing them change, e.g. once real font measurement lands in the
+// canvas.
+void invalidate_text_measurement_cache();
+
+// The root, if any, is the first element of the returned vector.
+std::vector<FlatLayoutBox> flatten(LayoutBox const &root);
+
+// The regions damaged between two flattenings of the same box tree, e.g.
+// taken before and after a relayout: the old and new border boxes of every
+// box whose dimensions changed. A renderer only has to repaint these. If the
+// trees don't have the same shape, everything is considered damaged and the
+// two root border boxes are returned.
+std::vector<geom::Rect> damaged_regions(std::vector<FlatLayoutBox> const &before, std::vector<FlatLayoutBox> const &after);
+
 LayoutBox const *box_at_position(LayoutBox const &, geom::Position);
 
+FlatLayoutBox const *box_at_position(std::vector<FlatLayoutBox> const &, geom::Position);
+
+// Memoizing frontend to box_at_position. Consecutive queries (mouse moves)
+// almost always land in the same box, so this remembers the path to the last
+// hit and restarts the search from the deepest remembered box that still
+// contains the queried position instead of from the root. Must be reset()
+// whenever the tree it was last queried against changes or goes away.
+class CachedHitTester {
+public:
+    [[nodiscard]] LayoutBox const *box_at_position(LayoutBox const &root, geom::Position);
+
+    void reset() { path_.clear(); }
+
+private:
+    // The last hit and its ancestors, rootmost first.
+    std::vector<LayoutBox const *> path_{};
+};
+
+// Uniform-grid spatial index over a flattened box tree. Built once per
+// layout, it answers box_at_position by only looking at the boxes whose
+// border box touches the queried grid cell instead of recursing through the
+// whole tree, keeping per-mouse-move hit testing cheap on big pages.
+class HitTestIndex {
+public:
+    explicit HitTestIndex(std::vector<FlatLayoutBox> boxes);
+
+    [[nodiscard]] FlatLayoutBox const *box_at_position(geom::Position) const;
+
+    [[nodiscard]] std::vector<FlatLayoutBox> const &boxes() const { return boxes_; }
+
+private:
+    // 256 px cells keep the grid small even on very tall pages while a cell
+    // still only holds the handful of boxes overlapping it.
+    static constexpr int kCellSize{256};
+
+    std::vector<FlatLayoutBox> boxes_;
+    std::vector<std::size_t> parents_;
+    geom::Rect bounds_{};
+    int columns_{};
+    std::vector<std::vector<std::size_t>> cells_;
+
+    [[nodiscard]] FlatLayoutBox const *first_hit_in(std::vector<std::size_t> const &matches, std::size_t box) const;
+};
+
+// Sorted index over the vertical extents of the root's direct children.
+// Built once per layout, it answers the two queries scrolling needs -- the
+// total document height for scrollbar sizing and which top-level boxes are
+// visible at a scroll offset for culling -- with binary searches instead of
+// tree walks.
+class OffsetIndex {
+public:
+    explicit OffsetIndex(LayoutBox const &root);
+
+    // The bottom edge of the lowest margin box in the document.
+    [[nodiscard]] int document_height() const { return document_height_; }
+
+    // Indices [first, last) into the root's children of the boxes whose
+    // margin box overlaps the half-open slice [y, y + height).
+    [[nodiscard]] std::pair<std::size_t, std::size_t> visible_range(int y, int height) const;
+
+private:
+    std::vector<int> tops_;
+    // Running maximum, so the list stays sorted even when a child hangs
+    // below its successors.
+    std::vector<int> max_bottoms_;
+    int document_height_{};
+};
+
 std::string to_string(LayoutBox const &box);
 
+// Appends into out instead of building a fresh string; callers dumping the
+// tree repeatedly can reuse the buffer.
+void to_string(LayoutBox const &box, std::string &out);
+
 inline std::string_view dom_name(LayoutBox const &node) {
     assert(node.node);
     return std::get<dom::Element>(node.node->node).name;
@@ -7,6 +7,8 @@
 
 #include "etest/etest.h"
 
+#include <cstddef>
+#include <string>
 #include <string_view>
 #include <utility>
 
@@ -895,6 +897,37 @@ int main() {
         expect(layout::create_layout(style_root, 1000) == expected_layout);
     });
 
+    etest::test("parallel layout of many siblings", [] {
+        std::vector<dom::Node> rows;
+        for (int i = 0; i < 200; ++i) {
+            rows.push_back(create_element_node("div", {}, {}));
+        }
+        auto dom_root = create_element_node("html", {}, std::move(rows));
+
+        auto style_root = style::StyledNode{
+            .node = dom_root,
+            .properties = {{css::PropertyId::Display, "block"}},
+        };
+        for (auto const &child : std::get<dom::Element>(dom_root).children) {
+            style_root.children.push_back({child, {
+                {css::PropertyId::Display, "block"},
+                {css::PropertyId::Height, "10px"},
+            }});
+        }
+        set_up_parent_ptrs(style_root);
+
+        auto layout = layout::create_layout(style_root, 500);
+        require(layout.has_value());
+        require_eq(layout->children.size(), std::size_t{200});
+
+        // Each sibling is stacked below the previous one, exactly as if they
+        // were laid out one at a time.
+        expect_eq(layout->dimensions.content.height, 2000);
+        for (int i = 0; i < 200; ++i) {
+            expect_eq(layout->children[i].dimensions.content, geom::Rect{0, i * 10, 500, 10});
+        }
+    });
+
     etest::test("box_at_position", [] {
         auto layout = layout::LayoutBox{
             .node = nullptr,
@@ -921,6 +954,294 @@ int main() {
         expect(box_at_position(layout, {47, 47}) == &layout.children[0].children[1]);
     });
 
+    etest::test("relayout matches a fresh layout at the new width", [] {
+        auto dom_root = create_element_node("html", {}, {
+            create_element_node("body", {}, {
+                dom::Text{"hello relayout"},
+            }),
+        });
+
+        auto const &children = std::get<dom::Element>(dom_root).children;
+        auto style_root = style::StyledNode{
+            .node = dom_root,
+            .properties = {{css::PropertyId::Display, "block"}, {css::PropertyId::FontSize, "10px"}},
+            .children = {
+                {children[0], {{css::PropertyId::Display, "block"}}, {
+                    {std::get<dom::Element>(children[0]).children[0], {}, {}},
+                }},
+            },
+        };
+        set_up_parent_ptrs(style_root);
+
+        auto layout = layout::create_layout(style_root, 500);
+        require(layout.has_value());
+
+        layout::relayout(*layout, 200);
+        expect_eq(layout, layout::create_layout(style_root, 200));
+
+        layout::relayout(*layout, 500);
+        expect_eq(layout, layout::create_layout(style_root, 500));
+
+        // Cached and freshly measured text produce the same layout.
+        layout::invalidate_text_measurement_cache();
+        expect_eq(layout, layout::create_layout(style_root, 500));
+    });
+
+    etest::test("text wraps at cached break opportunities", [] {
+        auto dom_root = create_element_node("html", {}, {
+            create_element_node("body", {}, {
+                dom::Text{"aaaaaaaa bbbbbbbb cccccccc"},
+            }),
+        });
+
+        auto const &children = std::get<dom::Element>(dom_root).children;
+        auto style_root = style::StyledNode{
+            .node = dom_root,
+            .properties = {{css::PropertyId::Display, "block"}, {css::PropertyId::FontSize, "10px"}},
+            .children = {
+                {children[0], {{css::PropertyId::Display, "block"}}, {
+                    {std::get<dom::Element>(children[0]).children[0], {}, {}},
+                }},
+            },
+        };
+        set_up_parent_ptrs(style_root);
+
+        auto text_height = [](layout::LayoutBox const &layout) {
+            return layout.children[0].children[0].children[0].dimensions.content.height;
+        };
+
+        // All three words fit on one line at 200px.
+        auto layout = layout::create_layout(style_root, 200);
+        require(layout.has_value());
+        expect_eq(text_height(*layout), 10);
+
+        // Re-flowing to a narrower width wraps, and matches a fresh layout.
+        layout::relayout(*layout, 100);
+        expect_eq(text_height(*layout), 20);
+        expect_eq(layout, layout::create_layout(style_root, 100));
+
+        layout::relayout(*layout, 60);
+        expect_eq(text_height(*layout), 30);
+        expect_eq(layout, layout::create_layout(style_root, 60));
+    });
+
+    etest::test("text metrics are measured once per box", [] {
+        auto dom_root = create_element_node("html", {}, {
+            create_element_node("body", {}, {
+                dom::Text{"hi"},
+            }),
+        });
+
+        auto const &children = std::get<dom::Element>(dom_root).children;
+        auto style_root = style::StyledNode{
+            .node = dom_root,
+            .properties = {{css::PropertyId::Display, "block"}, {css::PropertyId::FontSize, "10px"}},
+            .children = {
+                {children[0], {{css::PropertyId::Display, "block"}}, {
+                    {std::get<dom::Element>(children[0]).children[0], {}, {}},
+                }},
+            },
+        };
+        set_up_parent_ptrs(style_root);
+
+        auto layout = layout::create_layout(style_root, 500);
+        require(layout.has_value());
+        auto const original = *layout;
+
+        // The boxes remember their measurements: a text change only takes
+        // effect once the tree is rebuilt, which is what a DOM change does.
+        auto &text = std::get<dom::Text>(std::get<dom::Element>(std::get<dom::Element>(dom_root).children[0]).children[0]);
+        text.text = "hi there, this is much longer";
+        layout::relayout(*layout, 500);
+        expect_eq(*layout, original);
+
+        auto rebuilt = layout::create_layout(style_root, 500);
+        require(rebuilt.has_value());
+        expect(*rebuilt != original);
+    });
+
+    etest::test("offset index", [] {
+        auto layout = layout::LayoutBox{
+            .node = nullptr,
+            .type = LayoutType::Block,
+            .dimensions = {{0, 0, 100, 300}},
+            .children = {
+                {nullptr, LayoutType::Block, {{0, 0, 100, 100}}, {}},
+                {nullptr, LayoutType::Block, {{0, 100, 100, 150}}, {}},
+                {nullptr, LayoutType::Block, {{0, 250, 100, 50}}, {}},
+            }
+        };
+
+        auto index = layout::OffsetIndex{layout};
+        expect_eq(index.document_height(), 300);
+
+        // A screenful at the top, in the middle, and past the end.
+        expect_eq(index.visible_range(0, 100), std::pair{std::size_t{0}, std::size_t{1}});
+        expect_eq(index.visible_range(50, 100), std::pair{std::size_t{0}, std::size_t{2}});
+        expect_eq(index.visible_range(100, 150), std::pair{std::size_t{1}, std::size_t{2}});
+        expect_eq(index.visible_range(240, 100), std::pair{std::size_t{1}, std::size_t{3}});
+        expect_eq(index.visible_range(300, 100), std::pair{std::size_t{3}, std::size_t{3}});
+
+        auto empty = layout::OffsetIndex{layout::LayoutBox{nullptr, LayoutType::Block, {{0, 0, 100, 25}}, {}}};
+        expect_eq(empty.document_height(), 25);
+        expect_eq(empty.visible_range(0, 100), std::pair{std::size_t{0}, std::size_t{0}});
+    });
+
+    etest::test("flatten", [] {
+        auto layout = layout::LayoutBox{
+            .node = nullptr,
+            .type = LayoutType::Block,
+            .dimensions = {{0, 0, 100, 100}},
+            .children = {
+                {nullptr, LayoutType::Block, {{25, 25, 50, 50}}, {
+                    {nullptr, LayoutType::AnonymousBlock, {{30, 30, 5, 5}}, {}},
+                    {nullptr, LayoutType::Block, {{45, 45, 5, 5}}, {}},
+                }},
+                {nullptr, LayoutType::Block, {{0, 80, 100, 20}}, {}},
+            }
+        };
+
+        auto constexpr kNoBox = layout::FlatLayoutBox::kNoBox;
+        auto flat = layout::flatten(layout);
+        require_eq(flat.size(), std::size_t{5});
+
+        // Depth-first order: root, first subtree, then the root's second child.
+        expect_eq(flat[0], layout::FlatLayoutBox{nullptr, LayoutType::Block, {{0, 0, 100, 100}}, 1, kNoBox});
+        expect_eq(flat[1], layout::FlatLayoutBox{nullptr, LayoutType::Block, {{25, 25, 50, 50}}, 2, 4});
+        expect_eq(flat[2], layout::FlatLayoutBox{nullptr, LayoutType::AnonymousBlock, {{30, 30, 5, 5}}, kNoBox, 3});
+        expect_eq(flat[3], layout::FlatLayoutBox{nullptr, LayoutType::Block, {{45, 45, 5, 5}}, kNoBox, kNoBox});
+        expect_eq(flat[4], layout::FlatLayoutBox{nullptr, LayoutType::Block, {{0, 80, 100, 20}}, kNoBox, kNoBox});
+    });
+
+    etest::test("box_at_position, flat", [] {
+        auto layout = layout::LayoutBox{
+            .node = nullptr,
+            .type = LayoutType::Block,
+            .dimensions = {{0, 0, 100, 100}},
+            .children = {
+                {nullptr, LayoutType::Block, {{25, 25, 50, 50}}, {
+                    {nullptr, LayoutType::AnonymousBlock, {{30, 30, 5, 5}}, {}},
+                    {nullptr, LayoutType::Block, {{45, 45, 5, 5}}, {}},
+                }},
+            }
+        };
+
+        auto flat = layout::flatten(layout);
+        expect(box_at_position(flat, {-1, -1}) == nullptr);
+        expect(box_at_position(flat, {101, 101}) == nullptr);
+
+        expect(box_at_position(flat, {100, 100}) == &flat[0]);
+        expect(box_at_position(flat, {0, 0}) == &flat[0]);
+
+        // We don't want to end up in anonymous blocks, so this should return its parent.
+        expect(box_at_position(flat, {31, 31}) == &flat[1]);
+
+        expect(box_at_position(flat, {75, 75}) == &flat[1]);
+        expect(box_at_position(flat, {47, 47}) == &flat[3]);
+    });
+
+    etest::test("damaged_regions", [] {
+        auto layout = layout::LayoutBox{
+            .node = nullptr,
+            .type = LayoutType::Block,
+            .dimensions = {{0, 0, 100, 100}},
+            .children = {
+                {nullptr, LayoutType::Block, {{0, 0, 100, 50}}, {}},
+                {nullptr, LayoutType::Block, {{0, 50, 100, 50}}, {}},
+            }
+        };
+
+        auto before = layout::flatten(layout);
+
+        // No geometry change, no damage.
+        expect(layout::damaged_regions(before, before).empty());
+
+        // Only the moved box's old and new positions are damaged.
+        layout.children[1].dimensions.content = {0, 60, 100, 50};
+        auto after = layout::flatten(layout);
+        expect_eq(layout::damaged_regions(before, after),
+                std::vector{geom::Rect{0, 50, 100, 50}, geom::Rect{0, 60, 100, 50}});
+
+        // A box whose size changed in place is reported once.
+        layout.children[1].dimensions.content = {0, 50, 100, 50};
+        layout.children[1].dimensions.padding = {1, 1, 1, 1};
+        expect_eq(layout::damaged_regions(before, layout::flatten(layout)),
+                std::vector{geom::Rect{0, 50, 100, 50}, geom::Rect{-1, 49, 102, 52}});
+
+        // Differently shaped trees damage everything.
+        layout.children.pop_back();
+        expect_eq(layout::damaged_regions(before, layout::flatten(layout)),
+                std::vector{geom::Rect{0, 0, 100, 100}});
+    });
+
+    etest::test("box_at_position, spatial index", [] {
+        auto layout = layout::LayoutBox{
+            .node = nullptr,
+            .type = LayoutType::Block,
+            .dimensions = {{0, 0, 600, 600}},
+            .children = {
+                {nullptr, LayoutType::Block, {{25, 25, 50, 50}}, {
+                    {nullptr, LayoutType::AnonymousBlock, {{30, 30, 5, 5}}, {}},
+                    {nullptr, LayoutType::Block, {{45, 45, 5, 5}}, {}},
+                }},
+                {nullptr, LayoutType::Block, {{0, 500, 600, 100}}, {}},
+            }
+        };
+
+        layout::HitTestIndex index{layout::flatten(layout)};
+        auto const &flat = index.boxes();
+
+        expect(index.box_at_position({-1, -1}) == nullptr);
+        expect(index.box_at_position({601, 601}) == nullptr);
+
+        expect(index.box_at_position({0, 0}) == &flat[0]);
+        expect(index.box_at_position({599, 300}) == &flat[0]);
+
+        // We don't want to end up in anonymous blocks, so this should return its parent.
+        expect(index.box_at_position({31, 31}) == &flat[1]);
+
+        expect(index.box_at_position({75, 75}) == &flat[1]);
+        expect(index.box_at_position({47, 47}) == &flat[3]);
+
+        // Boxes spanning several grid cells are found in all of them.
+        expect(index.box_at_position({10, 550}) == &flat[4]);
+        expect(index.box_at_position({599, 550}) == &flat[4]);
+    });
+
+    etest::test("box_at_position, cached", [] {
+        auto layout = layout::LayoutBox{
+            .node = nullptr,
+            .type = LayoutType::Block,
+            .dimensions = {{0, 0, 100, 100}},
+            .children = {
+                {nullptr, LayoutType::Block, {{25, 25, 50, 50}}, {
+                    {nullptr, LayoutType::AnonymousBlock, {{30, 30, 5, 5}}, {}},
+                    {nullptr, LayoutType::Block, {{45, 45, 5, 5}}, {}},
+                }},
+            }
+        };
+
+        layout::CachedHitTester tester{};
+
+        // Every query matches what a full search would return, regardless of
+        // where the previous query landed.
+        expect(tester.box_at_position(layout, {-1, -1}) == nullptr);
+        expect(tester.box_at_position(layout, {47, 47}) == &layout.children[0].children[1]);
+        // Same box again, served from the remembered path.
+        expect(tester.box_at_position(layout, {48, 48}) == &layout.children[0].children[1]);
+        // Out into the parent, a sibling's anonymous area, and the root.
+        expect(tester.box_at_position(layout, {75, 75}) == &layout.children[0]);
+        expect(tester.box_at_position(layout, {31, 31}) == &layout.children[0]);
+        expect(tester.box_at_position(layout, {0, 0}) == &layout);
+        expect(tester.box_at_position(layout, {101, 101}) == nullptr);
+
+        // Back inside after a complete miss.
+        expect(tester.box_at_position(layout, {47, 47}) == &layout.children[0].children[1]);
+
+        tester.reset();
+        expect(tester.box_at_position(layout, {47, 47}) == &layout.children[0].children[1]);
+    });
+
     etest::test("to_string", [] {
         auto dom_root = create_element_node("html", {}, {
             create_element_node("body", {}, {
@@ -951,6 +1272,10 @@ int main() {
                 "    p\n"
                 "    block {0,30,35,0} {5,15,0,0} {0,0,0,0}\n";
         expect_eq(to_string(layout::create_layout(style_root, 0).value()), expected);
+
+        std::string sink{"previous content\n"};
+        to_string(layout::create_layout(style_root, 0).value(), sink);
+        expect_eq(sink, "previous content\n" + std::string{expected});
     });
 
     // clang-format on
@@ -1171,7 +1496,7 @@ int main() {
         expect_eq(dom::nodes_by_xpath(layout, "/html/div/"), NodeVec{});
         expect_eq(dom::nodes_by_xpath(layout, "/html/div/p"), NodeVec{&anon_block.children[1].children[0]});
         expect_eq(dom::nodes_by_xpath(layout, "/htm/div"), NodeVec{});
-        expect_eq(dom::nodes_by_xpath(layout, "//div"), NodeVec{});
+        expect_eq(dom::nodes_by_xpath(layout, "//div"), NodeVec{&layout.children[0], &anon_block.children[1]});
     });
 
     return etest::run_all_tests();
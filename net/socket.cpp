@@ -5,25 +5,199 @@
 
 #include "net/socket.h"
 
+#include "os/os.h"
+
 #include <asio.hpp>
 #include <asio/ssl.hpp>
 #include <openssl/ssl.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace net {
 namespace {
 
+// Resolved endpoints, shared by every socket in the process. Entries expire
+// after a fixed ttl since asio doesn't surface the records' own ttls.
+class ResolverCache {
+public:
+    std::optional<asio::ip::tcp::resolver::results_type> get(std::string_view host, std::string_view service) {
+        std::scoped_lock lock{mutex_};
+        auto it = entries_.find(std::pair{std::string{host}, std::string{service}});
+        if (it == entries_.end() || std::chrono::steady_clock::now() >= it->second.expires_at) {
+            return std::nullopt;
+        }
+        return it->second.endpoints;
+    }
+
+    void put(std::string_view host, std::string_view service, asio::ip::tcp::resolver::results_type endpoints) {
+        std::scoped_lock lock{mutex_};
+        entries_.insert_or_assign(std::pair{std::string{host}, std::string{service}},
+                Entry{std::move(endpoints), std::chrono::steady_clock::now() + kTtl});
+    }
+
+private:
+    static constexpr std::chrono::seconds kTtl{60};
+
+    struct Entry {
+        asio::ip::tcp::resolver::results_type endpoints{};
+        std::chrono::steady_clock::time_point expires_at{};
+    };
+
+    std::mutex mutex_{};
+    std::map<std::pair<std::string, std::string>, Entry> entries_{};
+};
+
+ResolverCache &resolver_cache() {
+    static ResolverCache cache{};
+    return cache;
+}
+
+// Probed once so sockets on kernels without io_uring don't pay the failed
+// setup syscalls on every connect.
+bool io_uring_supported() {
+    static bool const supported = os::IoUring::open().has_value();
+    return supported;
+}
+
 struct BaseSocketImpl {
-    bool connect(asio::ip::tcp::resolver &resolver,
+    bool connect(asio::io_service &svc,
+            asio::ip::tcp::resolver &resolver,
             asio::ip::tcp::socket &socket,
             std::string_view host,
             std::string_view service) {
+        if (auto cached = resolver_cache().get(host, service)) {
+            if (connect_staggered(svc, socket, *cached)) {
+                return true;
+            }
+            // The cached addresses may have gone stale. Re-resolve and retry.
+        }
+
         asio::error_code ec;
         auto endpoints = resolver.resolve(host, service, ec);
-        asio::connect(socket, endpoints, ec);
-        return !ec;
+        if (ec) {
+            return false;
+        }
+
+        resolver_cache().put(host, service, endpoints);
+        return connect_staggered(svc, socket, endpoints);
+    }
+
+    // Tries the endpoints in parallel with staggered starts, alternating
+    // address family, in the style of Happy Eyeballs (RFC 8305). A host with
+    // a broken ipv6 route then costs one stagger delay instead of stalling
+    // until the os gives up on the connect.
+    bool connect_staggered(
+            asio::io_service &svc, asio::ip::tcp::socket &socket, asio::ip::tcp::resolver::results_type const &all) {
+        std::vector<asio::ip::tcp::endpoint> v6{};
+        std::vector<asio::ip::tcp::endpoint> v4{};
+        for (auto const &entry : all) {
+            (entry.endpoint().address().is_v6() ? v6 : v4).push_back(entry.endpoint());
+        }
+
+        std::vector<asio::ip::tcp::endpoint> ordered{};
+        ordered.reserve(v6.size() + v4.size());
+        for (std::size_t i = 0; i < std::max(v6.size(), v4.size()); ++i) {
+            if (i < v6.size()) {
+                ordered.push_back(v6[i]);
+            }
+            if (i < v4.size()) {
+                ordered.push_back(v4[i]);
+            }
+        }
+
+        if (ordered.empty()) {
+            return false;
+        }
+
+        static constexpr std::chrono::milliseconds kStaggerDelay{250};
+
+        std::list<asio::ip::tcp::socket> attempts{};
+        asio::steady_timer stagger{svc};
+        asio::steady_timer connect_deadline{svc};
+        bool connected = false;
+        std::size_t next_endpoint = 0;
+        std::size_t failed = 0;
+
+        std::function<void()> start_attempt = [&] {
+            if (connected || next_endpoint >= ordered.size()) {
+                return;
+            }
+
+            auto *attempt = &attempts.emplace_back(svc);
+            attempt->async_connect(ordered[next_endpoint], [&, attempt](asio::error_code attempt_ec) {
+                if (connected) {
+                    return;
+                }
+
+                if (attempt_ec) {
+                    if (++failed == ordered.size()) {
+                        // Everything failed; don't sit out the deadline.
+                        stagger.cancel();
+                        connect_deadline.cancel();
+                        return;
+                    }
+
+                    // A failure is as good a reason as the stagger timer to
+                    // move on to the next endpoint.
+                    start_attempt();
+                    return;
+                }
+
+                connected = true;
+                socket = std::move(*attempt);
+                stagger.cancel();
+                connect_deadline.cancel();
+                for (auto &other : attempts) {
+                    other.close();
+                }
+            });
+
+            ++next_endpoint;
+            if (next_endpoint < ordered.size()) {
+                stagger.expires_after(kStaggerDelay);
+                stagger.async_wait([&](asio::error_code timer_ec) {
+                    if (!timer_ec) {
+                        start_attempt();
+                    }
+                });
+            }
+        };
+
+        // The caller's overall deadline shrinks the connect budget when less
+        // of it remains than the configured connect timeout.
+        auto timeout = connect_timeout;
+        if (deadline) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    *deadline - std::chrono::steady_clock::now());
+            timeout = std::clamp(remaining, std::chrono::milliseconds{0}, timeout);
+        }
+
+        svc.restart();
+        connect_deadline.expires_after(timeout);
+        connect_deadline.async_wait([&](asio::error_code timer_ec) {
+            if (!timer_ec) {
+                stagger.cancel();
+                for (auto &attempt : attempts) {
+                    attempt.close();
+                }
+            }
+        });
+
+        start_attempt();
+        svc.run();
+        return connected;
     }
 
     std::size_t write(auto &socket, std::string_view data) {
@@ -31,35 +205,128 @@ struct BaseSocketImpl {
         return asio::write(socket, asio::buffer(data), ec);
     }
 
-    std::string read_all(auto &socket) {
+    std::size_t write(auto &socket, std::span<std::string_view const> fragments) {
+        // A buffer sequence turns the fragments into one scatter-gather
+        // write (writev on plain sockets) instead of concatenating them
+        // into a temporary first.
+        std::vector<asio::const_buffer> buffers;
+        buffers.reserve(fragments.size());
+        for (auto const &fragment : fragments) {
+            buffers.emplace_back(fragment.data(), fragment.size());
+        }
+
         asio::error_code ec;
-        asio::read(socket, asio::dynamic_buffer(buffer), ec);
-        return std::exchange(buffer, {});
+        return asio::write(socket, buffers, ec);
     }
 
-    std::string read_until(auto &socket, std::string_view delimiter) {
+    // Appends whatever the socket has ready to the buffer, blocking until at
+    // least one byte arrives. One receive per refill, into a block big enough
+    // that e.g. a chunked response is mostly served from memory instead of
+    // costing a handful of syscalls per chunk. Returns false on eof or error.
+    bool refill(asio::io_service &svc, auto &socket) {
+        auto old_size = buffer.size();
+        buffer.resize(old_size + kReadBlockSize);
+
+        if (uring) {
+            std::optional<std::chrono::nanoseconds> timeout{};
+            if (deadline) {
+                auto remaining = *deadline - std::chrono::steady_clock::now();
+                if (remaining <= std::chrono::steady_clock::duration::zero()) {
+                    buffer.resize(old_size);
+                    return false;
+                }
+                timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining);
+            }
+
+            auto n = uring->read(uring_fd, std::span{buffer}.subspan(old_size), timeout);
+            buffer.resize(old_size + n.value_or(0));
+            return n.value_or(0) > 0;
+        }
+
         asio::error_code ec;
-        auto n = asio::read_until(socket, asio::dynamic_buffer(buffer), delimiter, ec);
-        std::string result{};
-        if (n > 0) {
-            result = buffer.substr(0, n);
-            buffer.erase(0, n);
+        std::size_t n{0};
+        if (!deadline) {
+            n = socket.read_some(asio::buffer(buffer.data() + old_size, kReadBlockSize), ec);
+        } else if (auto remaining = *deadline - std::chrono::steady_clock::now();
+                   remaining <= std::chrono::steady_clock::duration::zero()) {
+            ec = asio::error::timed_out;
+        } else {
+            // A plain read_some can't be interrupted, so reads under a
+            // deadline go through the async machinery with a timer that
+            // breaks the read by closing the connection. A read that missed
+            // its deadline leaves the connection unusable anyway.
+            asio::steady_timer timer{svc};
+            timer.expires_after(remaining);
+            timer.async_wait([&](asio::error_code timer_ec) {
+                if (!timer_ec) {
+                    socket.lowest_layer().close();
+                }
+            });
+
+            socket.async_read_some(asio::buffer(buffer.data() + old_size, kReadBlockSize),
+                    [&](asio::error_code read_ec, std::size_t read_n) {
+                        ec = read_ec;
+                        n = read_n;
+                        timer.cancel();
+                    });
+
+            svc.restart();
+            svc.run();
         }
-        return result;
+
+        buffer.resize(old_size + n);
+        return !ec && n > 0;
     }
 
-    std::string read_bytes(auto &socket, std::size_t bytes) {
-        if (buffer.size() < bytes) {
-            auto bytes_to_transfer = bytes - buffer.size();
-            asio::error_code ec;
-            asio::read(socket, asio::dynamic_buffer(buffer), asio::transfer_at_least(bytes_to_transfer), ec);
+    std::string read_all(asio::io_service &svc, auto &socket) {
+        while (refill(svc, socket)) {
+        }
+        return std::exchange(buffer, {});
+    }
+
+    std::string read_until(asio::io_service &svc, auto &socket, std::string_view delimiter) {
+        if (delimiter.empty()) {
+            return {};
+        }
+
+        std::size_t searched{0};
+        while (true) {
+            // A delimiter may straddle a refill, so back up a bit instead of
+            // restarting the search from where the last refill ended.
+            auto start = searched > delimiter.size() - 1 ? searched - (delimiter.size() - 1) : 0;
+            if (auto found = buffer.find(delimiter, start); found != std::string::npos) {
+                auto n = found + delimiter.size();
+                std::string result = buffer.substr(0, n);
+                buffer.erase(0, n);
+                return result;
+            }
+
+            searched = buffer.size();
+            if (!refill(svc, socket)) {
+                // Whatever arrived stays buffered for later reads.
+                return {};
+            }
+        }
+    }
+
+    std::string read_bytes(asio::io_service &svc, auto &socket, std::size_t bytes) {
+        while (buffer.size() < bytes && refill(svc, socket)) {
         }
 
         std::string result = buffer.substr(0, bytes);
         buffer.erase(0, bytes);
         return result;
     }
+
+    static constexpr std::size_t kReadBlockSize{65536};
+
     std::string buffer{};
+    std::chrono::milliseconds connect_timeout{std::chrono::seconds{10}};
+    std::optional<std::chrono::steady_clock::time_point> deadline{};
+    // Only the plain socket reads through the ring; tls bytes have to flow
+    // through the ssl stream and stay on the asio path.
+    std::optional<os::IoUring> uring{};
+    int uring_fd{-1};
 };
 
 } // namespace
@@ -70,45 +337,193 @@ struct Socket::Impl : public BaseSocketImpl {
     asio::ip::tcp::socket socket{svc};
 };
 
+void Socket::prefetch_dns(std::string host, std::string service) {
+    if (resolver_cache().get(host, service)) {
+        return;
+    }
+
+    std::thread{[host = std::move(host), service = std::move(service)] {
+        asio::io_service svc{};
+        asio::ip::tcp::resolver resolver{svc};
+        asio::error_code ec;
+        auto endpoints = resolver.resolve(host, service, ec);
+        if (!ec) {
+            resolver_cache().put(host, service, std::move(endpoints));
+        }
+    }}.detach();
+}
+
 Socket::Socket() : impl_(std::make_unique<Impl>()) {}
 Socket::~Socket() = default;
 Socket::Socket(Socket &&) noexcept = default;
 Socket &Socket::operator=(Socket &&) noexcept = default;
 
+void Socket::set_connect_timeout(std::chrono::milliseconds timeout) {
+    impl_->connect_timeout = timeout;
+}
+
+void Socket::set_deadline(std::optional<std::chrono::steady_clock::time_point> deadline) {
+    impl_->deadline = deadline;
+}
+
 bool Socket::connect(std::string_view host, std::string_view service) {
-    return impl_->connect(impl_->resolver, impl_->socket, host, service);
+    if (!impl_->connect(impl_->svc, impl_->resolver, impl_->socket, host, service)) {
+        return false;
+    }
+
+    if (io_uring_supported()) {
+        // The connect leaves the fd non-blocking, and io_uring honors
+        // O_NONBLOCK, so the fd has to go back to blocking before the ring
+        // can wait for data on it.
+        asio::error_code ec;
+        impl_->socket.native_non_blocking(false, ec);
+        if (!ec) {
+            impl_->uring = os::IoUring::open();
+            impl_->uring_fd = impl_->socket.native_handle();
+        }
+    }
+
+    return true;
 }
 
 std::size_t Socket::write(std::string_view data) {
     return impl_->write(impl_->socket, data);
 }
 
+std::size_t Socket::write(std::span<std::string_view const> fragments) {
+    return impl_->write(impl_->socket, fragments);
+}
+
 std::string Socket::read_all() {
-    return impl_->read_all(impl_->socket);
+    return impl_->read_all(impl_->svc, impl_->socket);
 }
 
 std::string Socket::read_until(std::string_view delimiter) {
-    return impl_->read_until(impl_->socket, delimiter);
+    return impl_->read_until(impl_->svc, impl_->socket, delimiter);
 }
 
 std::string Socket::read_bytes(std::size_t bytes) {
-    return impl_->read_bytes(impl_->socket, bytes);
+    return impl_->read_bytes(impl_->svc, impl_->socket, bytes);
 }
 
+struct TlsSessionCache::Impl {
+    ~Impl() {
+        for (auto &[host, session] : sessions) {
+            SSL_SESSION_free(session);
+        }
+    }
+
+    // Takes over the caller's reference to the session.
+    void put(std::string host, SSL_SESSION *session) {
+        std::scoped_lock lock{mutex};
+        if (auto it = sessions.find(host); it != sessions.end()) {
+            SSL_SESSION_free(it->second);
+        }
+        sessions.insert_or_assign(std::move(host), session);
+    }
+
+    // The caller owns the returned reference.
+    SSL_SESSION *get(std::string const &host) {
+        std::scoped_lock lock{mutex};
+        auto it = sessions.find(host);
+        if (it == sessions.end()) {
+            return nullptr;
+        }
+        SSL_SESSION_up_ref(it->second);
+        return it->second;
+    }
+
+    std::mutex mutex{};
+    std::map<std::string, SSL_SESSION *> sessions{};
+};
+
+TlsSessionCache::TlsSessionCache() : impl_(std::make_unique<Impl>()) {}
+TlsSessionCache::~TlsSessionCache() = default;
+
 struct SecureSocket::Impl : public BaseSocketImpl {
     // TODO(robinlinden): Better error propagation.
     bool connect(std::string_view host, std::string_view service) {
-        if (BaseSocketImpl::connect(resolver, socket.next_layer(), host, service)) {
+        if (BaseSocketImpl::connect(svc, resolver, socket.next_layer(), host, service)) {
             asio::error_code ec;
             // Set SNI hostname. Many hosts reject the handshake if this isn't done.
             std::string null_terminated_host{host};
             SSL_set_tlsext_host_name(socket.native_handle(), null_terminated_host.c_str());
-            socket.handshake(asio::ssl::stream_base::handshake_type::client, ec);
-            return !ec;
+
+            alpn_selected.clear();
+            if (!alpn_protocols.empty()) {
+                // The wire format is a sequence of length-prefixed names.
+                std::string wire{};
+                for (auto const &protocol : alpn_protocols) {
+                    wire += static_cast<char>(protocol.size());
+                    wire += protocol;
+                }
+
+                SSL_set_alpn_protos(socket.native_handle(),
+                        reinterpret_cast<unsigned char const *>(wire.data()),
+                        static_cast<unsigned>(wire.size()));
+            }
+
+            if (session_cache != nullptr) {
+                // Offer the last session we established with this host so the
+                // server can do an abbreviated handshake.
+                if (auto *session = session_cache->impl_->get(null_terminated_host)) {
+                    SSL_set_session(socket.native_handle(), session);
+                    SSL_SESSION_free(session);
+                }
+            }
+
+            if (!deadline) {
+                socket.handshake(asio::ssl::stream_base::handshake_type::client, ec);
+            } else if (auto remaining = *deadline - std::chrono::steady_clock::now();
+                       remaining <= std::chrono::steady_clock::duration::zero()) {
+                ec = asio::error::timed_out;
+            } else {
+                // Like refill: a handshake under a deadline goes through the
+                // async machinery so a stalled server can't hold us past it.
+                asio::steady_timer timer{svc};
+                timer.expires_after(remaining);
+                timer.async_wait([&](asio::error_code timer_ec) {
+                    if (!timer_ec) {
+                        socket.lowest_layer().close();
+                    }
+                });
+
+                socket.async_handshake(
+                        asio::ssl::stream_base::handshake_type::client, [&](asio::error_code handshake_ec) {
+                            ec = handshake_ec;
+                            timer.cancel();
+                        });
+
+                svc.restart();
+                svc.run();
+            }
+
+            if (ec) {
+                return false;
+            }
+
+            if (session_cache != nullptr) {
+                if (auto *session = SSL_get1_session(socket.native_handle())) {
+                    session_cache->impl_->put(std::move(null_terminated_host), session);
+                }
+            }
+
+            unsigned char const *selected{nullptr};
+            unsigned selected_length{0};
+            SSL_get0_alpn_selected(socket.native_handle(), &selected, &selected_length);
+            if (selected != nullptr) {
+                alpn_selected.assign(reinterpret_cast<char const *>(selected), selected_length);
+            }
+
+            return true;
         }
         return false;
     }
 
+    std::shared_ptr<TlsSessionCache> session_cache{};
+    // h2 joins this list once the protocol layer can actually speak it.
+    std::vector<std::string> alpn_protocols{"http/1.1"};
+    std::string alpn_selected{};
     asio::io_service svc{};
     asio::ip::tcp::resolver resolver{svc};
     asio::ssl::context ctx{asio::ssl::context::method::sslv23_client};
@@ -116,6 +531,26 @@ struct SecureSocket::Impl : public BaseSocketImpl {
 };
 
 SecureSocket::SecureSocket() : impl_(std::make_unique<Impl>()) {}
+
+SecureSocket::SecureSocket(std::shared_ptr<TlsSessionCache> session_cache) : SecureSocket() {
+    impl_->session_cache = std::move(session_cache);
+}
+
+void SecureSocket::set_connect_timeout(std::chrono::milliseconds timeout) {
+    impl_->connect_timeout = timeout;
+}
+
+void SecureSocket::set_deadline(std::optional<std::chrono::steady_clock::time_point> deadline) {
+    impl_->deadline = deadline;
+}
+
+void SecureSocket::set_alpn_protocols(std::vector<std::string> protocols) {
+    impl_->alpn_protocols = std::move(protocols);
+}
+
+std::string_view SecureSocket::alpn_protocol() const {
+    return impl_->alpn_selected;
+}
 SecureSocket::~SecureSocket() = default;
 SecureSocket::SecureSocket(SecureSocket &&) noexcept = default;
 SecureSocket &SecureSocket::operator=(SecureSocket &&) noexcept = default;
@@ -128,16 +563,20 @@ std::size_t SecureSocket::write(std::string_view data) {
     return impl_->write(impl_->socket, data);
 }
 
+std::size_t SecureSocket::write(std::span<std::string_view const> fragments) {
+    return impl_->write(impl_->socket, fragments);
+}
+
 std::string SecureSocket::read_all() {
-    return impl_->read_all(impl_->socket);
+    return impl_->read_all(impl_->svc, impl_->socket);
 }
 
 std::string SecureSocket::read_until(std::string_view delimiter) {
-    return impl_->read_until(impl_->socket, delimiter);
+    return impl_->read_until(impl_->svc, impl_->socket, delimiter);
 }
 
 std::string SecureSocket::read_bytes(std::size_t bytes) {
-    return impl_->read_bytes(impl_->socket, bytes);
+    return impl_->read_bytes(impl_->svc, impl_->socket, bytes);
 }
 
 } // namespace net
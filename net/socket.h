@@ -5,10 +5,14 @@
 #ifndef NET_SOCKET_H_
 #define NET_SOCKET_H_
 
+#include <chrono>
 #include <cstddef>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace net {
 
@@ -20,8 +24,25 @@ public:
     Socket(Socket &&) noexcept;
     Socket &operator=(Socket &&) noexcept;
 
+    // Starts resolving host in the background so a later connect to it can
+    // skip the dns lookup. Results land in a process-wide cache shared by
+    // Socket and SecureSocket.
+    static void prefetch_dns(std::string host, std::string service);
+
+    // Caps how long connect may spend across all its connection attempts.
+    void set_connect_timeout(std::chrono::milliseconds timeout);
+
+    // Point in time after which connects and reads on this socket give up.
+    // A read that hits the deadline closes the connection, so the socket
+    // should be treated as dead afterwards. std::nullopt removes the cap.
+    void set_deadline(std::optional<std::chrono::steady_clock::time_point> deadline);
+
     bool connect(std::string_view host, std::string_view service);
     std::size_t write(std::string_view data);
+    // Writes the fragments back to back, as if they had been concatenated
+    // first, but gathers them in the send path instead of copying them into
+    // a temporary.
+    std::size_t write(std::span<std::string_view const> fragments);
     std::string read_all();
     std::string read_until(std::string_view delimiter);
     std::string read_bytes(std::size_t bytes);
@@ -31,16 +52,55 @@ private:
     std::unique_ptr<Impl> impl_;
 };
 
+// Established TLS sessions, keyed by host. Hand the same cache to every
+// SecureSocket talking to the same servers and reconnects will try to resume
+// the previous session instead of doing a full handshake.
+class TlsSessionCache {
+public:
+    TlsSessionCache();
+    ~TlsSessionCache();
+
+    TlsSessionCache(TlsSessionCache const &) = delete;
+    TlsSessionCache &operator=(TlsSessionCache const &) = delete;
+
+private:
+    friend class SecureSocket;
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 class SecureSocket {
 public:
     SecureSocket();
+    explicit SecureSocket(std::shared_ptr<TlsSessionCache> session_cache);
     ~SecureSocket();
 
     SecureSocket(SecureSocket &&) noexcept;
     SecureSocket &operator=(SecureSocket &&) noexcept;
 
+    // Caps how long connect may spend across all its connection attempts.
+    void set_connect_timeout(std::chrono::milliseconds timeout);
+
+    // Point in time after which connects and reads on this socket give up.
+    // A read that hits the deadline closes the connection, so the socket
+    // should be treated as dead afterwards. std::nullopt removes the cap.
+    void set_deadline(std::optional<std::chrono::steady_clock::time_point> deadline);
+
+    // Protocols to offer via ALPN (RFC 7301) on the next connect, most
+    // preferred first. Offer only protocols the caller can actually speak:
+    // the server is free to pick any of them. Defaults to just http/1.1.
+    void set_alpn_protocols(std::vector<std::string> protocols);
+
+    // The protocol the server picked during the handshake, e.g. "http/1.1",
+    // or empty before connecting or if the server didn't pick one.
+    [[nodiscard]] std::string_view alpn_protocol() const;
+
     bool connect(std::string_view host, std::string_view service);
     std::size_t write(std::string_view data);
+    // Writes the fragments back to back, as if they had been concatenated
+    // first, but gathers them in the send path instead of copying them into
+    // a temporary.
+    std::size_t write(std::span<std::string_view const> fragments);
     std::string read_all();
     std::string read_until(std::string_view delimiter);
     std::string read_bytes(std::size_t bytes);
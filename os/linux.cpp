@@ -4,10 +4,33 @@
 
 #include "os/os.h"
 
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <linux/perf_event.h>
+#include <linux/time_types.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cerrno>
 #include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <utility>
 
 using namespace std::literals;
 
@@ -46,4 +69,431 @@ unsigned active_window_scale_factor() {
     return 1;
 }
 
+struct ScaleFactorWatcher::Impl {
+    ~Impl() {
+        if (watcher.joinable()) {
+            std::uint64_t one{1};
+            [[maybe_unused]] auto rc = write(wake_fd, &one, sizeof(one));
+            watcher.join();
+        }
+        if (inotify_fd != -1) {
+            close(inotify_fd);
+        }
+        if (wake_fd != -1) {
+            close(wake_fd);
+        }
+    }
+
+    std::function<void(unsigned)> on_change{};
+    std::atomic<unsigned> scale{1};
+    int inotify_fd{-1};
+    int wake_fd{-1};
+    std::thread watcher{};
+};
+
+ScaleFactorWatcher::ScaleFactorWatcher(std::function<void(unsigned)> on_change) : impl_{std::make_unique<Impl>()} {
+    impl_->on_change = std::move(on_change);
+    impl_->scale.store(active_window_scale_factor(), std::memory_order_relaxed);
+
+    // The compositor rewrites the session's monitor configuration when
+    // displays are plugged, unplugged, or rescaled, so an inotify watch on it
+    // gives us a change edge without linking the display server's libraries
+    // and without ever polling the slow path. Sessions that don't write one
+    // just keep the value cached at startup.
+    std::string config_dir;
+    if (char const *xdg_config_home = std::getenv("XDG_CONFIG_HOME")) {
+        config_dir = xdg_config_home;
+    } else if (char const *home = std::getenv("HOME")) {
+        config_dir = home + "/.config"s;
+    } else {
+        return;
+    }
+
+    impl_->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    impl_->wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (impl_->inotify_fd == -1 || impl_->wake_fd == -1) {
+        return;
+    }
+
+    // Watch the directory rather than the file: the configuration is
+    // replaced atomically, which would drop a watch on the file itself.
+    if (inotify_add_watch(impl_->inotify_fd, config_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+        return;
+    }
+
+    impl_->watcher = std::thread{[impl = impl_.get()] {
+        while (true) {
+            std::array<pollfd, 2> fds{{{impl->inotify_fd, POLLIN, 0}, {impl->wake_fd, POLLIN, 0}}};
+            if (poll(fds.data(), fds.size(), -1) == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+
+            if ((fds[1].revents & POLLIN) != 0) {
+                return;
+            }
+
+            bool relevant{false};
+            // Room for a batch of events; inotify rejects reads that can't
+            // fit at least one.
+            alignas(inotify_event) std::array<char, 4096> buffer{};
+            ssize_t len{};
+            while ((len = read(impl->inotify_fd, buffer.data(), buffer.size())) > 0) {
+                for (char const *p = buffer.data(); p < buffer.data() + len;) {
+                    auto const *event = reinterpret_cast<inotify_event const *>(p);
+                    if (event->len > 0 && std::string_view{event->name} == "monitors.xml"sv) {
+                        relevant = true;
+                    }
+                    p += sizeof(inotify_event) + event->len;
+                }
+            }
+
+            if (!relevant) {
+                continue;
+            }
+
+            auto scale = active_window_scale_factor();
+            if (scale != impl->scale.exchange(scale, std::memory_order_relaxed) && impl->on_change) {
+                impl->on_change(scale);
+            }
+        }
+    }};
+}
+
+ScaleFactorWatcher::ScaleFactorWatcher(ScaleFactorWatcher &&) noexcept = default;
+ScaleFactorWatcher &ScaleFactorWatcher::operator=(ScaleFactorWatcher &&) noexcept = default;
+ScaleFactorWatcher::~ScaleFactorWatcher() = default;
+
+unsigned ScaleFactorWatcher::scale_factor() const {
+    return impl_->scale.load(std::memory_order_relaxed);
+}
+
+struct MemoryMappedFile::Impl {
+    ~Impl() {
+        if (data != nullptr) {
+            munmap(data, size);
+        }
+    }
+
+    void *data{nullptr};
+    std::size_t size{0};
+};
+
+std::optional<MemoryMappedFile> MemoryMappedFile::map(std::string const &path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) == -1) {
+        close(fd);
+        return std::nullopt;
+    }
+
+    auto impl = std::make_unique<Impl>();
+    impl->size = static_cast<std::size_t>(info.st_size);
+    if (impl->size > 0) {
+        // The mapping stays alive after the fd is closed.
+        impl->data = mmap(nullptr, impl->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (impl->data == MAP_FAILED) {
+            impl->data = nullptr;
+            close(fd);
+            return std::nullopt;
+        }
+    }
+
+    close(fd);
+    return MemoryMappedFile{std::move(impl)};
+}
+
+MemoryMappedFile::MemoryMappedFile(std::unique_ptr<Impl> impl) : impl_{std::move(impl)} {}
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile &&) noexcept = default;
+MemoryMappedFile &MemoryMappedFile::operator=(MemoryMappedFile &&) noexcept = default;
+MemoryMappedFile::~MemoryMappedFile() = default;
+
+std::string_view MemoryMappedFile::view() const {
+    return {static_cast<char const *>(impl_->data), impl_->size};
+}
+
+struct PerfCounters::Impl {
+    ~Impl() {
+        for (int fd : fds) {
+            if (fd != -1) {
+                close(fd);
+            }
+        }
+    }
+
+    // The group leader (instructions) first; reads go through it.
+    std::array<int, 4> fds{-1, -1, -1, -1};
+};
+
+std::optional<PerfCounters> PerfCounters::open() {
+    // One event group, so the counters are scheduled (and multiplexed)
+    // together and a read through the leader sees all of them.
+    constexpr std::array<std::uint64_t, 4> kEvents{
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    auto impl = std::make_unique<Impl>();
+    for (std::size_t i = 0; i < kEvents.size(); ++i) {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = kEvents[i];
+        attr.disabled = i == 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        int group_fd = i == 0 ? -1 : impl->fds[0];
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+        if (fd == -1) {
+            return std::nullopt;
+        }
+
+        impl->fds[i] = fd;
+    }
+
+    return PerfCounters{std::move(impl)};
+}
+
+PerfCounters::PerfCounters(std::unique_ptr<Impl> impl) : impl_{std::move(impl)} {}
+PerfCounters::PerfCounters(PerfCounters &&) noexcept = default;
+PerfCounters &PerfCounters::operator=(PerfCounters &&) noexcept = default;
+PerfCounters::~PerfCounters() = default;
+
+void PerfCounters::start() {
+    ioctl(impl_->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(impl_->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounterValues PerfCounters::stop() {
+    ioctl(impl_->fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // PERF_FORMAT_GROUP layout: nr followed by one value per event.
+    std::array<std::uint64_t, 5> buffer{};
+    if (read(impl_->fds[0], buffer.data(), sizeof(buffer)) == -1 || buffer[0] != 4) {
+        return {};
+    }
+
+    return {
+            .instructions = buffer[1],
+            .cycles = buffer[2],
+            .cache_misses = buffer[3],
+            .branch_misses = buffer[4],
+    };
+}
+
+namespace {
+
+// glibc has no wrappers for the io_uring syscalls.
+int io_uring_setup(unsigned entries, io_uring_params *params) {
+    return static_cast<int>(syscall(SYS_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(SYS_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int ring_fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return static_cast<int>(syscall(SYS_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+} // namespace
+
+struct IoUring::Impl {
+    ~Impl() {
+        if (sq_ring != MAP_FAILED) {
+            munmap(sq_ring, sq_ring_size);
+        }
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_size);
+        }
+        if (ring_fd != -1) {
+            close(ring_fd);
+        }
+    }
+
+    int ring_fd{-1};
+    void *sq_ring{MAP_FAILED};
+    std::size_t sq_ring_size{};
+    void *cq_ring{MAP_FAILED};
+    std::size_t cq_ring_size{};
+    void *sqes{MAP_FAILED};
+    std::size_t sqes_size{};
+
+    // Pointers into the shared rings.
+    unsigned *sq_tail{};
+    unsigned *sq_mask{};
+    unsigned *sq_array{};
+    io_uring_sqe *sqe_entries{};
+    unsigned *cq_head{};
+    unsigned *cq_tail{};
+    unsigned *cq_mask{};
+    io_uring_cqe *cqes{};
+};
+
+std::optional<IoUring> IoUring::open() {
+    auto impl = std::make_unique<Impl>();
+
+    // Two entries: a read and, when a timeout applies, its linked timeout.
+    io_uring_params params{};
+    impl->ring_fd = io_uring_setup(2, &params);
+    if (impl->ring_fd == -1) {
+        return std::nullopt;
+    }
+
+    impl->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    impl->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        impl->sq_ring_size = impl->cq_ring_size = std::max(impl->sq_ring_size, impl->cq_ring_size);
+    }
+
+    impl->sq_ring = mmap(nullptr,
+            impl->sq_ring_size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            impl->ring_fd,
+            IORING_OFF_SQ_RING);
+    if (impl->sq_ring == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    impl->cq_ring = (params.features & IORING_FEAT_SINGLE_MMAP) != 0
+            ? impl->sq_ring
+            : mmap(nullptr,
+                      impl->cq_ring_size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE,
+                      impl->ring_fd,
+                      IORING_OFF_CQ_RING);
+    if (impl->cq_ring == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    impl->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    impl->sqes = mmap(nullptr,
+            impl->sqes_size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            impl->ring_fd,
+            IORING_OFF_SQES);
+    if (impl->sqes == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    auto *sq = static_cast<std::uint8_t *>(impl->sq_ring);
+    impl->sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    impl->sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    impl->sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    impl->sqe_entries = static_cast<io_uring_sqe *>(impl->sqes);
+    auto *cq = static_cast<std::uint8_t *>(impl->cq_ring);
+    impl->cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    impl->cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    impl->cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    impl->cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    // Kernels old enough to lack the ops we submit (pre-5.6) get treated
+    // the same as kernels without io_uring at all.
+    std::array<std::uint8_t, sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op)> probe_storage{};
+    auto *probe = reinterpret_cast<io_uring_probe *>(probe_storage.data());
+    if (io_uring_register(impl->ring_fd, IORING_REGISTER_PROBE, probe, 256) == -1) {
+        return std::nullopt;
+    }
+
+    auto supported = [&](std::uint8_t op) {
+        return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+    };
+    if (!supported(IORING_OP_READ) || !supported(IORING_OP_LINK_TIMEOUT)) {
+        return std::nullopt;
+    }
+
+    return IoUring{std::move(impl)};
+}
+
+IoUring::IoUring(std::unique_ptr<Impl> impl) : impl_{std::move(impl)} {}
+IoUring::IoUring(IoUring &&) noexcept = default;
+IoUring &IoUring::operator=(IoUring &&) noexcept = default;
+IoUring::~IoUring() = default;
+
+std::optional<std::size_t> IoUring::read(
+        int fd, std::span<char> buffer, std::optional<std::chrono::nanoseconds> timeout) {
+    constexpr std::uint64_t kReadTag{1};
+    constexpr std::uint64_t kTimeoutTag{2};
+
+    // We're the only submitter, so the tail can be read plainly; only the
+    // publishing store has to be ordered against the sqe writes.
+    auto mask = *impl_->sq_mask;
+    auto tail = *impl_->sq_tail;
+    unsigned to_submit{0};
+
+    auto &read_sqe = impl_->sqe_entries[tail & mask];
+    read_sqe = {};
+    read_sqe.opcode = IORING_OP_READ;
+    read_sqe.fd = fd;
+    read_sqe.addr = reinterpret_cast<std::uint64_t>(buffer.data());
+    read_sqe.len = static_cast<unsigned>(buffer.size());
+    read_sqe.off = static_cast<std::uint64_t>(-1);
+    read_sqe.user_data = kReadTag;
+    impl_->sq_array[tail & mask] = tail & mask;
+    ++tail;
+    ++to_submit;
+
+    __kernel_timespec ts{};
+    if (timeout) {
+        read_sqe.flags |= IOSQE_IO_LINK;
+        auto &timeout_sqe = impl_->sqe_entries[tail & mask];
+        timeout_sqe = {};
+        timeout_sqe.opcode = IORING_OP_LINK_TIMEOUT;
+        timeout_sqe.fd = -1;
+        ts.tv_sec = timeout->count() / 1'000'000'000;
+        ts.tv_nsec = timeout->count() % 1'000'000'000;
+        timeout_sqe.addr = reinterpret_cast<std::uint64_t>(&ts);
+        timeout_sqe.len = 1;
+        timeout_sqe.user_data = kTimeoutTag;
+        impl_->sq_array[tail & mask] = tail & mask;
+        ++tail;
+        ++to_submit;
+    }
+
+    std::atomic_ref<unsigned>{*impl_->sq_tail}.store(tail, std::memory_order_release);
+
+    // Wait until the read's completion shows up. A fired timeout posts its
+    // own completion and cancels the read, whose completion follows with
+    // -ECANCELED, so draining until we see the read's works for both.
+    std::optional<int> read_result{};
+    while (!read_result) {
+        if (io_uring_enter(impl_->ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS) == -1 && errno != EINTR) {
+            return std::nullopt;
+        }
+        to_submit = 0;
+
+        auto head = *impl_->cq_head;
+        auto cq_tail = std::atomic_ref<unsigned>{*impl_->cq_tail}.load(std::memory_order_acquire);
+        for (; head != cq_tail; ++head) {
+            auto const &cqe = impl_->cqes[head & *impl_->cq_mask];
+            if (cqe.user_data == kReadTag) {
+                read_result = cqe.res;
+            }
+        }
+        std::atomic_ref<unsigned>{*impl_->cq_head}.store(head, std::memory_order_release);
+    }
+
+    if (*read_result < 0) {
+        return std::nullopt;
+    }
+
+    return static_cast<std::size_t>(*read_result);
+}
+
 } // namespace os
@@ -14,6 +14,18 @@
 #include "etest/etest.h"
 
 #include <stdlib.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
 
 using etest::expect_eq;
 
@@ -41,5 +53,81 @@ int main() {
         expect_eq(os::active_window_scale_factor(), 50u);
     });
 
+    etest::test("scale factor watcher sees monitor configuration changes", [] {
+        std::array<char, 32> config_dir{"/tmp/hastur-scale-test-XXXXXX"};
+        if (mkdtemp(config_dir.data()) == nullptr) {
+            return;
+        }
+        setenv("XDG_CONFIG_HOME", config_dir.data(), true);
+
+        setenv("HST_SCALE", "2", true);
+        std::atomic<unsigned> notified{0};
+        os::ScaleFactorWatcher watcher{[&](unsigned scale) { notified = scale; }};
+        expect_eq(watcher.scale_factor(), 2u);
+
+        // Rewriting the monitor configuration should make the watcher re-run
+        // the slow path and see the new value.
+        setenv("HST_SCALE", "3", true);
+        std::ofstream{std::string{config_dir.data()} + "/monitors.xml"} << "<monitors/>";
+
+        for (int i = 0; i < 500 && notified == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        expect_eq(notified.load(), 3u);
+        expect_eq(watcher.scale_factor(), 3u);
+
+        unsetenv("HST_SCALE");
+        unsetenv("XDG_CONFIG_HOME");
+        unlink((std::string{config_dir.data()} + "/monitors.xml").c_str());
+        rmdir(config_dir.data());
+    });
+
+    etest::test("perf counters count instructions", [] {
+        // Locked-down kernels (and most CI sandboxes) don't let us at the
+        // counters at all, and that has to be fine.
+        auto counters = os::PerfCounters::open();
+        if (!counters) {
+            return;
+        }
+
+        counters->start();
+        int sum = 0;
+        for (int i = 0; i < 10'000; ++i) {
+            // NOLINTNEXTLINE(hicpp-no-assembler): Keeps the loop from being optimized out.
+            asm volatile("" : "+r"(sum));
+            sum += i;
+        }
+        auto values = counters->stop();
+
+        etest::expect(values.instructions > 10'000);
+        etest::expect(values.cycles > 0);
+    });
+
+    etest::test("io_uring reads from a pipe", [] {
+        // Kernels without io_uring (and sandboxes that filter the syscalls)
+        // can't run this, and that has to be fine.
+        auto uring = os::IoUring::open();
+        if (!uring) {
+            return;
+        }
+
+        std::array<int, 2> fds{};
+        if (pipe(fds.data()) != 0) {
+            return;
+        }
+
+        etest::expect(write(fds[1], "hi", 2) == 2);
+
+        std::array<char, 16> buffer{};
+        expect_eq(uring->read(fds[0], std::span{buffer}), std::optional<std::size_t>{2});
+        expect_eq(std::string_view(buffer.data(), 2), "hi");
+
+        // Nothing more is coming, so a read with a timeout has to give up.
+        expect_eq(uring->read(fds[0], std::span{buffer}, std::chrono::milliseconds{5}), std::nullopt);
+
+        close(fds[0]);
+        close(fds[1]);
+    });
+
     return etest::run_all_tests();
 }
@@ -5,7 +5,15 @@
 #ifndef OS_OS_H_
 #define OS_OS_H_
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace os {
@@ -13,6 +21,101 @@ namespace os {
 std::vector<std::string> font_paths();
 unsigned active_window_scale_factor();
 
+// Caches active_window_scale_factor() and subscribes to the platform's
+// display-configuration change notifications, re-running the slow path only
+// when one arrives. on_change is invoked from the watcher's thread when the
+// cached value actually changed; scale_factor() is an atomic load, so
+// callers can read it as often as they like.
+class ScaleFactorWatcher {
+public:
+    explicit ScaleFactorWatcher(std::function<void(unsigned)> on_change);
+
+    ScaleFactorWatcher(ScaleFactorWatcher &&) noexcept;
+    ScaleFactorWatcher &operator=(ScaleFactorWatcher &&) noexcept;
+    ~ScaleFactorWatcher();
+
+    [[nodiscard]] unsigned scale_factor() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// A read-only file mapped into memory. The view stays valid for as long as
+// the object is alive, and reloads of the same file share the os page cache
+// instead of each reading their own copy.
+class MemoryMappedFile {
+public:
+    static std::optional<MemoryMappedFile> map(std::string const &path);
+
+    MemoryMappedFile(MemoryMappedFile &&) noexcept;
+    MemoryMappedFile &operator=(MemoryMappedFile &&) noexcept;
+    ~MemoryMappedFile();
+
+    [[nodiscard]] std::string_view view() const;
+
+private:
+    struct Impl;
+    explicit MemoryMappedFile(std::unique_ptr<Impl>);
+    std::unique_ptr<Impl> impl_;
+};
+
+struct PerfCounterValues {
+    std::uint64_t instructions{};
+    std::uint64_t cycles{};
+    std::uint64_t cache_misses{};
+    std::uint64_t branch_misses{};
+};
+
+// Hardware performance counters for the calling thread, counting between
+// start() and stop(). open() returns std::nullopt on platforms without
+// support and on kernels that don't let us at the counters, so callers have
+// to be able to get by without them.
+class PerfCounters {
+public:
+    static std::optional<PerfCounters> open();
+
+    PerfCounters(PerfCounters &&) noexcept;
+    PerfCounters &operator=(PerfCounters &&) noexcept;
+    ~PerfCounters();
+
+    // Resets the counters and starts counting.
+    void start();
+
+    // Stops counting and reads the counters.
+    [[nodiscard]] PerfCounterValues stop();
+
+private:
+    struct Impl;
+    explicit PerfCounters(std::unique_ptr<Impl>);
+    std::unique_ptr<Impl> impl_;
+};
+
+// A minimal io_uring: one blocking read at a time. Submitting and waiting
+// is a single syscall, so a read costs one io_uring_enter instead of a
+// readiness wait plus a receive. open() returns std::nullopt on platforms
+// without io_uring and on kernels too old or locked down to let us at it,
+// so callers have to be able to get by without it.
+class IoUring {
+public:
+    static std::optional<IoUring> open();
+
+    IoUring(IoUring &&) noexcept;
+    IoUring &operator=(IoUring &&) noexcept;
+    ~IoUring();
+
+    // Reads up to buffer.size() bytes from fd, waiting at most timeout for
+    // them when one is given. Returns the number of bytes read, 0 at eof,
+    // and std::nullopt on error or when the timeout fires.
+    [[nodiscard]] std::optional<std::size_t> read(
+            int fd, std::span<char> buffer, std::optional<std::chrono::nanoseconds> timeout = std::nullopt);
+
+private:
+    struct Impl;
+    explicit IoUring(std::unique_ptr<Impl>);
+    std::unique_ptr<Impl> impl_;
+};
+
 } // namespace os
 
 #endif
@@ -23,11 +23,17 @@
 #include <Shlobj.h>
 #include <shellscalingapi.h>
 
+#include <atomic>
 #include <charconv>
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
 #include <cwchar>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
 
 namespace os {
 
@@ -59,4 +65,174 @@ unsigned active_window_scale_factor() {
     return static_cast<unsigned>(std::lround(static_cast<float>(scale_factor) / 100.f));
 }
 
+struct ScaleFactorWatcher::Impl {
+    ~Impl() {
+        if (watcher.joinable()) {
+            if (HWND handle = hwnd.load()) {
+                PostMessageW(handle, WM_CLOSE, 0, 0);
+            }
+            watcher.join();
+        }
+    }
+
+    static LRESULT CALLBACK wnd_proc(HWND hwnd, UINT msg, WPARAM w_param, LPARAM l_param) {
+        switch (msg) {
+            case WM_DISPLAYCHANGE:
+            case WM_DPICHANGED: {
+                auto *impl = reinterpret_cast<Impl *>(GetWindowLongPtrW(hwnd, GWLP_USERDATA));
+                if (impl != nullptr) {
+                    auto scale = active_window_scale_factor();
+                    if (scale != impl->scale.exchange(scale) && impl->on_change) {
+                        impl->on_change(scale);
+                    }
+                }
+                return 0;
+            }
+            case WM_CLOSE:
+                DestroyWindow(hwnd);
+                return 0;
+            case WM_DESTROY:
+                PostQuitMessage(0);
+                return 0;
+            default:
+                return DefWindowProcW(hwnd, msg, w_param, l_param);
+        }
+    }
+
+    std::function<void(unsigned)> on_change{};
+    std::atomic<unsigned> scale{1};
+    std::atomic<HWND> hwnd{nullptr};
+    std::thread watcher{};
+};
+
+ScaleFactorWatcher::ScaleFactorWatcher(std::function<void(unsigned)> on_change) : impl_{std::make_unique<Impl>()} {
+    impl_->on_change = std::move(on_change);
+    impl_->scale.store(active_window_scale_factor());
+
+    // Display changes are broadcast to top-level windows, so the watcher
+    // owns an invisible one with its own message loop.
+    impl_->watcher = std::thread{[impl = impl_.get()] {
+        WNDCLASSW wc{};
+        wc.lpfnWndProc = &Impl::wnd_proc;
+        wc.hInstance = GetModuleHandleW(nullptr);
+        wc.lpszClassName = L"HasturScaleFactorWatcher";
+        RegisterClassW(&wc);
+
+        HWND hwnd = CreateWindowExW(
+                0, wc.lpszClassName, L"", 0, 0, 0, 0, 0, nullptr, nullptr, wc.hInstance, nullptr);
+        if (hwnd == nullptr) {
+            return;
+        }
+
+        SetWindowLongPtrW(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(impl));
+        impl->hwnd.store(hwnd);
+
+        MSG msg{};
+        while (GetMessageW(&msg, nullptr, 0, 0) > 0) {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+    }};
+}
+
+ScaleFactorWatcher::ScaleFactorWatcher(ScaleFactorWatcher &&) noexcept = default;
+ScaleFactorWatcher &ScaleFactorWatcher::operator=(ScaleFactorWatcher &&) noexcept = default;
+ScaleFactorWatcher::~ScaleFactorWatcher() = default;
+
+unsigned ScaleFactorWatcher::scale_factor() const {
+    return impl_->scale.load();
+}
+
+struct MemoryMappedFile::Impl {
+    ~Impl() {
+        if (data != nullptr) {
+            UnmapViewOfFile(data);
+        }
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+    }
+
+    void *data{nullptr};
+    std::size_t size{0};
+    HANDLE mapping{nullptr};
+};
+
+std::optional<MemoryMappedFile> MemoryMappedFile::map(std::string const &path) {
+    HANDLE file = CreateFileA(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+
+    LARGE_INTEGER size{};
+    if (GetFileSizeEx(file, &size) == 0) {
+        CloseHandle(file);
+        return std::nullopt;
+    }
+
+    auto impl = std::make_unique<Impl>();
+    impl->size = static_cast<std::size_t>(size.QuadPart);
+    if (impl->size > 0) {
+        impl->mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (impl->mapping == nullptr) {
+            CloseHandle(file);
+            return std::nullopt;
+        }
+
+        impl->data = MapViewOfFile(impl->mapping, FILE_MAP_READ, 0, 0, 0);
+        if (impl->data == nullptr) {
+            CloseHandle(file);
+            return std::nullopt;
+        }
+    }
+
+    // The mapping keeps the file open on its own.
+    CloseHandle(file);
+    return MemoryMappedFile{std::move(impl)};
+}
+
+MemoryMappedFile::MemoryMappedFile(std::unique_ptr<Impl> impl) : impl_{std::move(impl)} {}
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile &&) noexcept = default;
+MemoryMappedFile &MemoryMappedFile::operator=(MemoryMappedFile &&) noexcept = default;
+MemoryMappedFile::~MemoryMappedFile() = default;
+
+std::string_view MemoryMappedFile::view() const {
+    return {static_cast<char const *>(impl_->data), impl_->size};
+}
+
+// No perf counters on Windows yet.
+struct PerfCounters::Impl {};
+
+std::optional<PerfCounters> PerfCounters::open() {
+    return std::nullopt;
+}
+
+PerfCounters::PerfCounters(std::unique_ptr<Impl> impl) : impl_{std::move(impl)} {}
+PerfCounters::PerfCounters(PerfCounters &&) noexcept = default;
+PerfCounters &PerfCounters::operator=(PerfCounters &&) noexcept = default;
+PerfCounters::~PerfCounters() = default;
+
+void PerfCounters::start() {}
+
+PerfCounterValues PerfCounters::stop() {
+    return {};
+}
+
+// io_uring is a Linux thing.
+struct IoUring::Impl {};
+
+std::optional<IoUring> IoUring::open() {
+    return std::nullopt;
+}
+
+IoUring::IoUring(std::unique_ptr<Impl> impl) : impl_{std::move(impl)} {}
+IoUring::IoUring(IoUring &&) noexcept = default;
+IoUring &IoUring::operator=(IoUring &&) noexcept = default;
+IoUring::~IoUring() = default;
+
+std::optional<std::size_t> IoUring::read(int, std::span<char>, std::optional<std::chrono::nanoseconds>) {
+    return std::nullopt;
+}
+
 } // namespace os
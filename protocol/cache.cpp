@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/cache.h"
+
+#include "util/string.h"
+
+#include <fmt/format.h>
+
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+using namespace std::literals;
+
+namespace protocol {
+namespace {
+
+std::int64_t now_in_seconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+}
+
+std::optional<std::int64_t> max_age(Response const &response) {
+    auto cache_control = response.headers.get("cache-control"sv);
+    if (!cache_control) {
+        return std::nullopt;
+    }
+
+    auto pos = cache_control->find("max-age="sv);
+    if (pos == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    auto value = cache_control->substr(pos + "max-age="sv.size());
+    std::int64_t seconds{};
+    auto res = std::from_chars(value.data(), value.data() + value.size(), seconds);
+    if (res.ec != std::errc()) {
+        return std::nullopt;
+    }
+
+    return seconds;
+}
+
+std::optional<std::string> getline_or_nullopt(std::istream &is) {
+    std::string line{};
+    if (!std::getline(is, line)) {
+        return std::nullopt;
+    }
+
+    return line;
+}
+
+} // namespace
+
+std::optional<Cache::Entry> Cache::load(uri::Uri const &uri) const {
+    std::ifstream file{entry_path(uri), std::ios::binary};
+    if (!file) {
+        return std::nullopt;
+    }
+
+    // Paths are hashes of the url, so make sure this entry isn't a collision.
+    auto url = getline_or_nullopt(file);
+    if (url != uri.uri) {
+        return std::nullopt;
+    }
+
+    auto stored_at_line = getline_or_nullopt(file);
+    if (!stored_at_line) {
+        return std::nullopt;
+    }
+
+    std::int64_t stored_at{};
+    if (std::from_chars(stored_at_line->data(), stored_at_line->data() + stored_at_line->size(), stored_at).ec
+            != std::errc()) {
+        return std::nullopt;
+    }
+
+    auto status_line = getline_or_nullopt(file);
+    if (!status_line) {
+        return std::nullopt;
+    }
+
+    auto sep1 = status_line->find(' ');
+    auto sep2 = status_line->find(' ', sep1 + 1);
+    if (sep1 == std::string::npos || sep2 == std::string::npos) {
+        return std::nullopt;
+    }
+
+    int status_code{};
+    auto status_str = std::string_view{*status_line}.substr(sep1 + 1, sep2 - sep1 - 1);
+    if (std::from_chars(status_str.data(), status_str.data() + status_str.size(), status_code).ec != std::errc()) {
+        return std::nullopt;
+    }
+
+    Entry entry{
+            .response = {Error::Ok, {status_line->substr(0, sep1), status_code, status_line->substr(sep2 + 1)}},
+            .stored_at = stored_at,
+    };
+
+    while (auto header = getline_or_nullopt(file)) {
+        if (header->empty()) {
+            break;
+        }
+
+        entry.response.headers.add(util::split_once(*header, ": "sv));
+    }
+
+    std::stringstream body{};
+    body << file.rdbuf();
+    entry.response.body = std::move(body).str();
+    return entry;
+}
+
+void Cache::store(uri::Uri const &uri, Response const &response) const {
+    std::error_code ec{};
+    std::filesystem::create_directories(root_, ec);
+    if (ec) {
+        return;
+    }
+
+    std::ofstream file{entry_path(uri), std::ios::binary | std::ios::trunc};
+    if (!file) {
+        return;
+    }
+
+    file << uri.uri << '\n';
+    file << now_in_seconds() << '\n';
+    file << fmt::format("{} {} {}\n",
+            response.status_line.version,
+            response.status_line.status_code,
+            response.status_line.reason);
+    file << response.headers.to_string();
+    file << '\n';
+    file << response.body;
+}
+
+bool Cache::is_fresh(Entry const &entry) {
+    auto cache_control = entry.response.headers.get("cache-control"sv);
+    if (cache_control && cache_control->contains("no-cache"sv)) {
+        return false;
+    }
+
+    auto age_limit = max_age(entry.response);
+    if (!age_limit) {
+        return false;
+    }
+
+    return now_in_seconds() - entry.stored_at < *age_limit;
+}
+
+bool Cache::is_cacheable(Response const &response) {
+    if (response.err != Error::Ok || response.status_line.status_code != 200) {
+        return false;
+    }
+
+    auto cache_control = response.headers.get("cache-control"sv);
+    if (cache_control && cache_control->contains("no-store"sv)) {
+        return false;
+    }
+
+    // Without an age limit or a validator the entry could never be served.
+    return max_age(response).has_value() || response.headers.get("etag"sv).has_value()
+            || response.headers.get("last-modified"sv).has_value();
+}
+
+std::vector<std::pair<std::string, std::string>> Cache::conditional_headers(Response const &response) {
+    std::vector<std::pair<std::string, std::string>> headers{};
+    if (auto etag = response.headers.get("etag"sv)) {
+        headers.emplace_back("If-None-Match", std::string{*etag});
+    }
+
+    if (auto last_modified = response.headers.get("last-modified"sv)) {
+        headers.emplace_back("If-Modified-Since", std::string{*last_modified});
+    }
+
+    return headers;
+}
+
+Response Cache::update(uri::Uri const &uri, Response response, std::optional<Entry> cached) const {
+    if (response.err == Error::Ok && response.status_line.status_code == 304 && cached) {
+        // The origin says our copy is still good, so its age restarts.
+        store(uri, cached->response);
+        return std::move(cached->response);
+    }
+
+    if (is_cacheable(response)) {
+        store(uri, response);
+    }
+
+    return response;
+}
+
+std::filesystem::path Cache::entry_path(uri::Uri const &uri) const {
+    return root_ / fmt::format("{:016x}", std::hash<std::string>{}(uri.uri));
+}
+
+} // namespace protocol
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef PROTOCOL_CACHE_H_
+#define PROTOCOL_CACHE_H_
+
+#include "protocol/response.h"
+
+#include "uri/uri.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace protocol {
+
+// Disk-backed cache of responses keyed by URL. Freshness follows
+// Cache-Control max-age; stale entries are revalidated with their ETag or
+// Last-Modified validators instead of being refetched in full.
+class Cache {
+public:
+    explicit Cache(std::filesystem::path root) : root_{std::move(root)} {}
+
+    struct Entry {
+        Response response{};
+        // Seconds since the Unix epoch when the entry was (re)validated.
+        std::int64_t stored_at{};
+    };
+
+    [[nodiscard]] std::optional<Entry> load(uri::Uri const &) const;
+    void store(uri::Uri const &, Response const &) const;
+
+    // True if the entry can be served without asking the origin.
+    [[nodiscard]] static bool is_fresh(Entry const &);
+
+    // True if a response may be stored at all.
+    [[nodiscard]] static bool is_cacheable(Response const &);
+
+    // Request headers for conditionally revalidating this response.
+    [[nodiscard]] static std::vector<std::pair<std::string, std::string>> conditional_headers(Response const &);
+
+    // Applies the origin's verdict on a (possibly conditional) fetch: a 304
+    // refreshes the cached entry and serves it, and anything cacheable
+    // replaces it.
+    [[nodiscard]] Response update(uri::Uri const &, Response, std::optional<Entry> cached) const;
+
+private:
+    std::filesystem::path root_;
+
+    [[nodiscard]] std::filesystem::path entry_path(uri::Uri const &) const;
+};
+
+} // namespace protocol
+
+#endif
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "protocol/cache.h"
+
+#include "etest/etest.h"
+
+#include <filesystem>
+#include <random>
+#include <string>
+
+using namespace std::literals;
+
+using etest::expect;
+using etest::expect_eq;
+using etest::require;
+
+namespace {
+
+std::filesystem::path temporary_cache_dir() {
+    std::random_device rng{};
+    return std::filesystem::temp_directory_path() / ("hastur-cache-test-" + std::to_string(rng()));
+}
+
+protocol::Response cacheable_response() {
+    protocol::Response response{protocol::Error::Ok, {"HTTP/1.1", 200, "OK"}, {}, "<html>hello</html>"};
+    response.headers.add({"Cache-Control", "max-age=3600"});
+    response.headers.add({"ETag", "\"v1\""});
+    response.headers.add({"Last-Modified", "Thu, 17 Oct 2019 07:18:26 GMT"});
+    return response;
+}
+
+} // namespace
+
+int main() {
+    auto const cache_dir = temporary_cache_dir();
+
+    etest::test("store and load round-trip", [&] {
+        protocol::Cache cache{cache_dir};
+        auto uri = uri::Uri::parse("http://example.com/");
+
+        expect(!cache.load(uri).has_value());
+
+        cache.store(uri, cacheable_response());
+        auto entry = cache.load(uri);
+        require(entry.has_value());
+        expect_eq(entry->response.status_line.status_code, 200);
+        expect_eq(entry->response.headers.get("etag"sv).value(), "\"v1\"");
+        expect_eq(entry->response.body, "<html>hello</html>");
+        expect(protocol::Cache::is_fresh(*entry));
+    });
+
+    etest::test("entries for other urls aren't returned", [&] {
+        protocol::Cache cache{cache_dir};
+        cache.store(uri::Uri::parse("http://example.com/"), cacheable_response());
+        expect(!cache.load(uri::Uri::parse("http://example.com/other")).has_value());
+    });
+
+    etest::test("freshness follows max-age", [] {
+        protocol::Cache::Entry entry{cacheable_response(), 0};
+        // Stored at the epoch, so an hour of max-age is long gone.
+        expect(!protocol::Cache::is_fresh(entry));
+    });
+
+    etest::test("cacheability", [] {
+        expect(protocol::Cache::is_cacheable(cacheable_response()));
+
+        auto no_store = cacheable_response();
+        no_store.headers = {};
+        no_store.headers.add({"Cache-Control", "no-store"});
+        expect(!protocol::Cache::is_cacheable(no_store));
+
+        auto not_ok = cacheable_response();
+        not_ok.status_line.status_code = 404;
+        expect(!protocol::Cache::is_cacheable(not_ok));
+
+        // Nothing saying when it expires or how to revalidate it.
+        expect(!protocol::Cache::is_cacheable({protocol::Error::Ok, {"HTTP/1.1", 200, "OK"}, {}, "hello"}));
+    });
+
+    etest::test("conditional headers carry the validators", [] {
+        auto headers = protocol::Cache::conditional_headers(cacheable_response());
+        require(headers.size() == 2);
+        expect_eq(headers[0].first, "If-None-Match");
+        expect_eq(headers[0].second, "\"v1\"");
+        expect_eq(headers[1].first, "If-Modified-Since");
+        expect_eq(headers[1].second, "Thu, 17 Oct 2019 07:18:26 GMT");
+    });
+
+    etest::test("a 304 serves and refreshes the cached response", [&] {
+        protocol::Cache cache{cache_dir};
+        auto uri = uri::Uri::parse("http://example.com/revalidated");
+        cache.store(uri, cacheable_response());
+        protocol::Cache::Entry stale{cacheable_response(), 0};
+
+        protocol::Response not_modified{protocol::Error::Ok, {"HTTP/1.1", 304, "Not Modified"}};
+        auto served = cache.update(uri, std::move(not_modified), stale);
+        expect_eq(served.body, "<html>hello</html>");
+
+        auto refreshed = cache.load(uri);
+        require(refreshed.has_value());
+        expect(protocol::Cache::is_fresh(*refreshed));
+    });
+
+    etest::test("a new response replaces the cached one", [&] {
+        protocol::Cache cache{cache_dir};
+        auto uri = uri::Uri::parse("http://example.com/replaced");
+        cache.store(uri, cacheable_response());
+
+        auto changed = cacheable_response();
+        changed.body = "<html>new</html>";
+        auto served = cache.update(uri, changed, cache.load(uri));
+        expect_eq(served.body, "<html>new</html>");
+
+        auto entry = cache.load(uri);
+        require(entry.has_value());
+        expect_eq(entry->response.body, "<html>new</html>");
+    });
+
+    auto res = etest::run_all_tests();
+    std::filesystem::remove_all(cache_dir);
+    return res;
+}
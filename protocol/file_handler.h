@@ -11,7 +11,8 @@ namespace protocol {
 
 class FileHandler final : public IProtocolHandler {
 public:
-    [[nodiscard]] Response handle(uri::Uri const &uri) override;
+    // Local files can't stall, so the deadline is ignored.
+    [[nodiscard]] Response handle(uri::Uri const &uri, Deadline = std::nullopt) override;
 };
 
 } // namespace protocol
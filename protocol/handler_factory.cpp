@@ -4,20 +4,42 @@
 
 #include "protocol/handler_factory.h"
 
+#include "net/socket.h"
+#include "protocol/cache.h"
 #include "protocol/file_handler.h"
 #include "protocol/http_handler.h"
 #include "protocol/https_handler.h"
 
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
 #include <utility>
 
 namespace protocol {
 
 std::unique_ptr<MultiProtocolHandler> HandlerFactory::create(std::optional<std::string> user_agent) {
+    return create(std::move(user_agent), default_response_cache(), std::make_shared<net::TlsSessionCache>());
+}
+
+std::unique_ptr<MultiProtocolHandler> HandlerFactory::create(std::optional<std::string> user_agent,
+        std::shared_ptr<Cache> response_cache,
+        std::shared_ptr<net::TlsSessionCache> tls_sessions) {
+    // The http and https handlers share one response cache so warm reloads
+    // are served from disk no matter the scheme.
     auto handler = std::make_unique<MultiProtocolHandler>();
-    handler->add("http", std::make_unique<HttpHandler>(user_agent));
-    handler->add("https", std::make_unique<HttpsHandler>(std::move(user_agent)));
+    handler->add("http", std::make_unique<HttpHandler>(user_agent, response_cache));
+    handler->add("https",
+            std::make_unique<HttpsHandler>(std::move(user_agent), std::move(response_cache), std::move(tls_sessions)));
     handler->add("file", std::make_unique<FileHandler>());
     return handler;
 }
 
+std::shared_ptr<Cache> HandlerFactory::default_response_cache() {
+    if (std::getenv("HST_DISABLE_DISK_IO") != nullptr) {
+        return nullptr;
+    }
+
+    return std::make_shared<Cache>(std::filesystem::temp_directory_path() / "hastur" / "cache");
+}
+
 } // namespace protocol
@@ -11,12 +11,29 @@
 #include <optional>
 #include <string>
 
+namespace net {
+class TlsSessionCache;
+} // namespace net
+
 namespace protocol {
 
+class Cache;
+
 class HandlerFactory {
 public:
     [[nodiscard]] static std::unique_ptr<MultiProtocolHandler> create(
             std::optional<std::string> user_agent = std::nullopt);
+
+    // As above, but wiring in caller-provided caches, so several handler
+    // stacks (e.g. one per tab) share one response cache and one set of TLS
+    // sessions. The response cache may be nullptr to disable caching.
+    [[nodiscard]] static std::unique_ptr<MultiProtocolHandler> create(std::optional<std::string> user_agent,
+            std::shared_ptr<Cache> response_cache,
+            std::shared_ptr<net::TlsSessionCache>);
+
+    // The disk-backed response cache create() wires in when the caller
+    // doesn't provide one. nullptr when HST_DISABLE_DISK_IO is set.
+    [[nodiscard]] static std::shared_ptr<Cache> default_response_cache();
 };
 
 } // namespace protocol
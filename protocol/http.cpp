@@ -5,13 +5,14 @@
 
 #include "protocol/http.h"
 
-#include "util/string.h"
-
-#include <fmt/format.h>
-
 #include <charconv>
-#include <sstream>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 using namespace std::string_view_literals;
 
@@ -30,23 +31,59 @@ bool Http::use_port(uri::Uri const &uri) {
     return false;
 }
 
-std::string Http::create_get_request(uri::Uri const &uri, std::optional<std::string_view> user_agent) {
-    std::stringstream ss;
-    ss << fmt::format("GET {} HTTP/1.1\r\n", uri.path);
+bool Http::keeps_connection_open(Response const &response) {
+    if (response.err != Error::Ok) {
+        return false;
+    }
+
+    if (response.headers.get("connection"sv) == "close"sv) {
+        return false;
+    }
+
+    // 204 and 304 responses never carry a body, so nothing was read until
+    // close.
+    if (response.status_line.status_code == 204 || response.status_line.status_code == 304) {
+        return true;
+    }
+
+    // Redirect bodies are only drained when small and length-bounded;
+    // otherwise their bytes were left unread on the connection.
+    if (is_redirect(response.status_line.status_code) && response.headers.get("location"sv).has_value()) {
+        return drainable_redirect_body_size(response.headers).has_value();
+    }
+
+    // Without a length-bounded body, the body was read until the server
+    // closed the connection.
+    return response.headers.get("content-length"sv).has_value()
+            || response.headers.get("transfer-encoding"sv) == "chunked"sv;
+}
+
+std::vector<std::string_view> Http::create_get_request_fragments(uri::Uri const &uri,
+        std::optional<std::string_view> user_agent,
+        std::span<std::pair<std::string, std::string> const> extra_headers) {
+    std::vector<std::string_view> fragments;
+    fragments.reserve(11 + extra_headers.size() * 4);
+
+    fragments.insert(fragments.end(), {"GET "sv, uri.path, " HTTP/1.1\r\nHost: "sv, uri.authority.host});
     if (Http::use_port(uri)) {
-        ss << fmt::format("Host: {}:{}\r\n", uri.authority.host, uri.authority.port);
-    } else {
-        ss << fmt::format("Host: {}\r\n", uri.authority.host);
+        fragments.insert(fragments.end(), {":"sv, uri.authority.port});
     }
-    ss << "Accept: text/html\r\n";
-    ss << "Connection: close\r\n";
+
+    fragments.push_back(
+            "\r\n"
+            "Accept: text/html\r\n"
+            "Accept-Encoding: gzip, deflate\r\n"
+            "Connection: keep-alive\r\n"sv);
     if (user_agent) {
-        ss << fmt::format("User-Agent: {}\r\n", *user_agent);
+        fragments.insert(fragments.end(), {"User-Agent: "sv, *user_agent, "\r\n"sv});
     }
 
-    ss << "\r\n";
+    for (auto const &[name, value] : extra_headers) {
+        fragments.insert(fragments.end(), {std::string_view{name}, ": "sv, std::string_view{value}, "\r\n"sv});
+    }
 
-    return std::move(ss).str();
+    fragments.push_back("\r\n"sv);
+    return fragments;
 }
 
 std::optional<StatusLine> Http::parse_status_line(std::string_view status_line) {
@@ -76,11 +113,31 @@ std::optional<StatusLine> Http::parse_status_line(std::string_view status_line)
 
 Headers Http::parse_headers(std::string_view header) {
     Headers headers;
-    for (auto sep = header.find("\r\n"); sep != std::string_view::npos; sep = header.find("\r\n")) {
-        headers.add(util::split_once(header.substr(0, sep), ": "));
-        header.remove_prefix(sep + 2);
+
+    // Walk the raw buffer with memchr and hand out views into it; the only
+    // copies are the ones Headers makes to own its strings.
+    auto const *it = header.data();
+    auto const *end = it + header.size();
+    while (it < end) {
+        auto const *line_end = static_cast<char const *>(std::memchr(it, '\n', end - it));
+        auto const *next = line_end != nullptr ? line_end + 1 : end;
+        if (line_end == nullptr) {
+            line_end = end;
+        }
+        if (line_end > it && line_end[-1] == '\r') {
+            --line_end;
+        }
+
+        if (auto const *colon = static_cast<char const *>(std::memchr(it, ':', line_end - it))) {
+            std::string_view value{colon + 1, line_end};
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+                value.remove_prefix(1);
+            }
+            headers.add({std::string_view{it, colon}, value});
+        }
+
+        it = next;
     }
-    headers.add(util::split_once(header, ": "));
 
     return headers;
 }
@@ -8,61 +8,256 @@
 
 #include "protocol/response.h"
 
+#include "archive/zlib.h"
 #include "uri/uri.h"
 #include "util/string.h"
 
+#include <algorithm>
 #include <charconv>
+#include <cstddef>
+#include <functional>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 namespace protocol {
 
 class Http {
 public:
-    static Response get(auto &&socket, uri::Uri const &uri, std::optional<std::string_view> user_agent) {
-        using namespace std::string_view_literals;
+    // Receives pieces of the response body, with any content-encoding already
+    // decoded, as they arrive off the socket.
+    using BodySink = std::function<void(std::string_view)>;
+
+    // Receives the body size promised by Content-Length, in encoded bytes,
+    // before the first piece arrives, so a destination buffer can be sized
+    // once instead of grown per piece.
+    using SizeHint = std::function<void(std::size_t)>;
 
+    static Response get(auto &&socket,
+            uri::Uri const &uri,
+            std::optional<std::string_view> user_agent,
+            std::span<std::pair<std::string, std::string> const> extra_headers = {}) {
         if (socket.connect(uri.authority.host, Http::use_port(uri) ? uri.authority.port : uri.scheme)) {
-            socket.write(Http::create_get_request(uri, std::move(user_agent)));
-            auto data = socket.read_until("\r\n"sv);
-            if (data.empty()) {
-                return {Error::Unresolved};
+            return Http::get_on_connected(socket, uri, std::move(user_agent), extra_headers);
+        }
+
+        return {Error::Unresolved};
+    }
+
+    // Like get, but streams the body into sink as it arrives instead of
+    // buffering it in Response::body, which stays empty. Pieces may already
+    // have been delivered by the time an error is returned.
+    static Response get(auto &&socket,
+            uri::Uri const &uri,
+            std::optional<std::string_view> user_agent,
+            std::span<std::pair<std::string, std::string> const> extra_headers,
+            BodySink const &sink,
+            SizeHint const &size_hint = {}) {
+        if (socket.connect(uri.authority.host, Http::use_port(uri) ? uri.authority.port : uri.scheme)) {
+            return Http::get_on_connected(socket, uri, std::move(user_agent), extra_headers, sink, size_hint);
+        }
+
+        return {Error::Unresolved};
+    }
+
+    // Issues a request on a socket that's already connected to the right
+    // server, e.g. one kept alive from an earlier request.
+    static Response get_on_connected(auto &&socket,
+            uri::Uri const &uri,
+            std::optional<std::string_view> user_agent,
+            std::span<std::pair<std::string, std::string> const> extra_headers = {}) {
+        std::string body{};
+        auto response = Http::get_on_connected(
+                socket,
+                uri,
+                std::move(user_agent),
+                extra_headers,
+                [&body](std::string_view piece) { body += piece; },
+                [&body](std::size_t expected) {
+                    // The header is server-controlled, so it doesn't get to
+                    // pick our allocation size unbounded; bodies past the cap
+                    // fall back to geometric growth.
+                    body.reserve(std::min(expected, Http::kMaxPreallocatedBody));
+                });
+        response.body = std::move(body);
+        return response;
+    }
+
+    static Response get_on_connected(auto &&socket,
+            uri::Uri const &uri,
+            std::optional<std::string_view> user_agent,
+            std::span<std::pair<std::string, std::string> const> extra_headers,
+            BodySink const &sink,
+            SizeHint const &size_hint = {}) {
+        using namespace std::string_view_literals;
+
+        socket.write(Http::create_get_request_fragments(uri, user_agent, extra_headers));
+        auto data = socket.read_until("\r\n"sv);
+        if (data.empty()) {
+            return {Error::Unresolved};
+        }
+        auto status_line = Http::parse_status_line(data.substr(0, data.size() - 2));
+        if (!status_line) {
+            return {Error::InvalidResponse};
+        }
+        data = socket.read_until("\r\n\r\n"sv);
+        if (data.empty()) {
+            return {Error::InvalidResponse, std::move(*status_line)};
+        }
+        auto headers = Http::parse_headers(data.substr(0, data.size() - 4));
+        if (headers.size() == 0) {
+            return {Error::InvalidResponse, std::move(*status_line)};
+        }
+
+        // These responses never carry a body, and waiting for one would hang
+        // on a connection the server keeps alive.
+        if (status_line->status_code == 204 || status_line->status_code == 304) {
+            return {Error::Ok, std::move(*status_line), std::move(headers)};
+        }
+
+        // The caller follows redirects without looking at the body, so don't
+        // pay for the transfer. Bodies small enough to be cheaper than a
+        // reconnect are drained to keep the connection reusable; anything
+        // else is left unread, sacrificing the connection (see
+        // keeps_connection_open).
+        if (Http::is_redirect(status_line->status_code) && headers.get("location"sv).has_value()) {
+            if (auto drainable = Http::drainable_redirect_body_size(headers); drainable && *drainable > 0) {
+                std::ignore = socket.read_bytes(*drainable);
             }
-            auto status_line = Http::parse_status_line(data.substr(0, data.size() - 2));
-            if (!status_line) {
-                return {Error::InvalidResponse};
+
+            return {Error::Ok, std::move(*status_line), std::move(headers)};
+        }
+
+        auto content_encoding = headers.get("content-encoding"sv);
+        std::optional<archive::ZlibDecoder> decoder{};
+        if (content_encoding == "gzip"sv || content_encoding == "x-gzip"sv) {
+            decoder.emplace(archive::ZlibMode::Gzip);
+        } else if (content_encoding == "deflate"sv) {
+            decoder.emplace(archive::ZlibMode::Zlib);
+        }
+
+        auto encoding = headers.get("transfer-encoding"sv);
+        if (encoding == "chunked"sv) {
+            // Transfer chunks are fed through the decoder and on to the sink
+            // as they arrive, so decompression and consumption overlap the
+            // download.
+            if (!Http::stream_chunked_body(socket, decoder ? &*decoder : nullptr, sink)) {
+                return {Error::InvalidResponse, std::move(*status_line)};
             }
-            data = socket.read_until("\r\n\r\n"sv);
-            if (data.empty()) {
+
+            if (decoder && !decoder->finished()) {
                 return {Error::InvalidResponse, std::move(*status_line)};
             }
-            auto headers = Http::parse_headers(data.substr(0, data.size() - 4));
-            if (headers.size() == 0) {
+
+            return {Error::Ok, std::move(*status_line), std::move(headers)};
+        }
+
+        if (auto content_length = headers.get("content-length"sv)) {
+            std::size_t length{};
+            auto result = std::from_chars(content_length->data(), content_length->data() + content_length->size(), length);
+            if (result.ec != std::errc()) {
                 return {Error::InvalidResponse, std::move(*status_line)};
             }
-            auto encoding = headers.get("transfer-encoding"sv);
-            if (encoding == "chunked"sv) {
-                if (auto body = Http::get_chunked_body(socket)) {
-                    data = *body;
-                } else {
+
+            if (size_hint) {
+                size_hint(length);
+            }
+
+            // A short read means the server closed the connection mid-body.
+            // read_all gave us truncated bodies in that case too, so keep the
+            // data; the connection just won't be reused.
+            constexpr std::size_t kReadSize = std::size_t{64} * 1024;
+            for (std::size_t received = 0; received < length;) {
+                auto piece = socket.read_bytes(std::min(kReadSize, length - received));
+                if (piece.empty()) {
+                    break;
+                }
+
+                received += piece.size();
+                if (!Http::deliver(sink, decoder ? &*decoder : nullptr, piece)) {
                     return {Error::InvalidResponse, std::move(*status_line)};
                 }
-            } else {
-                data = socket.read_all();
             }
-            return {Error::Ok, std::move(*status_line), std::move(headers), std::move(data)};
+        } else {
+            // The socket api blocks until the server closes the connection
+            // here, so there's nothing to overlap with.
+            if (!Http::deliver(sink, decoder ? &*decoder : nullptr, socket.read_all())) {
+                return {Error::InvalidResponse, std::move(*status_line)};
+            }
         }
 
-        return {Error::Unresolved};
+        if (decoder && !decoder->finished()) {
+            return {Error::InvalidResponse, std::move(*status_line)};
+        }
+
+        return {Error::Ok, std::move(*status_line), std::move(headers)};
     }
 
+    // True if the server left the connection open after this response: the
+    // body was length-bounded rather than read until close, and the server
+    // didn't ask to tear the connection down.
+    [[nodiscard]] static bool keeps_connection_open(Response const &);
+
+    // True for the status codes whose Location header callers follow.
+    [[nodiscard]] static bool is_redirect(int status_code) {
+        return status_code == 301 || status_code == 302 || status_code == 307 || status_code == 308;
+    }
+
+    static bool use_port(uri::Uri const &uri);
+
 private:
-    static std::optional<std::string> get_chunked_body(auto &socket) {
+    // A redirect body this small is cheaper to read and throw away than the
+    // reconnect that abandoning the connection would cost.
+    static constexpr std::size_t kMaxDrainedRedirectBody{std::size_t{4} * 1024};
+
+    // The most Content-Length alone can make us allocate up-front.
+    static constexpr std::size_t kMaxPreallocatedBody{std::size_t{64} * 1024 * 1024};
+
+    // The size of the redirect body if it's worth draining to keep the
+    // connection alive, and nullopt if it should be left unread instead.
+    static std::optional<std::size_t> drainable_redirect_body_size(Headers const &headers) {
+        using namespace std::string_view_literals;
+        if (headers.get("transfer-encoding"sv) == "chunked"sv) {
+            return std::nullopt;
+        }
+
+        auto content_length = headers.get("content-length"sv);
+        if (!content_length) {
+            return std::nullopt;
+        }
+
+        std::size_t length{};
+        auto result = std::from_chars(content_length->data(), content_length->data() + content_length->size(), length);
+        if (result.ec != std::errc() || length > kMaxDrainedRedirectBody) {
+            return std::nullopt;
+        }
+
+        return length;
+    }
+
+    // Decodes piece if needed and hands it to the sink.
+    static bool deliver(BodySink const &sink, archive::ZlibDecoder *decoder, std::string_view piece) {
+        if (decoder != nullptr) {
+            auto decoded = decoder->decode(piece);
+            if (!decoded) {
+                return false;
+            }
+
+            sink(*decoded);
+            return true;
+        }
+
+        sink(piece);
+        return true;
+    }
+
+    static bool stream_chunked_body(auto &socket, archive::ZlibDecoder *decoder, BodySink const &sink) {
         using namespace std::literals;
 
-        std::string body{};
         while (true) {
             // Read first part of chunk
             std::string bytes = socket.read_until("\r\n"sv);
@@ -84,7 +279,7 @@ private:
             if (chunk_size == 0) {
                 // TODO(mkiael): Handle trailer part
                 socket.read_until("\r\n"sv);
-                return body;
+                return true;
             }
 
             // Read chunk from socket
@@ -93,8 +288,10 @@ private:
                 break;
             }
 
-            // Append chunk to body
-            body += bytes;
+            // Hand the chunk to the consumer
+            if (!Http::deliver(sink, decoder, bytes)) {
+                break;
+            }
 
             // Read trailing \r\n before continuing with the next chunk
             bytes = socket.read_bytes(2);
@@ -102,11 +299,16 @@ private:
                 break;
             }
         }
-        return std::nullopt;
+        return false;
     }
 
-    static bool use_port(uri::Uri const &uri);
-    static std::string create_get_request(uri::Uri const &uri, std::optional<std::string_view> user_agent);
+    // The request as constant fragments plus views into the arguments, for
+    // the sockets' scatter-gather write. Assembling the request this way
+    // copies nothing; the views are only good for as long as the arguments
+    // live.
+    static std::vector<std::string_view> create_get_request_fragments(uri::Uri const &uri,
+            std::optional<std::string_view> user_agent,
+            std::span<std::pair<std::string, std::string> const> extra_headers = {});
     static std::optional<StatusLine> parse_status_line(std::string_view status_line);
     static Headers parse_headers(std::string_view header);
 };
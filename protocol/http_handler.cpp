@@ -6,12 +6,88 @@
 #include "protocol/http_handler.h"
 
 #include "net/socket.h"
+#include "protocol/cache.h"
 #include "protocol/http.h"
 
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace protocol {
 
-Response HttpHandler::handle(uri::Uri const &uri) {
-    return Http::get(net::Socket{}, uri, user_agent_);
+Response HttpHandler::handle(uri::Uri const &uri, Deadline deadline) {
+    if (cache_ == nullptr) {
+        return fetch(uri, {}, deadline);
+    }
+
+    auto cached = cache_->load(uri);
+    if (cached && Cache::is_fresh(*cached)) {
+        return std::move(cached->response);
+    }
+
+    std::vector<std::pair<std::string, std::string>> conditional{};
+    if (cached) {
+        conditional = Cache::conditional_headers(cached->response);
+    }
+
+    return cache_->update(uri, fetch(uri, conditional, deadline), std::move(cached));
+}
+
+Response HttpHandler::fetch(
+        uri::Uri const &uri, std::span<std::pair<std::string, std::string> const> extra_headers, Deadline deadline) {
+    if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+        return {Error::Timeout};
+    }
+
+    auto key = std::pair{uri.authority.host, std::string{Http::use_port(uri) ? uri.authority.port : uri.scheme}};
+
+    std::optional<net::Socket> pooled{};
+    {
+        std::scoped_lock lock{connections_mutex_};
+        if (auto it = connections_.find(key); it != connections_.end()) {
+            pooled = std::move(it->second);
+            connections_.erase(it);
+        }
+    }
+
+    if (pooled) {
+        pooled->set_deadline(deadline);
+        auto response = Http::get_on_connected(*pooled, uri, user_agent_, extra_headers);
+        if (response.err == Error::Ok) {
+            if (Http::keeps_connection_open(response)) {
+                std::scoped_lock lock{connections_mutex_};
+                connections_.insert_or_assign(std::move(key), std::move(*pooled));
+            }
+
+            return response;
+        }
+
+        // The server probably closed the pooled connection while it sat idle.
+        // Retry on a fresh one.
+    }
+
+    net::Socket socket{};
+    if (connect_timeout_) {
+        socket.set_connect_timeout(*connect_timeout_);
+    }
+    socket.set_deadline(deadline);
+
+    auto response = Http::get(socket, uri, user_agent_, extra_headers);
+    if (Http::keeps_connection_open(response)) {
+        std::scoped_lock lock{connections_mutex_};
+        connections_.insert_or_assign(std::move(key), std::move(socket));
+    }
+
+    if (response.err != Error::Ok && deadline && std::chrono::steady_clock::now() >= *deadline) {
+        // The socket gave up because the deadline passed, not because the
+        // server misbehaved.
+        return {Error::Timeout};
+    }
+
+    return response;
 }
 
 } // namespace protocol
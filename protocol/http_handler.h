@@ -7,7 +7,15 @@
 
 #include "protocol/iprotocol_handler.h"
 
+#include "net/socket.h"
+#include "protocol/cache.h"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <utility>
 
@@ -15,12 +23,27 @@ namespace protocol {
 
 class HttpHandler final : public IProtocolHandler {
 public:
-    explicit HttpHandler(std::optional<std::string> user_agent) : user_agent_{std::move(user_agent)} {}
+    explicit HttpHandler(std::optional<std::string> user_agent, std::shared_ptr<Cache> cache = nullptr)
+        : user_agent_{std::move(user_agent)}, cache_{std::move(cache)} {}
+
+    [[nodiscard]] Response handle(uri::Uri const &, Deadline deadline = std::nullopt) override;
 
-    [[nodiscard]] Response handle(uri::Uri const &) override;
+    // Applied to every socket this handler creates.
+    void set_connect_timeout(std::chrono::milliseconds timeout) { connect_timeout_ = timeout; }
 
 private:
+    [[nodiscard]] Response fetch(uri::Uri const &, std::span<std::pair<std::string, std::string> const>, Deadline);
+
     std::optional<std::string> user_agent_;
+    std::shared_ptr<Cache> cache_;
+    std::optional<std::chrono::milliseconds> connect_timeout_;
+
+    // Connections the server kept alive after a response, keyed by host and
+    // service, ready to be reused for the next request to the same origin.
+    // Sockets are checked out of the pool while in use, so the mutex only
+    // guards the map itself and parallel fetches don't serialize.
+    std::mutex connections_mutex_;
+    std::map<std::pair<std::string, std::string>, net::Socket> connections_;
 };
 
 } // namespace protocol
@@ -6,10 +6,18 @@
 
 #include "etest/etest.h"
 
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
+using namespace std::string_literals;
 using namespace std::string_view_literals;
 
+using etest::expect;
 using etest::expect_eq;
 using etest::require;
 
@@ -22,8 +30,11 @@ struct FakeSocket {
         return connect_result;
     }
 
-    std::size_t write(std::string_view data) {
-        write_data = data;
+    std::size_t write(std::span<std::string_view const> fragments) {
+        write_data.clear();
+        for (auto const &fragment : fragments) {
+            write_data += fragment;
+        }
         return write_data.size();
     }
 
@@ -74,7 +85,7 @@ int main() {
         FakeSocket socket;
         socket.read_data =
                 "HTTP/1.1 200 OK\r\n"
-                "Content-Encoding: gzip\r\n"
+                "Content-Encoding: identity\r\n"
                 "Accept-Ranges: bytes\r\n"
                 "Age: 367849\r\n"
                 "Cache-Control: max-age=604800\r\n"
@@ -103,7 +114,7 @@ int main() {
         expect_eq(response.status_line.version, "HTTP/1.1");
         expect_eq(response.status_line.status_code, 200);
         expect_eq(response.status_line.reason, "OK");
-        expect_eq(response.headers.get("Content-Encoding"sv).value(), "gzip");
+        expect_eq(response.headers.get("Content-Encoding"sv).value(), "identity");
         expect_eq(response.headers.get("Accept-Ranges"sv).value(), "bytes");
         expect_eq(response.headers.get("Age"sv).value(), "367849");
         expect_eq(response.headers.get("Cache-Control"sv).value(), "max-age=604800");
@@ -154,6 +165,44 @@ int main() {
         expect_eq(response.status_line.reason, "Moved Permanently");
     });
 
+    etest::test("small redirect bodies are drained and the connection kept", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 301 Moved Permanently\r\n"
+                "Location: http://example.com/new\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "hello";
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::Ok);
+        // The body is thrown away, but it's been read off the socket so the
+        // connection can serve the next request.
+        expect_eq(response.body, "");
+        expect_eq(socket.read_data, "");
+        require(protocol::Http::keeps_connection_open(response));
+    });
+
+    etest::test("large redirect bodies are left unread", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 301 Moved Permanently\r\n"
+                "Location: http://example.com/new\r\n"
+                "Content-Length: 5000\r\n"
+                "\r\n"
+                + std::string(5000, 'a');
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(response.body, "");
+        // The unread body is still sitting on the connection, so it mustn't
+        // be reused.
+        expect_eq(socket.read_data.size(), std::size_t{5000});
+        require(!protocol::Http::keeps_connection_open(response));
+    });
+
     etest::test("transfer-encoding chunked, real body", [] {
         auto socket = create_chunked_socket(
                 "7f\r\n"
@@ -250,6 +299,243 @@ int main() {
         expect_eq(response.err, protocol::Error::InvalidResponse);
     });
 
+    etest::test("the request advertises compression support", [] {
+        FakeSocket socket;
+        socket.read_data = "HTTP/1.1 404 Not Found\r\n\r\n";
+        std::ignore = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        require(socket.write_data.contains("Accept-Encoding: gzip, deflate\r\n"));
+    });
+
+    etest::test("content-encoding gzip", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Encoding: gzip\r\n"
+                "Content-Length: 25\r\n"
+                "\r\n"
+                "\037\213\010\000\000\000\000\000\002\003\313\110\315\311\311\007\000\206\246\020\066\005\000\000\000"s;
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(response.body, "hello");
+    });
+
+    etest::test("content-encoding deflate", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Encoding: deflate\r\n"
+                "Content-Length: 13\r\n"
+                "\r\n"
+                "\170\234\313\110\315\311\311\007\000\006\054\002\025"s;
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(response.body, "hello");
+    });
+
+    etest::test("content-encoding gzip, corrupt body", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Encoding: gzip\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "hello";
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::InvalidResponse);
+    });
+
+    etest::test("content-encoding gzip, chunked transfer", [] {
+        // The compressed body is split across two transfer chunks.
+        auto socket = create_chunked_socket(
+                "a\r\n\037\213\010\000\000\000\000\000\002\003\r\n"
+                "f\r\n\313\110\315\311\311\007\000\206\246\020\066\005\000\000\000\r\n"
+                "0\r\n\r\n"s);
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Encoding: gzip\r\n"
+                + socket.read_data.substr(socket.read_data.find("Transfer-Encoding"));
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(response.body, "hello");
+    });
+
+    etest::test("the request asks to keep the connection alive", [] {
+        FakeSocket socket;
+        socket.read_data = "HTTP/1.1 404 Not Found\r\n\r\n";
+        std::ignore = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        require(socket.write_data.contains("Connection: keep-alive\r\n"));
+    });
+
+    etest::test("content-length bounds the body read", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "hello"
+                "HTTP/1.1 200 OK\r\n";
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.body, "hello");
+        // The start of the next response is still in the socket.
+        expect_eq(socket.read_data, "HTTP/1.1 200 OK\r\n");
+        require(protocol::Http::keeps_connection_open(response));
+    });
+
+    etest::test("content-length, invalid value", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: lots\r\n"
+                "\r\n"
+                "hello";
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::InvalidResponse);
+    });
+
+    etest::test("connection: close responses aren't reusable", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: 5\r\n"
+                "Connection: close\r\n"
+                "\r\n"
+                "hello";
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.body, "hello");
+        require(!protocol::Http::keeps_connection_open(response));
+    });
+
+    etest::test("read-until-close responses aren't reusable", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Server: hello\r\n"
+                "\r\n"
+                "hello";
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.body, "hello");
+        require(!protocol::Http::keeps_connection_open(response));
+    });
+
+    etest::test("extra headers are sent", [] {
+        FakeSocket socket;
+        socket.read_data = "HTTP/1.1 304 Not Modified\r\nETag: \"v1\"\r\n\r\n";
+        std::vector<std::pair<std::string, std::string>> conditional{{"If-None-Match", "\"v1\""}};
+        std::ignore = protocol::Http::get(socket, create_uri(), std::nullopt, conditional);
+
+        require(socket.write_data.contains("If-None-Match: \"v1\"\r\n"));
+    });
+
+    etest::test("304 responses have no body", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 304 Not Modified\r\n"
+                "ETag: \"v1\"\r\n"
+                "\r\n";
+
+        auto response = protocol::Http::get(socket, create_uri(), std::nullopt);
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(response.status_line.status_code, 304);
+        expect_eq(response.body, "");
+        // No body also means nothing was read until close.
+        require(protocol::Http::keeps_connection_open(response));
+    });
+
+    etest::test("body pieces stream into the sink", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "hello";
+
+        std::string streamed{};
+        auto response = protocol::Http::get(
+                socket, create_uri(), std::nullopt, {}, [&streamed](std::string_view piece) { streamed += piece; });
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(streamed, "hello");
+        // Streamed bodies aren't buffered in the response.
+        expect_eq(response.body, "");
+    });
+
+    etest::test("the size hint sees the content length before any body piece", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "hello";
+
+        std::string streamed{};
+        std::optional<std::size_t> hinted{};
+        auto response = protocol::Http::get(
+                socket,
+                create_uri(),
+                std::nullopt,
+                {},
+                [&](std::string_view piece) {
+                    expect(hinted.has_value());
+                    streamed += piece;
+                },
+                [&](std::size_t expected) { hinted = expected; });
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(hinted, std::size_t{5});
+        expect_eq(streamed, "hello");
+    });
+
+    etest::test("chunked transfer streams one piece per chunk", [] {
+        auto socket = create_chunked_socket("5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n"s);
+
+        std::vector<std::string> pieces{};
+        auto response = protocol::Http::get(
+                socket, create_uri(), std::nullopt, {}, [&pieces](std::string_view piece) {
+                    pieces.emplace_back(piece);
+                });
+
+        expect_eq(response.err, protocol::Error::Ok);
+        require(pieces.size() == 2);
+        expect_eq(pieces[0], "hello");
+        expect_eq(pieces[1], " world");
+    });
+
+    etest::test("the sink sees decoded data", [] {
+        FakeSocket socket;
+        socket.read_data =
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Encoding: gzip\r\n"
+                "Content-Length: 25\r\n"
+                "\r\n"
+                "\037\213\010\000\000\000\000\000\002\003\313\110\315\311\311\007\000\206\246\020\066\005\000\000\000"s;
+
+        std::string streamed{};
+        auto response = protocol::Http::get(
+                socket, create_uri(), std::nullopt, {}, [&streamed](std::string_view piece) { streamed += piece; });
+
+        expect_eq(response.err, protocol::Error::Ok);
+        expect_eq(streamed, "hello");
+    });
+
     etest::test("404 no headers no body", [] {
         FakeSocket socket;
         socket.read_data = "HTTP/1.1 404 Not Found\r\n\r\n";
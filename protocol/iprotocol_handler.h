@@ -9,12 +9,31 @@
 
 #include "uri/uri.h"
 
+#include <chrono>
+#include <future>
+#include <optional>
+
 namespace protocol {
 
+// When the request must be done by. A request that would run past its
+// deadline gives up with Error::Timeout instead; no deadline means it may
+// take as long as it takes.
+using Deadline = std::optional<std::chrono::steady_clock::time_point>;
+
 class IProtocolHandler {
 public:
     virtual ~IProtocolHandler() = default;
-    [[nodiscard]] virtual Response handle(uri::Uri const &) = 0;
+
+    // Must be safe to call from several threads at once: handle_async relies
+    // on it, and callers fetch subresources in parallel. Handlers whose IO
+    // can't stall (e.g. local files) are free to ignore the deadline.
+    [[nodiscard]] virtual Response handle(uri::Uri const &, Deadline deadline = std::nullopt) = 0;
+
+    // Starts the request immediately and returns a future for its response,
+    // letting the caller issue many requests before waiting on any of them.
+    [[nodiscard]] virtual std::future<Response> handle_async(uri::Uri const &uri, Deadline deadline = std::nullopt) {
+        return std::async(std::launch::async, [this, uri, deadline] { return handle(uri, deadline); });
+    }
 };
 
 } // namespace protocol
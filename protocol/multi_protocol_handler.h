@@ -2,32 +2,96 @@
 //
 // SPDX-License-Identifier: BSD-2-Clause
 
+#ifndef PROTOCOL_MULTI_PROTOCOL_HANDLER_H_
+#define PROTOCOL_MULTI_PROTOCOL_HANDLER_H_
+
 #include "protocol/iprotocol_handler.h"
 
+#include "uri/uri.h"
+
+#include <array>
+#include <cstddef>
 #include <functional>
+#include <future>
 #include <map>
 #include <memory>
+#include <span>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace protocol {
 
 class MultiProtocolHandler final : public IProtocolHandler {
 public:
     void add(std::string protocol, std::unique_ptr<IProtocolHandler> handler) {
+        if (auto scheme = uri::scheme_from_string(protocol); scheme != uri::Scheme::Unknown) {
+            interned_handlers_[static_cast<std::size_t>(scheme)] = std::move(handler);
+            return;
+        }
+
         handlers_[std::move(protocol)] = std::move(handler);
     }
 
-    [[nodiscard]] Response handle(uri::Uri const &uri) override {
-        if (!handlers_.contains(uri.scheme)) {
-            return {Error::Unhandled};
+    [[nodiscard]] Response handle(uri::Uri const &uri, Deadline deadline = std::nullopt) override {
+        if (auto *handler = handler_for(uri); handler != nullptr) {
+            return handler->handle(uri, deadline);
+        }
+
+        return {Error::Unhandled};
+    }
+
+    [[nodiscard]] std::future<Response> handle_async(uri::Uri const &uri, Deadline deadline = std::nullopt) override {
+        if (auto *handler = handler_for(uri); handler != nullptr) {
+            return handler->handle_async(uri, deadline);
+        }
+
+        std::promise<Response> unhandled{};
+        unhandled.set_value({Error::Unhandled});
+        return unhandled.get_future();
+    }
+
+    // Fetches all uris concurrently, returning the responses in request
+    // order once the last one has arrived.
+    [[nodiscard]] std::vector<Response> handle_all(std::span<uri::Uri const> uris) {
+        std::vector<std::future<Response>> futures;
+        futures.reserve(uris.size());
+        for (auto const &uri : uris) {
+            futures.push_back(handle_async(uri));
+        }
+
+        std::vector<Response> responses;
+        responses.reserve(futures.size());
+        for (auto &future : futures) {
+            responses.push_back(future.get());
         }
 
-        return handlers_[uri.scheme]->handle(uri);
+        return responses;
     }
 
 private:
+    [[nodiscard]] IProtocolHandler *handler_for(uri::Uri const &uri) {
+        // Hand-built uris may not have gone through Uri::parse, so intern on
+        // the fly for them.
+        auto scheme = uri.scheme_id != uri::Scheme::Unknown ? uri.scheme_id : uri::scheme_from_string(uri.scheme);
+        if (scheme != uri::Scheme::Unknown) {
+            return interned_handlers_[static_cast<std::size_t>(scheme)].get();
+        }
+
+        if (auto it = handlers_.find(uri.scheme); it != handlers_.end()) {
+            return it->second.get();
+        }
+
+        return nullptr;
+    }
+
+    // Handlers for the schemes Uri::parse interns, indexed by uri::Scheme.
+    std::array<std::unique_ptr<IProtocolHandler>, uri::kSchemeCount> interned_handlers_{};
+
+    // Everything else, dispatched by scheme string.
     std::map<std::string, std::unique_ptr<IProtocolHandler>, std::less<>> handlers_;
 };
 
 } // namespace protocol
+
+#endif
@@ -6,7 +6,11 @@
 
 #include "etest/etest.h"
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <utility>
+#include <vector>
 
 using etest::expect_eq;
 using protocol::MultiProtocolHandler;
@@ -16,7 +20,12 @@ namespace {
 class FakeProtocolHandler final : public protocol::IProtocolHandler {
 public:
     explicit FakeProtocolHandler(protocol::Response response) : response_{std::move(response)} {}
-    [[nodiscard]] protocol::Response handle(uri::Uri const &) override { return response_; }
+    [[nodiscard]] protocol::Response handle(uri::Uri const &, protocol::Deadline deadline = std::nullopt) override {
+        last_deadline = deadline;
+        return response_;
+    }
+
+    protocol::Deadline last_deadline{};
 
 private:
     protocol::Response response_;
@@ -33,5 +42,54 @@ int main() {
         expect_eq(handler.handle(uri::Uri{.scheme = "hax"}).err, protocol::Error::Ok);
     });
 
+    etest::test("interned schemes are handled", [] {
+        MultiProtocolHandler handler;
+        handler.add("http", std::make_unique<FakeProtocolHandler>(protocol::Response{protocol::Error::Ok}));
+
+        expect_eq(handler.handle(uri::Uri::parse("http://example.com")).err, protocol::Error::Ok);
+        // Hand-built uris never went through parse, but should dispatch the same.
+        expect_eq(handler.handle(uri::Uri{.scheme = "http"}).err, protocol::Error::Ok);
+        expect_eq(handler.handle(uri::Uri::parse("https://example.com")).err, protocol::Error::Unhandled);
+    });
+
+    etest::test("async requests", [] {
+        MultiProtocolHandler handler;
+        expect_eq(handler.handle_async(uri::Uri{.scheme = "hax"}).get().err, protocol::Error::Unhandled);
+
+        handler.add("hax", std::make_unique<FakeProtocolHandler>(protocol::Response{protocol::Error::Ok}));
+        expect_eq(handler.handle_async(uri::Uri{.scheme = "hax"}).get().err, protocol::Error::Ok);
+    });
+
+    etest::test("deadlines reach the dispatched-to handler", [] {
+        MultiProtocolHandler handler;
+        auto fake = std::make_unique<FakeProtocolHandler>(protocol::Response{protocol::Error::Ok});
+        auto *hax = fake.get();
+        handler.add("hax", std::move(fake));
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{1};
+        expect_eq(handler.handle(uri::Uri{.scheme = "hax"}, deadline).err, protocol::Error::Ok);
+        expect_eq(hax->last_deadline, protocol::Deadline{deadline});
+
+        expect_eq(handler.handle(uri::Uri{.scheme = "hax"}).err, protocol::Error::Ok);
+        expect_eq(hax->last_deadline, protocol::Deadline{});
+    });
+
+    etest::test("concurrent fetches arrive in request order", [] {
+        MultiProtocolHandler handler;
+        handler.add("hax", std::make_unique<FakeProtocolHandler>(protocol::Response{protocol::Error::Ok}));
+
+        std::vector<uri::Uri> uris{
+                uri::Uri{.scheme = "hax"},
+                uri::Uri{.scheme = "nope"},
+                uri::Uri{.scheme = "hax"},
+        };
+        auto responses = handler.handle_all(uris);
+
+        expect_eq(responses.size(), std::size_t{3});
+        expect_eq(responses[0].err, protocol::Error::Ok);
+        expect_eq(responses[1].err, protocol::Error::Unhandled);
+        expect_eq(responses[2].err, protocol::Error::Ok);
+    });
+
     return etest::run_all_tests();
 }
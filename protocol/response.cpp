@@ -7,7 +7,7 @@
 
 #include "util/string.h"
 
-#include <algorithm>
+#include <cstdint>
 #include <sstream>
 #include <utility>
 
@@ -36,9 +36,18 @@ std::size_t Headers::size() const {
     return headers_.size();
 }
 
-bool Headers::CaseInsensitiveLess::operator()(std::string_view s1, std::string_view s2) const {
-    return std::ranges::lexicographical_compare(
-            s1, s2, [](char c1, char c2) { return util::lowercased(c1) < util::lowercased(c2); });
+std::size_t Headers::LowercasedHash::operator()(std::string_view s) const {
+    // FNV-1a over the lowercased name.
+    std::uint64_t hash = 0xcbf2'9ce4'8422'2325;
+    for (char c : s) {
+        hash ^= static_cast<unsigned char>(util::lowercased(c));
+        hash *= 0x100'0000'01b3;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+bool Headers::CaseInsensitiveEqual::operator()(std::string_view s1, std::string_view s2) const {
+    return util::iequals(s1, s2);
 }
 
 } // namespace protocol
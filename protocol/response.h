@@ -7,11 +7,14 @@
 #define PROTOCOL_RESPONSE_H_
 
 #include <cstddef>
-#include <map>
+#include <memory>
 #include <optional>
+#include <ostream>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
+#include <variant>
 
 namespace protocol {
 
@@ -20,6 +23,7 @@ enum class Error {
     Unresolved,
     Unhandled,
     InvalidResponse,
+    Timeout,
 };
 
 struct StatusLine {
@@ -40,18 +44,75 @@ public:
     [[nodiscard]] bool operator==(Headers const &) const = default;
 
 private:
-    struct CaseInsensitiveLess {
+    struct LowercasedHash {
         using is_transparent = void;
-        bool operator()(std::string_view s1, std::string_view s2) const;
+        [[nodiscard]] std::size_t operator()(std::string_view) const;
     };
-    std::map<std::string, std::string, CaseInsensitiveLess> headers_;
+    struct CaseInsensitiveEqual {
+        using is_transparent = void;
+        [[nodiscard]] bool operator()(std::string_view, std::string_view) const;
+    };
+    // Names hash lowercased, so a lookup doesn't care what case the server
+    // sent the header in and costs one hash instead of a scan.
+    std::unordered_map<std::string, std::string, LowercasedHash, CaseInsensitiveEqual> headers_;
+};
+
+// A response body: immutable bytes with shared ownership. Copying a body
+// (e.g. into the page cache) bumps a refcount instead of copying the bytes,
+// so the document text can be referred to from several places with one
+// owner. The bytes can also be a view of memory owned by something else,
+// e.g. a memory-mapped file, in which case the backing keeps the memory
+// alive for as long as any copy of the body is around.
+class Body {
+public:
+    Body() = default;
+    Body(std::string data) : data_{std::make_shared<std::string const>(std::move(data))} {}
+    Body(char const *data) : data_{std::make_shared<std::string const>(data)} {}
+
+    [[nodiscard]] static Body view_of(std::string_view data, std::shared_ptr<void const> backing) {
+        Body body{};
+        body.data_ = View{data, std::move(backing)};
+        return body;
+    }
+
+    operator std::string_view() const { return view(); }
+    [[nodiscard]] std::string_view view() const {
+        if (auto const *owned = std::get_if<std::shared_ptr<std::string const>>(&data_)) {
+            return *owned != nullptr ? std::string_view{**owned} : std::string_view{};
+        }
+        return std::get<View>(data_).data;
+    }
+
+    // Shared ownership of the body's backing bytes, for consumers that keep
+    // views into the body alive past the response itself.
+    [[nodiscard]] std::shared_ptr<void const> backing() const {
+        if (auto const *owned = std::get_if<std::shared_ptr<std::string const>>(&data_)) {
+            return *owned;
+        }
+        return std::get<View>(data_).backing;
+    }
+
+    [[nodiscard]] std::size_t size() const { return view().size(); }
+    [[nodiscard]] char const *data() const { return view().data(); }
+
+    // Bodies compare by content no matter how the bytes are held.
+    [[nodiscard]] bool operator==(Body const &other) const { return view() == other.view(); }
+    friend std::ostream &operator<<(std::ostream &os, Body const &body) { return os << body.view(); }
+
+private:
+    struct View {
+        std::string_view data{};
+        std::shared_ptr<void const> backing{};
+    };
+
+    std::variant<std::shared_ptr<std::string const>, View> data_{};
 };
 
 struct Response {
     Error err;
     StatusLine status_line;
     Headers headers;
-    std::string body;
+    Body body;
 
     [[nodiscard]] bool operator==(Response const &) const = default;
 };
@@ -27,5 +27,13 @@ int main() {
         expect_eq(headers.get("cOnTeNt-TyPe"sv).value(), "text/html");
     });
 
+    etest::test("copied bodies share their bytes", [] {
+        protocol::Body body{"<html>hello</html>"};
+        protocol::Body copy = body; // NOLINT(performance-unnecessary-copy-initialization)
+
+        expect_eq(copy, body);
+        expect_eq(copy.data(), body.data());
+    });
+
     return etest::run_all_tests();
 }
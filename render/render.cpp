@@ -10,13 +10,16 @@
 #include "gfx/color.h"
 #include "util/from_chars.h"
 #include "util/string.h"
+#include "util/trace.h"
 
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
 #include <charconv>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <optional>
 #include <sstream>
 #include <string_view>
 #include <variant>
@@ -26,8 +29,6 @@ using namespace std::literals;
 namespace render {
 namespace {
 
-constexpr gfx::Color kDefaultColor{0x0, 0x0, 0x0};
-
 bool has_any_border(geom::EdgeSize const &border) {
     return border != geom::EdgeSize{};
 }
@@ -65,23 +66,26 @@ void render_text(gfx::Painter &painter, layout::LayoutBox const &layout, dom::Te
 }
 
 void render_element(gfx::Painter &painter, layout::LayoutBox const &layout) {
-    auto background_color = layout.get_property<css::PropertyId::BackgroundColor>().value();
     auto const &border_size = layout.dimensions.border;
-    if (has_any_border(border_size)) {
-        gfx::Borders borders{};
-        borders.left.color = layout.get_property<css::PropertyId::BorderLeftColor>().value_or(kDefaultColor);
-        borders.left.size = border_size.left;
-        borders.right.color = layout.get_property<css::PropertyId::BorderRightColor>().value_or(kDefaultColor);
-        borders.right.size = border_size.right;
-        borders.top.color = layout.get_property<css::PropertyId::BorderTopColor>().value_or(kDefaultColor);
-        borders.top.size = border_size.top;
-        borders.bottom.color = layout.get_property<css::PropertyId::BorderBottomColor>().value_or(kDefaultColor);
-        borders.bottom.size = border_size.bottom;
-
-        painter.draw_rect(layout.dimensions.padding_box(), background_color, borders);
-    } else if (!is_fully_transparent(background_color)) {
-        painter.draw_rect(layout.dimensions.padding_box(), background_color, gfx::Borders{});
+    if (!has_any_border(border_size)) {
+        auto background_color = layout.get_property<css::PropertyId::BackgroundColor>().value();
+        if (!is_fully_transparent(background_color)) {
+            painter.draw_rect(layout.dimensions.padding_box(), background_color, gfx::Borders{});
+        }
+        return;
     }
+
+    // A bordered box needs five colors; get_box_colors resolves them in one
+    // pass over the node's properties, and the whole decoration goes out as
+    // one command.
+    auto colors = layout.node->get_box_colors();
+    gfx::Borders borders{
+            {colors.border_left, border_size.left},
+            {colors.border_right, border_size.right},
+            {colors.border_top, border_size.top},
+            {colors.border_bottom, border_size.bottom},
+    };
+    painter.draw_rect(layout.dimensions.padding_box(), colors.background, borders);
 }
 
 void do_render(gfx::Painter &painter, layout::LayoutBox const &layout) {
@@ -96,18 +100,34 @@ bool should_render(layout::LayoutBox const &layout) {
     return layout.type == layout::LayoutType::Block || layout.type == layout::LayoutType::Inline;
 }
 
-} // namespace
+void render_node(gfx::Painter &painter, layout::LayoutBox const &layout, std::optional<geom::Rect> const &clip) {
+    if (clip && !layout.dimensions.border_box().overlaps(*clip)) {
+        return;
+    }
 
-void render_layout(gfx::Painter &painter, layout::LayoutBox const &layout) {
     if (should_render(layout)) {
         do_render(painter, layout);
     }
 
     for (auto const &child : layout.children) {
-        render_layout(painter, child);
+        render_node(painter, child, clip);
     }
 }
 
+} // namespace
+
+void render_layout(gfx::Painter &painter, layout::LayoutBox const &layout, std::optional<geom::Rect> const &clip) {
+    util::trace::Span span{"render::render_layout"};
+    render_node(painter, layout, clip);
+}
+
+std::vector<gfx::CanvasCommand> record_layout(layout::LayoutBox const &layout, std::optional<geom::Rect> const &clip) {
+    gfx::CanvasCommandSaver saver;
+    gfx::Painter painter{saver};
+    render_layout(painter, layout, clip);
+    return saver.take_commands();
+}
+
 namespace debug {
 
 void render_layout_depth(gfx::Painter &painter, layout::LayoutBox const &layout) {
@@ -117,5 +137,54 @@ void render_layout_depth(gfx::Painter &painter, layout::LayoutBox const &layout)
     }
 }
 
+namespace {
+
+struct PaintCost {
+    layout::LayoutBox const *box{};
+    std::int64_t cost{};
+};
+
+// A command is weighed in as a microsecond so a box that happens to paint
+// quickly this frame but issues a pile of draw calls still lights up.
+constexpr std::int64_t kNsPerCommand{1000};
+
+void measure_paint_costs(layout::LayoutBox const &layout, std::vector<PaintCost> &costs) {
+    if (should_render(layout)) {
+        gfx::CanvasCommandSaver saver;
+        gfx::Painter painter{saver};
+        auto start = std::chrono::steady_clock::now();
+        do_render(painter, layout);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        auto command_count = static_cast<std::int64_t>(saver.take_commands().size());
+        if (command_count > 0) {
+            costs.push_back({&layout,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()
+                            + command_count * kNsPerCommand});
+        }
+    }
+
+    for (auto const &child : layout.children) {
+        measure_paint_costs(child, costs);
+    }
+}
+
+} // namespace
+
+void render_paint_heatmap(gfx::Painter &painter, layout::LayoutBox const &layout) {
+    std::vector<PaintCost> costs;
+    measure_paint_costs(layout, costs);
+    auto const max_cost = std::ranges::max_element(costs, {}, &PaintCost::cost);
+    if (max_cost == end(costs) || max_cost->cost <= 0) {
+        return;
+    }
+
+    for (auto const &[box, cost] : costs) {
+        constexpr std::int64_t kMinAlpha{0x10};
+        constexpr std::int64_t kMaxAlpha{0xa0};
+        auto alpha = kMinAlpha + cost * (kMaxAlpha - kMinAlpha) / max_cost->cost;
+        painter.fill_rect(box->dimensions.border_box(), {0xFF, 0x00, 0x00, static_cast<std::uint8_t>(alpha)});
+    }
+}
+
 } // namespace debug
 } // namespace render
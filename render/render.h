@@ -5,15 +5,38 @@
 #ifndef RENDER_RENDER_H_
 #define RENDER_RENDER_H_
 
+#include "geom/geom.h"
+#include "gfx/canvas_command_saver.h"
 #include "gfx/painter.h"
 #include "layout/layout.h"
 
+#include <optional>
+#include <vector>
+
 namespace render {
 
-void render_layout(gfx::Painter &, layout::LayoutBox const &);
+// If a viewport is provided, subtrees whose border box falls entirely outside
+// it are skipped. Geometry is top-down, so a skipped subtree costs a single
+// rect check no matter how many boxes it holds.
+void render_layout(gfx::Painter &, layout::LayoutBox const &, std::optional<geom::Rect> const &clip = std::nullopt);
+
+// Renders into a retained display list instead of a canvas. Callers can keep
+// the list across frames, diff it against the previous one to see whether
+// anything changed, and replay it with gfx::replay_commands, skipping the
+// walk over the layout tree on frames where nothing moved.
+std::vector<gfx::CanvasCommand> record_layout(
+        layout::LayoutBox const &, std::optional<geom::Rect> const &clip = std::nullopt);
 
 namespace debug {
 void render_layout_depth(gfx::Painter &, layout::LayoutBox const &);
+
+// Overlays what each box costs to paint: every box is painted into a
+// throwaway display list with the time and command count measured, then
+// tinted red, with the most expensive box the most opaque. The tints are
+// translucent and ancestors stack on top of their descendants, so expensive
+// subtrees glow as a whole. For finding pathological pages in the field
+// without attaching a profiler.
+void render_paint_heatmap(gfx::Painter &, layout::LayoutBox const &);
 } // namespace debug
 } // namespace render
 
@@ -12,6 +12,7 @@
 #include "layout/layout.h"
 #include "style/styled_node.h"
 
+using etest::expect;
 using etest::expect_eq;
 
 using CanvasCommands = std::vector<gfx::CanvasCommand>;
@@ -95,6 +96,85 @@ int main() {
         expect_eq(saver.take_commands(), CanvasCommands{gfx::DrawRectCmd{expected_rect, expected_color, {}}});
     });
 
+    etest::test("paint heatmap tints painted boxes", [] {
+        dom::Node dom = dom::Element{"div", {}, {dom::Element{"first"}}};
+        auto styled = style::StyledNode{
+                .node = dom,
+                .properties = {{css::PropertyId::Display, "block"}, {css::PropertyId::BackgroundColor, "#0A0B0C"}},
+        };
+
+        auto layout = layout::LayoutBox{
+                .node = &styled,
+                .type = layout::LayoutType::Block,
+                .dimensions = {{10, 20, 100, 100}, {}, {}, {}},
+        };
+
+        gfx::CanvasCommandSaver saver;
+        gfx::Painter painter{saver};
+        render::debug::render_paint_heatmap(painter, layout);
+
+        auto commands = saver.take_commands();
+        expect_eq(commands.size(), std::size_t{1});
+        auto const &cmd = std::get<gfx::FillRectCmd>(commands[0]);
+        expect_eq(cmd.rect, geom::Rect{10, 20, 100, 100});
+        expect_eq(cmd.color.r, 0xFF);
+        // The only painted box is also the most expensive one.
+        expect(cmd.color.a > 0);
+    });
+
+    etest::test("record_layout matches direct rendering", [] {
+        dom::Node dom = dom::Element{"div", {}, {dom::Element{"first"}}};
+        auto styled = style::StyledNode{
+                .node = dom,
+                .properties = {{css::PropertyId::Display, "block"}, {css::PropertyId::BackgroundColor, "#0A0B0C"}},
+        };
+
+        auto layout = layout::LayoutBox{
+                .node = &styled,
+                .type = layout::LayoutType::Block,
+                .dimensions = {{10, 20, 100, 100}, {}, {}, {}},
+        };
+
+        gfx::CanvasCommandSaver saver;
+        gfx::Painter painter{saver};
+        render::render_layout(painter, layout);
+
+        // The retained list holds exactly the commands direct rendering would
+        // have issued, and unchanged layouts record identical lists.
+        expect_eq(render::record_layout(layout), saver.take_commands());
+        expect_eq(render::record_layout(layout), render::record_layout(layout));
+    });
+
+    etest::test("culling", [] {
+        dom::Node dom = dom::Element{"div", {}, {dom::Element{"first"}}};
+        auto styled = style::StyledNode{
+                .node = dom,
+                .properties = {{css::PropertyId::Display, "block"}, {css::PropertyId::BackgroundColor, "#0A0B0C"}},
+        };
+
+        auto layout = layout::LayoutBox{
+                .node = &styled,
+                .type = layout::LayoutType::Block,
+                .dimensions = {{10, 20, 100, 100}, {}, {}, {}},
+        };
+
+        gfx::CanvasCommandSaver saver;
+        gfx::Painter painter{saver};
+
+        geom::Rect expected_rect{10, 20, 100, 100};
+        gfx::Color expected_color{0xA, 0xB, 0xC};
+
+        // Intersecting the viewport, partially or fully, renders.
+        render::render_layout(painter, layout, geom::Rect{0, 0, 200, 200});
+        expect_eq(saver.take_commands(), CanvasCommands{gfx::DrawRectCmd{expected_rect, expected_color, {}}});
+        render::render_layout(painter, layout, geom::Rect{0, 0, 20, 30});
+        expect_eq(saver.take_commands(), CanvasCommands{gfx::DrawRectCmd{expected_rect, expected_color, {}}});
+
+        // Scrolled past, nothing is rendered.
+        render::render_layout(painter, layout, geom::Rect{0, 200, 100, 100});
+        expect_eq(saver.take_commands(), CanvasCommands{});
+    });
+
     etest::test("render block with transparent background-color", [] {
         dom::Node dom = dom::Element{"div", {}, {dom::Element{"first"}}};
         auto styled = style::StyledNode{
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef STYLE_ANCESTOR_FILTER_H_
+#define STYLE_ANCESTOR_FILTER_H_
+
+#include "dom/dom.h"
+#include "util/string.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+namespace style {
+
+// Counting bloom filter over the tag, id, and class names of the elements on
+// the current styling stack. Lets selector matching reject rules with
+// descendant components without walking the ancestor chain: may_contain()
+// answering false means the name is definitely not on an ancestor, answering
+// true means it probably is. False positives only cost a slow-path check.
+class AncestorFilter {
+public:
+    void push(dom::Element const &element) { adjust(element, 1); }
+    void pop(dom::Element const &element) { adjust(element, -1); }
+
+    [[nodiscard]] bool may_contain(std::string_view value) const {
+        auto [first, second] = slots_for(value);
+        return counters_[first] > 0 && counters_[second] > 0;
+    }
+
+private:
+    // 1 KiB of counters, large enough that the handful of names on a
+    // realistic ancestor chain rarely collide.
+    static constexpr std::size_t kSlotCount{1024};
+
+    std::array<std::uint8_t, kSlotCount> counters_{};
+
+    [[nodiscard]] static std::pair<std::size_t, std::size_t> slots_for(std::string_view value) {
+        auto hash = std::hash<std::string_view>{}(value);
+        return {hash % kSlotCount, hash / kSlotCount % kSlotCount};
+    }
+
+    void adjust(dom::Element const &element, int delta) {
+        adjust(element.name, delta);
+        if (element.attributes.contains("id")) {
+            adjust(element.attributes.at("id"), delta);
+        }
+
+        if (element.attributes.contains("class")) {
+            for (auto element_class : util::LazySplit{element.attributes.at("class"), " "}) {
+                adjust(element_class, delta);
+            }
+        }
+    }
+
+    void adjust(std::string_view value, int delta) {
+        auto [first, second] = slots_for(value);
+        // A counter that has saturated sticks at its max so pathological
+        // nesting can't make it claim a name left the stack while an earlier,
+        // uncounted, push is still live. Sticking is conservative: the worst
+        // case is a permanent false positive.
+        for (auto slot : {first, second}) {
+            if (counters_[slot] != std::numeric_limits<std::uint8_t>::max()) {
+                counters_[slot] = static_cast<std::uint8_t>(counters_[slot] + delta);
+            }
+        }
+    }
+};
+
+} // namespace style
+
+#endif
@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "style/ancestor_filter.h"
+
+#include "etest/etest.h"
+
+using etest::expect;
+
+int main() {
+    etest::test("tag names", [] {
+        style::AncestorFilter filter;
+        expect(!filter.may_contain("div"));
+
+        filter.push(dom::Element{"div"});
+        expect(filter.may_contain("div"));
+        expect(!filter.may_contain("span"));
+
+        filter.pop(dom::Element{"div"});
+        expect(!filter.may_contain("div"));
+    });
+
+    etest::test("ids and classes", [] {
+        style::AncestorFilter filter;
+        dom::Element element{"div", {{"id", "content"}, {"class", "one two"}}};
+
+        filter.push(element);
+        expect(filter.may_contain("content"));
+        expect(filter.may_contain("one"));
+        expect(filter.may_contain("two"));
+
+        filter.pop(element);
+        expect(!filter.may_contain("content"));
+        expect(!filter.may_contain("one"));
+        expect(!filter.may_contain("two"));
+    });
+
+    etest::test("repeated names are counted", [] {
+        style::AncestorFilter filter;
+        filter.push(dom::Element{"div"});
+        filter.push(dom::Element{"div"});
+
+        filter.pop(dom::Element{"div"});
+        expect(filter.may_contain("div"));
+
+        filter.pop(dom::Element{"div"});
+        expect(!filter.may_contain("div"));
+    });
+
+    return etest::run_all_tests();
+}
@@ -4,10 +4,19 @@
 
 #include "style/style.h"
 
+#include "css/media_query.h"
 #include "util/string.h"
+#include "util/trace.h"
 
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <future>
 #include <iterator>
+#include <optional>
+#include <set>
+#include <thread>
 #include <utility>
 
 namespace style {
@@ -17,13 +26,13 @@ bool has_class(dom::Element const &element, std::string_view needle_class) {
         return false;
     }
 
-    auto classes = util::split(element.attributes.at("class"), " ");
-    return std::ranges::any_of(classes, [&](auto const &c) { return c == needle_class; });
+    return std::ranges::any_of(
+            util::LazySplit{element.attributes.at("class"), " "}, [&](auto c) { return c == needle_class; });
 }
 } // namespace
 
 // TODO(robinlinden): This needs to match more things.
-bool is_match(dom::Element const &element, std::string_view selector_) {
+bool is_match(dom::Element const &element, std::string_view selector_, ElementState const &state) {
     // https://developer.mozilla.org/en-US/docs/Web/CSS/Pseudo-classes
     auto [selector, psuedo_class] = util::split_once(selector_, ":");
 
@@ -41,6 +50,16 @@ bool is_match(dom::Element const &element, std::string_view selector_) {
                 return false;
             }
 
+            if (selector.empty()) {
+                return true;
+            }
+        } else if (psuedo_class == "hover" || psuedo_class == "active") {
+            // https://developer.mozilla.org/en-US/docs/Web/CSS/:hover
+            // https://developer.mozilla.org/en-US/docs/Web/CSS/:active
+            if (!(psuedo_class == "hover" ? state.hovered : state.active)) {
+                return false;
+            }
+
             if (selector.empty()) {
                 return true;
             }
@@ -72,43 +91,584 @@ bool is_match(dom::Element const &element, std::string_view selector_) {
     return false;
 }
 
+namespace {
+
+using DeclarationWithSpecificity = std::pair<std::uint32_t, std::pair<css::PropertyId, std::string>>;
+
+// A selector with descendant combinators can only match if every ancestor
+// component's name is on the styling stack. is_match doesn't handle
+// descendant combinators yet, but rejecting them here keeps that an O(1)
+// filter probe per rule instead of a walk up the tree once it does.
+bool ancestors_may_match(std::string_view selector, AncestorFilter const &filter) {
+    auto parts = util::split(selector, " ");
+    for (std::size_t i = 0; i + 1 < parts.size(); ++i) {
+        auto part = util::split_once(parts[i], ":").first;
+        if (part.empty() || part == "*") {
+            continue;
+        }
+
+        if (part.starts_with('.') || part.starts_with('#')) {
+            part.remove_prefix(1);
+        }
+
+        if (!filter.may_contain(part)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Appends the rule's declarations together with the specificity of its most
+// specific matching selector, or nothing if no selector matches.
+void append_if_matched(css::Rule const &rule,
+        dom::Element const &element,
+        AncestorFilter const *filter,
+        ElementState const &state,
+        std::vector<DeclarationWithSpecificity> &matched) {
+    std::optional<std::uint32_t> specificity;
+    for (std::size_t i = 0; i < rule.selectors.size(); ++i) {
+        if (filter != nullptr && !ancestors_may_match(rule.selectors[i], *filter)) {
+            continue;
+        }
+
+        if (!is_match(element, rule.selectors[i], state)) {
+            continue;
+        }
+
+        // Hand-written rules (e.g. in tests) may not have precomputed keys.
+        auto key = i < rule.selector_specificities.size() ? rule.selector_specificities[i]
+                                                          : css::specificity(rule.selectors[i]);
+        specificity = std::max(specificity.value_or(0), key);
+    }
+
+    if (!specificity) {
+        return;
+    }
+
+    for (auto const &[property, value] : rule.declarations) {
+        matched.push_back({*specificity, {property, value.raw}});
+    }
+}
+
+// Resolves the cascade: the most specific declaration of each property wins,
+// with source order breaking ties. The result holds one entry per property so
+// queries don't have to scan past declarations that lost the cascade.
+std::vector<std::pair<css::PropertyId, std::string>> into_cascade_order(
+        std::vector<DeclarationWithSpecificity> &&matched) {
+    std::ranges::stable_sort(matched, {}, &DeclarationWithSpecificity::first);
+
+    std::vector<std::pair<css::PropertyId, std::string>> declarations;
+    declarations.reserve(matched.size());
+    for (auto &[specificity, declaration] : matched) {
+        auto it = std::ranges::find_if(
+                declarations, [property = declaration.first](auto const &d) { return d.first == property; });
+        if (it != end(declarations)) {
+            it->second = std::move(declaration.second);
+        } else {
+            declarations.push_back(std::move(declaration));
+        }
+    }
+
+    return declarations;
+}
+
+} // namespace
+
 std::vector<std::pair<css::PropertyId, std::string>> matching_rules(
-        dom::Element const &element, std::vector<css::Rule> const &stylesheet) {
-    std::vector<std::pair<css::PropertyId, std::string>> matched_rules;
+        dom::Element const &element, std::vector<css::Rule> const &stylesheet, ElementState const &state) {
+    std::vector<DeclarationWithSpecificity> matched;
 
     for (auto const &rule : stylesheet) {
-        if (std::ranges::any_of(rule.selectors, [&](auto const &selector) { return is_match(element, selector); })) {
-            std::ranges::copy(rule.declarations, std::back_inserter(matched_rules));
+        append_if_matched(rule, element, nullptr, state, matched);
+    }
+
+    return into_cascade_order(std::move(matched));
+}
+
+namespace {
+
+// The tag name a selector can only ever match, or std::nullopt if it could
+// match elements of any tag (universal, class, and id selectors).
+std::optional<std::string_view> restricting_tag_name(std::string_view selector) {
+    auto tag = util::split_once(selector, ":").first;
+    if (tag.empty() || tag == "*" || tag.starts_with('.') || tag.starts_with('#')) {
+        return std::nullopt;
+    }
+
+    return tag;
+}
+
+} // namespace
+
+namespace {
+
+void bucket_rules(std::vector<css::Rule> const &rules,
+        std::map<std::string, std::vector<std::size_t>, std::less<>> &rules_by_tag,
+        std::vector<std::size_t> &universal_rules,
+        std::map<std::string, std::vector<std::size_t>, std::less<>> &media_rules,
+        std::vector<std::size_t> &pointer_state_rules) {
+    for (std::size_t i = 0; i < rules.size(); ++i) {
+        if (!rules[i].media_query.empty()) {
+            media_rules[rules[i].media_query].push_back(i);
+        }
+
+        if (std::ranges::any_of(rules[i].selectors,
+                    [](auto const &selector) { return selector.contains(":hover") || selector.contains(":active"); })) {
+            pointer_state_rules.push_back(i);
+        }
+
+        bool in_universal_bucket{false};
+        for (auto const &selector : rules[i].selectors) {
+            if (auto tag = restricting_tag_name(selector)) {
+                auto &bucket = rules_by_tag[std::string{*tag}];
+                if (bucket.empty() || bucket.back() != i) {
+                    bucket.push_back(i);
+                }
+            } else if (!in_universal_bucket) {
+                universal_rules.push_back(i);
+                in_universal_bucket = true;
+            }
+        }
+    }
+}
+
+} // namespace
+
+SelectorIndex::Partial::Partial(std::vector<css::Rule> const &rules) : rule_count_{rules.size()} {
+    bucket_rules(rules, rules_by_tag_, universal_rules_, media_rules_, pointer_state_rules_);
+}
+
+SelectorIndex::SelectorIndex(std::vector<css::Rule> const &stylesheet) : stylesheet_{stylesheet} {
+    std::map<std::string, std::vector<std::size_t>, std::less<>> media_rules;
+    bucket_rules(stylesheet, rules_by_tag_, universal_rules_, media_rules, pointer_state_rules_);
+    build_media_groups(std::move(media_rules));
+    build_selector_entries();
+}
+
+SelectorIndex::SelectorIndex(std::vector<css::Rule> const &stylesheet, std::vector<Partial> const &partials)
+    : stylesheet_{stylesheet} {
+    // Each partial's indices are local to its fragment, so they're shifted by
+    // the number of rules in the fragments before it. Splicing in fragment
+    // order keeps every bucket sorted by rule position.
+    std::map<std::string, std::vector<std::size_t>, std::less<>> media_rules;
+    std::size_t offset{0};
+    for (auto const &partial : partials) {
+        for (auto const &[tag, bucket] : partial.rules_by_tag_) {
+            auto &merged = rules_by_tag_[tag];
+            for (auto index : bucket) {
+                merged.push_back(index + offset);
+            }
+        }
+
+        for (auto index : partial.universal_rules_) {
+            universal_rules_.push_back(index + offset);
+        }
+
+        for (auto index : partial.pointer_state_rules_) {
+            pointer_state_rules_.push_back(index + offset);
+        }
+
+        for (auto const &[query, rules] : partial.media_rules_) {
+            auto &merged = media_rules[query];
+            for (auto index : rules) {
+                merged.push_back(index + offset);
+            }
+        }
+
+        offset += partial.rule_count_;
+    }
+
+    assert(offset == stylesheet.size());
+    build_media_groups(std::move(media_rules));
+    build_selector_entries();
+}
+
+void SelectorIndex::build_selector_entries() {
+    std::size_t selector_count{0};
+    for (auto const &rule : stylesheet_) {
+        selector_count += rule.selectors.size();
+    }
+
+    selectors_.reserve(selector_count);
+    selector_spans_.reserve(stylesheet_.size());
+    for (auto const &rule : stylesheet_) {
+        selector_spans_.push_back({selectors_.size(), rule.selectors.size()});
+        for (std::size_t i = 0; i < rule.selectors.size(); ++i) {
+            // Hand-written rules (e.g. in tests) may not have precomputed keys.
+            auto key = i < rule.selector_specificities.size() ? rule.selector_specificities[i]
+                                                              : css::specificity(rule.selectors[i]);
+            selectors_.push_back({rule.selectors[i], key});
+        }
+    }
+}
+
+void SelectorIndex::build_media_groups(std::map<std::string, std::vector<std::size_t>, std::less<>> &&media_rules) {
+    if (media_rules.empty()) {
+        return;
+    }
+
+    media_groups_.reserve(media_rules.size());
+    for (auto &[query, rules] : media_rules) {
+        media_groups_.push_back({css::MediaQuery::parse(query), std::move(rules)});
+    }
+
+    // Everything starts out active so an index that's never told about the
+    // viewport behaves like the queries were never evaluated.
+    rule_active_.assign(stylesheet_.size(), true);
+}
+
+void SelectorIndex::set_media_width(int width) {
+    for (auto const &group : media_groups_) {
+        bool const active = group.query.evaluate(width);
+        for (auto index : group.rules) {
+            rule_active_[index] = active;
+        }
+    }
+}
+
+std::vector<std::pair<css::PropertyId, std::string>> SelectorIndex::matching_rules(
+        dom::Element const &element, ElementState const &state) const {
+    return matching_rules(element, static_cast<AncestorFilter const *>(nullptr), state);
+}
+
+std::vector<std::pair<css::PropertyId, std::string>> SelectorIndex::matching_rules(
+        dom::Element const &element, AncestorFilter const &filter, ElementState const &state) const {
+    return matching_rules(element, &filter, state);
+}
+
+std::vector<std::pair<css::PropertyId, std::string>> SelectorIndex::matching_rules(
+        dom::Element const &element, AncestorFilter const *filter, ElementState const &state) const {
+    std::vector<DeclarationWithSpecificity> matched;
+
+    static std::vector<std::size_t> const kNoRules{};
+    auto it = rules_by_tag_.find(element.name);
+    auto const &tagged = it != end(rules_by_tag_) ? it->second : kNoRules;
+
+    // Both buckets are sorted by rule position, so walk them in lockstep to
+    // keep declarations in source order like the unindexed path.
+    auto tag_it = tagged.begin();
+    auto universal_it = universal_rules_.begin();
+    while (tag_it != tagged.end() || universal_it != universal_rules_.end()) {
+        std::size_t rule_index{};
+        if (universal_it == universal_rules_.end() || (tag_it != tagged.end() && *tag_it <= *universal_it)) {
+            rule_index = *tag_it++;
+            if (universal_it != universal_rules_.end() && *universal_it == rule_index) {
+                ++universal_it;
+            }
+        } else {
+            rule_index = *universal_it++;
+        }
+
+        if (!rule_active_.empty() && !rule_active_[rule_index]) {
+            continue;
+        }
+
+        // The scan only reads the dense selector entries; the rule itself,
+        // with its cold declaration map, is fetched once a selector matched.
+        auto const &span = selector_spans_[rule_index];
+        std::optional<std::uint32_t> specificity;
+        for (std::size_t i = span.first; i < span.first + span.count; ++i) {
+            auto const &entry = selectors_[i];
+            if (filter != nullptr && !ancestors_may_match(entry.selector, *filter)) {
+                continue;
+            }
+
+            if (!is_match(element, entry.selector, state)) {
+                continue;
+            }
+
+            specificity = std::max(specificity.value_or(0), entry.specificity);
+        }
+
+        if (!specificity) {
+            continue;
+        }
+
+        for (auto const &[property, value] : stylesheet_[rule_index].declarations) {
+            matched.push_back({*specificity, {property, value.raw}});
         }
     }
 
-    return matched_rules;
+    return into_cascade_order(std::move(matched));
 }
 
 namespace {
-void style_tree_impl(StyledNode &current, dom::Node const &root, std::vector<css::Rule> const &stylesheet) {
+
+// Caches matched declarations for elements that can't match differently.
+// Selectors only ever consult the element's name and its class, id, and href
+// attributes, so those four make up the key. Pages full of identical siblings
+// (think thousands of table rows) match against the stylesheet once. Once
+// descendant combinators match for real, the ancestor chain has to become
+// part of the key too.
+using MatchedDeclarationsCache = std::map<std::string, std::vector<std::pair<css::PropertyId, std::string>>>;
+
+std::string matched_declarations_cache_key(dom::Element const &element) {
+    static constexpr char kSeparator{'\0'};
+    std::string key = element.name;
+    for (auto const *attribute : {"class", "id"}) {
+        key += kSeparator;
+        if (element.attributes.contains(attribute)) {
+            key += element.attributes.at(attribute);
+        }
+    }
+
+    key += kSeparator;
+    key += element.attributes.contains("href") ? '1' : '0';
+    return key;
+}
+
+// Nodes with at least this many children have their subtrees styled on
+// multiple cores. Styling a subtree only depends on its ancestors, so sibling
+// subtrees are independent of each other.
+constexpr std::size_t kParallelChildThreshold{128};
+
+void style_tree_impl(StyledNode &current,
+        dom::Node const &root,
+        SelectorIndex const &index,
+        MatchedDeclarationsCache &cache,
+        AncestorFilter &filter) {
     if (auto const *element = std::get_if<dom::Element>(&root)) {
         current.children.reserve(element->children.size());
         for (auto const &child : element->children) {
             // TODO(robinlinden): emplace_back once Clang supports it (C++20/p0960). Not supported as of Clang 14.
             current.children.push_back({child});
-            auto &child_node = current.children.back();
-            style_tree_impl(child_node, child, stylesheet);
-            child_node.parent = &current;
         }
+
+        filter.push(*element);
+
+        // All children are in place before any subtree is built, so the
+        // vector won't move underneath the parent pointers being set below.
+        if (element->children.size() >= kParallelChildThreshold) {
+            auto worker_count = std::max(std::thread::hardware_concurrency(), 1u);
+            auto chunk_size = (element->children.size() + worker_count - 1) / worker_count;
+            std::vector<std::future<void>> workers;
+            for (std::size_t begin = 0; begin < element->children.size(); begin += chunk_size) {
+                auto end = std::min(begin + chunk_size, element->children.size());
+                workers.push_back(std::async(std::launch::async, [&, begin, end] {
+                    MatchedDeclarationsCache worker_cache;
+                    AncestorFilter worker_filter{filter};
+                    for (std::size_t i = begin; i < end; ++i) {
+                        style_tree_impl(current.children[i], element->children[i], index, worker_cache, worker_filter);
+                        current.children[i].parent = &current;
+                    }
+                }));
+            }
+
+            for (auto &worker : workers) {
+                worker.get();
+            }
+        } else {
+            for (std::size_t i = 0; i < element->children.size(); ++i) {
+                style_tree_impl(current.children[i], element->children[i], index, cache, filter);
+                current.children[i].parent = &current;
+            }
+        }
+
+        filter.pop(*element);
+
+        auto key = matched_declarations_cache_key(*element);
+        if (auto it = cache.find(key); it != end(cache)) {
+            current.properties.assign(it->second.begin(), it->second.end());
+        } else {
+            auto matched = index.matching_rules(*element, filter);
+            current.properties.assign(matched.begin(), matched.end());
+            cache.emplace(std::move(key), std::move(matched));
+        }
+
+        return;
     }
 
-    current.properties = std::holds_alternative<dom::Element>(root)
-            ? matching_rules(std::get<dom::Element>(root), stylesheet)
-            : std::vector<std::pair<css::PropertyId, std::string>>{};
+    current.properties = {};
 }
+
+// Resolving display has to wait until the whole tree is styled: a node's
+// value can depend on its ancestors' properties (inherit/unset), and
+// style_tree_impl fills a node's properties in after its children's.
+void resolve_precomputed_style(StyledNode &node) {
+    node.display.reset();
+    node.display = node.get_property<css::PropertyId::Display>();
+    for (auto &child : node.children) {
+        resolve_precomputed_style(child);
+    }
+}
+
 } // namespace
 
 std::unique_ptr<StyledNode> style_tree(dom::Node const &root, std::vector<css::Rule> const &stylesheet) {
+    return style_tree(root, SelectorIndex{stylesheet});
+}
+
+std::unique_ptr<StyledNode> style_tree(dom::Node const &root, SelectorIndex const &index) {
+    util::trace::Span span{"style::style_tree"};
+    MatchedDeclarationsCache cache;
     // TODO(robinlinden): std::make_unique once Clang supports it (C++20/p0960). Not supported as of Clang 14.
     auto tree_root = std::unique_ptr<StyledNode>(new StyledNode{root});
-    style_tree_impl(*tree_root, root, stylesheet);
+    AncestorFilter filter;
+    style_tree_impl(*tree_root, root, index, cache, filter);
+    resolve_precomputed_style(*tree_root);
     return tree_root;
 }
 
+namespace {
+
+void restyle_impl(StyledNode &node,
+        std::vector<dom::Node const *> const &dirty,
+        SelectorIndex const &index,
+        MatchedDeclarationsCache &cache) {
+    if (std::ranges::find(dirty, &node.node) != end(dirty)) {
+        // Rebuild the whole subtree. The node keeps its slot in its parent's
+        // children and its own parent pointer, so the rest of the tree is
+        // unaffected.
+        node.children.clear();
+        AncestorFilter filter;
+        for (auto const *ancestor = node.parent; ancestor != nullptr; ancestor = ancestor->parent) {
+            if (auto const *element = std::get_if<dom::Element>(&ancestor->node)) {
+                filter.push(*element);
+            }
+        }
+
+        style_tree_impl(node, node.node, index, cache, filter);
+        return;
+    }
+
+    for (auto &child : node.children) {
+        restyle_impl(child, dirty, index, cache);
+    }
+}
+
+} // namespace
+
+void restyle(StyledNode &root, std::vector<dom::Node const *> const &dirty, std::vector<css::Rule> const &stylesheet) {
+    if (dirty.empty()) {
+        return;
+    }
+
+    SelectorIndex index{stylesheet};
+    MatchedDeclarationsCache cache;
+    restyle_impl(root, dirty, index, cache);
+    resolve_precomputed_style(root);
+}
+
+namespace {
+
+StyledNode const *find_styled_node(StyledNode const &node, dom::Element const *element) {
+    if (std::get_if<dom::Element>(&node.node) == element) {
+        return &node;
+    }
+
+    for (auto const &child : node.children) {
+        if (auto const *found = find_styled_node(child, element)) {
+            return found;
+        }
+    }
+
+    return nullptr;
+}
+
+// The hovered element and its ancestors: hovering an element hovers
+// everything containing it. Walked through the styled tree since the dom
+// doesn't have parent pointers.
+std::set<dom::Element const *> hover_chain(StyledNode const &root, dom::Element const *element) {
+    std::set<dom::Element const *> chain;
+    if (element == nullptr) {
+        return chain;
+    }
+
+    for (auto const *node = find_styled_node(root, element); node != nullptr; node = node->parent) {
+        if (auto const *ancestor = std::get_if<dom::Element>(&node->node)) {
+            chain.insert(ancestor);
+        }
+    }
+
+    return chain;
+}
+
+// Swaps in newly matched declarations and reports how much they invalidated.
+RestyleDamage apply_matched_declarations(
+        StyledNode &node, std::vector<std::pair<css::PropertyId, std::string>> const &matched) {
+    bool changed = false;
+    bool affects_layout = false;
+    auto note_change = [&](css::PropertyId id) {
+        changed = true;
+        affects_layout = affects_layout || css::is_layout_affecting(id);
+    };
+
+    for (auto const &[id, value] : matched) {
+        auto it = std::ranges::find_if(node.properties, [id = id](auto const &p) { return p.first == id; });
+        if (it == node.properties.end() || it->second != value) {
+            note_change(id);
+        }
+    }
+
+    for (auto const &[id, value] : node.properties) {
+        if (std::ranges::find_if(matched, [id = id](auto const &p) { return p.first == id; }) == matched.end()) {
+            note_change(id);
+        }
+    }
+
+    if (!changed) {
+        return RestyleDamage::None;
+    }
+
+    node.properties.assign(matched.begin(), matched.end());
+    // Keep the precomputed display in sync. A display change is
+    // layout-affecting, so the paint-only path never stales its subtree.
+    node.display.reset();
+    node.display = node.get_property<css::PropertyId::Display>();
+    return affects_layout ? RestyleDamage::Layout : RestyleDamage::Paint;
+}
+
+RestyleDamage restyle_hovered_impl(StyledNode &node,
+        SelectorIndex const &index,
+        std::set<dom::Element const *> const &old_chain,
+        std::set<dom::Element const *> const &new_chain) {
+    RestyleDamage damage = RestyleDamage::None;
+    if (auto const *element = std::get_if<dom::Element>(&node.node)) {
+        bool const was_hovered = old_chain.contains(element);
+        bool const is_hovered = new_chain.contains(element);
+        if (was_hovered != is_hovered) {
+            auto matched = index.matching_rules(*element, ElementState{.hovered = is_hovered});
+            damage = apply_matched_declarations(node, matched);
+        }
+    }
+
+    for (auto &child : node.children) {
+        damage = std::max(damage, restyle_hovered_impl(child, index, old_chain, new_chain));
+    }
+
+    return damage;
+}
+
+} // namespace
+
+RestyleDamage restyle_hovered_element(StyledNode &root,
+        SelectorIndex const &index,
+        dom::Element const *old_hovered,
+        dom::Element const *new_hovered) {
+    if (old_hovered == new_hovered || !index.has_pointer_state_rules()) {
+        return RestyleDamage::None;
+    }
+
+    // Elements on both chains stay hovered, so only the parts the chains
+    // don't share can match differently.
+    return restyle_hovered_impl(root, index, hover_chain(root, old_hovered), hover_chain(root, new_hovered));
+}
+
+bool media_matching_changes(std::vector<css::Rule> const &stylesheet, int old_width, int new_width) {
+    std::set<std::string_view> seen;
+    for (auto const &rule : stylesheet) {
+        if (rule.media_query.empty() || !seen.insert(rule.media_query).second) {
+            continue;
+        }
+
+        auto query = css::MediaQuery::parse(rule.media_query);
+        if (query.evaluate(old_width) != query.evaluate(new_width)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 } // namespace style
@@ -5,11 +5,16 @@
 #ifndef STYLE_STYLE_H_
 #define STYLE_STYLE_H_
 
+#include "css/media_query.h"
 #include "css/property_id.h"
 #include "css/rule.h"
 #include "dom/dom.h"
+#include "style/ancestor_filter.h"
 #include "style/styled_node.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -18,13 +23,146 @@
 
 namespace style {
 
-bool is_match(dom::Element const &element, std::string_view selector);
+// Element state that lives outside the dom, consulted by pseudo-class
+// selectors like :hover and :active.
+struct ElementState {
+    bool hovered{false};
+    bool active{false};
+};
+
+bool is_match(dom::Element const &element, std::string_view selector, ElementState const &state = {});
 
 std::vector<std::pair<css::PropertyId, std::string>> matching_rules(
-        dom::Element const &element, std::vector<css::Rule> const &stylesheet);
+        dom::Element const &element, std::vector<css::Rule> const &stylesheet, ElementState const &state = {});
+
+// Buckets rules by the tag name their selectors are restricted to so each
+// element only tests the rules that could apply to it instead of scanning the
+// whole stylesheet. The stylesheet must outlive the index.
+class SelectorIndex {
+public:
+    // The buckets for one stylesheet fragment. Fragments are independent, so
+    // partials can be built on the worker threads that parse each sheet and
+    // spliced into a full index once every fragment's position in the merged
+    // stylesheet is known.
+    class Partial {
+    public:
+        explicit Partial(std::vector<css::Rule> const &rules);
+        Partial() = default;
+
+    private:
+        friend class SelectorIndex;
+        std::map<std::string, std::vector<std::size_t>, std::less<>> rules_by_tag_{};
+        std::vector<std::size_t> universal_rules_{};
+        // Owns its query strings: the fragment's rules are moved into the
+        // merged stylesheet before the partial is spliced.
+        std::map<std::string, std::vector<std::size_t>, std::less<>> media_rules_{};
+        std::vector<std::size_t> pointer_state_rules_{};
+        std::size_t rule_count_{};
+    };
+
+    explicit SelectorIndex(std::vector<css::Rule> const &stylesheet);
+
+    // An index over a merged stylesheet, spliced from the partials of its
+    // fragments in the order the fragments appear in the stylesheet.
+    SelectorIndex(std::vector<css::Rule> const &stylesheet, std::vector<Partial> const &partials);
+
+    [[nodiscard]] std::vector<std::pair<css::PropertyId, std::string>> matching_rules(
+            dom::Element const &element, ElementState const &state = {}) const;
+
+    // Like the above, but rules with descendant components whose names aren't
+    // in the ancestor filter are rejected without full selector matching.
+    [[nodiscard]] std::vector<std::pair<css::PropertyId, std::string>> matching_rules(
+            dom::Element const &element, AncestorFilter const &filter, ElementState const &state = {}) const;
+
+    // Whether any rule has a :hover or :active selector. When none do,
+    // pointer movement can't change which rules match, and the hover restyle
+    // is free.
+    [[nodiscard]] bool has_pointer_state_rules() const { return !pointer_state_rules_.empty(); }
+
+    // Re-evaluates the stylesheet's media queries against a viewport of this
+    // width. Rules whose query doesn't match are invisible to matching_rules
+    // until the next call. Rules in the same @media block share its query, so
+    // each distinct query is evaluated once, not once per rule.
+    void set_media_width(int width);
+
+private:
+    [[nodiscard]] std::vector<std::pair<css::PropertyId, std::string>> matching_rules(
+            dom::Element const &element, AncestorFilter const *filter, ElementState const &state) const;
+
+    // The rules inside each distinct @media block.
+    struct MediaGroup {
+        css::MediaQuery query;
+        std::vector<std::size_t> rules;
+    };
+
+    // One selector pulled out of its rule together with its precomputed
+    // cascade key. Views into the stylesheet's selector strings.
+    struct SelectorEntry {
+        std::string_view selector;
+        std::uint32_t specificity{};
+    };
+
+    // Where a rule's selectors sit in selectors_.
+    struct SelectorSpan {
+        std::size_t first{};
+        std::size_t count{};
+    };
+
+    void build_media_groups(std::map<std::string, std::vector<std::size_t>, std::less<>> &&media_rules);
+    void build_selector_entries();
+
+    std::vector<css::Rule> const &stylesheet_;
+    // Every rule's selectors flattened into one dense array, so the match
+    // scan reads contiguous selector entries instead of striding across whole
+    // rules where the selectors sit next to cold declaration maps and media
+    // queries. A rule's declarations are only touched once a selector of its
+    // matched. selector_spans_ is parallel to the stylesheet.
+    std::vector<SelectorEntry> selectors_{};
+    std::vector<SelectorSpan> selector_spans_{};
+    std::map<std::string, std::vector<std::size_t>, std::less<>> rules_by_tag_{};
+    std::vector<std::size_t> universal_rules_{};
+    // Rules carrying a :hover/:active selector, tracked so the pointer-state
+    // restyle knows whether there's anything for it to do.
+    std::vector<std::size_t> pointer_state_rules_{};
+    std::vector<MediaGroup> media_groups_{};
+    // Per-rule media verdict, empty when the stylesheet has no media queries.
+    // Rules outside @media are always active.
+    std::vector<bool> rule_active_{};
+};
 
 std::unique_ptr<StyledNode> style_tree(dom::Node const &root, std::vector<css::Rule> const &stylesheet);
 
+// Like the above, but with a caller-provided index over the stylesheet, for
+// callers that already have one, e.g. spliced together from partials built
+// while the stylesheets loaded.
+std::unique_ptr<StyledNode> style_tree(dom::Node const &root, SelectorIndex const &index);
+
+// Recomputes style for the subtrees rooted at the given dirty DOM nodes,
+// leaving the rest of the styled tree (and its parent pointers) intact. Dirty
+// nodes are identified by address, so they must be nodes of the DOM tree the
+// styled tree was built from.
+void restyle(StyledNode &root, std::vector<dom::Node const *> const &dirty, std::vector<css::Rule> const &stylesheet);
+
+// How much of the pipeline a restyle invalidated: nothing, paint only, or
+// layout and paint.
+enum class RestyleDamage { None, Paint, Layout };
+
+// Restyles the elements whose :hover matching changed when the hovered
+// element went from old_hovered to new_hovered (either may be null): the two
+// ancestor chains, minus the part they share. The rest of the styled tree
+// isn't touched, and the damage is Paint when every property that changed is
+// paint-only per css::is_layout_affecting, so hovering a menu entry repaints
+// it instead of relaying out the document.
+RestyleDamage restyle_hovered_element(StyledNode &root,
+        SelectorIndex const &index,
+        dom::Element const *old_hovered,
+        dom::Element const *new_hovered);
+
+// Whether any of the stylesheet's media queries matches at one of the widths
+// but not the other, i.e. whether resizing between them changes which rules
+// apply rather than just the geometry. Each distinct query is checked once.
+bool media_matching_changes(std::vector<css::Rule> const &stylesheet, int old_width, int new_width);
+
 } // namespace style
 
 #endif
@@ -15,6 +15,7 @@
 
 using namespace std::literals;
 using etest::expect;
+using etest::expect_eq;
 using etest::require;
 
 namespace {
@@ -81,6 +82,74 @@ int main() {
         });
     }
 
+    etest::test("is_match: psuedo-class, hover and active", [] {
+        expect(!style::is_match(dom::Element{"a"}, "a:hover"sv));
+        expect(style::is_match(dom::Element{"a"}, "a:hover"sv, {.hovered = true}));
+        expect(style::is_match(dom::Element{"a"}, ":hover"sv, {.hovered = true}));
+        expect(style::is_match(dom::Element{"div", {{"class", "menu"}}}, ".menu:hover"sv, {.hovered = true}));
+        expect(!style::is_match(dom::Element{"b"}, "a:hover"sv, {.hovered = true}));
+
+        expect(!style::is_match(dom::Element{"a"}, "a:active"sv, {.hovered = true}));
+        expect(style::is_match(dom::Element{"a"}, "a:active"sv, {.active = true}));
+    });
+
+    etest::test("restyle_hovered_element: only the hover chains are touched", [] {
+        dom::Node root = dom::Element{"html", {}, {dom::Element{"body", {}, {dom::Element{"a"}, dom::Element{"a"}}}}};
+
+        std::vector<css::Rule> stylesheet{
+                {.selectors = {"a"}, .declarations = {{css::PropertyId::Color, "blue"}}},
+                {.selectors = {"a:hover"}, .declarations = {{css::PropertyId::Color, "red"}}},
+        };
+        style::SelectorIndex index{stylesheet};
+        auto styled = style::style_tree(root, index);
+
+        auto const &body_element = std::get<dom::Element>(std::get<dom::Element>(root).children[0]);
+        auto const *first = &std::get<dom::Element>(body_element.children[0]);
+        auto const *second = &std::get<dom::Element>(body_element.children[1]);
+        auto &body = styled->children[0];
+
+        // Color is paint-only, so hovering is Paint damage.
+        expect_eq(style::restyle_hovered_element(*styled, index, nullptr, first), style::RestyleDamage::Paint);
+        expect_eq(body.children[0].properties, std::vector{std::pair{css::PropertyId::Color, "red"s}});
+        expect_eq(body.children[1].properties, std::vector{std::pair{css::PropertyId::Color, "blue"s}});
+
+        // Moving to the sibling restores the one the pointer left.
+        expect_eq(style::restyle_hovered_element(*styled, index, first, second), style::RestyleDamage::Paint);
+        expect_eq(body.children[0].properties, std::vector{std::pair{css::PropertyId::Color, "blue"s}});
+        expect_eq(body.children[1].properties, std::vector{std::pair{css::PropertyId::Color, "red"s}});
+
+        // A hover that doesn't change what matches does nothing.
+        expect_eq(style::restyle_hovered_element(*styled, index, second, second), style::RestyleDamage::None);
+
+        // Without :hover rules in the stylesheet, hover changes are free.
+        std::vector<css::Rule> plain{
+                {.selectors = {"a"}, .declarations = {{css::PropertyId::Color, "blue"}}},
+        };
+        style::SelectorIndex plain_index{plain};
+        expect(!plain_index.has_pointer_state_rules());
+        expect_eq(style::restyle_hovered_element(*styled, plain_index, second, first), style::RestyleDamage::None);
+    });
+
+    etest::test("restyle_hovered_element: layout-affecting properties", [] {
+        dom::Node root = dom::Element{"html", {}, {dom::Element{"body", {}, {dom::Element{"a"}}}}};
+
+        std::vector<css::Rule> stylesheet{
+                {.selectors = {"a:hover"}, .declarations = {{css::PropertyId::Width, "100px"}}},
+        };
+        style::SelectorIndex index{stylesheet};
+        auto styled = style::style_tree(root, index);
+
+        auto const &body_element = std::get<dom::Element>(std::get<dom::Element>(root).children[0]);
+        auto const *anchor = &std::get<dom::Element>(body_element.children[0]);
+        auto &body = styled->children[0];
+
+        expect_eq(style::restyle_hovered_element(*styled, index, nullptr, anchor), style::RestyleDamage::Layout);
+        expect_eq(body.children[0].properties, std::vector{std::pair{css::PropertyId::Width, "100px"s}});
+
+        expect_eq(style::restyle_hovered_element(*styled, index, anchor, nullptr), style::RestyleDamage::Layout);
+        expect(body.children[0].properties.empty());
+    });
+
     etest::test("matching_rules: simple names", [] {
         std::vector<css::Rule> stylesheet;
         expect(style::matching_rules(dom::Element{"div"}, stylesheet).empty());
@@ -126,6 +195,205 @@ int main() {
         }
     });
 
+    etest::test("matching_rules: more specific selectors win", [] {
+        std::vector<css::Rule> stylesheet{
+                css::Rule{.selectors = {".fancy"}, .declarations = {{css::PropertyId::Width, "10px"}}},
+                css::Rule{.selectors = {"div"}, .declarations = {{css::PropertyId::Width, "20px"}}},
+        };
+
+        // The class rule appears first in the stylesheet, but it's more
+        // specific, so its declaration is the one that survives the cascade.
+        auto rules = style::matching_rules(dom::Element{"div", {{"class", "fancy"}}}, stylesheet);
+        require(rules.size() == 1);
+        expect_eq(rules[0], std::pair{css::PropertyId::Width, "10px"s});
+    });
+
+    etest::test("selector index: matches the unindexed path in source order", [] {
+        std::vector<css::Rule> stylesheet{
+                css::Rule{.selectors = {"span", "p"}, .declarations = {{css::PropertyId::Width, "80px"}}},
+                css::Rule{.selectors = {".fancy"}, .declarations = {{css::PropertyId::Color, "red"}}},
+                css::Rule{.selectors = {"*"}, .declarations = {{css::PropertyId::Height, "auto"}}},
+                css::Rule{.selectors = {"p", "#thing"}, .declarations = {{css::PropertyId::FontSize, "10px"}}},
+        };
+        style::SelectorIndex index{stylesheet};
+
+        for (auto element : {dom::Element{"p"},
+                     dom::Element{"span"},
+                     dom::Element{"div"},
+                     dom::Element{"p", {{"class", "fancy"}}},
+                     dom::Element{"div", {{"id", "thing"}}}}) {
+            expect_eq(index.matching_rules(element), style::matching_rules(element, stylesheet));
+        }
+    });
+
+    etest::test("selector index: untagged element", [] {
+        std::vector<css::Rule> stylesheet{
+                css::Rule{.selectors = {"well-this-is-not-html"}, .declarations = {{css::PropertyId::Width, "80px"}}},
+        };
+        style::SelectorIndex index{stylesheet};
+        expect(index.matching_rules(dom::Element{"div"}).empty());
+        expect_eq(index.matching_rules(dom::Element{"well-this-is-not-html"}).size(), std::size_t{1});
+    });
+
+    etest::test("selector index: spliced from partials matches one built directly", [] {
+        std::vector<css::Rule> first_fragment{
+                css::Rule{.selectors = {"span", "p"}, .declarations = {{css::PropertyId::Width, "80px"}}},
+                css::Rule{.selectors = {"*"}, .declarations = {{css::PropertyId::Height, "auto"}}},
+        };
+        std::vector<css::Rule> second_fragment{
+                css::Rule{.selectors = {".fancy"}, .declarations = {{css::PropertyId::Color, "red"}}},
+                css::Rule{.selectors = {"p", "#thing"}, .declarations = {{css::PropertyId::FontSize, "10px"}}},
+        };
+
+        std::vector<style::SelectorIndex::Partial> partials{
+                style::SelectorIndex::Partial{first_fragment},
+                style::SelectorIndex::Partial{second_fragment},
+        };
+
+        auto stylesheet = first_fragment;
+        stylesheet.insert(stylesheet.end(), second_fragment.begin(), second_fragment.end());
+
+        style::SelectorIndex spliced{stylesheet, partials};
+        style::SelectorIndex direct{stylesheet};
+
+        for (auto element : {dom::Element{"p"},
+                     dom::Element{"span"},
+                     dom::Element{"div"},
+                     dom::Element{"p", {{"class", "fancy"}}},
+                     dom::Element{"div", {{"id", "thing"}}}}) {
+            expect_eq(spliced.matching_rules(element), direct.matching_rules(element));
+        }
+    });
+
+    etest::test("selector index: media queries gate rules by viewport width", [] {
+        std::vector<css::Rule> stylesheet{
+                css::Rule{.selectors = {"p"}, .declarations = {{css::PropertyId::Width, "80px"}}},
+                css::Rule{.selectors = {"p"},
+                        .declarations = {{css::PropertyId::Color, "red"}},
+                        .media_query = "(min-width: 900px)"},
+                css::Rule{.selectors = {"p"},
+                        .declarations = {{css::PropertyId::Height, "auto"}},
+                        .media_query = "print"},
+        };
+        style::SelectorIndex index{stylesheet};
+        dom::Element p{"p"};
+
+        // An index that's never told about the viewport applies everything,
+        // like before media queries were evaluated.
+        expect_eq(index.matching_rules(p).size(), std::size_t{3});
+
+        index.set_media_width(500);
+        expect_eq(index.matching_rules(p),
+                std::vector{std::pair{css::PropertyId::Width, "80px"s}});
+
+        index.set_media_width(900);
+        expect_eq(index.matching_rules(p),
+                std::vector{std::pair{css::PropertyId::Width, "80px"s}, std::pair{css::PropertyId::Color, "red"s}});
+
+        expect(style::media_matching_changes(stylesheet, 500, 900));
+        expect(!style::media_matching_changes(stylesheet, 900, 1000));
+        expect(!style::media_matching_changes({stylesheet[0]}, 500, 900));
+    });
+
+    etest::test("selector index: spliced partials carry their media queries", [] {
+        std::vector<css::Rule> first_fragment{
+                css::Rule{.selectors = {"p"}, .declarations = {{css::PropertyId::Width, "80px"}}},
+        };
+        std::vector<css::Rule> second_fragment{
+                css::Rule{.selectors = {"p"},
+                        .declarations = {{css::PropertyId::Color, "red"}},
+                        .media_query = "(min-width: 900px)"},
+        };
+
+        std::vector<style::SelectorIndex::Partial> partials{
+                style::SelectorIndex::Partial{first_fragment},
+                style::SelectorIndex::Partial{second_fragment},
+        };
+
+        auto stylesheet = first_fragment;
+        stylesheet.insert(stylesheet.end(), second_fragment.begin(), second_fragment.end());
+
+        style::SelectorIndex spliced{stylesheet, partials};
+        spliced.set_media_width(500);
+        expect_eq(spliced.matching_rules(dom::Element{"p"}),
+                std::vector{std::pair{css::PropertyId::Width, "80px"s}});
+    });
+
+    etest::test("style_tree: repeated siblings", [] {
+        auto root = dom::Element{"html", {}, {}};
+        for (int i = 0; i < 3; ++i) {
+            root.children.emplace_back(dom::Element{"tr", {{"class", "row"}}});
+        }
+        root.children.emplace_back(dom::Element{"tr"});
+
+        std::vector<css::Rule> stylesheet{
+                {.selectors = {".row"}, .declarations = {{css::PropertyId::Height, "10px"}}},
+        };
+
+        auto styled = style::style_tree(root, stylesheet);
+        require(styled->children.size() == 4);
+        for (int i = 0; i < 3; ++i) {
+            expect_eq(styled->children[i].properties,
+                    std::vector{std::pair{css::PropertyId::Height, "10px"s}});
+        }
+        expect(styled->children[3].properties.empty());
+    });
+
+    etest::test("style_tree: many siblings are styled in parallel", [] {
+        auto root = dom::Element{"html", {}, {}};
+        for (int i = 0; i < 1000; ++i) {
+            root.children.emplace_back(dom::Element{"tr", {{"class", "row"}}, {dom::Element{"td"}}});
+        }
+
+        std::vector<css::Rule> stylesheet{
+                {.selectors = {".row"}, .declarations = {{css::PropertyId::Height, "10px"}}},
+                {.selectors = {"td"}, .declarations = {{css::PropertyId::Width, "20px"}}},
+        };
+
+        auto styled = style::style_tree(root, stylesheet);
+        require(styled->children.size() == 1000);
+        for (auto const &child : styled->children) {
+            expect(child.parent == styled.get());
+            expect_eq(child.properties, std::vector{std::pair{css::PropertyId::Height, "10px"s}});
+            require(child.children.size() == 1);
+            expect(child.children[0].parent == &child);
+            expect_eq(child.children[0].properties, std::vector{std::pair{css::PropertyId::Width, "20px"s}});
+        }
+    });
+
+    etest::test("restyle: only dirty subtrees are recomputed", [] {
+        // The dirty set is keyed by node address, so the DOM must outlive the
+        // styled tree rather than being converted to a temporary dom::Node.
+        dom::Node root = dom::Element{"html", {}, {dom::Element{"body", {}, {dom::Element{"p"}, dom::Element{"p"}}}}};
+
+        std::vector<css::Rule> stylesheet{
+                {.selectors = {"p"}, .declarations = {{css::PropertyId::Height, "100px"}}},
+        };
+
+        auto styled = style::style_tree(root, stylesheet);
+        auto &body = styled->children[0];
+        require(body.children.size() == 2);
+
+        // Restyling the second <p> against a new stylesheet only affects it.
+        std::vector<css::Rule> new_stylesheet{
+                {.selectors = {"p"}, .declarations = {{css::PropertyId::Height, "50px"}}},
+        };
+        auto const &body_element = std::get<dom::Element>(std::get<dom::Element>(root).children[0]);
+        style::restyle(*styled, {&body_element.children[1]}, new_stylesheet);
+
+        expect_eq(body.children[0].properties, std::vector{std::pair{css::PropertyId::Height, "100px"s}});
+        expect_eq(body.children[1].properties, std::vector{std::pair{css::PropertyId::Height, "50px"s}});
+        expect(body.children[1].parent == &body);
+
+        // Dirtying <body> rebuilds its subtree, parent pointers included.
+        style::restyle(*styled, {&std::get<dom::Element>(root).children[0]}, new_stylesheet);
+        require(styled->children[0].children.size() == 2);
+        for (auto const &p : styled->children[0].children) {
+            expect_eq(p.properties, std::vector{std::pair{css::PropertyId::Height, "50px"s}});
+            expect(p.parent == &styled->children[0]);
+        }
+    });
+
     etest::test("style_tree: structure", [] {
         auto root = dom::Element{"html", {}, {}};
         root.children.emplace_back(dom::Element{"head"});
@@ -166,5 +434,17 @@ int main() {
         expect(check_parents(*style::style_tree(root, stylesheet), expected));
     });
 
+    etest::test("style_tree: display is resolved into its slot", [] {
+        dom::Node root = dom::Element{"html", {}, {dom::Element{"p"}}};
+        std::vector<css::Rule> stylesheet{
+                {.selectors = {"html"}, .declarations = {{css::PropertyId::Display, "block"}}},
+                {.selectors = {"p"}, .declarations = {{css::PropertyId::Display, "none"}}},
+        };
+
+        auto styled = style::style_tree(root, stylesheet);
+        expect(styled->display == style::DisplayValue::Block);
+        expect(styled->children[0].display == style::DisplayValue::None);
+    });
+
     return etest::run_all_tests();
 }
@@ -10,11 +10,15 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <array>
 #include <charconv>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <map>
+#include <string>
 #include <optional>
 #include <sstream>
 #include <string_view>
@@ -188,7 +192,7 @@ std::optional<gfx::Color> try_from_rgba(std::string_view text) {
     };
 }
 
-gfx::Color parse_color(std::string_view str) {
+gfx::Color parse_color_uncached(std::string_view str) {
     if (auto color = try_from_hex_chars(str)) {
         return *color;
     }
@@ -205,6 +209,20 @@ gfx::Color parse_color(std::string_view str) {
     return gfx::Color{0xFF, 0, 0};
 }
 
+// Rendering asks for color and background-color per box per frame, and a page
+// only uses a handful of distinct colors, so remember what we've parsed.
+// thread_local as style queries can run on the styling worker threads.
+gfx::Color parse_color(std::string_view str) {
+    static thread_local std::map<std::string, gfx::Color, std::less<>> memo;
+    if (auto it = memo.find(str); it != end(memo)) {
+        return it->second;
+    }
+
+    auto color = parse_color_uncached(str);
+    memo.emplace(str, color);
+    return color;
+}
+
 std::string_view get_parent_raw_property(style::StyledNode const &node, css::PropertyId property) {
     if (node.parent != nullptr) {
         return node.parent->get_raw_property(property);
@@ -213,7 +231,7 @@ std::string_view get_parent_raw_property(style::StyledNode const &node, css::Pro
     return kInitialValues.at(property);
 }
 
-std::optional<std::pair<float, std::string_view>> split_into_value_and_unit(std::string_view property) {
+std::optional<std::pair<float, std::string>> split_into_value_and_unit_uncached(std::string_view property) {
     float res{};
     auto parse_result = util::from_chars(property.data(), property.data() + property.size(), res);
     if (parse_result.ec != std::errc{}) {
@@ -223,7 +241,24 @@ std::optional<std::pair<float, std::string_view>> split_into_value_and_unit(std:
 
     auto const parsed_length = std::distance(property.data(), parse_result.ptr);
     auto const unit = property.substr(parsed_length);
-    return std::pair{res, unit};
+    return std::pair{res, std::string{unit}};
+}
+
+// Same deal as parse_color: lengths like "16px" repeat all over a page, so
+// parse each spelling once. The returned unit views into the cache, which is
+// safe as map nodes don't move and the memo is never cleared.
+std::optional<std::pair<float, std::string_view>> split_into_value_and_unit(std::string_view property) {
+    static thread_local std::map<std::string, std::optional<std::pair<float, std::string>>, std::less<>> memo;
+    auto it = memo.find(property);
+    if (it == end(memo)) {
+        it = memo.emplace(property, split_into_value_and_unit_uncached(property)).first;
+    }
+
+    if (!it->second) {
+        return std::nullopt;
+    }
+
+    return std::pair{it->second->first, std::string_view{it->second->second}};
 }
 
 } // namespace
@@ -264,6 +299,44 @@ std::string_view StyledNode::get_raw_property(css::PropertyId property) const {
     return it->second;
 }
 
+BoxColors StyledNode::get_box_colors() const {
+    static constexpr std::array kIds{css::PropertyId::BackgroundColor,
+            css::PropertyId::BorderLeftColor,
+            css::PropertyId::BorderRightColor,
+            css::PropertyId::BorderTopColor,
+            css::PropertyId::BorderBottomColor};
+
+    // One reverse pass picks up the winning declaration of all five
+    // properties at once.
+    std::array<std::string_view, kIds.size()> raw{};
+    std::size_t remaining{kIds.size()};
+    for (auto it = rbegin(properties); it != rend(properties) && remaining > 0; ++it) {
+        for (std::size_t i = 0; i < kIds.size(); ++i) {
+            if (it->first == kIds[i] && raw[i].empty()) {
+                raw[i] = it->second;
+                remaining -= 1;
+                break;
+            }
+        }
+    }
+
+    auto resolve = [&](std::size_t i) {
+        // Plain values parse straight from the collected view; absent
+        // properties and keywords like unset and currentcolor go through
+        // the full resolution path, which knows about initial values and
+        // the cascade.
+        auto value = raw[i];
+        if (!value.empty() && value != "unset" && value != "initial" && value != "inherit"
+                && value != "currentcolor") {
+            return parse_color(value);
+        }
+
+        return get_color_property(kIds[i]);
+    };
+
+    return {resolve(0), resolve(1), resolve(2), resolve(3), resolve(4)};
+}
+
 gfx::Color StyledNode::get_color_property(css::PropertyId property) const {
     auto color_text = get_raw_property(property);
 
@@ -276,6 +349,10 @@ gfx::Color StyledNode::get_color_property(css::PropertyId property) const {
 }
 
 DisplayValue StyledNode::get_display_property() const {
+    if (display) {
+        return *display;
+    }
+
     auto raw = get_raw_property(css::PropertyId::Display);
     if (raw == "none") {
         return DisplayValue::None;
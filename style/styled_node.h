@@ -8,9 +8,11 @@
 #include "css/property_id.h"
 #include "dom/dom.h"
 #include "gfx/color.h"
+#include "util/small_vector.h"
 #include "util/string.h"
 
 #include <algorithm>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -31,14 +33,39 @@ enum class FontStyle {
     Oblique,
 };
 
+// The colors a box's decoration paints with: background plus the four
+// border sides.
+struct BoxColors {
+    gfx::Color background{};
+    gfx::Color border_left{};
+    gfx::Color border_right{};
+    gfx::Color border_top{};
+    gfx::Color border_bottom{};
+
+    [[nodiscard]] bool operator==(BoxColors const &) const = default;
+};
+
 struct StyledNode {
     dom::Node const &node;
-    std::vector<std::pair<css::PropertyId, std::string>> properties;
+    // Most nodes have only a few matched declarations, so a heap allocation
+    // per node for them is pure overhead. The children have to stay in a
+    // std::vector as StyledNode is still incomplete here.
+    util::SmallVector<std::pair<css::PropertyId, std::string>, 6> properties;
     std::vector<StyledNode> children;
     StyledNode const *parent{nullptr};
+    // display, resolved once after styling so layout's per-box dispatch reads
+    // a byte instead of re-deriving it from the cascade. Derived state: not
+    // part of equality, and unset on trees built by hand, where get_property
+    // falls back to resolving the string form.
+    std::optional<DisplayValue> display{};
 
     std::string_view get_raw_property(css::PropertyId) const;
 
+    // All five box-decoration colors resolved in one pass over the node's
+    // properties, instead of the one-scan-per-property that five
+    // get_property calls would do.
+    BoxColors get_box_colors() const;
+
     template<css::PropertyId T>
     auto get_property() const {
         // Some of these branches have the same content, but we still want to
@@ -145,6 +145,61 @@ int main() {
         expect_eq(child.get_property<css::PropertyId::Color>(), gfx::Color::from_css_name("blue"));
     });
 
+    etest::test("box colors match the per-property queries", [] {
+        dom::Node dom_node = dom::Element{"dummy"s};
+        style::StyledNode root{
+                .node = dom_node,
+                .properties = {{css::PropertyId::Color, "blue"s}},
+                .children{
+                        style::StyledNode{
+                                .node{dom_node},
+                                .properties{
+                                        {css::PropertyId::BackgroundColor, "#abc"s},
+                                        {css::PropertyId::BorderLeftColor, "red"s},
+                                        {css::PropertyId::BorderRightColor, "currentcolor"s},
+                                        {css::PropertyId::BorderTopColor, "unset"s},
+                                },
+                        },
+                },
+        };
+
+        auto &child = root.children[0];
+        child.parent = &root;
+
+        auto colors = child.get_box_colors();
+        expect_eq(colors.background, child.get_property<css::PropertyId::BackgroundColor>());
+        expect_eq(colors.border_left, child.get_property<css::PropertyId::BorderLeftColor>());
+        expect_eq(colors.border_right, child.get_property<css::PropertyId::BorderRightColor>());
+        expect_eq(colors.border_top, child.get_property<css::PropertyId::BorderTopColor>());
+        // Not declared at all, so it resolves like any other absent property.
+        expect_eq(colors.border_bottom, child.get_property<css::PropertyId::BorderBottomColor>());
+    });
+
+    etest::test("box colors, later declarations win", [] {
+        dom::Node dom_node = dom::Element{"dummy"s};
+        style::StyledNode styled_node{
+                .node = dom_node,
+                .properties =
+                        {
+                                {css::PropertyId::BackgroundColor, "red"s},
+                                {css::PropertyId::BackgroundColor, "green"s},
+                        },
+        };
+
+        expect_eq(styled_node.get_box_colors().background, gfx::Color::from_css_name("green"));
+    });
+
+    etest::test("repeated color queries are stable", [] {
+        dom::Node dom_node = dom::Element{"dummy"s};
+        style::StyledNode styled_node{.node = dom_node, .properties = {{css::PropertyId::Color, "#abc"s}}};
+
+        // The second query is answered from the parse memo and has to match
+        // the first, freshly parsed, one.
+        auto first = styled_node.get_property<css::PropertyId::Color>();
+        expect_eq(styled_node.get_property<css::PropertyId::Color>(), first);
+        expect_eq(first, gfx::Color{0xAA, 0xBB, 0xCC});
+    });
+
     etest::test("get_font_style_property", [] {
         dom::Node dom_node = dom::Element{"dummy"s};
         style::StyledNode styled_node{.node = dom_node, .properties = {{css::PropertyId::FontStyle, "oblique"s}}};
@@ -238,7 +293,7 @@ int main() {
         expect_eq(dom::nodes_by_xpath(styled_node, "/html/div/"), NodeVec{});
         expect_eq(dom::nodes_by_xpath(styled_node, "/html/div/p"), NodeVec{});
         expect_eq(dom::nodes_by_xpath(styled_node, "/htm/div"), NodeVec{});
-        expect_eq(dom::nodes_by_xpath(styled_node, "//div"), NodeVec{});
+        expect_eq(dom::nodes_by_xpath(styled_node, "//div"), NodeVec{&styled_node.children[1]});
     });
 
     etest::test("get_property, last property gets priority", [] {
@@ -263,5 +318,17 @@ int main() {
         expect_eq(styled_node.get_property<css::PropertyId::Display>(), style::DisplayValue::Block);
     });
 
+    etest::test("get_property, resolved display wins over the string form", [] {
+        dom::Node dom_node = dom::Element{"dummy"s};
+        style::StyledNode styled_node{
+                .node = dom_node,
+                .properties = {{css::PropertyId::Display, "block"s}},
+                .children = {},
+                .display = style::DisplayValue::None,
+        };
+
+        expect_eq(styled_node.get_property<css::PropertyId::Display>(), style::DisplayValue::None);
+    });
+
     return etest::run_all_tests();
 }
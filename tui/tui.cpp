@@ -4,52 +4,156 @@
 
 #include "tui/tui.h"
 
+#include "geom/geom.h"
+#include "util/string.h"
+
+#include <fmt/format.h>
 #include <ftxui/dom/elements.hpp>
 #include <ftxui/screen/screen.hpp>
 #include <ftxui/screen/string.hpp>
 
+#include <cstddef>
 #include <cstdlib>
 #include <string>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace tui {
 namespace {
 
-ftxui::Element element_from_node(layout::LayoutBox const &box);
+constexpr int kScreenWidth = 80;
+constexpr int kScreenHeight = 10;
+
+// The mapping from terminal cells to layout pixels is approximate, so the
+// visible slice is padded by a screenful in each direction rather than cut
+// exactly at the screen edges.
+constexpr int kAssumedCellHeightPx = 16;
+constexpr int kViewportHeightPx = kScreenHeight * kAssumedCellHeightPx;
+// Wide enough that windowing only ever prunes vertically.
+constexpr int kViewportWidthPx = 1'000'000;
+
+constexpr geom::Rect viewport_for(int scroll_y) {
+    return {0, scroll_y - kViewportHeightPx, kViewportWidthPx, 3 * kViewportHeightPx};
+}
+
+ftxui::Element element_from_node(layout::LayoutBox const &box, geom::Rect const &viewport);
 
-ftxui::Elements parse_children(layout::LayoutBox const &box) {
+ftxui::Elements parse_children(layout::LayoutBox const &box, geom::Rect const &viewport) {
     ftxui::Elements children;
     for (auto const &child : box.children) {
-        children.push_back(element_from_node(child));
+        if (!child.dimensions.border_box().overlaps(viewport)) {
+            continue;
+        }
+
+        children.push_back(element_from_node(child, viewport));
     };
 
     return children;
 }
 
-ftxui::Element element_from_node(layout::LayoutBox const &box) {
+ftxui::Element element_for_box(layout::LayoutBox const &box, ftxui::Elements children) {
     switch (box.type) {
         case layout::LayoutType::Inline: {
             if (auto text = std::get_if<dom::Text>(&box.node->node)) {
                 return ftxui::paragraph(text->text);
             }
-            return hbox(parse_children(box));
+            return hbox(std::move(children));
         }
         case layout::LayoutType::AnonymousBlock:
         case layout::LayoutType::Block: {
-            return flex(vbox(parse_children(box)));
+            return flex(vbox(std::move(children)));
         }
     }
     std::abort(); // unreachable
 }
 
-} // namespace
+ftxui::Element element_from_node(layout::LayoutBox const &box, geom::Rect const &viewport) {
+    return element_for_box(box, parse_children(box, viewport));
+}
 
-std::string render(layout::LayoutBox const &root) {
-    auto document = element_from_node(root);
-    document = document | ftxui::size(ftxui::WIDTH, ftxui::LESS_THAN, 80);
-    auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(80), ftxui::Dimension::Fixed(10));
+std::string screen_from_element(ftxui::Element document) {
+    document = document | ftxui::size(ftxui::WIDTH, ftxui::LESS_THAN, kScreenWidth);
+    auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(kScreenWidth), ftxui::Dimension::Fixed(kScreenHeight));
     ftxui::Render(screen, document);
     return screen.ToString();
 }
 
+} // namespace
+
+std::string render(layout::LayoutBox const &root, int scroll_y) {
+    return screen_from_element(element_from_node(root, viewport_for(scroll_y)));
+}
+
+struct Renderer::Impl {
+    struct CachedSubtree {
+        layout::LayoutBox box{};
+        ftxui::Element element{};
+    };
+
+    std::vector<CachedSubtree> subtrees{};
+    std::vector<std::string> rows{};
+    int scroll_y{0};
+};
+
+Renderer::Renderer() : impl_{std::make_unique<Impl>()} {}
+Renderer::Renderer(Renderer &&) noexcept = default;
+Renderer &Renderer::operator=(Renderer &&) noexcept = default;
+Renderer::~Renderer() = default;
+
+std::string Renderer::render(layout::LayoutBox const &root, int scroll_y) {
+    // Cached subtrees were pruned against the old viewport, so scrolling
+    // invalidates all of them.
+    if (scroll_y != impl_->scroll_y) {
+        impl_->subtrees.clear();
+        impl_->scroll_y = scroll_y;
+    }
+
+    auto viewport = viewport_for(scroll_y);
+
+    // Reuse the element subtree of every visible top-level box that's
+    // identical to last frame and rebuild the rest.
+    auto &subtrees = impl_->subtrees;
+    subtrees.resize(root.children.size());
+    ftxui::Elements children;
+    children.reserve(root.children.size());
+    for (std::size_t i = 0; i < root.children.size(); ++i) {
+        if (!root.children[i].dimensions.border_box().overlaps(viewport)) {
+            continue;
+        }
+
+        if (subtrees[i].element == nullptr || subtrees[i].box != root.children[i]) {
+            subtrees[i] = {root.children[i], element_from_node(root.children[i], viewport)};
+        }
+
+        children.push_back(subtrees[i].element);
+    }
+
+    auto screen = screen_from_element(element_for_box(root, std::move(children)));
+
+    // Repaint only the rows that changed, addressing each one with a
+    // cursor-position escape so unchanged rows cost no bytes at all.
+    std::string update;
+    std::vector<std::string> rows;
+    for (auto row : util::LazySplit{screen, "\n"}) {
+        rows.emplace_back(row);
+    }
+
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        if (i < impl_->rows.size() && impl_->rows[i] == rows[i]) {
+            continue;
+        }
+
+        update += fmt::format("\x1b[{};1H{}\x1b[K", i + 1, rows[i]);
+    }
+
+    // Rows the previous frame had but this one doesn't need clearing.
+    for (std::size_t i = rows.size(); i < impl_->rows.size(); ++i) {
+        update += fmt::format("\x1b[{};1H\x1b[2K", i + 1);
+    }
+
+    impl_->rows = std::move(rows);
+    return update;
+}
+
 } // namespace tui
@@ -7,11 +7,38 @@
 
 #include "layout/layout.h"
 
+#include <memory>
 #include <string>
 
 namespace tui {
 
-std::string render(layout::LayoutBox const &root);
+// Renders the slice of the document starting scroll_y layout pixels from the
+// top. Subtrees falling entirely outside the visible slice are skipped before
+// any elements are built, so scrolling around in a huge document only pays
+// for roughly what's on screen.
+std::string render(layout::LayoutBox const &root, int scroll_y = 0);
+
+// Renders a document repeatedly, reusing work from the previous frame.
+//
+// Element subtrees are only rebuilt for top-level boxes that changed since the
+// last call, and the returned string only repaints the terminal rows that
+// differ from the previous frame, so refreshing a mostly-unchanged page costs
+// very little in both CPU and bytes over the wire.
+class Renderer {
+public:
+    Renderer();
+    Renderer(Renderer &&) noexcept;
+    Renderer &operator=(Renderer &&) noexcept;
+    ~Renderer();
+
+    // Returns the escape sequences and text needed to bring a terminal
+    // displaying the previous frame up to date with this layout.
+    std::string render(layout::LayoutBox const &root, int scroll_y = 0);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
 
 } // namespace tui
 
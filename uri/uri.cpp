@@ -9,8 +9,8 @@
 
 #include <fmt/format.h>
 
-#include <exception>
-#include <regex>
+#include <string>
+#include <string_view>
 #include <utility>
 
 namespace uri {
@@ -21,6 +21,7 @@ void normalize(Uri &uri) {
     // The scheme and host components of the URI are case-insensitive and
     // therefore should be normalized to lowercase.
     uri.scheme = util::lowercased(std::move(uri.scheme));
+    uri.scheme_id = scheme_from_string(uri.scheme);
     uri.authority.host = util::lowercased(std::move(uri.authority.host));
 
     // In presence of an authority component, an empty path component should be
@@ -50,48 +51,83 @@ void complete_from_base_if_needed(Uri &uri, Uri const &base) {
 
 } // namespace
 
-Uri Uri::parse(std::string uristr, std::optional<std::reference_wrapper<Uri const>> base_uri) {
-    // Regex taken from RFC 3986.
-    std::smatch match;
-    std::regex const uri_regex{"^(([^:/?#]+):)?(//([^/?#]*))?([^?#]*)(\\?([^#]*))?(#(.*))?"};
-    if (!std::regex_search(uristr, match, uri_regex)) {
-        std::terminate();
-    }
+// Splits along the same boundaries as the regex from RFC 3986:
+// ^(([^:/?#]+):)?(//([^/?#]*))?([^?#]*)(\?([^#]*))?(#(.*))?
+UriView UriView::parse(std::string_view uristr) {
+    UriView result{.uri = uristr};
+    auto remaining = uristr;
 
-    Authority authority{};
+    if (auto scheme_end = remaining.find_first_of(":/?#");
+            scheme_end != std::string_view::npos && scheme_end != 0 && remaining[scheme_end] == ':') {
+        result.scheme = remaining.substr(0, scheme_end);
+        remaining.remove_prefix(scheme_end + 1);
+    }
 
-    std::string hostport = match.str(4);
-    if (auto userinfo_end = hostport.find_first_of('@'); userinfo_end != std::string::npos) {
-        // Userinfo present.
-        std::string userinfo = hostport.substr(0, userinfo_end);
-        hostport = hostport.substr(userinfo_end + 1);
+    if (remaining.starts_with("//")) {
+        remaining.remove_prefix(2);
+        auto hostport = remaining.substr(0, remaining.find_first_of("/?#"));
+        remaining.remove_prefix(hostport.size());
+
+        if (auto userinfo_end = hostport.find('@'); userinfo_end != std::string_view::npos) {
+            // Userinfo present.
+            auto userinfo = hostport.substr(0, userinfo_end);
+            hostport.remove_prefix(userinfo_end + 1);
+
+            if (auto user_end = userinfo.find(':'); user_end != std::string_view::npos) {
+                // Password present.
+                result.authority.user = userinfo.substr(0, user_end);
+                result.authority.passwd = userinfo.substr(user_end + 1);
+            } else {
+                // Password not present.
+                result.authority.user = userinfo;
+            }
+        }
 
-        if (auto user_end = userinfo.find_first_of(':'); user_end != std::string::npos) {
-            // Password present.
-            authority.user = userinfo.substr(0, user_end);
-            authority.passwd = userinfo.substr(user_end + 1);
+        if (auto host_end = hostport.find(':'); host_end != std::string_view::npos) {
+            // Port present.
+            result.authority.host = hostport.substr(0, host_end);
+            result.authority.port = hostport.substr(host_end + 1);
         } else {
-            // Password not present.
-            authority.user = std::move(userinfo);
+            // Port not present.
+            result.authority.host = hostport;
         }
     }
 
-    if (auto host_end = hostport.find_first_of(':'); host_end != std::string::npos) {
-        // Port present.
-        authority.host = hostport.substr(0, host_end);
-        authority.port = hostport.substr(host_end + 1);
-    } else {
-        // Port not present.
-        authority.host = std::move(hostport);
+    result.path = remaining.substr(0, remaining.find_first_of("?#"));
+    remaining.remove_prefix(result.path.size());
+
+    if (remaining.starts_with('?')) {
+        remaining.remove_prefix(1);
+        result.query = remaining.substr(0, remaining.find('#'));
+        remaining.remove_prefix(result.query.size());
+    }
+
+    if (remaining.starts_with('#')) {
+        result.fragment = remaining.substr(1);
     }
 
-    auto uri = Uri{
-            .scheme{match.str(2)},
-            .authority{std::move(authority)},
-            .path{match.str(5)},
-            .query{match.str(7)},
-            .fragment{match.str(9)},
+    return result;
+}
+
+Uri UriView::to_uri() const {
+    return {
+            .uri = std::string{uri},
+            .scheme = std::string{scheme},
+            .authority{
+                    .user = std::string{authority.user},
+                    .passwd = std::string{authority.passwd},
+                    .host = std::string{authority.host},
+                    .port = std::string{authority.port},
+            },
+            .path = std::string{path},
+            .query = std::string{query},
+            .fragment = std::string{fragment},
     };
+}
+
+Uri Uri::parse(std::string uristr, std::optional<std::reference_wrapper<Uri const>> base_uri) {
+    auto uri = UriView::parse(uristr).to_uri();
+    // The views point into uristr, so they're copied before it's taken.
     uri.uri = std::move(uristr);
 
     normalize(uri);
@@ -103,4 +139,12 @@ Uri Uri::parse(std::string uristr, std::optional<std::reference_wrapper<Uri cons
     return uri;
 }
 
+Uri const &UriResolver::resolve(std::string const &uristr) {
+    if (auto it = resolved_.find(uristr); it != resolved_.end()) {
+        return it->second;
+    }
+
+    return resolved_.emplace(uristr, Uri::parse(uristr, base_)).first->second;
+}
+
 } // namespace uri
@@ -6,12 +6,47 @@
 #ifndef URI_URI_H_
 #define URI_URI_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace uri {
 
+// The schemes the browser has handlers for, interned by Uri::parse so
+// per-request dispatch on them is an array index rather than a string
+// comparison. Anything else stays Unknown and is dispatched by string.
+enum class Scheme : std::uint8_t {
+    Unknown,
+    Http,
+    Https,
+    File,
+};
+
+// One slot per Scheme value, for arrays indexed by scheme.
+inline constexpr std::size_t kSchemeCount{4};
+
+// Expects its argument to already be lowercased, like a parsed Uri's scheme.
+constexpr Scheme scheme_from_string(std::string_view scheme) {
+    if (scheme == "http") {
+        return Scheme::Http;
+    }
+
+    if (scheme == "https") {
+        return Scheme::Https;
+    }
+
+    if (scheme == "file") {
+        return Scheme::File;
+    }
+
+    return Scheme::Unknown;
+}
+
 struct Authority {
     std::string user;
     std::string passwd;
@@ -33,7 +68,65 @@ struct Uri {
     std::string query;
     std::string fragment;
 
-    [[nodiscard]] bool operator==(Uri const &) const = default;
+    // Interned form of scheme, filled in by parse.
+    Scheme scheme_id{Scheme::Unknown};
+
+    // scheme_id is derived from scheme, so it doesn't participate in
+    // equality; hand-built uris in tests rarely bother setting it.
+    [[nodiscard]] bool operator==(Uri const &other) const {
+        return uri == other.uri && scheme == other.scheme && authority == other.authority && path == other.path
+                && query == other.query && fragment == other.fragment;
+    }
+};
+
+struct AuthorityView {
+    std::string_view user;
+    std::string_view passwd;
+    std::string_view host;
+    std::string_view port;
+
+    [[nodiscard]] bool empty() const { return user.empty() && passwd.empty() && host.empty() && port.empty(); }
+
+    [[nodiscard]] bool operator==(AuthorityView const &) const = default;
+};
+
+// A uri split into views of the string it was parsed from: nothing is
+// allocated, and the components stay exactly as written, with no lowercasing
+// and no base-uri completion. Convert with to_uri() when the components need
+// to outlive the input.
+struct UriView {
+    static UriView parse(std::string_view uri);
+
+    std::string_view uri;
+    std::string_view scheme;
+    AuthorityView authority;
+    std::string_view path;
+    std::string_view query;
+    std::string_view fragment;
+
+    // Copies the views into an owned Uri. Unlike Uri::parse, this applies no
+    // normalization.
+    [[nodiscard]] Uri to_uri() const;
+
+    [[nodiscard]] bool operator==(UriView const &) const = default;
+};
+
+// Resolves uris relative to one base, e.g. a document's hrefs against the
+// document's uri. The base is parsed once up front, and resolutions are
+// memoized: nav menus repeat the same handful of links on every page, so a
+// repeated href only pays for resolution the first time it's seen.
+class UriResolver {
+public:
+    explicit UriResolver(Uri base) : base_{std::move(base)} {}
+
+    // The returned reference stays valid for the resolver's lifetime.
+    Uri const &resolve(std::string const &uri);
+
+    [[nodiscard]] Uri const &base() const { return base_; }
+
+private:
+    Uri base_;
+    std::map<std::string, Uri, std::less<>> resolved_;
 };
 
 } // namespace uri
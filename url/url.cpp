@@ -5,50 +5,325 @@
 #include "url/url.h"
 
 #include "util/string.h"
+#include "util/unicode.h"
 #include "util/uuid.h"
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace url {
+namespace {
+
+constexpr auto kHexDigits = std::string_view{"0123456789ABCDEF"};
+
+// One bit per encode set. The sets nest (each one contains the previous), so
+// a byte's entry holds every set from the first one it appears in onwards.
+constexpr std::array<std::uint8_t, 256> kEncodeSetBits = [] {
+    std::array<std::uint8_t, 256> bits{};
+
+    auto add = [&](PercentEncodeSet set, std::string_view bytes) {
+        std::uint8_t mask{};
+        for (auto s = static_cast<std::size_t>(set); s <= static_cast<std::size_t>(PercentEncodeSet::Component); ++s) {
+            mask |= static_cast<std::uint8_t>(1 << s);
+        }
+
+        for (unsigned char byte : bytes) {
+            bits[byte] |= mask;
+        }
+    };
+
+    // Every set contains the C0 control set.
+    for (std::size_t byte = 0; byte < bits.size(); ++byte) {
+        if (byte < 0x20 || byte > 0x7e) {
+            bits[byte] = 0b0111'1111;
+        }
+    }
+
+    add(PercentEncodeSet::Fragment, " \"<>`");
+    add(PercentEncodeSet::Query, " \"#<>");
+    add(PercentEncodeSet::SpecialQuery, "'");
+    add(PercentEncodeSet::Path, "?`{}");
+    add(PercentEncodeSet::Userinfo, "/:;=@[\\]^|");
+    add(PercentEncodeSet::Component, "$%&+,");
+
+    return bits;
+}();
+
+constexpr bool needs_encoding(char c, PercentEncodeSet set) {
+    return (kEncodeSetBits[static_cast<unsigned char>(c)] & (1 << static_cast<std::size_t>(set))) != 0;
+}
+
+// Bootstring parameters for punycode, from RFC 3492 section 5.
+constexpr std::uint32_t kPunycodeBase = 36;
+constexpr std::uint32_t kPunycodeTMin = 1;
+constexpr std::uint32_t kPunycodeTMax = 26;
+constexpr std::uint32_t kPunycodeSkew = 38;
+constexpr std::uint32_t kPunycodeDamp = 700;
+constexpr std::uint32_t kPunycodeInitialBias = 72;
+constexpr std::uint32_t kPunycodeInitialN = 128;
+
+// https://datatracker.ietf.org/doc/html/rfc3492#section-6.1
+constexpr std::uint32_t punycode_adapt(std::uint32_t delta, std::uint32_t num_points, bool first_time) {
+    delta = first_time ? delta / kPunycodeDamp : delta / 2;
+    delta += delta / num_points;
+
+    std::uint32_t k = 0;
+    while (delta > ((kPunycodeBase - kPunycodeTMin) * kPunycodeTMax) / 2) {
+        delta /= kPunycodeBase - kPunycodeTMin;
+        k += kPunycodeBase;
+    }
+
+    return k + (((kPunycodeBase - kPunycodeTMin + 1) * delta) / (delta + kPunycodeSkew));
+}
+
+constexpr char punycode_digit(std::uint32_t d) {
+    return d < 26 ? static_cast<char>('a' + d) : static_cast<char>('0' + d - 26);
+}
+
+// https://datatracker.ietf.org/doc/html/rfc3492#section-6.3
+std::optional<std::string> punycode_encode(std::vector<std::uint32_t> const &input) {
+    std::string output{};
+    for (auto code_point : input) {
+        if (code_point < 0x80) {
+            output += static_cast<char>(code_point);
+        }
+    }
+
+    auto basic = static_cast<std::uint32_t>(output.size());
+    auto handled = basic;
+    if (basic > 0) {
+        output += '-';
+    }
+
+    std::uint32_t n = kPunycodeInitialN;
+    std::uint32_t delta = 0;
+    std::uint32_t bias = kPunycodeInitialBias;
+    while (handled < input.size()) {
+        auto m = std::numeric_limits<std::uint32_t>::max();
+        for (auto code_point : input) {
+            if (code_point >= n && code_point < m) {
+                m = code_point;
+            }
+        }
+
+        if (m - n > (std::numeric_limits<std::uint32_t>::max() - delta) / (handled + 1)) {
+            return std::nullopt;
+        }
+
+        delta += (m - n) * (handled + 1);
+        n = m;
+        for (auto code_point : input) {
+            if (code_point < n && ++delta == 0) {
+                return std::nullopt;
+            }
+
+            if (code_point == n) {
+                auto q = delta;
+                for (std::uint32_t k = kPunycodeBase;; k += kPunycodeBase) {
+                    auto t = k <= bias ? kPunycodeTMin : (k >= bias + kPunycodeTMax ? kPunycodeTMax : k - bias);
+                    if (q < t) {
+                        break;
+                    }
+
+                    output += punycode_digit(t + (q - t) % (kPunycodeBase - t));
+                    q = (q - t) / (kPunycodeBase - t);
+                }
+
+                output += punycode_digit(q);
+                bias = punycode_adapt(delta, handled + 1, handled == basic);
+                delta = 0;
+                ++handled;
+            }
+        }
+
+        ++delta;
+        ++n;
+    }
+
+    return output;
+}
+
+// Decodes a label that utf8_is_valid already vetted. Ascii letters are
+// lowercased on the way through; full IDNA (UTS 46) also case-folds and
+// normalizes non-ascii code points, but that needs unicode tables we don't
+// ship, so those are encoded as they came.
+std::vector<std::uint32_t> label_code_points(std::string_view label) {
+    std::vector<std::uint32_t> code_points{};
+    code_points.reserve(label.size());
+    for (std::size_t i = 0; i < label.size();) {
+        auto lead = static_cast<unsigned char>(label[i]);
+        if (lead < 0x80) {
+            code_points.push_back(static_cast<unsigned char>(util::lowercased(label[i])));
+            i += 1;
+            continue;
+        }
+
+        std::size_t continuation_bytes = (lead & 0b1110'0000) == 0b1100'0000 ? 1 //
+                : (lead & 0b1111'0000) == 0b1110'0000                        ? 2
+                                                                             : 3;
+        std::uint32_t code_point = lead & (0b0111'1111 >> continuation_bytes);
+        for (std::size_t j = 1; j <= continuation_bytes; ++j) {
+            code_point = code_point << 6 | (static_cast<unsigned char>(label[i + j]) & 0b0011'1111);
+        }
+
+        code_points.push_back(code_point);
+        i += continuation_bytes + 1;
+    }
+
+    return code_points;
+}
+
+std::optional<std::string> map_domain(std::string_view host) {
+    std::string out{};
+    out.reserve(host.size());
+
+    // Ascii hosts (including ones that already carry xn-- labels) only need
+    // lowercasing.
+    if (std::ranges::all_of(host, [](char c) { return static_cast<unsigned char>(c) < 0x80; })) {
+        std::ranges::transform(host, std::back_inserter(out), [](char c) { return util::lowercased(c); });
+        return out;
+    }
+
+    if (!util::utf8_is_valid(host)) {
+        return std::nullopt;
+    }
+
+    bool first = true;
+    for (auto label : util::LazySplit{host, "."}) {
+        if (!std::exchange(first, false)) {
+            out += '.';
+        }
+
+        if (std::ranges::all_of(label, [](char c) { return static_cast<unsigned char>(c) < 0x80; })) {
+            std::ranges::transform(label, std::back_inserter(out), [](char c) { return util::lowercased(c); });
+            continue;
+        }
+
+        auto encoded = punycode_encode(label_code_points(label));
+        if (!encoded) {
+            return std::nullopt;
+        }
+
+        out += "xn--";
+        out += *encoded;
+    }
+
+    return out;
+}
+
+} // namespace
+
+void percent_encode_to(std::string_view input, std::string &out, PercentEncodeSet set) {
+    while (!input.empty()) {
+        std::size_t clean{0};
+        while (clean < input.size() && !needs_encoding(input[clean], set)) {
+            ++clean;
+        }
+
+        out.append(input.substr(0, clean));
+        input.remove_prefix(clean);
+
+        if (!input.empty()) {
+            auto byte = static_cast<unsigned char>(input.front());
+            out += '%';
+            out += kHexDigits[byte >> 4];
+            out += kHexDigits[byte & 0xf];
+            input.remove_prefix(1);
+        }
+    }
+}
+
+std::string percent_encode(std::string_view input, PercentEncodeSet set) {
+    std::string out{};
+    out.reserve(input.size());
+    percent_encode_to(input, out, set);
+    return out;
+}
+
+// https://url.spec.whatwg.org/#host-serializing
+void host_serialize_to(Host const &host, std::string &out) {
+    switch (host.type) {
+        case HostType::DnsDomain:
+        case HostType::Opaque:
+        case HostType::Empty:
+            out += std::get<std::string>(host.data);
+            break;
+        case HostType::Ip4Addr:
+            out += util::ipv4_serialize(std::get<std::uint32_t>(host.data));
+            break;
+        case HostType::Ip6Addr:
+            std::array<std::uint16_t, 8> v6 = std::get<std::array<std::uint16_t, 8>>(host.data);
+            out += '[';
+            out += util::ipv6_serialize(v6);
+            out += ']';
+    }
+}
+
+std::string host_serialize(Host const &host) {
+    std::string out{};
+    host_serialize_to(host, out);
+    return out;
+}
 
 // https://w3c.github.io/FileAPI/#unicodeBlobURL
 std::string blob_url_create(Origin const &origin) {
-    std::string result = "blob:";
-    std::string serialized = "";
+    std::string result{};
+    // "blob:" + scheme + "://" + host + ":" + port + "/" + uuid, with some
+    // slack so typical hosts fit without a second allocation.
+    result.reserve(origin.scheme.size() + 96);
+    result += "blob:";
 
     // https://html.spec.whatwg.org/multipage/browsers.html#ascii-serialisation-of-an-origin
     if (origin.opaque) {
-        serialized = "null";
+        result += "null";
     } else {
-        serialized = origin.scheme + "://";
-
-        switch (origin.host.type) {
-            case HostType::DnsDomain:
-            case HostType::Opaque:
-            case HostType::Empty:
-                serialized += std::get<std::string>(origin.host.data);
-                break;
-            case HostType::Ip4Addr:
-                serialized += util::ipv4_serialize(std::get<std::uint32_t>(origin.host.data));
-                break;
-            case HostType::Ip6Addr:
-                std::array<std::uint16_t, 8> v6 = std::get<std::array<std::uint16_t, 8>>(origin.host.data);
-                serialized += "[" + util::ipv6_serialize(v6) + "]";
-        }
+        result += origin.scheme;
+        result += "://";
+        host_serialize_to(origin.host, result);
 
         if (origin.port.has_value()) {
-            serialized += ":" + std::to_string(origin.port.value());
+            result += ':';
+            result += std::to_string(origin.port.value());
         }
     }
 
-    result += serialized;
-    result += "/";
+    result += '/';
     result += util::new_uuid();
 
     return result;
 }
 
+std::optional<std::string> domain_to_ascii(std::string_view host) {
+    // Keyed by the raw host string, like the dns cache, so every parse of a
+    // url pointing at a known host skips the unicode processing. Failures
+    // are cached too; a host doesn't become encodable by being retried.
+    static std::mutex mutex{};
+    static std::map<std::string, std::optional<std::string>, std::less<>> cache{};
+
+    {
+        std::scoped_lock lock{mutex};
+        if (auto it = cache.find(host); it != cache.end()) {
+            return it->second;
+        }
+    }
+
+    auto mapped = map_domain(host);
+
+    std::scoped_lock lock{mutex};
+    return cache.emplace(std::string{host}, std::move(mapped)).first->second;
+}
+
 } // namespace url
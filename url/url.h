@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 
 namespace url {
@@ -30,11 +31,55 @@ struct Origin {
     bool opaque;
 };
 
+/**
+ * The percent-encode sets from https://url.spec.whatwg.org/#percent-encoded-bytes
+ */
+enum class PercentEncodeSet : std::uint8_t {
+    C0Control,
+    Fragment,
+    Query,
+    SpecialQuery,
+    Path,
+    Userinfo,
+    Component,
+};
+
+/**
+ * Appends input to out, percent-encoding the bytes the set requires.
+ *
+ * Classification is one table lookup per byte and clean stretches are
+ * appended in bulk, so already-encoded input costs no more than a copy.
+ */
+void percent_encode_to(std::string_view input, std::string &out, PercentEncodeSet);
+
+std::string percent_encode(std::string_view input, PercentEncodeSet);
+
+/**
+ * Appends the serialization of the host to out, as in
+ * https://url.spec.whatwg.org/#host-serializing
+ */
+void host_serialize_to(Host const &host, std::string &out);
+
+std::string host_serialize(Host const &host);
+
 /**
  * Generates a new Blob URL for the given origin
  */
 std::string blob_url_create(Origin const &origin);
 
+/**
+ * Converts a domain to the ascii form dns wants: ascii labels are
+ * lowercased, and non-ascii labels become xn-- labels per RFC 3492.
+ * Returns std::nullopt for hosts that aren't valid utf-8 or whose labels
+ * can't be encoded.
+ *
+ * Results are cached process-wide keyed by the raw host string — the same
+ * key the dns cache uses — since sessions revisit the same few dozen hosts
+ * continuously, so repeated conversions of a host cost one map lookup
+ * instead of redoing the unicode processing.
+ */
+std::optional<std::string> domain_to_ascii(std::string_view host);
+
 } // namespace url
 
 #endif
@@ -42,5 +42,45 @@ int main() {
                 blob, std::regex("blob:https://\\[2001:db8:85a3::8a2e:370:7334\\]:8080/" + REGEX_UUID)));
     });
 
+    etest::test("percent encoding", [] {
+        using url::PercentEncodeSet;
+
+        etest::expect_eq(url::percent_encode("nothing-to-do", PercentEncodeSet::Component), "nothing-to-do");
+        etest::expect_eq(url::percent_encode("hello world", PercentEncodeSet::Fragment), "hello%20world");
+
+        // '?' is fine in a fragment, but not in a path.
+        etest::expect_eq(url::percent_encode("a?b", PercentEncodeSet::Fragment), "a?b");
+        etest::expect_eq(url::percent_encode("a?b", PercentEncodeSet::Path), "a%3Fb");
+
+        etest::expect_eq(url::percent_encode("100%", PercentEncodeSet::Component), "100%25");
+        etest::expect_eq(url::percent_encode("\x7f", PercentEncodeSet::C0Control), "%7F");
+    });
+
+    etest::test("host serialization", [] {
+        etest::expect_eq(url::host_serialize({url::HostType::DnsDomain, "example.com"}), "example.com");
+        etest::expect_eq(url::host_serialize({url::HostType::Ip4Addr, std::uint32_t{134744072}}), "8.8.8.8");
+
+        std::array<std::uint16_t, 8> v6 = {0x2001, 0xdb8, 0x85a3, 0, 0, 0x8a2e, 0x370, 0x7334};
+        etest::expect_eq(url::host_serialize({url::HostType::Ip6Addr, v6}), "[2001:db8:85a3::8a2e:370:7334]");
+    });
+
+    etest::test("domain to ascii", [] {
+        // Ascii hosts just get lowercased, xn-- labels included.
+        etest::expect_eq(url::domain_to_ascii("Example.COM"), "example.com");
+        etest::expect_eq(url::domain_to_ascii("XN--BCHER-KVA.example"), "xn--bcher-kva.example");
+
+        // Non-ascii labels are punycoded.
+        etest::expect_eq(url::domain_to_ascii("b\xc3\xbc"
+                                              "cher.example"),
+                "xn--bcher-kva.example");
+        etest::expect_eq(url::domain_to_ascii("\xc3\xbc"
+                                              "bung.M\xc3\xbcLLER.example"),
+                "xn--bung-zra.xn--mller-kva.example");
+
+        // Broken utf-8 can't be mapped, the first time or from the cache.
+        etest::expect_eq(url::domain_to_ascii("\xff.example"), std::nullopt);
+        etest::expect_eq(url::domain_to_ascii("\xff.example"), std::nullopt);
+    });
+
     return etest::run_all_tests();
 }
@@ -10,8 +10,16 @@
 
 #include <concepts>
 #include <cstddef>
+#include <cstring>
 #include <string_view>
 
+#ifdef __SSE2__
+#include <bit>
+#include <cstdint>
+
+#include <emmintrin.h>
+#endif
+
 namespace util {
 
 template<typename T>
@@ -51,7 +59,92 @@ public:
         return input_.substr(start, pos_ - start);
     }
 
+    // Advances to the next occurrence of the delimiter, returning false and
+    // stopping at the end of input if there isn't one.
+    constexpr bool seek_to(char delimiter) {
+        if !consteval {
+            auto const *hit = static_cast<char const *>( //
+                    std::memchr(input_.data() + pos_, delimiter, input_.size() - pos_));
+            if (hit == nullptr) {
+                pos_ = input_.size();
+                return false;
+            }
+
+            pos_ = static_cast<std::size_t>(hit - input_.data());
+            return true;
+        }
+
+        if (auto hit = input_.find(delimiter, pos_); hit != std::string_view::npos) {
+            pos_ = hit;
+            return true;
+        }
+
+        pos_ = input_.size();
+        return false;
+    }
+
+    // Consumes until the delimiter or the end of input is found, leaving the
+    // delimiter itself unconsumed.
+    constexpr std::string_view consume_until(char delimiter) {
+        std::size_t const start = pos_;
+        seek_to(delimiter);
+        return input_.substr(start, pos_ - start);
+    }
+
+    // Consumes until one of the delimiters or the end of input is found,
+    // scanning a block of input at a time where the hardware allows.
+    constexpr std::string_view consume_until_any_of(std::string_view delimiters) {
+        std::size_t const start = pos_;
+
+        if !consteval {
+#ifdef __SSE2__
+            while (pos_ + 16 <= input_.size()) {
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                auto const chars = _mm_loadu_si128(reinterpret_cast<__m128i const *>(input_.data() + pos_));
+                auto hits = _mm_setzero_si128();
+                for (char delimiter : delimiters) {
+                    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chars, _mm_set1_epi8(delimiter)));
+                }
+
+                if (auto mask = static_cast<std::uint16_t>(_mm_movemask_epi8(hits)); mask != 0) {
+                    pos_ += std::countr_zero(mask);
+                    return input_.substr(start, pos_ - start);
+                }
+
+                pos_ += 16;
+            }
+#endif
+        }
+
+        while (!is_eof() && delimiters.find(input_[pos_]) == std::string_view::npos) {
+            ++pos_;
+        }
+
+        return input_.substr(start, pos_ - start);
+    }
+
     constexpr void skip_whitespace() {
+        if !consteval {
+#ifdef __SSE2__
+            while (pos_ + 16 <= input_.size()) {
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                auto const chars = _mm_loadu_si128(reinterpret_cast<__m128i const *>(input_.data() + pos_));
+                auto whitespace = _mm_setzero_si128();
+                for (char ws : {' ', '\n', '\r', '\f', '\v', '\t'}) {
+                    whitespace = _mm_or_si128(whitespace, _mm_cmpeq_epi8(chars, _mm_set1_epi8(ws)));
+                }
+
+                auto mask = static_cast<std::uint16_t>(_mm_movemask_epi8(whitespace));
+                if (mask != 0xFFFF) {
+                    pos_ += std::countr_one(mask);
+                    return;
+                }
+
+                pos_ += 16;
+            }
+#endif
+        }
+
         while (!is_eof() && util::is_whitespace(peek())) {
             advance(1);
         }
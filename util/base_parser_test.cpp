@@ -6,6 +6,8 @@
 
 #include "etest/etest.h"
 
+#include <string>
+
 using etest::expect;
 using etest::expect_eq;
 using util::BaseParser;
@@ -54,6 +56,49 @@ int main() {
         expect_eq(p.consume_while([](char c) { return c != 'd'; }), "c");
     });
 
+    etest::test("consume_until_any_of", [] {
+        auto p = BaseParser("name: value; }");
+        expect_eq(p.consume_until_any_of(":"), "name");
+        expect_eq(p.consume_char(), ':');
+        expect_eq(p.consume_until_any_of(";}"), " value");
+        expect_eq(p.consume_char(), ';');
+        expect_eq(p.consume_until_any_of("#"), " }");
+        expect(p.is_eof());
+    });
+
+    etest::test("consume_until_any_of, long input", [] {
+        // Long enough that any block-at-a-time fast path runs several blocks.
+        std::string prefix(100, 'a');
+        auto input = prefix + "{" + std::string(40, 'b') + "}";
+        auto p = BaseParser(input);
+        expect_eq(p.consume_until_any_of(",{"), prefix);
+        expect_eq(p.consume_char(), '{');
+    });
+
+    etest::test("seek_to", [] {
+        auto p = BaseParser("name: value");
+        expect(p.seek_to(':'));
+        expect_eq(p.consume_char(), ':');
+        expect(!p.seek_to('#'));
+        expect(p.is_eof());
+    });
+
+    etest::test("consume_until", [] {
+        auto p = BaseParser("name: value; }");
+        expect_eq(p.consume_until(':'), "name");
+        expect_eq(p.consume_char(), ':');
+        expect_eq(p.consume_until('#'), " value; }");
+        expect(p.is_eof());
+    });
+
+    etest::test("consume_until, long input", [] {
+        std::string prefix(100, 'a');
+        auto input = prefix + "{" + std::string(40, 'b') + "}";
+        auto p = BaseParser(input);
+        expect_eq(p.consume_until('{'), prefix);
+        expect_eq(p.consume_char(), '{');
+    });
+
     etest::test("skip_whitespace, consume_char", [] {
         auto p = BaseParser("      \t       \n         h          \n\n\ni");
         p.skip_whitespace();
@@ -62,4 +107,14 @@ int main() {
         p.skip_whitespace();
         expect_eq(p.consume_char(), 'i');
     });
+
+    etest::test("skip_whitespace, long whitespace run", [] {
+        auto input = std::string(70, ' ') + "x";
+        auto p = BaseParser(input);
+        p.skip_whitespace();
+        expect_eq(p.consume_char(), 'x');
+        expect(p.is_eof());
+    });
+
+    return etest::run_all_tests();
 }
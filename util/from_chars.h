@@ -5,64 +5,165 @@
 #ifndef UTIL_FROM_CHARS_H_
 #define UTIL_FROM_CHARS_H_
 
-#include <version>
-
-// Workaround for libc++ not supporting std::from_chars for floating point numbers.
-// TODO(robinlinden): Nuke once libc++ supports std::from_chars w/ floats.
-#if defined(_LIBCPP_VERSION)
-
 #include <algorithm>
-#include <cerrno>
+#include <array>
 #include <charconv>
-#include <cstdlib>
-#include <iterator>
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <system_error>
+#include <type_traits>
 
 namespace util {
 
-// https://en.cppreference.com/w/cpp/utility/from_chars
-using std::from_chars;
 using std::from_chars_result;
 
-// Not spec-compliant at all, but good enough for how we're using it.
+namespace detail {
+
+// The powers of ten a double represents exactly. With an exact mantissa and
+// an exponent in this range, one multiply (or divide) yields the correctly
+// rounded double.
+constexpr std::array<double, 23> kExactPowersOfTen{1e0,
+        1e1,
+        1e2,
+        1e3,
+        1e4,
+        1e5,
+        1e6,
+        1e7,
+        1e8,
+        1e9,
+        1e10,
+        1e11,
+        1e12,
+        1e13,
+        1e14,
+        1e15,
+        1e16,
+        1e17,
+        1e18,
+        1e19,
+        1e20,
+        1e21,
+        1e22};
+
+// 10^exponent in extended precision, for values off the fast path. The
+// couple of ulps of long double error squaring can accumulate is far below
+// what a float resolves.
+inline long double power_of_ten(int exponent) {
+    bool negative = exponent < 0;
+    auto remaining = static_cast<unsigned>(negative ? -exponent : exponent);
+    long double base = 10.L;
+    long double result = 1.L;
+    while (remaining != 0) {
+        if ((remaining & 1) != 0) {
+            result *= base;
+        }
+
+        base *= base;
+        remaining >>= 1;
+    }
+
+    return negative ? 1.L / result : result;
+}
+
+} // namespace detail
+
+// Integers go straight to the standard library.
+template<typename T>
+requires std::is_integral_v<T>
+from_chars_result from_chars(char const *first, char const *last, T &value, int base = 10) {
+    return std::from_chars(first, last, value, base);
+}
+
+// Locale-free float parsing, used on every platform: libc++ still has no
+// std::from_chars for floats, and the strtof family consults the locale on
+// every call. Digits are read into a base-10 mantissa and exponent, and the
+// common case -- few enough digits that the mantissa is exact, and a small
+// exponent -- finishes with a single correctly rounded multiply. Not
+// std::from_chars to the letter (no hex, inf, or nan), but it covers
+// everything css throws at it.
 inline from_chars_result from_chars(char const *first, char const *last, float &value) {
-    // Produce a null-terminated string that we can safely pass to std::strtof.
-    std::string to_parse{first, last};
-    char *end{};
-    float result = std::strtof(to_parse.c_str(), &end);
-    if (end == to_parse.c_str()) {
-        // No conversion could be performed.
-        return {first, std::errc::invalid_argument};
+    char const *it = first;
+    bool negative = it != last && *it == '-';
+    if (negative) {
+        ++it;
     }
 
-    // Since we're parsing a copy of the argument, we need to map the end ptr
-    // back into the string the user provided.
-    auto map_end_into_argument_string = [&] {
-        auto parsed_length = std::distance(to_parse.c_str(), static_cast<char const *>(end));
-        auto new_end = first;
-        std::advance(new_end, parsed_length);
-        return new_end;
+    std::uint64_t mantissa = 0;
+    int exponent10 = 0;
+    bool any_digits = false;
+    bool truncated = false;
+    auto consume_digits = [&](bool after_point) {
+        while (it != last && *it >= '0' && *it <= '9') {
+            any_digits = true;
+            if (mantissa < (std::numeric_limits<std::uint64_t>::max() - 9) / 10) {
+                mantissa = mantissa * 10 + static_cast<std::uint64_t>(*it - '0');
+                if (after_point) {
+                    --exponent10;
+                }
+            } else {
+                // Digits past what 64 bits hold only shift the scale.
+                if (!after_point) {
+                    ++exponent10;
+                }
+
+                truncated = truncated || *it != '0';
+            }
+
+            ++it;
+        }
     };
 
-    if (errno == ERANGE) {
-        return {map_end_into_argument_string(), std::errc::result_out_of_range};
+    consume_digits(false);
+    if (it != last && *it == '.') {
+        ++it;
+        consume_digits(true);
     }
 
-    value = result;
-    return {map_end_into_argument_string(), std::errc{}};
-}
+    if (!any_digits) {
+        return {first, std::errc::invalid_argument};
+    }
 
-} // namespace util
+    if (it != last && (*it == 'e' || *it == 'E')) {
+        char const *exponent_part = it + 1;
+        bool exponent_negative = false;
+        if (exponent_part != last && (*exponent_part == '+' || *exponent_part == '-')) {
+            exponent_negative = *exponent_part == '-';
+            ++exponent_part;
+        }
 
-#else
+        // An e with no digits after it isn't part of the number.
+        if (exponent_part != last && *exponent_part >= '0' && *exponent_part <= '9') {
+            int exponent = 0;
+            while (exponent_part != last && *exponent_part >= '0' && *exponent_part <= '9') {
+                // Clamped; anything near this size over- or underflows anyway.
+                exponent = std::min(exponent * 10 + (*exponent_part - '0'), 100'000);
+                ++exponent_part;
+            }
 
-#include <charconv>
-namespace util {
-using std::from_chars;
-using std::from_chars_result;
-} // namespace util
+            exponent10 += exponent_negative ? -exponent : exponent;
+            it = exponent_part;
+        }
+    }
 
-#endif
+    double result{};
+    if (!truncated && mantissa < (std::uint64_t{1} << 53) && exponent10 >= -22 && exponent10 <= 22) {
+        result = static_cast<double>(mantissa);
+        result = exponent10 < 0 ? result / detail::kExactPowersOfTen[static_cast<std::size_t>(-exponent10)]
+                                : result * detail::kExactPowersOfTen[static_cast<std::size_t>(exponent10)];
+    } else {
+        result = static_cast<double>(static_cast<long double>(mantissa) * detail::power_of_ten(exponent10));
+    }
+
+    if (result > static_cast<double>(std::numeric_limits<float>::max())) {
+        return {it, std::errc::result_out_of_range};
+    }
+
+    value = negative ? -static_cast<float>(result) : static_cast<float>(result);
+    return {it, std::errc{}};
+}
+
+} // namespace util
 
 #endif
@@ -48,5 +48,49 @@ int main() {
         expect_eq(v, 0.f);
     });
 
+    etest::test("success, exponents", [] {
+        auto from = "6.25e-2"sv;
+        float v{};
+        auto res = util::from_chars(from.data(), from.data() + from.size(), v);
+        expect_eq(res, util::from_chars_result{from.data() + from.size(), std::errc{}});
+        expect_eq(v, 0.0625f);
+
+        from = "1.5E2"sv;
+        res = util::from_chars(from.data(), from.data() + from.size(), v);
+        expect_eq(res, util::from_chars_result{from.data() + from.size(), std::errc{}});
+        expect_eq(v, 150.f);
+    });
+
+    etest::test("success, trailing garbage", [] {
+        // The css lengths we parse leave their unit after the number.
+        auto from = "2.5rem"sv;
+        float v{};
+        auto res = util::from_chars(from.data(), from.data() + from.size(), v);
+        expect_eq(res, util::from_chars_result{from.data() + 3, std::errc{}});
+        expect_eq(v, 2.5f);
+
+        // An e with no digits after it isn't part of the number.
+        from = "5e"sv;
+        res = util::from_chars(from.data(), from.data() + from.size(), v);
+        expect_eq(res, util::from_chars_result{from.data() + 1, std::errc{}});
+        expect_eq(v, 5.f);
+    });
+
+    etest::test("success, more digits than a mantissa holds", [] {
+        auto from = "3.141592653589793238462643383279502884"sv;
+        float v{};
+        auto res = util::from_chars(from.data(), from.data() + from.size(), v);
+        expect_eq(res, util::from_chars_result{from.data() + from.size(), std::errc{}});
+        expect_eq(v, 3.14159265f);
+    });
+
+    etest::test("success, integers", [] {
+        auto from = "42"sv;
+        int v{};
+        auto res = util::from_chars(from.data(), from.data() + from.size(), v);
+        expect_eq(res, util::from_chars_result{from.data() + from.size(), std::errc{}});
+        expect_eq(v, 42);
+    });
+
     return etest::run_all_tests();
 }
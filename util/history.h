@@ -5,16 +5,35 @@
 #ifndef UTIL_HISTORY_H_
 #define UTIL_HISTORY_H_
 
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <ios>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
 namespace util {
 
+// Navigation history, bounded so a long session holds the most recent
+// max_entries entries instead of growing forever. Storage is reserved up
+// front: pushes within the bound never reallocate, and once it's reached the
+// oldest entry is dropped for each new one.
+//
+// Optionally backed by an append-only log on disk (attach_log), replayed on
+// attach so a restarted session resumes where it left off.
 template<typename T>
 class History {
 public:
-    constexpr void push(T entry) {
+    static constexpr std::size_t kDefaultMaxEntries{512};
+
+    explicit History(std::size_t max_entries = kDefaultMaxEntries) : max_entries_{max_entries} {
+        entries_.reserve(max_entries_);
+    }
+
+    void push(T entry) {
         // Are we already on this entry?
         if (current_index_ >= 0 && entries_[current_index_] == entry) {
             return;
@@ -27,9 +46,15 @@ public:
             return;
         }
 
+        log(entry);
+
         // Does the entry require more space in the list?
         if (static_cast<std::size_t>(current_index_) == entries_.size()) {
             entries_.push_back(std::move(entry));
+            if (entries_.size() > max_entries_) {
+                entries_.erase(cbegin(entries_));
+                current_index_ -= 1;
+            }
             return;
         }
 
@@ -72,9 +97,45 @@ public:
 
     constexpr std::vector<T> const &entries() const { return entries_; }
 
+    // Backs the history with an append-only log at path, one serialized
+    // entry per line. Whatever the log already holds is replayed first, then
+    // it's compacted down to the (bounded) replayed entries so it doesn't
+    // grow across sessions, and every later push is appended as it happens.
+    // Entries whose line doesn't deserialize are skipped, so a damaged log
+    // loses lines rather than the session.
+    void attach_log(std::filesystem::path const &path,
+            std::function<std::string(T const &)> serialize,
+            std::function<std::optional<T>(std::string const &)> deserialize) {
+        serialize_ = std::move(serialize);
+
+        if (std::ifstream replay{path}; replay) {
+            for (std::string line; std::getline(replay, line);) {
+                if (auto entry = deserialize(line)) {
+                    push(std::move(*entry));
+                }
+            }
+        }
+
+        log_ = std::ofstream{path, std::ios::trunc};
+        for (auto const &entry : entries_) {
+            log(entry);
+        }
+    }
+
 private:
+    void log(T const &entry) {
+        if (log_.is_open()) {
+            log_ << serialize_(entry) << '\n';
+            log_.flush();
+        }
+    }
+
+    std::size_t max_entries_{kDefaultMaxEntries};
     int current_index_{-1};
     std::vector<T> entries_;
+
+    std::function<std::string(T const &)> serialize_{};
+    std::ofstream log_{};
 };
 
 } // namespace util
@@ -6,7 +6,12 @@
 
 #include "etest/etest.h"
 
+#include <charconv>
+#include <filesystem>
+#include <fstream>
 #include <optional>
+#include <string>
+#include <system_error>
 #include <vector>
 
 using etest::expect_eq;
@@ -105,5 +110,67 @@ int main() {
         expect_eq(h.entries(), std::vector<int>{1, 2, 3, 4});
     });
 
+    etest::test("the oldest entry is dropped once the bound is hit", [] {
+        History<int> h{3};
+
+        h.push(1);
+        h.push(2);
+        h.push(3);
+        h.push(4);
+
+        expect_eq(h.entries(), std::vector<int>{2, 3, 4});
+        expect_eq(h.current(), 4);
+        expect_eq(h.previous(), 3);
+    });
+
+    etest::test("an attached log is replayed and appended to", [] {
+        auto path = std::filesystem::temp_directory_path() / "hastur_history_test.log";
+        std::filesystem::remove(path);
+
+        auto serialize = [](int entry) { return std::to_string(entry); };
+        auto deserialize = [](std::string const &line) -> std::optional<int> {
+            int parsed{};
+            if (std::from_chars(line.data(), line.data() + line.size(), parsed).ec != std::errc{}) {
+                return std::nullopt;
+            }
+            return parsed;
+        };
+
+        {
+            History<int> h;
+            h.attach_log(path, serialize, deserialize);
+            h.push(1);
+            h.push(2);
+        }
+
+        History<int> restored;
+        restored.attach_log(path, serialize, deserialize);
+        expect_eq(restored.entries(), std::vector<int>{1, 2});
+        expect_eq(restored.current(), 2);
+
+        std::filesystem::remove(path);
+    });
+
+    etest::test("lines that don't deserialize are skipped", [] {
+        auto path = std::filesystem::temp_directory_path() / "hastur_history_damaged_test.log";
+        {
+            std::ofstream log{path};
+            log << "1\nnot a number\n3\n";
+        }
+
+        History<int> h;
+        h.attach_log(path, [](int entry) { return std::to_string(entry); }, [](std::string const &line) -> std::optional<int> {
+            int parsed{};
+            if (std::from_chars(line.data(), line.data() + line.size(), parsed).ec != std::errc{}) {
+                return std::nullopt;
+            }
+            return parsed;
+        });
+
+        expect_eq(h.entries(), std::vector<int>{1, 3});
+
+        std::filesystem::remove(path);
+    });
+
     return etest::run_all_tests();
 }
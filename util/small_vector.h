@@ -0,0 +1,209 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef UTIL_SMALL_VECTOR_H_
+#define UTIL_SMALL_VECTOR_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// A vector that stores up to InlineCapacity elements inside itself instead of
+// on the heap, spilling to a heap allocation only when it outgrows that
+// buffer. Meant for hot structs where most instances hold a handful of
+// elements and a separate allocation per instance dominates the build time.
+//
+// Unlike std::vector, T must be a complete type, so a struct can't use this
+// for a list of its own type (e.g. tree children).
+template<typename T, std::size_t InlineCapacity>
+class SmallVector {
+public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = T const *;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    SmallVector() = default;
+
+    SmallVector(std::initializer_list<T> values) { assign(values.begin(), values.end()); }
+
+    // Implicit conversion from std::vector keeps this a drop-in replacement
+    // for members that used to be vectors.
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    SmallVector(std::vector<T> const &values) { assign(values.begin(), values.end()); }
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    SmallVector(std::vector<T> &&values) {
+        reserve(values.size());
+        for (auto &value : values) {
+            push_back(std::move(value));
+        }
+    }
+
+    SmallVector(SmallVector const &other) { assign(other.begin(), other.end()); }
+
+    SmallVector(SmallVector &&other) noexcept { steal(std::move(other)); }
+
+    SmallVector &operator=(SmallVector const &other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    SmallVector &operator=(SmallVector &&other) noexcept {
+        if (this != &other) {
+            destroy();
+            steal(std::move(other));
+        }
+        return *this;
+    }
+
+    SmallVector &operator=(std::initializer_list<T> values) {
+        assign(values.begin(), values.end());
+        return *this;
+    }
+
+    ~SmallVector() { destroy(); }
+
+    template<typename InputIt>
+    void assign(InputIt first, InputIt last) {
+        clear();
+        for (; first != last; ++first) {
+            push_back(*first);
+        }
+    }
+
+    void reserve(std::size_t capacity) {
+        if (capacity > capacity_) {
+            grow(capacity);
+        }
+    }
+
+    void push_back(T const &value) { emplace_back(value); }
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_back(Args &&...args) {
+        if (size_ == capacity_) {
+            grow(capacity_ * 2);
+        }
+
+        auto *slot = std::construct_at(data_ + size_, std::forward<Args>(args)...);
+        size_ += 1;
+        return *slot;
+    }
+
+    void pop_back() {
+        assert(size_ > 0);
+        size_ -= 1;
+        std::destroy_at(data_ + size_);
+    }
+
+    void clear() {
+        std::destroy(begin(), end());
+        size_ = 0;
+    }
+
+    T &operator[](std::size_t idx) { return data_[idx]; }
+    T const &operator[](std::size_t idx) const { return data_[idx]; }
+
+    T &at(std::size_t idx) {
+        assert(idx < size_);
+        return data_[idx];
+    }
+
+    T const &at(std::size_t idx) const {
+        assert(idx < size_);
+        return data_[idx];
+    }
+
+    T &front() { return data_[0]; }
+    T const &front() const { return data_[0]; }
+    T &back() { return data_[size_ - 1]; }
+    T const &back() const { return data_[size_ - 1]; }
+
+    T *data() { return data_; }
+    T const *data() const { return data_; }
+
+    iterator begin() { return data_; }
+    const_iterator begin() const { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator end() const { return data_ + size_; }
+    reverse_iterator rbegin() { return reverse_iterator{end()}; }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator{end()}; }
+    reverse_iterator rend() { return reverse_iterator{begin()}; }
+    const_reverse_iterator rend() const { return const_reverse_iterator{begin()}; }
+
+    [[nodiscard]] std::size_t size() const { return size_; }
+    [[nodiscard]] std::size_t capacity() const { return capacity_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+
+    [[nodiscard]] bool operator==(SmallVector const &other) const {
+        return std::equal(begin(), end(), other.begin(), other.end());
+    }
+
+    [[nodiscard]] bool operator==(std::vector<T> const &other) const {
+        return std::equal(begin(), end(), other.begin(), other.end());
+    }
+
+private:
+    [[nodiscard]] T *inline_buffer() { return reinterpret_cast<T *>(buffer_); }
+    [[nodiscard]] bool is_inline() const { return data_ == reinterpret_cast<T const *>(buffer_); }
+
+    void grow(std::size_t capacity) {
+        capacity = std::max(capacity, InlineCapacity + 1);
+        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+        auto *heap = static_cast<T *>(::operator new(capacity * sizeof(T), std::align_val_t{alignof(T)}));
+        std::uninitialized_move(begin(), end(), heap);
+        std::destroy(begin(), end());
+        if (!is_inline()) {
+            ::operator delete(data_, std::align_val_t{alignof(T)});
+        }
+
+        data_ = heap;
+        capacity_ = capacity;
+    }
+
+    // Takes over the other vector's elements, leaving it empty. Heap buffers
+    // are stolen wholesale, inline elements are moved one by one.
+    void steal(SmallVector &&other) noexcept {
+        if (other.is_inline()) {
+            data_ = inline_buffer();
+            capacity_ = InlineCapacity;
+            size_ = other.size_;
+            std::uninitialized_move(other.begin(), other.end(), data_);
+            other.clear();
+        } else {
+            data_ = std::exchange(other.data_, other.inline_buffer());
+            capacity_ = std::exchange(other.capacity_, InlineCapacity);
+            size_ = std::exchange(other.size_, 0);
+        }
+    }
+
+    void destroy() {
+        clear();
+        if (!is_inline()) {
+            ::operator delete(data_, std::align_val_t{alignof(T)});
+        }
+    }
+
+    alignas(T) std::byte buffer_[InlineCapacity * sizeof(T)];
+    T *data_{inline_buffer()};
+    std::size_t size_{0};
+    std::size_t capacity_{InlineCapacity};
+};
+
+} // namespace util
+
+#endif
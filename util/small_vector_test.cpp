@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "util/small_vector.h"
+
+#include "etest/etest.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+using etest::expect;
+using etest::expect_eq;
+using util::SmallVector;
+
+int main() {
+    etest::test("small vectors stay inline", [] {
+        SmallVector<int, 4> v{1, 2, 3};
+        expect_eq(v.size(), std::size_t{3});
+        expect_eq(v.capacity(), std::size_t{4});
+        expect_eq(v[0], 1);
+        expect_eq(v.back(), 3);
+    });
+
+    etest::test("growing past the inline capacity", [] {
+        SmallVector<int, 2> v;
+        for (int i = 0; i < 10; ++i) {
+            v.push_back(i);
+        }
+
+        expect_eq(v.size(), std::size_t{10});
+        expect(v.capacity() >= std::size_t{10});
+        for (int i = 0; i < 10; ++i) {
+            expect_eq(v[static_cast<std::size_t>(i)], i);
+        }
+    });
+
+    etest::test("copying", [] {
+        SmallVector<std::string, 2> v{"hello", "wonderful", "world"};
+        auto copy = v;
+        expect_eq(copy, v);
+
+        copy.push_back("!");
+        expect(!(copy == v));
+    });
+
+    etest::test("moving", [] {
+        SmallVector<std::string, 2> inline_sized{"hi"};
+        auto moved_inline = std::move(inline_sized);
+        expect_eq(moved_inline, SmallVector<std::string, 2>{"hi"});
+
+        SmallVector<std::string, 2> heap_sized{"one", "two", "three"};
+        auto moved_heap = std::move(heap_sized);
+        expect_eq(moved_heap, (SmallVector<std::string, 2>{"one", "two", "three"}));
+        expect(heap_sized.empty()); // NOLINT(bugprone-use-after-move): Moving leaves the vector empty.
+
+        heap_sized.push_back("reuse after move is fine");
+        expect_eq(heap_sized.size(), std::size_t{1});
+    });
+
+    etest::test("clear and pop_back destroy elements", [] {
+        SmallVector<std::string, 2> v{"a", "b", "c"};
+        v.pop_back();
+        expect_eq(v.size(), std::size_t{2});
+        expect_eq(v.back(), "b");
+
+        v.clear();
+        expect(v.empty());
+    });
+
+    etest::test("reserve", [] {
+        SmallVector<int, 2> v;
+        v.reserve(100);
+        expect(v.capacity() >= std::size_t{100});
+        expect(v.empty());
+
+        auto *data = v.data();
+        for (int i = 0; i < 100; ++i) {
+            v.push_back(i);
+        }
+
+        // No reallocation happened while filling the reserved space.
+        expect_eq(v.data(), data);
+    });
+
+    return etest::run_all_tests();
+}
@@ -9,7 +9,9 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <ios>
 #include <iterator>
 #include <span>
@@ -78,17 +80,130 @@ constexpr char lowercased(char c) {
     return s;
 }
 
-constexpr bool no_case_compare(std::string_view a, std::string_view b) {
+// Folds A-Z to a-z in each of the eight bytes packed into v, leaving every
+// other byte as it is.
+constexpr std::uint64_t lowercased8(std::uint64_t v) {
+    constexpr std::uint64_t kHighBits = 0x8080'8080'8080'8080;
+    constexpr std::uint64_t kOnes = 0x0101'0101'0101'0101;
+    // A byte is upper-case if its high bit is clear and its low seven bits
+    // are in [A, Z]; the additions carry into the high bit for bytes at or
+    // past each bound, and can't carry further since both addends fit in
+    // seven bits.
+    std::uint64_t low7 = v & ~kHighBits;
+    std::uint64_t at_least_a = (low7 + (0x80 - 'A') * kOnes) & kHighBits;
+    std::uint64_t past_z = (low7 + (0x80 - 'Z' - 1) * kOnes) & kHighBits;
+    std::uint64_t is_upper = at_least_a & ~past_z & ~(v & kHighBits);
+    // The high bit of each upper-case byte, moved down to the 0x20 case bit.
+    return v | (is_upper >> 2);
+}
+
+// Case-insensitive comparison of ascii strings, folding case sixteen bytes
+// at a time.
+constexpr bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    if !consteval {
+        auto folded8 = [](char const *data) {
+            std::uint64_t block{};
+            std::memcpy(&block, data, sizeof(block));
+            return lowercased8(block);
+        };
+
+        while (a.size() >= 2 * sizeof(std::uint64_t)) {
+            if (folded8(a.data()) != folded8(b.data()) || folded8(a.data() + 8) != folded8(b.data() + 8)) {
+                return false;
+            }
+
+            a.remove_prefix(2 * sizeof(std::uint64_t));
+            b.remove_prefix(2 * sizeof(std::uint64_t));
+        }
+    }
+
     return std::ranges::equal(a, b, [](auto c1, auto c2) { return lowercased(c1) == lowercased(c2); });
 }
 
+// Case-insensitive std::string_view::find for ascii strings.
+constexpr std::size_t ifind(std::string_view haystack, std::string_view needle) {
+    if (needle.size() > haystack.size()) {
+        return std::string_view::npos;
+    }
+
+    for (std::size_t i = 0; i <= haystack.size() - needle.size(); ++i) {
+        if (iequals(haystack.substr(i, needle.size()), needle)) {
+            return i;
+        }
+    }
+
+    return std::string_view::npos;
+}
+
+// Lazily yields the sep-separated pieces of str as views, one per
+// iteration, for consumers that walk the pieces once and don't need them
+// materialized into a vector. Splits like split(): empty pieces between
+// adjacent separators are yielded, and there's always at least one piece.
+class LazySplit {
+public:
+    constexpr LazySplit(std::string_view str, std::string_view sep) : str_{str}, sep_{sep} {}
+
+    class Iterator {
+    public:
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+
+        constexpr Iterator() = default;
+        constexpr Iterator(std::string_view str, std::string_view sep) : remaining_{str}, sep_{sep} { advance(); }
+
+        constexpr std::string_view operator*() const { return current_; }
+
+        constexpr Iterator &operator++() {
+            if (!has_more_) {
+                finished_ = true;
+                return *this;
+            }
+
+            advance();
+            return *this;
+        }
+
+        constexpr void operator++(int) { ++*this; }
+
+        constexpr bool operator==(std::default_sentinel_t) const { return finished_; }
+
+    private:
+        constexpr void advance() {
+            auto p = remaining_.find(sep_);
+            if (p == std::string_view::npos) {
+                current_ = remaining_;
+                has_more_ = false;
+                return;
+            }
+
+            current_ = remaining_.substr(0, p);
+            remaining_.remove_prefix(p + sep_.size());
+        }
+
+        std::string_view remaining_{};
+        std::string_view sep_{};
+        std::string_view current_{};
+        bool has_more_{true};
+        bool finished_{false};
+    };
+
+    [[nodiscard]] constexpr Iterator begin() const { return Iterator{str_, sep_}; }
+    [[nodiscard]] constexpr std::default_sentinel_t end() const { return {}; }
+
+private:
+    std::string_view str_{};
+    std::string_view sep_{};
+};
+
 inline std::vector<std::string_view> split(std::string_view str, std::string_view sep) {
     std::vector<std::string_view> result{};
-    for (auto p = str.find(sep); p != str.npos; p = str.find(sep)) {
-        result.push_back(str.substr(0, p));
-        str.remove_prefix(std::min(p + sep.size(), str.size()));
+    for (auto piece : LazySplit{str, sep}) {
+        result.push_back(piece);
     }
-    result.push_back(str);
     return result;
 }
 
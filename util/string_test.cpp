@@ -7,7 +7,11 @@
 
 #include "etest/etest.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <string_view>
+#include <vector>
 
 using namespace std::literals;
 using namespace util;
@@ -67,17 +71,33 @@ int main() {
         expect_eq(lowercased("woop woop"), "woop woop");
     });
 
-    etest::test("no case compare", [] {
-        expect(no_case_compare("word"sv, "word"sv));
-        expect(no_case_compare("WORD"sv, "WORD"sv));
-        expect(no_case_compare("word"sv, "WORD"sv));
-        expect(no_case_compare("WORD"sv, "word"sv));
-        expect(no_case_compare("Abc-Def_Ghi"sv, "aBc-DEf_gHi"sv));
-        expect(no_case_compare("10 seconds"sv, "10 Seconds"sv));
-        expect(no_case_compare("Abc $#@"sv, "ABC $#@"sv));
-        expect(!no_case_compare(" word"sv, "word"sv));
-        expect(!no_case_compare("word "sv, "word"sv));
-        expect(!no_case_compare("word "sv, "woord"sv));
+    etest::test("iequals", [] {
+        expect(iequals("word"sv, "word"sv));
+        expect(iequals("WORD"sv, "WORD"sv));
+        expect(iequals("word"sv, "WORD"sv));
+        expect(iequals("WORD"sv, "word"sv));
+        expect(iequals("Abc-Def_Ghi"sv, "aBc-DEf_gHi"sv));
+        expect(iequals("10 seconds"sv, "10 Seconds"sv));
+        expect(iequals("Abc $#@"sv, "ABC $#@"sv));
+        expect(!iequals(" word"sv, "word"sv));
+        expect(!iequals("word "sv, "word"sv));
+        expect(!iequals("word "sv, "woord"sv));
+    });
+
+    etest::test("iequals, block-sized strings", [] {
+        expect(iequals("Content-Type: TEXT/HTML; charset=UTF-8"sv, "content-type: text/html; charset=utf-8"sv));
+        expect(!iequals("Content-Type: TEXT/HTML; charset=UTF-8"sv, "content-type: text/html; charset=utf-9"sv));
+        expect(!iequals("00000000000000000Bc"sv, "00000000000000000bD"sv));
+        // Case folding is ascii-only; the high bit opts a byte out.
+        expect(!iequals("\xc5\xc5\xc5\xc5\xc5\xc5\xc5\xc5"sv, "\xe5\xe5\xe5\xe5\xe5\xe5\xe5\xe5"sv));
+    });
+
+    etest::test("ifind", [] {
+        expect_eq(ifind("DejaVuSans.ttf"sv, "dejavusans"sv), std::size_t{0});
+        expect_eq(ifind("abcDEF"sv, "CdE"sv), std::size_t{2});
+        expect_eq(ifind("abc"sv, ""sv), std::size_t{0});
+        expect_eq(ifind("abc"sv, "d"sv), std::string_view::npos);
+        expect_eq(ifind("ab"sv, "abc"sv), std::string_view::npos);
     });
 
     etest::test("split, single char delimiter", [] {
@@ -145,6 +165,22 @@ int main() {
         expect_eq(s[0], "");
     });
 
+    etest::test("lazy split yields the same pieces as split", [] {
+        for (auto str : {"a,b,c,d", ",a,b,", "", ",", "abc"}) {
+            std::vector<std::string_view> pieces;
+            for (auto piece : LazySplit{str, ","}) {
+                pieces.push_back(piece);
+            }
+
+            expect_eq(pieces, split(str, ","));
+        }
+    });
+
+    etest::test("lazy split works with range algorithms", [] {
+        expect(std::ranges::any_of(LazySplit{"nav active hidden", " "}, [](auto c) { return c == "active"; }));
+        expect(!std::ranges::any_of(LazySplit{"nav active hidden", " "}, [](auto c) { return c == "act"; }));
+    });
+
     etest::test("split, multi char delimiter at start and end", [] {
         std::string_view str{"bbbabbbcbbbdbbbebbb"};
         auto s = split(str, "bbb");
@@ -0,0 +1,183 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef UTIL_TRACE_H_
+#define UTIL_TRACE_H_
+
+#include <fmt/format.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace util::trace {
+
+// One completed span. The name has to point at a string literal: spans store
+// the pointer, not a copy.
+struct TraceEvent {
+    char const *name{};
+    int tid{};
+    std::int64_t start_us{};
+    std::int64_t duration_us{};
+};
+
+namespace detail {
+
+// Fixed-size per-thread span log. When it fills up it wraps around, so the
+// newest spans win.
+struct ThreadLog {
+    static constexpr std::size_t kCapacity = 4096;
+
+    std::mutex mutex{};
+    int tid{};
+    std::array<TraceEvent, kCapacity> events{};
+    std::size_t next{};
+    bool wrapped{};
+};
+
+struct Registry {
+    std::mutex mutex{};
+    std::vector<std::shared_ptr<ThreadLog>> logs{};
+    int next_tid{1};
+};
+
+inline Registry &registry() {
+    static Registry instance{};
+    return instance;
+}
+
+inline std::atomic<bool> &enabled() {
+    static std::atomic<bool> is_enabled{false};
+    return is_enabled;
+}
+
+// The time all events are reported relative to, fixed the first time it's
+// asked for.
+inline std::chrono::steady_clock::time_point epoch() {
+    static auto const start = std::chrono::steady_clock::now();
+    return start;
+}
+
+inline ThreadLog &thread_log() {
+    // Held by shared_ptr so a thread's spans survive the thread for dumping.
+    thread_local std::shared_ptr<ThreadLog> log = [] {
+        auto new_log = std::make_shared<ThreadLog>();
+        auto &reg = registry();
+        std::scoped_lock lock{reg.mutex};
+        new_log->tid = reg.next_tid++;
+        reg.logs.push_back(new_log);
+        return new_log;
+    }();
+    return *log;
+}
+
+inline std::int64_t to_us(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+} // namespace detail
+
+inline bool is_enabled() {
+    return detail::enabled().load(std::memory_order_relaxed);
+}
+
+inline void enable() {
+    detail::epoch();
+    detail::enabled().store(true, std::memory_order_relaxed);
+}
+
+inline void disable() {
+    detail::enabled().store(false, std::memory_order_relaxed);
+}
+
+// Drops every span collected so far.
+inline void clear() {
+    auto &reg = detail::registry();
+    std::scoped_lock lock{reg.mutex};
+    for (auto const &log : reg.logs) {
+        std::scoped_lock log_lock{log->mutex};
+        log->next = 0;
+        log->wrapped = false;
+    }
+}
+
+// Scoped span covering its own lifetime. Costs one relaxed atomic load when
+// tracing is disabled.
+class Span {
+public:
+    explicit Span(char const *name) {
+        if (is_enabled()) {
+            name_ = name;
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~Span() {
+        if (name_ == nullptr) {
+            return;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        auto &log = detail::thread_log();
+        std::scoped_lock lock{log.mutex};
+        log.events[log.next] = {
+                .name = name_,
+                .tid = log.tid,
+                .start_us = detail::to_us(start_ - detail::epoch()),
+                .duration_us = detail::to_us(end - start_),
+        };
+
+        if (++log.next == detail::ThreadLog::kCapacity) {
+            log.next = 0;
+            log.wrapped = true;
+        }
+    }
+
+    Span(Span const &) = delete;
+    Span &operator=(Span const &) = delete;
+
+private:
+    char const *name_{nullptr};
+    std::chrono::steady_clock::time_point start_{};
+};
+
+// Serializes every collected span into the trace-event format understood by
+// chrome://tracing and https://ui.perfetto.dev/.
+inline std::string to_trace_json() {
+    std::string events{};
+    auto append = [&](TraceEvent const &event) {
+        if (!events.empty()) {
+            events += ',';
+        }
+
+        events += fmt::format(R"({{"name":"{}","cat":"trace","ph":"X","ts":{},"dur":{},"pid":1,"tid":{}}})",
+                event.name,
+                event.start_us,
+                event.duration_us,
+                event.tid);
+    };
+
+    auto &reg = detail::registry();
+    std::scoped_lock lock{reg.mutex};
+    for (auto const &log : reg.logs) {
+        std::scoped_lock log_lock{log->mutex};
+        std::size_t count = log->wrapped ? detail::ThreadLog::kCapacity : log->next;
+        std::size_t oldest = log->wrapped ? log->next : 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            append(log->events[(oldest + i) % detail::ThreadLog::kCapacity]);
+        }
+    }
+
+    return fmt::format(R"({{"traceEvents":[{}]}})", events);
+}
+
+} // namespace util::trace
+
+#endif
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "util/trace.h"
+
+#include "etest/etest.h"
+
+#include <string>
+
+using etest::expect;
+using etest::expect_eq;
+
+int main() {
+    etest::test("spans while disabled aren't collected", [] {
+        { util::trace::Span span{"ignored"}; }
+        expect_eq(util::trace::to_trace_json(), R"({"traceEvents":[]})");
+    });
+
+    etest::test("spans while enabled end up in the dump", [] {
+        util::trace::enable();
+        {
+            util::trace::Span outer{"outer"};
+            util::trace::Span inner{"inner"};
+        }
+        util::trace::disable();
+
+        auto json = util::trace::to_trace_json();
+        expect(json.contains(R"("name":"outer")"));
+        expect(json.contains(R"("name":"inner")"));
+        expect(json.contains(R"("ph":"X")"));
+    });
+
+    etest::test("clear drops collected spans", [] {
+        util::trace::clear();
+        expect_eq(util::trace::to_trace_json(), R"({"traceEvents":[]})");
+    });
+
+    return etest::run_all_tests();
+}
@@ -5,8 +5,11 @@
 #ifndef UTIL_UNICODE_H_
 #define UTIL_UNICODE_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
 
 namespace util {
 
@@ -61,6 +64,79 @@ inline std::string unicode_to_utf8(std::uint32_t code_point) {
     }
 }
 
+// Checks that the data is well-formed utf-8 per RFC 3629: every sequence is
+// the shortest encoding of its code point, and no sequence encodes a
+// surrogate or anything past U+10FFFF. Ascii-only stretches are skipped
+// eight bytes at a time.
+constexpr bool utf8_is_valid(std::string_view data) {
+    std::size_t i = 0;
+    while (i < data.size()) {
+        if !consteval {
+            constexpr std::uint64_t kHighBits = 0x8080'8080'8080'8080;
+            while (data.size() - i >= sizeof(std::uint64_t)) {
+                std::uint64_t block{};
+                std::memcpy(&block, data.data() + i, sizeof(block));
+                if ((block & kHighBits) != 0) {
+                    break;
+                }
+
+                i += sizeof(block);
+            }
+
+            if (i == data.size()) {
+                break;
+            }
+        }
+
+        auto lead = static_cast<unsigned char>(data[i]);
+        if (lead < 0x80) {
+            i += 1;
+            continue;
+        }
+
+        std::size_t continuation_bytes = 0;
+        std::uint32_t code_point = 0;
+        std::uint32_t smallest = 0;
+        if ((lead & 0b1110'0000) == 0b1100'0000) {
+            continuation_bytes = 1;
+            code_point = lead & 0b0001'1111;
+            smallest = 0x80;
+        } else if ((lead & 0b1111'0000) == 0b1110'0000) {
+            continuation_bytes = 2;
+            code_point = lead & 0b0000'1111;
+            smallest = 0x800;
+        } else if ((lead & 0b1111'1000) == 0b1111'0000) {
+            continuation_bytes = 3;
+            code_point = lead & 0b0000'0111;
+            smallest = 0x1'0000;
+        } else {
+            return false;
+        }
+
+        if (data.size() - i <= continuation_bytes) {
+            return false;
+        }
+
+        for (std::size_t j = 1; j <= continuation_bytes; ++j) {
+            auto byte = static_cast<unsigned char>(data[i + j]);
+            if ((byte & 0b1100'0000) != 0b1000'0000) {
+                return false;
+            }
+
+            code_point = code_point << 6 | (byte & 0b0011'1111);
+        }
+
+        bool is_surrogate = code_point >= 0xd800 && code_point <= 0xdfff;
+        if (code_point < smallest || is_surrogate || code_point > 0x10ffff) {
+            return false;
+        }
+
+        i += continuation_bytes + 1;
+    }
+
+    return true;
+}
+
 } // namespace util
 
 #endif
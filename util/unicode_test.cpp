@@ -10,9 +10,11 @@
 
 using namespace std::literals;
 
+using etest::expect;
 using etest::expect_eq;
 using util::unicode_to_utf8;
 using util::unicode_utf8_byte_count;
+using util::utf8_is_valid;
 
 int main() {
     etest::test("unicode_utf8_byte_count", [] {
@@ -49,5 +51,31 @@ int main() {
         expect_eq(unicode_to_utf8(0x110000), ""sv);
     });
 
+    etest::test("utf8_is_valid", [] {
+        expect(utf8_is_valid(""sv));
+        expect(utf8_is_valid("hello"sv));
+        expect(utf8_is_valid("a string long enough to hit the eight-byte ascii fast path"sv));
+        expect(utf8_is_valid("nÖn-ascii ह € 한 𐍈"sv));
+
+        // Stray continuation byte.
+        expect(!utf8_is_valid("\x80"sv));
+        // 0xf8 starts a five-byte sequence, which utf-8 no longer has.
+        expect(!utf8_is_valid("\xf8\x88\x80\x80\x80"sv));
+        // Truncated two- and four-byte sequences.
+        expect(!utf8_is_valid("\xc3"sv));
+        expect(!utf8_is_valid("\xf0\x9f\x98"sv));
+        // A continuation byte that isn't one.
+        expect(!utf8_is_valid("\xc3\x28"sv));
+        // Overlong encodings of '/' and NUL.
+        expect(!utf8_is_valid("\xc0\xaf"sv));
+        expect(!utf8_is_valid("\xe0\x80\x80"sv));
+        // The surrogate U+D800, and the first code point past U+10FFFF.
+        expect(!utf8_is_valid("\xed\xa0\x80"sv));
+        expect(!utf8_is_valid("\xf4\x90\x80\x80"sv));
+
+        // Bad bytes are still seen when preceded by a block of ascii.
+        expect(!utf8_is_valid("sixteen bytes of \xc3("sv));
+    });
+
     return etest::run_all_tests();
 }
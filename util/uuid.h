@@ -6,41 +6,80 @@
 #ifndef UTIL_UUID_H_
 #define UTIL_UUID_H_
 
-#include <iomanip>
-#include <ios>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <random>
-#include <sstream>
-#include <utility>
+#include <span>
+#include <string>
 
 namespace util {
-inline std::string new_uuid() {
-    unsigned char data[16];
-    std::stringstream uuid_string;
-    uuid_string << std::setfill('0');
+namespace detail {
+
+// Hands out random 16-byte blocks from a buffer a thread-local prng fills a
+// thousand bytes at a time. random_device — which may cost a syscall per
+// word — is only touched to seed, so a UUID's share of the random bits is a
+// couple of generator steps amortized over the batch.
+class UuidRandomPool {
+public:
+    std::array<unsigned char, 16> take() {
+        if (next_ == block_.size()) {
+            refill();
+        }
 
-    std::random_device rando;
+        std::array<unsigned char, 16> out;
+        std::memcpy(out.data(), block_.data() + next_, out.size());
+        next_ += out.size();
+        return out;
+    }
 
-    for (size_t i = 0; i < 16; i++) {
-        data[i] = static_cast<unsigned char>(rando());
+private:
+    void refill() {
+        for (std::size_t i = 0; i < block_.size(); i += sizeof(std::uint64_t)) {
+            auto word = prng_();
+            std::memcpy(block_.data() + i, &word, sizeof(word));
+        }
+        next_ = 0;
     }
 
+    // 64 UUIDs per refill.
+    static constexpr std::size_t kBlockSize{16 * 64};
+
+    std::array<unsigned char, kBlockSize> block_{};
+    std::size_t next_{kBlockSize};
+    std::mt19937_64 prng_{std::random_device{}()};
+};
+
+} // namespace detail
+
+// Formats a random version-4 UUID into out without allocating.
+inline void new_uuid(std::span<char, 36> out) {
+    thread_local detail::UuidRandomPool pool;
+    auto data = pool.take();
+
     // Set UUID version bits
-    data[6] &= 0x0f;
-    data[6] |= 0x40;
+    data[6] = static_cast<unsigned char>((data[6] & 0x0f) | 0x40);
 
     // Set UUID variant bits
-    data[8] &= 0x3f;
-    data[8] |= 0x80;
+    data[8] = static_cast<unsigned char>((data[8] & 0x3f) | 0x80);
 
-    for (size_t i = 0; i < 16; i++) {
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+    std::size_t at{0};
+    for (std::size_t i = 0; i < data.size(); ++i) {
         if (i == 4 || i == 6 || i == 8 || i == 10) {
-            uuid_string << '-';
+            out[at++] = '-';
         }
 
-        uuid_string << std::setw(2) << std::hex << +data[i];
+        out[at++] = kHexDigits[data[i] >> 4];
+        out[at++] = kHexDigits[data[i] & 0x0f];
     }
+}
 
-    return std::move(uuid_string).str();
+inline std::string new_uuid() {
+    std::string uuid(36, '\0');
+    new_uuid(std::span<char, 36>{uuid});
+    return uuid;
 }
 
 } // namespace util
@@ -6,7 +6,10 @@
 
 #include "etest/etest.h"
 
+#include <array>
 #include <iostream>
+#include <set>
+#include <span>
 #include <string>
 
 using etest::require;
@@ -24,6 +27,32 @@ int main() {
         require(u[23] == '-');
     });
 
+    etest::test("UUID version and variant bits", [] {
+        std::string u = util::new_uuid();
+        require(u[14] == '4');
+        require(u[19] == '8' || u[19] == '9' || u[19] == 'a' || u[19] == 'b');
+    });
+
+    etest::test("UUIDs stay distinct across a pool refill", [] {
+        // The thread-local pool holds 64 UUIDs worth of random bytes, so
+        // this crosses several refills.
+        std::set<std::string> seen;
+        for (int i = 0; i < 500; ++i) {
+            seen.insert(util::new_uuid());
+        }
+
+        require(seen.size() == 500);
+    });
+
+    etest::test("allocation-free overload formats identically", [] {
+        std::array<char, 36> buf{};
+        util::new_uuid(std::span{buf});
+        std::string u{buf.begin(), buf.end()};
+        require(u.size() == 36);
+        require(u[8] == '-');
+        require(u[14] == '4');
+    });
+
     // To-Do(dzero): Add collision test
 
     return etest::run_all_tests();
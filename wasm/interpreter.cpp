@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "wasm/interpreter.h"
+
+#include "wasm/leb128.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace wasm {
+
+std::optional<std::vector<Instruction>> Interpreter::decode_body(std::span<std::uint8_t const> code) {
+    std::vector<Instruction> instructions;
+    while (!code.empty()) {
+        auto opcode = code.front();
+        code = code.subspan(1);
+
+        switch (opcode) {
+            case 0x20:
+            case 0x21: {
+                auto local = Leb128<std::uint32_t>::decode_from(code);
+                if (!local) {
+                    return std::nullopt;
+                }
+
+                instructions.push_back({opcode == 0x20 ? Instruction::Opcode::LocalGet : Instruction::Opcode::LocalSet,
+                        static_cast<std::int32_t>(*local)});
+                break;
+            }
+            case 0x41: {
+                auto value = Leb128<std::int32_t>::decode_from(code);
+                if (!value) {
+                    return std::nullopt;
+                }
+
+                instructions.push_back({Instruction::Opcode::I32Const, *value});
+                break;
+            }
+            case 0x6a:
+                instructions.push_back({Instruction::Opcode::I32Add});
+                break;
+            case 0x6b:
+                instructions.push_back({Instruction::Opcode::I32Sub});
+                break;
+            case 0x6c:
+                instructions.push_back({Instruction::Opcode::I32Mul});
+                break;
+            case 0x0b:
+                instructions.push_back({Instruction::Opcode::End});
+                break;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    return instructions;
+}
+
+std::optional<std::int32_t> Interpreter::run(std::span<Instruction const> instructions, //
+        std::vector<std::int32_t> locals) {
+    std::vector<std::int32_t> stack;
+
+    auto pop = [&]() -> std::optional<std::int32_t> {
+        if (stack.empty()) {
+            return std::nullopt;
+        }
+
+        auto value = stack.back();
+        stack.pop_back();
+        return value;
+    };
+
+    for (auto const &instruction : instructions) {
+        switch (instruction.op) {
+            case Instruction::Opcode::LocalGet: {
+                auto local = static_cast<std::uint32_t>(instruction.operand);
+                if (local >= locals.size()) {
+                    return std::nullopt;
+                }
+
+                stack.push_back(locals[local]);
+                break;
+            }
+            case Instruction::Opcode::LocalSet: {
+                auto local = static_cast<std::uint32_t>(instruction.operand);
+                auto value = pop();
+                if (local >= locals.size() || !value) {
+                    return std::nullopt;
+                }
+
+                locals[local] = *value;
+                break;
+            }
+            case Instruction::Opcode::I32Const:
+                stack.push_back(instruction.operand);
+                break;
+            case Instruction::Opcode::I32Add:
+            case Instruction::Opcode::I32Sub:
+            case Instruction::Opcode::I32Mul: {
+                auto rhs = pop();
+                auto lhs = pop();
+                if (!lhs || !rhs) {
+                    return std::nullopt;
+                }
+
+                // i32 arithmetic wraps around, so it's done unsigned.
+                auto a = static_cast<std::uint32_t>(*lhs);
+                auto b = static_cast<std::uint32_t>(*rhs);
+                switch (instruction.op) {
+                    case Instruction::Opcode::I32Add:
+                        stack.push_back(static_cast<std::int32_t>(a + b));
+                        break;
+                    case Instruction::Opcode::I32Sub:
+                        stack.push_back(static_cast<std::int32_t>(a - b));
+                        break;
+                    default:
+                        stack.push_back(static_cast<std::int32_t>(a * b));
+                        break;
+                }
+                break;
+            }
+            case Instruction::Opcode::End:
+                return pop();
+        }
+    }
+
+    return std::nullopt;
+}
+
+} // namespace wasm
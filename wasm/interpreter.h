@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef WASM_INTERPRETER_H_
+#define WASM_INTERPRETER_H_
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace wasm {
+
+// A function body's expression, decoded once into fixed-width instructions
+// with the LEB128 operands already unpacked, so execution never touches the
+// variable-length encoding.
+struct Instruction {
+    // https://webassembly.github.io/spec/core/binary/instructions.html
+    enum class Opcode : std::uint8_t {
+        LocalGet, // 0x20
+        LocalSet, // 0x21
+        I32Const, // 0x41
+        I32Add, // 0x6a
+        I32Sub, // 0x6b
+        I32Mul, // 0x6c
+        End, // 0x0b
+    };
+
+    Opcode op{};
+    std::int32_t operand{};
+
+    [[nodiscard]] bool operator==(Instruction const &) const = default;
+};
+
+// Executes decoded instruction streams over a contiguous operand stack.
+// This is deliberately the fast shape for an interpreter: decode_body
+// front-loads all per-instruction parsing, and run is a tight loop over a
+// dense opcode enum that the compiler lowers to a jump table.
+class Interpreter {
+public:
+    // Decodes one function body's code into an instruction stream.
+    // Instructions that aren't supported yet fail the decode.
+    static std::optional<std::vector<Instruction>> decode_body(std::span<std::uint8_t const>);
+
+    // Runs a decoded body to its end and returns the top of the operand
+    // stack, or std::nullopt if the body underflows its stack or touches
+    // locals that don't exist.
+    static std::optional<std::int32_t> run(std::span<Instruction const>, std::vector<std::int32_t> locals = {});
+};
+
+} // namespace wasm
+
+#endif
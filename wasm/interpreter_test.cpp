@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2023 Robin Lindén <dev@robinlinden.eu>
+//
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "wasm/interpreter.h"
+
+#include "etest/etest.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+using etest::expect_eq;
+using wasm::Instruction;
+using wasm::Interpreter;
+
+namespace {
+
+std::optional<std::int32_t> decode_and_run(
+        std::vector<std::uint8_t> const &code, std::vector<std::int32_t> locals = {}) {
+    auto instructions = Interpreter::decode_body(code);
+    if (!instructions) {
+        return std::nullopt;
+    }
+
+    return Interpreter::run(*instructions, std::move(locals));
+}
+
+} // namespace
+
+int main() {
+    etest::test("decode predecodes operands", [] {
+        // i32.const 5, i32.const -1, i32.add, end
+        std::vector<std::uint8_t> code{0x41, 0x05, 0x41, 0x7f, 0x6a, 0x0b};
+        expect_eq(Interpreter::decode_body(code),
+                std::vector<Instruction>{
+                        {Instruction::Opcode::I32Const, 5},
+                        {Instruction::Opcode::I32Const, -1},
+                        {Instruction::Opcode::I32Add},
+                        {Instruction::Opcode::End},
+                });
+    });
+
+    etest::test("decode failures", [] {
+        // Unsupported opcode.
+        expect_eq(Interpreter::decode_body(std::vector<std::uint8_t>{0xff}), std::nullopt);
+        // Truncated i32.const operand.
+        expect_eq(Interpreter::decode_body(std::vector<std::uint8_t>{0x41}), std::nullopt);
+        // Truncated local.get operand.
+        expect_eq(Interpreter::decode_body(std::vector<std::uint8_t>{0x20}), std::nullopt);
+    });
+
+    etest::test("arithmetic", [] {
+        expect_eq(decode_and_run({0x41, 0x05, 0x41, 0x03, 0x6a, 0x0b}), 8);
+        expect_eq(decode_and_run({0x41, 0x05, 0x41, 0x03, 0x6b, 0x0b}), 2);
+        expect_eq(decode_and_run({0x41, 0x05, 0x41, 0x03, 0x6c, 0x0b}), 15);
+    });
+
+    etest::test("locals", [] {
+        // local.get 0, local.get 1, i32.add, local.set 0, local.get 0, end
+        expect_eq(decode_and_run({0x20, 0x00, 0x20, 0x01, 0x6a, 0x21, 0x00, 0x20, 0x00, 0x0b}, {11, 31}), 42);
+
+        // Out-of-range locals fail the run.
+        expect_eq(decode_and_run({0x20, 0x00, 0x0b}), std::nullopt);
+        expect_eq(decode_and_run({0x41, 0x00, 0x21, 0x05, 0x0b}, {0}), std::nullopt);
+    });
+
+    etest::test("stack underflow", [] {
+        expect_eq(decode_and_run({0x6a, 0x0b}), std::nullopt);
+        expect_eq(decode_and_run({0x41, 0x01, 0x6a, 0x0b}), std::nullopt);
+        // A body that never produces a value has nothing to return.
+        expect_eq(decode_and_run({0x0b}), std::nullopt);
+    });
+
+    return etest::run_all_tests();
+}
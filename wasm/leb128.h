@@ -7,9 +7,11 @@
 
 #include <cmath>
 #include <concepts>
+#include <cstddef>
 #include <cstdint>
 #include <istream>
 #include <optional>
+#include <span>
 
 namespace wasm {
 
@@ -56,6 +58,47 @@ struct Leb128<T> {
 
         return std::nullopt;
     }
+
+    // Decodes from a buffer, advancing it past the bytes consumed on
+    // success. The one-byte encoding covers the overwhelming majority of
+    // integers in real modules, so it's handled before the general loop.
+    static std::optional<T> decode_from(std::span<std::uint8_t const> &data) {
+        if (!data.empty() && !(data.front() & 0b1000'0000)) {
+            T result = data.front();
+            data = data.subspan(1);
+            return result;
+        }
+
+        T result{};
+        std::uint8_t shift{};
+        auto const max_bytes = static_cast<std::size_t>(std::ceil(sizeof(T) * 8 / 7.f));
+        for (std::size_t i = 0; i < max_bytes; ++i) {
+            if (i >= data.size()) {
+                return std::nullopt;
+            }
+
+            auto const byte = data[i];
+            if (i == max_bytes - 1) {
+                // This is the last byte we'll read. Check that any extra bits are all 0.
+                auto remaining_value_bits = sizeof(T) * 8 - (max_bytes - 1) * 7;
+                auto extra_bits_mask = (0xff << remaining_value_bits) & 0b0111'1111;
+                auto extra_bits = byte & extra_bits_mask;
+                if (extra_bits != 0) {
+                    return std::nullopt;
+                }
+            }
+
+            result |= static_cast<T>(byte & 0b0111'1111) << shift;
+            if (!(byte & 0b1000'0000)) {
+                data = data.subspan(i + 1);
+                return result;
+            }
+
+            shift += 7;
+        }
+
+        return std::nullopt;
+    }
 };
 
 // https://en.wikipedia.org/wiki/LEB128#Decode_signed_integer
@@ -103,6 +146,49 @@ struct Leb128<T> {
 
         return result;
     }
+
+    // See the unsigned specialization; the general loop is shared in shape,
+    // with the sign extension on top.
+    static std::optional<T> decode_from(std::span<std::uint8_t const> &data) {
+        T result{};
+        std::uint8_t shift{};
+        std::uint8_t byte{};
+        auto const max_bytes = static_cast<std::size_t>(std::ceil(sizeof(T) * 8 / 7.f));
+        std::size_t i = 0;
+        for (; i < max_bytes; ++i) {
+            if (i >= data.size()) {
+                return std::nullopt;
+            }
+
+            byte = data[i];
+            if (i == max_bytes - 1) {
+                // This is the last byte we'll read. Check that any extra bits are all 0.
+                auto remaining_value_bits = sizeof(T) * 8 - (max_bytes - 1) * 7 - 1;
+                auto extra_bits_mask = (0xff << remaining_value_bits) & kNonContinuationBits;
+                auto extra_bits = byte & extra_bits_mask;
+                if (extra_bits != 0 && extra_bits != extra_bits_mask) {
+                    return std::nullopt;
+                }
+            }
+
+            result |= static_cast<T>(byte & kNonContinuationBits) << shift;
+            shift += 7;
+            if (!(byte & kContinuationBit)) {
+                break;
+            }
+        }
+
+        if (byte & kContinuationBit) {
+            return std::nullopt;
+        }
+
+        if ((shift < sizeof(T) * 8) && (byte & kSignBit)) {
+            result |= ~0 << shift;
+        }
+
+        data = data.subspan(i + 1);
+        return result;
+    }
 };
 
 } // namespace wasm
@@ -6,7 +6,10 @@
 
 #include "etest/etest.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <limits>
+#include <span>
 #include <sstream>
 #include <string>
 
@@ -15,14 +18,28 @@ using etest::expect_eq;
 using wasm::Leb128;
 
 namespace {
+// Every case is decoded both through the stream decoder and the span
+// decoder so the two can't drift apart.
+std::span<std::uint8_t const> as_bytes(std::string const &bytes) {
+    return {reinterpret_cast<std::uint8_t const *>(bytes.data()), bytes.size()};
+}
+
 template<typename T>
 void expect_decoded(std::string bytes, T expected, etest::source_location loc = etest::source_location::current()) {
-    expect_eq(Leb128<T>::decode_from(std::stringstream{std::move(bytes)}), expected, std::nullopt, std::move(loc));
+    expect_eq(Leb128<T>::decode_from(std::stringstream{bytes}), expected, std::nullopt, loc);
+
+    auto data = as_bytes(bytes);
+    expect_eq(Leb128<T>::decode_from(data), expected, std::nullopt, loc);
+    // The span decoder consumes exactly the encoding.
+    expect_eq(data.size(), std::size_t{0}, std::nullopt, std::move(loc));
 };
 
 template<typename T>
 void expect_decode_failure(std::string bytes, etest::source_location loc = etest::source_location::current()) {
-    expect_eq(Leb128<T>::decode_from(std::stringstream{std::move(bytes)}), std::nullopt, std::nullopt, std::move(loc));
+    expect_eq(Leb128<T>::decode_from(std::stringstream{bytes}), std::nullopt, std::nullopt, loc);
+
+    auto data = as_bytes(bytes);
+    expect_eq(Leb128<T>::decode_from(data), std::nullopt, std::nullopt, std::move(loc));
 };
 } // namespace
 
@@ -7,12 +7,16 @@
 #include "wasm/leb128.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <istream>
+#include <iterator>
+#include <memory>
 #include <optional>
-#include <sstream>
-#include <string>
+#include <span>
+#include <spanstream>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -21,8 +25,8 @@ using namespace std::literals;
 namespace wasm {
 namespace {
 
-constexpr int kMagicSize = 4;
-constexpr int kVersionSize = 4;
+constexpr std::size_t kMagicSize = 4;
+constexpr std::size_t kVersionSize = 4;
 
 template<typename T>
 std::optional<std::vector<T>> parse_vector(std::istream &);
@@ -143,91 +147,161 @@ std::optional<std::vector<T>> parse_vector(std::istream &&is) {
     return parse_vector<T>(is);
 }
 
-std::optional<std::string> get_section_data(std::vector<Section> const &sections, SectionId id) {
+std::span<char const> as_chars(std::span<std::uint8_t const> bytes) {
+    return {reinterpret_cast<char const *>(bytes.data()), bytes.size()};
+}
+
+std::optional<std::span<std::uint8_t const>> get_section_data(std::vector<Section> const &sections, SectionId id) {
     auto section = std::ranges::find_if(sections, [&](auto const &s) { return s.id == id; });
     if (section == end(sections)) {
         return std::nullopt;
     }
 
-    return std::string{reinterpret_cast<char const *>(section->content.data()), section->content.size()};
+    return section->content;
 }
 
 } // namespace
 
 std::optional<Module> Module::parse_from(std::istream &is) {
-    std::string buf;
+    auto bytes = std::make_shared<std::vector<std::uint8_t> const>(
+            std::istreambuf_iterator<char>{is}, std::istreambuf_iterator<char>{});
 
-    // https://webassembly.github.io/spec/core/bikeshed/#binary-magic
-    buf.resize(kMagicSize);
-    is.read(buf.data(), buf.size());
-    if (!is || buf != "\0asm"sv) {
-        return std::nullopt;
+    auto module = parse_from(std::span{*bytes});
+    if (module) {
+        module->owned_bytes = std::move(bytes);
     }
 
+    return module;
+}
+
+std::optional<Module> Module::parse_from(std::span<std::uint8_t const> bytes) {
+    // https://webassembly.github.io/spec/core/bikeshed/#binary-magic
     // https://webassembly.github.io/spec/core/bikeshed/#binary-version
-    buf.resize(kVersionSize);
-    is.read(buf.data(), buf.size());
-    if (!is || buf != "\1\0\0\0"sv) {
+    if (bytes.size() < kMagicSize + kVersionSize //
+            || !std::ranges::equal(as_chars(bytes.first(kMagicSize)), "\0asm"sv)
+            || !std::ranges::equal(as_chars(bytes.subspan(kMagicSize, kVersionSize)), "\1\0\0\0"sv)) {
         return std::nullopt;
     }
 
+    bytes = bytes.subspan(kMagicSize + kVersionSize);
+
     Module module;
 
     // https://webassembly.github.io/spec/core/bikeshed/#sections
-    while (true) {
-        std::uint8_t id{};
-        is.read(reinterpret_cast<char *>(&id), sizeof(id));
-        if (!is) {
-            // We've read 0 or more complete modules, so we're done.
-            break;
-        }
-
+    // Only section headers are inspected here; the contents stay untouched
+    // in the buffer as views for the section accessors to parse on demand.
+    while (!bytes.empty()) {
+        auto id = bytes.front();
         if (!(id >= static_cast<int>(SectionId::Custom) && id <= static_cast<int>(SectionId::DataCount))) {
             return std::nullopt;
         }
 
-        auto size = Leb128<std::uint32_t>::decode_from(is);
-        if (!size) {
-            return std::nullopt;
-        }
+        bytes = bytes.subspan(1);
 
-        std::vector<std::uint8_t> content;
-        content.resize(*size);
-        is.read(reinterpret_cast<char *>(content.data()), *size);
-        if (!is) {
+        auto size = Leb128<std::uint32_t>::decode_from(bytes);
+        if (!size || *size > bytes.size()) {
             return std::nullopt;
         }
 
-        module.sections.push_back(Section{static_cast<SectionId>(id), std::move(content)});
+        module.sections.push_back(Section{static_cast<SectionId>(id), bytes.first(*size)});
+        bytes = bytes.subspan(*size);
     }
 
     return module;
 }
 
 std::optional<TypeSection> Module::type_section() const {
+    if (type_section_cache) {
+        return type_section_cache;
+    }
+
     auto content = get_section_data(sections, SectionId::Type);
     if (!content) {
         return std::nullopt;
     }
 
-    if (auto maybe_types = parse_vector<FunctionType>(std::stringstream{*std::move(content)})) {
-        return TypeSection{.types = *std::move(maybe_types)};
+    if (auto maybe_types = parse_vector<FunctionType>(std::ispanstream{as_chars(*content)})) {
+        type_section_cache = TypeSection{.types = *std::move(maybe_types)};
+        return type_section_cache;
     }
 
     return std::nullopt;
 }
 
+std::optional<CodeSection> Module::code_section() const {
+    if (code_section_cache) {
+        return code_section_cache;
+    }
+
+    auto content = get_section_data(sections, SectionId::Code);
+    if (!content) {
+        return std::nullopt;
+    }
+
+    auto data = *content;
+    auto count = Leb128<std::uint32_t>::decode_from(data);
+    if (!count) {
+        return std::nullopt;
+    }
+
+    CodeSection code_section;
+    code_section.entries.reserve(*count);
+    for (std::uint32_t i = 0; i < *count; ++i) {
+        auto size = Leb128<std::uint32_t>::decode_from(data);
+        if (!size || *size > data.size()) {
+            return std::nullopt;
+        }
+
+        // The body bytes stay where they are; only their location is
+        // recorded.
+        auto offset = static_cast<std::uint32_t>(content->size() - data.size());
+        data = data.subspan(*size);
+        code_section.entries.push_back(CodeSection::Entry{.offset = offset, .size = *size});
+    }
+
+    code_section_cache = std::move(code_section);
+    return code_section_cache;
+}
+
 std::optional<ExportSection> Module::export_section() const {
+    if (export_section_cache) {
+        return export_section_cache;
+    }
+
     auto content = get_section_data(sections, SectionId::Export);
     if (!content) {
         return std::nullopt;
     }
 
-    if (auto maybe_exports = parse_vector<Export>(std::stringstream{*std::move(content)})) {
-        return ExportSection{.exports = std::move(maybe_exports).value()};
+    if (auto maybe_exports = parse_vector<Export>(std::ispanstream{as_chars(*content)})) {
+        export_section_cache = ExportSection{.exports = std::move(maybe_exports).value()};
+        return export_section_cache;
     }
 
     return std::nullopt;
 }
 
+std::optional<Export> Module::find_export(std::string_view name) const {
+    if (!export_section()) {
+        return std::nullopt;
+    }
+
+    auto const &exports = export_section_cache->exports;
+    if (!export_index_cache) {
+        std::unordered_map<std::string_view, std::size_t> index;
+        index.reserve(exports.size());
+        for (std::size_t i = 0; i < exports.size(); ++i) {
+            index.emplace(exports[i].name, i);
+        }
+        export_index_cache = std::move(index);
+    }
+
+    auto it = export_index_cache->find(name);
+    if (it == export_index_cache->end()) {
+        return std::nullopt;
+    }
+
+    return exports[it->second];
+}
+
 } // namespace wasm
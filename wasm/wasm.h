@@ -5,10 +5,16 @@
 #ifndef WASM_WASM_H_
 #define WASM_WASM_H_
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iosfwd>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace wasm {
@@ -30,11 +36,15 @@ enum class SectionId {
     DataCount = 12,
 };
 
+// A section borrows its content from the module's underlying buffer; see
+// the ownership note on Module.
 struct Section {
     SectionId id{};
-    std::vector<std::uint8_t> content{};
+    std::span<std::uint8_t const> content{};
 
-    [[nodiscard]] bool operator==(Section const &) const = default;
+    [[nodiscard]] bool operator==(Section const &other) const {
+        return id == other.id && std::ranges::equal(content, other.content);
+    }
 };
 
 // https://webassembly.github.io/spec/core/binary/types.html#types
@@ -89,17 +99,60 @@ struct ExportSection {
     [[nodiscard]] bool operator==(ExportSection const &) const = default;
 };
 
+// https://webassembly.github.io/spec/core/bikeshed/#code-section
+// Function bodies are not decoded up front: each entry records where its
+// body sits in the section content and how large it is, so bodies can be
+// decoded on first call instead of at load time.
+struct CodeSection {
+    struct Entry {
+        std::uint32_t offset{};
+        std::uint32_t size{};
+
+        [[nodiscard]] bool operator==(Entry const &) const = default;
+    };
+
+    std::vector<Entry> entries{};
+
+    [[nodiscard]] bool operator==(CodeSection const &) const = default;
+};
+
 // https://webassembly.github.io/spec/core/bikeshed/#modules
+// Section contents are views into the module's bytes rather than copies.
+// Modules parsed from a stream keep those bytes alive themselves; modules
+// parsed from a span borrow the caller's buffer, which must outlive the
+// module and anything parsed out of it.
 struct Module {
     static std::optional<Module> parse_from(std::istream &&is) { return parse_from(is); }
     static std::optional<Module> parse_from(std::istream &);
+    static std::optional<Module> parse_from(std::span<std::uint8_t const>);
 
     std::vector<Section> sections{};
 
+    // Backing storage for modules parsed from a stream. Not part of a
+    // module's identity.
+    std::shared_ptr<std::vector<std::uint8_t> const> owned_bytes{};
+
+    // parse_from only scans section headers; a section's contents are
+    // parsed the first time its accessor is called and cached, so tools
+    // that just list exports never pay for the code and data sections.
     std::optional<TypeSection> type_section() const;
     std::optional<ExportSection> export_section() const;
-
-    [[nodiscard]] bool operator==(Module const &) const = default;
+    std::optional<CodeSection> code_section() const;
+
+    // The export with the given name, if there is one. A name-to-export map
+    // is built on first call, so dispatching a call by name costs one hash
+    // lookup instead of a scan of the export section.
+    std::optional<Export> find_export(std::string_view name) const;
+
+    [[nodiscard]] bool operator==(Module const &other) const { return sections == other.sections; }
+
+    // Parsed-on-first-access caches, not part of a module's identity.
+    // Failed parses aren't cached; they're rare and cheap to repeat.
+    mutable std::optional<TypeSection> type_section_cache{};
+    mutable std::optional<ExportSection> export_section_cache{};
+    mutable std::optional<CodeSection> code_section_cache{};
+    // Keys view into export_section_cache, which stays put once built.
+    mutable std::optional<std::unordered_map<std::string_view, std::size_t>> export_index_cache{};
 };
 
 } // namespace wasm
@@ -6,10 +6,14 @@
 
 #include "etest/etest.h"
 
+#include <cstdint>
+#include <memory>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 using namespace std::literals;
 
@@ -17,6 +21,14 @@ using etest::expect_eq;
 
 namespace {
 
+// Sections only borrow their content, so the bytes are parked in the
+// module's own buffer, just like Module::parse_from does for streams.
+wasm::Module module_with_section(wasm::SectionId id, std::vector<std::uint8_t> content) {
+    auto bytes = std::make_shared<std::vector<std::uint8_t> const>(std::move(content));
+    auto section = wasm::Section{.id = id, .content{std::span{*bytes}}};
+    return wasm::Module{.sections{std::move(section)}, .owned_bytes{std::move(bytes)}};
+}
+
 void export_section_tests() {
     etest::test("export section, non-existent", [] {
         auto module = wasm::Module{};
@@ -24,60 +36,32 @@ void export_section_tests() {
     });
 
     etest::test("export section, missing export count", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Export,
-                .content{},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Export, {});
 
         expect_eq(module.export_section(), std::nullopt);
     });
 
     etest::test("export section, missing export after count", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Export,
-                .content{1},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Export, {1});
 
         expect_eq(module.export_section(), std::nullopt);
     });
 
     etest::test("export section, empty", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Export,
-                .content{0},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Export, {0});
 
         expect_eq(module.export_section(), wasm::ExportSection{});
     });
 
     etest::test("export section, one", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Export,
-                .content{1, 2, 'h', 'i', static_cast<std::uint8_t>(wasm::Export::Type::Function), 5},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Export, {1, 2, 'h', 'i', static_cast<std::uint8_t>(wasm::Export::Type::Function), 5});
 
         expect_eq(module.export_section(),
                 wasm::ExportSection{.exports{wasm::Export{"hi", wasm::Export::Type::Function, 5}}});
     });
 
     etest::test("export section, two", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Export,
-                .content{
-                        2,
-                        2,
-                        'h',
-                        'i',
-                        static_cast<std::uint8_t>(wasm::Export::Type::Function),
-                        5,
-                        3,
-                        'l',
-                        'o',
-                        'l',
-                        static_cast<std::uint8_t>(wasm::Export::Type::Global),
-                        2,
-                },
-        }}};
+        auto module = module_with_section(wasm::SectionId::Export, {2, 2, 'h', 'i', static_cast<std::uint8_t>(wasm::Export::Type::Function), 5, 3, 'l', 'o', 'l', static_cast<std::uint8_t>(wasm::Export::Type::Global), 2});
 
         expect_eq(module.export_section(),
                 wasm::ExportSection{.exports{
@@ -86,18 +70,47 @@ void export_section_tests() {
                 }});
     });
 
+    etest::test("export section, parsed on first access and cached", [] {
+        auto module = module_with_section(
+                wasm::SectionId::Export, {1, 2, 'h', 'i', static_cast<std::uint8_t>(wasm::Export::Type::Function), 5});
+
+        auto exports = module.export_section();
+        expect_eq(exports, wasm::ExportSection{.exports{wasm::Export{"hi", wasm::Export::Type::Function, 5}}});
+
+        // Once parsed, the section is served from the cache.
+        module.sections.clear();
+        expect_eq(module.export_section(), exports);
+    });
+
+    etest::test("find_export", [] {
+        auto module = module_with_section(wasm::SectionId::Export, {2, 2, 'h', 'i', static_cast<std::uint8_t>(wasm::Export::Type::Function), 5, 3, 'l', 'o', 'l', static_cast<std::uint8_t>(wasm::Export::Type::Global), 2});
+
+        expect_eq(module.find_export("hi"), wasm::Export{"hi", wasm::Export::Type::Function, 5});
+        expect_eq(module.find_export("lol"), wasm::Export{"lol", wasm::Export::Type::Global, 2});
+        expect_eq(module.find_export("nope"), std::nullopt);
+
+        // Lookups are served from the name index once it's built.
+        module.sections.clear();
+        expect_eq(module.find_export("hi"), wasm::Export{"hi", wasm::Export::Type::Function, 5});
+    });
+
+    etest::test("find_export, no export section", [] {
+        auto module = wasm::Module{};
+        expect_eq(module.find_export("hi"), std::nullopt);
+    });
+
     etest::test("export section, missing name", [] {
-        auto module = wasm::Module{.sections{wasm::Section{.id = wasm::SectionId::Export, .content{1, 2}}}};
+        auto module = module_with_section(wasm::SectionId::Export, {1, 2});
         expect_eq(module.export_section(), std::nullopt);
     });
 
     etest::test("export section, missing type", [] {
-        auto module = wasm::Module{.sections{wasm::Section{.id = wasm::SectionId::Export, .content{1, 1, 'a'}}}};
+        auto module = module_with_section(wasm::SectionId::Export, {1, 1, 'a'});
         expect_eq(module.export_section(), std::nullopt);
     });
 
     etest::test("export section, missing index", [] {
-        auto module = wasm::Module{.sections{wasm::Section{.id = wasm::SectionId::Export, .content{1, 1, 'a', 1}}}};
+        auto module = module_with_section(wasm::SectionId::Export, {1, 1, 'a', 1});
         expect_eq(module.export_section(), std::nullopt);
     });
 }
@@ -109,46 +122,31 @@ void type_section_tests() {
     });
 
     etest::test("type section, missing type data", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Type,
-                .content{},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Type, {});
 
         expect_eq(module.type_section(), std::nullopt);
     });
 
     etest::test("type section, empty", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Type,
-                .content{0},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Type, {0});
 
         expect_eq(module.type_section(), wasm::TypeSection{});
     });
 
     etest::test("type section, missing type after count", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Type,
-                .content{1},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Type, {1});
 
         expect_eq(module.type_section(), std::nullopt);
     });
 
     etest::test("type section, bad magic in function type", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Type,
-                .content{1, 0x59},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Type, {1, 0x59});
 
         expect_eq(module.type_section(), std::nullopt);
     });
 
     etest::test("type section, one type with no parameters and no results", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Type,
-                .content{1, 0x60, 0, 0},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Type, {1, 0x60, 0, 0});
 
         expect_eq(module.type_section(),
                 wasm::TypeSection{
@@ -157,19 +155,13 @@ void type_section_tests() {
     });
 
     etest::test("type section, eof in parameter parsing", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Type,
-                .content{1, 0x60, 1},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Type, {1, 0x60, 1});
 
         expect_eq(module.type_section(), std::nullopt);
     });
 
     etest::test("type section, eof in result parsing", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Type,
-                .content{1, 0x60, 0, 1},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Type, {1, 0x60, 0, 1});
 
         expect_eq(module.type_section(), std::nullopt);
     });
@@ -177,10 +169,7 @@ void type_section_tests() {
     etest::test("type section, two types", [] {
         auto const i32_byte = static_cast<std::uint8_t>(wasm::ValueType::Int32);
         auto const f64_byte = static_cast<std::uint8_t>(wasm::ValueType::Float64);
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Type,
-                .content{2, 0x60, 0, 1, i32_byte, 0x60, 2, i32_byte, i32_byte, 1, f64_byte},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Type, {2, 0x60, 0, 1, i32_byte, 0x60, 2, i32_byte, i32_byte, 1, f64_byte});
 
         expect_eq(module.type_section(),
                 wasm::TypeSection{
@@ -195,15 +184,54 @@ void type_section_tests() {
     });
 
     etest::test("type section, invalid value type", [] {
-        auto module = wasm::Module{.sections{wasm::Section{
-                .id = wasm::SectionId::Type,
-                .content{1, 0x60, 0, 1, 0x10},
-        }}};
+        auto module = module_with_section(wasm::SectionId::Type, {1, 0x60, 0, 1, 0x10});
 
         expect_eq(module.type_section(), std::nullopt);
     });
 }
 
+void code_section_tests() {
+    etest::test("code section, non-existent", [] {
+        auto module = wasm::Module{};
+        expect_eq(module.code_section(), std::nullopt);
+    });
+
+    etest::test("code section, missing entry count", [] {
+        auto module = module_with_section(wasm::SectionId::Code, {});
+
+        expect_eq(module.code_section(), std::nullopt);
+    });
+
+    etest::test("code section, empty", [] {
+        auto module = module_with_section(wasm::SectionId::Code, {0});
+
+        expect_eq(module.code_section(), wasm::CodeSection{});
+    });
+
+    etest::test("code section, missing size after count", [] {
+        auto module = module_with_section(wasm::SectionId::Code, {1});
+
+        expect_eq(module.code_section(), std::nullopt);
+    });
+
+    etest::test("code section, truncated body", [] {
+        auto module = module_with_section(wasm::SectionId::Code, {1, 5, 0xaa});
+
+        expect_eq(module.code_section(), std::nullopt);
+    });
+
+    etest::test("code section, two entries", [] {
+        auto module = module_with_section(wasm::SectionId::Code, {2, 1, 0xaa, 2, 0xbb, 0xcc});
+
+        // The bodies aren't decoded, just located within the section.
+        expect_eq(module.code_section(),
+                wasm::CodeSection{.entries{
+                        wasm::CodeSection::Entry{.offset = 2, .size = 1},
+                        wasm::CodeSection::Entry{.offset = 4, .size = 2},
+                }});
+    });
+}
+
 } // namespace
 
 int main() {
@@ -247,35 +275,34 @@ int main() {
     etest::test("one valid section", [] {
         auto wasm_bytes = std::stringstream{"\0asm\1\0\0\0\x0b\4\1\2\3\4"s};
         expect_eq(wasm::Module::parse_from(std::move(wasm_bytes)),
-                wasm::Module{
-                        .sections{
-                                wasm::Section{
-                                        .id = wasm::SectionId::Data,
-                                        .content{1, 2, 3, 4},
-                                },
-                        },
-                });
+                module_with_section(wasm::SectionId::Data, {1, 2, 3, 4}));
     });
 
     etest::test("two valid sections", [] {
         auto wasm_bytes = std::stringstream{"\0asm\1\0\0\0\x09\4\1\2\3\4\x0a\2\5\6"s};
+
+        std::vector<std::uint8_t> element_content{1, 2, 3, 4};
+        std::vector<std::uint8_t> code_content{5, 6};
         expect_eq(wasm::Module::parse_from(std::move(wasm_bytes)),
-                wasm::Module{
-                        .sections{
-                                wasm::Section{
-                                        .id = wasm::SectionId::Element,
-                                        .content{1, 2, 3, 4},
-                                },
-                                wasm::Section{
-                                        .id = wasm::SectionId::Code,
-                                        .content{5, 6},
-                                },
-                        },
-                });
+                wasm::Module{.sections{
+                        wasm::Section{.id = wasm::SectionId::Element, .content{element_content}},
+                        wasm::Section{.id = wasm::SectionId::Code, .content{code_content}},
+                }});
+    });
+
+    etest::test("parsing from a span borrows the caller's buffer", [] {
+        std::vector<std::uint8_t> bytes{'\0', 'a', 's', 'm', 1, 0, 0, 0, 0x0b, 4, 1, 2, 3, 4};
+
+        auto module = wasm::Module::parse_from(std::span{bytes});
+        expect_eq(module, module_with_section(wasm::SectionId::Data, {1, 2, 3, 4}));
+
+        // The section's content is a view into the original bytes, not a copy.
+        expect_eq(module.value().sections.at(0).content.data(), bytes.data() + 10);
     });
 
     type_section_tests();
     export_section_tests();
+    code_section_tests();
 
     return etest::run_all_tests();
 }